@@ -120,6 +120,9 @@ PrintUsageAndExit(void)
             " and\n"
             "  -b <bitrate>: send at the specified bitrate (default: as "
             "fast as possible)\n"
+            " and\n"
+            "  -m <batch_size>: pump datagrams from a udp or multicast "
+            "input, up to <batch_size> per call, and report the packet rate\n"
             "\n", PUMP_DEFAULT_PACKET_SIZE);
     exit(1);
 }
@@ -174,65 +177,143 @@ done:
 }
 
 /*----------------------------------------------------------------------
-|       GetEndPoinStreams
+|       IsDatagramEndPoint
++---------------------------------------------------------------------*/
+static ATX_Boolean
+IsDatagramEndPoint(EndPoint* endpoint)
+{
+    return endpoint->type == ENDPOINT_TYPE_UDP_CLIENT       ||
+           endpoint->type == ENDPOINT_TYPE_UDP_SERVER       ||
+           endpoint->type == ENDPOINT_TYPE_MULTICAST_CLIENT ||
+           endpoint->type == ENDPOINT_TYPE_MULTICAST_SERVER;
+}
+
+/*----------------------------------------------------------------------
+|       OpenDatagramEndPoint
 +---------------------------------------------------------------------*/
 static ATX_Result
-GetEndPointStreams(EndPoint*          endpoint, 
-                   ATX_InputStream**  input_stream,
-                   ATX_OutputStream** output_stream)
+OpenDatagramEndPoint(EndPoint* endpoint, ATX_DatagramSocket** datagram_socket)
 {
-    ATX_Result result;
+    ATX_Socket*       socket;
+    ATX_SocketAddress address;
+    ATX_Result        result;
+
+    /* create socket */
+    result = ATX_UdpSocket_Create(datagram_socket);
+    if (result) return result;
+
+    /* cast to ATX_Socket interface */
+    socket = ATX_CAST(*datagram_socket, ATX_Socket);
+    if (socket == NULL) return ATX_ERROR_INTERNAL;
 
     switch (endpoint->type) {
       case ENDPOINT_TYPE_UDP_CLIENT:
+        /* connect socket */
+        fprintf(stderr, ":: connecting to %s on port %d\n", 
+                endpoint->info.udp_client.hostname,
+                endpoint->info.udp_client.port);
+        result = ATX_Socket_ConnectToHost(socket, 
+                                          endpoint->info.udp_client.hostname,
+                                          endpoint->info.udp_client.port,
+                                          10000);
+        break;
+
+      case ENDPOINT_TYPE_MULTICAST_CLIENT:
+        /* set the time to live */
         {
-            ATX_DatagramSocket* client;
-            ATX_Socket*         socket;
+            ATX_MulticastSocket* mcast_socket = ATX_CAST(*datagram_socket, ATX_MulticastSocket);
+            if (mcast_socket) {
+                ATX_MulticastSocket_SetTimeToLive(mcast_socket, endpoint->info.multicast_client.ttl);
+            }
+        }
 
-            /* create socket */
-            result = ATX_UdpSocket_Create(&client);
-            if (result) return result;
+        /* connect socket */
+        fprintf(stderr, ":: connecting to %s on port %d\n", 
+                endpoint->info.multicast_client.groupname,
+                endpoint->info.multicast_client.port);
+        result = ATX_Socket_ConnectToHost(socket, 
+                                          endpoint->info.multicast_client.groupname,
+                                          endpoint->info.multicast_client.port,
+                                          10000);
+        break;
 
-            /* cast to ATX_Socket interface */
-            socket = ATX_CAST(client, ATX_Socket);
-            if (socket == NULL) return ATX_ERROR_INTERNAL;
+      case ENDPOINT_TYPE_UDP_SERVER:
+        /* listen on port */
+        fprintf(stderr, ":: listening on port %d\n", 
+                endpoint->info.udp_server.port);
+        ATX_SocketAddress_Set(&address,
+                              NULL,
+                              endpoint->info.udp_server.port);
+        result = ATX_Socket_Bind(socket, &address);
+        break;
 
-            /* connect socket */
-            return ConnectClient(socket, 
-                                 endpoint->info.udp_client.hostname,
-                                 endpoint->info.udp_client.port,
-                                 input_stream,
-                                 output_stream);
+      case ENDPOINT_TYPE_MULTICAST_SERVER:
+        /* join the multicast group */
+        fprintf(stderr, ":: joining multicast group %s\n",
+                endpoint->info.multicast_server.groupname);
+        {
+            ATX_MulticastSocket* mcast_socket = ATX_CAST(*datagram_socket, ATX_MulticastSocket);
+            if (mcast_socket) {
+                ATX_IpAddress group_address;
+                ATX_IpAddress_ResolveName(&group_address, endpoint->info.multicast_server.groupname, -1);
+                ATX_MulticastSocket_JoinGroup(mcast_socket, &group_address, NULL);
+            }
         }
+
+        /* listen on port */
+        fprintf(stderr, ":: listening on port %d\n", 
+                endpoint->info.multicast_server.port);
+        ATX_SocketAddress_Set(&address,
+                              NULL,
+                              endpoint->info.multicast_server.port);
+        result = ATX_Socket_Bind(socket, &address);
+        break;
+
+      default:
+        result = ATX_ERROR_INVALID_PARAMETERS;
         break;
+    }
 
-     case ENDPOINT_TYPE_MULTICAST_CLIENT:
+    if (result != ATX_SUCCESS) {
+        fprintf(stderr, "ERROR: cannot open datagram endpoint (%d)\n", result);
+        ATX_DESTROY_OBJECT(*datagram_socket);
+    }
+
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|       GetEndPoinStreams
++---------------------------------------------------------------------*/
+static ATX_Result
+GetEndPointStreams(EndPoint*          endpoint, 
+                   ATX_InputStream**  input_stream,
+                   ATX_OutputStream** output_stream)
+{
+    ATX_Result result;
+
+    switch (endpoint->type) {
+      case ENDPOINT_TYPE_UDP_CLIENT:
+      case ENDPOINT_TYPE_UDP_SERVER:
+      case ENDPOINT_TYPE_MULTICAST_CLIENT:
+      case ENDPOINT_TYPE_MULTICAST_SERVER:
         {
-            ATX_DatagramSocket* client;
+            ATX_DatagramSocket* datagram_socket;
             ATX_Socket*         socket;
 
-            /* create socket */
-            result = ATX_UdpSocket_Create(&client);
+            /* create and connect or bind the socket */
+            result = OpenDatagramEndPoint(endpoint, &datagram_socket);
             if (result) return result;
+            socket = ATX_CAST(datagram_socket, ATX_Socket);
 
-            /* set the time to live */
-            {
-                ATX_MulticastSocket* mcast_socket = ATX_CAST(client, ATX_MulticastSocket);
-                if (mcast_socket) {
-                    ATX_MulticastSocket_SetTimeToLive(mcast_socket, endpoint->info.multicast_client.ttl);
-                }
+            /* get the streams, they keep the socket alive */
+            if (input_stream) {
+                ATX_Socket_GetInputStream(socket, input_stream);
             }
-            
-            /* cast to ATX_Socket interface */
-            socket = ATX_CAST(client, ATX_Socket);
-            if (socket == NULL) return ATX_ERROR_INTERNAL;
-
-            /* connect socket */
-            return ConnectClient(socket,
-                                 endpoint->info.multicast_client.groupname,
-                                 endpoint->info.multicast_client.port,
-                                 input_stream,
-                                 output_stream);
+            if (output_stream) {
+                ATX_Socket_GetOutputStream(socket, output_stream);
+            }
+            ATX_DESTROY_OBJECT(datagram_socket);
         }
         break;
 
@@ -253,76 +334,6 @@ GetEndPointStreams(EndPoint*          endpoint,
         }
         break;
 
-      case ENDPOINT_TYPE_UDP_SERVER:
-        {
-            ATX_DatagramSocket* server;
-            ATX_Socket*         socket;
-            ATX_SocketAddress   address;
-
-            /* create socket */
-            result = ATX_UdpSocket_Create(&server);
-            if (result) return result;
-
-            /* cast to ATX_Socket interface */
-            socket = ATX_CAST(server, ATX_Socket);
-            if (socket == NULL) return ATX_ERROR_INTERNAL;
-
-            /* listen on port */
-            fprintf(stderr, ":: listening on port %d\n", 
-                    endpoint->info.udp_server.port);
-            ATX_SocketAddress_Set(&address,
-                                  NULL,
-                                  endpoint->info.udp_server.port);
-            ATX_Socket_Bind(socket, &address);
-
-            /* get the input stream */
-            if (input_stream) {
-                ATX_Socket_GetInputStream(socket, input_stream);
-            }
-        }
-        break;
-
-      case ENDPOINT_TYPE_MULTICAST_SERVER:
-        {
-            ATX_DatagramSocket* server;
-            ATX_Socket*         socket;
-            ATX_SocketAddress   address;
-
-            /* create socket */
-            result = ATX_UdpSocket_Create(&server);
-            if (result) return result;
-
-            /* join the multicast group */
-            fprintf(stderr, ":: joining multicast group %s\n",
-                    endpoint->info.multicast_server.groupname);
-            {
-                ATX_MulticastSocket* mcast_socket = ATX_CAST(server, ATX_MulticastSocket);
-                if (mcast_socket) {
-                    ATX_IpAddress group_address;
-                    ATX_IpAddress_ResolveName(&group_address, endpoint->info.multicast_server.groupname, -1);
-                    ATX_MulticastSocket_JoinGroup(mcast_socket, &group_address, NULL);
-                }
-            }
-            
-            /* cast to ATX_Socket interface */
-            socket = ATX_CAST(server, ATX_Socket);
-            if (socket == NULL) return ATX_ERROR_INTERNAL;
-
-            /* listen on port */
-            fprintf(stderr, ":: listening on port %d\n", 
-                    endpoint->info.multicast_server.port);
-            ATX_SocketAddress_Set(&address,
-                                  NULL,
-                                  endpoint->info.multicast_server.port);
-            ATX_Socket_Bind(socket, &address);
-
-            /* get the input stream */
-            if (input_stream) {
-                ATX_Socket_GetInputStream(socket, input_stream);
-            }
-        }
-        break;  
-  
       case ENDPOINT_TYPE_TCP_SERVER:
         {
             ATX_ServerSocket*  server;
@@ -421,6 +432,123 @@ GetEndPointStreams(EndPoint*          endpoint,
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|       PumpDatagrams
++---------------------------------------------------------------------*/
+static ATX_Result
+PumpDatagrams(EndPoint*    in_endpoint, 
+              EndPoint*    out_endpoint,
+              unsigned int packet_size,
+              unsigned int batch_size)
+{
+    ATX_DatagramSocket* in;
+    ATX_DatagramSocket* out = NULL;
+    ATX_OutputStream*   out_stream = NULL;
+    ATX_DataBuffer**    packets;
+    ATX_TimeStamp       report_time;
+    unsigned long       packet_count = 0;
+    unsigned long       byte_count   = 0;
+    unsigned long       call_count   = 0;
+    ATX_Result          result;
+    unsigned int        i;
+
+    /* allocate the packets */
+    packets = (ATX_DataBuffer**)calloc(batch_size, sizeof(ATX_DataBuffer*));
+    if (packets == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    for (i=0; i<batch_size; i++) {
+        result = ATX_DataBuffer_Create(packet_size, &packets[i]);
+        if (ATX_FAILED(result)) return result;
+    }
+
+    /* open the endpoints */
+    result = OpenDatagramEndPoint(in_endpoint, &in);
+    if (ATX_FAILED(result)) return result;
+    if (IsDatagramEndPoint(out_endpoint)) {
+        result = OpenDatagramEndPoint(out_endpoint, &out);
+    } else {
+        result = GetEndPointStreams(out_endpoint, NULL, &out_stream);
+    }
+    if (ATX_FAILED(result)) return result;
+
+    ATX_System_GetCurrentTimeStamp(&report_time);
+    for (;;) {
+        ATX_Cardinal  received = 0;
+        ATX_TimeStamp now;
+        ATX_TimeStamp elapsed;
+
+        /* receive, one datagram per call in single mode */
+        if (batch_size == 1) {
+            result = ATX_DatagramSocket_Receive(in, packets[0], NULL);
+            received = 1;
+        } else {
+            result = ATX_DatagramSocket_ReceiveMany(in, packets, NULL, batch_size, &received);
+        }
+        if (ATX_FAILED(result)) {
+            fprintf(stderr, "ERROR: receive failed (%d)\n", result);
+            break;
+        }
+        ++call_count;
+
+        /* forward */
+        if (out == NULL) {
+            for (i=0; i<received && ATX_SUCCEEDED(result); i++) {
+                result = ATX_OutputStream_WriteFully(out_stream, 
+                                                     ATX_DataBuffer_GetData(packets[i]),
+                                                     ATX_DataBuffer_GetDataSize(packets[i]));
+            }
+        } else if (batch_size == 1) {
+            result = ATX_DatagramSocket_Send(out, packets[0], NULL);
+        } else {
+            ATX_Cardinal offset = 0;
+            while (offset < received && ATX_SUCCEEDED(result)) {
+                ATX_Cardinal sent = 0;
+                result = ATX_DatagramSocket_SendMany(out, 
+                                                     packets+offset, 
+                                                     NULL, 
+                                                     received-offset, 
+                                                     &sent);
+                offset += sent;
+            }
+        }
+        if (ATX_FAILED(result)) {
+            fprintf(stderr, "ERROR: send failed (%d)\n", result);
+            break;
+        }
+
+        /* update the stats */
+        packet_count += received;
+        for (i=0; i<received; i++) {
+            byte_count += ATX_DataBuffer_GetDataSize(packets[i]);
+        }
+
+        /* report once per second */
+        ATX_System_GetCurrentTimeStamp(&now);
+        ATX_TimeStamp_Sub(elapsed, now, report_time);
+        if (elapsed.seconds >= 1) {
+            float seconds = (float)elapsed.seconds + (float)elapsed.nanoseconds/1000000000.0f;
+            fprintf(stderr, 
+                    ":: %.0f packets/s, %.0f bytes/s, %.1f packets per call\n",
+                    (float)packet_count/seconds,
+                    (float)byte_count/seconds,
+                    (float)packet_count/(float)call_count);
+            packet_count = 0;
+            byte_count   = 0;
+            call_count   = 0;
+            report_time  = now;
+        }
+    }
+
+    ATX_DESTROY_OBJECT(in);
+    ATX_DESTROY_OBJECT(out);
+    ATX_RELEASE_OBJECT(out_stream);
+    for (i=0; i<batch_size; i++) {
+        ATX_DataBuffer_Destroy(packets[i]);
+    }
+    free(packets);
+
+    return result;
+}
+
 /*----------------------------------------------------------------------
 |       main
 +---------------------------------------------------------------------*/
@@ -433,6 +561,7 @@ main(int argc, char** argv)
     EndPoint*    current_endpoint = &in_endpoint;
     unsigned int packet_size = PUMP_DEFAULT_PACKET_SIZE;
     unsigned int bitrate = 0;
+    unsigned int batch_size = 0;
 
     if (argc < 2) {
         PrintUsageAndExit();
@@ -455,6 +584,13 @@ main(int argc, char** argv)
         } else if (!strcmp(arg, "-b")) {
             bitrate = strtoul(*argv++, NULL, 10);
             continue;
+        } else if (!strcmp(arg, "-m")) {
+            batch_size = strtoul(*argv++, NULL, 10);
+            if (batch_size == 0) {
+                fprintf(stderr, "ERROR: invalid batch size\n");
+                exit(1);
+            }
+            continue;
         } else if (!strcmp(arg, "udp")) {
             if (argv[0] && argv[1]) {
                 if (!strcmp(argv[0], "server")) {
@@ -577,6 +713,19 @@ main(int argc, char** argv)
         exit(1);
     }
 
+    /* datagram pump */
+    if (batch_size) {
+        if (in_endpoint.type != ENDPOINT_TYPE_UDP_SERVER &&
+            in_endpoint.type != ENDPOINT_TYPE_MULTICAST_SERVER) {
+            fprintf(stderr, "ERROR: -m requires a udp or multicast input\n");
+            exit(1);
+        }
+        return ATX_FAILED(PumpDatagrams(&in_endpoint, 
+                                        &out_endpoint, 
+                                        packet_size, 
+                                        batch_size)) ? 1 : 0;
+    }
+
     /* data pump */
     {
         ATX_InputStream*  in;
@@ -608,6 +757,21 @@ main(int argc, char** argv)
             exit(1);
         }
 
+        /* files are sent to tcp endpoints in one go, which lets the */
+        /* socket pull the data directly from the file when it can   */
+        if (in_endpoint.type == ENDPOINT_TYPE_FILE &&
+            (out_endpoint.type == ENDPOINT_TYPE_TCP_CLIENT ||
+             out_endpoint.type == ENDPOINT_TYPE_TCP_SERVER)) {
+            ATX_LargeSize bytes_copied = 0;
+            result = ATX_Stream_Copy(in, out, 0, &bytes_copied);
+            fprintf(stderr, "[%d] copied %lu bytes\n", 
+                    result, (unsigned long)bytes_copied);
+            ATX_RELEASE_OBJECT(in);
+            ATX_RELEASE_OBJECT(out);
+            free(buffer);
+            return ATX_FAILED(result) ? 1 : 0;
+        }
+
         /* measure the current time */
         /*if (bitrate) gettimeofday(&start, NULL);*/
 
@@ -43,10 +43,12 @@
 #include "AtxTypes.h"
 #include "AtxResults.h"
 #include "AtxUtils.h"
+#include "AtxAllocator.h"
 #include "AtxTime.h"
 #include "AtxDebug.h"
 #include "AtxLogging.h"
 #include "AtxString.h"
+#include "AtxAtom.h"
 #include "AtxInterfaces.h"
 #include "AtxDestroyable.h"
 #include "AtxReferenceable.h"
@@ -0,0 +1,683 @@
+/*****************************************************************
+|
+|   Atomix - Allocators
+|
+| Copyright (c) 2002-2010, Axiomatic Systems, LLC.
+| All rights reserved.
+|
+| Redistribution and use in source and binary forms, with or without
+| modification, are permitted provided that the following conditions are met:
+|     * Redistributions of source code must retain the above copyright
+|       notice, this list of conditions and the following disclaimer.
+|     * Redistributions in binary form must reproduce the above copyright
+|       notice, this list of conditions and the following disclaimer in the
+|       documentation and/or other materials provided with the distribution.
+|     * Neither the name of Axiomatic Systems nor the
+|       names of its contributors may be used to endorse or promote products
+|       derived from this software without specific prior written permission.
+|
+| THIS SOFTWARE IS PROVIDED BY AXIOMATIC SYSTEMS ''AS IS'' AND ANY
+| EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+| WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+| DISCLAIMED. IN NO EVENT SHALL AXIOMATIC SYSTEMS BE LIABLE FOR ANY
+| DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+| (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+| LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+| ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+| (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+| SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+|
+ ****************************************************************/
+
+/*----------------------------------------------------------------------
+|    includes
++---------------------------------------------------------------------*/
+#include "AtxConfig.h"
+#include "AtxAllocator.h"
+#include "AtxUtils.h"
+
+/*----------------------------------------------------------------------
+|    types
++---------------------------------------------------------------------*/
+typedef struct ATX_MemoryPoolChunk {
+    struct ATX_MemoryPoolChunk* next;
+} ATX_MemoryPoolChunk;
+
+typedef struct ATX_MemoryPoolBlock {
+    struct ATX_MemoryPoolBlock* next;
+} ATX_MemoryPoolBlock;
+
+struct ATX_MemoryPool {
+    ATX_Allocator        allocator;
+    const ATX_Allocator* parent;
+    ATX_Size             block_size;
+    ATX_Cardinal         blocks_per_chunk;
+    ATX_MemoryPoolChunk* chunks;
+    ATX_MemoryPoolBlock* free_blocks;
+    ATX_Cardinal         free_count;
+};
+
+typedef struct ATX_MemoryArenaChunk {
+    struct ATX_MemoryArenaChunk* next;
+    ATX_Size                     size;
+    ATX_Size                     used;
+} ATX_MemoryArenaChunk;
+
+struct ATX_MemoryArena {
+    ATX_Allocator         allocator;
+    const ATX_Allocator*  parent;
+    ATX_Size              chunk_size;
+    ATX_MemoryArenaChunk* chunks; /* current chunk first */
+    unsigned char*        last;   /* most recent allocation in the current chunk */
+    ATX_Size              allocated;
+};
+
+/*----------------------------------------------------------------------
+|    constants
++---------------------------------------------------------------------*/
+#define ATX_ALLOCATOR_ALIGNMENT 8
+#define ATX_ALLOCATOR_ALIGN(x) \
+    (((x)+ATX_ALLOCATOR_ALIGNMENT-1) & ~((ATX_Size)ATX_ALLOCATOR_ALIGNMENT-1))
+
+#define ATX_MEMORY_POOL_DEFAULT_BLOCKS_PER_CHUNK 64
+#define ATX_MEMORY_POOL_CHUNK_HEADER_SIZE \
+    ATX_ALLOCATOR_ALIGN(sizeof(ATX_MemoryPoolChunk))
+
+#define ATX_MEMORY_ARENA_DEFAULT_CHUNK_SIZE 4096
+#define ATX_MEMORY_ARENA_CHUNK_HEADER_SIZE \
+    ATX_ALLOCATOR_ALIGN(sizeof(ATX_MemoryArenaChunk))
+#define ATX_MEMORY_ARENA_CHUNK_DATA(c) \
+    (((unsigned char*)(c))+ATX_MEMORY_ARENA_CHUNK_HEADER_SIZE)
+
+/*----------------------------------------------------------------------
+|    C runtime
++---------------------------------------------------------------------*/
+#if defined(ATX_CONFIG_ENABLE_ALLOCATOR_HOOKS)
+#define ATX_ALLOCATOR_MALLOC(size)            malloc(size)
+#define ATX_ALLOCATOR_REALLOC(memory, size)   realloc((memory), (size))
+#define ATX_ALLOCATOR_FREE(memory)            free(memory)
+#else
+#define ATX_ALLOCATOR_MALLOC(size)            ATX_AllocateMemory(size)
+#define ATX_ALLOCATOR_REALLOC(memory, size)   ATX_ReallocateMemory((memory), (size))
+#define ATX_ALLOCATOR_FREE(memory)            ATX_FreeMemory(memory)
+#endif
+
+/*----------------------------------------------------------------------
+|    ATX_DefaultAllocator_Allocate
++---------------------------------------------------------------------*/
+static void*
+ATX_DefaultAllocator_Allocate(void* context, ATX_Size size)
+{
+    ATX_COMPILER_UNUSED(context);
+    return ATX_ALLOCATOR_MALLOC(size);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_DefaultAllocator_Reallocate
++---------------------------------------------------------------------*/
+static void*
+ATX_DefaultAllocator_Reallocate(void* context, void* memory, ATX_Size size)
+{
+    ATX_COMPILER_UNUSED(context);
+    return ATX_ALLOCATOR_REALLOC(memory, size);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_DefaultAllocator_Free
++---------------------------------------------------------------------*/
+static void
+ATX_DefaultAllocator_Free(void* context, void* memory)
+{
+    ATX_COMPILER_UNUSED(context);
+    ATX_ALLOCATOR_FREE(memory);
+}
+
+/*----------------------------------------------------------------------
+|    globals
++---------------------------------------------------------------------*/
+static const ATX_Allocator ATX_DefaultAllocator = {
+    ATX_DefaultAllocator_Allocate,
+    ATX_DefaultAllocator_Reallocate,
+    ATX_DefaultAllocator_Free,
+    NULL
+};
+static const ATX_Allocator* ATX_CurrentAllocator = &ATX_DefaultAllocator;
+
+/*----------------------------------------------------------------------
+|    ATX_SetAllocator
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_SetAllocator(const ATX_Allocator* allocator)
+{
+#if defined(ATX_CONFIG_ENABLE_ALLOCATOR_HOOKS)
+    if (allocator == NULL) {
+        ATX_CurrentAllocator = &ATX_DefaultAllocator;
+        return ATX_SUCCESS;
+    }
+    if (allocator->Allocate   == NULL || 
+        allocator->Reallocate == NULL ||
+        allocator->Free       == NULL) {
+        return ATX_ERROR_INVALID_PARAMETERS;
+    }
+    ATX_CurrentAllocator = allocator;
+
+    return ATX_SUCCESS;
+#else
+    ATX_COMPILER_UNUSED(allocator);
+    return ATX_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+/*----------------------------------------------------------------------
+|    ATX_GetAllocator
++---------------------------------------------------------------------*/
+const ATX_Allocator*
+ATX_GetAllocator(void)
+{
+    return ATX_CurrentAllocator;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_GetDefaultAllocator
++---------------------------------------------------------------------*/
+const ATX_Allocator*
+ATX_GetDefaultAllocator(void)
+{
+    return &ATX_DefaultAllocator;
+}
+
+#if defined(ATX_CONFIG_ENABLE_ALLOCATOR_HOOKS)
+/*----------------------------------------------------------------------
+|    ATX_AllocateMemory
++---------------------------------------------------------------------*/
+void*
+ATX_AllocateMemory(ATX_Size size)
+{
+    return ATX_Allocator_Allocate(ATX_CurrentAllocator, size);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_AllocateZeroMemory
++---------------------------------------------------------------------*/
+void*
+ATX_AllocateZeroMemory(ATX_Size size)
+{
+    void* memory = ATX_Allocator_Allocate(ATX_CurrentAllocator, size);
+    if (memory) ATX_SetMemory(memory, 0, size);
+    return memory;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_ReallocateMemory
++---------------------------------------------------------------------*/
+void*
+ATX_ReallocateMemory(void* memory, ATX_Size size)
+{
+    return ATX_Allocator_Reallocate(ATX_CurrentAllocator, memory, size);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_FreeMemory
++---------------------------------------------------------------------*/
+void
+ATX_FreeMemory(void* memory)
+{
+    if (memory) ATX_Allocator_Free(ATX_CurrentAllocator, memory);
+}
+#endif /* ATX_CONFIG_ENABLE_ALLOCATOR_HOOKS */
+
+#if !defined(ATX_CONFIG_HAVE_STRDUP) || defined(ATX_CONFIG_ENABLE_ALLOCATOR_HOOKS)
+/*----------------------------------------------------------------------
+|    ATX_DuplicateString
++---------------------------------------------------------------------*/
+char*
+ATX_DuplicateString(const char* s)
+{
+    ATX_Size length = ATX_StringLength(s);
+    char*    copy   = (char*)ATX_AllocateMemory(length+1);
+    if (copy) ATX_CopyMemory(copy, s, length+1);
+    return copy;
+}
+#endif
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_Grow
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_MemoryPool_Grow(ATX_MemoryPool* self, ATX_Cardinal block_count)
+{
+    ATX_MemoryPoolChunk* chunk;
+    unsigned char*       block;
+    ATX_Cardinal         i;
+
+    chunk = (ATX_MemoryPoolChunk*)ATX_Allocator_Allocate(self->parent, 
+        ATX_MEMORY_POOL_CHUNK_HEADER_SIZE+self->block_size*block_count);
+    if (chunk == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    chunk->next  = self->chunks;
+    self->chunks = chunk;
+
+    /* thread the new blocks onto the free list, lowest address first */
+    block = ((unsigned char*)chunk)+ATX_MEMORY_POOL_CHUNK_HEADER_SIZE+
+            self->block_size*block_count;
+    for (i=0; i<block_count; i++) {
+        block -= self->block_size;
+        ((ATX_MemoryPoolBlock*)block)->next = self->free_blocks;
+        self->free_blocks = (ATX_MemoryPoolBlock*)block;
+    }
+    self->free_count += block_count;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_AllocateSize
++---------------------------------------------------------------------*/
+static void*
+ATX_MemoryPool_AllocateSize(void* context, ATX_Size size)
+{
+    ATX_MemoryPool* self = (ATX_MemoryPool*)context;
+    if (size > self->block_size) return NULL;
+    return ATX_MemoryPool_Allocate(self);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_Reallocate
++---------------------------------------------------------------------*/
+static void*
+ATX_MemoryPool_Reallocate(void* context, void* memory, ATX_Size size)
+{
+    ATX_MemoryPool* self = (ATX_MemoryPool*)context;
+    if (size > self->block_size) return NULL;
+    if (memory == NULL) return ATX_MemoryPool_Allocate(self);
+
+    /* every block already has the maximum size */
+    return memory;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_FreeBlock
++---------------------------------------------------------------------*/
+static void
+ATX_MemoryPool_FreeBlock(void* context, void* memory)
+{
+    ATX_MemoryPool_Free((ATX_MemoryPool*)context, memory);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_MemoryPool_Create(ATX_Size             block_size,
+                      ATX_Cardinal         blocks_per_chunk,
+                      const ATX_Allocator* parent,
+                      ATX_MemoryPool**     pool)
+{
+    /* check parameters */
+    if (block_size == 0) return ATX_ERROR_INVALID_PARAMETERS;
+    if (parent == NULL) parent = ATX_GetAllocator();
+    if (blocks_per_chunk == 0) blocks_per_chunk = ATX_MEMORY_POOL_DEFAULT_BLOCKS_PER_CHUNK;
+
+    /* allocate the object */
+    *pool = (ATX_MemoryPool*)ATX_Allocator_Allocate(parent, sizeof(ATX_MemoryPool));
+    if (*pool == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* construct the object (chunks are allocated on demand) */
+    if (block_size < sizeof(ATX_MemoryPoolBlock)) block_size = sizeof(ATX_MemoryPoolBlock);
+    (*pool)->allocator.Allocate   = ATX_MemoryPool_AllocateSize;
+    (*pool)->allocator.Reallocate = ATX_MemoryPool_Reallocate;
+    (*pool)->allocator.Free       = ATX_MemoryPool_FreeBlock;
+    (*pool)->allocator.context    = *pool;
+    (*pool)->parent               = parent;
+    (*pool)->block_size           = ATX_ALLOCATOR_ALIGN(block_size);
+    (*pool)->blocks_per_chunk     = blocks_per_chunk;
+    (*pool)->chunks               = NULL;
+    (*pool)->free_blocks          = NULL;
+    (*pool)->free_count           = 0;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_MemoryPool_Destroy(ATX_MemoryPool* self)
+{
+    const ATX_Allocator* parent = self->parent;
+    ATX_MemoryPoolChunk* chunk  = self->chunks;
+
+    while (chunk) {
+        ATX_MemoryPoolChunk* next = chunk->next;
+        ATX_Allocator_Free(parent, chunk);
+        chunk = next;
+    }
+    ATX_Allocator_Free(parent, self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_Allocate
++---------------------------------------------------------------------*/
+void*
+ATX_MemoryPool_Allocate(ATX_MemoryPool* self)
+{
+    ATX_MemoryPoolBlock* block;
+
+    if (self->free_blocks == NULL) {
+        if (ATX_FAILED(ATX_MemoryPool_Grow(self, self->blocks_per_chunk))) return NULL;
+    }
+    block = self->free_blocks;
+    self->free_blocks = block->next;
+    --self->free_count;
+
+    return block;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_Free
++---------------------------------------------------------------------*/
+void
+ATX_MemoryPool_Free(ATX_MemoryPool* self, void* block)
+{
+    if (block == NULL) return;
+    ((ATX_MemoryPoolBlock*)block)->next = self->free_blocks;
+    self->free_blocks = (ATX_MemoryPoolBlock*)block;
+    ++self->free_count;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_Reserve
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_MemoryPool_Reserve(ATX_MemoryPool* self, ATX_Cardinal block_count)
+{
+    if (block_count <= self->free_count) return ATX_SUCCESS;
+    return ATX_MemoryPool_Grow(self, block_count-self->free_count);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_GetFreeCount
++---------------------------------------------------------------------*/
+ATX_Cardinal
+ATX_MemoryPool_GetFreeCount(ATX_MemoryPool* self)
+{
+    return self->free_count;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_GetBlockSize
++---------------------------------------------------------------------*/
+ATX_Size
+ATX_MemoryPool_GetBlockSize(ATX_MemoryPool* self)
+{
+    return self->block_size;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryPool_GetAllocator
++---------------------------------------------------------------------*/
+const ATX_Allocator*
+ATX_MemoryPool_GetAllocator(ATX_MemoryPool* self)
+{
+    return &self->allocator;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_AllocateChunk
++---------------------------------------------------------------------*/
+static ATX_MemoryArenaChunk*
+ATX_MemoryArena_AllocateChunk(ATX_MemoryArena* self, ATX_Size size)
+{
+    ATX_MemoryArenaChunk* chunk;
+
+    chunk = (ATX_MemoryArenaChunk*)ATX_Allocator_Allocate(self->parent, 
+                                                          ATX_MEMORY_ARENA_CHUNK_HEADER_SIZE+size);
+    if (chunk == NULL) return NULL;
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+
+    return chunk;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_Allocate
++---------------------------------------------------------------------*/
+void*
+ATX_MemoryArena_Allocate(ATX_MemoryArena* self, ATX_Size size)
+{
+    ATX_MemoryArenaChunk* chunk = self->chunks;
+    unsigned char*        memory;
+
+    size = size ? ATX_ALLOCATOR_ALIGN(size) : ATX_ALLOCATOR_ALIGNMENT;
+    if (chunk == NULL || chunk->used+size > chunk->size) {
+        if (chunk && size > self->chunk_size/2) {
+            /* large allocations get their own chunk, behind the current
+               one, so that the space left in the current one isn't lost */
+            ATX_MemoryArenaChunk* large = ATX_MemoryArena_AllocateChunk(self, size);
+            if (large == NULL) return NULL;
+            large->used = size;
+            large->next = chunk->next;
+            chunk->next = large;
+            self->allocated += size;
+            return ATX_MEMORY_ARENA_CHUNK_DATA(large);
+        }
+        chunk = ATX_MemoryArena_AllocateChunk(self, 
+                                              size > self->chunk_size ? size : self->chunk_size);
+        if (chunk == NULL) return NULL;
+        chunk->next  = self->chunks;
+        self->chunks = chunk;
+    }
+    memory = ATX_MEMORY_ARENA_CHUNK_DATA(chunk)+chunk->used;
+    chunk->used     += size;
+    self->allocated += size;
+    self->last       = memory;
+
+    return memory;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_AllocateSize
++---------------------------------------------------------------------*/
+static void*
+ATX_MemoryArena_AllocateSize(void* context, ATX_Size size)
+{
+    return ATX_MemoryArena_Allocate((ATX_MemoryArena*)context, size);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_Reallocate
++---------------------------------------------------------------------*/
+static void*
+ATX_MemoryArena_Reallocate(void* context, void* memory, ATX_Size size)
+{
+    ATX_MemoryArena*      self  = (ATX_MemoryArena*)context;
+    ATX_MemoryArenaChunk* chunk = self->chunks;
+    unsigned char*        bytes = (unsigned char*)memory;
+    ATX_Size              available;
+    void*                 copy;
+
+    if (memory == NULL) return ATX_MemoryArena_Allocate(self, size);
+
+    /* the most recent allocation can grow or shrink in place */
+    if (bytes == self->last) {
+        ATX_Size offset  = (ATX_Size)(bytes-ATX_MEMORY_ARENA_CHUNK_DATA(chunk));
+        ATX_Size aligned = size ? ATX_ALLOCATOR_ALIGN(size) : ATX_ALLOCATOR_ALIGNMENT;
+        if (offset+aligned <= chunk->size) {
+            self->allocated = self->allocated-(chunk->used-offset)+aligned;
+            chunk->used     = offset+aligned;
+            return memory;
+        }
+    }
+
+    /* find the chunk of the allocation. Allocation sizes aren't 
+       recorded, so copy as much as the new size needs, up to the end of 
+       what was allocated from that chunk: any bytes past the original
+       allocation belong to the arena and are safe to read */
+    while (chunk) {
+        unsigned char* data = ATX_MEMORY_ARENA_CHUNK_DATA(chunk);
+        if (bytes >= data && bytes < data+chunk->used) break;
+        chunk = chunk->next;
+    }
+    if (chunk == NULL) return NULL;
+    available = chunk->used-(ATX_Size)(bytes-ATX_MEMORY_ARENA_CHUNK_DATA(chunk));
+
+    copy = ATX_MemoryArena_Allocate(self, size);
+    if (copy == NULL) return NULL;
+    ATX_CopyMemory(copy, memory, size < available ? size : available);
+
+    return copy;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_Free
++---------------------------------------------------------------------*/
+static void
+ATX_MemoryArena_Free(void* context, void* memory)
+{
+    ATX_MemoryArena* self = (ATX_MemoryArena*)context;
+
+    /* only the most recent allocation can be given back */
+    if (memory != NULL && memory == self->last) {
+        ATX_MemoryArenaChunk* chunk  = self->chunks;
+        ATX_Size              offset = (ATX_Size)(self->last-ATX_MEMORY_ARENA_CHUNK_DATA(chunk));
+        self->allocated -= chunk->used-offset;
+        chunk->used      = offset;
+        self->last       = NULL;
+    }
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_MemoryArena_Create(ATX_Size             chunk_size,
+                       const ATX_Allocator* parent,
+                       ATX_MemoryArena**    arena)
+{
+    if (parent == NULL) parent = ATX_GetAllocator();
+    if (chunk_size == 0) chunk_size = ATX_MEMORY_ARENA_DEFAULT_CHUNK_SIZE;
+
+    /* allocate the object */
+    *arena = (ATX_MemoryArena*)ATX_Allocator_Allocate(parent, sizeof(ATX_MemoryArena));
+    if (*arena == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* construct the object (chunks are allocated on demand) */
+    (*arena)->allocator.Allocate   = ATX_MemoryArena_AllocateSize;
+    (*arena)->allocator.Reallocate = ATX_MemoryArena_Reallocate;
+    (*arena)->allocator.Free       = ATX_MemoryArena_Free;
+    (*arena)->allocator.context    = *arena;
+    (*arena)->parent               = parent;
+    (*arena)->chunk_size           = ATX_ALLOCATOR_ALIGN(chunk_size);
+    (*arena)->chunks               = NULL;
+    (*arena)->last                 = NULL;
+    (*arena)->allocated            = 0;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_MemoryArena_Destroy(ATX_MemoryArena* self)
+{
+    const ATX_Allocator*  parent = self->parent;
+    ATX_MemoryArenaChunk* chunk  = self->chunks;
+
+    while (chunk) {
+        ATX_MemoryArenaChunk* next = chunk->next;
+        ATX_Allocator_Free(parent, chunk);
+        chunk = next;
+    }
+    ATX_Allocator_Free(parent, self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_Reset
++---------------------------------------------------------------------*/
+void
+ATX_MemoryArena_Reset(ATX_MemoryArena* self)
+{
+    ATX_MemoryArenaChunk* chunk = self->chunks;
+    ATX_MemoryArenaChunk* keep  = NULL;
+
+    /* keep one regular chunk, release all the others */
+    while (chunk) {
+        ATX_MemoryArenaChunk* next = chunk->next;
+        if (keep == NULL && chunk->size == self->chunk_size) {
+            keep = chunk;
+        } else {
+            ATX_Allocator_Free(self->parent, chunk);
+        }
+        chunk = next;
+    }
+    if (keep) {
+        keep->next = NULL;
+        keep->used = 0;
+    }
+    self->chunks    = keep;
+    self->last      = NULL;
+    self->allocated = 0;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_GetMark
++---------------------------------------------------------------------*/
+void
+ATX_MemoryArena_GetMark(ATX_MemoryArena* self, ATX_MemoryArenaMark* mark)
+{
+    mark->chunk     = self->chunks;
+    mark->next      = self->chunks?self->chunks->next:NULL;
+    mark->used      = self->chunks?self->chunks->used:0;
+    mark->allocated = self->allocated;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_Rewind
++---------------------------------------------------------------------*/
+void
+ATX_MemoryArena_Rewind(ATX_MemoryArena* self, const ATX_MemoryArenaMark* mark)
+{
+    ATX_MemoryArenaChunk* chunk;
+
+    /* release the chunks that became current after the mark */
+    while (self->chunks != mark->chunk) {
+        chunk        = self->chunks;
+        self->chunks = chunk->next;
+        ATX_Allocator_Free(self->parent, chunk);
+    }
+
+    /* and the large chunks inserted behind the marked one */
+    if (self->chunks) {
+        while (self->chunks->next != mark->next) {
+            chunk              = self->chunks->next;
+            self->chunks->next = chunk->next;
+            ATX_Allocator_Free(self->parent, chunk);
+        }
+        self->chunks->used = mark->used;
+    }
+    self->last      = NULL;
+    self->allocated = mark->allocated;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_GetSize
++---------------------------------------------------------------------*/
+ATX_Size
+ATX_MemoryArena_GetSize(ATX_MemoryArena* self)
+{
+    return self->allocated;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MemoryArena_GetAllocator
++---------------------------------------------------------------------*/
+const ATX_Allocator*
+ATX_MemoryArena_GetAllocator(ATX_MemoryArena* self)
+{
+    return &self->allocator;
+}
@@ -0,0 +1,187 @@
+/*****************************************************************
+|
+|   Atomix - Allocators
+|
+| Copyright (c) 2002-2010, Axiomatic Systems, LLC.
+| All rights reserved.
+|
+| Redistribution and use in source and binary forms, with or without
+| modification, are permitted provided that the following conditions are met:
+|     * Redistributions of source code must retain the above copyright
+|       notice, this list of conditions and the following disclaimer.
+|     * Redistributions in binary form must reproduce the above copyright
+|       notice, this list of conditions and the following disclaimer in the
+|       documentation and/or other materials provided with the distribution.
+|     * Neither the name of Axiomatic Systems nor the
+|       names of its contributors may be used to endorse or promote products
+|       derived from this software without specific prior written permission.
+|
+| THIS SOFTWARE IS PROVIDED BY AXIOMATIC SYSTEMS ''AS IS'' AND ANY
+| EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+| WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+| DISCLAIMED. IN NO EVENT SHALL AXIOMATIC SYSTEMS BE LIABLE FOR ANY
+| DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+| (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+| LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+| ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+| (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+| SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+|
+ ****************************************************************/
+/** @file
+ * Memory allocators.
+ *
+ * All the memory used by the library is obtained through 
+ * ATX_AllocateMemory/ATX_ReallocateMemory/ATX_FreeMemory, which call
+ * the allocator installed with ATX_SetAllocator (malloc/realloc/free
+ * by default). 
+ *
+ * Two special-purpose allocators can also be given to a subsystem:
+ * a pool, which hands out blocks of a single size from a free list,
+ * and an arena, which carves allocations out of large chunks and 
+ * releases them all at once.
+ */
+
+#ifndef _ATX_ALLOCATOR_H_
+#define _ATX_ALLOCATOR_H_
+
+/*----------------------------------------------------------------------
+|    includes
++---------------------------------------------------------------------*/
+#include "AtxTypes.h"
+#include "AtxResults.h"
+
+/*----------------------------------------------------------------------
+|    types
++---------------------------------------------------------------------*/
+/**
+ * An allocator. The context is passed back to each of the functions.
+ * Reallocate follows the semantics of realloc: a NULL memory pointer 
+ * allocates, and the contents are preserved up to the smaller of the
+ * old and new sizes.
+ */
+typedef struct {
+    void* (*Allocate)(void* context, ATX_Size size);
+    void* (*Reallocate)(void* context, void* memory, ATX_Size size);
+    void  (*Free)(void* context, void* memory);
+    void* context;
+} ATX_Allocator;
+
+/**
+ * Pool of fixed-size blocks. Allocating and freeing a block are O(1)
+ * and never touch the parent allocator once the pool has grown to its
+ * working size. Pools are not thread-safe.
+ */
+typedef struct ATX_MemoryPool ATX_MemoryPool;
+
+/**
+ * Bump allocator. Allocations are carved out of large chunks and are
+ * released all at once when the arena is reset or destroyed; freeing
+ * an individual allocation only reclaims it if it was the most recent
+ * one. Arenas are not thread-safe.
+ */
+typedef struct ATX_MemoryArena ATX_MemoryArena;
+
+/**
+ * Position in an arena, to which the arena can be rewound.
+ */
+typedef struct {
+    struct ATX_MemoryArenaChunk* chunk;
+    struct ATX_MemoryArenaChunk* next;
+    ATX_Size                     used;
+    ATX_Size                     allocated;
+} ATX_MemoryArenaMark;
+
+/*----------------------------------------------------------------------
+|    macros
++---------------------------------------------------------------------*/
+#define ATX_Allocator_Allocate(a, size) \
+    ((a)->Allocate((a)->context, (size)))
+#define ATX_Allocator_Reallocate(a, memory, size) \
+    ((a)->Reallocate((a)->context, (memory), (size)))
+#define ATX_Allocator_Free(a, memory) \
+    ((a)->Free((a)->context, (memory)))
+
+/*----------------------------------------------------------------------
+|    prototypes
++---------------------------------------------------------------------*/
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Install the allocator used by the library, or restore the default
+ * one if allocator is NULL. The allocator object must remain valid
+ * until it is replaced. Since memory must be freed by the allocator
+ * that allocated it, this should be called before any other function
+ * of the library, or at a point where no library object is alive.
+ * Returns ATX_ERROR_NOT_SUPPORTED if the library was built with
+ * ATX_CONFIG_DISABLE_ALLOCATOR_HOOKS.
+ */
+ATX_Result           ATX_SetAllocator(const ATX_Allocator* allocator);
+const ATX_Allocator* ATX_GetAllocator(void);
+const ATX_Allocator* ATX_GetDefaultAllocator(void);
+
+/**
+ * Create a pool of blocks of block_size bytes. The pool grows by 
+ * chunks of blocks_per_chunk blocks obtained from the parent allocator
+ * (the current allocator if parent is NULL).
+ */
+ATX_Result           ATX_MemoryPool_Create(ATX_Size             block_size,
+                                           ATX_Cardinal         blocks_per_chunk,
+                                           const ATX_Allocator* parent,
+                                           ATX_MemoryPool**     pool);
+ATX_Result           ATX_MemoryPool_Destroy(ATX_MemoryPool* self);
+void*                ATX_MemoryPool_Allocate(ATX_MemoryPool* self);
+void                 ATX_MemoryPool_Free(ATX_MemoryPool* self, void* block);
+ATX_Size             ATX_MemoryPool_GetBlockSize(ATX_MemoryPool* self);
+
+/**
+ * Make sure that at least block_count blocks can be allocated without 
+ * growing the pool. The missing blocks are obtained in a single chunk.
+ */
+ATX_Result           ATX_MemoryPool_Reserve(ATX_MemoryPool* self, ATX_Cardinal block_count);
+ATX_Cardinal         ATX_MemoryPool_GetFreeCount(ATX_MemoryPool* self);
+
+/**
+ * Get an allocator view of the pool. Requests larger than the block 
+ * size fail.
+ */
+const ATX_Allocator* ATX_MemoryPool_GetAllocator(ATX_MemoryPool* self);
+
+/**
+ * Create an arena that grows by chunks of chunk_size bytes obtained
+ * from the parent allocator (the current allocator if parent is NULL).
+ * Allocations larger than a chunk get a chunk of their own.
+ */
+ATX_Result           ATX_MemoryArena_Create(ATX_Size             chunk_size,
+                                            const ATX_Allocator* parent,
+                                            ATX_MemoryArena**    arena);
+ATX_Result           ATX_MemoryArena_Destroy(ATX_MemoryArena* self);
+void*                ATX_MemoryArena_Allocate(ATX_MemoryArena* self, ATX_Size size);
+
+/**
+ * Release all the allocations at once. One chunk is kept so that the
+ * arena can be reused without going back to the parent allocator.
+ */
+void                 ATX_MemoryArena_Reset(ATX_MemoryArena* self);
+
+/**
+ * Record the current position of the arena, and later release 
+ * everything allocated since then, for example to undo a failed 
+ * operation. A mark can't be used after the arena has been reset.
+ */
+void                 ATX_MemoryArena_GetMark(ATX_MemoryArena* self, ATX_MemoryArenaMark* mark);
+void                 ATX_MemoryArena_Rewind(ATX_MemoryArena* self, const ATX_MemoryArenaMark* mark);
+
+/**
+ * Get the number of bytes currently allocated from the arena.
+ */
+ATX_Size             ATX_MemoryArena_GetSize(ATX_MemoryArena* self);
+const ATX_Allocator* ATX_MemoryArena_GetAllocator(ATX_MemoryArena* self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ATX_ALLOCATOR_H_ */
@@ -0,0 +1,329 @@
+/*****************************************************************
+|
+|   Atomix - Atoms
+|
+| Copyright (c) 2002-2010, Axiomatic Systems, LLC.
+| All rights reserved.
+|
+| Redistribution and use in source and binary forms, with or without
+| modification, are permitted provided that the following conditions are met:
+|     * Redistributions of source code must retain the above copyright
+|       notice, this list of conditions and the following disclaimer.
+|     * Redistributions in binary form must reproduce the above copyright
+|       notice, this list of conditions and the following disclaimer in the
+|       documentation and/or other materials provided with the distribution.
+|     * Neither the name of Axiomatic Systems nor the
+|       names of its contributors may be used to endorse or promote products
+|       derived from this software without specific prior written permission.
+|
+| THIS SOFTWARE IS PROVIDED BY AXIOMATIC SYSTEMS ''AS IS'' AND ANY
+| EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+| WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+| DISCLAIMED. IN NO EVENT SHALL AXIOMATIC SYSTEMS BE LIABLE FOR ANY
+| DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+| (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+| LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+| ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+| (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+| SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+|
+ ****************************************************************/
+
+/*----------------------------------------------------------------------
+|    includes
++---------------------------------------------------------------------*/
+#include "AtxConfig.h"
+#include "AtxAtom.h"
+#include "AtxUtils.h"
+#include "AtxThreads.h"
+
+/*----------------------------------------------------------------------
+|    types
++---------------------------------------------------------------------*/
+struct ATX_AtomEntry {
+    struct ATX_AtomEntry*       next;
+    const struct ATX_AtomEntry* caseless;
+    ATX_UInt32                  hash;
+    ATX_Size                    length;
+    char                        chars[1]; /* more characters follow */
+};
+
+typedef struct {
+    struct ATX_AtomEntry** buckets;
+    ATX_Cardinal           bucket_count;
+    ATX_Cardinal           atom_count;
+} ATX_AtomTable;
+
+/*----------------------------------------------------------------------
+|    constants
++---------------------------------------------------------------------*/
+#define ATX_ATOM_TABLE_INITIAL_BUCKET_COUNT 256
+
+/*----------------------------------------------------------------------
+|    macros
++---------------------------------------------------------------------*/
+#define ATX_ATOM_LOWERCASE(x) (((x) >= 'A' && (x) <= 'Z') ? (x)^32 : (x))
+
+/*----------------------------------------------------------------------
+|    globals
++---------------------------------------------------------------------*/
+static ATX_Mutex*    ATX_AtomTable_Lock = NULL;
+static ATX_AtomTable ATX_AtomTable_Instance = { NULL, 0, 0 };
+
+/*----------------------------------------------------------------------
+|    ATX_Atom_Hash
+|
+|    FNV-1a, optionally on the lowercase characters
++---------------------------------------------------------------------*/
+static ATX_UInt32
+ATX_Atom_Hash(const char* chars, ATX_Size length, ATX_Boolean lowercase)
+{
+    ATX_UInt32 hash = 2166136261U;
+    ATX_Size   i;
+    for (i=0; i<length; i++) {
+        unsigned char c = (unsigned char)chars[i];
+        if (lowercase) c = ATX_ATOM_LOWERCASE(c);
+        hash = (hash^c)*16777619U;
+    }
+    return hash;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_AtomTable_Lookup
+|
+|    the table must be locked
++---------------------------------------------------------------------*/
+static struct ATX_AtomEntry*
+ATX_AtomTable_Lookup(ATX_AtomTable* self, 
+                     const char*    chars, 
+                     ATX_Size       length, 
+                     ATX_UInt32     hash)
+{
+    struct ATX_AtomEntry* entry;
+    if (self->buckets == NULL) return NULL;
+    for (entry = self->buckets[hash&(self->bucket_count-1)]; entry; entry = entry->next) {
+        if (entry->hash == hash && 
+            entry->length == length && 
+            ATX_MemoryEqual(entry->chars, chars, length)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_AtomTable_Grow
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_AtomTable_Grow(ATX_AtomTable* self)
+{
+    ATX_Cardinal           bucket_count = self->bucket_count ? 
+                                          2*self->bucket_count : 
+                                          ATX_ATOM_TABLE_INITIAL_BUCKET_COUNT;
+    struct ATX_AtomEntry** buckets;
+    ATX_Cardinal           i;
+
+    buckets = (struct ATX_AtomEntry**)ATX_AllocateZeroMemory(bucket_count*sizeof(struct ATX_AtomEntry*));
+    if (buckets == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* move the entries to the new buckets */
+    for (i=0; i<self->bucket_count; i++) {
+        struct ATX_AtomEntry* entry = self->buckets[i];
+        while (entry) {
+            struct ATX_AtomEntry* next = entry->next;
+            ATX_Cardinal          bucket = entry->hash&(bucket_count-1);
+            entry->next = buckets[bucket];
+            buckets[bucket] = entry;
+            entry = next;
+        }
+    }
+    if (self->buckets) ATX_FreeMemory(self->buckets);
+    self->buckets      = buckets;
+    self->bucket_count = bucket_count;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_AtomTable_Intern
+|
+|    the table must be locked
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_AtomTable_Intern(ATX_AtomTable*         self, 
+                     const char*            chars, 
+                     ATX_Size               length, 
+                     struct ATX_AtomEntry** atom)
+{
+    ATX_UInt32            hash = ATX_Atom_Hash(chars, length, ATX_FALSE);
+    struct ATX_AtomEntry* entry;
+    ATX_Size              i;
+
+    /* check if the atom already exists */
+    entry = ATX_AtomTable_Lookup(self, chars, length, hash);
+    if (entry) {
+        *atom = entry;
+        return ATX_SUCCESS;
+    }
+
+    /* keep the load factor under 1 */
+    if (self->atom_count >= self->bucket_count) {
+        ATX_CHECK(ATX_AtomTable_Grow(self));
+    }
+
+    /* create a new entry */
+    entry = (struct ATX_AtomEntry*)ATX_AllocateMemory(sizeof(struct ATX_AtomEntry)+length);
+    if (entry == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    entry->hash   = hash;
+    entry->length = length;
+    ATX_CopyMemory(entry->chars, chars, length);
+    entry->chars[length] = '\0';
+
+    /* find or create the caseless atom */
+    entry->caseless = entry;
+    for (i=0; i<length; i++) {
+        if (chars[i] >= 'A' && chars[i] <= 'Z') break;
+    }
+    if (i != length) {
+        struct ATX_AtomEntry* caseless = NULL;
+        ATX_Result            result;
+        for (i=0; i<length; i++) {
+            entry->chars[i] = ATX_ATOM_LOWERCASE(chars[i]);
+        }
+        result = ATX_AtomTable_Intern(self, entry->chars, length, &caseless);
+        if (ATX_FAILED(result)) {
+            ATX_FreeMemory(entry);
+            return result;
+        }
+        ATX_CopyMemory(entry->chars, chars, length);
+        entry->caseless = caseless;
+    }
+
+    /* add the entry to the table */
+    {
+        ATX_Cardinal bucket = hash&(self->bucket_count-1);
+        entry->next = self->buckets[bucket];
+        self->buckets[bucket] = entry;
+        ++self->atom_count;
+    }
+
+    *atom = entry;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Atom_InternN
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Atom_InternN(const char* chars, ATX_Size length, ATX_Atom* atom)
+{
+    struct ATX_AtomEntry* entry = NULL;
+    ATX_Result            result;
+
+    *atom = NULL;
+    if (chars == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+
+    ATX_CHECK(ATX_Mutex_LockAutoCreate(&ATX_AtomTable_Lock));
+    result = ATX_AtomTable_Intern(&ATX_AtomTable_Instance, chars, length, &entry);
+    ATX_Mutex_Unlock(ATX_AtomTable_Lock);
+
+    *atom = entry;
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Atom_Intern
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Atom_Intern(const char* name, ATX_Atom* atom)
+{
+    if (name == NULL) {
+        *atom = NULL;
+        return ATX_ERROR_INVALID_PARAMETERS;
+    }
+    return ATX_Atom_InternN(name, ATX_StringLength(name), atom);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Atom_Find
++---------------------------------------------------------------------*/
+ATX_Atom
+ATX_Atom_Find(const char* name)
+{
+    ATX_Size              length;
+    struct ATX_AtomEntry* entry;
+
+    if (name == NULL) return NULL;
+    length = ATX_StringLength(name);
+
+    if (ATX_FAILED(ATX_Mutex_LockAutoCreate(&ATX_AtomTable_Lock))) return NULL;
+    entry = ATX_AtomTable_Lookup(&ATX_AtomTable_Instance, 
+                                 name, 
+                                 length, 
+                                 ATX_Atom_Hash(name, length, ATX_FALSE));
+    ATX_Mutex_Unlock(ATX_AtomTable_Lock);
+
+    return entry;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Atom_FindCaseless
++---------------------------------------------------------------------*/
+ATX_Atom
+ATX_Atom_FindCaseless(const char* name)
+{
+    ATX_AtomTable*        self = &ATX_AtomTable_Instance;
+    ATX_Size              length;
+    ATX_UInt32            hash;
+    struct ATX_AtomEntry* entry = NULL;
+
+    if (name == NULL) return NULL;
+    length = ATX_StringLength(name);
+    hash   = ATX_Atom_Hash(name, length, ATX_TRUE);
+
+    /* caseless atoms are lowercase, so the lowercase hash finds them */
+    if (ATX_FAILED(ATX_Mutex_LockAutoCreate(&ATX_AtomTable_Lock))) return NULL;
+    if (self->buckets) {
+        for (entry = self->buckets[hash&(self->bucket_count-1)]; entry; entry = entry->next) {
+            if (entry->hash == hash && 
+                entry->length == length &&
+                entry->caseless == entry) {
+                ATX_Size i;
+                for (i=0; i<length; i++) {
+                    if (entry->chars[i] != ATX_ATOM_LOWERCASE(name[i])) break;
+                }
+                if (i == length) break;
+            }
+        }
+    }
+    ATX_Mutex_Unlock(ATX_AtomTable_Lock);
+
+    return entry;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Atom_GetCaseless
++---------------------------------------------------------------------*/
+ATX_Atom
+ATX_Atom_GetCaseless(ATX_Atom self)
+{
+    return self ? self->caseless : NULL;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Atom_GetChars
++---------------------------------------------------------------------*/
+const char*
+ATX_Atom_GetChars(ATX_Atom self)
+{
+    return self ? self->chars : "";
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Atom_GetLength
++---------------------------------------------------------------------*/
+ATX_Size
+ATX_Atom_GetLength(ATX_Atom self)
+{
+    return self ? self->length : 0;
+}
@@ -0,0 +1,96 @@
+/*****************************************************************
+|
+|   Atomix - Atoms
+|
+| Copyright (c) 2002-2010, Axiomatic Systems, LLC.
+| All rights reserved.
+|
+| Redistribution and use in source and binary forms, with or without
+| modification, are permitted provided that the following conditions are met:
+|     * Redistributions of source code must retain the above copyright
+|       notice, this list of conditions and the following disclaimer.
+|     * Redistributions in binary form must reproduce the above copyright
+|       notice, this list of conditions and the following disclaimer in the
+|       documentation and/or other materials provided with the distribution.
+|     * Neither the name of Axiomatic Systems nor the
+|       names of its contributors may be used to endorse or promote products
+|       derived from this software without specific prior written permission.
+|
+| THIS SOFTWARE IS PROVIDED BY AXIOMATIC SYSTEMS ''AS IS'' AND ANY
+| EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+| WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+| DISCLAIMED. IN NO EVENT SHALL AXIOMATIC SYSTEMS BE LIABLE FOR ANY
+| DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+| (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+| LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+| ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+| (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+| SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+|
+ ****************************************************************/
+/** @file
+ * Interned strings.
+ *
+ * An atom is the unique, immutable copy of a string held in a global
+ * table. Interning the same characters always returns the same atom,
+ * so two names can be compared with a single pointer compare once they
+ * have been interned. Atoms live until the process exits, so they 
+ * should be used for identifiers from a bounded set (logger names,
+ * header names, property names), not for arbitrary data.
+ * All the functions are thread-safe.
+ */
+
+#ifndef _ATX_ATOM_H_
+#define _ATX_ATOM_H_
+
+/*----------------------------------------------------------------------
+|    includes
++---------------------------------------------------------------------*/
+#include "AtxTypes.h"
+#include "AtxResults.h"
+
+/*----------------------------------------------------------------------
+|    types
++---------------------------------------------------------------------*/
+typedef const struct ATX_AtomEntry* ATX_Atom;
+
+/*----------------------------------------------------------------------
+|    prototypes
++---------------------------------------------------------------------*/
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Get the atom for a string, adding it to the table if needed.
+ */
+ATX_Result ATX_Atom_Intern(const char* name, ATX_Atom* atom);
+ATX_Result ATX_Atom_InternN(const char* chars, ATX_Size length, ATX_Atom* atom);
+
+/**
+ * Get the atom for a string if it has already been interned.
+ * Returns NULL otherwise: since nothing can be keyed by an atom that
+ * doesn't exist, a lookup can stop right there.
+ */
+ATX_Atom ATX_Atom_Find(const char* name);
+
+/**
+ * Get the caseless atom for a string if it has already been interned,
+ * regardless of the case of the characters. Returns NULL otherwise.
+ */
+ATX_Atom ATX_Atom_FindCaseless(const char* name);
+
+/**
+ * Get the caseless atom of an atom: the atom of its lowercase form. 
+ * Atoms whose strings differ only by case have the same caseless atom.
+ */
+ATX_Atom ATX_Atom_GetCaseless(ATX_Atom self);
+
+const char* ATX_Atom_GetChars(ATX_Atom self);
+ATX_Size    ATX_Atom_GetLength(ATX_Atom self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ATX_ATOM_H_ */
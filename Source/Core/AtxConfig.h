@@ -70,8 +70,10 @@
 #define ATX_CONFIG_HAVE_MEMMOVE
 #define ATX_CONFIG_HAVE_MEMSET
 #define ATX_CONFIG_HAVE_MEMCMP
+#define ATX_CONFIG_HAVE_MEMCHR
 #define ATX_CONFIG_HAVE_ATEXIT
 #define ATX_CONFIG_HAVE_GETENV
+#define ATX_CONFIG_HAVE_STRTOD
 #endif /* ATX_CONFIG_HAS_STD_C */
 
 #if defined(ATX_CONFIG_HAVE_STRING_H)
@@ -116,6 +118,9 @@
 #define ATX_LocalFunctionName __FUNCTION__
 #define ATX_COMPILER_UNUSED(p) (void)p
 #define ATX_CONFIG_HAVE_STDINT_H
+#if defined(__x86_64__) || defined(__i386__)
+#define ATX_CONFIG_HAVE_X86_SIMD /* SSE2/AVX2, selected at runtime */
+#endif
 #else
 #define ATX_COMPILER_UNUSED(p) 
 #endif
@@ -177,6 +182,11 @@
 
 #if defined(__linux__) 
 #define ATX_CONFIG_HAVE_GETADDRINFO
+#define ATX_CONFIG_HAVE_EPOLL
+#define ATX_CONFIG_HAVE_EVENTFD
+#define ATX_CONFIG_HAVE_RECVMMSG
+#define ATX_CONFIG_HAVE_SENDMMSG
+#define ATX_CONFIG_HAVE_SENDFILE
 #endif
 
 #if defined(__APPLE__)
@@ -237,6 +247,14 @@
 #define ATX_LocalFunctionName (NULL)
 #endif
 
+/* route allocations through a runtime-installable allocator */
+#if defined(ATX_CONFIG_HAVE_MALLOC)  && \
+    defined(ATX_CONFIG_HAVE_REALLOC) && \
+    defined(ATX_CONFIG_HAVE_FREE)    && \
+    !defined(ATX_CONFIG_DISABLE_ALLOCATOR_HOOKS)
+#define ATX_CONFIG_ENABLE_ALLOCATOR_HOOKS
+#endif
+
 #if !defined(ATX_fseek)
 #define ATX_fseek fseeko
 #endif
@@ -48,6 +48,7 @@
 #define ATX_FILE_OPEN_MODE_TRUNCATE   0x08
 #define ATX_FILE_OPEN_MODE_APPEND     0x10
 #define ATX_FILE_OPEN_MODE_UNBUFFERED 0x20
+#define ATX_FILE_OPEN_MODE_SYNC       0x40 /* Flush also writes to storage */
 
 #define ATX_ERROR_NO_SUCH_FILE       (ATX_ERROR_BASE_FILE - 0)
 #define ATX_ERROR_FILE_NOT_OPEN      (ATX_ERROR_BASE_FILE - 1)
@@ -97,6 +98,8 @@ extern "C" {
 #endif /* __cplusplus */
 
 extern ATX_Result ATX_File_Create(ATX_CString name, ATX_File** file);
+extern ATX_Result ATX_File_Rename(ATX_CString old_name, ATX_CString new_name);
+extern ATX_Result ATX_File_Remove(ATX_CString name);
 extern ATX_Result ATX_File_Load(ATX_File* file, ATX_DataBuffer** buffer);
 extern ATX_Result ATX_File_Save(ATX_File* file, ATX_DataBuffer* buffer);
 
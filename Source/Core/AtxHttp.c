@@ -36,10 +36,14 @@
 #include "AtxDefs.h"
 #include "AtxResults.h"
 #include "AtxUtils.h"
+#include "AtxAtom.h"
 #include "AtxInterfaces.h"
 #include "AtxReferenceable.h"
 #include "AtxDestroyable.h"
 #include "AtxList.h"
+#include "AtxMap.h"
+#include "AtxTime.h"
+#include "AtxSystem.h"
 #include "AtxHttp.h"
 #include "AtxSockets.h"
 #include "AtxVersion.h"
@@ -53,10 +57,58 @@ ATX_SET_LOCAL_LOGGER("atomix.http")
 /*----------------------------------------------------------------------
 |    types
 +---------------------------------------------------------------------*/
+typedef struct {
+    ATX_String               key; /* host:port */
+    ATX_Socket*              socket;
+    ATX_BufferedInputStream* buffered_input;
+    ATX_InputStream*         input;
+    ATX_OutputStream*        output;
+    ATX_TimeStamp            idle_since;
+} ATX_HttpConnection;
+
+typedef struct {
+    ATX_Cardinal reference_count;
+    ATX_Map*     idle_connections; /* ATX_List of connections, by host:port */
+    ATX_Boolean  keep_alive;
+    ATX_UInt32   max_connections_per_host;
+    ATX_UInt32   idle_timeout;
+} ATX_HttpConnectionPool;
+
+typedef struct {
+    /* interfaces */
+    ATX_IMPLEMENTS(ATX_InputStream);
+    ATX_IMPLEMENTS(ATX_Referenceable);
+
+    /* members */
+    ATX_Cardinal            reference_count;
+    ATX_HttpConnectionPool* pool;
+    ATX_HttpConnection*     connection;
+    ATX_InputStream*        source; /* delimited body of the response */
+    ATX_Boolean             reusable;
+    ATX_Boolean             has_length;
+    ATX_LargeSize           content_length;
+    ATX_Position            position;
+} ATX_HttpBodyStream;
+
+typedef struct {
+    /* interfaces */
+    ATX_IMPLEMENTS(ATX_InputStream);
+    ATX_IMPLEMENTS(ATX_Referenceable);
+
+    /* members */
+    ATX_Cardinal     reference_count;
+    ATX_InputStream* source;
+    ATX_UInt64       chunk_remaining;
+    ATX_Boolean      chunk_pending; /* a chunk's data has yet to be terminated */
+    ATX_Boolean      eos;
+    ATX_Position     position;
+} ATX_HttpChunkedInputStream;
+
 struct ATX_HttpClient {
     struct {
         ATX_Boolean follow_redirect;
     } options;
+    ATX_HttpConnectionPool* pool;
 };
 
 typedef struct {
@@ -69,6 +121,7 @@ typedef struct {
 
 typedef struct {
     ATX_String name;
+    ATX_Atom   key;  /* caseless atom of the name, NULL if not an atom */
     ATX_String value;
 } ATX_HttpHeader;
 
@@ -100,8 +153,9 @@ typedef enum {
 /*----------------------------------------------------------------------
 |    constants
 +---------------------------------------------------------------------*/
-#define ATX_HTTP_DEFAULT_PROTOCOL "HTTP/1.0"
+#define ATX_HTTP_DEFAULT_PROTOCOL "HTTP/1.1"
 #define ATX_HTTP_MAX_LINE_SIZE    2048
+#define ATX_HTTP_MAX_DRAIN_SIZE   65536
 #define ATX_HTTP_DEFAULT_PORT     80
 #define ATX_HTTP_INVALID_PORT     (-1)
 
@@ -109,6 +163,9 @@ typedef enum {
 #define ATX_HTTP_CONNECT_TIMEOUT  15000 /* 15 seconds */
 #define ATX_HTTP_MAX_REDIRECTS    20
 
+#define ATX_HTTP_DEFAULT_MAX_CONNECTIONS_PER_HOST 4
+#define ATX_HTTP_DEFAULT_IDLE_TIMEOUT             30000 /* 30 seconds */
+
 #define ATX_HTTP_HEADER_CONTENT_LENGTH      "Content-Length"
 #define ATX_HTTP_HEADER_HOST                "Host"
 #define ATX_HTTP_HEADER_CONNECTION          "Connection"
@@ -117,6 +174,7 @@ typedef enum {
 #define ATX_HTTP_HEADER_CONTENT_TYPE        "Content-Type"
 #define ATX_HTTP_HEADER_CONTENT_ENCODING    "Content-Encoding"
 #define ATX_HTTP_HEADER_LOCATION            "Location"
+#define ATX_HTTP_HEADER_TRANSFER_ENCODING   "Transfer-Encoding"
 
 #define ATX_HTTP_HEADER_DEFAULT_AGENT "Atomix/"ATX_ATOMIX_VERSION_STRING 
 
@@ -226,7 +284,8 @@ case ATX_HTTP_URL_PARSER_STATE_LEADING_SLASH:
 
 case ATX_HTTP_URL_PARSER_STATE_HOST:
     if (c == ':') {
-        ATX_String_AssignN(&self->host, mark, (ATX_Size)(url-mark));
+        ATX_String_AssignN(&self->host, mark, (ATX_Size)(url-1-mark));
+        self->port = 0;
         state = ATX_HTTP_URL_PARSER_STATE_PORT;
     } else if (c == '/' || c == 0) {
         ATX_String_AssignN(&self->host, mark, (ATX_Size)(url-1-mark));
@@ -267,17 +326,774 @@ ATX_HttpUrl_Destruct(ATX_HttpUrl* self)
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|   ATX_HttpConnection_Destroy
++---------------------------------------------------------------------*/
+static void
+ATX_HttpConnection_Destroy(ATX_HttpConnection* self)
+{
+    ATX_LOG_FINE_1("ATX_HttpConnection::Destroy - closing connection to %s",
+                   ATX_CSTR(self->key));
+    ATX_RELEASE_OBJECT(self->input);
+    ATX_BufferedInputStream_Destroy(self->buffered_input);
+    ATX_RELEASE_OBJECT(self->output);
+    ATX_DESTROY_OBJECT(self->socket);
+    ATX_String_Destruct(&self->key);
+    ATX_FreeMemory((void*)self);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpConnection_Create
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpConnection_Create(const ATX_HttpUrl*   url,
+                          ATX_CString          key,
+                          ATX_HttpConnection** connection)
+{
+    ATX_SocketAddress   address;
+    ATX_InputStream*    socket_input = NULL;
+    ATX_HttpConnection* self;
+    ATX_Result          result;
+
+    /* default return value */
+    *connection = NULL;
+
+    /* resolve the host address */
+    ATX_LOG_INFO_1("ATX_HttpConnection::Create - resolving name [%s]...",
+                   ATX_CSTR(url->host));
+    result = ATX_IpAddress_ResolveName(&address.ip_address, 
+                                       ATX_CSTR(url->host),
+                                       ATX_HTTP_RESOLVER_TIMEOUT);
+    if (ATX_FAILED(result)) return result;
+    address.port = url->port;
+    ATX_LOG_INFO("ATX_HttpConnection::Create - name resolved");
+
+    /* allocate the object */
+    self = (ATX_HttpConnection*)ATX_AllocateZeroMemory(sizeof(ATX_HttpConnection));
+    if (self == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    self->key = ATX_String_Create(key);
+
+    /* create a socket to connect to the server */
+    result = ATX_TcpClientSocket_Create(&self->socket);
+    if (ATX_FAILED(result)) goto end;
+
+    /* connect to the server */
+    ATX_LOG_INFO_1("ATX_HttpConnection::Create - connecting on port %d...",
+                   url->port);
+    result = ATX_Socket_Connect(self->socket, &address, ATX_HTTP_CONNECT_TIMEOUT);
+    if (ATX_FAILED(result)) goto end;
+
+    /* get the streams */
+    result = ATX_Socket_GetOutputStream(self->socket, &self->output);
+    if (ATX_FAILED(result)) goto end;
+    result = ATX_Socket_GetInputStream(self->socket, &socket_input);
+    if (ATX_FAILED(result)) goto end;
+    result = ATX_BufferedInputStream_Create(socket_input, 0, &self->buffered_input);
+    if (ATX_FAILED(result)) goto end;
+    result = ATX_BufferedInputStream_GetInputStream(self->buffered_input, &self->input);
+
+end:
+    ATX_RELEASE_OBJECT(socket_input);
+    if (ATX_FAILED(result)) {
+        ATX_HttpConnection_Destroy(self);
+        return result;
+    }
+    *connection = self;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpConnectionPool_Create
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpConnectionPool_Create(ATX_HttpConnectionPool** pool)
+{
+    ATX_Result result;
+
+    /* allocate the object */
+    *pool = (ATX_HttpConnectionPool*)ATX_AllocateZeroMemory(sizeof(ATX_HttpConnectionPool));
+    if (*pool == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* construct the object */
+    result = ATX_Map_Create(&(*pool)->idle_connections);
+    if (ATX_FAILED(result)) {
+        ATX_FreeMemory((void*)*pool);
+        *pool = NULL;
+        return result;
+    }
+    (*pool)->reference_count          = 1;
+    (*pool)->keep_alive               = ATX_TRUE;
+    (*pool)->max_connections_per_host = ATX_HTTP_DEFAULT_MAX_CONNECTIONS_PER_HOST;
+    (*pool)->idle_timeout             = ATX_HTTP_DEFAULT_IDLE_TIMEOUT;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpConnectionPool_Flush
++---------------------------------------------------------------------*/
+static void
+ATX_HttpConnectionPool_Flush(ATX_HttpConnectionPool* self)
+{
+    /* map entries are the items of the map's list */
+    ATX_ListItem* item = ATX_List_GetFirstItem(ATX_Map_AsList(self->idle_connections));
+    while (item) {
+        ATX_List*     list = (ATX_List*)ATX_MapEntry_GetData((ATX_MapEntry*)item);
+        ATX_ListItem* connection_item = ATX_List_GetFirstItem(list);
+        while (connection_item) {
+            ATX_HttpConnection_Destroy((ATX_HttpConnection*)ATX_ListItem_GetData(connection_item));
+            connection_item = ATX_ListItem_GetNext(connection_item);
+        }
+        ATX_List_Destroy(list);
+        item = ATX_ListItem_GetNext(item);
+    }
+    ATX_Map_Clear(self->idle_connections);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpConnectionPool_Release
++---------------------------------------------------------------------*/
+static void
+ATX_HttpConnectionPool_Release(ATX_HttpConnectionPool* self)
+{
+    if (--self->reference_count) return;
+
+    ATX_HttpConnectionPool_Flush(self);
+    ATX_Map_Destroy(self->idle_connections);
+    ATX_FreeMemory((void*)self);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpConnectionPool_MakeKey
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpConnectionPool_MakeKey(const ATX_HttpUrl* url, ATX_String* key)
+{
+    char port[16];
+
+    ATX_CHECK(ATX_IntegerToStringU(url->port, port, sizeof(port)));
+    ATX_CHECK(ATX_String_Assign(key, ATX_CSTR(url->host)));
+    ATX_CHECK(ATX_String_AppendChar(key, ':'));
+    return ATX_String_Append(key, port);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpConnectionPool_IsExpired
++---------------------------------------------------------------------*/
+static ATX_Boolean
+ATX_HttpConnectionPool_IsExpired(ATX_HttpConnectionPool*   self,
+                                 const ATX_HttpConnection* connection,
+                                 const ATX_TimeStamp*      now)
+{
+    ATX_TimeStamp expiration;
+    ATX_TimeStamp timeout;
+
+    ATX_TimeStamp_Set(timeout, 
+                      self->idle_timeout/1000, 
+                      (self->idle_timeout%1000)*1000000);
+    ATX_TimeStamp_Add(expiration, connection->idle_since, timeout);
+    return ATX_TimeStamp_IsLaterOrEqual(*now, expiration);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpConnectionPool_Acquire
+|
+|   Returns the most recently used idle connection for a key, closing
+|   the ones that have been idle for too long, or NULL if there is none.
++---------------------------------------------------------------------*/
+static ATX_HttpConnection*
+ATX_HttpConnectionPool_Acquire(ATX_HttpConnectionPool* self, ATX_CString key)
+{
+    ATX_MapEntry*       entry = ATX_Map_Get(self->idle_connections, key);
+    ATX_List*           list;
+    ATX_ListItem*       item;
+    ATX_HttpConnection* connection = NULL;
+    ATX_TimeStamp       now;
+
+    if (entry == NULL) return NULL;
+    list = (ATX_List*)ATX_MapEntry_GetData(entry);
+    ATX_System_GetCurrentTimeStamp(&now);
+
+    /* connections are kept from oldest to most recent */
+    while ((item = ATX_List_GetFirstItem(list))) {
+        ATX_HttpConnection* candidate = (ATX_HttpConnection*)ATX_ListItem_GetData(item);
+        if (!ATX_HttpConnectionPool_IsExpired(self, candidate, &now)) break;
+        ATX_List_RemoveItem(list, item);
+        ATX_LOG_FINE("ATX_HttpConnectionPool::Acquire - idle connection expired");
+        ATX_HttpConnection_Destroy(candidate);
+    }
+    item = ATX_List_GetLastItem(list);
+    if (item) {
+        connection = (ATX_HttpConnection*)ATX_ListItem_GetData(item);
+        ATX_List_RemoveItem(list, item);
+        ATX_LOG_FINE_1("ATX_HttpConnectionPool::Acquire - reusing connection to %s", key);
+    }
+
+    return connection;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpConnectionPool_Recycle
+|
+|   Takes ownership of a connection that is ready to send a new request.
++---------------------------------------------------------------------*/
+static void
+ATX_HttpConnectionPool_Recycle(ATX_HttpConnectionPool* self, 
+                               ATX_HttpConnection*     connection)
+{
+    ATX_MapEntry* entry;
+    ATX_List*     list = NULL;
+
+    if (self->keep_alive && self->max_connections_per_host) {
+        entry = ATX_Map_Get(self->idle_connections, ATX_CSTR(connection->key));
+        if (entry) {
+            list = (ATX_List*)ATX_MapEntry_GetData(entry);
+        } else if (ATX_SUCCEEDED(ATX_List_Create(&list))) {
+            if (ATX_FAILED(ATX_Map_Put(self->idle_connections, 
+                                       ATX_CSTR(connection->key), 
+                                       list, 
+                                       NULL))) {
+                ATX_List_Destroy(list);
+                list = NULL;
+            }
+        }
+    }
+    if (list == NULL || 
+        ATX_List_GetItemCount(list) >= self->max_connections_per_host ||
+        ATX_FAILED(ATX_List_AddData(list, connection))) {
+        ATX_HttpConnection_Destroy(connection);
+        return;
+    }
+    ATX_System_GetCurrentTimeStamp(&connection->idle_since);
+}
+
+/*----------------------------------------------------------------------
+|   forward declarations
++---------------------------------------------------------------------*/
+ATX_DECLARE_INTERFACE_MAP(ATX_HttpBodyStream, ATX_InputStream)
+ATX_DECLARE_INTERFACE_MAP(ATX_HttpBodyStream, ATX_Referenceable)
+ATX_DECLARE_INTERFACE_MAP(ATX_HttpChunkedInputStream, ATX_InputStream)
+ATX_DECLARE_INTERFACE_MAP(ATX_HttpChunkedInputStream, ATX_Referenceable)
+
+/*----------------------------------------------------------------------
+|   ATX_Http_IsChunked
++---------------------------------------------------------------------*/
+static ATX_Boolean
+ATX_Http_IsChunked(const ATX_HttpMessage* message)
+{
+    const ATX_String* encoding = 
+        ATX_HttpMessage_GetHeader(message, ATX_HTTP_HEADER_TRANSFER_ENCODING);
+    return encoding && ATX_String_Equals(encoding, "chunked", ATX_TRUE);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpBodyStream_ReleaseConnection
++---------------------------------------------------------------------*/
+static void
+ATX_HttpBodyStream_ReleaseConnection(ATX_HttpBodyStream* self)
+{
+    if (self->connection == NULL) return;
+    ATX_RELEASE_OBJECT(self->source);
+    if (self->reusable) {
+        ATX_HttpConnectionPool_Recycle(self->pool, self->connection);
+    } else {
+        ATX_HttpConnection_Destroy(self->connection);
+    }
+    self->connection = NULL;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpBodyStream_Create
+|
+|   Creates the body stream of a response received on a connection, 
+|   taking ownership of the connection.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpBodyStream_Create(ATX_HttpConnectionPool* pool,
+                          ATX_HttpConnection*     connection,
+                          const ATX_HttpRequest*  request,
+                          const ATX_HttpResponse* response,
+                          ATX_InputStream**       stream)
+{
+    ATX_HttpBodyStream* self;
+    const ATX_String*   header;
+    ATX_Boolean         delimited = ATX_FALSE;
+
+    /* allocate the object */
+    *stream = NULL;
+    self = (ATX_HttpBodyStream*)ATX_AllocateZeroMemory(sizeof(ATX_HttpBodyStream));
+    if (self == NULL) {
+        ATX_HttpConnection_Destroy(connection);
+        return ATX_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* construct the object */
+    self->reference_count = 1;
+    self->pool            = pool;
+    self->connection      = connection;
+    self->source          = response->base.body;
+    ATX_REFERENCE_OBJECT(self->source);
+    ++pool->reference_count;
+
+    /* see if the server will keep the connection open */
+    header = ATX_HttpMessage_GetHeader(&response->base, ATX_HTTP_HEADER_CONNECTION);
+    if (ATX_String_Equals(&response->base.protocol, "HTTP/1.0", ATX_TRUE)) {
+        self->reusable = header && ATX_String_Equals(header, "keep-alive", ATX_TRUE);
+    } else {
+        self->reusable = !(header && ATX_String_Equals(header, "close", ATX_TRUE));
+    }
+
+    /* find out where the body ends (after switching protocols, the */
+    /* rest of the connection is the body, and it can't be reused)   */
+    if (response->status_code == 101) {
+        self->reusable = ATX_FALSE;
+    } else if (ATX_String_Equals(&request->method, ATX_HTTP_METHOD_HEAD, ATX_TRUE) ||
+        response->status_code == 204 ||
+        response->status_code == 304) {
+        self->has_length = ATX_TRUE;
+        delimited        = ATX_TRUE;
+    } else if (ATX_Http_IsChunked(&response->base)) {
+        delimited = ATX_TRUE;
+    } else if ((header = ATX_HttpMessage_GetHeader(&response->base, 
+                                                   ATX_HTTP_HEADER_CONTENT_LENGTH))) {
+        ATX_UInt64 length = 0;
+        if (ATX_SUCCEEDED(ATX_ParseInteger64U(ATX_CSTR(*header), &length, ATX_TRUE))) {
+            self->has_length     = ATX_TRUE;
+            self->content_length = length;
+            delimited            = ATX_TRUE;
+        }
+    }
+    if (!delimited) self->reusable = ATX_FALSE;
+
+    /* setup the interfaces */
+    ATX_SET_INTERFACE(self, ATX_HttpBodyStream, ATX_InputStream);
+    ATX_SET_INTERFACE(self, ATX_HttpBodyStream, ATX_Referenceable);
+    *stream = &ATX_BASE(self, ATX_InputStream);
+
+    /* an empty body doesn't need the connection */
+    if (self->has_length && self->content_length == 0) {
+        ATX_HttpBodyStream_ReleaseConnection(self);
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpBodyStream_Destroy
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpBodyStream_Destroy(ATX_HttpBodyStream* self)
+{
+    /* drain what is left of a small body so that the connection can */
+    /* be reused, otherwise close it                                  */
+    if (self->connection && self->reusable) {
+        ATX_Size drained = 0;
+        while (self->connection && drained < ATX_HTTP_MAX_DRAIN_SIZE) {
+            ATX_Byte buffer[1024];
+            ATX_Size bytes_read = 0;
+            if (ATX_FAILED(ATX_INTERFACE(&ATX_BASE(self, ATX_InputStream))->Read(
+                    &ATX_BASE(self, ATX_InputStream), 
+                    buffer, 
+                    sizeof(buffer), 
+                    &bytes_read))) {
+                break;
+            }
+            drained += bytes_read;
+        }
+    }
+    if (self->connection) {
+        self->reusable = ATX_FALSE;
+        ATX_HttpBodyStream_ReleaseConnection(self);
+    }
+    ATX_RELEASE_OBJECT(self->source);
+    ATX_HttpConnectionPool_Release(self->pool);
+    ATX_FreeMemory((void*)self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpBodyStream_Read
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpBodyStream_Read(ATX_InputStream* _self,
+                        ATX_Any          buffer, 
+                        ATX_Size         bytes_to_read, 
+                        ATX_Size*        bytes_read)
+{
+    ATX_HttpBodyStream* self = ATX_SELF(ATX_HttpBodyStream, ATX_InputStream);
+    ATX_Size            local_read = 0;
+    ATX_Result          result;
+
+    if (bytes_read) *bytes_read = 0;
+    if (self->connection == NULL) return ATX_ERROR_EOS;
+    if (bytes_to_read == 0) return ATX_SUCCESS;
+
+    /* read directly into the caller's buffer */
+    result = ATX_InputStream_Read(self->source, buffer, bytes_to_read, &local_read);
+    if (ATX_FAILED(result)) {
+        /* the connection can only be reused after a complete body */
+        if (result != ATX_ERROR_EOS ||
+            (self->has_length && self->position != self->content_length)) {
+            self->reusable = ATX_FALSE;
+        }
+        ATX_HttpBodyStream_ReleaseConnection(self);
+        return result;
+    }
+    self->position += local_read;
+    if (bytes_read) *bytes_read = local_read;
+
+    /* give the connection back as soon as the whole body has been read */
+    if (self->has_length && self->position == self->content_length) {
+        ATX_HttpBodyStream_ReleaseConnection(self);
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpBodyStream_Seek
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpBodyStream_Seek(ATX_InputStream* _self, ATX_Position where)
+{
+    ATX_HttpBodyStream* self = ATX_SELF(ATX_HttpBodyStream, ATX_InputStream);
+    ATX_Result          result;
+
+    /* only forward seeks are possible */
+    if (where == self->position) return ATX_SUCCESS;
+    if (where < self->position || self->connection == NULL) {
+        return ATX_ERROR_NOT_SUPPORTED;
+    }
+    if (self->has_length && where > self->content_length) {
+        return ATX_ERROR_OUT_OF_RANGE;
+    }
+
+    /* skip in the delimited body, which may avoid copying the data */
+    result = ATX_InputStream_Skip(self->source, (ATX_Size)(where-self->position));
+    if (ATX_FAILED(result)) {
+        self->reusable = ATX_FALSE;
+        ATX_HttpBodyStream_ReleaseConnection(self);
+        return result;
+    }
+    self->position = where;
+    if (self->has_length && self->position == self->content_length) {
+        ATX_HttpBodyStream_ReleaseConnection(self);
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpBodyStream_Tell
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpBodyStream_Tell(ATX_InputStream* _self, ATX_Position* where)
+{
+    ATX_HttpBodyStream* self = ATX_SELF(ATX_HttpBodyStream, ATX_InputStream);
+    if (where) *where = self->position;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpBodyStream_GetSize
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpBodyStream_GetSize(ATX_InputStream* _self, ATX_LargeSize* size)
+{
+    ATX_HttpBodyStream* self = ATX_SELF(ATX_HttpBodyStream, ATX_InputStream);
+    if (size) *size = self->content_length;
+    return self->has_length ? ATX_SUCCESS : ATX_ERROR_NOT_SUPPORTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpBodyStream_GetAvailable
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpBodyStream_GetAvailable(ATX_InputStream* _self, 
+                                ATX_LargeSize*   available)
+{
+    ATX_HttpBodyStream* self = ATX_SELF(ATX_HttpBodyStream, ATX_InputStream);
+    ATX_LargeSize       source_available = 0;
+
+    if (self->connection) {
+        ATX_InputStream_GetAvailable(self->source, &source_available);
+        if (self->has_length && 
+            source_available > self->content_length-self->position) {
+            source_available = self->content_length-self->position;
+        }
+    }
+    *available = source_available;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpBodyStream_GetInterface
++---------------------------------------------------------------------*/
+ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(ATX_HttpBodyStream)
+    ATX_GET_INTERFACE_ACCEPT(ATX_HttpBodyStream, ATX_InputStream)
+    ATX_GET_INTERFACE_ACCEPT(ATX_HttpBodyStream, ATX_Referenceable)
+ATX_END_GET_INTERFACE_IMPLEMENTATION
+
+/*----------------------------------------------------------------------
+|   ATX_InputStream interface
++---------------------------------------------------------------------*/
+ATX_BEGIN_INTERFACE_MAP(ATX_HttpBodyStream, ATX_InputStream)
+    ATX_HttpBodyStream_Read,
+    ATX_HttpBodyStream_Seek,
+    ATX_HttpBodyStream_Tell,
+    ATX_HttpBodyStream_GetSize,
+    ATX_HttpBodyStream_GetAvailable
+};
+
+/*----------------------------------------------------------------------
+|   ATX_Referenceable interface
++---------------------------------------------------------------------*/
+ATX_IMPLEMENT_REFERENCEABLE_INTERFACE(ATX_HttpBodyStream, reference_count)
+
+/*----------------------------------------------------------------------
+|   ATX_HttpChunkedInputStream_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_HttpChunkedInputStream_Create(ATX_InputStream*  source,
+                                  ATX_InputStream** stream)
+{
+    ATX_HttpChunkedInputStream* self;
+
+    /* allocate the object */
+    *stream = NULL;
+    self = (ATX_HttpChunkedInputStream*)ATX_AllocateZeroMemory(sizeof(ATX_HttpChunkedInputStream));
+    if (self == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* construct the object */
+    self->reference_count = 1;
+    self->source          = source;
+    ATX_REFERENCE_OBJECT(source);
+
+    /* setup the interfaces */
+    ATX_SET_INTERFACE(self, ATX_HttpChunkedInputStream, ATX_InputStream);
+    ATX_SET_INTERFACE(self, ATX_HttpChunkedInputStream, ATX_Referenceable);
+    *stream = &ATX_BASE(self, ATX_InputStream);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpChunkedInputStream_Destroy
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpChunkedInputStream_Destroy(ATX_HttpChunkedInputStream* self)
+{
+    ATX_RELEASE_OBJECT(self->source);
+    ATX_FreeMemory((void*)self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpChunkedInputStream_NextChunk
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpChunkedInputStream_NextChunk(ATX_HttpChunkedInputStream* self)
+{
+    char        line[ATX_HTTP_MAX_LINE_SIZE+1];
+    const char* digits;
+    const char* c;
+    ATX_UInt64  size = 0;
+    ATX_Result  result;
+
+    /* the data of the previous chunk is followed by a CRLF */
+    if (self->chunk_pending) {
+        ATX_CHECK(ATX_InputStream_ReadLine(self->source, line, sizeof(line), NULL));
+        if (line[0] != '\0') return ATX_ERROR_INVALID_FORMAT;
+        self->chunk_pending = ATX_FALSE;
+    }
+
+    /* parse the chunk size, ignoring extensions */
+    result = ATX_InputStream_ReadLine(self->source, line, sizeof(line), NULL);
+    if (ATX_FAILED(result)) {
+        return result == ATX_ERROR_EOS ? ATX_ERROR_INVALID_FORMAT : result;
+    }
+    digits = ATX_Http_SkipWhitespace(line);
+    for (c = digits; ; c++) {
+        unsigned int digit;
+        if (*c >= '0' && *c <= '9') {
+            digit = *c-'0';
+        } else if (*c >= 'a' && *c <= 'f') {
+            digit = *c-'a'+10;
+        } else if (*c >= 'A' && *c <= 'F') {
+            digit = *c-'A'+10;
+        } else {
+            break;
+        }
+        if (size >> 60) return ATX_ERROR_OVERFLOW;
+        size = (size<<4) | digit;
+    }
+    if (c == digits || (*c != '\0' && *c != ';' && *c != ' ' && *c != '\t')) {
+        return ATX_ERROR_INVALID_FORMAT;
+    }
+
+    if (size == 0) {
+        /* last chunk, skip the trailer */
+        do {
+            ATX_CHECK(ATX_InputStream_ReadLine(self->source, line, sizeof(line), NULL));
+        } while (line[0] != '\0');
+        self->eos = ATX_TRUE;
+    } else {
+        self->chunk_remaining = size;
+        self->chunk_pending   = ATX_TRUE;
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpChunkedInputStream_Read
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpChunkedInputStream_Read(ATX_InputStream* _self,
+                                ATX_Any          buffer, 
+                                ATX_Size         bytes_to_read, 
+                                ATX_Size*        bytes_read)
+{
+    ATX_HttpChunkedInputStream* self = ATX_SELF(ATX_HttpChunkedInputStream, ATX_InputStream);
+    ATX_Size                    local_read = 0;
+    ATX_Result                  result;
+
+    if (bytes_read) *bytes_read = 0;
+    if (bytes_to_read == 0) return ATX_SUCCESS;
+
+    /* move on to the next chunk if needed */
+    if (self->chunk_remaining == 0) {
+        if (!self->eos) ATX_CHECK(ATX_HttpChunkedInputStream_NextChunk(self));
+        if (self->eos) return ATX_ERROR_EOS;
+    }
+
+    /* read the chunk data directly into the caller's buffer */
+    if (bytes_to_read > self->chunk_remaining) {
+        bytes_to_read = (ATX_Size)self->chunk_remaining;
+    }
+    result = ATX_InputStream_Read(self->source, buffer, bytes_to_read, &local_read);
+    if (ATX_FAILED(result)) {
+        return result == ATX_ERROR_EOS ? ATX_ERROR_INVALID_FORMAT : result;
+    }
+    self->chunk_remaining -= local_read;
+    self->position        += local_read;
+    if (bytes_read) *bytes_read = local_read;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpChunkedInputStream_Seek
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpChunkedInputStream_Seek(ATX_InputStream* _self, ATX_Position where)
+{
+    ATX_HttpChunkedInputStream* self = ATX_SELF(ATX_HttpChunkedInputStream, ATX_InputStream);
+
+    /* skip forward one chunk at a time, the source may be able to seek */
+    if (where < self->position) return ATX_ERROR_NOT_SUPPORTED;
+    while (where > self->position) {
+        ATX_UInt64 count;
+        if (self->chunk_remaining == 0) {
+            if (!self->eos) ATX_CHECK(ATX_HttpChunkedInputStream_NextChunk(self));
+            if (self->eos) return ATX_ERROR_OUT_OF_RANGE;
+        }
+        count = where-self->position;
+        if (count > self->chunk_remaining) count = self->chunk_remaining;
+        ATX_CHECK(ATX_InputStream_Skip(self->source, (ATX_Size)count));
+        self->chunk_remaining -= count;
+        self->position        += count;
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpChunkedInputStream_Tell
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpChunkedInputStream_Tell(ATX_InputStream* _self, ATX_Position* where)
+{
+    ATX_HttpChunkedInputStream* self = ATX_SELF(ATX_HttpChunkedInputStream, ATX_InputStream);
+    if (where) *where = self->position;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpChunkedInputStream_GetSize
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpChunkedInputStream_GetSize(ATX_InputStream* _self, ATX_LargeSize* size)
+{
+    ATX_COMPILER_UNUSED(_self);
+    if (size) *size = 0;
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpChunkedInputStream_GetAvailable
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_HttpChunkedInputStream_GetAvailable(ATX_InputStream* _self, 
+                                        ATX_LargeSize*   available)
+{
+    ATX_HttpChunkedInputStream* self = ATX_SELF(ATX_HttpChunkedInputStream, ATX_InputStream);
+    ATX_LargeSize               source_available = 0;
+
+    ATX_InputStream_GetAvailable(self->source, &source_available);
+    *available = source_available < self->chunk_remaining ? 
+                 source_available : self->chunk_remaining;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpChunkedInputStream_GetInterface
++---------------------------------------------------------------------*/
+ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(ATX_HttpChunkedInputStream)
+    ATX_GET_INTERFACE_ACCEPT(ATX_HttpChunkedInputStream, ATX_InputStream)
+    ATX_GET_INTERFACE_ACCEPT(ATX_HttpChunkedInputStream, ATX_Referenceable)
+ATX_END_GET_INTERFACE_IMPLEMENTATION
+
+/*----------------------------------------------------------------------
+|   ATX_InputStream interface
++---------------------------------------------------------------------*/
+ATX_BEGIN_INTERFACE_MAP(ATX_HttpChunkedInputStream, ATX_InputStream)
+    ATX_HttpChunkedInputStream_Read,
+    ATX_HttpChunkedInputStream_Seek,
+    ATX_HttpChunkedInputStream_Tell,
+    ATX_HttpChunkedInputStream_GetSize,
+    ATX_HttpChunkedInputStream_GetAvailable
+};
+
+/*----------------------------------------------------------------------
+|   ATX_Referenceable interface
++---------------------------------------------------------------------*/
+ATX_IMPLEMENT_REFERENCEABLE_INTERFACE(ATX_HttpChunkedInputStream, reference_count)
+
 /*----------------------------------------------------------------------
 |   ATX_HttpClient_Create
 +---------------------------------------------------------------------*/
 ATX_Result
 ATX_HttpClient_Create(ATX_HttpClient** client)
 {
+    ATX_Result result;
+
     /* allocate memory */
     *client = (ATX_HttpClient*)ATX_AllocateZeroMemory(sizeof(ATX_HttpClient));
+    if (*client == NULL) return ATX_ERROR_OUT_OF_MEMORY;
 
     /* construct the object */
     (*client)->options.follow_redirect = ATX_TRUE;
+    result = ATX_HttpConnectionPool_Create(&(*client)->pool);
+    if (ATX_FAILED(result)) {
+        ATX_FreeMemory((void*)*client);
+        *client = NULL;
+        return result;
+    }
 
     return ATX_SUCCESS;
 }
@@ -288,7 +1104,11 @@ ATX_HttpClient_Create(ATX_HttpClient** client)
 ATX_Result
 ATX_HttpClient_Destroy(ATX_HttpClient* self)
 {
-    /* destruct the object */
+    /* destruct the object (responses that are still being read keep  */
+    /* a reference to the pool, so only close the idle connections)   */
+    self->pool->keep_alive = ATX_FALSE;
+    ATX_HttpConnectionPool_Flush(self->pool);
+    ATX_HttpConnectionPool_Release(self->pool);
 
     /* free the memory */
     ATX_FreeMemory((void*)self);
@@ -306,6 +1126,9 @@ ATX_HttpClient_SetOptionBool(ATX_HttpClient* self,
 {
     if (ATX_StringsEqual(option, ATX_HTTP_CLIENT_OPTION_FOLLOW_REDIRECT)) {
         self->options.follow_redirect = value;
+    } else if (ATX_StringsEqual(option, ATX_HTTP_CLIENT_OPTION_KEEP_ALIVE)) {
+        self->pool->keep_alive = value;
+        if (!value) ATX_HttpConnectionPool_Flush(self->pool);
     } else {
         return ATX_ERROR_NO_SUCH_ITEM;
     }
@@ -313,6 +1136,77 @@ ATX_HttpClient_SetOptionBool(ATX_HttpClient* self,
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|   ATX_HttpClient_GetOptionBool
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_HttpClient_GetOptionBool(const ATX_HttpClient* self,
+                             ATX_CString           option,
+                             ATX_Boolean*          value)
+{
+    if (ATX_StringsEqual(option, ATX_HTTP_CLIENT_OPTION_FOLLOW_REDIRECT)) {
+        *value = self->options.follow_redirect;
+    } else if (ATX_StringsEqual(option, ATX_HTTP_CLIENT_OPTION_KEEP_ALIVE)) {
+        *value = self->pool->keep_alive;
+    } else {
+        return ATX_ERROR_NO_SUCH_ITEM;
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpClient_SetOptionUInt
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_HttpClient_SetOptionUInt(ATX_HttpClient* self,
+                             ATX_CString     option,
+                             ATX_UInt32      value)
+{
+    if (ATX_StringsEqual(option, ATX_HTTP_CLIENT_OPTION_MAX_CONNECTIONS_PER_HOST)) {
+        self->pool->max_connections_per_host = value;
+    } else if (ATX_StringsEqual(option, ATX_HTTP_CLIENT_OPTION_IDLE_TIMEOUT)) {
+        self->pool->idle_timeout = value;
+    } else {
+        return ATX_ERROR_NO_SUCH_ITEM;
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpClient_GetOptionUInt
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_HttpClient_GetOptionUInt(const ATX_HttpClient* self,
+                             ATX_CString           option,
+                             ATX_UInt32*           value)
+{
+    if (ATX_StringsEqual(option, ATX_HTTP_CLIENT_OPTION_MAX_CONNECTIONS_PER_HOST)) {
+        *value = self->pool->max_connections_per_host;
+    } else if (ATX_StringsEqual(option, ATX_HTTP_CLIENT_OPTION_IDLE_TIMEOUT)) {
+        *value = self->pool->idle_timeout;
+    } else {
+        return ATX_ERROR_NO_SUCH_ITEM;
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_HttpClient_CanRetry
++---------------------------------------------------------------------*/
+static ATX_Boolean
+ATX_HttpClient_CanRetry(const ATX_HttpRequest* request)
+{
+    /* the server may have received the request before the connection */
+    /* failed, so only resend requests that are idempotent, and that   */
+    /* have no body stream (it cannot be read a second time)           */
+    if (request->base.body) return ATX_FALSE;
+    return ATX_String_Equals(&request->method, ATX_HTTP_METHOD_GET, ATX_FALSE) ||
+           ATX_String_Equals(&request->method, ATX_HTTP_METHOD_HEAD, ATX_FALSE);
+}
+
 /*----------------------------------------------------------------------
 |   ATX_HttpClient_SendRequestOnce
 +---------------------------------------------------------------------*/
@@ -322,31 +1216,19 @@ ATX_HttpClient_SendRequestOnce(ATX_HttpClient*    self,
                                ATX_HttpResponse** response)
 
 {
-    ATX_SocketAddress address;
-    ATX_Socket*       connection = NULL;
-    ATX_InputStream*  input_stream = NULL;
-    ATX_OutputStream* output_stream = NULL;
-    ATX_Result        result;
-
-    ATX_COMPILER_UNUSED(self);
+    ATX_HttpConnection* connection = NULL;
+    ATX_InputStream*    body = NULL;
+    ATX_String          key = ATX_EMPTY_STRING;
+    ATX_Boolean         allow_reuse = ATX_TRUE;
+    ATX_Result          result;
 
     /* set default return value */
     *response = NULL;
 
-    /* resolve the host address */
-    ATX_LOG_INFO_1("ATX_HttpClient::SendRequest - resolving name [%s]...",
-                   ATX_CSTR(request->url.host));
-    result = ATX_IpAddress_ResolveName(&address.ip_address, 
-                                       ATX_CSTR(request->url.host),
-                                       ATX_HTTP_RESOLVER_TIMEOUT);
-    if (ATX_FAILED(result)) return result;
-    address.port = request->url.port;
-    ATX_LOG_INFO("ATX_HttpClient::SendRequest - name resolved");
-
     /* setup some headers */
     ATX_HttpMessage_SetHeader((ATX_HttpMessage*)request,
                               ATX_HTTP_HEADER_CONNECTION,
-                              "close");
+                              self->pool->keep_alive?"keep-alive":"close");
     ATX_HttpMessage_SetHeader((ATX_HttpMessage*)request,
                               ATX_HTTP_HEADER_HOST,
                               ATX_CSTR(request->url.host));
@@ -354,40 +1236,64 @@ ATX_HttpClient_SendRequestOnce(ATX_HttpClient*    self,
                               ATX_HTTP_HEADER_USER_AGENT,
                               ATX_HTTP_HEADER_DEFAULT_AGENT);
 
-    /* create a socket to connect to the server */
-    result = ATX_TcpClientSocket_Create(&connection);
-    if (ATX_FAILED(result)) return result;
-
-    /* connect to the server */
-    ATX_LOG_INFO_1("ATX_HttpClient::SendRequest - connecting on port %d...",
-               request->url.port);
-    result = ATX_Socket_Connect(connection, &address, ATX_HTTP_CONNECT_TIMEOUT);
+    /* connections are pooled by host:port */
+    result = ATX_HttpConnectionPool_MakeKey(&request->url, &key);
     if (ATX_FAILED(result)) goto end;
 
-    /* emit the request onto the connection */
-    result = ATX_Socket_GetOutputStream(connection, &output_stream);
-    if (ATX_FAILED(result)) goto end;
-    result = ATX_HttpRequest_Emit(request, output_stream);
-    if (ATX_FAILED(result)) goto end;
+    for (;;) {
+        ATX_Boolean reused = ATX_FALSE;
 
-    /* create a response from the connection's input stream */
-    result = ATX_Socket_GetInputStream(connection, &input_stream);
-    if (ATX_FAILED(result)) goto end;
-    result = ATX_HttpResponse_CreateFromStream(input_stream, response);
+        /* get an idle connection or make a new one */
+        if (allow_reuse) {
+            connection = ATX_HttpConnectionPool_Acquire(self->pool, ATX_CSTR(key));
+            reused = (connection != NULL);
+        }
+        if (connection == NULL) {
+            result = ATX_HttpConnection_Create(&request->url, ATX_CSTR(key), &connection);
+            if (ATX_FAILED(result)) goto end;
+        }
+
+        /* emit the request and parse the response */
+        result = ATX_HttpRequest_Emit(request, connection->output);
+        if (ATX_SUCCEEDED(result)) {
+            result = ATX_HttpResponse_CreateFromStream(connection->input, response);
+        }
+
+        /* an interim (1xx) response is followed by the final one on the */
+        /* same connection, except for 101 after which HTTP is over      */
+        while (ATX_SUCCEEDED(result) &&
+               (*response)->status_code >= 100 && 
+               (*response)->status_code <  200 &&
+               (*response)->status_code != 101) {
+            ATX_LOG_FINE_1("ATX_HttpClient::SendRequest - skipping interim response %d",
+                           (int)(*response)->status_code);
+            ATX_HttpResponse_Destroy(*response);
+            *response = NULL;
+            result = ATX_HttpResponse_CreateFromStream(connection->input, response);
+        }
+        if (ATX_SUCCEEDED(result)) break;
+
+        /* the server may have closed an idle connection, retry once */
+        ATX_HttpConnection_Destroy(connection);
+        connection = NULL;
+        *response  = NULL;
+        if (!reused || !ATX_HttpClient_CanRetry(request)) goto end;
+        ATX_LOG_FINE_1("ATX_HttpClient::SendRequest - reused connection failed (%d), retrying", result);
+        allow_reuse = ATX_FALSE;
+    }
+
+    /* the body stream owns the connection from now on */
+    result = ATX_HttpBodyStream_Create(self->pool, connection, request, *response, &body);
     if (ATX_FAILED(result)) {
+        ATX_HttpResponse_Destroy(*response);
         *response = NULL;
         goto end;
     }
+    ATX_RELEASE_OBJECT((*response)->base.body);
+    (*response)->base.body = body;
 
 end:
-    if (ATX_FAILED(result)) {
-        if (*response != NULL) {
-            ATX_HttpResponse_Destroy(*response);
-        }
-    }
-    ATX_RELEASE_OBJECT(input_stream);
-    ATX_RELEASE_OBJECT(output_stream);
-    ATX_DESTROY_OBJECT(connection);
+    ATX_String_Destruct(&key);
     return result;
 }
 
@@ -446,6 +1352,7 @@ ATX_HttpClient_SendRequest(ATX_HttpClient*    self,
 +---------------------------------------------------------------------*/
 static ATX_Result 
 ATX_HttpHeader_Create(ATX_CString      name, 
+                      ATX_Atom         key,
                       ATX_CString      value,
                       ATX_HttpHeader** header)
 {
@@ -457,6 +1364,7 @@ ATX_HttpHeader_Create(ATX_CString      name,
 
     /* construct the object */
     (*header)->name  = ATX_String_Create(name);
+    (*header)->key   = key;
     (*header)->value = ATX_String_Create(value);
 
     return ATX_SUCCESS;
@@ -488,6 +1396,20 @@ ATX_HttpHeader_SetValue(ATX_HttpHeader* header, ATX_CString value)
     return ATX_String_Assign(&header->value, value);
 }
 
+/*----------------------------------------------------------------------
+|    ATX_HttpHeader_Matches
++---------------------------------------------------------------------*/
+static ATX_Boolean
+ATX_HttpHeader_Matches(const ATX_HttpHeader* header, 
+                       ATX_Atom              key,
+                       ATX_CString           name)
+{
+    /* an atom name only matches the same caseless atom, other names */
+    /* may have been interned since, so they are compared as strings */
+    if (header->key) return header->key == key;
+    return ATX_String_Equals(&header->name, name, ATX_TRUE);
+}
+
 /*----------------------------------------------------------------------
 |    ATX_HttpMessage_Construct
 +---------------------------------------------------------------------*/
@@ -569,44 +1491,108 @@ ATX_HttpMessage_Destroy(ATX_HttpMessage* message)
 }
 
 /*----------------------------------------------------------------------
-|    ATX_HttpMessage_SetHeader
+|    ATX_HttpMessage_FindHeader
 +---------------------------------------------------------------------*/
-ATX_Result
-ATX_HttpMessage_SetHeader(ATX_HttpMessage* message,
-                          ATX_CString      name, 
-                          ATX_CString      value)
+static ATX_HttpHeader*
+ATX_HttpMessage_FindHeader(const ATX_HttpMessage* message,
+                           ATX_Atom               key,
+                           ATX_CString            name)
 {
-    ATX_HttpHeader* header;
-    ATX_Result      result;
-
-    /* find if the header already exists */
     ATX_ListItem* item = ATX_List_GetFirstItem(message->headers);
     while (item) {
-        header = (ATX_HttpHeader*)ATX_ListItem_GetData(item);
-        if (ATX_String_Equals(&header->name, name, ATX_TRUE)) {
-            /* found a match */
-            return ATX_HttpHeader_SetValue(header, value);
-        }
+        ATX_HttpHeader* header = (ATX_HttpHeader*)ATX_ListItem_GetData(item);
+        if (ATX_HttpHeader_Matches(header, key, name)) return header;
         item = ATX_ListItem_GetNext(item);
     }
 
+    return NULL;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_HttpMessage_SetHeaderWithKey
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpMessage_SetHeaderWithKey(ATX_HttpMessage* message,
+                                 ATX_CString      name, 
+                                 ATX_Atom         key,
+                                 ATX_CString      value)
+{
+    ATX_HttpHeader* header;
+    ATX_Result      result;
+
+    /* find if the header already exists */
+    header = ATX_HttpMessage_FindHeader(message, key, name);
+    if (header) return ATX_HttpHeader_SetValue(header, value);
+
     /* create a new header */
-    result = ATX_HttpHeader_Create(name, value, &header);
+    result = ATX_HttpHeader_Create(name, key, value, &header);
     if (ATX_FAILED(result)) return result;
     return ATX_List_AddData(message->headers, header);
 }
 
+/*----------------------------------------------------------------------
+|    ATX_HttpMessage_SetHeader
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_HttpMessage_SetHeader(ATX_HttpMessage* message,
+                          ATX_CString      name, 
+                          ATX_CString      value)
+{
+    ATX_Atom   atom;
+    ATX_Result result;
+
+    /* header names are compared without case */
+    result = ATX_Atom_Intern(name, &atom);
+    if (ATX_FAILED(result)) return result;
+
+    return ATX_HttpMessage_SetHeaderWithKey(message, 
+                                            name, 
+                                            ATX_Atom_GetCaseless(atom), 
+                                            value);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_HttpMessage_SetParsedHeader
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpMessage_SetParsedHeader(ATX_HttpMessage* message,
+                                ATX_CString      name, 
+                                ATX_CString      value)
+{
+    /* names read from the network are never interned, as the atom   */
+    /* table keeps every entry: a peer could make it grow forever     */
+    return ATX_HttpMessage_SetHeaderWithKey(message, 
+                                            name, 
+                                            ATX_Atom_FindCaseless(name), 
+                                            value);
+}
+
 /*----------------------------------------------------------------------
 |    ATX_HttpMessage_GetHeader
 +---------------------------------------------------------------------*/
 const ATX_String*
 ATX_HttpMessage_GetHeader(const ATX_HttpMessage* message, ATX_CString name)
 {
+    ATX_HttpHeader* header;
+
+    header = ATX_HttpMessage_FindHeader(message, ATX_Atom_FindCaseless(name), name);
+    return header ? &header->value : NULL;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_HttpMessage_GetHeaderByAtom
++---------------------------------------------------------------------*/
+const ATX_String*
+ATX_HttpMessage_GetHeaderByAtom(const ATX_HttpMessage* message, ATX_Atom name)
+{
+    ATX_Atom    key = ATX_Atom_GetCaseless(name);
+    ATX_CString chars = ATX_Atom_GetChars(name);
+
     /* find the header */
     ATX_ListItem* item = ATX_List_GetFirstItem(message->headers);
     while (item) {
         ATX_HttpHeader* header = (ATX_HttpHeader*)ATX_ListItem_GetData(item);
-        if (ATX_String_Equals(&header->name, name, ATX_TRUE)) {
+        if (ATX_HttpHeader_Matches(header, key, chars)) {
             /* found a match */
             return &header->value;
         }
@@ -666,13 +1652,13 @@ ATX_HttpMessage_SetBody(ATX_HttpMessage* self,
 +---------------------------------------------------------------------*/
 ATX_Result
 ATX_HttpMessage_GetBody(const ATX_HttpMessage* self,
-                        ATX_InputStream*       stream,
+                        ATX_InputStream**      stream,
                         ATX_Size*              content_length)
 {
     /* return a reference to the stream */
     if (stream) {
-        stream = self->body;
-        ATX_REFERENCE_OBJECT(stream);
+        *stream = self->body;
+        ATX_REFERENCE_OBJECT(*stream);
     }
 
     /* return the content length */
@@ -693,22 +1679,28 @@ ATX_HttpMessage_GetBody(const ATX_HttpMessage* self,
 }
 
 /*----------------------------------------------------------------------
-|    ATX_HttpMessage_Emit
+|    ATX_HttpMessage_FormatHeaders
 +---------------------------------------------------------------------*/
 static ATX_Result
-ATX_HttpMessage_Emit(const ATX_HttpMessage* message, ATX_OutputStream* stream)
+ATX_HttpMessage_FormatHeaders(const ATX_HttpMessage* message, 
+                              ATX_StringBuilder*     builder)
 {
     ATX_ListItem* item = ATX_List_GetFirstItem(message->headers);
 
-    /* output the headers */
+    /* append the headers */
     while (item) {
         ATX_HttpHeader* header = ATX_ListItem_GetData(item);
         if (header && 
             !ATX_String_IsEmpty(&header->name) && 
             !ATX_String_IsEmpty(&header->value)) {
-            ATX_OutputStream_WriteString(stream, ATX_CSTR(header->name));
-            ATX_OutputStream_Write(stream, ": ", 2, NULL);
-            ATX_OutputStream_WriteLine(stream, ATX_CSTR(header->value));
+            ATX_CHECK(ATX_StringBuilder_AppendSubString(builder,
+                                                        ATX_String_GetChars(&header->name),
+                                                        ATX_String_GetLength(&header->name)));
+            ATX_CHECK(ATX_StringBuilder_AppendSubString(builder, ": ", 2));
+            ATX_CHECK(ATX_StringBuilder_AppendSubString(builder, 
+                                                        ATX_String_GetChars(&header->value),
+                                                        ATX_String_GetLength(&header->value)));
+            ATX_CHECK(ATX_StringBuilder_AppendSubString(builder, "\r\n", 2));
             ATX_LOG_FINE_2("ATX_HttpMessage::Emit - %s: %s", ATX_CSTR(header->name), ATX_CSTR(header->value));
         }
         item = ATX_ListItem_GetNext(item);
@@ -717,6 +1709,25 @@ ATX_HttpMessage_Emit(const ATX_HttpMessage* message, ATX_OutputStream* stream)
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|    ATX_HttpMessage_WriteBuilder
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_HttpMessage_WriteBuilder(ATX_StringBuilder* builder, 
+                             ATX_Result         result,
+                             ATX_OutputStream*  stream)
+{
+    /* write everything that was formatted in a single call */
+    if (ATX_SUCCEEDED(result)) {
+        result = ATX_OutputStream_WriteFully(stream, 
+                                             ATX_StringBuilder_GetChars(builder),
+                                             ATX_StringBuilder_GetLength(builder));
+    }
+    ATX_StringBuilder_Destruct(builder);
+
+    return result;
+}
+
 /*----------------------------------------------------------------------
 |    ATX_HttpRequest_Create
 +---------------------------------------------------------------------*/
@@ -784,24 +1795,74 @@ ATX_HttpRequest_Destroy(ATX_HttpRequest* request)
 ATX_Result
 ATX_HttpRequest_Emit(const ATX_HttpRequest* request, ATX_OutputStream* stream)
 {
+    ATX_StringBuilder builder = ATX_EMPTY_STRING_BUILDER;
+    ATX_Result        result;
+
     /* check that we have all we need */
     if (ATX_String_IsEmpty(&request->method) || 
         ATX_String_IsEmpty(&request->base.protocol)) {
         return ATX_ERROR_INVALID_PARAMETERS;
     }
 
-    /* output the request line */
-    ATX_OutputStream_WriteString(stream, ATX_CSTR(request->method));
-    ATX_OutputStream_Write(stream, " ", 1, NULL);
-    ATX_OutputStream_WriteString(stream, ATX_CSTR(request->url.path));
-    ATX_OutputStream_Write(stream, " ", 1, NULL);
-    ATX_OutputStream_WriteString(stream, ATX_CSTR(request->base.protocol));
+    /* request line */
+    result = ATX_StringBuilder_AppendFormat(&builder, "%s %s %s\r\n",
+                                            ATX_CSTR(request->method),
+                                            ATX_CSTR(request->url.path),
+                                            ATX_CSTR(request->base.protocol));
 
-    /* output the headers */
-    ATX_HttpMessage_Emit(&request->base, stream);
+    /* headers */
+    if (ATX_SUCCEEDED(result)) {
+        result = ATX_HttpMessage_FormatHeaders(&request->base, &builder);
+    }
 
     /* terminating line */
-    ATX_OutputStream_Write(stream, "\r\n", 2, NULL);
+    if (ATX_SUCCEEDED(result)) {
+        result = ATX_StringBuilder_AppendSubString(&builder, "\r\n", 2);
+    }
+
+    return ATX_HttpMessage_WriteBuilder(&builder, result, stream);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_HttpResponse_SetupBody
++---------------------------------------------------------------------*/
+static ATX_Result 
+ATX_HttpResponse_SetupBody(ATX_HttpResponse* response, ATX_InputStream* stream)
+{
+    const ATX_String* content_length;
+    ATX_UInt64        length = 0;
+    
+    /* chunked bodies are decoded as they are read */
+    if (ATX_Http_IsChunked(&response->base)) {
+        return ATX_HttpChunkedInputStream_Create(stream, &response->base.body);
+    }
+
+    content_length = ATX_HttpMessage_GetHeader(&response->base, 
+                                               ATX_HTTP_HEADER_CONTENT_LENGTH);
+    if (content_length && 
+        ATX_SUCCEEDED(ATX_ParseInteger64U(ATX_CSTR(*content_length), &length, ATX_TRUE))) {
+        if (length == 0) {
+            /* nothing to read */
+            ATX_MemoryStream* empty = NULL;
+            ATX_CHECK(ATX_MemoryStream_Create(0, &empty));
+            ATX_MemoryStream_GetInputStream(empty, &response->base.body);
+            ATX_MemoryStream_Destroy(empty);
+        } else {
+            /* never read past the end of the body */
+            ATX_Position offset = 0;
+            ATX_InputStream_Tell(stream, &offset);
+            ATX_CHECK(ATX_SubInputStream_Create(stream, 
+                                                offset, 
+                                                length, 
+                                                NULL, 
+                                                &response->base.body));
+        }
+        return ATX_SUCCESS;
+    }
+
+    /* the body extends to the end of the stream */
+    response->base.body = stream;
+    ATX_REFERENCE_OBJECT(stream);
 
     return ATX_SUCCESS;
 }
@@ -861,6 +1922,7 @@ ATX_HttpResponse_Parse(ATX_HttpResponse* response, ATX_InputStream* stream)
     /* parse headers until an empty line or end of stream */
     do {
         /* read a line */
+        line = buffer;
         result = ATX_InputStream_ReadLine(stream, line, sizeof(buffer), NULL);
         if (ATX_FAILED(result)) break;
 
@@ -868,9 +1930,9 @@ ATX_HttpResponse_Parse(ATX_HttpResponse* response, ATX_InputStream* stream)
         if (line[0] == '\0' || line[0] == '\r' || line[0] == '\n') {
             if (header_pending) {
                 ATX_String_TrimWhitespace(&header_value);
-                ATX_HttpMessage_SetHeader((ATX_HttpMessage*)response, 
-                                          ATX_CSTR(header_name), 
-                                          ATX_CSTR(header_value));
+                ATX_HttpMessage_SetParsedHeader((ATX_HttpMessage*)response, 
+                                                ATX_CSTR(header_name), 
+                                                ATX_CSTR(header_value));
                 ATX_LOG_FINE_2("ATX_HttpResponse::Parse - %s: %s",
                                ATX_CSTR(header_name),
                                ATX_CSTR(header_value));
@@ -890,9 +1952,9 @@ ATX_HttpResponse_Parse(ATX_HttpResponse* response, ATX_InputStream* stream)
             /* add the pending header to the list */
             if (header_pending) {
                 ATX_String_TrimWhitespace(&header_value);
-                ATX_HttpMessage_SetHeader((ATX_HttpMessage*)response, 
-                                          ATX_CSTR(header_name), 
-                                          ATX_CSTR(header_value));
+                ATX_HttpMessage_SetParsedHeader((ATX_HttpMessage*)response, 
+                                                ATX_CSTR(header_name), 
+                                                ATX_CSTR(header_value));
                 ATX_LOG_FINE_2("ATX_HttpResponse::Parse - %s: %s",
                                ATX_CSTR(header_name),
                                ATX_CSTR(header_value));
@@ -910,15 +1972,13 @@ ATX_HttpResponse_Parse(ATX_HttpResponse* response, ATX_InputStream* stream)
         }
     } while(ATX_SUCCEEDED(result));
 
-    /* keep a reference to the stream */
-    response->base.body = stream;
-    ATX_REFERENCE_OBJECT(stream);
-
     /* cleanup */
     ATX_String_Destruct(&header_name);
     ATX_String_Destruct(&header_value);
 
-    return ATX_SUCCESS;
+    /* the body is whatever follows the headers, delimited by the */
+    /* transfer encoding or the content length when there is one  */
+    return ATX_HttpResponse_SetupBody(response, stream);
 }
 
 /*----------------------------------------------------------------------
@@ -980,29 +2040,25 @@ extern ATX_Result
 ATX_HttpResponse_Emit(const ATX_HttpResponse* response,
                       ATX_OutputStream*       stream)
 {
+    ATX_StringBuilder builder = ATX_EMPTY_STRING_BUILDER;
+    ATX_Result        result;
+
     /* check that we have what we need */
     if (ATX_String_IsEmpty(&response->base.protocol)) return ATX_ERROR_INVALID_PARAMETERS;
     if (response->status_code >= 1000) return ATX_ERROR_INVALID_PARAMETERS;
 
-    /* output response line */
-    ATX_OutputStream_WriteString(stream, ATX_CSTR(response->base.protocol));
-    {
-        char code_string[5];
-        unsigned  code_int = response->status_code;
-        code_string[0] = ' ';
-        code_string[1] = '0' + code_int/100; 
-        code_int -= 100*(code_int/100);
-        code_string[2] = '0' + code_int/10;
-        code_int -= 10*(code_int/10);
-        code_string[3] = '0' + code_int;
-        code_string[4] = ' ';
-        ATX_OutputStream_Write(stream, code_string, 5, NULL);
-    }
-    ATX_OutputStream_WriteString(stream, ATX_CSTR(response->reason_phrase));
-    ATX_OutputStream_Write(stream, "\r\n", 2, NULL);
-
-    /* output the rest of the message */
-    return ATX_HttpMessage_Emit((ATX_HttpMessage*)response, stream);
+    /* response line */
+    result = ATX_StringBuilder_AppendFormat(&builder, "%s %03u %s\r\n",
+                                            ATX_CSTR(response->base.protocol),
+                                            (unsigned int)response->status_code,
+                                            ATX_CSTR(response->reason_phrase));
+
+    /* headers */
+    if (ATX_SUCCEEDED(result)) {
+        result = ATX_HttpMessage_FormatHeaders(&response->base, &builder);
+    }
+
+    return ATX_HttpMessage_WriteBuilder(&builder, result, stream);
 }
 
 /*----------------------------------------------------------------------
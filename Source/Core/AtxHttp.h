@@ -39,6 +39,7 @@
 #include "AtxDefs.h"
 #include "AtxResults.h"
 #include "AtxUtils.h"
+#include "AtxAtom.h"
 #include "AtxInterfaces.h"
 #include "AtxProperties.h"
 #include "AtxStreams.h"
@@ -58,7 +59,10 @@ typedef struct ATX_HttpResponse ATX_HttpResponse;
 #define ATX_HTTP_METHOD_HEAD    "HEAD"
 #define ATX_HTTP_METHOD_POST    "POST"
 
-#define ATX_HTTP_CLIENT_OPTION_FOLLOW_REDIRECT "FollowRedirect"
+#define ATX_HTTP_CLIENT_OPTION_FOLLOW_REDIRECT          "FollowRedirect"
+#define ATX_HTTP_CLIENT_OPTION_KEEP_ALIVE               "KeepAlive"
+#define ATX_HTTP_CLIENT_OPTION_MAX_CONNECTIONS_PER_HOST "MaxConnectionsPerHost"
+#define ATX_HTTP_CLIENT_OPTION_IDLE_TIMEOUT             "IdleTimeout"
 
 /*----------------------------------------------------------------------
 |    prototypes
@@ -82,6 +86,16 @@ extern const ATX_String*
 ATX_HttpMessage_GetHeader(const ATX_HttpMessage* message,
                           ATX_CString            name);
 
+/**
+ * Same as ATX_HttpMessage_GetHeader, for callers that keep the atom of
+ * the header name around: the lookup only compares pointers, except
+ * for names parsed from a response that were not atoms yet, which are
+ * compared as strings.
+ */
+extern const ATX_String*
+ATX_HttpMessage_GetHeaderByAtom(const ATX_HttpMessage* message,
+                                ATX_Atom               name);
+
 extern ATX_Result
 ATX_HttpMessage_SetProtocol(ATX_HttpMessage* message,
                             ATX_CString      protocol);
@@ -96,7 +110,7 @@ ATX_HttpMessage_SetBody(ATX_HttpMessage* message,
 
 extern ATX_Result
 ATX_HttpMessage_GetBody(const ATX_HttpMessage* message,
-                        ATX_InputStream*       stream,
+                        ATX_InputStream**      stream,
                         ATX_Size*              content_length);
 
 extern ATX_Result
@@ -135,6 +149,16 @@ ATX_HttpResponse_GetStatusCode(const ATX_HttpResponse* response);
 extern const ATX_String*
 ATX_HttpResponse_GetReasonPhrase(const ATX_HttpResponse* response);
 
+/**
+ * Create a stream that decodes a body sent with the "chunked" transfer
+ * encoding. Chunk data is read from the source directly into the 
+ * caller's buffer, and the stream returns ATX_ERROR_EOS after the last
+ * chunk and the trailer have been consumed.
+ */
+extern ATX_Result
+ATX_HttpChunkedInputStream_Create(ATX_InputStream*  source,
+                                  ATX_InputStream** stream);
+
 extern ATX_Result
 ATX_HttpClient_Create(ATX_HttpClient** client);
 
@@ -151,6 +175,34 @@ ATX_HttpClient_GetOptionBool(const ATX_HttpClient* client,
                              ATX_CString           option,
                              ATX_Boolean*          value);
 
+/**
+ * Set an integer option of a client.
+ * ATX_HTTP_CLIENT_OPTION_MAX_CONNECTIONS_PER_HOST is the maximum number
+ * of idle keep-alive connections kept for each host:port, and
+ * ATX_HTTP_CLIENT_OPTION_IDLE_TIMEOUT is the time, in milliseconds,
+ * after which an idle connection is closed instead of being reused.
+ */
+extern ATX_Result
+ATX_HttpClient_SetOptionUInt(ATX_HttpClient* client, 
+                             ATX_CString     option,
+                             ATX_UInt32      value);
+
+extern ATX_Result
+ATX_HttpClient_GetOptionUInt(const ATX_HttpClient* client, 
+                             ATX_CString           option,
+                             ATX_UInt32*           value);
+
+/**
+ * Send a request and wait for the response headers.
+ * When keep-alive is enabled (the default), the connection is taken from
+ * the client's pool of idle connections to the same host:port if one is
+ * available, and is returned to the pool once the response body has been
+ * read to the end. Destroying a response before its body has been fully
+ * read closes the connection.
+ * If a pooled connection turns out to have been closed by the server, a
+ * GET or HEAD request without a body is sent again on a new connection.
+ * Other requests are not repeated, and the error is returned instead.
+ */
 extern ATX_Result 
 ATX_HttpClient_SendRequest(ATX_HttpClient*    client,
                            ATX_HttpRequest*   request,
@@ -34,6 +34,13 @@
 +---------------------------------------------------------------------*/
 #include "AtxJson.h"
 #include "AtxDebug.h"
+#if defined(ATX_CONFIG_HAVE_STRTOD)
+#include <stdlib.h>
+#endif
+#if defined(ATX_CONFIG_HAVE_X86_SIMD) && !defined(ATX_CONFIG_DISABLE_SIMD)
+#define ATX_JSON_USE_X86_SIMD
+#include <immintrin.h>
+#endif
 
 /*----------------------------------------------------------------------
 |    types
@@ -49,14 +56,22 @@ typedef enum {
     ATX_JSON_PARSER_STATE_LITERAL
 } ATX_JsonParser_State;
 
+/* a slot is empty when child is NULL */
+typedef struct {
+    ATX_UInt32 hash;
+    ATX_Json*  child;
+} ATX_JsonSlot;
+
 struct ATX_Json {
-    ATX_String   name;
-    ATX_Json*    parent;
-    ATX_Json*    child;
-    ATX_Cardinal child_count;
-    ATX_Json*    next;
-    ATX_Json*    prev;
-    ATX_JsonType type;
+    ATX_JsonArena* arena;
+    ATX_String     name;
+    ATX_Json*      parent;
+    ATX_Json**     children; /* in insertion order */
+    ATX_Cardinal   child_count;
+    ATX_Cardinal   child_capacity;
+    ATX_JsonSlot*  index;    /* member index of large objects */
+    ATX_Cardinal   index_size;
+    ATX_JsonType   type;
     union {
         double      number;
         ATX_String  string;
@@ -65,6 +80,13 @@ struct ATX_Json {
 };
 
 typedef struct {
+    ATX_IMPLEMENTS(ATX_JsonListener);
+    ATX_JsonArena* arena;
+    ATX_Json*      context;
+    ATX_Json*      root;
+} ATX_JsonTreeBuilder;
+
+struct ATX_JsonParser {
     ATX_JsonParser_State state;
     ATX_Boolean          in_escape;
     ATX_Boolean          in_unicode;
@@ -72,15 +94,51 @@ typedef struct {
     ATX_UInt32           unicode;
     ATX_String           name;
     ATX_String           value;
-    ATX_Json*            context;
-    ATX_Json*            root;
-} ATX_JsonParser;
+    unsigned char*       stack; /* open containers, innermost last */
+    ATX_Cardinal         stack_size;
+    ATX_Cardinal         depth;
+    ATX_Result           result; /* sticky once a feed has failed */
+    ATX_JsonListener*    listener;
+    ATX_JsonTreeBuilder  builder;
+};
+
+typedef ATX_Size (*ATX_JsonScanFunction)(const unsigned char* chars, ATX_Size size);
+
+typedef struct {
+    ATX_JsonScannerType  type;
+    ATX_JsonScanFunction find_string_special;
+    ATX_JsonScanFunction skip_whitespace;
+} ATX_JsonScanner;
+
+typedef struct {
+    char              buffer[ATX_JSON_SERIALIZER_BUFFER_SIZE];
+    ATX_Size          size;
+    ATX_OutputStream* stream; /* if NULL, the output goes to string */
+    ATX_String*       string;
+    ATX_Result        result; /* first write error, if any */
+    ATX_Cardinal      depth;
+    ATX_Boolean       pretty;
+} ATX_JsonWriter;
+
+/*----------------------------------------------------------------------
+|    forward declarations
++---------------------------------------------------------------------*/
+ATX_DECLARE_INTERFACE_MAP(ATX_JsonTreeBuilder, ATX_JsonListener)
 
 /*----------------------------------------------------------------------
 |    constants
 +---------------------------------------------------------------------*/
 static ATX_Json ATX_Json_Null;
 
+#define ATX_JSON_CHILDREN_INITIAL_CAPACITY 4
+#define ATX_JSON_INDEX_THRESHOLD           8 /* members before we index */
+
+#define ATX_JSON_INDENTATION                 4
+
+#define ATX_JSON_PARSER_INITIAL_STACK_SIZE   16
+#define ATX_JSON_PARSER_CONTAINER_TYPE_MASK  0x7F
+#define ATX_JSON_PARSER_CONTAINER_NOT_EMPTY  0x80
+
 /*----------------------------------------------------------------------
 |   character map (generated by MakeJsonCharMap.py)
 |
@@ -164,6 +222,409 @@ static const unsigned char ATX_JsonCharMap[256] = {
 #define ATX_JSON_CHAR_IS_LITERAL(c)    (ATX_JsonCharMap[c]&8)
 #define ATX_JSON_CHAR_IS_CONTROL(c)    (ATX_JsonCharMap[c]&16)
 
+/*----------------------------------------------------------------------
+|    ATX_JsonScanner_FindStringSpecialScalar
+|
+|    returns the number of characters before the first quote, backslash
+|    or control character
++---------------------------------------------------------------------*/
+static ATX_Size
+ATX_JsonScanner_FindStringSpecialScalar(const unsigned char* chars, ATX_Size size)
+{
+    ATX_Size i;
+    for (i=0; i<size; i++) {
+        unsigned char c = chars[i];
+        if (c == '"' || c == '\\' || c < 0x20) break;
+    }
+    return i;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonScanner_SkipWhitespaceScalar
+|
+|    returns the number of whitespace characters at the start
++---------------------------------------------------------------------*/
+static ATX_Size
+ATX_JsonScanner_SkipWhitespaceScalar(const unsigned char* chars, ATX_Size size)
+{
+    ATX_Size i;
+    for (i=0; i<size && ATX_JSON_CHAR_IS_WHITESPACE(chars[i]); i++) {}
+    return i;
+}
+
+#if defined(ATX_JSON_USE_X86_SIMD)
+/*----------------------------------------------------------------------
+|    ATX_JsonScanner_FindStringSpecialSse2
++---------------------------------------------------------------------*/
+__attribute__((target("sse2")))
+static ATX_Size
+ATX_JsonScanner_FindStringSpecialSse2(const unsigned char* chars, ATX_Size size)
+{
+    const __m128i quote     = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control   = _mm_set1_epi8(0x1F);
+    ATX_Size      i;
+
+    for (i=0; i+16 <= size; i += 16) {
+        __m128i chunk   = _mm_loadu_si128((const __m128i*)(chars+i));
+        __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                       _mm_cmpeq_epi8(chunk, backslash));
+        /* min(c, 0x1F) == c <=> c <= 0x1F */
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk));
+        {
+            int mask = _mm_movemask_epi8(special);
+            if (mask) return i+__builtin_ctz(mask);
+        }
+    }
+    return i+ATX_JsonScanner_FindStringSpecialScalar(chars+i, size-i);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonScanner_SkipWhitespaceSse2
++---------------------------------------------------------------------*/
+__attribute__((target("sse2")))
+static ATX_Size
+ATX_JsonScanner_SkipWhitespaceSse2(const unsigned char* chars, ATX_Size size)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab   = _mm_set1_epi8('\t');
+    const __m128i lf    = _mm_set1_epi8('\n');
+    const __m128i cr    = _mm_set1_epi8('\r');
+    ATX_Size      i;
+
+    for (i=0; i+16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(chars+i));
+        __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                                  _mm_cmpeq_epi8(chunk, tab)),
+                                     _mm_or_si128(_mm_cmpeq_epi8(chunk, lf),
+                                                  _mm_cmpeq_epi8(chunk, cr)));
+        int mask = ~_mm_movemask_epi8(blank) & 0xFFFF;
+        if (mask) return i+__builtin_ctz(mask);
+    }
+    return i+ATX_JsonScanner_SkipWhitespaceScalar(chars+i, size-i);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonScanner_FindStringSpecialAvx2
++---------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static ATX_Size
+ATX_JsonScanner_FindStringSpecialAvx2(const unsigned char* chars, ATX_Size size)
+{
+    const __m256i quote     = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control   = _mm256_set1_epi8(0x1F);
+    ATX_Size      i;
+
+    for (i=0; i+32 <= size; i += 32) {
+        __m256i chunk   = _mm256_loadu_si256((const __m256i*)(chars+i));
+        __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                          _mm256_cmpeq_epi8(chunk, backslash));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control), chunk));
+        {
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+            if (mask) return i+__builtin_ctz(mask);
+        }
+    }
+    return i+ATX_JsonScanner_FindStringSpecialSse2(chars+i, size-i);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonScanner_SkipWhitespaceAvx2
++---------------------------------------------------------------------*/
+__attribute__((target("avx2")))
+static ATX_Size
+ATX_JsonScanner_SkipWhitespaceAvx2(const unsigned char* chars, ATX_Size size)
+{
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab   = _mm256_set1_epi8('\t');
+    const __m256i lf    = _mm256_set1_epi8('\n');
+    const __m256i cr    = _mm256_set1_epi8('\r');
+    ATX_Size      i;
+
+    for (i=0; i+32 <= size; i += 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(chars+i));
+        __m256i blank = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space),
+                                                        _mm256_cmpeq_epi8(chunk, tab)),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, lf),
+                                                        _mm256_cmpeq_epi8(chunk, cr)));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(blank);
+        if (mask) return i+__builtin_ctz(mask);
+    }
+    return i+ATX_JsonScanner_SkipWhitespaceSse2(chars+i, size-i);
+}
+#endif /* ATX_JSON_USE_X86_SIMD */
+
+/*----------------------------------------------------------------------
+|    scanners
++---------------------------------------------------------------------*/
+static const ATX_JsonScanner ATX_JsonScanner_Scalar = {
+    ATX_JSON_SCANNER_SCALAR,
+    ATX_JsonScanner_FindStringSpecialScalar,
+    ATX_JsonScanner_SkipWhitespaceScalar
+};
+#if defined(ATX_JSON_USE_X86_SIMD)
+static const ATX_JsonScanner ATX_JsonScanner_Sse2 = {
+    ATX_JSON_SCANNER_SSE2,
+    ATX_JsonScanner_FindStringSpecialSse2,
+    ATX_JsonScanner_SkipWhitespaceSse2
+};
+static const ATX_JsonScanner ATX_JsonScanner_Avx2 = {
+    ATX_JSON_SCANNER_AVX2,
+    ATX_JsonScanner_FindStringSpecialAvx2,
+    ATX_JsonScanner_SkipWhitespaceAvx2
+};
+#endif
+static const ATX_JsonScanner* ATX_JsonScanner_Current = NULL;
+
+/*----------------------------------------------------------------------
+|    ATX_JsonScanner_Find
+|
+|    returns the scanner of the requested type, or NULL if the CPU
+|    doesn't support it
++---------------------------------------------------------------------*/
+static const ATX_JsonScanner*
+ATX_JsonScanner_Find(ATX_JsonScannerType type)
+{
+#if defined(ATX_JSON_USE_X86_SIMD)
+    __builtin_cpu_init();
+    switch (type) {
+      case ATX_JSON_SCANNER_AUTO:
+        /* SSE2 isn't a default: with the short runs of typical */
+        /* documents, it doesn't parse faster than scalar code  */
+        if (__builtin_cpu_supports("avx2")) return &ATX_JsonScanner_Avx2;
+        return &ATX_JsonScanner_Scalar;
+
+      case ATX_JSON_SCANNER_AVX2:
+        return __builtin_cpu_supports("avx2") ? &ATX_JsonScanner_Avx2 : NULL;
+
+      case ATX_JSON_SCANNER_SSE2:
+        return __builtin_cpu_supports("sse2") ? &ATX_JsonScanner_Sse2 : NULL;
+
+      case ATX_JSON_SCANNER_SCALAR:
+        return &ATX_JsonScanner_Scalar;
+    }
+    return NULL;
+#else
+    if (type == ATX_JSON_SCANNER_AUTO || type == ATX_JSON_SCANNER_SCALAR) {
+        return &ATX_JsonScanner_Scalar;
+    } else {
+        return NULL;
+    }
+#endif
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonScanner_Get
++---------------------------------------------------------------------*/
+static const ATX_JsonScanner*
+ATX_JsonScanner_Get(void)
+{
+    /* races are harmless here: every thread selects the same scanner */
+    if (ATX_JsonScanner_Current == NULL) {
+        ATX_JsonScanner_Current = ATX_JsonScanner_Find(ATX_JSON_SCANNER_AUTO);
+    }
+    return ATX_JsonScanner_Current;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Json_SetScanner
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Json_SetScanner(ATX_JsonScannerType type)
+{
+    const ATX_JsonScanner* scanner = ATX_JsonScanner_Find(type);
+    if (scanner == NULL) return ATX_ERROR_NOT_SUPPORTED;
+    ATX_JsonScanner_Current = scanner;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Json_GetScanner
++---------------------------------------------------------------------*/
+ATX_JsonScannerType
+ATX_Json_GetScanner(void)
+{
+    return ATX_JsonScanner_Get()->type;
+}
+
+
+/*----------------------------------------------------------------------
+|    ATX_JsonArena_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_JsonArena_Create(ATX_Size block_size, ATX_JsonArena** arena)
+{
+    return ATX_JsonArena_CreateWithAllocator(block_size, NULL, arena);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonArena_CreateWithAllocator
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_JsonArena_CreateWithAllocator(ATX_Size             block_size, 
+                                  const ATX_Allocator* allocator,
+                                  ATX_JsonArena**      arena)
+{
+    if (block_size == 0) block_size = ATX_JSON_ARENA_DEFAULT_BLOCK_SIZE;
+    return ATX_MemoryArena_Create(block_size, allocator, arena);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonArena_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_JsonArena_Destroy(ATX_JsonArena* self)
+{
+    return ATX_MemoryArena_Destroy(self);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonArena_Reset
++---------------------------------------------------------------------*/
+void
+ATX_JsonArena_Reset(ATX_JsonArena* self)
+{
+    ATX_MemoryArena_Reset(self);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonArena_AssignString
+|
+|    Short strings are stored inline. Longer ones are laid out like a 
+|    heap ATX_String (an ATX_StringBuffer header followed by the 
+|    characters), so that all the read-only ATX_String functions work 
+|    on them.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_JsonArena_AssignString(ATX_JsonArena* self, 
+                           ATX_String*    string, 
+                           const char*    chars, 
+                           ATX_Size       length)
+{
+    ATX_StringBuffer* buffer;
+
+    ATX_String_Construct(string);
+    if (chars == NULL || length <= ATX_STRING_INLINE_CAPACITY) {
+        return ATX_String_AssignN(string, chars, length);
+    }
+    buffer = (ATX_StringBuffer*)ATX_MemoryArena_Allocate(self, sizeof(ATX_StringBuffer)+length+1);
+    if (buffer == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    buffer->length    = length;
+    buffer->allocated = length;
+    string->chars = (char*)(buffer+1);
+    ATX_CopyMemory(string->chars, chars, length);
+    string->chars[length] = '\0';
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonArena_CreateNode
++---------------------------------------------------------------------*/
+static ATX_Json*
+ATX_JsonArena_CreateNode(ATX_JsonArena* self, ATX_JsonType type)
+{
+    ATX_Json* json = (ATX_Json*)ATX_MemoryArena_Allocate(self, sizeof(ATX_Json));
+    if (json == NULL) return NULL;
+    ATX_SetMemory(json, 0, sizeof(ATX_Json));
+    json->arena = self;
+    json->type  = type;
+
+    return json;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Json_AllocateStorage
++---------------------------------------------------------------------*/
+static void*
+ATX_Json_AllocateStorage(ATX_Json* self, ATX_Size size)
+{
+    if (self->arena) {
+        return ATX_MemoryArena_Allocate(self->arena, size);
+    } else {
+        return ATX_AllocateMemory(size);
+    }
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Json_FreeStorage
+|
+|    storage taken from an arena is only reclaimed with the arena
++---------------------------------------------------------------------*/
+static void
+ATX_Json_FreeStorage(ATX_Json* self, void* storage)
+{
+    if (self->arena == NULL && storage) ATX_FreeMemory(storage);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Json_HashName
+|
+|    32-bit FNV-1a hash
++---------------------------------------------------------------------*/
+static ATX_UInt32
+ATX_Json_HashName(const char* name)
+{
+    ATX_UInt32 hash = 0x811C9DC5;
+    const unsigned char* n = (const unsigned char*)name;
+    while (*n) {
+        hash ^= *n++;
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Json_IndexChild
+|
+|    a later member with the same name replaces an earlier one, so that
+|    lookups return the last member added under a name.
++---------------------------------------------------------------------*/
+static void
+ATX_Json_IndexChild(ATX_Json* self, ATX_Json* child)
+{
+    ATX_Cardinal mask = self->index_size-1;
+    ATX_UInt32   hash = ATX_Json_HashName(ATX_String_GetChars(&child->name));
+    ATX_Ordinal  i;
+
+    for (i = hash&mask;; i = (i+1)&mask) {
+        ATX_JsonSlot* slot = &self->index[i];
+        if (slot->child == NULL ||
+            (slot->hash == hash && 
+             ATX_String_Equals(&slot->child->name, 
+                               ATX_String_GetChars(&child->name), 
+                               ATX_FALSE))) {
+            slot->hash  = hash;
+            slot->child = child;
+            return;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Json_BuildIndex
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_Json_BuildIndex(ATX_Json* self)
+{
+    ATX_Cardinal size = 16;
+    ATX_Ordinal  i;
+
+    /* keep the load factor under 1/2 */
+    while (size < 2*self->child_count) size *= 2;
+    self->index = (ATX_JsonSlot*)ATX_Json_AllocateStorage(self, size*sizeof(ATX_JsonSlot));
+    if (self->index == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    ATX_SetMemory(self->index, 0, size*sizeof(ATX_JsonSlot));
+    self->index_size = size;
+    for (i=0; i<self->child_count; i++) {
+        ATX_Json_IndexChild(self, self->children[i]);
+    }
+
+    return ATX_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
 |    ATX_Json_Create
 +---------------------------------------------------------------------*/
@@ -249,15 +710,19 @@ ATX_Json_CreateNull(void)
 void
 ATX_Json_Destroy(ATX_Json* self)
 {
-    ATX_Json* child = self->child;
+    ATX_Ordinal i;
+
+    /* arena nodes are released with their arena */
+    if (self->arena) return;
+
     if (self->type == ATX_JSON_TYPE_STRING) {
         ATX_String_Destruct(&self->value.string);
     }
-    while (child) {
-        ATX_Json* next = child->next;
-        ATX_Json_Destroy(child);
-        child = next;
+    for (i=0; i<self->child_count; i++) {
+        ATX_Json_Destroy(self->children[i]);
     }
+    ATX_Json_FreeStorage(self, self->children);
+    ATX_Json_FreeStorage(self, self->index);
     ATX_String_Destruct(&self->name);
     ATX_FreeMemory(self);
 }
@@ -268,12 +733,27 @@ ATX_Json_Destroy(ATX_Json* self)
 ATX_Json*    
 ATX_Json_GetChild(ATX_Json* self, const char* name)
 {
-    ATX_Json* child = self->child;
-    while (child) {
-        if (ATX_String_Equals(&child->name, name, ATX_FALSE)) {
-            return child;
+    ATX_Ordinal i;
+
+    /* large objects are looked up through their index */
+    if (self->index) {
+        ATX_Cardinal mask = self->index_size-1;
+        ATX_UInt32   hash = ATX_Json_HashName(name);
+        for (i = hash&mask;; i = (i+1)&mask) {
+            ATX_JsonSlot* slot = &self->index[i];
+            if (slot->child == NULL) return NULL;
+            if (slot->hash == hash && 
+                ATX_String_Equals(&slot->child->name, name, ATX_FALSE)) {
+                return slot->child;
+            }
+        }
+    }
+
+    /* search from the end, so that the last of duplicate names wins */
+    for (i=self->child_count; i--;) {
+        if (ATX_String_Equals(&self->children[i]->name, name, ATX_FALSE)) {
+            return self->children[i];
         }
-        child = child->next;
     }
     
     return NULL;
@@ -285,17 +765,11 @@ ATX_Json_GetChild(ATX_Json* self, const char* name)
 ATX_Json*    
 ATX_Json_GetChildAt(ATX_Json* self, ATX_Ordinal indx, const char** name)
 {
-    ATX_Json* child = self->child;
+    ATX_Json* child;
     if (name) *name = NULL;
     
-    /* start from the end of the list */
     if (indx >= self->child_count) return NULL;
-    indx = self->child_count-indx-1;
-    while (indx) {
-        child = child->next;
-        if (child == NULL) return NULL;
-        --indx;
-    }
+    child = self->children[indx];
     if (name) {
         if (self->type == ATX_JSON_TYPE_OBJECT) {
             /* only children of Objects have names, even if they may be empty */
@@ -337,14 +811,52 @@ ATX_Json_AddChild(ATX_Json* self, const char* name, ATX_Json* child)
     } else if (self->type != ATX_JSON_TYPE_OBJECT) {
         return ATX_ERROR_INVALID_PARAMETERS;
     }
+
+    /* a tree can't mix arena and heap nodes */
+    if (child->arena != self->arena) return ATX_ERROR_INVALID_PARAMETERS;
     
-    ATX_String_Assign(&child->name, name);
-    child->parent     = self;
-    child->next       = self->child;
-    child->prev       = NULL;
-    if (self->child) self->child->prev = child;
-    self->child       = child;
-    ++self->child_count;
+    if (child->arena) {
+        ATX_Result result = ATX_JsonArena_AssignString(child->arena, 
+                                                       &child->name, 
+                                                       name, 
+                                                       name?ATX_StringLength(name):0);
+        if (ATX_FAILED(result)) return result;
+    } else {
+        ATX_String_Assign(&child->name, name);
+    }
+
+    /* grow the children vector if needed */
+    if (self->child_count == self->child_capacity) {
+        ATX_Cardinal capacity = self->child_capacity ? 
+                                2*self->child_capacity : 
+                                ATX_JSON_CHILDREN_INITIAL_CAPACITY;
+        ATX_Json** children = (ATX_Json**)ATX_Json_AllocateStorage(self, capacity*sizeof(ATX_Json*));
+        if (children == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        if (self->child_count) {
+            ATX_CopyMemory(children, self->children, self->child_count*sizeof(ATX_Json*));
+        }
+        ATX_Json_FreeStorage(self, self->children);
+        self->children       = children;
+        self->child_capacity = capacity;
+    }
+    self->children[self->child_count++] = child;
+    child->parent = self;
+
+    /* the index is maintained here rather than built on the first */
+    /* lookup, so that lookups never modify the tree                */
+    if (self->type == ATX_JSON_TYPE_OBJECT &&
+        self->child_count >= ATX_JSON_INDEX_THRESHOLD) {
+        if (self->index && 2*self->child_count <= self->index_size) {
+            ATX_Json_IndexChild(self, child);
+        } else {
+            ATX_Json_FreeStorage(self, self->index);
+            self->index      = NULL;
+            self->index_size = 0;
+
+            /* without an index, lookups just search the children */
+            ATX_Json_BuildIndex(self);
+        }
+    }
     
     return ATX_SUCCESS; 
 }
@@ -411,20 +923,176 @@ ATX_Json_AsString(ATX_Json* self)
 }
 
 /*----------------------------------------------------------------------
-|   ATX_JsonParser_Construct
+|   ATX_JsonTreeBuilder_CreateNode
++---------------------------------------------------------------------*/
+static ATX_Json*
+ATX_JsonTreeBuilder_CreateNode(ATX_JsonTreeBuilder* self, ATX_JsonType type)
+{
+    if (self->arena) {
+        return ATX_JsonArena_CreateNode(self->arena, type);
+    } else {
+        return ATX_Json_Create(type);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonTreeBuilder_AddNode
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_JsonTreeBuilder_AddNode(ATX_JsonTreeBuilder* self, 
+                            const char*          name, 
+                            ATX_Json*            node)
+{
+    if (node == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    
+    if (self->context) {
+        ATX_Result result = ATX_Json_AddChild(self->context, name, node);
+        if (ATX_FAILED(result)) {
+            ATX_Json_Destroy(node);
+            return result;
+        }
+    } else {
+        ATX_ASSERT(self->root == NULL);
+        self->root = node;
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonTreeBuilder_OnStartContainer
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_JsonTreeBuilder_OnStartContainer(ATX_JsonListener* _self, 
+                                     const char*       name,
+                                     ATX_JsonType      type)
+{
+    ATX_JsonTreeBuilder* self = ATX_SELF(ATX_JsonTreeBuilder, ATX_JsonListener);
+    ATX_Json*            node = ATX_JsonTreeBuilder_CreateNode(self, type);
+    ATX_Result           result;
+
+    result = ATX_JsonTreeBuilder_AddNode(self, name, node);
+    if (ATX_FAILED(result)) return result;
+    self->context = node;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonTreeBuilder_OnEndContainer
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_JsonTreeBuilder_OnEndContainer(ATX_JsonListener* _self, ATX_JsonType type)
+{
+    ATX_JsonTreeBuilder* self = ATX_SELF(ATX_JsonTreeBuilder, ATX_JsonListener);
+    ATX_COMPILER_UNUSED(type);
+
+    self->context = self->context->parent;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonTreeBuilder_OnValue
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_JsonTreeBuilder_OnValue(ATX_JsonListener*    _self, 
+                            const char*          name, 
+                            const ATX_JsonValue* value)
+{
+    ATX_JsonTreeBuilder* self = ATX_SELF(ATX_JsonTreeBuilder, ATX_JsonListener);
+    ATX_Json*            node = ATX_JsonTreeBuilder_CreateNode(self, value->type);
+    
+    if (node) {
+        switch (value->type) {
+          case ATX_JSON_TYPE_NUMBER:
+            node->value.number = value->value.number;
+            break;
+
+          case ATX_JSON_TYPE_BOOLEAN:
+            node->value.boolean = value->value.boolean;
+            break;
+
+          case ATX_JSON_TYPE_STRING:
+            if (self->arena) {
+                if (ATX_FAILED(ATX_JsonArena_AssignString(self->arena, 
+                                                          &node->value.string,
+                                                          value->value.string.chars,
+                                                          value->value.string.length))) {
+                    return ATX_ERROR_OUT_OF_MEMORY;
+                }
+            } else {
+                ATX_Result result = ATX_String_AssignN(&node->value.string, 
+                                                       value->value.string.chars,
+                                                       value->value.string.length);
+                if (ATX_FAILED(result)) {
+                    ATX_Json_Destroy(node);
+                    return result;
+                }
+            }
+            break;
+
+          default:
+            break;
+        }
+    }
+
+    return ATX_JsonTreeBuilder_AddNode(self, name, node);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonTreeBuilder interfaces
++---------------------------------------------------------------------*/
+ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(ATX_JsonTreeBuilder)
+    ATX_GET_INTERFACE_ACCEPT(ATX_JsonTreeBuilder, ATX_JsonListener)
+ATX_END_GET_INTERFACE_IMPLEMENTATION
+
+ATX_BEGIN_INTERFACE_MAP(ATX_JsonTreeBuilder, ATX_JsonListener)
+    ATX_JsonTreeBuilder_OnStartContainer,
+    ATX_JsonTreeBuilder_OnEndContainer,
+    ATX_JsonTreeBuilder_OnValue
+};
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_Reset
 +---------------------------------------------------------------------*/
 static void
-ATX_JsonParser_Construct(ATX_JsonParser* self)
+ATX_JsonParser_Reset(ATX_JsonParser* self)
 {
     self->state         = ATX_JSON_PARSER_STATE_VALUE;
     self->in_escape     = ATX_FALSE;
     self->in_unicode    = ATX_FALSE;
     self->unicode_chars = 0;
     self->unicode       = 0;
-    self->context       = NULL;
-    self->root          = NULL;
+    self->depth         = 0;
+    self->result        = ATX_SUCCESS;
+    ATX_String_SetLength(&self->name,  0);
+    ATX_String_SetLength(&self->value, 0);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_Construct
++---------------------------------------------------------------------*/
+static void
+ATX_JsonParser_Construct(ATX_JsonParser* self, 
+                         ATX_JsonArena*    arena, 
+                         ATX_JsonListener* listener)
+{
     ATX_String_Construct(&self->name);
     ATX_String_Construct(&self->value);
+    self->stack      = NULL;
+    self->stack_size = 0;
+    ATX_JsonParser_Reset(self);
+
+    self->builder.arena   = arena;
+    self->builder.context = NULL;
+    self->builder.root    = NULL;
+    ATX_SET_INTERFACE(&self->builder, ATX_JsonTreeBuilder, ATX_JsonListener);
+    if (listener) {
+        self->listener = listener;
+    } else {
+        self->listener = &ATX_BASE(&self->builder, ATX_JsonListener);
+    }
 }
 
 /*----------------------------------------------------------------------
@@ -433,31 +1101,132 @@ ATX_JsonParser_Construct(ATX_JsonParser* self)
 static void
 ATX_JsonParser_Destruct(ATX_JsonParser* self)
 {
-    if (self->context) ATX_Json_Destroy(self->context);
+    if (self->builder.root) ATX_Json_Destroy(self->builder.root);
+    if (self->stack) ATX_FreeMemory(self->stack);
     ATX_String_Destruct(&self->name);
     ATX_String_Destruct(&self->value);
 }
 
 /*----------------------------------------------------------------------
-|   ATX_JsonParser_OnNewValue
+|   ATX_JsonParser_Create
 +---------------------------------------------------------------------*/
-static void
-ATX_JsonParser_OnNewValue(ATX_JsonParser* self, ATX_Json* value)
+ATX_Result
+ATX_JsonParser_Create(ATX_JsonArena* arena, ATX_JsonParser** parser)
 {
-    if (self->context) {
-        const char* name = NULL;
-        if (!ATX_String_IsEmpty(&self->name)) {
-            name = ATX_String_GetChars(&self->name);
-        }
-        ATX_Json_AddChild(self->context, name, value);
-        if (name) ATX_String_SetLength(&self->name, 0);
+    *parser = (ATX_JsonParser*)ATX_AllocateMemory(sizeof(ATX_JsonParser));
+    if (*parser == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    ATX_JsonParser_Construct(*parser, arena, NULL);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_CreateWithListener
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_JsonParser_CreateWithListener(ATX_JsonListener* listener, ATX_JsonParser** parser)
+{
+    if (listener == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+    *parser = (ATX_JsonParser*)ATX_AllocateMemory(sizeof(ATX_JsonParser));
+    if (*parser == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    ATX_JsonParser_Construct(*parser, NULL, listener);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_JsonParser_Destroy(ATX_JsonParser* self)
+{
+    ATX_JsonParser_Destruct(self);
+    ATX_FreeMemory(self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_GetMemberName
+|
+|   returns the name of the next value, or NULL when not in an object,
+|   and marks the current container as non-empty
++---------------------------------------------------------------------*/
+static const char*
+ATX_JsonParser_GetMemberName(ATX_JsonParser* self)
+{
+    unsigned char* top;
+    
+    if (self->depth == 0) return NULL;
+    top = &self->stack[self->depth-1];
+    *top |= ATX_JSON_PARSER_CONTAINER_NOT_EMPTY;
+    if ((*top & ATX_JSON_PARSER_CONTAINER_TYPE_MASK) == ATX_JSON_TYPE_OBJECT) {
+        return ATX_CSTR(self->name);
     } else {
-        ATX_ASSERT(self->root == NULL);
-        self->root = value;
+        return NULL;
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_OnStartContainer
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_JsonParser_OnStartContainer(ATX_JsonParser* self, ATX_JsonType type)
+{
+    ATX_Result result;
+
+    /* make room on the stack */
+    if (self->depth == self->stack_size) {
+        ATX_Cardinal   stack_size = self->stack_size?2*self->stack_size:ATX_JSON_PARSER_INITIAL_STACK_SIZE;
+        unsigned char* stack = (unsigned char*)ATX_AllocateMemory(stack_size);
+        if (stack == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        if (self->stack) {
+            ATX_CopyMemory(stack, self->stack, self->depth);
+            ATX_FreeMemory(self->stack);
+        }
+        self->stack      = stack;
+        self->stack_size = stack_size;
     }
+
+    result = ATX_JsonListener_OnStartContainer(self->listener, 
+                                               ATX_JsonParser_GetMemberName(self), 
+                                               type);
+    if (ATX_FAILED(result)) return result;
+    ATX_String_SetLength(&self->name, 0);
+    self->stack[self->depth++] = (unsigned char)type;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_OnEndContainer
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_JsonParser_OnEndContainer(ATX_JsonParser* self)
+{
+    ATX_JsonType type = (ATX_JsonType)(self->stack[--self->depth] & 
+                                       ATX_JSON_PARSER_CONTAINER_TYPE_MASK);
+    return ATX_JsonListener_OnEndContainer(self->listener, type);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_OnValue
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_JsonParser_OnValue(ATX_JsonParser* self, ATX_JsonValue* value)
+{
+    ATX_Result result;
     
-    /* reset the value buffer */
+    result = ATX_JsonListener_OnValue(self->listener, 
+                                      ATX_JsonParser_GetMemberName(self), 
+                                      value);
+    if (ATX_FAILED(result)) return result;
+    
+    /* reset the name and value buffers */
+    ATX_String_SetLength(&self->name, 0);
     ATX_String_SetLength(&self->value, 0);
+
+    return ATX_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
@@ -487,31 +1256,56 @@ ATX_JsonParser_AppendUTF8(ATX_String* dest, unsigned int c)
     }
 }
 
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_SkipWhitespace
+|
+|   the first character is known to be whitespace. Single separating
+|   spaces are common, so only call the scanner for longer runs.
++---------------------------------------------------------------------*/
+static ATX_Size
+ATX_JsonParser_SkipWhitespace(const ATX_JsonScanner* scanner, 
+                              const char*            chars, 
+                              ATX_Size               size)
+{
+    if (size < 2 || !ATX_JSON_CHAR_IS_WHITESPACE((unsigned char)chars[1])) return 1;
+    return scanner->skip_whitespace((const unsigned char*)chars, size);
+}
+
 /*----------------------------------------------------------------------
 |   ATX_JsonParser_Parse
 +---------------------------------------------------------------------*/
 static ATX_Result   
 ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size)
 {
+    const ATX_JsonScanner* scanner = ATX_JsonScanner_Get();
+    ATX_JsonValue          value;
+    unsigned int           context_type;
+    ATX_Size               skip;
+    ATX_Result             result;
+    
     /* parse chars one by one */
     while (size) {
         unsigned char c = *serialized;
         switch (self->state) {
           case ATX_JSON_PARSER_STATE_VALUE:
-            if (ATX_JSON_CHAR_IS_WHITESPACE(c)) break;
+            if (ATX_JSON_CHAR_IS_WHITESPACE(c)) {
+                skip = ATX_JsonParser_SkipWhitespace(scanner, serialized, size);
+                serialized += skip;
+                size       -= skip;
+                continue;
+            }
             if (c == '\0') break;
             if (c == '{') {
-                ATX_Json* object = ATX_Json_CreateObject();
-                ATX_JsonParser_OnNewValue(self, object);
-                self->context = object;
+                result = ATX_JsonParser_OnStartContainer(self, ATX_JSON_TYPE_OBJECT);
+                if (ATX_FAILED(result)) return result;
                 self->state = ATX_JSON_PARSER_STATE_NAMED_VALUE;
             } else if (c == '[') {
-                ATX_Json* array = ATX_Json_CreateArray();
-                ATX_JsonParser_OnNewValue(self, array);
-                self->context = array;
+                result = ATX_JsonParser_OnStartContainer(self, ATX_JSON_TYPE_ARRAY);
+                if (ATX_FAILED(result)) return result;
                 self->state = ATX_JSON_PARSER_STATE_VALUE;
             } else if (c == ']') {
-                if (self->context == NULL || self->context->child_count) {
+                if (self->depth == 0 || 
+                    (self->stack[self->depth-1] & ATX_JSON_PARSER_CONTAINER_NOT_EMPTY)) {
                     return ATX_ERROR_INVALID_SYNTAX;
                 }
                 self->state = ATX_JSON_PARSER_STATE_DELIMITER;
@@ -530,11 +1324,17 @@ ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size
             break;
             
           case ATX_JSON_PARSER_STATE_NAMED_VALUE:
-            if (ATX_JSON_CHAR_IS_WHITESPACE(c)) break;
+            if (ATX_JSON_CHAR_IS_WHITESPACE(c)) {
+                skip = ATX_JsonParser_SkipWhitespace(scanner, serialized, size);
+                serialized += skip;
+                size       -= skip;
+                continue;
+            }
             if (c == '"') {
                 self->state = ATX_JSON_PARSER_STATE_NAME;
             } else if (c == '}') {
-                if (self->context == NULL || self->context->child_count) {
+                if (self->depth == 0 || 
+                    (self->stack[self->depth-1] & ATX_JSON_PARSER_CONTAINER_NOT_EMPTY)) {
                     return ATX_ERROR_INVALID_SYNTAX;
                 }
                 self->state = ATX_JSON_PARSER_STATE_DELIMITER;
@@ -545,21 +1345,28 @@ ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size
             break;
             
           case ATX_JSON_PARSER_STATE_DELIMITER:
-            if (ATX_JSON_CHAR_IS_WHITESPACE(c)) break;
-            if (self->context == NULL) {
+            if (ATX_JSON_CHAR_IS_WHITESPACE(c)) {
+                skip = ATX_JsonParser_SkipWhitespace(scanner, serialized, size);
+                serialized += skip;
+                size       -= skip;
+                continue;
+            }
+            if (self->depth == 0) {
                 if (c == '\0') {
                     break;
                 } else {
                     return ATX_ERROR_INVALID_SYNTAX;
                 }
             }
-            if ((c == '}' && self->context->type == ATX_JSON_TYPE_OBJECT) ||
-                (c == ']' && self->context->type == ATX_JSON_TYPE_ARRAY)) {
-                self->context = self->context->parent;
+            context_type = self->stack[self->depth-1] & ATX_JSON_PARSER_CONTAINER_TYPE_MASK;
+            if ((c == '}' && context_type == ATX_JSON_TYPE_OBJECT) ||
+                (c == ']' && context_type == ATX_JSON_TYPE_ARRAY)) {
+                result = ATX_JsonParser_OnEndContainer(self);
+                if (ATX_FAILED(result)) return result;
                 break;
             }
             if (c != ',') return ATX_ERROR_INVALID_SYNTAX;
-            if (self->context->type == ATX_JSON_TYPE_OBJECT) {
+            if (context_type == ATX_JSON_TYPE_OBJECT) {
                 self->state = ATX_JSON_PARSER_STATE_NAMED_VALUE;
             } else {
                 self->state = ATX_JSON_PARSER_STATE_VALUE;
@@ -567,7 +1374,12 @@ ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size
             break;
             
           case ATX_JSON_PARSER_STATE_COLON:
-            if (ATX_JSON_CHAR_IS_WHITESPACE(c)) break;
+            if (ATX_JSON_CHAR_IS_WHITESPACE(c)) {
+                skip = ATX_JsonParser_SkipWhitespace(scanner, serialized, size);
+                serialized += skip;
+                size       -= skip;
+                continue;
+            }
             if (c == ':') {
                 self->state = ATX_JSON_PARSER_STATE_VALUE;
             } else {
@@ -577,6 +1389,20 @@ ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size
             
           case ATX_JSON_PARSER_STATE_NAME:
           case ATX_JSON_PARSER_STATE_STRING:
+            if (!self->in_unicode && !self->in_escape) {
+                /* copy the run of plain characters in one go */
+                skip = scanner->find_string_special((const unsigned char*)serialized, size);
+                if (skip) {
+                    if (self->state == ATX_JSON_PARSER_STATE_NAME) {
+                        ATX_String_AppendSubString(&self->name, serialized, skip);
+                    } else {
+                        ATX_String_AppendSubString(&self->value, serialized, skip);
+                    }
+                    serialized += skip;
+                    size       -= skip;
+                    continue;
+                }
+            }
             if (self->in_unicode) {
                 int nibble = ATX_HexToNibble(c);
                 if (nibble < 0) return ATX_ERROR_INVALID_SYNTAX;
@@ -620,7 +1446,11 @@ ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size
                 if (self->state == ATX_JSON_PARSER_STATE_NAME) {
                     self->state = ATX_JSON_PARSER_STATE_COLON;
                 } else {
-                    ATX_JsonParser_OnNewValue(self, ATX_Json_CreateString(ATX_CSTR(self->value)));
+                    value.type                = ATX_JSON_TYPE_STRING;
+                    value.value.string.chars  = ATX_CSTR(self->value);
+                    value.value.string.length = ATX_String_GetLength(&self->value);
+                    result = ATX_JsonParser_OnValue(self, &value);
+                    if (ATX_FAILED(result)) return result;
                     self->state = ATX_JSON_PARSER_STATE_DELIMITER;
                 }
                 break;
@@ -642,8 +1472,7 @@ ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size
             if (ATX_JSON_CHAR_IS_NUMBER(c)) {
                 ATX_String_AppendChar(&self->value, c);
             } else {
-                double     number = 0.0;
-                ATX_Result result;
+                double number = 0.0;
                 
                 /* integers can't start with a zero */
                 if (ATX_String_GetLength(&self->value) >= 2) {
@@ -657,7 +1486,14 @@ ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size
                 /* parse the number */
                 result = ATX_ParseDouble(ATX_CSTR(self->value), &number, ATX_FALSE);
                 if (ATX_FAILED(result)) return ATX_ERROR_INVALID_SYNTAX;
-                ATX_JsonParser_OnNewValue(self, ATX_Json_CreateNumber(number));
+#if defined(ATX_CONFIG_HAVE_STRTOD)
+                /* get the correctly rounded value, so that numbers round-trip */
+                number = strtod(ATX_CSTR(self->value), NULL);
+#endif
+                value.type         = ATX_JSON_TYPE_NUMBER;
+                value.value.number = number;
+                result = ATX_JsonParser_OnValue(self, &value);
+                if (ATX_FAILED(result)) return result;
                 self->state = ATX_JSON_PARSER_STATE_DELIMITER;
                 continue;
             }
@@ -668,14 +1504,18 @@ ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size
                 ATX_String_AppendChar(&self->value, c);
             } else {
                 if (ATX_String_Equals(&self->value, "true", ATX_FALSE)) {
-                    ATX_JsonParser_OnNewValue(self, ATX_Json_CreateBoolean(ATX_TRUE));
+                    value.type          = ATX_JSON_TYPE_BOOLEAN;
+                    value.value.boolean = ATX_TRUE;
                 } else if (ATX_String_Equals(&self->value, "false", ATX_FALSE)) {
-                    ATX_JsonParser_OnNewValue(self, ATX_Json_CreateBoolean(ATX_FALSE));
+                    value.type          = ATX_JSON_TYPE_BOOLEAN;
+                    value.value.boolean = ATX_FALSE;
                 } else if (ATX_String_Equals(&self->value, "null", ATX_FALSE)) {
-                    ATX_JsonParser_OnNewValue(self, ATX_Json_CreateNull());
+                    value.type          = ATX_JSON_TYPE_NULL;
                 } else {
                     return ATX_ERROR_INVALID_SYNTAX;
                 }
+                result = ATX_JsonParser_OnValue(self, &value);
+                if (ATX_FAILED(result)) return result;
                 self->state = ATX_JSON_PARSER_STATE_DELIMITER;
                 continue;
             } 
@@ -689,46 +1529,147 @@ ATX_JsonParser_Parse(ATX_JsonParser* self, const char* serialized, ATX_Size size
 }
 
 /*----------------------------------------------------------------------
-|   ATX_Json_ParseBuffer
+|   ATX_JsonParser_Feed
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_JsonParser_Feed(ATX_JsonParser* self, const void* data, ATX_Size size)
+{
+    if (ATX_FAILED(self->result)) return self->result;
+    self->result = ATX_JsonParser_Parse(self, (const char*)data, size);
+    
+    return self->result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_FeedStream
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_JsonParser_FeedStream(ATX_JsonParser* self, ATX_InputStream* stream)
+{
+    char       buffer[ATX_JSON_PARSER_STREAM_BUFFER_SIZE];
+    ATX_Size   bytes_read;
+    ATX_Result result;
+
+    for (;;) {
+        result = ATX_InputStream_Read(stream, buffer, sizeof(buffer), &bytes_read);
+        if (result == ATX_ERROR_EOS) return ATX_SUCCESS;
+        if (ATX_FAILED(result)) return result;
+        if (bytes_read == 0) return ATX_SUCCESS;
+        result = ATX_JsonParser_Feed(self, buffer, bytes_read);
+        if (ATX_FAILED(result)) return result;
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_JsonParser_Finish
+|
+|   completes the current document, and leaves the parser ready for
+|   a new one. When building a tree, the root is returned through json
+|   (or destroyed if json is NULL). 
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_JsonParser_Finish(ATX_JsonParser* self, ATX_Json** json)
+{
+    char       termination = '\0';
+    ATX_Result result;
+    
+    if (json) *json = NULL;
+    
+    /* feed a termination and check that the document is complete */
+    result = ATX_JsonParser_Feed(self, &termination, 1);
+    if (ATX_SUCCEEDED(result) && self->depth) result = ATX_ERROR_INVALID_SYNTAX;
+
+    /* return the root object produced by the parser */
+    if (ATX_SUCCEEDED(result) && json) {
+        *json = self->builder.root;
+        self->builder.root = NULL;
+    }
+
+    /* get ready for the next document */
+    if (self->builder.root) {
+        ATX_Json_Destroy(self->builder.root);
+        self->builder.root = NULL;
+    }
+    self->builder.context = NULL;
+    ATX_JsonParser_Reset(self);
+    
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Json_ParseBufferEx
 +---------------------------------------------------------------------*/
 ATX_Result   
-ATX_Json_ParseBuffer(const char* serialized, ATX_Size size, ATX_Json** json)
+ATX_Json_ParseBufferEx(const char*    serialized, 
+                       ATX_Size       size, 
+                       ATX_JsonArena* arena,
+                       ATX_Json**     json)
 {
-    ATX_JsonParser parser;
-    ATX_Result     result;
-    char           termination = '\0';
+    ATX_JsonParser      parser;
+    ATX_MemoryArenaMark mark;
+    ATX_Result          result;
     
     /* construct the parser */
-    ATX_JsonParser_Construct(&parser);
+    ATX_JsonParser_Construct(&parser, arena, NULL);
+    if (arena) ATX_MemoryArena_GetMark(arena, &mark);
     
-    /* start empty */
-    *json = NULL;
-
     /* parse the buffer */
-    result = ATX_JsonParser_Parse(&parser, serialized, size);
-    if (ATX_FAILED(result)) goto end;
+    result = ATX_JsonParser_Feed(&parser, serialized, size);
+    if (ATX_SUCCEEDED(result)) {
+        result = ATX_JsonParser_Finish(&parser, json);
+    } else {
+        *json = NULL;
+    }
     
-    /* feed a termination */
-    result = ATX_JsonParser_Parse(&parser, &termination, 1);
-    if (ATX_FAILED(result)) goto end;
+    /* destruct the parser */
+    ATX_JsonParser_Destruct(&parser);
 
-    /* return the root object produced by the parser */
+    /* give back what a failed parse took from the arena */
+    if (arena && ATX_FAILED(result)) ATX_MemoryArena_Rewind(arena, &mark);
+    
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Json_ParseStream
++---------------------------------------------------------------------*/
+ATX_Result   
+ATX_Json_ParseStream(ATX_InputStream* stream, ATX_JsonArena* arena, ATX_Json** json)
+{
+    ATX_JsonParser      parser;
+    ATX_MemoryArenaMark mark;
+    ATX_Result          result;
+    
+    /* construct the parser */
+    ATX_JsonParser_Construct(&parser, arena, NULL);
+    if (arena) ATX_MemoryArena_GetMark(arena, &mark);
+    
+    /* parse the stream */
+    result = ATX_JsonParser_FeedStream(&parser, stream);
     if (ATX_SUCCEEDED(result)) {
-        if (parser.context) {
-            result = ATX_ERROR_INVALID_SYNTAX;
-        } else {
-            *json = parser.root;
-            parser.root = NULL;
-        }
+        result = ATX_JsonParser_Finish(&parser, json);
+    } else {
+        *json = NULL;
     }
     
-end:
     /* destruct the parser */
     ATX_JsonParser_Destruct(&parser);
+
+    /* give back what a failed parse took from the arena */
+    if (arena && ATX_FAILED(result)) ATX_MemoryArena_Rewind(arena, &mark);
     
     return result;
 }
 
+/*----------------------------------------------------------------------
+|   ATX_Json_ParseBuffer
++---------------------------------------------------------------------*/
+ATX_Result   
+ATX_Json_ParseBuffer(const char* serialized, ATX_Size size, ATX_Json** json)
+{
+    return ATX_Json_ParseBufferEx(serialized, size, NULL, json);
+}
+
 /*----------------------------------------------------------------------
 |    ATX_Json_Parse
 +---------------------------------------------------------------------*/
@@ -738,18 +1679,97 @@ ATX_Json_Parse(const char* serialized, ATX_Json** json)
     return ATX_Json_ParseBuffer(serialized, ATX_StringLength(serialized), json);
 }
 
+/*----------------------------------------------------------------------
+|    ATX_JsonWriter_Flush
+|
+|    Once a write has failed, the buffered output is discarded.
++---------------------------------------------------------------------*/
+static void
+ATX_JsonWriter_Flush(ATX_JsonWriter* self)
+{
+    if (self->size && ATX_SUCCEEDED(self->result)) {
+        if (self->stream) {
+            self->result = ATX_OutputStream_WriteFully(self->stream, self->buffer, self->size);
+        } else {
+            self->result = ATX_String_AppendSubString(self->string, self->buffer, self->size);
+        }
+    }
+    self->size = 0;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonWriter_Write
++---------------------------------------------------------------------*/
+static void
+ATX_JsonWriter_Write(ATX_JsonWriter* self, const char* chars, ATX_Size size)
+{
+    if (ATX_FAILED(self->result)) return;
+    while (size) {
+        ATX_Size chunk = sizeof(self->buffer)-self->size;
+        if (chunk > size) chunk = size;
+        ATX_CopyMemory(self->buffer+self->size, chars, chunk);
+        self->size += chunk;
+        chars      += chunk;
+        size       -= chunk;
+        if (self->size == sizeof(self->buffer)) ATX_JsonWriter_Flush(self);
+    }
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonWriter_WriteChar
++---------------------------------------------------------------------*/
+static void
+ATX_JsonWriter_WriteChar(ATX_JsonWriter* self, char c)
+{
+    if (ATX_FAILED(self->result)) return;
+    self->buffer[self->size++] = c;
+    if (self->size == sizeof(self->buffer)) ATX_JsonWriter_Flush(self);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonWriter_WriteString
++---------------------------------------------------------------------*/
+static void
+ATX_JsonWriter_WriteString(ATX_JsonWriter* self, const char* string)
+{
+    ATX_JsonWriter_Write(self, string, ATX_StringLength(string));
+}
+
+/*----------------------------------------------------------------------
+|    ATX_JsonWriter_WriteIndentation
++---------------------------------------------------------------------*/
+static void
+ATX_JsonWriter_WriteIndentation(ATX_JsonWriter* self)
+{
+    static const char spaces[] = "                                ";
+    ATX_Size size = ATX_JSON_INDENTATION*self->depth;
+    
+    while (size) {
+        ATX_Size chunk = size > sizeof(spaces)-1 ? sizeof(spaces)-1 : size;
+        ATX_JsonWriter_Write(self, spaces, chunk);
+        size -= chunk;
+    }
+}
+
 /*----------------------------------------------------------------------
 |    ATX_Json_EmitString
 +---------------------------------------------------------------------*/
 static void
-ATX_Json_EmitString(ATX_String* string, ATX_String* buffer)
+ATX_Json_EmitString(const ATX_String* string, ATX_JsonWriter* writer)
 {
-    const char* s = ATX_CSTR(*string);
-    char        c;
+    const char* s     = ATX_String_GetChars(string);
+    const char* run   = s;
+    const char* end   = s+ATX_String_GetLength(string);
     
-    ATX_String_AppendChar(buffer, '"');
-    while ((c = *s++)) {
-        char escape = '\0';
+    ATX_JsonWriter_WriteChar(writer, '"');
+    for (; s != end; s++) {
+        unsigned char c = (unsigned char)*s;
+        char          escape;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        /* write the run of plain characters before this one */
+        ATX_JsonWriter_Write(writer, run, (ATX_Size)(s-run));
+        run = s+1;
         switch (c) {
           case '"':  escape = '"';  break;
           case '\\': escape = '\\'; break;
@@ -758,120 +1778,97 @@ ATX_Json_EmitString(ATX_String* string, ATX_String* buffer)
           case '\n': escape = 'n';  break;
           case '\r': escape = 'r';  break;
           case '\t': escape = 't';  break;
+          default:   escape = 'u';  break;
         }
-        if (escape) {
-            ATX_String_AppendChar(buffer, '\\');
-            ATX_String_AppendChar(buffer, escape);
-        } else {
-            ATX_String_AppendChar(buffer, c);
+        ATX_JsonWriter_WriteChar(writer, '\\');
+        ATX_JsonWriter_WriteChar(writer, escape);
+        if (escape == 'u') {
+            char hex[4];
+            hex[0] = '0';
+            hex[1] = '0';
+            hex[2] = ATX_NibbleToHex(c>>4, ATX_FALSE);
+            hex[3] = ATX_NibbleToHex(c&0x0F, ATX_FALSE);
+            ATX_JsonWriter_Write(writer, hex, 4);
         }
     }
-    ATX_String_AppendChar(buffer, '"');
+    ATX_JsonWriter_Write(writer, run, (ATX_Size)(end-run));
+    ATX_JsonWriter_WriteChar(writer, '"');
 }
 
 /*----------------------------------------------------------------------
 |    ATX_Json_Emit
 +---------------------------------------------------------------------*/
-static ATX_Result   
-ATX_Json_Emit(ATX_Json*   self, 
-              ATX_String* prefix, 
-              ATX_String* buffer, 
-              ATX_Boolean in_object,
-              ATX_Boolean pretty)
+static void
+ATX_Json_Emit(ATX_Json*       self, 
+              ATX_JsonWriter* writer, 
+              ATX_Boolean     in_object)
 {
-    char      workspace[256];
-    ATX_Json* child;
+    char        workspace[32];
+    ATX_Ordinal i;
     
-    if (pretty) ATX_String_Append(buffer, ATX_CSTR(*prefix));
+    if (writer->pretty) ATX_JsonWriter_WriteIndentation(writer);
     if (in_object) {
-        ATX_Json_EmitString(&self->name, buffer);
-        ATX_String_Append(buffer, ": ");
+        ATX_Json_EmitString(&self->name, writer);
+        ATX_JsonWriter_Write(writer, ": ", 2);
     }
     switch (self->type) {
       case ATX_JSON_TYPE_NUMBER:
-        if (self->value.number == (ATX_Int32)self->value.number) {
-            ATX_IntegerToString((ATX_Int32)self->value.number, workspace, sizeof(workspace));
-        } else {
-            double abs_val = self->value.number>=0.0?self->value.number:-self->value.number;
-            if (abs_val < 1E-6 || abs_val > 1E9) {
-                ATX_FormatStringN(workspace, sizeof(workspace), "%e", (float)self->value.number); 
-            } else {
-                ATX_FormatStringN(workspace, sizeof(workspace), "%f", (float)self->value.number); 
-            }
+        /* JSON has no representation for infinities and NaNs */
+        if (self->value.number != self->value.number ||
+            self->value.number-self->value.number != 0.0) {
+            ATX_JsonWriter_Write(writer, "null", 4);
+            break;
         }
-        ATX_String_Append(buffer, workspace);
+        ATX_DoubleToStringShortest(self->value.number, workspace, sizeof(workspace));
+        ATX_JsonWriter_WriteString(writer, workspace);
         break;
         
       case ATX_JSON_TYPE_STRING:
-        ATX_Json_EmitString(&self->value.string, buffer);
+        ATX_Json_EmitString(&self->value.string, writer);
         break;
         
       case ATX_JSON_TYPE_BOOLEAN:
-        ATX_String_Append(buffer, self->value.boolean?"true":"false");
+        if (self->value.boolean) {
+            ATX_JsonWriter_Write(writer, "true", 4);
+        } else {
+            ATX_JsonWriter_Write(writer, "false", 5);
+        }
         break;
         
       case ATX_JSON_TYPE_NULL:
-        ATX_String_Append(buffer, "null");
+        ATX_JsonWriter_Write(writer, "null", 4);
         break;
 
       case ATX_JSON_TYPE_ARRAY:
-        if (self->child_count == 0) {
-            ATX_String_Append(buffer, "[]");
-            break;
-        }
-        ATX_String_AppendChar(buffer, '[');
-        if (pretty) {
-            ATX_String_Append(prefix, "    ");
-            ATX_String_Append(buffer, "\n");
-        }
-        child = self->child;
-        while (child && child->next) child = child->next;
-        while (child) {
-            ATX_Json_Emit(child, prefix, buffer, ATX_FALSE, pretty);
-            child = child->prev;
-            if (child) {
-                ATX_String_Append(buffer, pretty?",\n":", ");
-            } else {
-                if (pretty) ATX_String_Append(buffer, "\n");
-            }
-        }
-        if (pretty) {
-            ATX_String_SetLength(prefix, ATX_String_GetLength(prefix)-4);
-            ATX_String_Append(buffer, ATX_CSTR(*prefix));
-        }
-        ATX_String_AppendChar(buffer, ']');
-        break;
-
       case ATX_JSON_TYPE_OBJECT:
         if (self->child_count == 0) {
-            ATX_String_Append(buffer, "{}");
+            ATX_JsonWriter_WriteString(writer, self->type == ATX_JSON_TYPE_ARRAY ? "[]" : "{}");
             break;
         }
-        ATX_String_AppendChar(buffer, '{');
-        if (pretty) {
-            ATX_String_Append(prefix, "    ");
-            ATX_String_Append(buffer, "\n");
+        ATX_JsonWriter_WriteChar(writer, self->type == ATX_JSON_TYPE_ARRAY ? '[' : '{');
+        if (writer->pretty) {
+            ++writer->depth;
+            ATX_JsonWriter_WriteChar(writer, '\n');
         }
-        child = self->child;
-        while (child && child->next) child = child->next;
-        while (child) {
-            ATX_Json_Emit(child, prefix, buffer, ATX_TRUE, pretty);
-            child = child->prev;
-            if (child) {
-                ATX_String_Append(buffer, pretty?",\n":", ");
+        for (i=0; i<self->child_count; i++) {
+            ATX_Json_Emit(self->children[i], writer, self->type == ATX_JSON_TYPE_OBJECT);
+            if (i+1 < self->child_count) {
+                if (writer->pretty) {
+                    ATX_JsonWriter_Write(writer, ",\n", 2);
+                } else {
+                    ATX_JsonWriter_Write(writer, ", ", 2);
+                }
             } else {
-                if (pretty) ATX_String_Append(buffer, "\n");
+                if (writer->pretty) ATX_JsonWriter_WriteChar(writer, '\n');
             }
         }
-        if (pretty) {
-            ATX_String_SetLength(prefix, ATX_String_GetLength(prefix)-4);
-            ATX_String_Append(buffer, ATX_CSTR(*prefix));
+        if (writer->pretty) {
+            --writer->depth;
+            ATX_JsonWriter_WriteIndentation(writer);
         }
-        ATX_String_AppendChar(buffer, '}');
+        ATX_JsonWriter_WriteChar(writer, self->type == ATX_JSON_TYPE_ARRAY ? ']' : '}');
         break;
     }
-
-    return ATX_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
@@ -880,13 +1877,40 @@ ATX_Json_Emit(ATX_Json*   self,
 ATX_Result   
 ATX_Json_Serialize(ATX_Json* self, ATX_String* buffer, ATX_Boolean pretty)
 {
-    ATX_String prefix = ATX_EMPTY_STRING;
-    ATX_Result result;
-    
+    ATX_JsonWriter writer;
+
     ATX_String_SetLength(buffer, 0);
 
-    result = ATX_Json_Emit(self, &prefix, buffer, ATX_FALSE, pretty);
-    ATX_String_Destruct(&prefix);
+    writer.size   = 0;
+    writer.stream = NULL;
+    writer.string = buffer;
+    writer.result = ATX_SUCCESS;
+    writer.depth  = 0;
+    writer.pretty = pretty;
+    ATX_Json_Emit(self, &writer, ATX_FALSE);
+    ATX_JsonWriter_Flush(&writer);
     
-    return result;
+    return writer.result;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Json_SerializeToStream
++---------------------------------------------------------------------*/
+ATX_Result   
+ATX_Json_SerializeToStream(ATX_Json*         self, 
+                           ATX_OutputStream* stream, 
+                           ATX_Boolean       pretty)
+{
+    ATX_JsonWriter writer;
+
+    writer.size   = 0;
+    writer.stream = stream;
+    writer.string = NULL;
+    writer.result = ATX_SUCCESS;
+    writer.depth  = 0;
+    writer.pretty = pretty;
+    ATX_Json_Emit(self, &writer, ATX_FALSE);
+    ATX_JsonWriter_Flush(&writer);
+    
+    return writer.result;
 }
@@ -39,13 +39,29 @@
 #include "AtxDefs.h"
 #include "AtxResults.h"
 #include "AtxUtils.h"
+#include "AtxAllocator.h"
 #include "AtxInterfaces.h"
+#include "AtxStreams.h"
 
 /*----------------------------------------------------------------------
 |   types
 +---------------------------------------------------------------------*/
 typedef struct ATX_Json ATX_Json;
 
+/**
+ * Arena from which a parsed tree can be allocated. This is an 
+ * ATX_MemoryArena: nodes and strings are carved out of large blocks, 
+ * and released all at once when the arena is reset or destroyed. 
+ * ATX_Json_Destroy is a no-op on nodes that belong to an arena.
+ */
+typedef ATX_MemoryArena ATX_JsonArena;
+
+/**
+ * Incremental parser. Data can be fed in chunks of any size, and the
+ * parser either builds a tree or reports events to a listener.
+ */
+typedef struct ATX_JsonParser ATX_JsonParser;
+
 /*----------------------------------------------------------------------
 |   constants
 +---------------------------------------------------------------------*/
@@ -58,6 +74,76 @@ typedef enum {
     ATX_JSON_TYPE_NULL
 } ATX_JsonType;
 
+/**
+ * Implementations of the character scanning used by the parser. The
+ * default is AVX2 when the CPU supports it, and the scalar scanner
+ * otherwise: SSE2 scans long runs faster, but parses typical documents
+ * no faster than the scalar scanner, so it must be selected explicitly.
+ */
+typedef enum {
+    ATX_JSON_SCANNER_AUTO = 0,
+    ATX_JSON_SCANNER_SCALAR,
+    ATX_JSON_SCANNER_SSE2,
+    ATX_JSON_SCANNER_AVX2
+} ATX_JsonScannerType;
+
+#define ATX_JSON_ARENA_DEFAULT_BLOCK_SIZE 65536
+#define ATX_JSON_PARSER_STREAM_BUFFER_SIZE 16384
+#define ATX_JSON_SERIALIZER_BUFFER_SIZE    4096
+
+/*----------------------------------------------------------------------
+|   ATX_JsonValue
++---------------------------------------------------------------------*/
+/**
+ * Scalar value reported to an ATX_JsonListener. String characters
+ * are only valid for the duration of the callback.
+ */
+typedef struct {
+    ATX_JsonType type;
+    union {
+        double      number;
+        ATX_Boolean boolean;
+        struct {
+            const char* chars;
+            ATX_Size    length;
+        } string;
+    } value;
+} ATX_JsonValue;
+
+/*----------------------------------------------------------------------
+|   ATX_JsonListener interface
++---------------------------------------------------------------------*/
+ATX_DECLARE_INTERFACE(ATX_JsonListener)
+/**
+ * Interface implemented by objects that want to receive parsing events
+ * instead of a tree. In each method, name is the member name when the
+ * value is inside an object, or NULL when it is inside an array or at
+ * the top level. Returning a failure code aborts the parse, and that
+ * code is returned to the caller feeding the parser.
+ */
+ATX_BEGIN_INTERFACE_DEFINITION(ATX_JsonListener)
+    ATX_Result (*OnStartContainer)(ATX_JsonListener* self, 
+                                   const char*       name,
+                                   ATX_JsonType      type);
+    ATX_Result (*OnEndContainer)(ATX_JsonListener* self, 
+                                 ATX_JsonType      type);
+    ATX_Result (*OnValue)(ATX_JsonListener*    self, 
+                          const char*          name, 
+                          const ATX_JsonValue* value);
+ATX_END_INTERFACE_DEFINITION
+
+/*----------------------------------------------------------------------
+|   convenience macros
++---------------------------------------------------------------------*/
+#define ATX_JsonListener_OnStartContainer(object, name, type) \
+ATX_INTERFACE(object)->OnStartContainer(object, name, type)
+
+#define ATX_JsonListener_OnEndContainer(object, type) \
+ATX_INTERFACE(object)->OnEndContainer(object, type)
+
+#define ATX_JsonListener_OnValue(object, name, value) \
+ATX_INTERFACE(object)->OnValue(object, name, value)
+
 /*----------------------------------------------------------------------
 |    prototypes
 +---------------------------------------------------------------------*/
@@ -72,6 +158,11 @@ ATX_Json*         ATX_Json_CreateNumber(double number);
 ATX_Json*         ATX_Json_CreateBoolean(ATX_Boolean value);
 ATX_Json*         ATX_Json_CreateNull(void);
 void              ATX_Json_Destroy(ATX_Json* self);
+
+/**
+ * Lookups don't modify the tree, so a tree that is no longer being
+ * built can be read from several threads at once.
+ */
 ATX_Json*         ATX_Json_GetChild(ATX_Json* self, const char* name);
 ATX_Json*         ATX_Json_GetChildAt(ATX_Json* self, ATX_Ordinal indx, const char** name);
 ATX_Cardinal      ATX_Json_GetChildCount(ATX_Json* self);
@@ -85,7 +176,35 @@ const ATX_String* ATX_Json_AsString(ATX_Json* self);
 
 ATX_Result        ATX_Json_Parse(const char* serialized, ATX_Json** json);
 ATX_Result        ATX_Json_ParseBuffer(const char* serialized, ATX_Size size, ATX_Json** json);
+ATX_Result        ATX_Json_ParseBufferEx(const char*    serialized, 
+                                         ATX_Size       size, 
+                                         ATX_JsonArena* arena,
+                                         ATX_Json**     json);
+ATX_Result        ATX_Json_ParseStream(ATX_InputStream* stream,
+                                       ATX_JsonArena*   arena,
+                                       ATX_Json**       json);
 ATX_Result        ATX_Json_Serialize(ATX_Json* self, ATX_String* buffer, ATX_Boolean pretty);
+ATX_Result        ATX_Json_SerializeToStream(ATX_Json*         self, 
+                                             ATX_OutputStream* stream, 
+                                             ATX_Boolean       pretty);
+
+ATX_Result          ATX_Json_SetScanner(ATX_JsonScannerType type);
+ATX_JsonScannerType ATX_Json_GetScanner(void);
+
+ATX_Result        ATX_JsonArena_Create(ATX_Size block_size, ATX_JsonArena** arena);
+ATX_Result        ATX_JsonArena_CreateWithAllocator(ATX_Size             block_size, 
+                                                    const ATX_Allocator* allocator,
+                                                    ATX_JsonArena**      arena);
+ATX_Result        ATX_JsonArena_Destroy(ATX_JsonArena* self);
+void              ATX_JsonArena_Reset(ATX_JsonArena* self);
+
+ATX_Result        ATX_JsonParser_Create(ATX_JsonArena* arena, ATX_JsonParser** parser);
+ATX_Result        ATX_JsonParser_CreateWithListener(ATX_JsonListener* listener, 
+                                                    ATX_JsonParser**  parser);
+ATX_Result        ATX_JsonParser_Destroy(ATX_JsonParser* self);
+ATX_Result        ATX_JsonParser_Feed(ATX_JsonParser* self, const void* data, ATX_Size size);
+ATX_Result        ATX_JsonParser_FeedStream(ATX_JsonParser* self, ATX_InputStream* stream);
+ATX_Result        ATX_JsonParser_Finish(ATX_JsonParser* self, ATX_Json** json);
 
 #ifdef __cplusplus
 }
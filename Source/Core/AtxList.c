@@ -34,11 +34,13 @@
 |    includes
 +---------------------------------------------------------------------*/
 #include "AtxConfig.h"
+#include "AtxDebug.h"
 #include "AtxTypes.h"
 #include "AtxDefs.h"
 #include "AtxResults.h"
 #include "AtxUtils.h"
 #include "AtxList.h"
+#include "AtxAllocator.h"
 #include "AtxReferenceable.h"
 
 /*----------------------------------------------------------------------
@@ -51,6 +53,7 @@ struct ATX_ListItem {
     ATX_UInt32    type;
     ATX_ListItem* next;
     ATX_ListItem* prev;
+    ATX_List*     owner; /* the list whose pool the item comes from */
 };
 
 
@@ -59,8 +62,79 @@ struct ATX_List {
     ATX_ListItem*          head;
     ATX_ListItem*          tail;
     ATX_ListDataDestructor destructor;
+    ATX_Size               item_size; /* 0 means sizeof(ATX_ListItem) */
+    ATX_MemoryPool*        item_pool; /* created with the first item  */
+    ATX_Cardinal           item_alive; /* items of the pool not freed */
 };
 
+/*----------------------------------------------------------------------
+|    constants
++---------------------------------------------------------------------*/
+#define ATX_LIST_MIN_ITEMS_PER_SLAB 8
+#define ATX_LIST_MAX_ITEMS_PER_SLAB 256
+
+/*----------------------------------------------------------------------
+|    ATX_List_AllocateItem
+|
+|    Items are carved out of slabs owned by the list and recycled
+|    through a free list, so that items stay close to each other in 
+|    memory and add/remove churn doesn't go back to the allocator.
+|    Slabs grow with the list.
++---------------------------------------------------------------------*/
+static ATX_ListItem*
+ATX_List_AllocateItem(ATX_List* list)
+{
+    ATX_ListItem* item;
+
+    if (list->item_pool == NULL) {
+        ATX_Size item_size = list->item_size ? list->item_size : sizeof(ATX_ListItem);
+        if (ATX_FAILED(ATX_MemoryPool_Create(item_size, 
+                                             ATX_LIST_MIN_ITEMS_PER_SLAB, 
+                                             NULL, 
+                                             &list->item_pool))) {
+            return NULL;
+        }
+    }
+    if (ATX_MemoryPool_GetFreeCount(list->item_pool) == 0) {
+        ATX_Cardinal slab_size = list->item_count;
+        if (slab_size < ATX_LIST_MIN_ITEMS_PER_SLAB) slab_size = ATX_LIST_MIN_ITEMS_PER_SLAB;
+        if (slab_size > ATX_LIST_MAX_ITEMS_PER_SLAB) slab_size = ATX_LIST_MAX_ITEMS_PER_SLAB;
+        if (ATX_FAILED(ATX_MemoryPool_Reserve(list->item_pool, slab_size))) return NULL;
+    }
+
+    item = (ATX_ListItem*)ATX_MemoryPool_Allocate(list->item_pool);
+    if (item == NULL) return NULL;
+    item->owner = list;
+    ++list->item_alive;
+
+    return item;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_List_FreeItem
++---------------------------------------------------------------------*/
+static void
+ATX_List_FreeItem(ATX_List* list, ATX_ListItem* item)
+{
+    ATX_ASSERT(item->owner == list);
+    ATX_MemoryPool_Free(list->item_pool, item);
+    --list->item_alive;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_List_DestroyItemPool
++---------------------------------------------------------------------*/
+static void
+ATX_List_DestroyItemPool(ATX_List* list)
+{
+    if (list->item_pool) {
+        /* a detached item must not outlive the list */
+        ATX_ASSERT(list->item_alive == 0);
+        ATX_MemoryPool_Destroy(list->item_pool);
+        list->item_pool = NULL;
+    }
+}
+
 #if !defined(_ATX_LIST_FRIEND_INCLUDE_)
 
 /*----------------------------------------------------------------------
@@ -104,6 +178,7 @@ ATX_List_Destroy(ATX_List* list)
 
     /* destroy all items */
     ATX_List_Clear(list);
+    ATX_List_DestroyItemPool(list);
 
     /* destroy the list object */
     ATX_FreeMemory((void*)list);
@@ -130,8 +205,8 @@ ATX_List_Clear(ATX_List* list)
                                          item->type);
         }
 
-        /* free the item memory */
-        ATX_FreeMemory(item);
+        /* recycle the item */
+        ATX_List_FreeItem(list, item);
 
         item = next;
     }
@@ -141,15 +216,38 @@ ATX_List_Clear(ATX_List* list)
     list->head = NULL;
     list->tail = NULL;
 
+    /* give the slabs back, unless detached items still live in them */
+    if (list->item_alive == 0) ATX_List_DestroyItemPool(list);
+
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|    ATX_List_Reserve
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_List_Reserve(ATX_List* list, ATX_Cardinal item_count)
+{
+    if (item_count <= list->item_count) return ATX_SUCCESS;
+
+    /* make sure the pool exists, then grow it in one slab */
+    if (list->item_pool == NULL) {
+        ATX_ListItem* item = ATX_List_AllocateItem(list);
+        if (item == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        ATX_List_FreeItem(list, item);
+    }
+    return ATX_MemoryPool_Reserve(list->item_pool, item_count-list->item_count);
+}
+
 /*----------------------------------------------------------------------
 |    ATX_List_AddItem
 +---------------------------------------------------------------------*/
 ATX_Result 
 ATX_List_AddItem(ATX_List* list, ATX_ListItem* item)
 {
+    /* items can't move to another list */
+    ATX_ASSERT(item->owner == list);
+
     /* add the item */
     if (list->tail) {
         item->prev = list->tail;
@@ -177,11 +275,8 @@ ATX_List_CreateItem(ATX_List* list)
 {
     ATX_ListItem* item;
 
-    /* avoid compiler warning about the unused parameter */
-    ATX_COMPILER_UNUSED(list);
-
     /* allocate a new item */
-    item = (ATX_ListItem*)ATX_AllocateMemory(sizeof(ATX_ListItem));
+    item = ATX_List_AllocateItem(list);
     if (item == NULL) {
         return NULL;
     }
@@ -279,8 +374,8 @@ ATX_List_DestroyItem(ATX_List* list, ATX_ListItem* item)
                                      item->type);
     }
     
-    /* free the item memory */
-    ATX_FreeMemory(item);    
+    /* recycle the item */
+    ATX_List_FreeItem(list, item);    
     
     return ATX_SUCCESS;
 }
@@ -293,6 +388,7 @@ ATX_List_InsertItem(ATX_List* list, ATX_ListItem* where, ATX_ListItem* item)
 {
     /* insert the item in the list */
     ATX_ListItem* position = where;
+    ATX_ASSERT(item->owner == list);
     if (position) {
         /* insert at position */
         item->next = position;
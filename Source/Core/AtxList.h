@@ -76,7 +76,24 @@ extern "C" {
 ATX_Result    ATX_List_Create(ATX_List** list);
 ATX_Result    ATX_List_CreateEx(const ATX_ListDataDestructor* destructor, ATX_List** list);
 ATX_Result    ATX_List_Destroy(ATX_List* list);
+
+/**
+ * Release all the items. The storage of the items goes back to the
+ * allocator, unless some detached items haven't been destroyed yet.
+ */
 ATX_Result    ATX_List_Clear(ATX_List* list);
+
+/**
+ * Preallocate storage so that the list can hold item_count items
+ * without allocating memory.
+ *
+ * Items are carved out of storage owned by the list that created them,
+ * so they can be moved within that list, but not added to another
+ * one. A detached item must be destroyed with ATX_List_DestroyItem on
+ * the same list, never freed directly, and before the list itself is
+ * destroyed. Debug builds assert on these rules.
+ */
+ATX_Result    ATX_List_Reserve(ATX_List* list, ATX_Cardinal item_count);
 ATX_ListItem* ATX_List_CreateItem(ATX_List* list);
 ATX_Result    ATX_List_AddData(ATX_List* list, ATX_Any data);
 ATX_Result    ATX_List_AddTypedData(ATX_List* list, ATX_Any data, ATX_UInt32 type);
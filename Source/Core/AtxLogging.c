@@ -36,6 +36,7 @@
 |   includes
 +---------------------------------------------------------------------*/
 #include <stdarg.h>
+#include <stddef.h>
 #include "AtxConfig.h"
 #include "AtxConsole.h"
 #include "AtxTypes.h"
@@ -44,7 +45,9 @@
 #include "AtxLogging.h"
 #include "AtxSystem.h"
 #include "AtxString.h"
+#include "AtxAtom.h"
 #include "AtxList.h"
+#include "AtxMap.h"
 #include "AtxDataBuffer.h"
 #include "AtxFile.h"
 #include "AtxStreams.h"
@@ -54,23 +57,39 @@
 #include "AtxThreads.h"
 #include "AtxDebug.h"
 
+/*----------------------------------------------------------------------
+|   logging
++---------------------------------------------------------------------*/
+ATX_SET_LOCAL_LOGGER("atomix.logging")
+
 /*----------------------------------------------------------------------
 |   types
 +---------------------------------------------------------------------*/
-typedef struct {
-    ATX_String key;
-    ATX_String value;
-} ATX_LogConfigEntry;
+/* immutable snapshot of a logger's handlers, replaced as a whole when */
+/* the logger is reconfigured                                          */
+typedef struct ATX_LogHandlerChain ATX_LogHandlerChain;
+struct ATX_LogHandlerChain {
+    ATX_AtomicInt         reference_count;
+    ATX_LogHandlerChain*  next_retired;
+    ATX_Cardinal          handler_count;
+    ATX_Cardinal          binary_count; /* handlers that take binary records */
+    ATX_LogHandlerEntry*  handlers[1];  /* handler_count entries */
+};
 
 typedef struct {
-    ATX_List*    config;
-    ATX_List*    loggers;
-    ATX_Logger*  root;
-    ATX_Mutex*   lock;
-    ATX_ThreadId lock_owner;
-    ATX_UInt32   lock_recursion;
-    ATX_Boolean  disabled;
-    ATX_Boolean  initialized;
+    ATX_Map*             config;  /* config values (ATX_String*) by key   */
+    ATX_Map*             loggers; /* loggers other than the root, by name */
+    ATX_Logger*          root;
+    ATX_Mutex*           lock;
+    ATX_ThreadId         lock_owner;
+    ATX_UInt32           lock_recursion;
+    ATX_ThreadLocal*     dispatching; /* set while a thread runs handlers */
+    ATX_AtomicInt        acquiring;   /* threads taking a chain reference */
+    ATX_LogHandlerChain* retired;     /* replaced chains not yet freed    */
+    ATX_ThreadId         initializer;
+    ATX_Boolean          initializing;
+    ATX_Boolean          initialized;
+    ATX_UInt32           skipped_config_lines; /* too long to be parsed */
 } ATX_LogManager;
 
 typedef struct {
@@ -79,29 +98,191 @@ typedef struct {
     ATX_Flags   format_filter;
 } ATX_LogConsoleHandler;
 
+/* what a binary handler remembers about a string it has defined */
+typedef struct {
+    const char* pointer;
+    char*       copy; /* message formats are also compared by value */
+} ATX_LogBinaryString;
+
+typedef struct {
+    ATX_LogBinaryString strings[ATX_LOG_BINARY_STRING_KINDS][ATX_LOG_BINARY_STRING_SLOTS];
+    ATX_Boolean         started; /* the stream header has been written */
+} ATX_LogBinaryEncoder;
+
+struct ATX_LogBinaryDecoder {
+    ATX_InputStream*  stream;
+    ATX_String        strings[ATX_LOG_BINARY_STRING_KINDS][ATX_LOG_BINARY_STRING_SLOTS];
+    ATX_Byte*         data;
+    ATX_Size          data_size;
+    ATX_StringBuilder message;
+    ATX_String        argument;
+};
+
+typedef enum {
+    ATX_LOG_ARGUMENT_NONE,
+    ATX_LOG_ARGUMENT_INT,
+    ATX_LOG_ARGUMENT_LONG,
+    ATX_LOG_ARGUMENT_LONG_LONG,
+    ATX_LOG_ARGUMENT_SIZE,
+    ATX_LOG_ARGUMENT_PTRDIFF,
+    ATX_LOG_ARGUMENT_DOUBLE,
+    ATX_LOG_ARGUMENT_LONG_DOUBLE,
+    ATX_LOG_ARGUMENT_STRING,
+    ATX_LOG_ARGUMENT_POINTER
+} ATX_LogArgumentType;
+
+/* a conversion in a printf-style format */
+typedef struct {
+    const char*         start;         /* the '%' */
+    const char*         modifiers_end; /* start of the length modifier */
+    const char*         end;           /* past the conversion character */
+    unsigned int        star_count;    /* '*' width and precision */
+    int                 precision;
+    char                length;        /* 'H' for hh, 'q' for ll */
+    char                conversion;
+    ATX_LogArgumentType type;
+} ATX_LogConversion;
+
 typedef struct {
-    ATX_OutputStream* stream;
+    ATX_OutputStream*     stream;
+    ATX_LogBinaryEncoder* binary;          /* NULL for text files */
+    ATX_StringBuilder     buffer;          /* records not written yet */
+    ATX_String            filename;
+    ATX_Flags             open_mode;
+    ATX_Size              buffer_size;     /* 0 to write each record */
+    ATX_UInt32            flush_interval;  /* in milliseconds */
+    ATX_TimeStamp         flush_time;      /* when buffered records are due */
+    ATX_LargeSize         file_size;       /* bytes written to the file */
+    ATX_LargeSize         max_size;        /* 0 for no size-based rotation */
+    ATX_UInt32            rotate_interval; /* in seconds, 0 for none */
+    ATX_TimeStamp         rotate_time;     /* when the file is due for rotation */
+    ATX_UInt32            backups;         /* number of rotated files kept */
+    ATX_Mutex*            lock;            /* NULL without a flusher thread */
+    ATX_Condition*        wakeup;
+    ATX_Thread*           flusher;         /* writes the records that are due */
+    ATX_Boolean           terminating;
 } ATX_LogFileHandler;
 
+/* how text records are framed on the network */
+typedef enum {
+    ATX_LOG_FRAMING_HEADERS, /* "Name: value" headers, then the message */
+    ATX_LOG_FRAMING_COMPACT  /* 4-byte length, then a formatted log line */
+} ATX_LogFraming;
+
+/* transport of an ATX_LogSender, see ATX_LogSender_SendPending */
+typedef struct {
+    ATX_Result (*Frame)(void*                instance,
+                        const ATX_LogRecord* record,
+                        ATX_StringBuilder*   output);
+    ATX_Result (*Connect)(void* instance);
+    ATX_Result (*Send)(void* instance, const char* frames, ATX_Size size);
+    void       (*Disconnect)(void* instance);
+    void       (*Restart)(void* instance); /* stateful senders: start a new stream */
+} ATX_LogSenderInterface;
+
+typedef struct {
+    void*                         instance;
+    const ATX_LogSenderInterface* iface;
+    ATX_Mutex*                    lock;
+    ATX_Condition*                wakeup;
+    ATX_Thread*                   thread;        /* NULL when sending inline */
+    ATX_StringBuilder             pending;       /* frames not taken yet */
+    ATX_StringBuilder             sending;       /* frames being sent */
+    ATX_UInt32                    pending_count;
+    ATX_Size                      queue_size;    /* max size of the pending frames */
+    ATX_UInt32                    dropped;
+    ATX_Boolean                   stateful;      /* frames only make sense on one connection */
+    ATX_Boolean                   connected;
+    ATX_Boolean                   busy;          /* frames are being sent */
+    ATX_Boolean                   terminating;
+    ATX_Timeout                   retry_delay;
+    ATX_TimeStamp                 retry_time;    /* when to try to connect again */
+} ATX_LogSender;
+
 typedef struct {
-    ATX_String        host;
-    ATX_UInt16        port;
-    ATX_OutputStream* stream;
-    ATX_UInt32        sequence_number;
+    ATX_String            host;
+    ATX_UInt16            port;
+    ATX_Timeout           connect_timeout;
+    ATX_OutputStream*     stream;
+    ATX_UInt32            sequence_number;
+    ATX_LogFraming        framing;
+    ATX_LogBinaryEncoder* binary; /* NULL for text records */
+    ATX_LogSender         sender;
 } ATX_LogTcpHandler;
 
 typedef struct {
+    ATX_String          host;
+    ATX_UInt16          port;
     ATX_DatagramSocket* socket;
-    ATX_SocketAddress   address;
     ATX_UInt32          sequence_number;
+    ATX_LogFraming      framing;
+    ATX_Size            datagram_size;
+    ATX_DataBuffer*     datagrams[16]; /* sent with one SendMany() call */
+    ATX_SocketAddress   addresses[16];
+    ATX_LogSender       sender;
 } ATX_LogUdpHandler;
 
+typedef enum {
+    ATX_LOG_ASYNC_OVERFLOW_DROP,
+    ATX_LOG_ASYNC_OVERFLOW_BLOCK,
+    ATX_LOG_ASYNC_OVERFLOW_COUNT_DROPPED
+} ATX_LogAsyncOverflowPolicy;
+
+typedef struct {
+    ATX_AtomicInt sequence; /* slot state, see ATX_LogAsyncHandler_Log */
+    int           level;
+    ATX_TimeStamp timestamp;
+    const char*   source_file;
+    unsigned int  source_line;
+    const char*   source_function;
+    const char*   format;   /* NULL for text records */
+    ATX_Size      arguments_size;
+    char*         message;  /* points into the handler's text storage: */
+                            /* the message, or a copy of the format    */
+                            /* followed by the encoded arguments        */
+} ATX_LogAsyncRecord;
+
+typedef struct {
+    ATX_String                 logger_name;
+    ATX_LogHandlerEntry*       handlers; /* handlers called by the writer */
+    ATX_Boolean                binary;   /* they all take binary records  */
+    ATX_LogBinaryString        formats[ATX_LOG_BINARY_STRING_SLOTS]; /* writer's copies */
+    ATX_LogAsyncRecord*        records;
+    char*                      text;
+    ATX_Size                   message_size;
+    ATX_UInt32                 capacity; /* power of 2 */
+    ATX_AtomicInt              tail;     /* next record claimed by a caller */
+    ATX_UInt32                 head;     /* next record read by the writer */
+    ATX_LogAsyncOverflowPolicy overflow;
+    ATX_AtomicInt              dropped;
+    ATX_AtomicInt              writer_waiting;
+    ATX_AtomicInt              callers_waiting;
+    ATX_AtomicInt              terminating;
+    ATX_Mutex*                 lock;
+    ATX_Condition*             not_empty;
+    ATX_Condition*             not_full;
+    ATX_Thread*                writer;
+    ATX_ThreadId               writer_id;
+} ATX_LogAsyncHandler;
+
 /*----------------------------------------------------------------------
 |   constants
 +---------------------------------------------------------------------*/
-#define ATX_LOG_HEAP_BUFFER_INCREMENT 4096
-#define ATX_LOG_STACK_BUFFER_MAX_SIZE 512
-#define ATX_LOG_HEAP_BUFFER_MAX_SIZE  65536
+#define ATX_LOG_HEAP_BUFFER_INCREMENT  4096
+#define ATX_LOG_STACK_BUFFER_MAX_SIZE  512
+#define ATX_LOG_HEAP_BUFFER_MAX_SIZE   65536
+#define ATX_LOG_CONFIG_MAX_LINE_LENGTH 4096
+#define ATX_LOG_CONFIG_STACK_KEY_SIZE  256
+#define ATX_LOG_BINARY_MAX_SPEC_SIZE   32
+#define ATX_LOG_BINARY_MAX_ENTRY_SIZE  0x1000000 /* 16 MB */
+#define ATX_LOG_PRECISION_NONE         -1
+#define ATX_LOG_PRECISION_STAR         -2
+
+/* formats a decoded argument, with the '*' width and precision values */
+#define ATX_LOG_APPEND_ARGUMENT(_builder, _spec, _stars, _star_count, _value)          \
+    ((_star_count) == 0 ? ATX_StringBuilder_AppendFormat((_builder), (_spec), (_value)) : \
+     (_star_count) == 1 ? ATX_StringBuilder_AppendFormat((_builder), (_spec), (_stars)[0], (_value)) : \
+     ATX_StringBuilder_AppendFormat((_builder), (_spec), (_stars)[0], (_stars)[1], (_value)))
 
 #if !defined(ATX_CONFIG_LOG_CONFIG_ENV)
 #define ATX_CONFIG_LOG_CONFIG_ENV "ATOMIX_LOG_CONFIG"
@@ -122,8 +303,27 @@ typedef struct {
 #define ATX_LOG_TCP_HANDLER_DEFAULT_PORT            7723
 #define ATX_LOG_TCP_HANDLER_DEFAULT_CONNECT_TIMEOUT 5000 /* 5 seconds */
 
+#define ATX_LOG_SENDER_DEFAULT_QUEUE_SIZE 262144 /* 256 KB     */
+#define ATX_LOG_SENDER_MIN_RETRY_DELAY    100    /* 100 ms     */
+#define ATX_LOG_SENDER_MAX_RETRY_DELAY    30000  /* 30 seconds */
+
+#define ATX_LOG_FILE_HANDLER_DEFAULT_FLUSH_INTERVAL 1000 /* 1 second */
+#define ATX_LOG_FILE_HANDLER_DEFAULT_BACKUPS        1
+#define ATX_LOG_FILE_HANDLER_MAX_BACKUPS            1000
+
 #define ATX_LOG_UDP_HANDLER_DEFAULT_PORT             7724
 #define ATX_LOG_UDP_HANDLER_DEFAULT_RESOLVER_TIMEOUT 10000 /* 10 seconds */
+#define ATX_LOG_UDP_HANDLER_DEFAULT_DATAGRAM_SIZE    1400  /* fits in an ethernet frame */
+#define ATX_LOG_UDP_HANDLER_MAX_DATAGRAM_SIZE        65507
+
+#define ATX_LOG_ASYNC_HANDLER_DEFAULT_CAPACITY     1024
+#define ATX_LOG_ASYNC_HANDLER_DEFAULT_MESSAGE_SIZE 1024
+#define ATX_LOG_ASYNC_HANDLER_MAX_CAPACITY         65536
+#define ATX_LOG_ASYNC_HANDLER_MAX_BLOCK_TIME       1000 /* 1 second */
+#define ATX_LOG_ASYNC_HANDLER_BLOCK_WAIT           10   /* 10 ms     */
+#define ATX_LOG_ASYNC_HANDLER_IDLE_WAIT            100  /* 100 ms    */
+#define ATX_LOG_ASYNC_HANDLER_POLL_WAIT            1    /* 1 ms      */
+#define ATX_LOG_ASYNC_HANDLER_POLL_COUNT           10   /* polls before waiting */
 
 #if defined(_WIN32) || defined(_WIN32_WCE)
 #define ATX_LOG_CONSOLE_HANDLER_DEFAULT_COLOR_MODE ATX_FALSE
@@ -170,6 +370,13 @@ static ATX_Result ATX_LogUdpHandler_Create(const char*     logger_name,
                                            ATX_LogHandler* handler);
 static ATX_Result ATX_LogNullHandler_Create(const char*     logger_name, 
                                             ATX_LogHandler* handler);
+static ATX_Result ATX_LogAsyncHandler_Create(const char*     logger_name, 
+                                             ATX_LogHandler* handler);
+static ATX_Result ATX_Log_EncodeArguments(const char* format, 
+                                          va_list     args,
+                                          ATX_Byte*   buffer,
+                                          ATX_Size    buffer_size,
+                                          ATX_Size*   encoded_size);
 
 /*----------------------------------------------------------------------
 |   ATX_LogHandler_Create
@@ -189,11 +396,98 @@ ATX_LogHandler_Create(const char*     logger_name,
         return ATX_LogTcpHandler_Create(logger_name, handler);
     } else if (ATX_StringsEqual(handler_name, "UdpHandler")) {
         return ATX_LogUdpHandler_Create(logger_name, handler);
+    } else if (ATX_StringsEqual(handler_name, "AsyncHandler")) {
+        return ATX_LogAsyncHandler_Create(logger_name, handler);
     }
 
     return ATX_ERROR_NO_SUCH_CLASS;
 }
 
+/*----------------------------------------------------------------------
+|   ATX_LogHandlerEntry_Add
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogHandlerEntry_Add(ATX_LogHandlerEntry** list, ATX_LogHandler* handler)
+{
+    ATX_LogHandlerEntry* entry;
+
+    /* allocate a new entry */
+    entry = (ATX_LogHandlerEntry*)ATX_AllocateMemory(sizeof(ATX_LogHandlerEntry));
+    if (entry == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* setup the entry */
+    entry->handler = *handler;
+    entry->lock    = NULL;
+    if (handler->iface->flags & ATX_LOG_HANDLER_FLAG_SERIALIZED) {
+        ATX_Result result = ATX_Mutex_Create(&entry->lock);
+        if (ATX_FAILED(result)) {
+            ATX_FreeMemory((void*)entry);
+            return result;
+        }
+    }
+    
+    /* attach the new entry at the beginning of the list */
+    entry->next = *list;
+    *list = entry;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogHandlerEntry_DestroyAll
++---------------------------------------------------------------------*/
+static void
+ATX_LogHandlerEntry_DestroyAll(ATX_LogHandlerEntry* list)
+{
+    while (list) {
+        ATX_LogHandlerEntry* next = list->next;
+        list->handler.iface->Destroy(&list->handler);
+        if (list->lock) ATX_Mutex_Destroy(list->lock);
+        ATX_FreeMemory((void*)list);
+        list = next;
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogHandlerEntry_CreateAll
+|
+|   Creates the handlers named in a comma-separated list, like the 
+|   value of a logger's .handlers property.
++---------------------------------------------------------------------*/
+static void
+ATX_LogHandlerEntry_CreateAll(ATX_LogHandlerEntry** list,
+                              const char*           logger_name,
+                              const char*           handlers_list,
+                              ATX_Boolean           allow_async)
+{
+    const char*    cursor = handlers_list;
+    const char*    name_start = handlers_list;
+    ATX_String     handler_name = ATX_EMPTY_STRING;
+    ATX_LogHandler handler = {NULL, NULL};
+    for (;;) {
+        if (*cursor == '\0' || *cursor == ',') {
+            if (cursor != name_start) {
+                ATX_String_AssignN(&handler_name, name_start, (ATX_Size)(cursor-name_start));
+                ATX_String_TrimWhitespace(&handler_name);
+                
+                /* create a handler */
+                if ((allow_async || !ATX_String_Equals(&handler_name, "AsyncHandler", ATX_FALSE)) &&
+                    ATX_SUCCEEDED(
+                    ATX_LogHandler_Create(logger_name,
+                                          ATX_CSTR(handler_name),
+                                          &handler))) {
+                    ATX_LogHandlerEntry_Add(list, &handler);
+                }
+
+            }
+            if (*cursor == '\0') break;
+            name_start = cursor+1;
+        }
+        ++cursor;
+    }
+    ATX_String_Destruct(&handler_name);
+}
+
 /*----------------------------------------------------------------------
 |   ATX_Log_GetLogLevel
 +---------------------------------------------------------------------*/
@@ -290,6 +584,158 @@ ATX_LogManager_Unlock(void)
     }
 }
 
+/*----------------------------------------------------------------------
+|   ATX_LogManager_EnterDispatch
+|
+|   Marks the calling thread as running handlers. Returns ATX_FALSE if
+|   it already is, so that records logged by handlers are dropped 
+|   instead of recursing.
++---------------------------------------------------------------------*/
+static ATX_Boolean
+ATX_LogManager_EnterDispatch(void)
+{
+    if (LogManager.dispatching == NULL) return ATX_FALSE;
+    if (ATX_ThreadLocal_Get(LogManager.dispatching)) return ATX_FALSE;
+    return ATX_SUCCEEDED(ATX_ThreadLocal_Set(LogManager.dispatching, 
+                                             (void*)&LogManager));
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogManager_LeaveDispatch
++---------------------------------------------------------------------*/
+static void
+ATX_LogManager_LeaveDispatch(void)
+{
+    ATX_ThreadLocal_Set(LogManager.dispatching, NULL);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogHandlerChain_Create
+|
+|   Resolves the handlers a logger's records go to: its own, followed by
+|   those of each ancestor until a logger that does not forward.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogHandlerChain_Create(ATX_Logger* logger, ATX_LogHandlerChain** chain)
+{
+    ATX_Logger*          ancestor;
+    ATX_LogHandlerEntry* entry;
+    ATX_Cardinal         count = 0;
+
+    for (ancestor = logger; ancestor; ancestor = ancestor->forward_to_parent ? ancestor->parent : NULL) {
+        for (entry = ancestor->handlers; entry; entry = entry->next) ++count;
+    }
+    if (count == 0) {
+        *chain = NULL;
+        return ATX_SUCCESS;
+    }
+    *chain = (ATX_LogHandlerChain*)ATX_AllocateMemory(
+        sizeof(ATX_LogHandlerChain)+(count-1)*sizeof(ATX_LogHandlerEntry*));
+    if (*chain == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* the logger that publishes the chain holds the first reference */
+    ATX_AtomicInt_Set(&(*chain)->reference_count, 1);
+    (*chain)->next_retired  = NULL;
+    (*chain)->handler_count = count;
+    (*chain)->binary_count  = 0;
+    count = 0;
+    for (ancestor = logger; ancestor; ancestor = ancestor->forward_to_parent ? ancestor->parent : NULL) {
+        for (entry = ancestor->handlers; entry; entry = entry->next) {
+            (*chain)->handlers[count++] = entry;
+            if (entry->handler.iface->flags & ATX_LOG_HANDLER_FLAG_BINARY) {
+                ++(*chain)->binary_count;
+            }
+        }
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogHandlerChain_Acquire
+|
+|   Returns a reference to the chain currently published by a logger,
+|   or NULL if no handler gets the logger's records. The LogManager.acquiring
+|   count covers the window between loading the pointer and taking the
+|   reference, during which a retired chain must not be freed.
++---------------------------------------------------------------------*/
+static ATX_LogHandlerChain*
+ATX_LogHandlerChain_Acquire(ATX_Logger* logger)
+{
+    ATX_LogHandlerChain* chain;
+
+    ATX_AtomicInt_Add(&LogManager.acquiring, 1);
+    chain = (ATX_LogHandlerChain*)ATX_AtomicPointer_Get(&logger->chain);
+    if (chain) ATX_AtomicInt_Add(&chain->reference_count, 1);
+    ATX_AtomicInt_Add(&LogManager.acquiring, -1);
+
+    return chain;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogHandlerChain_Release
+|
+|   Chains are only freed by ATX_LogManager_ReclaimChains, so releasing
+|   the last reference to a retired chain leaves it for the next call.
++---------------------------------------------------------------------*/
+static void
+ATX_LogHandlerChain_Release(ATX_LogHandlerChain* self)
+{
+    ATX_AtomicInt_Add(&self->reference_count, -1);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogManager_ReclaimChains
+|
+|   Frees the retired chains that are no longer referenced. Must be
+|   called with the log manager locked.
++---------------------------------------------------------------------*/
+static void
+ATX_LogManager_ReclaimChains(void)
+{
+    ATX_LogHandlerChain** link = &LogManager.retired;
+
+    /* a thread may be about to reference a chain it has just loaded */
+    if (ATX_AtomicInt_Get(&LogManager.acquiring)) return;
+
+    while (*link) {
+        ATX_LogHandlerChain* chain = *link;
+        if (ATX_AtomicInt_Get(&chain->reference_count) == 0) {
+            *link = chain->next_retired;
+            ATX_FreeMemory((void*)chain);
+        } else {
+            link = &chain->next_retired;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Logger_PublishHandlers
+|
+|   Replaces the chain used to log with a snapshot of the handlers the
+|   logger currently resolves to. Must be called with the log manager 
+|   locked, after the logger's parent is set.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_Logger_PublishHandlers(ATX_Logger* self)
+{
+    ATX_LogHandlerChain* chain;
+    ATX_LogHandlerChain* previous;
+
+    ATX_CHECK(ATX_LogHandlerChain_Create(self, &chain));
+    previous = (ATX_LogHandlerChain*)ATX_AtomicPointer_Exchange(&self->chain, chain);
+
+    /* threads that are still logging may use the old chain for a while */
+    if (previous) {
+        ATX_LogHandlerChain_Release(previous);
+        previous->next_retired = LogManager.retired;
+        LogManager.retired = previous;
+    }
+    ATX_LogManager_ReclaimChains();
+
+    return ATX_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
 |   ATX_LogManager_ConfigValueIsBooleanTrue
 +---------------------------------------------------------------------*/
@@ -316,28 +762,71 @@ ATX_LogManager_ConfigValueIsBooleanFalse(ATX_String* value)
         ATX_String_Compare(value, "0",     ATX_FALSE) == 0;
 }
 
+/*----------------------------------------------------------------------
+|   ATX_LogManager_ConfigValueToSize
+|
+|   Parses a size in bytes, with an optional K, M or G suffix.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogManager_ConfigValueToSize(const ATX_String* value, ATX_LargeSize* size)
+{
+    const char*   chars = ATX_CSTR(*value);
+    ATX_LargeSize result = 0;
+
+    if (*chars < '0' || *chars > '9') return ATX_ERROR_INVALID_SYNTAX;
+    while (*chars >= '0' && *chars <= '9') {
+        result = result*10+(ATX_LargeSize)(*chars++ - '0');
+    }
+    switch (*chars) {
+        case 'k': case 'K': result <<= 10; ++chars; break;
+        case 'm': case 'M': result <<= 20; ++chars; break;
+        case 'g': case 'G': result <<= 30; ++chars; break;
+    }
+    if (*chars) return ATX_ERROR_INVALID_SYNTAX;
+
+    *size = result;
+    return ATX_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
 |   ATX_LogManager_GetConfigValue
 +---------------------------------------------------------------------*/
 static ATX_String*
 ATX_LogManager_GetConfigValue(const char* prefix, const char* suffix)
 {
-    ATX_ListItem* item = ATX_List_GetFirstItem(LogManager.config);
+    char          stack_key[ATX_LOG_CONFIG_STACK_KEY_SIZE];
+    char*         key = stack_key;
     ATX_Size      prefix_length = prefix?ATX_StringLength(prefix):0;
     ATX_Size      suffix_length = suffix?ATX_StringLength(suffix):0;
-    ATX_Size      key_length    = prefix_length+suffix_length;
-    while (item) {
-        ATX_LogConfigEntry* entry = (ATX_LogConfigEntry*)ATX_ListItem_GetData(item);
-        if (ATX_String_GetLength(&entry->key) == key_length &&
-            (prefix == NULL || ATX_String_StartsWith(&entry->key, prefix)) &&
-            (suffix == NULL || ATX_String_EndsWith(&entry->key, suffix  )) ) {
-            return &entry->value;
-        }
-        item = ATX_ListItem_GetNext(item);
+    ATX_MapEntry* entry;
+
+    /* build the key, on the stack unless it is unusually long */
+    if (prefix_length+suffix_length >= sizeof(stack_key)) {
+        key = (char*)ATX_AllocateMemory(prefix_length+suffix_length+1);
+        if (key == NULL) return NULL;
     }
+    if (prefix_length) ATX_CopyMemory(key, prefix, prefix_length);
+    if (suffix_length) ATX_CopyMemory(key+prefix_length, suffix, suffix_length);
+    key[prefix_length+suffix_length] = '\0';
+
+    entry = ATX_Map_Get(LogManager.config, key);
+    if (key != stack_key) ATX_FreeMemory((void*)key);
+
+    return entry ? (ATX_String*)ATX_MapEntry_GetData(entry) : NULL;
+}
 
-    /* not found */
-    return NULL;
+/*----------------------------------------------------------------------
+|   ATX_LogManager_DestroyConfigValue
++---------------------------------------------------------------------*/
+static void
+ATX_LogManager_DestroyConfigValue(ATX_ListDataDestructor* self, 
+                                  ATX_Any                 data, 
+                                  ATX_UInt32              type)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(type);
+    ATX_String_Destruct((ATX_String*)data);
+    ATX_FreeMemory(data);
 }
 
 /*----------------------------------------------------------------------
@@ -353,15 +842,15 @@ ATX_LogManager_SetConfigValue(const char* key, const char* value)
     } else {
         /* the value does not already exist, create a new one */
         ATX_Result result;
-        ATX_LogConfigEntry* entry = ATX_AllocateMemory(sizeof(ATX_LogConfigEntry));
-        if (entry == NULL) return ATX_ERROR_OUT_OF_MEMORY;
-        result = ATX_List_AddData(LogManager.config, (void*)entry);
+        value_string = (ATX_String*)ATX_AllocateMemory(sizeof(ATX_String));
+        if (value_string == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        *value_string = ATX_String_Create(value);
+        result = ATX_Map_Put(LogManager.config, key, (ATX_Any)value_string, NULL);
         if (ATX_FAILED(result)) {
-            ATX_FreeMemory((void*)entry);
+            ATX_String_Destruct(value_string);
+            ATX_FreeMemory((void*)value_string);
             return result;
         }
-        entry->key = ATX_String_Create(key);
-        entry->value = ATX_String_Create(value);
     }
 
     return ATX_SUCCESS;
@@ -373,15 +862,7 @@ ATX_LogManager_SetConfigValue(const char* key, const char* value)
 static ATX_Result
 ATX_LogManager_ClearConfig() 
 {
-    ATX_ListItem* item = ATX_List_GetFirstItem(LogManager.config);
-    while (item) {
-        ATX_LogConfigEntry* entry = (ATX_LogConfigEntry*)ATX_ListItem_GetData(item);
-        ATX_String_Destruct(&entry->key);
-        ATX_String_Destruct(&entry->value);
-        ATX_FreeMemory((void*)entry);
-        item = ATX_ListItem_GetNext(item);
-    }
-    ATX_List_Clear(LogManager.config);
+    ATX_Map_Clear(LogManager.config);
 
     return ATX_SUCCESS;
 }
@@ -437,19 +918,49 @@ ATX_LogManager_ParseConfig(const char* config,
 static ATX_Result
 ATX_LogManager_ParseConfigFile(const char* filename) 
 {
-    ATX_Result result;
-
-    /* load the file */
-    ATX_DataBuffer* buffer = NULL;
-    result = ATX_LoadFile(filename, &buffer);
-    if (ATX_FAILED(result)) return result;
-
-    /* parse the config */
-    result = ATX_LogManager_ParseConfig((const char*)ATX_DataBuffer_GetData(buffer),
-                                        ATX_DataBuffer_GetDataSize(buffer));
-
-    /* destroy the buffer */
-    ATX_DataBuffer_Destroy(buffer);
+    ATX_File*                file = NULL;
+    ATX_InputStream*         file_stream = NULL;
+    ATX_BufferedInputStream* stream = NULL;
+    ATX_String               line = ATX_EMPTY_STRING;
+    ATX_Result               result;
+
+    /* open the file */
+    ATX_CHECK(ATX_File_Create(filename, &file));
+    result = ATX_File_Open(file, ATX_FILE_OPEN_MODE_READ);
+    if (ATX_FAILED(result)) goto end;
+    result = ATX_File_GetInputStream(file, &file_stream);
+    if (ATX_FAILED(result)) goto end;
+    result = ATX_BufferedInputStream_Create(file_stream, 0, &stream);
+    if (ATX_FAILED(result)) goto end;
+
+    /* parse the config one line at a time */
+    for (;;) {
+        result = ATX_BufferedInputStream_ReadLineString(stream, 
+                                                        &line, 
+                                                        ATX_LOG_CONFIG_MAX_LINE_LENGTH);
+        if (result == ATX_ERROR_NOT_ENOUGH_SPACE) {
+            /* skip the rest of a line that is too long, and go on */
+            do {
+                result = ATX_BufferedInputStream_ReadLineString(stream, 
+                                                                &line, 
+                                                                ATX_LOG_CONFIG_MAX_LINE_LENGTH);
+            } while (result == ATX_ERROR_NOT_ENOUGH_SPACE);
+            ++LogManager.skipped_config_lines;
+            continue;
+        }
+        if (ATX_FAILED(result)) break;
+        ATX_LogManager_ParseConfig(ATX_CSTR(line), ATX_String_GetLength(&line));
+    }
+    if (result == ATX_ERROR_EOS) result = ATX_SUCCESS;
+
+end:
+    ATX_String_Destruct(&line);
+    ATX_BufferedInputStream_Destroy(stream);
+    ATX_RELEASE_OBJECT(file_stream);
+    if (file) {
+        ATX_File_Close(file);
+        ATX_DESTROY_OBJECT(file);
+    }
 
     return result;
 }
@@ -479,24 +990,10 @@ ATX_LogManager_ParseConfigSource(ATX_String* source)
 static ATX_Boolean
 ATX_LogManager_HaveLoggerConfig(const char* name)
 {
-    ATX_ListItem* item = ATX_List_GetFirstItem(LogManager.config);
-    ATX_Size      name_length = ATX_StringLength(name);
-    while (item) {
-        ATX_LogConfigEntry* entry = (ATX_LogConfigEntry*)ATX_ListItem_GetData(item);
-        if (ATX_String_StartsWith(&entry->key, name)) {
-            const char* suffix = ATX_CSTR(entry->key)+name_length;
-            if (ATX_StringsEqual(suffix, ".level") ||
-                ATX_StringsEqual(suffix, ".handlers") ||
-                ATX_StringsEqual(suffix, ".forward")) {
-                return ATX_TRUE;
-            }
-        }
-        item = ATX_ListItem_GetNext(item);
-    }
-
-    /* no config found */
-    return ATX_FALSE;
-
+    return 
+        ATX_LogManager_GetConfigValue(name, ".level")    != NULL ||
+        ATX_LogManager_GetConfigValue(name, ".handlers") != NULL ||
+        ATX_LogManager_GetConfigValue(name, ".forward")  != NULL;
 }
 
 /*----------------------------------------------------------------------
@@ -531,32 +1028,10 @@ ATX_LogManager_ConfigureLogger(ATX_Logger* logger)
         ATX_String* handlers = ATX_LogManager_GetConfigValue(
             ATX_CSTR(logger->name),".handlers");
         if (handlers) {
-            const char*    handlers_list = ATX_CSTR(*handlers);
-            const char*    cursor = handlers_list;
-            const char*    name_start = handlers_list;
-            ATX_String     handler_name = ATX_EMPTY_STRING;
-            ATX_LogHandler handler = {NULL, NULL};
-            for (;;) {
-                if (*cursor == '\0' || *cursor == ',') {
-                    if (cursor != name_start) {
-                        ATX_String_AssignN(&handler_name, name_start, (ATX_Size)(cursor-name_start));
-                        ATX_String_TrimWhitespace(&handler_name);
-                        
-                        /* create a handler */
-                        if (ATX_SUCCEEDED(
-                            ATX_LogHandler_Create(ATX_CSTR(logger->name),
-                                                  ATX_CSTR(handler_name),
-                                                  &handler))) {
-                            ATX_Logger_AddHandler(logger, &handler);
-                        }
-
-                    }
-                    if (*cursor == '\0') break;
-                    name_start = cursor+1;
-                }
-                ++cursor;
-            }
-            ATX_String_Destruct(&handler_name);
+            ATX_LogHandlerEntry_CreateAll(&logger->handlers,
+                                          ATX_CSTR(logger->name),
+                                          ATX_CSTR(*handlers),
+                                          ATX_TRUE);
         }
     }
 
@@ -583,26 +1058,40 @@ ATX_LogManager_Terminate(void)
 
     /* destroy everything we've created */
     ATX_LogManager_ClearConfig();
-    ATX_List_Destroy(LogManager.config);
+    ATX_Map_Destroy(LogManager.config);
     LogManager.config = NULL;
 
     {
-        ATX_ListItem* item = ATX_List_GetFirstItem(LogManager.loggers);
+        /* map entries are the items of the map's list */
+        ATX_ListItem* item = ATX_List_GetFirstItem(ATX_Map_AsList(LogManager.loggers));
         while (item) {
-            ATX_Logger* logger = (ATX_Logger*)ATX_ListItem_GetData(item);
+            ATX_Logger* logger = (ATX_Logger*)ATX_MapEntry_GetData((ATX_MapEntry*)item);
             ATX_Logger_Destroy(logger);
             item = ATX_ListItem_GetNext(item);
         }
     }
 
-    /* destroy the logger list */
-    ATX_List_Destroy(LogManager.loggers);
+    /* destroy the logger map */
+    ATX_Map_Destroy(LogManager.loggers);
     LogManager.loggers = NULL;
 
     /* destroy the root logger */
     ATX_Logger_Destroy(LogManager.root);
     LogManager.root = NULL;
 
+    /* free the chains that were replaced */
+    while (LogManager.retired) {
+        ATX_LogHandlerChain* next = LogManager.retired->next_retired;
+        ATX_FreeMemory((void*)LogManager.retired);
+        LogManager.retired = next;
+    }
+
+    /* destroy the recursion guard */
+    if (LogManager.dispatching) {
+        ATX_ThreadLocal_Destroy(LogManager.dispatching);
+        LogManager.dispatching = NULL;
+    }
+
     /* destroy the lock */
     if (LogManager.lock) ATX_Mutex_Destroy(LogManager.lock);
     
@@ -635,21 +1124,31 @@ ATX_LogManager_Initialize(void)
         return ATX_SUCCESS;
     }
 
-    /* avoid recursion */
-    LogManager.disabled = ATX_TRUE;
-    
     /* create a lock */
     ATX_Mutex_LockAutoCreate(&LogManager.lock);
     if (LogManager.initialized) {
         ATX_Mutex_Unlock(LogManager.lock);
         return ATX_SUCCESS;
     }
+
+    /* avoid recursion from code that logs while we initialize */
+    LogManager.initializer  = ATX_GetCurrentThreadId();
+    LogManager.initializing = ATX_TRUE;
+
+    /* create the guard against handlers that log */
+    ATX_ThreadLocal_Create(&LogManager.dispatching);
     
-    /* create a logger list */
-    ATX_List_Create(&LogManager.loggers);
+    /* create a logger map */
+    ATX_Map_Create(&LogManager.loggers);
 
     /* create a config */
-    ATX_List_Create(&LogManager.config);
+    {
+        ATX_ListDataDestructor destructor = { 
+            NULL, 
+            ATX_LogManager_DestroyConfigValue 
+        };
+        ATX_Map_CreateEx(&destructor, &LogManager.config);
+    }
 
     /* set some default config values */
     ATX_LogManager_SetConfigValue(".handlers", ATX_LOG_ROOT_DEFAULT_HANDLER);
@@ -692,15 +1191,24 @@ ATX_LogManager_Initialize(void)
         LogManager.root->level = ATX_CONFIG_DEFAULT_LOG_LEVEL;
         LogManager.root->level_is_inherited = ATX_FALSE;
         ATX_LogManager_ConfigureLogger(LogManager.root);
+        ATX_Logger_PublishHandlers(LogManager.root);
     }
 
     /* register a function to be called when the program exits */
     ATX_AtExit(ATX_LogManager_AtExitHandler);
 
     /* we are now initialized */
-    LogManager.disabled    = ATX_FALSE;
-    LogManager.initialized = ATX_TRUE;
+    LogManager.initializing = ATX_FALSE;
+    LogManager.initialized  = ATX_TRUE;
     ATX_Mutex_Unlock(LogManager.lock);
+
+    /* now that there are handlers, report what the config lost */
+    if (LogManager.skipped_config_lines) {
+        ATX_LOG_WARNING_2("%u config lines longer than %d characters were skipped",
+                          (unsigned int)LogManager.skipped_config_lines,
+                          ATX_LOG_CONFIG_MAX_LINE_LENGTH);
+        LogManager.skipped_config_lines = 0;
+    }
     
     return ATX_SUCCESS;
 }
@@ -715,6 +1223,10 @@ ATX_Logger_Create(const char* name)
     ATX_Logger* logger = 
         (ATX_Logger*)ATX_AllocateZeroMemory(sizeof(ATX_Logger));
     if (logger == NULL) return NULL;
+    if (ATX_FAILED(ATX_Atom_Intern(name, &logger->atom))) {
+        ATX_FreeMemory(logger);
+        return NULL;
+    }
 
     /* setup the logger */
     logger->level              = ATX_LOG_LEVEL_OFF;
@@ -732,14 +1244,9 @@ ATX_Logger_Create(const char* name)
 static ATX_Result
 ATX_Logger_Destroy(ATX_Logger* self)
 {
-    /* destroy all handlers */
-    ATX_LogHandlerEntry* entry = self->handlers;
-    while (entry) {
-        ATX_LogHandlerEntry* next = entry->next;
-        entry->handler.iface->Destroy(&entry->handler);
-        ATX_FreeMemory((void*)entry);
-        entry = next;
-    }
+    /* destroy all handlers and the chain that refers to them */
+    ATX_FreeMemory(ATX_AtomicPointer_Get(&self->chain));
+    ATX_LogHandlerEntry_DestroyAll(self->handlers);
     
     /* destruct other members */
     ATX_String_Destruct(&self->name);
@@ -762,71 +1269,100 @@ ATX_Logger_Log(ATX_Logger*  self,
                const char*  msg, 
                             ...)
 {
-    char     buffer[ATX_LOG_STACK_BUFFER_MAX_SIZE];
-    ATX_Size buffer_size = sizeof(buffer);
-    char*    message = buffer;
-    int      result;
-    va_list  args;
+    char                 buffer[ATX_LOG_STACK_BUFFER_MAX_SIZE];
+    ATX_Byte             arguments[ATX_LOG_STACK_BUFFER_MAX_SIZE];
+    ATX_Size             buffer_size = sizeof(buffer);
+    char*                message = buffer;
+    ATX_LogRecord        record;
+    ATX_LogHandlerChain* chain;
+    int                  result;
+    va_list              args;
 
     /* check the log level (in case filtering has not already been done) */
     if (level < self->level) return;
-        
-    for(;;) {
+
+    /* drop records logged by handlers, to prevent recursion */
+    if (!ATX_LogManager_EnterDispatch()) return;
+
+    /* get the handlers for this logger and its parents: the chain stays */
+    /* valid while we hold a reference to it, even if the logger is      */
+    /* reconfigured, so no global lock is needed                          */
+    chain = ATX_LogHandlerChain_Acquire(self);
+    if (chain == NULL) {
+        ATX_LogManager_LeaveDispatch();
+        return;
+    }
+
+    /* setup the log record */
+    record.logger_name     = ATX_CSTR(self->name);
+    record.level           = level;
+    record.message         = NULL;
+    record.source_file     = source_file;
+    record.source_line     = source_line;
+    record.source_function = source_function;
+    record.format          = msg;
+    record.arguments       = NULL;
+    record.arguments_size  = 0;
+    ATX_System_GetCurrentTimeStamp(&record.timestamp);
+
+    /* binary handlers only need the arguments, which is much cheaper */
+    if (chain->binary_count) {
         va_start(args, msg);
-        /* try to format the message (it might not fit) */
-        result = ATX_FormatStringVN(message, buffer_size-1, msg, args);
+        if (ATX_SUCCEEDED(ATX_Log_EncodeArguments(msg, 
+                                                  args, 
+                                                  arguments, 
+                                                  sizeof(arguments), 
+                                                  &record.arguments_size))) {
+            record.arguments = arguments;
+        }
         va_end(args);
-        if (result >= (int)(buffer_size-1)) result = -1;
-        message[buffer_size-1] = 0; /* force a NULL termination */
-        if (result >= 0) break;
+    }
 
-        /* the buffer was too small, try something bigger */
-        buffer_size = (buffer_size+ATX_LOG_HEAP_BUFFER_INCREMENT)*2;
-        if (buffer_size > ATX_LOG_HEAP_BUFFER_MAX_SIZE) break;
-        if (message != buffer) ATX_FreeMemory((void*)message);
-        message = ATX_AllocateMemory(buffer_size);
-        if (message == NULL) return;
+    /* format the message for the other handlers, or if the arguments */
+    /* could not be encoded                                           */
+    if (record.arguments == NULL || chain->binary_count < chain->handler_count) {
+        for(;;) {
+            va_start(args, msg);
+            /* try to format the message (it might not fit) */
+            result = ATX_FormatStringVN(message, buffer_size-1, msg, args);
+            va_end(args);
+            if (result >= (int)(buffer_size-1)) result = -1;
+            message[buffer_size-1] = 0; /* force a NULL termination */
+            if (result >= 0) break;
+
+            /* the buffer was too small, try something bigger */
+            buffer_size = (buffer_size+ATX_LOG_HEAP_BUFFER_INCREMENT)*2;
+            if (buffer_size > ATX_LOG_HEAP_BUFFER_MAX_SIZE) break;
+            if (message != buffer) ATX_FreeMemory((void*)message);
+            message = ATX_AllocateMemory(buffer_size);
+            if (message == NULL) break;
+        }
+        record.message = message;
     }
 
-    {
-        /* the message is formatted, publish it to the handlers */
-        ATX_LogRecord record;
-        ATX_Logger*   logger = self;
-        
-        /* setup the log record */
-        record.logger_name     = ATX_CSTR(logger->name),
-        record.level           = level;
-        record.message         = message;
-        record.source_file     = source_file;
-        record.source_line     = source_line;
-        record.source_function = source_function;
-        ATX_System_GetCurrentTimeStamp(&record.timestamp);
-
-        /* call all handlers for this logger and parents */
-        LogManager.disabled = ATX_TRUE;
-        ATX_LogManager_Lock();
-        while (logger) {
-            /* call all handlers for the current logger */
-            ATX_LogHandlerEntry* entry = logger->handlers;
-            while (entry) {
-                entry->handler.iface->Log(&entry->handler, &record);
-                entry = entry->next;
+    /* publish the record to the handlers */
+    if (record.message || record.arguments) {
+        ATX_Cardinal i;
+        for (i=0; i<chain->handler_count; i++) {
+            ATX_LogHandlerEntry* entry = chain->handlers[i];
+            if (record.message == NULL && 
+                !(entry->handler.iface->flags & ATX_LOG_HANDLER_FLAG_BINARY)) {
+                continue;
             }
-
-            /* forward to the parent unless this logger does not forward */
-            if (logger->forward_to_parent) {
-                logger = logger->parent;
+            if (entry->lock) {
+                ATX_Mutex_Lock(entry->lock);
+                entry->handler.iface->Log(&entry->handler, &record);
+                ATX_Mutex_Unlock(entry->lock);
             } else {
-                break;
+                entry->handler.iface->Log(&entry->handler, &record);
             }
         }
-        ATX_LogManager_Unlock();
-        LogManager.disabled = ATX_FALSE;
     }
-
+    ATX_LogHandlerChain_Release(chain);
+    ATX_LogManager_LeaveDispatch();
 
     /* free anything we may have allocated */
-    if (message != buffer) ATX_FreeMemory((void*)message);
+    if (message && message != buffer) ATX_FreeMemory((void*)message);
 }
 
 /*----------------------------------------------------------------------
@@ -835,23 +1371,34 @@ ATX_Logger_Log(ATX_Logger*  self,
 ATX_Result
 ATX_Logger_AddHandler(ATX_Logger* self, ATX_LogHandler* handler)
 {
-    ATX_LogHandlerEntry* entry;
+    ATX_Result result;
 
     /* check parameters */
     if (handler == NULL) return ATX_ERROR_INVALID_PARAMETERS;
 
-    /* allocate a new entry */
-    entry = (ATX_LogHandlerEntry*)ATX_AllocateMemory(sizeof(ATX_LogHandlerEntry));
-    if (entry == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    ATX_LogManager_Lock();
+    result = ATX_LogHandlerEntry_Add(&self->handlers, handler);
+    if (ATX_SUCCEEDED(result)) result = ATX_Logger_PublishHandlers(self);
 
-    /* setup the entry */
-    entry->handler = *handler;
-    
-    /* attach the new entry at the beginning of the list */
-    entry->next = self->handlers;
-    self->handlers = entry;
+    /* the loggers that forward to this one resolve to the new handler too */
+    if (ATX_SUCCEEDED(result)) {
+        ATX_ListItem* item = ATX_List_GetFirstItem(ATX_Map_AsList(LogManager.loggers));
+        while (item && ATX_SUCCEEDED(result)) {
+            ATX_Logger* logger = (ATX_Logger*)ATX_MapEntry_GetData((ATX_MapEntry*)item);
+            ATX_Logger* ancestor = logger;
+            while (ancestor != self && ancestor->forward_to_parent) {
+                ancestor = ancestor->parent;
+                if (ancestor == NULL) break;
+            }
+            if (ancestor == self && logger != self) {
+                result = ATX_Logger_PublishHandlers(logger);
+            }
+            item = ATX_ListItem_GetNext(item);
+        }
+    }
+    ATX_LogManager_Unlock();
 
-    return ATX_SUCCESS;
+    return result;
 }
 
 /*----------------------------------------------------------------------
@@ -880,16 +1427,8 @@ ATX_Logger_SetParent(ATX_Logger* self, ATX_Logger* parent)
 static ATX_Logger*
 ATX_Log_FindLogger(const char* name)
 {
-    ATX_ListItem* item = ATX_List_GetFirstItem(LogManager.loggers);
-    while (item) {
-        ATX_Logger* logger = (ATX_Logger*)ATX_ListItem_GetData(item);
-        if (ATX_StringsEqual(ATX_CSTR(logger->name), name)) {
-            return logger;
-        }
-        item = ATX_ListItem_GetNext(item);
-    }
-
-    return NULL;
+    ATX_MapEntry* entry = ATX_Map_Get(LogManager.loggers, name);
+    return entry ? (ATX_Logger*)ATX_MapEntry_GetData(entry) : NULL;
 }
 
 /*----------------------------------------------------------------------
@@ -900,8 +1439,11 @@ ATX_Log_GetLogger(const char* name)
 {
     ATX_Logger* logger;
 
-    /* first check if we're disabled (to prevent recursion) */
-    if (LogManager.disabled) return NULL;
+    /* loggers can't be created while the manager initializes itself */
+    if (LogManager.initializing && 
+        LogManager.initializer == ATX_GetCurrentThreadId()) {
+        return NULL;
+    }
     
     /* check that the manager is initialized */
     if (!LogManager.initialized) {
@@ -959,8 +1501,11 @@ ATX_Log_GetLogger(const char* name)
         ATX_Logger_SetParent(logger, parent);
     }
 
-    /* add this logger to the list */
-    ATX_List_AddData(LogManager.loggers, (void*)logger);
+    /* resolve the handlers once, rather than each time a record is logged */
+    ATX_Logger_PublishHandlers(logger);
+
+    /* add this logger to the map */
+    ATX_Map_Put(LogManager.loggers, name, (ATX_Any)logger, NULL);
 
     ATX_LogManager_Unlock();
     return logger;
@@ -1011,68 +1556,72 @@ ATX_LogNullHandler_Log(ATX_LogHandler* self, const ATX_LogRecord* record)
 static const ATX_LogHandlerInterface 
 ATX_LogNullHandler_Interface = {
     ATX_LogNullHandler_Log,
-    ATX_LogNullHandler_Destroy
+    ATX_LogNullHandler_Destroy,
+    0
 };
 
 /*----------------------------------------------------------------------
-|   ATX_Log_FormatRecordToStream
+|   ATX_Log_FormatRecord
+|
+|   Appends the text form of a record to a builder, so that it can be
+|   output with a single write.
 +---------------------------------------------------------------------*/
-static void
-ATX_Log_FormatRecordToStream(const ATX_LogRecord* record,
-                             ATX_OutputStream*    stream,
-                             ATX_Boolean          use_colors,
-                             ATX_Flags            format_filter)
+static ATX_Result
+ATX_Log_FormatRecord(const ATX_LogRecord* record,
+                     ATX_StringBuilder*   output,
+                     ATX_Boolean          use_colors,
+                     ATX_Flags            format_filter)
 {
     const char* level_name = ATX_Log_GetLogLevelName(record->level);
     char        level_string[16];
     char        buffer[64];
     const char* ansi_color = NULL;
 
-    /* format and emit the record */
+    /* format the record */
     if (level_name[0] == '\0') {
         ATX_IntegerToString(record->level, level_string, sizeof(level_string));
         level_name = level_string;
     }
     if ((format_filter & ATX_LOG_FORMAT_FILTER_NO_SOURCE) == 0) {
-        ATX_OutputStream_WriteString(stream, record->source_file);
-        ATX_OutputStream_WriteFully(stream, "(", 1);
+        ATX_CHECK(ATX_StringBuilder_Append(output, record->source_file));
+        ATX_CHECK(ATX_StringBuilder_AppendChar(output, '('));
         ATX_IntegerToStringU(record->source_line, buffer, sizeof(buffer));
-        ATX_OutputStream_WriteString(stream, buffer);
-        ATX_OutputStream_WriteFully(stream, "): ", 3);
+        ATX_CHECK(ATX_StringBuilder_Append(output, buffer));
+        ATX_CHECK(ATX_StringBuilder_AppendSubString(output, "): ", 3));
     }
-    ATX_OutputStream_WriteFully(stream, "[", 1);
-    ATX_OutputStream_WriteString(stream, record->logger_name);
-    ATX_OutputStream_WriteFully(stream, "] ", 2);
+    ATX_CHECK(ATX_StringBuilder_AppendChar(output, '['));
+    ATX_CHECK(ATX_StringBuilder_Append(output, record->logger_name));
+    ATX_CHECK(ATX_StringBuilder_AppendSubString(output, "] ", 2));
     if ((format_filter & ATX_LOG_FORMAT_FILTER_NO_TIMESTAMP) == 0) {
         ATX_IntegerToStringU(record->timestamp.seconds, buffer, sizeof(buffer));
-        ATX_OutputStream_WriteString(stream, buffer);
-        ATX_OutputStream_WriteString(stream, ":");
+        ATX_CHECK(ATX_StringBuilder_Append(output, buffer));
+        ATX_CHECK(ATX_StringBuilder_AppendChar(output, ':'));
         ATX_IntegerToStringU(record->timestamp.nanoseconds/1000000L, buffer, sizeof(buffer));
-        ATX_OutputStream_WriteString(stream, buffer);
-        ATX_OutputStream_WriteFully(stream, " ", 1);
+        ATX_CHECK(ATX_StringBuilder_Append(output, buffer));
+        ATX_CHECK(ATX_StringBuilder_AppendChar(output, ' '));
     }
     if ((format_filter & ATX_LOG_FORMAT_FILTER_NO_FUNCTION_NAME) == 0) {
-        ATX_OutputStream_WriteFully(stream, "[",1);
+        ATX_CHECK(ATX_StringBuilder_AppendChar(output, '['));
         if (record->source_function) {
-            ATX_OutputStream_WriteString(stream, record->source_function);
+            ATX_CHECK(ATX_StringBuilder_Append(output, record->source_function));
         }
-        ATX_OutputStream_WriteFully(stream, "] ",2);
+        ATX_CHECK(ATX_StringBuilder_AppendSubString(output, "] ", 2));
     }
     if (use_colors) {
         ansi_color = ATX_Log_GetLogLevelAnsiColor(record->level);
         if (ansi_color) {
-            ATX_OutputStream_WriteFully(stream, "\033[", 2);
-            ATX_OutputStream_WriteString(stream, ansi_color);
-            ATX_OutputStream_WriteFully(stream, ";1m", 3);
+            ATX_CHECK(ATX_StringBuilder_AppendSubString(output, "\033[", 2));
+            ATX_CHECK(ATX_StringBuilder_Append(output, ansi_color));
+            ATX_CHECK(ATX_StringBuilder_AppendSubString(output, ";1m", 3));
         }
     }
-    ATX_OutputStream_WriteString(stream, level_name);
+    ATX_CHECK(ATX_StringBuilder_Append(output, level_name));
     if (use_colors && ansi_color) {
-        ATX_OutputStream_WriteFully(stream, "\033[0m", 4);
+        ATX_CHECK(ATX_StringBuilder_AppendSubString(output, "\033[0m", 4));
     }
-    ATX_OutputStream_WriteFully(stream, ": ", 2);
-    ATX_OutputStream_WriteString(stream, record->message);
-    ATX_OutputStream_WriteFully(stream, "\r\n", 2);
+    ATX_CHECK(ATX_StringBuilder_AppendSubString(output, ": ", 2));
+    ATX_CHECK(ATX_StringBuilder_Append(output, record->message));
+    return ATX_StringBuilder_AppendSubString(output, "\r\n", 2);
 }
 
 /*----------------------------------------------------------------------
@@ -1087,24 +1636,17 @@ static void
 ATX_LogConsoleHandler_Log(ATX_LogHandler* _self, const ATX_LogRecord* record)
 {
     ATX_LogConsoleHandler* self = (ATX_LogConsoleHandler*)_self->instance;
-    ATX_MemoryStream*      memory_stream;
-    ATX_OutputStream*      output_stream;
-
-    if (ATX_FAILED(ATX_MemoryStream_Create(4096, &memory_stream))) return;
-    if (ATX_SUCCEEDED(ATX_MemoryStream_GetOutputStream(memory_stream, &output_stream))) {
-        const ATX_DataBuffer* buffer;
-        ATX_Log_FormatRecordToStream(record, output_stream, self->use_colors, self->format_filter);
-        ATX_OutputStream_WriteFully(output_stream, "\0", 1);
-        ATX_MemoryStream_GetBuffer(memory_stream, &buffer);
+    ATX_StringBuilder      output = ATX_EMPTY_STRING_BUILDER;
+
+    if (ATX_SUCCEEDED(ATX_Log_FormatRecord(record, &output, self->use_colors, self->format_filter))) {
         if (self->outputs & ATX_LOG_CONSOLE_HANDLER_OUTPUT_TO_CONSOLE) {
-            ATX_ConsoleOutput((const char*)ATX_DataBuffer_GetData(buffer));
+            ATX_ConsoleOutput(ATX_StringBuilder_GetChars(&output));
         }
         if (self->outputs & ATX_LOG_CONSOLE_HANDLER_OUTPUT_TO_DEBUG) {
-            ATX_DebugOutput((const char*)ATX_DataBuffer_GetData(buffer));
+            ATX_DebugOutput(ATX_StringBuilder_GetChars(&output));
         }
-        ATX_RELEASE_OBJECT(output_stream);
     }
-    ATX_MemoryStream_Destroy(memory_stream);
+    ATX_StringBuilder_Destruct(&output);
 }
 
 /*----------------------------------------------------------------------
@@ -1186,401 +1728,2570 @@ ATX_LogConsoleHandler_Create(const char*     logger_name,
 static const ATX_LogHandlerInterface 
 ATX_LogConsoleHandler_Interface = {
     ATX_LogConsoleHandler_Log,
-    ATX_LogConsoleHandler_Destroy
+    ATX_LogConsoleHandler_Destroy,
+    0 /* each record is output with a single call */
 };
 
 /*----------------------------------------------------------------------
-|   ATX_LogFileHandler forward references
-+---------------------------------------------------------------------*/
-static const ATX_LogHandlerInterface ATX_LogFileHandler_Interface;
-
-/*----------------------------------------------------------------------
-|   ATX_LogFileHandler_Log
+|   ATX_Log_ParseConversion
+|
+|   Finds the next conversion of a printf-style format. Returns 
+|   ATX_ERROR_EOS when there are no more, and ATX_ERROR_NOT_SUPPORTED
+|   for the ones that binary records can't carry (like %n or %ls).
 +---------------------------------------------------------------------*/
-static void
-ATX_LogFileHandler_Log(ATX_LogHandler* _self, const ATX_LogRecord* record)
+static ATX_Result
+ATX_Log_ParseConversion(const char* format, ATX_LogConversion* conversion)
 {
-    ATX_LogFileHandler* self = (ATX_LogFileHandler*)_self->instance;
-    ATX_Log_FormatRecordToStream(record, self->stream, ATX_FALSE, 0);
-}
+    const char* cursor = format;
+
+    /* find the next '%' */
+    while (*cursor && *cursor != '%') ++cursor;
+    if (*cursor == '\0') return ATX_ERROR_EOS;
+    conversion->start      = cursor++;
+    conversion->star_count = 0;
+    conversion->precision  = ATX_LOG_PRECISION_NONE;
+    conversion->length     = 0;
+
+    /* flags and width */
+    while (*cursor == '-' || *cursor == '+' || *cursor == ' ' || 
+           *cursor == '#' || *cursor == '0') {
+        ++cursor;
+    }
+    if (*cursor == '*') {
+        ++conversion->star_count;
+        ++cursor;
+    } else {
+        while (*cursor >= '0' && *cursor <= '9') ++cursor;
+    }
+
+    /* precision */
+    if (*cursor == '.') {
+        ++cursor;
+        if (*cursor == '*') {
+            ++conversion->star_count;
+            conversion->precision = ATX_LOG_PRECISION_STAR;
+            ++cursor;
+        } else {
+            conversion->precision = 0;
+            while (*cursor >= '0' && *cursor <= '9') {
+                conversion->precision = conversion->precision*10+(*cursor++ - '0');
+            }
+        }
+    }
+
+    /* length modifier */
+    conversion->modifiers_end = cursor;
+    if (cursor[0] == 'h' && cursor[1] == 'h') {
+        conversion->length = 'H';
+        cursor += 2;
+    } else if (cursor[0] == 'l' && cursor[1] == 'l') {
+        conversion->length = 'q';
+        cursor += 2;
+    } else if (*cursor == 'h' || *cursor == 'l' || *cursor == 'L' ||
+               *cursor == 'z' || *cursor == 't') {
+        conversion->length = *cursor++;
+    }
+
+    /* conversion */
+    conversion->conversion = *cursor;
+    if (*cursor == '\0') return ATX_ERROR_INVALID_SYNTAX;
+    conversion->end = cursor+1;
+    switch (*cursor) {
+        case '%':
+            conversion->type = ATX_LOG_ARGUMENT_NONE;
+            break;
+
+        case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+            switch (conversion->length) {
+                case 0: case 'h': case 'H': conversion->type = ATX_LOG_ARGUMENT_INT;       break;
+                case 'l':                   conversion->type = ATX_LOG_ARGUMENT_LONG;      break;
+                case 'q':                   conversion->type = ATX_LOG_ARGUMENT_LONG_LONG; break;
+                case 'z':                   conversion->type = ATX_LOG_ARGUMENT_SIZE;      break;
+                case 't':                   conversion->type = ATX_LOG_ARGUMENT_PTRDIFF;   break;
+                default: return ATX_ERROR_NOT_SUPPORTED;
+            }
+            break;
+
+        case 'c':
+            if (conversion->length) return ATX_ERROR_NOT_SUPPORTED;
+            conversion->type = ATX_LOG_ARGUMENT_INT;
+            break;
+
+        case 's':
+            if (conversion->length) return ATX_ERROR_NOT_SUPPORTED;
+            conversion->type = ATX_LOG_ARGUMENT_STRING;
+            break;
+
+        case 'p':
+            conversion->type = ATX_LOG_ARGUMENT_POINTER;
+            break;
+
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+            conversion->type = conversion->length == 'L' ? 
+                               ATX_LOG_ARGUMENT_LONG_DOUBLE : 
+                               ATX_LOG_ARGUMENT_DOUBLE;
+            break;
+
+        default:
+            return ATX_ERROR_NOT_SUPPORTED;
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Log_EncodeArguments
+|
+|   Copies the arguments of a message, as described by its format, to
+|   a buffer. Strings are copied, everything else is stored as a 32 or
+|   64-bit value.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_Log_EncodeArguments(const char* format, 
+                        va_list     args,
+                        ATX_Byte*   buffer,
+                        ATX_Size    buffer_size,
+                        ATX_Size*   encoded_size)
+{
+    ATX_LogConversion conversion;
+    ATX_Size          size = 0;
+    ATX_Result        result;
+
+    while ((result = ATX_Log_ParseConversion(format, &conversion)) == ATX_SUCCESS) {
+        ATX_Boolean  is_signed = (conversion.conversion == 'd' || conversion.conversion == 'i');
+        int          precision = conversion.precision;
+        unsigned int star;
+        
+        format = conversion.end;
+
+        /* '*' width and precision come before the value */
+        for (star = 0; star < conversion.star_count; star++) {
+            int value = va_arg(args, int);
+            if (star+1 == conversion.star_count && precision == ATX_LOG_PRECISION_STAR) {
+                precision = value;
+            }
+            if (size+5 > buffer_size) return ATX_ERROR_NOT_ENOUGH_SPACE;
+            buffer[size] = 'i';
+            ATX_BytesFromInt32Be(buffer+size+1, (ATX_UInt32)value);
+            size += 5;
+        }
+
+        switch (conversion.type) {
+            case ATX_LOG_ARGUMENT_NONE:
+                break;
+
+            case ATX_LOG_ARGUMENT_INT: {
+                int value = va_arg(args, int);
+                if (conversion.length == 'h') {
+                    value = is_signed ? (int)(short)value : (int)(unsigned short)value;
+                } else if (conversion.length == 'H') {
+                    value = is_signed ? (int)(signed char)value : (int)(unsigned char)value;
+                }
+                if (size+5 > buffer_size) return ATX_ERROR_NOT_ENOUGH_SPACE;
+                buffer[size] = 'i';
+                ATX_BytesFromInt32Be(buffer+size+1, (ATX_UInt32)value);
+                size += 5;
+                break;
+            }
+
+            case ATX_LOG_ARGUMENT_LONG:
+            case ATX_LOG_ARGUMENT_LONG_LONG:
+            case ATX_LOG_ARGUMENT_SIZE:
+            case ATX_LOG_ARGUMENT_PTRDIFF: 
+            case ATX_LOG_ARGUMENT_POINTER: {
+                ATX_UInt64 value;
+                switch (conversion.type) {
+                    case ATX_LOG_ARGUMENT_LONG:
+                        value = is_signed ? 
+                                (ATX_UInt64)va_arg(args, long) : 
+                                (ATX_UInt64)va_arg(args, unsigned long);
+                        break;
+                    case ATX_LOG_ARGUMENT_LONG_LONG:
+                        value = (ATX_UInt64)va_arg(args, ATX_Int64);
+                        break;
+                    case ATX_LOG_ARGUMENT_SIZE:
+                        value = (ATX_UInt64)va_arg(args, size_t);
+                        break;
+                    case ATX_LOG_ARGUMENT_PTRDIFF:
+                        value = (ATX_UInt64)va_arg(args, ptrdiff_t);
+                        break;
+                    default:
+                        value = (ATX_UInt64)(size_t)va_arg(args, void*);
+                        break;
+                }
+                if (size+9 > buffer_size) return ATX_ERROR_NOT_ENOUGH_SPACE;
+                buffer[size] = conversion.type == ATX_LOG_ARGUMENT_POINTER ? 'p' : 'l';
+                ATX_BytesFromInt64Be(buffer+size+1, value);
+                size += 9;
+                break;
+            }
+
+            case ATX_LOG_ARGUMENT_DOUBLE:
+            case ATX_LOG_ARGUMENT_LONG_DOUBLE: {
+                double     value;
+                ATX_UInt64 bits;
+                if (conversion.type == ATX_LOG_ARGUMENT_DOUBLE) {
+                    value = va_arg(args, double);
+                } else {
+                    value = (double)va_arg(args, long double);
+                }
+                ATX_CopyMemory(&bits, &value, sizeof(bits));
+                if (size+9 > buffer_size) return ATX_ERROR_NOT_ENOUGH_SPACE;
+                buffer[size] = 'd';
+                ATX_BytesFromInt64Be(buffer+size+1, bits);
+                size += 9;
+                break;
+            }
+
+            case ATX_LOG_ARGUMENT_STRING: {
+                const char* value = va_arg(args, const char*);
+                ATX_Size    length = 0;
+                if (value == NULL) {
+                    if (size+1 > buffer_size) return ATX_ERROR_NOT_ENOUGH_SPACE;
+                    buffer[size++] = 'n';
+                    break;
+                }
+
+                /* with a precision, the string does not need a terminator */
+                while ((precision < 0 || length < (ATX_Size)precision) && value[length]) {
+                    ++length;
+                }
+                if (size+5+length > buffer_size) return ATX_ERROR_NOT_ENOUGH_SPACE;
+                buffer[size] = 's';
+                ATX_BytesFromInt32Be(buffer+size+1, (ATX_UInt32)length);
+                ATX_CopyMemory(buffer+size+5, value, length);
+                size += 5+length;
+                break;
+            }
+        }
+    }
+    if (result != ATX_ERROR_EOS) return result;
+
+    *encoded_size = size;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Log_FormatArguments
+|
+|   Formats a message from its format and encoded arguments.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_Log_FormatArguments(const char*        format,
+                        const ATX_Byte*    arguments,
+                        ATX_Size           arguments_size,
+                        ATX_StringBuilder* message,
+                        ATX_String*        scratch)
+{
+    const ATX_Byte*   end = arguments+arguments_size;
+    ATX_LogConversion conversion;
+    ATX_Result        result;
+
+    ATX_StringBuilder_Reset(message);
+    while ((result = ATX_Log_ParseConversion(format, &conversion)) == ATX_SUCCESS) {
+        char         spec[ATX_LOG_BINARY_MAX_SPEC_SIZE];
+        ATX_Size     spec_size = 0;
+        ATX_Size     modifiers_size = (ATX_Size)(conversion.modifiers_end-conversion.start);
+        ATX_Boolean  is_signed = (conversion.conversion == 'd' || conversion.conversion == 'i');
+        int          stars[2] = {0, 0};
+        unsigned int star;
+        ATX_Byte     tag;
+
+        /* copy the text up to the conversion */
+        ATX_CHECK(ATX_StringBuilder_AppendSubString(message, format, (ATX_Size)(conversion.start-format)));
+        format = conversion.end;
+        if (conversion.type == ATX_LOG_ARGUMENT_NONE) {
+            ATX_CHECK(ATX_StringBuilder_AppendChar(message, '%'));
+            continue;
+        }
+
+        /* rebuild the conversion for the decoded type of the value */
+        if (modifiers_size+4 > sizeof(spec)) return ATX_ERROR_INVALID_FORMAT;
+        ATX_CopyMemory(spec, conversion.start, modifiers_size);
+        spec_size = modifiers_size;
+
+        /* '*' width and precision */
+        for (star = 0; star < conversion.star_count; star++) {
+            if (arguments+5 > end || arguments[0] != 'i') return ATX_ERROR_INVALID_FORMAT;
+            stars[star] = (int)ATX_BytesToInt32Be(arguments+1);
+            arguments += 5;
+        }
+
+        /* the value */
+        if (arguments >= end) return ATX_ERROR_INVALID_FORMAT;
+        tag = *arguments++;
+        switch (tag) {
+            case 'i':
+            case 'l': {
+                ATX_Int64 value;
+                if (conversion.type == ATX_LOG_ARGUMENT_STRING  ||
+                    conversion.type == ATX_LOG_ARGUMENT_POINTER ||
+                    conversion.type == ATX_LOG_ARGUMENT_DOUBLE  ||
+                    conversion.type == ATX_LOG_ARGUMENT_LONG_DOUBLE) {
+                    return ATX_ERROR_INVALID_FORMAT;
+                }
+                if (tag == 'i') {
+                    ATX_UInt32 bits;
+                    if (arguments+4 > end) return ATX_ERROR_INVALID_FORMAT;
+                    bits = ATX_BytesToInt32Be(arguments);
+                    value = is_signed ? (ATX_Int64)(ATX_Int32)bits : (ATX_Int64)bits;
+                    arguments += 4;
+                } else {
+                    if (arguments+8 > end) return ATX_ERROR_INVALID_FORMAT;
+                    value = (ATX_Int64)ATX_BytesToInt64Be(arguments);
+                    arguments += 8;
+                }
+                if (conversion.conversion == 'c') {
+                    spec[spec_size++] = 'c';
+                    spec[spec_size]   = '\0';
+                    result = ATX_LOG_APPEND_ARGUMENT(message, spec, stars, conversion.star_count, (int)value);
+                } else {
+                    spec[spec_size++] = 'l';
+                    spec[spec_size++] = 'l';
+                    spec[spec_size++] = conversion.conversion;
+                    spec[spec_size]   = '\0';
+                    result = ATX_LOG_APPEND_ARGUMENT(message, spec, stars, conversion.star_count, value);
+                }
+                break;
+            }
+
+            case 'd': {
+                double     value;
+                ATX_UInt64 bits;
+                if (conversion.type != ATX_LOG_ARGUMENT_DOUBLE &&
+                    conversion.type != ATX_LOG_ARGUMENT_LONG_DOUBLE) {
+                    return ATX_ERROR_INVALID_FORMAT;
+                }
+                if (arguments+8 > end) return ATX_ERROR_INVALID_FORMAT;
+                bits = ATX_BytesToInt64Be(arguments);
+                ATX_CopyMemory(&value, &bits, sizeof(value));
+                arguments += 8;
+                spec[spec_size++] = conversion.conversion;
+                spec[spec_size]   = '\0';
+                result = ATX_LOG_APPEND_ARGUMENT(message, spec, stars, conversion.star_count, value);
+                break;
+            }
+
+            case 'p': {
+                ATX_UInt64 value;
+                if (conversion.type != ATX_LOG_ARGUMENT_POINTER) return ATX_ERROR_INVALID_FORMAT;
+                if (arguments+8 > end) return ATX_ERROR_INVALID_FORMAT;
+                value = ATX_BytesToInt64Be(arguments);
+                arguments += 8;
+                spec[spec_size++] = 'p';
+                spec[spec_size]   = '\0';
+                result = ATX_LOG_APPEND_ARGUMENT(message, spec, stars, conversion.star_count, (void*)(size_t)value);
+                break;
+            }
+
+            case 's':
+            case 'n': {
+                const char* value = "(null)";
+                if (conversion.type != ATX_LOG_ARGUMENT_STRING) return ATX_ERROR_INVALID_FORMAT;
+                if (tag == 's') {
+                    ATX_UInt32 length;
+                    if (arguments+4 > end) return ATX_ERROR_INVALID_FORMAT;
+                    length = ATX_BytesToInt32Be(arguments);
+                    arguments += 4;
+                    if (length > (ATX_UInt32)(end-arguments)) return ATX_ERROR_INVALID_FORMAT;
+                    ATX_CHECK(ATX_String_AssignN(scratch, (const char*)arguments, length));
+                    arguments += length;
+                    value = ATX_CSTR(*scratch);
+                }
+                spec[spec_size++] = 's';
+                spec[spec_size]   = '\0';
+                result = ATX_LOG_APPEND_ARGUMENT(message, spec, stars, conversion.star_count, value);
+                break;
+            }
+
+            default:
+                return ATX_ERROR_INVALID_FORMAT;
+        }
+        if (ATX_FAILED(result)) return result;
+    }
+    if (result != ATX_ERROR_EOS) return result;
+
+    /* the text after the last conversion */
+    return ATX_StringBuilder_Append(message, format);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinaryEncoder_Create
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogBinaryEncoder_Create(ATX_LogBinaryEncoder** encoder)
+{
+    *encoder = (ATX_LogBinaryEncoder*)ATX_AllocateZeroMemory(sizeof(ATX_LogBinaryEncoder));
+    return *encoder ? ATX_SUCCESS : ATX_ERROR_OUT_OF_MEMORY;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinaryEncoder_Reset
+|
+|   Forgets the strings defined so far, for a new stream.
++---------------------------------------------------------------------*/
+static void
+ATX_LogBinaryEncoder_Reset(ATX_LogBinaryEncoder* self)
+{
+    unsigned int kind;
+    unsigned int slot;
+
+    for (kind = 0; kind < ATX_LOG_BINARY_STRING_KINDS; kind++) {
+        for (slot = 0; slot < ATX_LOG_BINARY_STRING_SLOTS; slot++) {
+            if (self->strings[kind][slot].copy) {
+                ATX_FreeMemory((void*)self->strings[kind][slot].copy);
+            }
+            self->strings[kind][slot].copy    = NULL;
+            self->strings[kind][slot].pointer = NULL;
+        }
+    }
+    self->started = ATX_FALSE;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinaryEncoder_Destroy
++---------------------------------------------------------------------*/
+static void
+ATX_LogBinaryEncoder_Destroy(ATX_LogBinaryEncoder* self)
+{
+    if (self == NULL) return;
+    ATX_LogBinaryEncoder_Reset(self);
+    ATX_FreeMemory((void*)self);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinary_GetStringSlot
+|
+|   Maps the address of a string to a slot of a string cache.
++---------------------------------------------------------------------*/
+static unsigned int
+ATX_LogBinary_GetStringSlot(const char* string)
+{
+    size_t     address = (size_t)string;
+    ATX_UInt32 key = (ATX_UInt32)(address >> 3) ^ (ATX_UInt32)(address >> 19);
+
+    return (unsigned int)((ATX_UInt32)(key*2654435761U) >> 24);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinaryEncoder_DefineString
+|
+|   Returns the id of a string, defining it in the output first if it
+|   isn't already. Strings are identified by address (they normally are
+|   literals or logger names), and ids are slots of a small cache, so a
+|   string is defined again when another one has taken its slot.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogBinaryEncoder_DefineString(ATX_LogBinaryEncoder* self,
+                                  unsigned int          kind,
+                                  const char*           string,
+                                  ATX_StringBuilder*    output,
+                                  ATX_UInt16*           id)
+{
+    unsigned int         slot = ATX_LogBinary_GetStringSlot(string);
+    ATX_LogBinaryString* entry = &self->strings[kind][slot];
+    ATX_Byte             header[8];
+    ATX_Size             length;
+
+    *id = (ATX_UInt16)slot;
+    if (entry->pointer == string) {
+        /* formats are not always literals, so check that it's unchanged */
+        if (kind != ATX_LOG_BINARY_STRING_FORMAT || 
+            (entry->copy && ATX_StringsEqual(entry->copy, string))) {
+            return ATX_SUCCESS;
+        }
+    }
+
+    /* (re)define the string */
+    if (entry->copy) ATX_FreeMemory((void*)entry->copy);
+    entry->copy    = NULL;
+    entry->pointer = string;
+    if (kind == ATX_LOG_BINARY_STRING_FORMAT) {
+        entry->copy = ATX_DuplicateString(string);
+    }
+    length = ATX_StringLength(string);
+    header[0] = 'S';
+    header[1] = (ATX_Byte)kind;
+    ATX_BytesFromInt16Be(header+2, (ATX_UInt16)slot);
+    ATX_BytesFromInt32Be(header+4, (ATX_UInt32)length);
+    ATX_CHECK(ATX_StringBuilder_AppendSubString(output, (const char*)header, sizeof(header)));
+    return ATX_StringBuilder_AppendSubString(output, string, length);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinaryEncoder_EncodeRecord
+|
+|   Appends a record, with the definitions of any new strings it uses.
+|   Records that only have a formatted message are stored with a "%s"
+|   format.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogBinaryEncoder_EncodeRecord(ATX_LogBinaryEncoder* self,
+                                  const ATX_LogRecord*  record,
+                                  ATX_StringBuilder*    output)
+{
+    ATX_Byte    header[1+4+ATX_LOG_BINARY_RECORD_HEADER_SIZE];
+    ATX_Byte    message_header[5];
+    const char* format = record->arguments ? record->format : "%s";
+    ATX_Size    message_length = 0;
+    ATX_Size    arguments_size = record->arguments_size;
+    ATX_UInt16  logger_id;
+    ATX_UInt16  file_id;
+    ATX_UInt16  function_id;
+    ATX_UInt16  format_id;
+
+    if (!self->started) {
+        ATX_CHECK(ATX_StringBuilder_AppendSubString(output, 
+                                                    ATX_LOG_BINARY_MAGIC, 
+                                                    ATX_LOG_BINARY_MAGIC_SIZE));
+        self->started = ATX_TRUE;
+    }
+    if (record->arguments == NULL) {
+        message_length = ATX_StringLength(record->message);
+        arguments_size = sizeof(message_header)+message_length;
+    }
+
+    /* the strings */
+    ATX_CHECK(ATX_LogBinaryEncoder_DefineString(self, 
+                                                ATX_LOG_BINARY_STRING_LOGGER_NAME, 
+                                                record->logger_name, 
+                                                output, 
+                                                &logger_id));
+    ATX_CHECK(ATX_LogBinaryEncoder_DefineString(self, 
+                                                ATX_LOG_BINARY_STRING_SOURCE_FILE, 
+                                                record->source_file ? record->source_file : "", 
+                                                output, 
+                                                &file_id));
+    ATX_CHECK(ATX_LogBinaryEncoder_DefineString(self, 
+                                                ATX_LOG_BINARY_STRING_SOURCE_FUNCTION, 
+                                                record->source_function ? record->source_function : "", 
+                                                output, 
+                                                &function_id));
+    ATX_CHECK(ATX_LogBinaryEncoder_DefineString(self, 
+                                                ATX_LOG_BINARY_STRING_FORMAT, 
+                                                format, 
+                                                output, 
+                                                &format_id));
+
+    /* the record */
+    header[0] = 'R';
+    ATX_BytesFromInt32Be(header+ 1, (ATX_UInt32)(ATX_LOG_BINARY_RECORD_HEADER_SIZE+arguments_size));
+    ATX_BytesFromInt32Be(header+ 5, (ATX_UInt32)record->level);
+    ATX_BytesFromInt32Be(header+ 9, (ATX_UInt32)record->timestamp.seconds);
+    ATX_BytesFromInt32Be(header+13, (ATX_UInt32)record->timestamp.nanoseconds);
+    ATX_BytesFromInt32Be(header+17, (ATX_UInt32)record->source_line);
+    ATX_BytesFromInt16Be(header+21, logger_id);
+    ATX_BytesFromInt16Be(header+23, file_id);
+    ATX_BytesFromInt16Be(header+25, function_id);
+    ATX_BytesFromInt16Be(header+27, format_id);
+    ATX_CHECK(ATX_StringBuilder_AppendSubString(output, (const char*)header, sizeof(header)));
+    if (record->arguments) {
+        return ATX_StringBuilder_AppendSubString(output, 
+                                                 (const char*)record->arguments, 
+                                                 record->arguments_size);
+    } else {
+        message_header[0] = 's';
+        ATX_BytesFromInt32Be(message_header+1, (ATX_UInt32)message_length);
+        ATX_CHECK(ATX_StringBuilder_AppendSubString(output, 
+                                                    (const char*)message_header, 
+                                                    sizeof(message_header)));
+        return ATX_StringBuilder_AppendSubString(output, record->message, message_length);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinaryDecoder_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_LogBinaryDecoder_Create(ATX_InputStream*       stream, 
+                            ATX_LogBinaryDecoder** decoder)
+{
+    unsigned int kind;
+    unsigned int slot;
+
+    /* check parameters */
+    if (stream == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+
+    /* allocate the object */
+    *decoder = (ATX_LogBinaryDecoder*)ATX_AllocateZeroMemory(sizeof(ATX_LogBinaryDecoder));
+    if (*decoder == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* construct the object */
+    for (kind = 0; kind < ATX_LOG_BINARY_STRING_KINDS; kind++) {
+        for (slot = 0; slot < ATX_LOG_BINARY_STRING_SLOTS; slot++) {
+            ATX_String_Construct(&(*decoder)->strings[kind][slot]);
+        }
+    }
+    ATX_String_Construct(&(*decoder)->argument);
+    ATX_StringBuilder_Construct(&(*decoder)->message);
+    (*decoder)->stream = stream;
+    ATX_REFERENCE_OBJECT(stream);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinaryDecoder_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_LogBinaryDecoder_Destroy(ATX_LogBinaryDecoder* self)
+{
+    unsigned int kind;
+    unsigned int slot;
+
+    if (self == NULL) return ATX_SUCCESS;
+
+    for (kind = 0; kind < ATX_LOG_BINARY_STRING_KINDS; kind++) {
+        for (slot = 0; slot < ATX_LOG_BINARY_STRING_SLOTS; slot++) {
+            ATX_String_Destruct(&self->strings[kind][slot]);
+        }
+    }
+    ATX_String_Destruct(&self->argument);
+    ATX_StringBuilder_Destruct(&self->message);
+    if (self->data) ATX_FreeMemory((void*)self->data);
+    ATX_RELEASE_OBJECT(self->stream);
+    ATX_FreeMemory((void*)self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinaryDecoder_ReadData
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogBinaryDecoder_ReadData(ATX_LogBinaryDecoder* self, ATX_Size size)
+{
+    if (size > ATX_LOG_BINARY_MAX_ENTRY_SIZE) return ATX_ERROR_INVALID_FORMAT;
+    if (size > self->data_size) {
+        ATX_Byte* data = (ATX_Byte*)ATX_ReallocateMemory(self->data, size);
+        if (data == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        self->data      = data;
+        self->data_size = size;
+    }
+    if (size == 0) return ATX_SUCCESS;
+    return ATX_InputStream_ReadFully(self->stream, self->data, size);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogBinaryDecoder_ReadRecord
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_LogBinaryDecoder_ReadRecord(ATX_LogBinaryDecoder* self,
+                                ATX_LogRecord*        record)
+{
+    for (;;) {
+        ATX_Byte   type;
+        ATX_Result result;
+
+        /* the end of the stream is expected between entries */
+        result = ATX_InputStream_ReadFully(self->stream, &type, 1);
+        if (ATX_FAILED(result)) return result;
+        switch (type) {
+            case 'A': {
+                unsigned int kind;
+                unsigned int slot;
+
+                /* a new stream starts, its strings are all new */
+                ATX_CHECK(ATX_LogBinaryDecoder_ReadData(self, ATX_LOG_BINARY_MAGIC_SIZE-1));
+                if (!ATX_MemoryEqual(self->data, ATX_LOG_BINARY_MAGIC+1, ATX_LOG_BINARY_MAGIC_SIZE-1)) {
+                    return ATX_ERROR_INVALID_FORMAT;
+                }
+                for (kind = 0; kind < ATX_LOG_BINARY_STRING_KINDS; kind++) {
+                    for (slot = 0; slot < ATX_LOG_BINARY_STRING_SLOTS; slot++) {
+                        ATX_String_Destruct(&self->strings[kind][slot]);
+                    }
+                }
+                break;
+            }
+
+            case 'S': {
+                ATX_Byte     header[7];
+                unsigned int kind;
+                unsigned int id;
+                ATX_UInt32   length;
+                
+                ATX_CHECK(ATX_InputStream_ReadFully(self->stream, header, sizeof(header)));
+                kind   = header[0];
+                id     = ATX_BytesToInt16Be(header+1);
+                length = ATX_BytesToInt32Be(header+3);
+                if (kind >= ATX_LOG_BINARY_STRING_KINDS || id >= ATX_LOG_BINARY_STRING_SLOTS) {
+                    return ATX_ERROR_INVALID_FORMAT;
+                }
+                ATX_CHECK(ATX_LogBinaryDecoder_ReadData(self, length));
+                ATX_CHECK(ATX_String_AssignN(&self->strings[kind][id], (const char*)self->data, length));
+                break;
+            }
+
+            case 'R': {
+                ATX_UInt32 size;
+                ATX_UInt16 logger_id;
+                ATX_UInt16 file_id;
+                ATX_UInt16 function_id;
+                ATX_UInt16 format_id;
+
+                ATX_CHECK(ATX_InputStream_ReadUI32(self->stream, &size));
+                if (size < ATX_LOG_BINARY_RECORD_HEADER_SIZE) return ATX_ERROR_INVALID_FORMAT;
+                ATX_CHECK(ATX_LogBinaryDecoder_ReadData(self, size));
+                logger_id   = ATX_BytesToInt16Be(self->data+16);
+                file_id     = ATX_BytesToInt16Be(self->data+18);
+                function_id = ATX_BytesToInt16Be(self->data+20);
+                format_id   = ATX_BytesToInt16Be(self->data+22);
+                if (logger_id   >= ATX_LOG_BINARY_STRING_SLOTS ||
+                    file_id     >= ATX_LOG_BINARY_STRING_SLOTS ||
+                    function_id >= ATX_LOG_BINARY_STRING_SLOTS ||
+                    format_id   >= ATX_LOG_BINARY_STRING_SLOTS) {
+                    return ATX_ERROR_INVALID_FORMAT;
+                }
+
+                record->level                 = (int)ATX_BytesToInt32Be(self->data);
+                record->timestamp.seconds     = (ATX_Int32)ATX_BytesToInt32Be(self->data+4);
+                record->timestamp.nanoseconds = (ATX_Int32)ATX_BytesToInt32Be(self->data+8);
+                record->source_line           = ATX_BytesToInt32Be(self->data+12);
+                record->logger_name     = ATX_CSTR(self->strings[ATX_LOG_BINARY_STRING_LOGGER_NAME][logger_id]);
+                record->source_file     = ATX_CSTR(self->strings[ATX_LOG_BINARY_STRING_SOURCE_FILE][file_id]);
+                record->source_function = ATX_CSTR(self->strings[ATX_LOG_BINARY_STRING_SOURCE_FUNCTION][function_id]);
+                record->format          = ATX_CSTR(self->strings[ATX_LOG_BINARY_STRING_FORMAT][format_id]);
+                record->arguments       = self->data+ATX_LOG_BINARY_RECORD_HEADER_SIZE;
+                record->arguments_size  = size-ATX_LOG_BINARY_RECORD_HEADER_SIZE;
+                ATX_CHECK(ATX_Log_FormatArguments(record->format,
+                                                  record->arguments,
+                                                  record->arguments_size,
+                                                  &self->message,
+                                                  &self->argument));
+                record->message = ATX_StringBuilder_GetChars(&self->message);
+                return ATX_SUCCESS;
+            }
+
+            default:
+                return ATX_ERROR_INVALID_FORMAT;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler forward references
++---------------------------------------------------------------------*/
+static const ATX_LogHandlerInterface ATX_LogFileHandler_Interface;
+static const ATX_LogHandlerInterface ATX_LogFileHandler_BinaryInterface;
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_Open
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogFileHandler_Open(ATX_LogFileHandler* self, ATX_Boolean append)
+{
+    ATX_File*  file;
+    ATX_Result result;
+
+    self->file_size = 0;
+    ATX_CHECK(ATX_File_Create(ATX_CSTR(self->filename), &file));
+    result = ATX_File_Open(file, 
+                           self->open_mode |
+                           (append?ATX_FILE_OPEN_MODE_APPEND:ATX_FILE_OPEN_MODE_TRUNCATE));
+    if (ATX_SUCCEEDED(result)) {
+        if (append) ATX_File_GetSize(file, &self->file_size);
+        result = ATX_File_GetOutputStream(file, &self->stream);
+        if (ATX_FAILED(result)) {
+            self->stream = NULL;
+        }
+    }
+    ATX_DESTROY_OBJECT(file);
+
+    /* binary files start with a header and define their own strings */
+    if (self->binary) ATX_LogBinaryEncoder_Reset(self->binary);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_Flush
+|
+|   Writes the buffered records with a single call.
++---------------------------------------------------------------------*/
+static void
+ATX_LogFileHandler_Flush(ATX_LogFileHandler* self)
+{
+    ATX_Size size = ATX_StringBuilder_GetLength(&self->buffer);
+
+    if (self->stream && size) {
+        if (ATX_SUCCEEDED(ATX_OutputStream_WriteFully(self->stream,
+                                                      ATX_StringBuilder_GetChars(&self->buffer),
+                                                      size))) {
+            self->file_size += size;
+        }
+
+        /* in sync mode, this is what writes the records to storage */
+        if (self->open_mode & ATX_FILE_OPEN_MODE_SYNC) {
+            ATX_OutputStream_Flush(self->stream);
+        }
+    }
+    ATX_StringBuilder_Reset(&self->buffer);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_GetBackupName
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogFileHandler_GetBackupName(ATX_LogFileHandler* self, 
+                                 ATX_UInt32          index, 
+                                 ATX_String*         name)
+{
+    char suffix[16];
+
+    if (index == 0) return ATX_String_Assign(name, ATX_CSTR(self->filename));
+    suffix[0] = '.';
+    ATX_IntegerToStringU(index, suffix+1, sizeof(suffix)-1);
+    ATX_CHECK(ATX_String_Assign(name, ATX_CSTR(self->filename)));
+    return ATX_String_Append(name, suffix);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_Rotate
+|
+|   Renames <filename> to <filename>.1, <filename>.1 to <filename>.2, 
+|   and so on, removing the oldest, and starts a new file.
++---------------------------------------------------------------------*/
+static void
+ATX_LogFileHandler_Rotate(ATX_LogFileHandler* self, const ATX_TimeStamp* now)
+{
+    ATX_String old_name = ATX_EMPTY_STRING;
+    ATX_String new_name = ATX_EMPTY_STRING;
+    ATX_UInt32 index;
+
+    /* close the current file */
+    ATX_LogFileHandler_Flush(self);
+    ATX_RELEASE_OBJECT(self->stream);
+
+    /* shift the backups */
+    if (self->backups) {
+        if (ATX_SUCCEEDED(ATX_LogFileHandler_GetBackupName(self, self->backups, &old_name))) {
+            ATX_File_Remove(ATX_CSTR(old_name));
+        }
+        for (index = self->backups; index > 0; index--) {
+            if (ATX_SUCCEEDED(ATX_LogFileHandler_GetBackupName(self, index-1, &old_name)) &&
+                ATX_SUCCEEDED(ATX_LogFileHandler_GetBackupName(self, index, &new_name))) {
+                ATX_File_Rename(ATX_CSTR(old_name), ATX_CSTR(new_name));
+            }
+        }
+    }
+    ATX_String_Destruct(&old_name);
+    ATX_String_Destruct(&new_name);
+
+    /* start a new file */
+    ATX_LogFileHandler_Open(self, ATX_FALSE);
+    self->rotate_time.seconds     = now->seconds+(ATX_Int32)self->rotate_interval;
+    self->rotate_time.nanoseconds = now->nanoseconds;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_Write
+|
+|   Adds a record to the buffer, and writes the buffer when it's full or
+|   due. Called with the lock held, if there is one.
++---------------------------------------------------------------------*/
+static void
+ATX_LogFileHandler_Write(ATX_LogFileHandler* self, const ATX_LogRecord* record)
+{
+    ATX_Size buffered = ATX_StringBuilder_GetLength(&self->buffer);
+    ATX_Result          result;
+
+    if (self->stream == NULL) return;
+
+    /* rotate before the record, so that it starts the new file */
+    if ((self->max_size && self->file_size+buffered >= self->max_size) ||
+        (self->rotate_interval && ATX_TimeStamp_IsLaterOrEqual(record->timestamp, self->rotate_time))) {
+        ATX_LogFileHandler_Rotate(self, &record->timestamp);
+        if (self->stream == NULL) return;
+        buffered = 0;
+    }
+
+    /* add the record to the buffer */
+    if (self->binary) {
+        result = ATX_LogBinaryEncoder_EncodeRecord(self->binary, record, &self->buffer);
+    } else {
+        result = ATX_Log_FormatRecord(record, &self->buffer, ATX_FALSE, 0);
+    }
+    if (ATX_FAILED(result)) {
+        /* drop what was added, and start binary records over */
+        self->buffer.length = buffered;
+        if (self->buffer.chars) self->buffer.chars[buffered] = '\0';
+        if (self->binary) ATX_LogBinaryEncoder_Reset(self->binary);
+        return;
+    }
+
+    /* write the buffer when it's full, or when its first record is due */
+    if (buffered == 0) {
+        self->flush_time = record->timestamp;
+        self->flush_time.seconds     += (ATX_Int32)(self->flush_interval/1000);
+        self->flush_time.nanoseconds += (ATX_Int32)(self->flush_interval%1000)*1000000;
+        if (self->flush_time.nanoseconds >= 1000000000) {
+            self->flush_time.seconds++;
+            self->flush_time.nanoseconds -= 1000000000;
+        }
+    }
+    if (ATX_StringBuilder_GetLength(&self->buffer) >= self->buffer_size ||
+        ATX_TimeStamp_IsLaterOrEqual(record->timestamp, self->flush_time)) {
+        ATX_LogFileHandler_Flush(self);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_Log
++---------------------------------------------------------------------*/
+static void
+ATX_LogFileHandler_Log(ATX_LogHandler* _self, const ATX_LogRecord* record)
+{
+    ATX_LogFileHandler* self = (ATX_LogFileHandler*)_self->instance;
+    ATX_Boolean         was_empty;
+
+    if (self->lock == NULL) {
+        ATX_LogFileHandler_Write(self, record);
+        return;
+    }
+
+    ATX_Mutex_Lock(self->lock);
+    was_empty = ATX_StringBuilder_GetLength(&self->buffer) == 0;
+    ATX_LogFileHandler_Write(self, record);
+
+    /* the flusher waits without a timeout while the buffer is empty */
+    if (was_empty && ATX_StringBuilder_GetLength(&self->buffer)) {
+        ATX_Condition_Signal(self->wakeup);
+    }
+    ATX_Mutex_Unlock(self->lock);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_RunFlusher
+|
+|   Writes the buffered records once they are due, so that they reach
+|   the file even when nothing else is logged.
++---------------------------------------------------------------------*/
+static void
+ATX_LogFileHandler_RunFlusher(void* arg)
+{
+    ATX_LogFileHandler* self = (ATX_LogFileHandler*)arg;
+
+    /* records logged by the file streams are dropped */
+    ATX_LogManager_EnterDispatch();
+
+    ATX_Mutex_Lock(self->lock);
+    while (!self->terminating) {
+        ATX_Timeout wait = ATX_TIMEOUT_INFINITE;
+
+        if (ATX_StringBuilder_GetLength(&self->buffer)) {
+            ATX_TimeStamp now;
+            ATX_TimeStamp delay;
+
+            ATX_System_GetCurrentTimeStamp(&now);
+            if (ATX_TimeStamp_IsLaterOrEqual(now, self->flush_time)) {
+                ATX_LogFileHandler_Flush(self);
+                continue;
+            }
+            ATX_TimeStamp_Sub(delay, self->flush_time, now);
+            wait = (ATX_Timeout)(delay.seconds*1000+delay.nanoseconds/1000000)+1;
+        }
+        ATX_Condition_Wait(self->wakeup, self->lock, wait);
+    }
+    ATX_Mutex_Unlock(self->lock);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_StartFlusher
+|
+|   Without a thread, the buffer is only written when a record is
+|   logged after it is due.
++---------------------------------------------------------------------*/
+static void
+ATX_LogFileHandler_StartFlusher(ATX_LogFileHandler* self)
+{
+    if (ATX_SUCCEEDED(ATX_Mutex_Create(&self->lock))) {
+        if (ATX_SUCCEEDED(ATX_Condition_Create(&self->wakeup))) {
+            if (ATX_SUCCEEDED(ATX_Thread_Create(ATX_LogFileHandler_RunFlusher, self, &self->flusher))) {
+                ATX_Thread_SetName(self->flusher, "atx-log-flush");
+                return;
+            }
+            ATX_Condition_Destroy(self->wakeup);
+        }
+        ATX_Mutex_Destroy(self->lock);
+    }
+    self->lock    = NULL;
+    self->wakeup  = NULL;
+    self->flusher = NULL;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_Destroy
++---------------------------------------------------------------------*/
+static void
+ATX_LogFileHandler_Destroy(ATX_LogHandler* _self)
+{
+    ATX_LogFileHandler* self = (ATX_LogFileHandler*)_self->instance;
+
+    /* stop the flusher thread */
+    if (self->flusher) {
+        ATX_Mutex_Lock(self->lock);
+        self->terminating = ATX_TRUE;
+        ATX_Condition_Signal(self->wakeup);
+        ATX_Mutex_Unlock(self->lock);
+        ATX_Thread_Join(self->flusher);
+        ATX_Condition_Destroy(self->wakeup);
+        ATX_Mutex_Destroy(self->lock);
+    }
+
+    /* write what's left and release the stream */
+    ATX_LogFileHandler_Flush(self);
+    ATX_RELEASE_OBJECT(self->stream);
+
+    /* destroy fields */
+    ATX_LogBinaryEncoder_Destroy(self->binary);
+    ATX_StringBuilder_Destruct(&self->buffer);
+    ATX_String_Destruct(&self->filename);
+
+    /* free the object memory */
+    ATX_FreeMemory((void*)self);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_Create
+|
+|   Configuration:
+|   <logger>.FileHandler.filename        name of the log file
+|   <logger>.FileHandler.append          append to an existing file
+|   <logger>.FileHandler.format          text | binary
+|   <logger>.FileHandler.buffer_size     bytes of records written at once,
+|                                        0 to write each record (default)
+|   <logger>.FileHandler.flush_interval  ms before buffered records are
+|                                        written, by a thread of the handler
+|   <logger>.FileHandler.sync            write to storage (fdatasync) after
+|                                        each write of the buffer
+|   <logger>.FileHandler.max_size        rotate when the file reaches this
+|                                        size (bytes, or with K, M, G)
+|   <logger>.FileHandler.rotate_interval rotate after this many seconds
+|   <logger>.FileHandler.backups         rotated files kept, as
+|                                        <filename>.1 to <filename>.<n>
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogFileHandler_Create(const char*     logger_name,
+                          ATX_LogHandler* handler)
+{
+    ATX_LogFileHandler* instance;
+    ATX_String*         property;
+    ATX_Boolean         append = ATX_TRUE;
+    ATX_Result          result = ATX_SUCCESS;
+
+    /* compute a prefix for the configuration of this handler */
+    ATX_String logger_prefix = ATX_String_Create(logger_name);
+    ATX_CHECK(ATX_String_Append(&logger_prefix, ".FileHandler"));
+
+    /* allocate a new object */
+    instance = ATX_AllocateZeroMemory(sizeof(ATX_LogFileHandler));
+    instance->open_mode      = ATX_FILE_OPEN_MODE_CREATE | ATX_FILE_OPEN_MODE_WRITE;
+    instance->flush_interval = ATX_LOG_FILE_HANDLER_DEFAULT_FLUSH_INTERVAL;
+    instance->backups        = ATX_LOG_FILE_HANDLER_DEFAULT_BACKUPS;
+    
+    /* configure the object */
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".filename");
+    if (property) {
+        ATX_String_Assign(&instance->filename, ATX_CSTR(*property));
+    } else if (logger_name[0]) {
+        ATX_String_Assign(&instance->filename, logger_name);
+        ATX_String_Append(&instance->filename, ".log");
+    } else {
+        /* default name for the root logger */
+        ATX_String_Assign(&instance->filename, ATX_CONFIG_DEFAULT_LOG_FILE_HANDLER_FILENAME);
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".append");
+    if (property && ATX_LogManager_ConfigValueIsBooleanFalse(property)) {
+        append = ATX_FALSE;
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".format");
+    if (property && ATX_String_Equals(property, "binary", ATX_TRUE)) {
+        /* binary records are formatted offline by LogDecoder */
+        result = ATX_LogBinaryEncoder_Create(&instance->binary);
+        if (ATX_FAILED(result)) instance->binary = NULL;
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".buffer_size");
+    if (property) {
+        ATX_LargeSize value;
+        if (ATX_SUCCEEDED(ATX_LogManager_ConfigValueToSize(property, &value)) &&
+            value <= ATX_LOG_HEAP_BUFFER_MAX_SIZE*16) {
+            instance->buffer_size = (ATX_Size)value;
+        }
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".flush_interval");
+    if (property) {
+        int value;
+        if (ATX_SUCCEEDED(ATX_String_ToInteger(property, &value, ATX_TRUE)) && value >= 0) {
+            instance->flush_interval = (ATX_UInt32)value;
+        }
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".sync");
+    if (property && ATX_LogManager_ConfigValueIsBooleanTrue(property)) {
+        instance->open_mode |= ATX_FILE_OPEN_MODE_SYNC;
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".max_size");
+    if (property) {
+        ATX_LogManager_ConfigValueToSize(property, &instance->max_size);
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".rotate_interval");
+    if (property) {
+        int value;
+        if (ATX_SUCCEEDED(ATX_String_ToInteger(property, &value, ATX_TRUE)) && value >= 0) {
+            instance->rotate_interval = (ATX_UInt32)value;
+        }
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".backups");
+    if (property) {
+        int value;
+        if (ATX_SUCCEEDED(ATX_String_ToInteger(property, &value, ATX_TRUE)) && 
+            value >= 0 && value <= ATX_LOG_FILE_HANDLER_MAX_BACKUPS) {
+            instance->backups = (ATX_UInt32)value;
+        }
+    }
+
+    /* we buffer the records ourselves, the file doesn't need to */
+    if (instance->buffer_size) {
+        instance->open_mode |= ATX_FILE_OPEN_MODE_UNBUFFERED;
+        ATX_StringBuilder_Reserve(&instance->buffer, instance->buffer_size+ATX_LOG_STACK_BUFFER_MAX_SIZE);
+    }
+
+    /* open the log file */
+    result = ATX_LogFileHandler_Open(instance, append);
+    ATX_System_GetCurrentTimeStamp(&instance->rotate_time);
+    instance->rotate_time.seconds += (ATX_Int32)instance->rotate_interval;
+
+    /* buffered records are written when due, even if nothing follows */
+    if (ATX_SUCCEEDED(result) && instance->buffer_size && instance->flush_interval) {
+        ATX_LogFileHandler_StartFlusher(instance);
+    }
+
+    /* setup the interface */
+    handler->instance = (ATX_LogHandlerInstance*)instance;
+    handler->iface    = instance->binary ? 
+                        &ATX_LogFileHandler_BinaryInterface : 
+                        &ATX_LogFileHandler_Interface;
+
+    /* cleanup */
+    ATX_String_Destruct(&logger_prefix);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_Interface
++---------------------------------------------------------------------*/
+static const ATX_LogHandlerInterface 
+ATX_LogFileHandler_Interface = {
+    ATX_LogFileHandler_Log,
+    ATX_LogFileHandler_Destroy,
+    ATX_LOG_HANDLER_FLAG_SERIALIZED
+};
+
+/*----------------------------------------------------------------------
+|   ATX_LogFileHandler_BinaryInterface
++---------------------------------------------------------------------*/
+static const ATX_LogHandlerInterface 
+ATX_LogFileHandler_BinaryInterface = {
+    ATX_LogFileHandler_Log,
+    ATX_LogFileHandler_Destroy,
+    ATX_LOG_HANDLER_FLAG_SERIALIZED | ATX_LOG_HANDLER_FLAG_BINARY
+};
+
+/*----------------------------------------------------------------------
+|   ATX_Log_FormatCompactFrame
+|
+|   Appends a record as a 4-byte big-endian length followed by the
+|   text form of the record.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_Log_FormatCompactFrame(const ATX_LogRecord* record, ATX_StringBuilder* output)
+{
+    ATX_Size offset = ATX_StringBuilder_GetLength(output);
+    ATX_Byte length[4] = {0, 0, 0, 0};
+
+    ATX_CHECK(ATX_StringBuilder_AppendSubString(output, (const char*)length, sizeof(length)));
+    ATX_CHECK(ATX_Log_FormatRecord(record, output, ATX_FALSE, 0));
+    ATX_BytesFromInt32Be((ATX_Byte*)output->chars+offset,
+                         (ATX_UInt32)(output->length-offset-sizeof(length)));
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Log_ConfigValueToFraming
++---------------------------------------------------------------------*/
+static ATX_LogFraming
+ATX_Log_ConfigValueToFraming(const ATX_String* value)
+{
+    if (value && ATX_String_Equals(value, "compact", ATX_TRUE)) {
+        return ATX_LOG_FRAMING_COMPACT;
+    }
+    return ATX_LOG_FRAMING_HEADERS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogSender_GetWaitTime
+|
+|   Returns 0 when the pending frames can be sent now, or how long to
+|   wait before they can. Called with the lock held.
++---------------------------------------------------------------------*/
+static ATX_Timeout
+ATX_LogSender_GetWaitTime(ATX_LogSender* self)
+{
+    ATX_TimeStamp now;
+    ATX_TimeStamp delay;
+
+    if (ATX_StringBuilder_GetLength(&self->pending) == 0 || self->busy) {
+        return ATX_TIMEOUT_INFINITE;
+    }
+    if (self->connected) return 0;
+    ATX_System_GetCurrentTimeStamp(&now);
+    if (ATX_TimeStamp_IsLaterOrEqual(now, self->retry_time)) return 0;
+    ATX_TimeStamp_Sub(delay, self->retry_time, now);
+
+    return (ATX_Timeout)(delay.seconds*1000+delay.nanoseconds/1000000)+1;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogSender_Truncate
+|
+|   Removes the pending frames from 'offset' on. The frames of a stateful
+|   sender refer to what came before them, so once some are lost, the
+|   next ones start a new stream. Called with the lock held.
++---------------------------------------------------------------------*/
+static void
+ATX_LogSender_Truncate(ATX_LogSender* self, ATX_Size offset)
+{
+    if (self->pending.chars) {
+        self->pending.length = offset;
+        self->pending.chars[offset] = '\0';
+    }
+    if (self->stateful) self->iface->Restart(self->instance);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogSender_SendPending
+|
+|   Connects if needed, then sends all the pending frames as one batch.
+|   Called with the lock held, which is released while the transport
+|   blocks, so that callers only ever wait for a frame to be queued.
+|   When the connection can't be made, the next attempt is delayed
+|   exponentially, and the frames wait in the queue.
++---------------------------------------------------------------------*/
+static void
+ATX_LogSender_SendPending(ATX_LogSender* self)
+{
+    ATX_StringBuilder batch       = self->pending;
+    ATX_UInt32        batch_count = self->pending_count;
+    ATX_Boolean       connected   = self->connected;
+    ATX_Result        result      = ATX_SUCCESS;
+
+    /* take the pending frames, new ones go to the other buffer */
+    self->pending       = self->sending;
+    self->sending       = batch;
+    self->pending_count = 0;
+    self->busy          = ATX_TRUE;
+    ATX_Mutex_Unlock(self->lock);
+
+    if (!connected) {
+        result = self->iface->Connect(self->instance);
+        connected = ATX_SUCCEEDED(result);
+    }
+    if (connected) {
+        result = self->iface->Send(self->instance,
+                                   ATX_StringBuilder_GetChars(&self->sending),
+                                   ATX_StringBuilder_GetLength(&self->sending));
+    }
+
+    ATX_Mutex_Lock(self->lock);
+    self->busy = ATX_FALSE;
+    if (ATX_SUCCEEDED(result)) {
+        self->connected   = ATX_TRUE;
+        self->retry_delay = 0;
+        ATX_StringBuilder_Reset(&self->sending);
+        return;
+    }
+
+    /* the connection failed, or was lost */
+    if (connected) {
+        self->iface->Disconnect(self->instance);
+        if (self->stateful) {
+            /* the rest of the stream can't be understood on a new connection */
+            self->dropped += batch_count+self->pending_count;
+            self->pending_count = 0;
+            batch_count = 0;
+            ATX_StringBuilder_Reset(&self->pending);
+            ATX_StringBuilder_Reset(&self->sending);
+        }
+    }
+    self->connected = ATX_FALSE;
+
+    /* put the batch back in front of the newer frames, if it fits */
+    if (batch_count) {
+        if (ATX_StringBuilder_GetLength(&self->sending)+
+            ATX_StringBuilder_GetLength(&self->pending) <= self->queue_size &&
+            ATX_SUCCEEDED(ATX_StringBuilder_AppendSubString(&self->sending,
+                                                            ATX_StringBuilder_GetChars(&self->pending),
+                                                            ATX_StringBuilder_GetLength(&self->pending)))) {
+            batch               = self->pending;
+            self->pending       = self->sending;
+            self->sending       = batch;
+            self->pending_count += batch_count;
+        } else if (self->stateful) {
+            /* the newer frames can't be decoded without the batch */
+            self->dropped += batch_count+self->pending_count;
+            self->pending_count = 0;
+            ATX_LogSender_Truncate(self, 0);
+        } else {
+            self->dropped += batch_count;
+        }
+        ATX_StringBuilder_Reset(&self->sending);
+    }
+
+    /* wait before trying again */
+    if (self->retry_delay == 0) {
+        self->retry_delay = ATX_LOG_SENDER_MIN_RETRY_DELAY;
+    } else if (self->retry_delay < ATX_LOG_SENDER_MAX_RETRY_DELAY/2) {
+        self->retry_delay *= 2;
+    } else {
+        self->retry_delay = ATX_LOG_SENDER_MAX_RETRY_DELAY;
+    }
+    ATX_System_GetCurrentTimeStamp(&self->retry_time);
+    self->retry_time.seconds     += self->retry_delay/1000;
+    self->retry_time.nanoseconds += (self->retry_delay%1000)*1000000;
+    if (self->retry_time.nanoseconds >= 1000000000) {
+        self->retry_time.seconds++;
+        self->retry_time.nanoseconds -= 1000000000;
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogSender_Run
++---------------------------------------------------------------------*/
+static void
+ATX_LogSender_Run(void* arg)
+{
+    ATX_LogSender* self = (ATX_LogSender*)arg;
+
+    /* records logged by the transport (sockets) are dropped */
+    ATX_LogManager_EnterDispatch();
+
+    ATX_Mutex_Lock(self->lock);
+    for (;;) {
+        ATX_Timeout wait = ATX_LogSender_GetWaitTime(self);
+        if (wait == 0) {
+            ATX_LogSender_SendPending(self);
+        } else if (self->terminating) {
+            /* frames that can't be sent now are dropped */
+            break;
+        } else {
+            ATX_Condition_Wait(self->wakeup, self->lock, wait);
+        }
+    }
+    ATX_Mutex_Unlock(self->lock);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogSender_Queue
+|
+|   Adds a record to the pending frames. When the queue is full, the
+|   record is dropped, and the number of dropped records is reported
+|   in a record of its own once there is room again.
++---------------------------------------------------------------------*/
+static void
+ATX_LogSender_Queue(ATX_LogSender* self, const ATX_LogRecord* record)
+{
+    ATX_Size offset;
+    ATX_Size frame_offset;
+
+    ATX_Mutex_Lock(self->lock);
+    offset = ATX_StringBuilder_GetLength(&self->pending);
+    if (offset >= self->queue_size) {
+        ++self->dropped;
+        ATX_Mutex_Unlock(self->lock);
+        return;
+    }
+
+    if (self->dropped) {
+        ATX_LogRecord report;
+        char          message[64];
+
+        ATX_FormatStringN(message, sizeof(message), "%u log records dropped", (unsigned int)self->dropped);
+        report                 = *record;
+        report.level           = ATX_LOG_LEVEL_WARNING;
+        report.message         = message;
+        report.source_file     = __FILE__;
+        report.source_line     = __LINE__;
+        report.source_function = "ATX_LogSender_Queue";
+        report.format          = NULL;
+        report.arguments       = NULL;
+        report.arguments_size  = 0;
+        if (ATX_SUCCEEDED(self->iface->Frame(self->instance, &report, &self->pending))) {
+            ++self->pending_count;
+            self->dropped = 0;
+        } else {
+            /* remove what was appended of the frame */
+            ATX_LogSender_Truncate(self, offset);
+        }
+    }
+    frame_offset = ATX_StringBuilder_GetLength(&self->pending);
+    if (ATX_SUCCEEDED(self->iface->Frame(self->instance, record, &self->pending))) {
+        ++self->pending_count;
+    } else {
+        ATX_LogSender_Truncate(self, frame_offset);
+    }
+
+    if (self->thread) {
+        /* the sender thread waits without a timeout when idle */
+        if (offset == 0) ATX_Condition_Signal(self->wakeup);
+    } else if (ATX_LogSender_GetWaitTime(self) == 0) {
+        ATX_LogSender_SendPending(self);
+    }
+    ATX_Mutex_Unlock(self->lock);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogSender_Destruct
++---------------------------------------------------------------------*/
+static void
+ATX_LogSender_Destruct(ATX_LogSender* self)
+{
+    /* stop the sender thread, it sends what it can first */
+    if (self->thread) {
+        ATX_Mutex_Lock(self->lock);
+        self->terminating = ATX_TRUE;
+        ATX_Condition_Signal(self->wakeup);
+        ATX_Mutex_Unlock(self->lock);
+        ATX_Thread_Join(self->thread);
+    }
+    if (self->connected) self->iface->Disconnect(self->instance);
+
+    /* destroy fields */
+    ATX_StringBuilder_Destruct(&self->pending);
+    ATX_StringBuilder_Destruct(&self->sending);
+    if (self->wakeup) ATX_Condition_Destroy(self->wakeup);
+    if (self->lock)   ATX_Mutex_Destroy(self->lock);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogSender_Construct
+|
+|   Records are sent from a thread of the sender, or by the callers if
+|   no thread can be created.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogSender_Construct(ATX_LogSender*                self,
+                        void*                         instance,
+                        const ATX_LogSenderInterface* iface,
+                        const ATX_String*             queue_size)
+{
+    self->instance   = instance;
+    self->iface      = iface;
+    self->queue_size = ATX_LOG_SENDER_DEFAULT_QUEUE_SIZE;
+    if (queue_size) {
+        ATX_LargeSize value;
+        if (ATX_SUCCEEDED(ATX_LogManager_ConfigValueToSize(queue_size, &value)) &&
+            value > 0 && value <= ATX_LOG_BINARY_MAX_ENTRY_SIZE) {
+            self->queue_size = (ATX_Size)value;
+        }
+    }
+
+    ATX_CHECK(ATX_Mutex_Create(&self->lock));
+    ATX_CHECK(ATX_Condition_Create(&self->wakeup));
+    if (ATX_SUCCEEDED(ATX_Thread_Create(ATX_LogSender_Run, self, &self->thread))) {
+        ATX_Thread_SetName(self->thread, "atx-log-sender");
+    } else {
+        self->thread = NULL;
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler forward references
++---------------------------------------------------------------------*/
+static const ATX_LogHandlerInterface ATX_LogTcpHandler_Interface;
+static const ATX_LogHandlerInterface ATX_LogTcpHandler_BinaryInterface;
+static const ATX_LogSenderInterface  ATX_LogTcpHandler_SenderInterface;
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_Connect
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogTcpHandler_Connect(void* instance)
+{
+    ATX_LogTcpHandler* self = (ATX_LogTcpHandler*)instance;
+    ATX_Result         result = ATX_SUCCESS;
+
+    /* create a socket */
+    ATX_Socket* tcp_socket = NULL;
+    ATX_CHECK(ATX_TcpClientSocket_Create(&tcp_socket));
+
+    /* connect to the host */
+    result = ATX_Socket_ConnectToHost(tcp_socket, ATX_CSTR(self->host), self->port,
+                                      self->connect_timeout);
+    if (ATX_SUCCEEDED(result)) {
+        /* get the stream */
+        result = ATX_Socket_GetOutputStream(tcp_socket, &self->stream);
+        if (ATX_FAILED(result)) self->stream = NULL;
+    }
+
+    /* cleanup */
+    ATX_DESTROY_OBJECT(tcp_socket);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_Send
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogTcpHandler_Send(void* instance, const char* frames, ATX_Size size)
+{
+    ATX_LogTcpHandler* self = (ATX_LogTcpHandler*)instance;
+
+    /* the whole batch goes out in one write */
+    return ATX_OutputStream_WriteFully(self->stream, frames, size);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_Disconnect
+|
+|   Called with the sender lock held.
++---------------------------------------------------------------------*/
+static void
+ATX_LogTcpHandler_Disconnect(void* instance)
+{
+    ATX_LogTcpHandler* self = (ATX_LogTcpHandler*)instance;
+
+    ATX_RELEASE_OBJECT(self->stream);
+
+    /* the next connection is a new binary stream */
+    if (self->binary) ATX_LogBinaryEncoder_Reset(self->binary);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_Restart
+|
+|   Called with the sender lock held, when binary records were lost.
++---------------------------------------------------------------------*/
+static void
+ATX_LogTcpHandler_Restart(void* instance)
+{
+    ATX_LogTcpHandler* self = (ATX_LogTcpHandler*)instance;
+
+    /* the next record starts with a header and defines its strings */
+    ATX_LogBinaryEncoder_Reset(self->binary);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_FormatRecord
+|
+|   Appends a record with its headers.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogTcpHandler_FormatRecord(const ATX_LogRecord* record,
+                               ATX_StringBuilder*   msg,
+                               ATX_UInt32           sequence_number)
+{
+    const char* level_name = ATX_Log_GetLogLevelName(record->level);
+    char        level_string[16];
+    ATX_Size    message_length = ATX_StringLength(record->message);
+    ATX_Result  result;
+
+    if (level_name[0] == '\0') {
+        ATX_IntegerToString(record->level, level_string, sizeof(level_string));
+        level_name = level_string;
+    }
+
+    /* format the headers in one pass, then append the message */
+    result = ATX_StringBuilder_AppendFormat(msg,
+        "Logger: %s\r\n"
+        "Level: %s\r\n"
+        "Source-File: %s\r\n"
+        "Source-Function: %s\r\n"
+        "Source-Line: %u\r\n"
+        "TimeStamp: %u:%u\r\n"
+        "Sequence-Number: %lu\r\n"
+        "Content-Length: %lu\r\n\r\n",
+        record->logger_name,
+        level_name,
+        record->source_file,
+        record->source_function,
+        record->source_line,
+        (unsigned int)record->timestamp.seconds,
+        (unsigned int)(record->timestamp.nanoseconds/1000000L),
+        (unsigned long)sequence_number,
+        (unsigned long)message_length);
+    if (ATX_FAILED(result)) return result;
+    return ATX_StringBuilder_AppendSubString(msg, record->message, message_length);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_Frame
+|
+|   Called with the sender lock held.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogTcpHandler_Frame(void*                instance,
+                        const ATX_LogRecord* record,
+                        ATX_StringBuilder*   output)
+{
+    ATX_LogTcpHandler* self = (ATX_LogTcpHandler*)instance;
+
+    if (self->binary) {
+        return ATX_LogBinaryEncoder_EncodeRecord(self->binary, record, output);
+    } else if (self->framing == ATX_LOG_FRAMING_COMPACT) {
+        return ATX_Log_FormatCompactFrame(record, output);
+    } else {
+        return ATX_LogTcpHandler_FormatRecord(record, output, self->sequence_number++);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_Log
++---------------------------------------------------------------------*/
+static void
+ATX_LogTcpHandler_Log(ATX_LogHandler* _self, const ATX_LogRecord* record)
+{
+    ATX_LogTcpHandler* self = (ATX_LogTcpHandler*)_self->instance;
+
+    /* the record is sent later, connecting to the host if needed */
+    ATX_LogSender_Queue(&self->sender, record);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_Destroy
++---------------------------------------------------------------------*/
+static void
+ATX_LogTcpHandler_Destroy(ATX_LogHandler* _self)
+{
+    ATX_LogTcpHandler* self = (ATX_LogTcpHandler*)_self->instance;
+
+    /* stop sending, this releases the stream */
+    ATX_LogSender_Destruct(&self->sender);
+
+    /* destroy fields */
+    ATX_String_Destruct(&self->host);
+    ATX_LogBinaryEncoder_Destroy(self->binary);
+
+    /* free the object memory */
+    ATX_FreeMemory((void*)self);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_Create
+|
+|   Configuration:
+|   <logger>.TcpHandler.hostname        host to send the records to
+|   <logger>.TcpHandler.port            port to connect to
+|   <logger>.TcpHandler.format          text | binary
+|   <logger>.TcpHandler.framing         headers | compact (4-byte length
+|                                       and a log line), for text records
+|   <logger>.TcpHandler.queue_size      bytes of records waiting to be
+|                                       sent before new ones are dropped
+|   <logger>.TcpHandler.connect_timeout ms to wait for a connection
+|
+|   Records are queued and sent in batches by a sender thread, so that
+|   callers never wait for the network. When the host can't be reached,
+|   connection attempts are spaced exponentially, up to 30 seconds.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogTcpHandler_Create(const char* logger_name, ATX_LogHandler* handler)
+{
+    ATX_LogTcpHandler* instance;
+    const ATX_String*  property;
+    ATX_Result         result = ATX_SUCCESS;
+
+    /* compute a prefix for the configuration of this handler */
+    ATX_String logger_prefix = ATX_String_Create(logger_name);
+    ATX_CHECK(ATX_String_Append(&logger_prefix, ".TcpHandler"));
+
+    /* allocate a new object */
+    instance = ATX_AllocateZeroMemory(sizeof(ATX_LogTcpHandler));
+    if (instance == NULL) {
+        ATX_String_Destruct(&logger_prefix);
+        return ATX_ERROR_OUT_OF_MEMORY;
+    }
+    instance->port            = ATX_LOG_TCP_HANDLER_DEFAULT_PORT;
+    instance->connect_timeout = ATX_LOG_TCP_HANDLER_DEFAULT_CONNECT_TIMEOUT;
+
+    /* configure the object */
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".hostname");
+    if (property) {
+        ATX_String_Assign(&instance->host, ATX_CSTR(*property));
+    } else {
+        /* default hostname */
+        ATX_String_Assign(&instance->host, "localhost");
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".port");
+    if (property) {
+        int port_int;
+        if (ATX_SUCCEEDED(ATX_String_ToInteger(property, &port_int, ATX_TRUE))) {
+            instance->port = (ATX_UInt16)port_int;
+        }
+    }
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".connect_timeout");
+    if (property) {
+        int value;
+        if (ATX_SUCCEEDED(ATX_String_ToInteger(property, &value, ATX_TRUE)) && value > 0) {
+            instance->connect_timeout = value;
+        }
+    }
+    instance->framing = ATX_Log_ConfigValueToFraming(
+        ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".framing"));
+    {
+        /* format: binary records are formatted offline by LogDecoder */
+        const ATX_String* format = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".format");
+        if (format && ATX_String_Equals(format, "binary", ATX_TRUE)) {
+            result = ATX_LogBinaryEncoder_Create(&instance->binary);
+            if (ATX_FAILED(result)) instance->binary = NULL;
+        }
+    }
+
+    /* setup the interface */
+    handler->instance = (ATX_LogHandlerInstance*)instance;
+    handler->iface    = instance->binary ?
+                        &ATX_LogTcpHandler_BinaryInterface :
+                        &ATX_LogTcpHandler_Interface;
+
+    /* start the sender */
+    if (ATX_SUCCEEDED(result)) {
+        instance->sender.stateful = instance->binary != NULL;
+        result = ATX_LogSender_Construct(&instance->sender,
+                                         instance,
+                                         &ATX_LogTcpHandler_SenderInterface,
+                                         ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".queue_size"));
+    }
+    if (ATX_FAILED(result)) ATX_LogTcpHandler_Destroy(handler);
+
+    /* cleanup */
+    ATX_String_Destruct(&logger_prefix);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_Interface
++---------------------------------------------------------------------*/
+static const ATX_LogHandlerInterface
+ATX_LogTcpHandler_Interface = {
+    ATX_LogTcpHandler_Log,
+    ATX_LogTcpHandler_Destroy,
+    0 /* the sender accepts concurrent callers */
+};
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_BinaryInterface
++---------------------------------------------------------------------*/
+static const ATX_LogHandlerInterface
+ATX_LogTcpHandler_BinaryInterface = {
+    ATX_LogTcpHandler_Log,
+    ATX_LogTcpHandler_Destroy,
+    ATX_LOG_HANDLER_FLAG_BINARY
+};
+
+/*----------------------------------------------------------------------
+|   ATX_LogTcpHandler_SenderInterface
++---------------------------------------------------------------------*/
+static const ATX_LogSenderInterface
+ATX_LogTcpHandler_SenderInterface = {
+    ATX_LogTcpHandler_Frame,
+    ATX_LogTcpHandler_Connect,
+    ATX_LogTcpHandler_Send,
+    ATX_LogTcpHandler_Disconnect,
+    ATX_LogTcpHandler_Restart
+};
+
+/*----------------------------------------------------------------------
+|   ATX_LogTUdpHandler forward references
++---------------------------------------------------------------------*/
+static const ATX_LogHandlerInterface ATX_LogUdpHandler_Interface;
+static const ATX_LogSenderInterface  ATX_LogUdpHandler_SenderInterface;
+
+/*----------------------------------------------------------------------
+|   ATX_LogUdpHandler_Connect
+|
+|   There is no connection, but the host name is resolved here, so that
+|   it is retried like a connection when it fails.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogUdpHandler_Connect(void* instance)
+{
+    ATX_LogUdpHandler* self = (ATX_LogUdpHandler*)instance;
+
+    ATX_SocketAddress  address;
+    unsigned int       i;
+
+    ATX_CHECK(ATX_IpAddress_ResolveName(&address.ip_address,
+                                        ATX_CSTR(self->host),
+                                        ATX_LOG_UDP_HANDLER_DEFAULT_RESOLVER_TIMEOUT));
+    address.port = self->port;
+    for (i=0; i<ATX_ARRAY_SIZE(self->addresses); i++) {
+        self->addresses[i] = address;
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogUdpHandler_GetFrameSize
++---------------------------------------------------------------------*/
+static ATX_Size
+ATX_LogUdpHandler_GetFrameSize(ATX_LogUdpHandler* self, const char* frame)
+{
+    if (self->framing == ATX_LOG_FRAMING_COMPACT) {
+        return 4+ATX_BytesToInt32Be((const ATX_Byte*)frame);
+    }
+
+    /* text frames include their null terminator */
+    return ATX_StringLength(frame)+1;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogUdpHandler_Drop
+|
+|   Counts the frames between offset and end as dropped.
++---------------------------------------------------------------------*/
+static void
+ATX_LogUdpHandler_Drop(ATX_LogUdpHandler* self, 
+                       const char*        frames, 
+                       ATX_Size           offset,
+                       ATX_Size           end)
+{
+    ATX_UInt32 count = 0;
+
+    while (offset < end) {
+        offset += ATX_LogUdpHandler_GetFrameSize(self, frames+offset);
+        ++count;
+    }
+    ATX_Mutex_Lock(self->sender.lock);
+    self->sender.dropped += count;
+    ATX_Mutex_Unlock(self->sender.lock);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogUdpHandler_Send
+|
+|   Packs as many whole frames as fit in each datagram, and sends the
+|   datagrams with as few system calls as possible. A frame larger than
+|   a datagram is sent on its own.
+|
+|   Once some datagrams went out, the batch can't be retried as a whole
+|   without sending them twice, so a failure only drops the rest.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogUdpHandler_Send(void* instance, const char* frames, ATX_Size size)
+{
+    ATX_LogUdpHandler* self = (ATX_LogUdpHandler*)instance;
+    ATX_Size           offset = 0; /* the frames before were sent */
+    ATX_Cardinal       i;
+    ATX_Result         result;
+
+    while (offset < size) {
+        ATX_Size     end   = offset;
+        ATX_Cardinal count = 0;
+        ATX_Cardinal sent  = 0;
+
+        /* cut the next datagrams at frame boundaries */
+        while (end < size && count < ATX_ARRAY_SIZE(self->datagrams)) {
+            ATX_Size start = end;
+            while (end < size) {
+                ATX_Size frame_size = ATX_LogUdpHandler_GetFrameSize(self, frames+end);
+                if (end != start && end-start+frame_size > self->datagram_size) break;
+                end += frame_size;
+            }
+            ATX_DataBuffer_SetBuffer(self->datagrams[count], (ATX_Byte*)frames+start, end-start);
+            ATX_DataBuffer_SetDataSize(self->datagrams[count], end-start);
+            ++count;
+        }
+
+        /* send them, and move past those that were sent */
+        result = ATX_DatagramSocket_SendAll(self->socket,
+                                            self->datagrams,
+                                            self->addresses,
+                                            count,
+                                            &sent);
+        for (i=0; i<sent; i++) {
+            offset += ATX_DataBuffer_GetDataSize(self->datagrams[i]);
+        }
+        if (ATX_FAILED(result)) {
+            /* nothing was sent, the sender keeps the batch for later */
+            if (offset == 0) return result;
+
+            ATX_LogUdpHandler_Drop(self, frames, offset, size);
+            return ATX_SUCCESS;
+        }
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogUdpHandler_Disconnect
++---------------------------------------------------------------------*/
+static void
+ATX_LogUdpHandler_Disconnect(void* instance)
+{
+    /* nothing to close, the name is resolved again on the next attempt */
+    ATX_COMPILER_UNUSED(instance);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogUdpHandler_Frame
+|
+|   Called with the sender lock held.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_LogUdpHandler_Frame(void*                instance,
+                        const ATX_LogRecord* record,
+                        ATX_StringBuilder*   output)
+{
+    ATX_LogUdpHandler* self = (ATX_LogUdpHandler*)instance;
+
+    if (self->framing == ATX_LOG_FRAMING_COMPACT) {
+        return ATX_Log_FormatCompactFrame(record, output);
+    }
+    ATX_CHECK(ATX_LogTcpHandler_FormatRecord(record, output, self->sequence_number++));
+    return ATX_StringBuilder_AppendChar(output, '\0');
+}
+
+/*----------------------------------------------------------------------
+|   ATX_LogUdpHandler_Log
++---------------------------------------------------------------------*/
+static void
+ATX_LogUdpHandler_Log(ATX_LogHandler* _self, const ATX_LogRecord* record)
+{
+    ATX_LogUdpHandler* self = (ATX_LogUdpHandler*)_self->instance;
+
+    /* the record is sent later, with the records queued after it */
+    ATX_LogSender_Queue(&self->sender, record);
+}
 
 /*----------------------------------------------------------------------
-|   ATX_LogFileHandler_Destroy
+|   ATX_LogUdpHandler_Destroy
 +---------------------------------------------------------------------*/
 static void
-ATX_LogFileHandler_Destroy(ATX_LogHandler* _self)
+ATX_LogUdpHandler_Destroy(ATX_LogHandler* _self)
 {
-    ATX_LogFileHandler* self = (ATX_LogFileHandler*)_self->instance;
+    ATX_LogUdpHandler* self = (ATX_LogUdpHandler*)_self->instance;
+    unsigned int       i;
 
-    /* release the stream */
-    ATX_RELEASE_OBJECT(self->stream);
+    /* stop sending */
+    ATX_LogSender_Destruct(&self->sender);
+
+    /* destroy fields */
+    for (i=0; i<ATX_ARRAY_SIZE(self->datagrams); i++) {
+        if (self->datagrams[i]) ATX_DataBuffer_Destroy(self->datagrams[i]);
+    }
+    ATX_DESTROY_OBJECT(self->socket);
+    ATX_String_Destruct(&self->host);
 
     /* free the object memory */
     ATX_FreeMemory((void*)self);
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogFileHandler_Create
+|   ATX_LogUdpHandler_Create
+|
+|   Configuration:
+|   <logger>.UdpHandler.hostname      host to send the records to
+|   <logger>.UdpHandler.port          port to send to
+|   <logger>.UdpHandler.framing       headers (null-terminated) | compact
+|                                     (4-byte length and a log line)
+|   <logger>.UdpHandler.queue_size    bytes of records waiting to be sent
+|                                     before new ones are dropped
+|   <logger>.UdpHandler.datagram_size max size of a datagram holding
+|                                     more than one record
+|
+|   Like with the TcpHandler, records are sent by a sender thread, and
+|   the records queued since the last send are packed in datagrams.
 +---------------------------------------------------------------------*/
 static ATX_Result
-ATX_LogFileHandler_Create(const char*     logger_name,
-                          ATX_LogHandler* handler)
+ATX_LogUdpHandler_Create(const char* logger_name, ATX_LogHandler* handler)
 {
-    ATX_LogFileHandler* instance;
-    const char*         filename;
-    ATX_String          filename_synth = ATX_EMPTY_STRING;
-    ATX_File*           file;
-    ATX_Boolean         append = ATX_TRUE;
-    ATX_Result          result = ATX_SUCCESS;
+    ATX_LogUdpHandler* instance;
+    const ATX_String*  property;
+    unsigned int       i;
+    ATX_Result         result = ATX_SUCCESS;
 
     /* compute a prefix for the configuration of this handler */
     ATX_String logger_prefix = ATX_String_Create(logger_name);
-    ATX_CHECK(ATX_String_Append(&logger_prefix, ".FileHandler"));
+    ATX_CHECK(ATX_String_Append(&logger_prefix, ".UdpHandler"));
 
     /* allocate a new object */
-    instance = ATX_AllocateZeroMemory(sizeof(ATX_LogFileHandler));
-    
+    instance = ATX_AllocateZeroMemory(sizeof(ATX_LogUdpHandler));
+    if (instance == NULL) {
+        ATX_String_Destruct(&logger_prefix);
+        return ATX_ERROR_OUT_OF_MEMORY;
+    }
+    instance->port          = ATX_LOG_UDP_HANDLER_DEFAULT_PORT;
+    instance->datagram_size = ATX_LOG_UDP_HANDLER_DEFAULT_DATAGRAM_SIZE;
+
+    /* setup the interface */
+    handler->instance = (ATX_LogHandlerInstance*)instance;
+    handler->iface    = &ATX_LogUdpHandler_Interface;
+
     /* configure the object */
-    {
-        /* filename */
-        ATX_String* filename_conf = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".filename");
-        if (filename_conf) {
-            filename = ATX_CSTR(*filename_conf);
-        } else if (logger_name[0]) {
-            ATX_String_Reserve(&filename_synth, ATX_StringLength(logger_name));
-            ATX_String_Assign(&filename_synth, logger_name);
-            ATX_String_Append(&filename_synth, ".log");
-            filename = ATX_CSTR(filename_synth);
-        } else {
-            /* default name for the root logger */
-            filename = ATX_CONFIG_DEFAULT_LOG_FILE_HANDLER_FILENAME;
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".hostname");
+    ATX_String_Assign(&instance->host, property ? ATX_CSTR(*property) : "localhost");
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".port");
+    if (property) {
+        int port_int;
+        if (ATX_SUCCEEDED(ATX_String_ToInteger(property, &port_int, ATX_TRUE))) {
+            instance->port = (ATX_UInt16)port_int;
         }
     }
-    {
-        /* append mode */
-        ATX_String* append_mode = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix),".append");
-        if (append_mode && !ATX_LogManager_ConfigValueIsBooleanFalse(append_mode)) {
-            append = ATX_FALSE;
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".datagram_size");
+    if (property) {
+        int value;
+        if (ATX_SUCCEEDED(ATX_String_ToInteger(property, &value, ATX_TRUE)) &&
+            value > 0 && value <= ATX_LOG_UDP_HANDLER_MAX_DATAGRAM_SIZE) {
+            instance->datagram_size = (ATX_Size)value;
         }
-
     }
+    instance->framing = ATX_Log_ConfigValueToFraming(
+        ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".framing"));
 
-    /* open the log file */
-    if (ATX_SUCCEEDED(ATX_File_Create(filename, &file))) {
-        result = ATX_File_Open(file, 
-                               ATX_FILE_OPEN_MODE_CREATE |
-                               ATX_FILE_OPEN_MODE_WRITE  |
-                               (append?ATX_FILE_OPEN_MODE_APPEND:0));
-        if (ATX_SUCCEEDED(result)) {
-            result = ATX_File_GetOutputStream(file, &instance->stream);
-            if (ATX_FAILED(result)) {
-                instance->stream = NULL;
-            }
-        }
-    
-        ATX_DESTROY_OBJECT(file);
+    /* construct fields */
+    result = ATX_UdpSocket_Create(&instance->socket);
+    for (i=0; ATX_SUCCEEDED(result) && i<ATX_ARRAY_SIZE(instance->datagrams); i++) {
+        result = ATX_DataBuffer_Create(0, &instance->datagrams[i]);
     }
 
-    /* setup the interface */
-    handler->instance = (ATX_LogHandlerInstance*)instance;
-    handler->iface    = &ATX_LogFileHandler_Interface;
+    /* start the sender */
+    if (ATX_SUCCEEDED(result)) {
+        result = ATX_LogSender_Construct(&instance->sender,
+                                         instance,
+                                         &ATX_LogUdpHandler_SenderInterface,
+                                         ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".queue_size"));
+    }
+    if (ATX_FAILED(result)) ATX_LogUdpHandler_Destroy(handler);
 
     /* cleanup */
     ATX_String_Destruct(&logger_prefix);
-    ATX_String_Destruct(&filename_synth);
 
     return result;
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogFileHandler_Interface
+|   ATX_LogUdpHandler_Interface
 +---------------------------------------------------------------------*/
-static const ATX_LogHandlerInterface 
-ATX_LogFileHandler_Interface = {
-    ATX_LogFileHandler_Log,
-    ATX_LogFileHandler_Destroy
+static const ATX_LogHandlerInterface
+ATX_LogUdpHandler_Interface = {
+    ATX_LogUdpHandler_Log,
+    ATX_LogUdpHandler_Destroy,
+    0 /* the sender accepts concurrent callers */
 };
 
 /*----------------------------------------------------------------------
-|   ATX_LogTcpHandler forward references
+|   ATX_LogUdpHandler_SenderInterface
 +---------------------------------------------------------------------*/
-static const ATX_LogHandlerInterface ATX_LogTcpHandler_Interface;
+static const ATX_LogSenderInterface
+ATX_LogUdpHandler_SenderInterface = {
+    ATX_LogUdpHandler_Frame,
+    ATX_LogUdpHandler_Connect,
+    ATX_LogUdpHandler_Send,
+    ATX_LogUdpHandler_Disconnect,
+    NULL /* datagrams are independent */
+};
 
 /*----------------------------------------------------------------------
-|   ATX_LogTcpHandler_Connect
+|   ATX_LogAsyncHandler forward references
 +---------------------------------------------------------------------*/
-static ATX_Result
-ATX_LogTcpHandler_Connect(ATX_LogTcpHandler* self)
-{
-    ATX_Result result = ATX_SUCCESS;
+static const ATX_LogHandlerInterface ATX_LogAsyncHandler_Interface;
+static const ATX_LogHandlerInterface ATX_LogAsyncHandler_BinaryInterface;
 
-    /* create a socket */
-    ATX_Socket* tcp_socket = NULL;
-    ATX_CHECK(ATX_TcpClientSocket_Create(&tcp_socket));
-
-    /* connect to the host */
-    result = ATX_Socket_ConnectToHost(tcp_socket, ATX_CSTR(self->host), self->port, 
-                                      ATX_LOG_TCP_HANDLER_DEFAULT_CONNECT_TIMEOUT);
-    if (ATX_SUCCEEDED(result)) {
-        /* get the stream */
-        result = ATX_Socket_GetOutputStream(tcp_socket, &self->stream);
-        if (ATX_FAILED(result)) self->stream = NULL;
+/*----------------------------------------------------------------------
+|   ATX_LogAsyncHandler_Dispatch
++---------------------------------------------------------------------*/
+static void
+ATX_LogAsyncHandler_Dispatch(ATX_LogAsyncHandler* self, const ATX_LogRecord* record)
+{
+    ATX_LogHandlerEntry* entry = self->handlers;
+    while (entry) {
+        entry->handler.iface->Log(&entry->handler, record);
+        entry = entry->next;
     }
-
-    /* cleanup */
-    ATX_DESTROY_OBJECT(tcp_socket);
-
-    return result;
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogTcpHandler_FormatRecord
+|   ATX_LogAsyncHandler_ReportDropped
 +---------------------------------------------------------------------*/
 static void
-ATX_LogTcpHandler_FormatRecord(const ATX_LogRecord* record, 
-                               ATX_String*          msg,
-                               ATX_UInt32           sequence_number)
+ATX_LogAsyncHandler_ReportDropped(ATX_LogAsyncHandler* self)
 {
-    /* format the record */
-    const char* level_name = ATX_Log_GetLogLevelName(record->level);
-    char        level_string[16];
-    char        buffer[64];
-
-    /* format and emit the record */
-    if (level_name[0] == '\0') {
-        ATX_IntegerToString(record->level, level_string, sizeof(level_string));
-        level_name = level_string;
-    }
-    ATX_String_Reserve(msg, 2048);
-    ATX_String_Append(msg, "Logger: ");
-    ATX_String_Append(msg, record->logger_name);
-    ATX_String_Append(msg, "\r\nLevel: ");
-    ATX_String_Append(msg, level_name);
-    ATX_String_Append(msg, "\r\nSource-File: ");
-    ATX_String_Append(msg, record->source_file);
-    ATX_String_Append(msg, "\r\nSource-Function: ");
-    ATX_String_Append(msg, record->source_function);
-    ATX_String_Append(msg, "\r\nSource-Line: ");
-    ATX_IntegerToStringU(record->source_line, buffer, sizeof(buffer));
-    ATX_String_Append(msg, buffer);
-    ATX_String_Append(msg, "\r\nTimeStamp: ");
-    ATX_IntegerToStringU(record->timestamp.seconds, buffer, sizeof(buffer));
-    ATX_String_Append(msg, buffer);
-    ATX_String_Append(msg, ":");
-    ATX_IntegerToStringU(record->timestamp.nanoseconds/1000000L, buffer, sizeof(buffer));
-    ATX_String_Append(msg, buffer);
-    ATX_String_Append(msg, "\r\nSequence-Number: ");
-    ATX_IntegerToStringU(sequence_number, buffer, sizeof(buffer));
-    ATX_String_Append(msg, buffer);
-    ATX_String_Append(msg, "\r\nContent-Length: ");
-    ATX_IntegerToString(ATX_StringLength(record->message), buffer, sizeof(buffer));
-    ATX_String_Append(msg, buffer);    
-    ATX_String_Append(msg, "\r\n\r\n");
-    ATX_String_Append(msg, record->message);
+    ATX_LogRecord record;
+    char          message[64];
+    ATX_Int32     dropped = ATX_AtomicInt_Get(&self->dropped);
+
+    if (dropped == 0) return;
+    ATX_AtomicInt_Add(&self->dropped, -dropped);
+
+    ATX_FormatStringN(message, sizeof(message), "%d log records dropped", (int)dropped);
+    record.logger_name     = ATX_CSTR(self->logger_name);
+    record.level           = ATX_LOG_LEVEL_WARNING;
+    record.message         = message;
+    record.source_file     = __FILE__;
+    record.source_line     = __LINE__;
+    record.source_function = "ATX_LogAsyncHandler_ReportDropped";
+    record.format          = NULL;
+    record.arguments       = NULL;
+    record.arguments_size  = 0;
+    ATX_System_GetCurrentTimeStamp(&record.timestamp);
+    ATX_LogAsyncHandler_Dispatch(self, &record);
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogTcpHandler_Log
+|   ATX_LogAsyncHandler_WakeUpCallers
 +---------------------------------------------------------------------*/
 static void
-ATX_LogTcpHandler_Log(ATX_LogHandler* _self, const ATX_LogRecord* record)
+ATX_LogAsyncHandler_WakeUpCallers(ATX_LogAsyncHandler* self)
 {
-    ATX_LogTcpHandler* self = (ATX_LogTcpHandler*)_self->instance;
-    ATX_String         msg  = ATX_EMPTY_STRING;
-    
-    /* ensure we're connected */
-    if (self->stream == NULL) {
-        if (ATX_FAILED(ATX_LogTcpHandler_Connect(self))) {
-            return;
-        }
+    if (ATX_AtomicInt_Get(&self->callers_waiting)) {
+        ATX_Mutex_Lock(self->lock);
+        ATX_Condition_Broadcast(self->not_full);
+        ATX_Mutex_Unlock(self->lock);
     }
+}
 
-    /* format the record */
-    ATX_LogTcpHandler_FormatRecord(record, &msg, self->sequence_number++);
-    
+/*----------------------------------------------------------------------
+|   ATX_LogAsyncHandler_GetFormat
+|
+|   Returns a copy of the format of a queued record that stays valid
+|   while the format is in use, so that binary handlers see the same
+|   address each time and don't define the format again.
+|   Only called from the writer thread.
++---------------------------------------------------------------------*/
+static const char*
+ATX_LogAsyncHandler_GetFormat(ATX_LogAsyncHandler* self, const ATX_LogAsyncRecord* slot)
+{
+    ATX_LogBinaryString* entry = &self->formats[ATX_LogBinary_GetStringSlot(slot->format)];
 
-    /* emit the formatted record */
-    if (ATX_FAILED(ATX_OutputStream_WriteString(self->stream, ATX_CSTR(msg)))) {
-        ATX_RELEASE_OBJECT(self->stream);
+    if (entry->pointer == slot->format && ATX_StringsEqual(entry->copy, slot->message)) {
+        return entry->copy;
+    }
+    if (entry->copy) ATX_FreeMemory((void*)entry->copy);
+    entry->pointer = slot->format;
+    entry->copy    = ATX_DuplicateString(slot->message);
+    if (entry->copy == NULL) {
+        /* the copy in the slot will do for this record */
+        entry->pointer = NULL;
+        return slot->message;
     }
 
-    ATX_String_Destruct(&msg);
+    return entry->copy;
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogTcpHandler_Destroy
+|   ATX_LogAsyncHandler_Drain
+|
+|   Passes all the queued records to the wrapped handlers, and returns
+|   how many there were. Only called from the writer thread.
 +---------------------------------------------------------------------*/
-static void
-ATX_LogTcpHandler_Destroy(ATX_LogHandler* _self)
+static ATX_Cardinal
+ATX_LogAsyncHandler_Drain(ATX_LogAsyncHandler* self)
 {
-    ATX_LogTcpHandler* self = (ATX_LogTcpHandler*)_self->instance;
+    ATX_Cardinal count = 0;
+
+    for (;;) {
+        ATX_LogAsyncRecord* slot = &self->records[self->head & (self->capacity-1)];
+        ATX_LogRecord       record;
+
+        /* a record is ready when its sequence is one past its position */
+        if ((ATX_UInt32)ATX_AtomicInt_Get(&slot->sequence) != self->head+1) break;
+
+        record.logger_name     = ATX_CSTR(self->logger_name);
+        record.level           = slot->level;
+        record.timestamp       = slot->timestamp;
+        record.source_file     = slot->source_file;
+        record.source_line     = slot->source_line;
+        record.source_function = slot->source_function;
+        if (slot->format) {
+            record.message        = NULL;
+            record.format         = ATX_LogAsyncHandler_GetFormat(self, slot);
+            record.arguments      = (const ATX_Byte*)slot->message+ATX_StringLength(slot->message)+1;
+            record.arguments_size = slot->arguments_size;
+        } else {
+            record.message        = slot->message;
+            record.format         = NULL;
+            record.arguments      = NULL;
+            record.arguments_size = 0;
+        }
+        ATX_LogAsyncHandler_Dispatch(self, &record);
 
-    /* destroy fields */
-    ATX_String_Destruct(&self->host);
+        /* give the slot back for the next round of the ring */
+        ATX_AtomicInt_Set(&slot->sequence, (ATX_Int32)(self->head+self->capacity));
+        ++self->head;
+        ++count;
 
-    /* release the stream */
-    ATX_RELEASE_OBJECT(self->stream);
+        /* wake up callers waiting for space once a batch is free */
+        if ((self->head & ((self->capacity-1)>>3)) == 0) {
+            ATX_LogAsyncHandler_WakeUpCallers(self);
+        }
+    }
+    ATX_LogAsyncHandler_WakeUpCallers(self);
 
-    /* free the object memory */
-    ATX_FreeMemory((void*)self);
+    if (self->overflow != ATX_LOG_ASYNC_OVERFLOW_DROP) {
+        ATX_LogAsyncHandler_ReportDropped(self);
+    }
+
+    return count;
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogTcpHandler_Create
+|   ATX_LogAsyncHandler_Run
 +---------------------------------------------------------------------*/
-static ATX_Result
-ATX_LogTcpHandler_Create(const char* logger_name, ATX_LogHandler* handler)
+static void
+ATX_LogAsyncHandler_Run(void* arg)
 {
-    ATX_LogTcpHandler* instance;
-    const ATX_String*  hostname;
-    const ATX_String*  port;
-    ATX_Result         result = ATX_SUCCESS;
-
-    /* compute a prefix for the configuration of this handler */
-    ATX_String logger_prefix = ATX_String_Create(logger_name);
-    ATX_CHECK(ATX_String_Append(&logger_prefix, ".TcpHandler"));
-
-    /* allocate a new object */
-    instance = ATX_AllocateZeroMemory(sizeof(ATX_LogTcpHandler));
+    ATX_LogAsyncHandler* self = (ATX_LogAsyncHandler*)arg;
+    unsigned int         polls = 0;
+
+    /* records logged by the handlers we call are dropped */
+    ATX_LogManager_EnterDispatch();
+
+    /* let the creator know who we are */
+    ATX_Mutex_Lock(self->lock);
+    self->writer_id = ATX_GetCurrentThreadId();
+    ATX_Condition_Signal(self->not_full);
+    ATX_Mutex_Unlock(self->lock);
+
+    for (;;) {
+        if (ATX_LogAsyncHandler_Drain(self)) polls = 0;
+        if (ATX_AtomicInt_Get(&self->terminating)) break;
+
+        /* records come in bursts: poll for a while before waiting, so */
+        /* that callers don't have to wake us up for each record        */
+        if (polls < ATX_LOG_ASYNC_HANDLER_POLL_COUNT) {
+            ATX_TimeInterval poll_wait = {0, ATX_LOG_ASYNC_HANDLER_POLL_WAIT*1000000};
+            ATX_System_Sleep(&poll_wait);
+            ++polls;
+            continue;
+        }
 
-    /* configure the object */
-    hostname = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".hostname");
-    if (hostname) {
-        ATX_String_Assign(&instance->host, ATX_CSTR(*hostname));
-    } else {
-        /* default hostname */
-        ATX_String_Assign(&instance->host, "localhost");
-    }
-    port = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".port");
-    if (port) {
-        int port_int;
-        if (ATX_SUCCEEDED(ATX_String_ToInteger(port, &port_int, ATX_TRUE))) {
-            instance->port = (ATX_UInt16)port_int;
-        } else {
-            instance->port = ATX_LOG_TCP_HANDLER_DEFAULT_PORT;
+        /* wait for more records, callers signal us when we're waiting */
+        ATX_Mutex_Lock(self->lock);
+        ATX_AtomicInt_Set(&self->writer_waiting, 1);
+        if ((ATX_UInt32)ATX_AtomicInt_Get(&self->records[self->head & (self->capacity-1)].sequence) != self->head+1 &&
+            !ATX_AtomicInt_Get(&self->terminating)) {
+            ATX_Condition_Wait(self->not_empty, self->lock, ATX_LOG_ASYNC_HANDLER_IDLE_WAIT);
         }
-    } else {
-        /* default port */
-        instance->port = ATX_LOG_TCP_HANDLER_DEFAULT_PORT;
+        ATX_AtomicInt_Set(&self->writer_waiting, 0);
+        ATX_Mutex_Unlock(self->lock);
     }
 
-    /* setup the interface */
-    handler->instance = (ATX_LogHandlerInstance*)instance;
-    handler->iface    = &ATX_LogTcpHandler_Interface;
-
-    /* cleanup */
-    ATX_String_Destruct(&logger_prefix);
-
-    return result;
+    /* flush what was queued before we were asked to terminate */
+    ATX_LogAsyncHandler_Drain(self);
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogTcpHandler_Interface
+|   ATX_LogAsyncHandler_WaitForSpace
 +---------------------------------------------------------------------*/
-static const ATX_LogHandlerInterface 
-ATX_LogTcpHandler_Interface = {
-    ATX_LogTcpHandler_Log,
-    ATX_LogTcpHandler_Destroy
-};
+static ATX_Boolean
+ATX_LogAsyncHandler_WaitForSpace(ATX_LogAsyncHandler* self, unsigned int* waited)
+{
+    /* don't wait forever: when the writer is stuck in a wrapped handler */
+    /* (on a blocked socket for example), the record is dropped instead   */
+    /* of blocking the caller too                                         */
+    if (*waited >= ATX_LOG_ASYNC_HANDLER_MAX_BLOCK_TIME) return ATX_FALSE;
+
+    ATX_Mutex_Lock(self->lock);
+    ATX_AtomicInt_Add(&self->callers_waiting, 1);
+    ATX_Condition_Signal(self->not_empty);
+    ATX_Condition_Wait(self->not_full, self->lock, ATX_LOG_ASYNC_HANDLER_BLOCK_WAIT);
+    ATX_AtomicInt_Add(&self->callers_waiting, -1);
+    ATX_Mutex_Unlock(self->lock);
+    *waited += ATX_LOG_ASYNC_HANDLER_BLOCK_WAIT;
+
+    return ATX_TRUE;
+}
 
 /*----------------------------------------------------------------------
-|   ATX_LogTUdpHandler forward references
+|   ATX_LogAsyncHandler_Queue
+|
+|   The records form a bounded multi-producer/single-consumer ring. 
+|   Each slot has a sequence number: a slot at position p is free when
+|   its sequence is p, and holds a record when its sequence is p+1. 
+|   Callers claim a position by advancing the tail with a compare-and-swap,
+|   copy the record into the slot, then publish it by updating the 
+|   sequence. The writer thread consumes records in order from the head.
+|   
+|   The record is queued with its message, or with its format and 
+|   arguments if format_size is not 0.
 +---------------------------------------------------------------------*/
-static const ATX_LogHandlerInterface ATX_LogUdpHandler_Interface;
+static void
+ATX_LogAsyncHandler_Queue(ATX_LogAsyncHandler* self, 
+                          const ATX_LogRecord* record,
+                          const char*          message,
+                          ATX_Size             format_size)
+{
+    ATX_LogAsyncRecord* slot;
+    ATX_UInt32          position;
+    unsigned int        waited = 0;
+
+    /* claim a slot */
+    for (;;) {
+        ATX_Int32 diff;
+        position = (ATX_UInt32)ATX_AtomicInt_Get(&self->tail);
+        slot     = &self->records[position & (self->capacity-1)];
+        diff     = (ATX_Int32)((ATX_UInt32)ATX_AtomicInt_Get(&slot->sequence) - position);
+        if (diff == 0) {
+            if (ATX_AtomicInt_CompareAndSwap(&self->tail, 
+                                             (ATX_Int32)position, 
+                                             (ATX_Int32)(position+1))) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* the ring is full */
+            if (self->overflow != ATX_LOG_ASYNC_OVERFLOW_BLOCK ||
+                !ATX_LogAsyncHandler_WaitForSpace(self, &waited)) {
+                if (self->overflow != ATX_LOG_ASYNC_OVERFLOW_DROP) {
+                    ATX_AtomicInt_Add(&self->dropped, 1);
+                }
+                return;
+            }
+        }
+    }
+
+    /* copy the record, truncating the message if needed */
+    slot->level           = record->level;
+    slot->timestamp       = record->timestamp;
+    slot->source_file     = record->source_file;
+    slot->source_line     = record->source_line;
+    slot->source_function = record->source_function;
+    if (format_size) {
+        slot->format         = record->format;
+        slot->arguments_size = record->arguments_size;
+        ATX_CopyMemory(slot->message, record->format, format_size);
+        ATX_CopyMemory(slot->message+format_size, record->arguments, record->arguments_size);
+    } else {
+        ATX_Size message_length = ATX_StringLength(message);
+        if (message_length >= self->message_size) {
+            message_length = self->message_size-1;
+        }
+        slot->format = NULL;
+        ATX_CopyMemory(slot->message, message, message_length);
+        slot->message[message_length] = '\0';
+    }
+
+    /* publish the record */
+    ATX_AtomicInt_Set(&slot->sequence, (ATX_Int32)(position+1));
+
+    /* wake up the writer if it is waiting */
+    if (ATX_AtomicInt_Get(&self->writer_waiting)) {
+        ATX_Mutex_Lock(self->lock);
+        ATX_Condition_Signal(self->not_empty);
+        ATX_Mutex_Unlock(self->lock);
+    }
+}
 
 /*----------------------------------------------------------------------
-|   ATX_LogUdpHandler_Log
+|   ATX_LogAsyncHandler_Log
+|
+|   When the wrapped handlers all take binary records, callers only copy
+|   the format and the encoded arguments of a record, and encoding and 
+|   writing it is left to the writer thread.
 +---------------------------------------------------------------------*/
 static void
-ATX_LogUdpHandler_Log(ATX_LogHandler* _self, const ATX_LogRecord* record)
+ATX_LogAsyncHandler_Log(ATX_LogHandler* _self, const ATX_LogRecord* record)
 {
-    ATX_LogUdpHandler* self = (ATX_LogUdpHandler*)_self->instance;
-    ATX_DataBuffer*    buffer;
-    
-    /* format the record */
-    ATX_String msg = ATX_EMPTY_STRING;
-    ATX_LogTcpHandler_FormatRecord(record, &msg, self->sequence_number++);
-
-    /* send the record in a datagram */
-    ATX_DataBuffer_Create(0, &buffer);
-    ATX_DataBuffer_SetBuffer(buffer, (void*)ATX_String_UseChars(&msg), ATX_String_GetLength(&msg)+1);
-    ATX_DataBuffer_SetDataSize(buffer, ATX_String_GetLength(&msg)+1);
-    ATX_DatagramSocket_Send(self->socket, buffer, &self->address);
-    
-    /* cleanup */
-    ATX_DataBuffer_Destroy(buffer);
-    ATX_String_Destruct(&msg);
+    ATX_LogAsyncHandler* self = (ATX_LogAsyncHandler*)_self->instance;
+    ATX_StringBuilder    message = ATX_EMPTY_STRING_BUILDER;
+    ATX_String           scratch = ATX_EMPTY_STRING;
+    ATX_Size             format_size = 0;
+
+    /* without a writer thread, call the handlers one caller at a time, */
+    /* as they expect to only ever be called from the writer             */
+    if (self->writer == NULL) {
+        ATX_Mutex_Lock(self->lock);
+        ATX_LogAsyncHandler_Dispatch(self, record);
+        ATX_Mutex_Unlock(self->lock);
+        return;
+    }
+
+    /* records logged by the wrapped handlers themselves are discarded */
+    if (ATX_GetCurrentThreadId() == self->writer_id) return;
+
+    if (self->binary && record->arguments) {
+        format_size = ATX_StringLength(record->format)+1;
+        if (format_size+record->arguments_size > self->message_size) format_size = 0;
+    }
+    if (format_size || record->message) {
+        ATX_LogAsyncHandler_Queue(self, record, record->message, format_size);
+        return;
+    }
+
+    /* the arguments don't fit in a slot, queue the message instead */
+    if (ATX_SUCCEEDED(ATX_Log_FormatArguments(record->format,
+                                              record->arguments,
+                                              record->arguments_size,
+                                              &message,
+                                              &scratch))) {
+        ATX_LogAsyncHandler_Queue(self, record, ATX_StringBuilder_GetChars(&message), 0);
+    }
+    ATX_StringBuilder_Destruct(&message);
+    ATX_String_Destruct(&scratch);
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogUdpHandler_Destroy
+|   ATX_LogAsyncHandler_Destroy
 +---------------------------------------------------------------------*/
 static void
-ATX_LogUdpHandler_Destroy(ATX_LogHandler* _self)
+ATX_LogAsyncHandler_Destroy(ATX_LogHandler* _self)
 {
-    ATX_LogUdpHandler* self = (ATX_LogUdpHandler*)_self->instance;
+    ATX_LogAsyncHandler* self = (ATX_LogAsyncHandler*)_self->instance;
+    unsigned int         i;
+
+    /* stop the writer thread, it flushes the queued records first */
+    if (self->writer) {
+        ATX_AtomicInt_Set(&self->terminating, 1);
+        ATX_Mutex_Lock(self->lock);
+        ATX_Condition_Signal(self->not_empty);
+        ATX_Mutex_Unlock(self->lock);
+        ATX_Thread_Join(self->writer);
+    }
+
+    /* destroy the wrapped handlers */
+    ATX_LogHandlerEntry_DestroyAll(self->handlers);
 
     /* destroy fields */
-    ATX_DESTROY_OBJECT(self->socket);
+    for (i=0; i<ATX_LOG_BINARY_STRING_SLOTS; i++) {
+        if (self->formats[i].copy) ATX_FreeMemory((void*)self->formats[i].copy);
+    }
+    ATX_Condition_Destroy(self->not_full);
+    ATX_Condition_Destroy(self->not_empty);
+    ATX_Mutex_Destroy(self->lock);
+    ATX_FreeMemory((void*)self->text);
+    ATX_FreeMemory((void*)self->records);
+    ATX_String_Destruct(&self->logger_name);
 
     /* free the object memory */
     ATX_FreeMemory((void*)self);
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogUdpHandler_Create
+|   ATX_LogAsyncHandler_Create
+|
+|   Configuration:
+|   <logger>.AsyncHandler.handlers     handlers called by the writer thread
+|   <logger>.AsyncHandler.capacity     number of queued records (power of 2)
+|   <logger>.AsyncHandler.message_size max size of a queued message, or
+|                                      of the format and arguments of a
+|                                      queued binary record
+|   <logger>.AsyncHandler.overflow     drop | block | count-dropped
 +---------------------------------------------------------------------*/
 static ATX_Result
-ATX_LogUdpHandler_Create(const char* logger_name, ATX_LogHandler* handler)
+ATX_LogAsyncHandler_Create(const char* logger_name, ATX_LogHandler* handler)
 {
-    ATX_LogUdpHandler* instance;
-    const ATX_String*  hostname_prop;
-    const char*        hostname = "localhost";
-    const ATX_String*  port_prop;
-    ATX_UInt16         port = ATX_LOG_UDP_HANDLER_DEFAULT_PORT;
-    ATX_Result         result = ATX_SUCCESS;
+    ATX_LogAsyncHandler* instance;
+    ATX_LogHandlerEntry* entry;
+    const ATX_String*    property;
+    ATX_UInt32           capacity = ATX_LOG_ASYNC_HANDLER_DEFAULT_CAPACITY;
+    ATX_UInt32           i;
+    ATX_Result           result = ATX_SUCCESS;
 
     /* compute a prefix for the configuration of this handler */
     ATX_String logger_prefix = ATX_String_Create(logger_name);
-    ATX_CHECK(ATX_String_Append(&logger_prefix, ".UdpHandler"));
+    ATX_CHECK(ATX_String_Append(&logger_prefix, ".AsyncHandler"));
 
     /* allocate a new object */
-    instance = ATX_AllocateZeroMemory(sizeof(ATX_LogUdpHandler));
+    instance = ATX_AllocateZeroMemory(sizeof(ATX_LogAsyncHandler));
+    if (instance == NULL) {
+        ATX_String_Destruct(&logger_prefix);
+        return ATX_ERROR_OUT_OF_MEMORY;
+    }
+    instance->logger_name  = ATX_String_Create(logger_name);
+    instance->message_size = ATX_LOG_ASYNC_HANDLER_DEFAULT_MESSAGE_SIZE;
+    instance->overflow     = ATX_LOG_ASYNC_OVERFLOW_COUNT_DROPPED;
 
     /* setup the interface */
     handler->instance = (ATX_LogHandlerInstance*)instance;
-    handler->iface    = &ATX_LogUdpHandler_Interface;
+    handler->iface    = &ATX_LogAsyncHandler_Interface;
 
-    /* construct fields */
-    result = ATX_UdpSocket_Create(&instance->socket);
-    if (ATX_FAILED(result)) {
-        ATX_String_Destruct(&logger_prefix);
-        ATX_FreeMemory(instance);
-        return result;
-    }
-    
     /* configure the object */
-    hostname_prop = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".hostname");
-    if (hostname_prop) {
-        hostname = ATX_CSTR(*hostname_prop);
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".capacity");
+    if (property) {
+        int value;
+        if (ATX_SUCCEEDED(ATX_String_ToInteger(property, &value, ATX_TRUE)) && 
+            value > 0 && value <= ATX_LOG_ASYNC_HANDLER_MAX_CAPACITY) {
+            capacity = (ATX_UInt32)value;
+        }
     }
-    port_prop = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".port");
-    if (port_prop) {
-        int port_int;
-        if (ATX_SUCCEEDED(ATX_String_ToInteger(port_prop, &port_int, ATX_TRUE))) {
-            port = (ATX_UInt16)port_int;
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".message_size");
+    if (property) {
+        int value;
+        if (ATX_SUCCEEDED(ATX_String_ToInteger(property, &value, ATX_TRUE)) && 
+            value > 1 && value <= ATX_LOG_HEAP_BUFFER_MAX_SIZE) {
+            instance->message_size = (ATX_Size)value;
         }
     }
-    
-    /* resolve the name */
-    result = ATX_IpAddress_ResolveName(&instance->address.ip_address, hostname, ATX_LOG_UDP_HANDLER_DEFAULT_RESOLVER_TIMEOUT);
-    if (ATX_FAILED(result)) {
-        ATX_String_Destruct(&logger_prefix);
-        ATX_LogUdpHandler_Destroy(handler);
-        return result;
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".overflow");
+    if (property) {
+        if (ATX_String_Equals(property, "drop", ATX_TRUE)) {
+            instance->overflow = ATX_LOG_ASYNC_OVERFLOW_DROP;
+        } else if (ATX_String_Equals(property, "block", ATX_TRUE)) {
+            instance->overflow = ATX_LOG_ASYNC_OVERFLOW_BLOCK;
+        } else if (ATX_String_Equals(property, "count-dropped", ATX_TRUE)) {
+            instance->overflow = ATX_LOG_ASYNC_OVERFLOW_COUNT_DROPPED;
+        }
     }
-    instance->address.port = port;
-    
+    property = ATX_LogManager_GetConfigValue(ATX_CSTR(logger_prefix), ".handlers");
+    if (property) {
+        ATX_LogHandlerEntry_CreateAll(&instance->handlers, 
+                                      logger_name, 
+                                      ATX_CSTR(*property), 
+                                      ATX_FALSE);
+    }
+
+    /* queue binary records when all the wrapped handlers take them */
+    instance->binary = instance->handlers ? ATX_TRUE : ATX_FALSE;
+    for (entry = instance->handlers; entry; entry = entry->next) {
+        if (!(entry->handler.iface->flags & ATX_LOG_HANDLER_FLAG_BINARY)) {
+            instance->binary = ATX_FALSE;
+        }
+    }
+    if (instance->binary) handler->iface = &ATX_LogAsyncHandler_BinaryInterface;
+
+    /* round the capacity up to a power of 2 */
+    instance->capacity = 1;
+    while (instance->capacity < capacity) instance->capacity <<= 1;
+
+    /* preallocate the records */
+    instance->records = ATX_AllocateZeroMemory(instance->capacity*sizeof(ATX_LogAsyncRecord));
+    instance->text    = ATX_AllocateMemory(instance->capacity*instance->message_size);
+    if (instance->records == NULL || instance->text == NULL) {
+        result = ATX_ERROR_OUT_OF_MEMORY;
+        goto end;
+    }
+    for (i=0; i<instance->capacity; i++) {
+        ATX_AtomicInt_Set(&instance->records[i].sequence, (ATX_Int32)i);
+        instance->records[i].message = instance->text+i*instance->message_size;
+    }
+
+    /* start the writer thread */
+    result = ATX_Mutex_Create(&instance->lock);
+    if (ATX_FAILED(result)) goto end;
+    result = ATX_Condition_Create(&instance->not_empty);
+    if (ATX_FAILED(result)) goto end;
+    result = ATX_Condition_Create(&instance->not_full);
+    if (ATX_FAILED(result)) goto end;
+    ATX_Mutex_Lock(instance->lock);
+    if (ATX_SUCCEEDED(ATX_Thread_Create(ATX_LogAsyncHandler_Run, instance, &instance->writer))) {
+        ATX_Thread_SetName(instance->writer, "atx-log-writer");
+        /* wait until the writer has recorded its thread id */
+        while (instance->writer_id == (ATX_ThreadId)0) {
+            ATX_Condition_Wait(instance->not_full, instance->lock, ATX_TIMEOUT_INFINITE);
+        }
+    } else {
+        /* no threads, the handlers will be called synchronously */
+        instance->writer = NULL;
+    }
+    ATX_Mutex_Unlock(instance->lock);
+
+end:
+    if (ATX_FAILED(result)) ATX_LogAsyncHandler_Destroy(handler);
+
     /* cleanup */
     ATX_String_Destruct(&logger_prefix);
 
@@ -1588,10 +4299,21 @@ ATX_LogUdpHandler_Create(const char* logger_name, ATX_LogHandler* handler)
 }
 
 /*----------------------------------------------------------------------
-|   ATX_LogUdpHandler_Interface
+|   ATX_LogAsyncHandler_Interface
 +---------------------------------------------------------------------*/
 static const ATX_LogHandlerInterface 
-ATX_LogUdpHandler_Interface = {
-    ATX_LogUdpHandler_Log,
-    ATX_LogUdpHandler_Destroy
+ATX_LogAsyncHandler_Interface = {
+    ATX_LogAsyncHandler_Log,
+    ATX_LogAsyncHandler_Destroy,
+    0 /* the queue accepts concurrent callers */
+};
+
+/*----------------------------------------------------------------------
+|   ATX_LogAsyncHandler_BinaryInterface
++---------------------------------------------------------------------*/
+static const ATX_LogHandlerInterface 
+ATX_LogAsyncHandler_BinaryInterface = {
+    ATX_LogAsyncHandler_Log,
+    ATX_LogAsyncHandler_Destroy,
+    ATX_LOG_HANDLER_FLAG_BINARY
 };
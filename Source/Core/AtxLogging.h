@@ -43,18 +43,30 @@
 #include "AtxTypes.h"
 #include "AtxTime.h"
 #include "AtxString.h"
+#include "AtxAtom.h"
+#include "AtxThreads.h"
+#include "AtxStreams.h"
 
 /*----------------------------------------------------------------------
 |   types
 +---------------------------------------------------------------------*/
+/**
+ * A log record. message is NULL when all the handlers of a logger are
+ * binary handlers and the arguments could be encoded: these handlers
+ * store format and arguments, and the message is formatted when the 
+ * records are decoded.
+ */
 typedef struct {
-    const char*   logger_name;
-    int           level;
-    const char*   message;
-    ATX_TimeStamp timestamp;
-    const char*   source_file;
-    unsigned int  source_line;
-    const char*   source_function;
+    const char*     logger_name;
+    int             level;
+    const char*     message;
+    ATX_TimeStamp   timestamp;
+    const char*     source_file;
+    unsigned int    source_line;
+    const char*     source_function;
+    const char*     format;         /* printf-style format of the message */
+    const ATX_Byte* arguments;      /* encoded arguments, or NULL         */
+    ATX_Size        arguments_size;
 } ATX_LogRecord;
 
 typedef struct ATX_Logger ATX_Logger;
@@ -62,9 +74,17 @@ typedef struct ATX_LogHandlerInstance ATX_LogHandlerInstance;
 typedef struct ATX_LogHandler ATX_LogHandler;
 typedef struct ATX_LogHandlerEntry ATX_LogHandlerEntry;
 
+/**
+ * Handlers are called concurrently from all the threads that log. A
+ * handler that is not thread-safe sets ATX_LOG_HANDLER_FLAG_SERIALIZED
+ * in its interface flags, and its Log method is then called by one
+ * thread at a time. A handler that sets ATX_LOG_HANDLER_FLAG_BINARY 
+ * accepts records that only have encoded arguments (see ATX_LogRecord).
+ */
 typedef struct {
     void (*Log)(ATX_LogHandler* self, const ATX_LogRecord* record);
     void (*Destroy)(ATX_LogHandler* self);
+    ATX_Flags flags;
 } ATX_LogHandlerInterface;
 
 struct ATX_LogHandler {
@@ -74,16 +94,19 @@ struct ATX_LogHandler {
 
 struct ATX_LogHandlerEntry {
     ATX_LogHandler       handler;
+    ATX_Mutex*           lock; /* only for serialized handlers */
     ATX_LogHandlerEntry* next;
 };
 
 struct ATX_Logger {
     ATX_String           name;
+    ATX_Atom             atom; /* interned name */
     int                  level;
     ATX_Boolean          level_is_inherited;
     ATX_Boolean          forward_to_parent;
     ATX_Logger*          parent;
-    ATX_LogHandlerEntry* handlers;
+    ATX_LogHandlerEntry* handlers; /* changed with the log manager locked */
+    ATX_AtomicPointer    chain;    /* snapshot of the handlers used to log */
 };
 
 typedef struct {
@@ -91,6 +114,27 @@ typedef struct {
     const char* name;
 } ATX_LoggerReference;
 
+/**
+ * Reads the records written by binary handlers (FileHandler and 
+ * TcpHandler configured with format=binary).
+ *
+ * A binary stream is a sequence of entries, each starting with a type
+ * byte. Integers are big-endian.
+ *   'A': the stream header, ATX_LOG_BINARY_MAGIC. Starts a new stream,
+ *        so files that were appended to can be decoded.
+ *   'S': a string: kind (1 byte: logger name, source file, source 
+ *        function, message format), id (2), length (4), characters.
+ *        A later string with the same kind and id replaces it.
+ *   'R': a record: size (4), level (4), timestamp seconds (4) and
+ *        nanoseconds (4), source line (4), the ids of the logger name,
+ *        source file, source function and message format (2 each), 
+ *        followed by the encoded arguments of the message.
+ * Each argument starts with a tag: 'i' 32-bit integer, 'l' 64-bit 
+ * integer, 'd' 64-bit IEEE double, 'p' 64-bit pointer value, 
+ * 's' string (length (4) and characters) or 'n' NULL string.
+ */
+typedef struct ATX_LogBinaryDecoder ATX_LogBinaryDecoder;
+
 ATX_Result ATX_GetSystemLogConfig(ATX_String* config);
 
 /*----------------------------------------------------------------------
@@ -107,6 +151,19 @@ ATX_Result ATX_GetSystemLogConfig(ATX_String* config);
 #define ATX_LOG_LEVEL_OFF     32767
 #define ATX_LOG_LEVEL_ALL     0
 
+#define ATX_LOG_HANDLER_FLAG_SERIALIZED 1
+#define ATX_LOG_HANDLER_FLAG_BINARY     2
+
+#define ATX_LOG_BINARY_MAGIC                  "ATXLOG01"
+#define ATX_LOG_BINARY_MAGIC_SIZE             8
+#define ATX_LOG_BINARY_RECORD_HEADER_SIZE     24
+#define ATX_LOG_BINARY_STRING_LOGGER_NAME     0
+#define ATX_LOG_BINARY_STRING_SOURCE_FILE     1
+#define ATX_LOG_BINARY_STRING_SOURCE_FUNCTION 2
+#define ATX_LOG_BINARY_STRING_FORMAT          3
+#define ATX_LOG_BINARY_STRING_KINDS           4
+#define ATX_LOG_BINARY_STRING_SLOTS           256 /* string ids are smaller */
+
 /*----------------------------------------------------------------------
 |   macros
 +---------------------------------------------------------------------*/
@@ -387,6 +444,18 @@ void ATX_Logger_Log(ATX_Logger*  self,
 
 ATX_Result ATX_Logger_AddHandler(ATX_Logger* self, ATX_LogHandler* handler);
 
+ATX_Result ATX_LogBinaryDecoder_Create(ATX_InputStream*       stream, 
+                                       ATX_LogBinaryDecoder** decoder);
+ATX_Result ATX_LogBinaryDecoder_Destroy(ATX_LogBinaryDecoder* self);
+
+/**
+ * Read the next record and format its message. The strings of the 
+ * record remain valid until the next call. Returns ATX_ERROR_EOS at
+ * the end of the stream.
+ */
+ATX_Result ATX_LogBinaryDecoder_ReadRecord(ATX_LogBinaryDecoder* self,
+                                           ATX_LogRecord*        record);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -33,17 +33,25 @@
 |    includes
 +---------------------------------------------------------------------*/
 #include "AtxConfig.h"
+#include "AtxDebug.h"
 #include "AtxTypes.h"
 #include "AtxDefs.h"
 #include "AtxResults.h"
 #include "AtxUtils.h"
 #include "AtxMap.h"
 #include "AtxString.h"
+#include "AtxAllocator.h"
 
 #define _ATX_LIST_FRIEND_INCLUDE_
 #include "AtxList.c"
 #undef _ATX_LIST_FRIEND_INCLUDE_
 
+/*----------------------------------------------------------------------
+|    constants
++---------------------------------------------------------------------*/
+#define ATX_MAP_HASH_TABLE_INITIAL_SIZE 16 /* must be a power of 2   */
+#define ATX_MAP_HASH_MIGRATION_STEP     16 /* slots moved per update */
+
 /*----------------------------------------------------------------------
 |    types
 +---------------------------------------------------------------------*/
@@ -52,17 +60,235 @@ struct ATX_MapEntry {
     ATX_String   key;
 };
 
+/* a slot is empty when entry is NULL, deleted when entry is the marker */
+typedef struct {
+    ATX_UInt32    hash;
+    ATX_MapEntry* entry;
+} ATX_MapSlot;
+
+typedef struct {
+    ATX_MapSlot* slots;
+    ATX_Cardinal size;
+    ATX_Cardinal used;
+    ATX_Cardinal filled;
+} ATX_MapHashTable;
+
 struct ATX_Map {
-    ATX_List entries;
+    ATX_List         entries;
+    ATX_MapIndexType index_type;
+    ATX_MapHashTable table;
+    ATX_MapHashTable migrating; /* previous table, while being resized */
+    ATX_Ordinal      migration_position;
 };
 
+/*----------------------------------------------------------------------
+|    globals
++---------------------------------------------------------------------*/
+static ATX_MapEntry ATX_Map_DeletedEntry;
+#define ATX_MAP_DELETED_ENTRY (&ATX_Map_DeletedEntry)
+
+/*----------------------------------------------------------------------
+|    ATX_Map_HashKey
+|
+|    32-bit FNV-1a hash
++---------------------------------------------------------------------*/
+static ATX_UInt32
+ATX_Map_HashKey(const char* key)
+{
+    ATX_UInt32 hash = 0x811C9DC5;
+    const unsigned char* k = (const unsigned char*)key;
+    while (*k) {
+        hash ^= *k++;
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MapHashTable_Init
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_MapHashTable_Init(ATX_MapHashTable* self, ATX_Cardinal size)
+{
+    self->slots = (ATX_MapSlot*)ATX_AllocateZeroMemory(size*sizeof(ATX_MapSlot));
+    if (self->slots == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    self->size   = size;
+    self->used   = 0;
+    self->filled = 0;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MapHashTable_Destruct
++---------------------------------------------------------------------*/
+static void
+ATX_MapHashTable_Destruct(ATX_MapHashTable* self)
+{
+    if (self->slots) ATX_FreeMemory((void*)self->slots);
+    self->slots  = NULL;
+    self->size   = 0;
+    self->used   = 0;
+    self->filled = 0;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MapHashTable_Find
+|
+|    returns the slot that holds the key, or NULL if not found
++---------------------------------------------------------------------*/
+static ATX_MapSlot*
+ATX_MapHashTable_Find(ATX_MapHashTable* self, const char* key, ATX_UInt32 hash)
+{
+    ATX_Cardinal mask = self->size-1;
+    ATX_Ordinal  i;
+
+    if (self->used == 0) return NULL;
+    for (i = hash&mask;; i = (i+1)&mask) {
+        ATX_MapSlot* slot = &self->slots[i];
+        if (slot->entry == NULL) return NULL;
+        if (slot->hash == hash && 
+            slot->entry != ATX_MAP_DELETED_ENTRY &&
+            ATX_String_Equals(&slot->entry->key, key, ATX_FALSE)) {
+            return slot;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MapHashTable_Insert
+|
+|    the caller must ensure that the key is not already in the table
+|    and that there is at least one empty slot
++---------------------------------------------------------------------*/
+static void
+ATX_MapHashTable_Insert(ATX_MapHashTable* self, ATX_MapEntry* entry, ATX_UInt32 hash)
+{
+    ATX_Cardinal mask = self->size-1;
+    ATX_Ordinal  i;
+
+    for (i = hash&mask;; i = (i+1)&mask) {
+        ATX_MapSlot* slot = &self->slots[i];
+        if (slot->entry == NULL || slot->entry == ATX_MAP_DELETED_ENTRY) {
+            if (slot->entry == NULL) ++self->filled;
+            slot->hash  = hash;
+            slot->entry = entry;
+            ++self->used;
+            return;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------
+|    ATX_MapHashTable_Delete
++---------------------------------------------------------------------*/
+static void
+ATX_MapHashTable_Delete(ATX_MapHashTable* self, ATX_MapSlot* slot)
+{
+    slot->entry = ATX_MAP_DELETED_ENTRY;
+    --self->used;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Map_Migrate
+|
+|    move up to max_slots slots from the table being resized to the
+|    current table, so that the cost of a resize is spread over the
+|    updates that follow it instead of being paid all at once.
++---------------------------------------------------------------------*/
+static void
+ATX_Map_Migrate(ATX_Map* self, ATX_Cardinal max_slots)
+{
+    ATX_MapHashTable* old = &self->migrating;
+    if (old->slots == NULL) return;
+
+    while (max_slots-- && self->migration_position < old->size) {
+        ATX_MapSlot* slot = &old->slots[self->migration_position++];
+        if (slot->entry && slot->entry != ATX_MAP_DELETED_ENTRY) {
+            ATX_MapHashTable_Insert(&self->table, slot->entry, slot->hash);
+            ATX_MapHashTable_Delete(old, slot);
+        }
+    }
+
+    /* release the old table once all its entries have moved */
+    if (old->used == 0) {
+        ATX_MapHashTable_Destruct(old);
+        self->migration_position = 0;
+    }
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Map_ReserveSlot
+|
+|    make sure that one more entry can be inserted in the current table
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_Map_ReserveSlot(ATX_Map* self)
+{
+    ATX_MapHashTable* table = &self->table;
+    ATX_Cardinal      size;
+
+    /* lazy allocation of the table */
+    if (table->slots == NULL) {
+        return ATX_MapHashTable_Init(table, ATX_MAP_HASH_TABLE_INITIAL_SIZE);
+    }
+
+    /* keep the used + deleted slots under 3/4 of the table */
+    if ((table->filled+1)*4 <= table->size*3) {
+        return ATX_SUCCESS;
+    }
+
+    /* a previous resize must complete before we start a new one */
+    ATX_Map_Migrate(self, self->migrating.size);
+
+    /* double the size, unless the load is mostly deleted slots */
+    size = table->size;
+    if (table->used+1 > size/4) size *= 2;
+
+    /* the current table becomes the one we migrate from */
+    self->migrating = *table;
+    self->migration_position = 0;
+    {
+        ATX_Result result = ATX_MapHashTable_Init(table, size);
+        if (ATX_FAILED(result)) {
+            *table = self->migrating;
+            self->migrating.slots = NULL;
+            self->migrating.size = 0;
+            return result;
+        }
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Map_FindSlot
++---------------------------------------------------------------------*/
+static ATX_MapSlot*
+ATX_Map_FindSlot(ATX_Map*           self, 
+                 const char*        key, 
+                 ATX_MapHashTable** table)
+{
+    ATX_UInt32   hash = ATX_Map_HashKey(key);
+    ATX_MapSlot* slot;
+
+    *table = &self->table;
+    slot = ATX_MapHashTable_Find(*table, key, hash);
+    if (slot == NULL && self->migrating.slots) {
+        *table = &self->migrating;
+        slot = ATX_MapHashTable_Find(*table, key, hash);
+    }
+
+    return slot;
+}
+
 /*----------------------------------------------------------------------
 |    ATX_Map_Create
 +---------------------------------------------------------------------*/
 ATX_Result 
 ATX_Map_Create(ATX_Map** map)
 {
-    return ATX_Map_CreateEx(NULL, map);
+    return ATX_Map_CreateIndexed(NULL, ATX_MAP_INDEX_TYPE_HASH, map);
 }
 
 /*----------------------------------------------------------------------
@@ -71,7 +297,29 @@ ATX_Map_Create(ATX_Map** map)
 ATX_Result 
 ATX_Map_CreateEx(const ATX_ListDataDestructor* destructor, ATX_Map** map)
 {
-    return ATX_List_CreateEx(destructor, (ATX_List**)map);
+    return ATX_Map_CreateIndexed(destructor, ATX_MAP_INDEX_TYPE_HASH, map);
+}
+
+/*----------------------------------------------------------------------
+|    ATX_Map_CreateIndexed
++---------------------------------------------------------------------*/
+ATX_Result 
+ATX_Map_CreateIndexed(const ATX_ListDataDestructor* destructor, 
+                      ATX_MapIndexType              index_type,
+                      ATX_Map**                     map)
+{
+    /* allocate memory for the object */
+    *map = (ATX_Map*)ATX_AllocateZeroMemory(sizeof(ATX_Map));
+    if (*map == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* construct the object */
+    if (destructor) {
+        (*map)->entries.destructor = *destructor;
+    }
+    (*map)->entries.item_size = sizeof(ATX_MapEntry);
+    (*map)->index_type = index_type;
+
+    return ATX_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
@@ -80,11 +328,16 @@ ATX_Map_CreateEx(const ATX_ListDataDestructor* destructor, ATX_Map** map)
 ATX_Result
 ATX_Map_Destroy(ATX_Map* self)
 {
+    if (self == NULL) return ATX_SUCCESS;
+
     /* clear all the enties */
     ATX_Map_Clear(self);
+    ATX_List_DestroyItemPool(&self->entries);
 
     /* destroy the object */
-    return ATX_List_Destroy((ATX_List*)self);
+    ATX_FreeMemory((void*)self);
+
+    return ATX_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
@@ -104,7 +357,12 @@ ATX_Map_Clear(ATX_Map* self)
         item = item->next;
     }
 
-    return ATX_List_Clear((ATX_List*)self);
+    /* reset the index */
+    ATX_MapHashTable_Destruct(&self->table);
+    ATX_MapHashTable_Destruct(&self->migrating);
+    self->migration_position = 0;
+
+    return ATX_List_Clear(&self->entries);
 }
 
 /*----------------------------------------------------------------------
@@ -143,8 +401,14 @@ ATX_Map_PutTyped(ATX_Map*          self,
             previous->type   = 0;
         }
 
+        /* make room in the index */
+        if (self->index_type == ATX_MAP_INDEX_TYPE_HASH) {
+            ATX_Map_Migrate(self, ATX_MAP_HASH_MIGRATION_STEP);
+            ATX_CHECK(ATX_Map_ReserveSlot(self));
+        }
+
         /* allocate a new entry */
-        entry = (ATX_MapEntry*)ATX_AllocateMemory(sizeof(ATX_MapEntry));
+        entry = (ATX_MapEntry*)ATX_List_AllocateItem(&self->entries);
         if (entry == NULL) return ATX_ERROR_OUT_OF_MEMORY;
 
         /* partially initialize the entry */
@@ -153,9 +417,15 @@ ATX_Map_PutTyped(ATX_Map*          self,
         /* add the entry to the list */
         result = ATX_List_AddItem(&self->entries, (ATX_ListItem*)entry);
         if (ATX_FAILED(result)) {
-            ATX_FreeMemory((void*)entry);
+            ATX_String_Destruct(&entry->key);
+            ATX_List_FreeItem(&self->entries, &entry->base);
             return result;
         }
+
+        /* index the entry */
+        if (self->index_type == ATX_MAP_INDEX_TYPE_HASH) {
+            ATX_MapHashTable_Insert(&self->table, entry, ATX_Map_HashKey(key));
+        }
     }
 
     /* update/init the entry */
@@ -183,11 +453,17 @@ ATX_Map_Put(ATX_Map*          self,
 ATX_MapEntry* 
 ATX_Map_Get(ATX_Map* self, const char* key)
 {
-    ATX_ListItem* item = self->entries.head;
-    while (item) {
-        ATX_MapEntry* entry = (ATX_MapEntry*)item;
-        if (ATX_String_Equals(&entry->key, key, ATX_FALSE)) return entry;
-        item = item->next;
+    if (self->index_type == ATX_MAP_INDEX_TYPE_HASH) {
+        ATX_MapHashTable* table;
+        ATX_MapSlot*      slot = ATX_Map_FindSlot(self, key, &table);
+        return slot?slot->entry:NULL;
+    } else {
+        ATX_ListItem* item = self->entries.head;
+        while (item) {
+            ATX_MapEntry* entry = (ATX_MapEntry*)item;
+            if (ATX_String_Equals(&entry->key, key, ATX_FALSE)) return entry;
+            item = item->next;
+        }
     }
 
     return NULL;
@@ -199,29 +475,36 @@ ATX_Map_Get(ATX_Map* self, const char* key)
 ATX_Result    
 ATX_Map_Remove(ATX_Map* self, ATX_CString key, ATX_MapEntryInfo* entry_info)
 {
-    ATX_ListItem* item = self->entries.head;
-    while (item) {
-        ATX_MapEntry* entry = (ATX_MapEntry*)item;
-        if (ATX_String_Equals(&entry->key, key, ATX_FALSE)) {
-            if (entry_info) {
-                /* return, but do not destroy the existing entry */
-                entry_info->is_set = ATX_TRUE;
-                entry_info->data   = entry->base.data;
-                entry_info->type   = entry->base.type;
-
-                ATX_String_Destruct(&entry->key);
-                ATX_List_DetachItem(&self->entries, item);
-                ATX_FreeMemory((void*)item);
-            } else {
-                ATX_String_Destruct(&entry->key);
-                ATX_List_RemoveItem((ATX_List*)self, item);
-            }
-            return ATX_SUCCESS;
-        }
-        item = item->next;
+    ATX_MapEntry* entry;
+
+    /* find the entry and remove it from the index */
+    if (self->index_type == ATX_MAP_INDEX_TYPE_HASH) {
+        ATX_MapHashTable* table;
+        ATX_MapSlot*      slot = ATX_Map_FindSlot(self, key, &table);
+        if (slot == NULL) return ATX_ERROR_NO_SUCH_ITEM;
+        entry = slot->entry;
+        ATX_MapHashTable_Delete(table, slot);
+        ATX_Map_Migrate(self, ATX_MAP_HASH_MIGRATION_STEP);
+    } else {
+        entry = ATX_Map_Get(self, key);
+        if (entry == NULL) return ATX_ERROR_NO_SUCH_ITEM;
     }
 
-    return ATX_ERROR_NO_SUCH_ITEM;
+    if (entry_info) {
+        /* return, but do not destroy the existing entry */
+        entry_info->is_set = ATX_TRUE;
+        entry_info->data   = entry->base.data;
+        entry_info->type   = entry->base.type;
+
+        ATX_String_Destruct(&entry->key);
+        ATX_List_DetachItem(&self->entries, &entry->base);
+        ATX_List_FreeItem(&self->entries, &entry->base);
+    } else {
+        ATX_String_Destruct(&entry->key);
+        ATX_List_RemoveItem(&self->entries, &entry->base);
+    }
+
+    return ATX_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
@@ -230,14 +513,16 @@ ATX_Map_Remove(ATX_Map* self, ATX_CString key, ATX_MapEntryInfo* entry_info)
 ATX_Boolean   
 ATX_Map_HasKey(ATX_Map* self, ATX_CString key)
 {
-    ATX_ListItem* item = self->entries.head;
-    while (item) {
-        ATX_MapEntry* entry = (ATX_MapEntry*)item;
-        if (ATX_String_Equals(&entry->key, key, ATX_FALSE)) return ATX_TRUE;
-        item = item->next;
-    }
+    return ATX_Map_Get(self, key) != NULL ? ATX_TRUE : ATX_FALSE;
+}
 
-    return ATX_FALSE;
+/*----------------------------------------------------------------------
+|    ATX_Map_GetEntryCount
++---------------------------------------------------------------------*/
+ATX_Cardinal
+ATX_Map_GetEntryCount(ATX_Map* self)
+{
+    return self->entries.item_count;
 }
 
 /*----------------------------------------------------------------------
@@ -246,7 +531,7 @@ ATX_Map_HasKey(ATX_Map* self, ATX_CString key)
 ATX_List*     
 ATX_Map_AsList(ATX_Map* self)
 {
-    return (ATX_List*)self;
+    return &self->entries;
 }
 
 /*----------------------------------------------------------------------
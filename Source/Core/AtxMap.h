@@ -53,6 +53,19 @@ typedef struct {
     ATX_UInt32  type;
 } ATX_MapEntryInfo;
 
+/**
+ * Lookup index used by a map.
+ * With ATX_MAP_INDEX_TYPE_HASH (the default), keys are located through an
+ * open-addressing hash table, so lookups, insertions and removals take 
+ * constant time on average. ATX_MAP_INDEX_TYPE_LIST does a linear scan of
+ * the entries, which uses less memory for very small maps.
+ * In both cases, ATX_Map_AsList() returns the entries in insertion order.
+ */
+typedef enum {
+    ATX_MAP_INDEX_TYPE_HASH,
+    ATX_MAP_INDEX_TYPE_LIST
+} ATX_MapIndexType;
+
 /*----------------------------------------------------------------------
 |    constants
 +---------------------------------------------------------------------*/
@@ -67,6 +80,9 @@ extern "C" {
 
 ATX_Result    ATX_Map_Create(ATX_Map** map);
 ATX_Result    ATX_Map_CreateEx(const ATX_ListDataDestructor* destructor, ATX_Map** map);
+ATX_Result    ATX_Map_CreateIndexed(const ATX_ListDataDestructor* destructor, 
+                                    ATX_MapIndexType              index_type,
+                                    ATX_Map**                     map);
 ATX_Result    ATX_Map_Destroy(ATX_Map* self);
 ATX_Result    ATX_Map_Clear(ATX_Map* self);
 ATX_Result    ATX_Map_Put(ATX_Map*          self, 
@@ -81,6 +97,7 @@ ATX_Result    ATX_Map_PutTyped(ATX_Map*          self,
 ATX_MapEntry* ATX_Map_Get(ATX_Map* self, const char* key);
 ATX_Result    ATX_Map_Remove(ATX_Map* self, ATX_CString key, ATX_MapEntryInfo* entry_info);
 ATX_Boolean   ATX_Map_HasKey(ATX_Map* self, ATX_CString key);
+ATX_Cardinal  ATX_Map_GetEntryCount(ATX_Map* self);
 ATX_List*     ATX_Map_AsList(ATX_Map* self);
 
 ATX_CString   ATX_MapEntry_GetKey(ATX_MapEntry* self);
@@ -35,6 +35,7 @@
 #include "AtxInterfaces.h"
 #include "AtxTypes.h"
 #include "AtxUtils.h"
+#include "AtxAtom.h"
 #include "AtxResults.h"
 #include "AtxDestroyable.h"
 #include "AtxProperties.h"
@@ -44,6 +45,7 @@
 +---------------------------------------------------------------------*/
 typedef struct PropertyNode {
     ATX_Property         property;
+    ATX_Atom             atom; /* interned name */
     struct PropertyNode* next;
 } PropertyNode;
 
@@ -199,6 +201,10 @@ PropertyNode_Create(ATX_CString              name,
 
     /* construct the node */
     node->next = NULL;
+    if (ATX_FAILED(ATX_Atom_Intern(name, &node->atom))) {
+        ATX_FreeMemory((void*)node);
+        return NULL;
+    }
     node->property.name = ATX_DuplicateString(name);
     if (ATX_FAILED(PropertyNode_SetValue(node, value))) {
         ATX_FreeMemory((void*)node->property.name);
@@ -293,10 +299,14 @@ Properties_FindProperty(Properties* self, ATX_CString name)
 {
     PropertyNode* node; 
 
+    /* property nodes intern their name, so no atom means no property */
+    ATX_Atom atom = ATX_Atom_Find(name);
+    if (atom == NULL) return NULL;
+
     /* find the node with that name */
     node = self->property_nodes;
     while (node) {
-        if (ATX_StringsEqual(node->property.name, name)) {
+        if (node->atom == atom) {
             /* match */
             return node;
         }
@@ -342,12 +352,13 @@ Properties_DeleteProperty(ATX_Properties* _self, ATX_CString name)
     Properties*   self = ATX_SELF(Properties, ATX_Properties);
     PropertyNode* node;
     PropertyNode* prev;
+    ATX_Atom      atom = ATX_Atom_Find(name);
 
     /* find and remove the property */
-    node = self->property_nodes;
+    node = atom ? self->property_nodes : NULL;
     prev = NULL;
     while (node) {
-        if (ATX_StringsEqual(node->property.name, name)) {
+        if (node->atom == atom) {
             /* match */
             if (prev) {
                 prev->next = node->next;
@@ -42,6 +42,7 @@
 #include "AtxDefs.h"
 #include "AtxTypes.h"
 #include "AtxDebug.h"
+#include "AtxThreads.h"
 
 /*----------------------------------------------------------------------
 |   ATX_Referenceable interface
@@ -170,6 +171,57 @@ ATX_BEGIN_INTERFACE_MAP_EX(_class, _base, ATX_Referenceable)              \
     _class##_Release                                                      \
 };         
 
+/**
+ * Same as ATX_IMPLEMENT_REFERENCEABLE_INTERFACE, but for classes whose
+ * references may be added and released concurrently from different
+ * threads. The counter must be an ATX_AtomicInt, initialized with
+ * ATX_AtomicInt_Set(). Classes that are only used from one thread at a
+ * time should keep using the non-atomic version, which is cheaper.
+ */
+#define ATX_IMPLEMENT_ATOMIC_REFERENCEABLE_INTERFACE(_class, _counter) \
+ATX_METHOD _class##_AddReference(ATX_Referenceable* _self)             \
+{                                                                      \
+    _class* self = ATX_SELF(_class, ATX_Referenceable);                \
+    ATX_ATOMIC_INCREMENT(&self->_counter);                             \
+    return ATX_SUCCESS;                                                \
+}                                                                      \
+ATX_METHOD _class##_Release(ATX_Referenceable* _self)                  \
+{                                                                      \
+    _class* self = ATX_SELF(_class, ATX_Referenceable);                \
+    ATX_Int32 count = ATX_ATOMIC_DECREMENT(&self->_counter);           \
+    ATX_ASSERT(count >= 0);                                            \
+    if (count == 0) {                                                  \
+        _class##_Destroy(self);                                        \
+    }                                                                  \
+    return ATX_SUCCESS;                                                \
+}                                                                      \
+ATX_BEGIN_INTERFACE_MAP(_class, ATX_Referenceable)                     \
+    _class##_AddReference,                                             \
+    _class##_Release                                                   \
+};         
+
+#define ATX_IMPLEMENT_ATOMIC_REFERENCEABLE_INTERFACE_EX(_class, _base, _counter) \
+ATX_METHOD _class##_AddReference(ATX_Referenceable* _self)                       \
+{                                                                                \
+    _class* self = ATX_SELF_EX(_class, _base, ATX_Referenceable);                \
+    ATX_ATOMIC_INCREMENT(&ATX_BASE(self, _base)._counter);                       \
+    return ATX_SUCCESS;                                                          \
+}                                                                                \
+ATX_METHOD _class##_Release(ATX_Referenceable* _self)                            \
+{                                                                                \
+    _class* self = ATX_SELF_EX(_class, _base, ATX_Referenceable);                \
+    ATX_Int32 count = ATX_ATOMIC_DECREMENT(&ATX_BASE(self, _base)._counter);     \
+    ATX_ASSERT(count >= 0);                                                      \
+    if (count == 0) {                                                            \
+        _class##_Destroy(self);                                                  \
+    }                                                                            \
+    return ATX_SUCCESS;                                                          \
+}                                                                                \
+ATX_BEGIN_INTERFACE_MAP_EX(_class, _base, ATX_Referenceable)                     \
+    _class##_AddReference,                                                       \
+    _class##_Release                                                             \
+};         
+
 #endif /* _ATX_REFERENCEABLE_H_ */
 
 
@@ -127,6 +127,9 @@
 /* file error codes */
 #define ATX_ERROR_BASE_FILE             (ATX_ERROR_BASE-700)
 
+/* thread error codes */
+#define ATX_ERROR_BASE_THREADS          (ATX_ERROR_BASE-800)
+
 /* standard error codes                                  */
 /* these are special codes to convey an errno            */
 /* the error code is (ATX_ERROR_BASE_ERRNO - errno)      */
@@ -187,3 +187,28 @@ ATX_Socket_ConnectToHost(ATX_Socket* socket,
     return ATX_Socket_Connect(socket, &address, timeout);
 }
 
+/*----------------------------------------------------------------------
+|   ATX_DatagramSocket_SendAll
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_DatagramSocket_SendAll(ATX_DatagramSocket*      self,
+                           ATX_DataBuffer* const*   packets,
+                           const ATX_SocketAddress* addresses,
+                           ATX_Cardinal             count,
+                           ATX_Cardinal*            sent)
+{
+    *sent = 0;
+    while (*sent < count) {
+        ATX_Cardinal done = 0;
+        ATX_Result   result = ATX_DatagramSocket_SendMany(self,
+                                                          packets+*sent,
+                                                          addresses?addresses+*sent:NULL,
+                                                          count-*sent,
+                                                          &done);
+        if (ATX_FAILED(result)) return result;
+        if (done == 0) return ATX_FAILURE;
+        *sent += done;
+    }
+
+    return ATX_SUCCESS;
+}
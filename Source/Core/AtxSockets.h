@@ -57,6 +57,16 @@ typedef struct {
     ATX_SocketAddress remote_address;
 } ATX_SocketInfo;
 
+/**
+ * Native socket descriptor (a file descriptor, or a SOCKET handle on
+ * Windows)
+ */
+typedef ATX_IntPtr ATX_SocketFd;
+
+typedef struct ATX_EventLoop      ATX_EventLoop;
+typedef struct ATX_EventLoopWatch ATX_EventLoopWatch;
+typedef struct ATX_EventLoopTimer ATX_EventLoopTimer;
+
 /*----------------------------------------------------------------------
 |   constants
 +---------------------------------------------------------------------*/
@@ -79,6 +89,10 @@ typedef struct {
 #define ATX_ERROR_NETWORK_UNREACHABLE (ATX_ERROR_BASE_SOCKETS - 14)
 #define ATX_ERROR_WOULD_BLOCK         (ATX_ERROR_BASE_SOCKETS - 15)
 
+#define ATX_EVENT_LOOP_READABLE  0x01
+#define ATX_EVENT_LOOP_WRITABLE  0x02
+#define ATX_EVENT_LOOP_ERROR     0x04 /* always reported, never requested */
+
 /*----------------------------------------------------------------------
 |   functions
 +---------------------------------------------------------------------*/
@@ -162,6 +176,15 @@ ATX_Result ATX_Socket_ConnectToHost(ATX_Socket* self,
 /*----------------------------------------------------------------------
 |   ATX_DatagramSocket
 +---------------------------------------------------------------------*/
+/**
+ * SendMany() and ReceiveMany() move up to 'count' datagrams with as few 
+ * system calls as the platform allows. 'addresses' may be NULL, or 
+ * point to an array of 'count' addresses, one per packet. 
+ * ReceiveMany() waits for the first datagram like Receive() does, and 
+ * then only takes the datagrams that are already queued. Both return 
+ * ATX_SUCCESS as long as at least one datagram was transferred, and 
+ * report how many in 'sent' or 'received'.
+ */
 ATX_DECLARE_INTERFACE(ATX_DatagramSocket)
 ATX_BEGIN_INTERFACE_DEFINITION(ATX_DatagramSocket)
     ATX_Result (*Send)(ATX_DatagramSocket*         self,
@@ -170,6 +193,16 @@ ATX_BEGIN_INTERFACE_DEFINITION(ATX_DatagramSocket)
     ATX_Result (*Receive)(ATX_DatagramSocket*         self,
                           ATX_DataBuffer*             packet, 
                           ATX_SocketAddress*          address);
+    ATX_Result (*SendMany)(ATX_DatagramSocket*         self,
+                           ATX_DataBuffer* const*      packets,
+                           const ATX_SocketAddress*    addresses,
+                           ATX_Cardinal                count,
+                           ATX_Cardinal*               sent);
+    ATX_Result (*ReceiveMany)(ATX_DatagramSocket*         self,
+                              ATX_DataBuffer* const*      packets,
+                              ATX_SocketAddress*          addresses,
+                              ATX_Cardinal                count,
+                              ATX_Cardinal*               received);
 ATX_END_INTERFACE_DEFINITION
 
 /*----------------------------------------------------------------------
@@ -181,6 +214,34 @@ ATX_INTERFACE(object)->Send(object, packet, address)
 #define ATX_DatagramSocket_Receive(object, packet, address) \
 ATX_INTERFACE(object)->Receive(object, packet, address)
 
+#define ATX_DatagramSocket_SendMany(object, packets, addresses, count, sent) \
+ATX_INTERFACE(object)->SendMany(object, packets, addresses, count, sent)
+
+#define ATX_DatagramSocket_ReceiveMany(object, packets, addresses, count, received) \
+ATX_INTERFACE(object)->ReceiveMany(object, packets, addresses, count, received)
+
+/*----------------------------------------------------------------------
+|   functions
++---------------------------------------------------------------------*/
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Same as SendMany(), but after a short send, the datagrams that were
+ * not sent are sent again, until they all are or a call fails. In
+ * that case the error is returned, and 'sent' tells how many datagrams
+ * went out before it.
+ */
+ATX_Result ATX_DatagramSocket_SendAll(ATX_DatagramSocket*      self,
+                                      ATX_DataBuffer* const*   packets,
+                                      const ATX_SocketAddress* addresses,
+                                      ATX_Cardinal             count,
+                                      ATX_Cardinal*            sent);
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 /*----------------------------------------------------------------------
 |   ATX_MulticastSocket
 +---------------------------------------------------------------------*/
@@ -227,6 +288,61 @@ ATX_INTERFACE(object)->Listen(object, max_clients)
 #define ATX_ServerSocket_WaitForNewClient(object, client) \
 ATX_INTERFACE(object)->WaitForNewClient(object, client)
 
+/*----------------------------------------------------------------------
+|   ATX_SelectableSocket
++---------------------------------------------------------------------*/
+/**
+ * Interface implemented by sockets that are backed by a native socket 
+ * descriptor, and can therefore be switched to non-blocking mode and 
+ * watched by an ATX_EventLoop.
+ * In non-blocking mode, WaitForNewClient(), Connect(), Send(), Receive() 
+ * and the Read()/Write() methods of the socket streams return 
+ * ATX_ERROR_WOULD_BLOCK instead of waiting. A non-blocking Connect() 
+ * is completed by calling Connect() again once the socket is writable.
+ * Clients accepted by a non-blocking server socket are non-blocking.
+ */
+ATX_DECLARE_INTERFACE(ATX_SelectableSocket)
+ATX_BEGIN_INTERFACE_DEFINITION(ATX_SelectableSocket)
+    ATX_SocketFd (*GetFd)(ATX_SelectableSocket* self);
+    ATX_Result   (*SetBlocking)(ATX_SelectableSocket* self, 
+                                ATX_Boolean           blocking);
+ATX_END_INTERFACE_DEFINITION
+
+/*----------------------------------------------------------------------
+|   convenience macros
++---------------------------------------------------------------------*/
+#define ATX_SelectableSocket_GetFd(object) \
+ATX_INTERFACE(object)->GetFd(object)
+
+#define ATX_SelectableSocket_SetBlocking(object, blocking) \
+ATX_INTERFACE(object)->SetBlocking(object, blocking)
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop callbacks
++---------------------------------------------------------------------*/
+/**
+ * Called when a watched socket is ready. 'events' is a combination of 
+ * the requested ATX_EVENT_LOOP_READABLE/WRITABLE flags, plus 
+ * ATX_EVENT_LOOP_ERROR if the socket has an error or was hung up, in 
+ * which case it should be removed from the loop.
+ */
+typedef void (*ATX_EventLoopSocketCallback)(ATX_EventLoop*      loop,
+                                            ATX_EventLoopWatch* watch,
+                                            ATX_Flags           events,
+                                            void*               listener);
+
+/**
+ * Called when a timer expires.
+ */
+typedef void (*ATX_EventLoopTimerCallback)(ATX_EventLoop*      loop,
+                                           ATX_EventLoopTimer* timer,
+                                           void*               listener);
+
+/**
+ * Function posted to run on the thread of an event loop.
+ */
+typedef void (*ATX_EventLoopFunction)(ATX_EventLoop* loop, void* arg);
+
 /*----------------------------------------------------------------------
 |   prototypes
 +---------------------------------------------------------------------*/
@@ -238,6 +354,82 @@ extern ATX_Result ATX_TcpClientSocket_Create(ATX_Socket** bsd_socket);
 extern ATX_Result ATX_TcpServerSocket_Create(ATX_ServerSocket** bsd_socket);
 extern ATX_Result ATX_UdpSocket_Create(ATX_DatagramSocket** bsd_socket);
 
+/**
+ * Create an event loop. The loop multiplexes socket readiness with
+ * epoll where available, and poll() or select() elsewhere.
+ * Except where noted, the ATX_EventLoop functions must be called from
+ * the thread that runs the loop, or while the loop is not running.
+ */
+extern ATX_Result ATX_EventLoop_Create(ATX_EventLoop** loop);
+extern ATX_Result ATX_EventLoop_Destroy(ATX_EventLoop* self);
+
+/**
+ * Watch a socket for the given ATX_EVENT_LOOP_XXX events. The socket 
+ * must stay open until the watch is removed, and should be in 
+ * non-blocking mode.
+ */
+extern ATX_Result ATX_EventLoop_AddSocket(ATX_EventLoop*              self,
+                                          ATX_SelectableSocket*       socket,
+                                          ATX_Flags                   events,
+                                          ATX_EventLoopSocketCallback callback,
+                                          void*                       listener,
+                                          ATX_EventLoopWatch**        watch);
+extern ATX_Result ATX_EventLoop_ModifySocket(ATX_EventLoop*      self,
+                                             ATX_EventLoopWatch* watch,
+                                             ATX_Flags           events);
+
+/**
+ * Stop watching a socket and free the watch. This may be called from
+ * any callback, including the callback of the watch being removed.
+ */
+extern ATX_Result ATX_EventLoop_RemoveSocket(ATX_EventLoop*      self,
+                                             ATX_EventLoopWatch* watch);
+
+/**
+ * Add a timer that expires after 'delay' milliseconds, and then every
+ * 'period' milliseconds if 'period' is not 0. A timer stays allocated
+ * after it has expired, until it is removed.
+ */
+extern ATX_Result ATX_EventLoop_AddTimer(ATX_EventLoop*             self,
+                                         ATX_Timeout                delay,
+                                         ATX_Timeout                period,
+                                         ATX_EventLoopTimerCallback callback,
+                                         void*                      listener,
+                                         ATX_EventLoopTimer**       timer);
+extern ATX_Result ATX_EventLoop_RemoveTimer(ATX_EventLoop*      self,
+                                            ATX_EventLoopTimer* timer);
+
+/**
+ * Wait up to 'timeout' milliseconds for events, and dispatch them. 
+ */
+extern ATX_Result ATX_EventLoop_RunOnce(ATX_EventLoop* self, 
+                                        ATX_Timeout    timeout);
+
+/**
+ * Dispatch events until ATX_EventLoop_Stop is called.
+ */
+extern ATX_Result ATX_EventLoop_Run(ATX_EventLoop* self);
+
+/**
+ * Make the current or next call to ATX_EventLoop_Run return.
+ * This function can be called from any thread.
+ */
+extern ATX_Result ATX_EventLoop_Stop(ATX_EventLoop* self);
+
+/**
+ * Interrupt the wait of the loop. 
+ * This function can be called from any thread.
+ */
+extern ATX_Result ATX_EventLoop_WakeUp(ATX_EventLoop* self);
+
+/**
+ * Run a function on the thread of the loop, in the order the functions
+ * were posted. This function can be called from any thread.
+ */
+extern ATX_Result ATX_EventLoop_Post(ATX_EventLoop*        self,
+                                     ATX_EventLoopFunction function,
+                                     void*                 arg);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -56,10 +56,32 @@ typedef struct {
     ATX_Position           position;
 } ATX_SubInputStream;
 
+struct ATX_BufferedInputStream {
+    /* interfaces */
+    ATX_IMPLEMENTS(ATX_InputStream);
+    ATX_IMPLEMENTS(ATX_Referenceable);
+
+    /* members */
+    ATX_Cardinal     reference_count;
+    ATX_InputStream* source;
+    ATX_Byte*        buffer;
+    ATX_Size         buffer_size;
+    ATX_Size         read_offset;
+    ATX_Size         valid;
+    ATX_Position     position;
+};
+
 /*----------------------------------------------------------------------
 |   constants
 +---------------------------------------------------------------------*/
 #define ATX_INPUT_STREAM_LOAD_DEFAULT_READ_CHUNK 4096
+#define ATX_INPUT_STREAM_SKIP_BUFFER_SIZE        4096
+
+/*----------------------------------------------------------------------
+|   forward declarations
++---------------------------------------------------------------------*/
+ATX_DECLARE_INTERFACE_MAP(ATX_BufferedInputStream, ATX_InputStream)
+ATX_DECLARE_INTERFACE_MAP(ATX_BufferedInputStream, ATX_Referenceable)
 
 /*----------------------------------------------------------------------
 |   ATX_InputStream_ReadLine
@@ -73,6 +95,13 @@ ATX_InputStream_ReadLine(ATX_InputStream* self,
     ATX_Result result;
     ATX_Size   total = 0;
 
+    /* buffered streams can scan their buffer directly */
+    if (ATX_INTERFACE(self) == &ATX_BufferedInputStream_ATX_InputStreamInterface) {
+        return ATX_BufferedInputStream_ReadLine(
+            ATX_SELF_O(self, ATX_BufferedInputStream, ATX_InputStream),
+            buffer, size, chars_read);
+    }
+
     /* check parameters */
     if (buffer == NULL || size < 1) {
         return ATX_ERROR_INVALID_PARAMETERS;
@@ -125,6 +154,13 @@ ATX_InputStream_ReadLineString(ATX_InputStream* self,
 {
     ATX_Result result;
 
+    /* buffered streams can scan their buffer directly */
+    if (ATX_INTERFACE(self) == &ATX_BufferedInputStream_ATX_InputStreamInterface) {
+        return ATX_BufferedInputStream_ReadLineString(
+            ATX_SELF_O(self, ATX_BufferedInputStream, ATX_InputStream),
+            string, max_length);
+    }
+
     /* reset the string */
     ATX_String_SetLength(string, 0);
 
@@ -246,15 +282,30 @@ ATX_InputStream_ReadFully(ATX_InputStream* self,
 ATX_Result
 ATX_InputStream_Skip(ATX_InputStream* self, ATX_Size count)
 {
+    ATX_Byte     buffer[ATX_INPUT_STREAM_SKIP_BUFFER_SIZE];
     ATX_Position position;
     ATX_Result   result;
 
-    /* get the current location */
+    /* get the current location and seek ahead */
     result = ATX_InputStream_Tell(self, &position);
-    if (ATX_FAILED(result)) return result;
-    
-    /* seek ahead */
-    return ATX_InputStream_Seek(self, position+count);
+    if (ATX_SUCCEEDED(result)) {
+        result = ATX_InputStream_Seek(self, position+count);
+        if (ATX_SUCCEEDED(result)) return ATX_SUCCESS;
+    }
+
+    /* the stream can't seek, read and discard the data */
+    while (count) {
+        ATX_Size bytes_read;
+        result = ATX_InputStream_Read(self, 
+                                      buffer, 
+                                      count < sizeof(buffer) ? count : sizeof(buffer),
+                                      &bytes_read);
+        if (ATX_FAILED(result)) return result;
+        if (bytes_read == 0) return ATX_ERROR_INTERNAL;
+        count -= bytes_read;
+    }
+
+    return ATX_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
@@ -387,6 +438,57 @@ ATX_OutputStream_WriteLine(ATX_OutputStream* self, ATX_CString string)
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|   ATX_Stream_Copy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Stream_Copy(ATX_InputStream*  input,
+                ATX_OutputStream* output,
+                ATX_LargeSize     size,
+                ATX_LargeSize*    bytes_copied)
+{
+    ATX_StreamTransfer* transfer = ATX_CAST(output, ATX_StreamTransfer);
+    ATX_LargeSize       total = 0;
+    ATX_Byte*           buffer;
+    ATX_Result          result = ATX_SUCCESS;
+
+    if (bytes_copied) *bytes_copied = 0;
+
+    /* let the output pull the data directly if it can */
+    if (transfer) {
+        result = ATX_StreamTransfer_TransferFrom(transfer, input, size, &total);
+        if (result != ATX_ERROR_NOT_SUPPORTED) {
+            if (bytes_copied) *bytes_copied = total;
+            return result;
+        }
+        result = ATX_SUCCESS;
+    }
+
+    /* copy through a buffer */
+    buffer = (ATX_Byte*)ATX_AllocateMemory(ATX_STREAM_COPY_BUFFER_SIZE);
+    if (buffer == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    while (size == 0 || total < size) {
+        ATX_Size bytes_to_read = ATX_STREAM_COPY_BUFFER_SIZE;
+        ATX_Size bytes_read    = 0;
+        if (size && size-total < bytes_to_read) {
+            bytes_to_read = (ATX_Size)(size-total);
+        }
+        result = ATX_InputStream_Read(input, buffer, bytes_to_read, &bytes_read);
+        if (result == ATX_ERROR_EOS) {
+            result = ATX_SUCCESS;
+            break;
+        }
+        if (ATX_FAILED(result)) break;
+        result = ATX_OutputStream_WriteFully(output, buffer, bytes_read);
+        if (ATX_FAILED(result)) break;
+        total += bytes_read;
+    }
+    ATX_FreeMemory(buffer);
+
+    if (bytes_copied) *bytes_copied = total;
+    return result;
+}
+
 /*----------------------------------------------------------------------
 |   forward declarations
 +---------------------------------------------------------------------*/
@@ -586,7 +688,7 @@ ATX_SubInputStream_GetAvailable(ATX_InputStream* _self,
     ATX_Result          result;
 
     /* compute the max possible value */
-    max_possible = self->size - self->offset;
+    max_possible = self->size - self->position;
 
     /* see how many bytes are available from the parent */
     result = ATX_InputStream_GetAvailable(self->parent,
@@ -964,3 +1066,474 @@ ATX_BEGIN_INTERFACE_MAP(ATX_MemoryStream, ATX_Referenceable)
     ATX_MemoryStream_AddReference,
     ATX_MemoryStream_Release
 };
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_BufferedInputStream_Create(ATX_InputStream*          source,
+                               ATX_Size                  buffer_size,
+                               ATX_BufferedInputStream** stream)
+{
+    /* default values */
+    *stream = NULL;
+    if (source == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+    if (buffer_size == 0) buffer_size = ATX_BUFFERED_INPUT_STREAM_DEFAULT_BUFFER_SIZE;
+
+    /* allocate the object */
+    *stream = ATX_AllocateZeroMemory(sizeof(ATX_BufferedInputStream));
+    if (*stream == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    (*stream)->buffer = ATX_AllocateMemory(buffer_size);
+    if ((*stream)->buffer == NULL) {
+        ATX_FreeMemory((void*)*stream);
+        *stream = NULL;
+        return ATX_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* construct the object */
+    (*stream)->reference_count = 1;
+    (*stream)->source          = source;
+    (*stream)->buffer_size     = buffer_size;
+    ATX_InputStream_Tell(source, &(*stream)->position);
+
+    /* keep a reference to the source stream */
+    ATX_REFERENCE_OBJECT(source);
+
+    /* setup the interfaces */
+    ATX_SET_INTERFACE(*stream, ATX_BufferedInputStream, ATX_InputStream);
+    ATX_SET_INTERFACE(*stream, ATX_BufferedInputStream, ATX_Referenceable);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Destruct
++---------------------------------------------------------------------*/
+static void
+ATX_BufferedInputStream_Destruct(ATX_BufferedInputStream* self)
+{
+    ATX_RELEASE_OBJECT(self->source);
+    ATX_FreeMemory((void*)self->buffer);
+    ATX_FreeMemory((void*)self);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_AddReference
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_BufferedInputStream_AddReference(ATX_Referenceable* _self)
+{
+    ATX_BufferedInputStream* self = ATX_SELF(ATX_BufferedInputStream, ATX_Referenceable);
+    ++self->reference_count;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Release
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_BufferedInputStream_Release(ATX_Referenceable* _self)
+{
+    ATX_BufferedInputStream* self = ATX_SELF(ATX_BufferedInputStream, ATX_Referenceable);
+    if (--self->reference_count == 0) {
+        ATX_BufferedInputStream_Destruct(self);
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_BufferedInputStream_Destroy(ATX_BufferedInputStream* self)
+{
+    if (self == NULL) return ATX_SUCCESS;
+    return ATX_BufferedInputStream_Release(&ATX_BASE(self, ATX_Referenceable));
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_GetInputStream
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_BufferedInputStream_GetInputStream(ATX_BufferedInputStream* self,
+                                       ATX_InputStream**        stream)
+{
+    ++self->reference_count;
+    *stream = &ATX_BASE(self, ATX_InputStream);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Fill
+|
+|   Refills the buffer with a single read from the source. Must only be
+|   called when the buffer is empty.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_BufferedInputStream_Fill(ATX_BufferedInputStream* self)
+{
+    ATX_Size   bytes_read = 0;
+    ATX_Result result;
+
+    ATX_ASSERT(self->read_offset == self->valid);
+    self->read_offset = 0;
+    self->valid       = 0;
+    result = ATX_InputStream_Read(self->source, 
+                                  self->buffer, 
+                                  self->buffer_size, 
+                                  &bytes_read);
+    if (ATX_FAILED(result)) return result;
+    if (bytes_read == 0) return ATX_ERROR_EOS;
+    self->valid = bytes_read;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Consume
++---------------------------------------------------------------------*/
+static void
+ATX_BufferedInputStream_Consume(ATX_BufferedInputStream* self, ATX_Size count)
+{
+    ATX_ASSERT(self->read_offset+count <= self->valid);
+    self->read_offset += count;
+    self->position    += count;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Peek
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_BufferedInputStream_Peek(ATX_BufferedInputStream* self,
+                             ATX_Any                  buffer,
+                             ATX_Size                 bytes_to_peek,
+                             ATX_Size*                bytes_peeked)
+{
+    ATX_Size available;
+
+    if (bytes_peeked) *bytes_peeked = 0;
+    if (bytes_to_peek == 0) return ATX_SUCCESS;
+
+    /* make sure we have something buffered */
+    if (self->read_offset == self->valid) {
+        ATX_CHECK(ATX_BufferedInputStream_Fill(self));
+    }
+
+    available = self->valid-self->read_offset;
+    if (bytes_to_peek > available) bytes_to_peek = available;
+    ATX_CopyMemory(buffer, self->buffer+self->read_offset, bytes_to_peek);
+    if (bytes_peeked) *bytes_peeked = bytes_to_peek;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Unread
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_BufferedInputStream_Unread(ATX_BufferedInputStream* self,
+                               ATX_AnyConst             data,
+                               ATX_Size                 size)
+{
+    ATX_Size available = self->valid-self->read_offset;
+
+    if (size == 0) return ATX_SUCCESS;
+
+    if (size <= self->read_offset) {
+        /* there is room in front of the buffered data */
+        self->read_offset -= size;
+        ATX_MoveMemory(self->buffer+self->read_offset, data, size);
+    } else {
+        /* move the buffered data up, growing the buffer if needed */
+        if (size+available > self->buffer_size) {
+            ATX_Byte* buffer = ATX_AllocateMemory(size+available);
+            if (buffer == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+            ATX_CopyMemory(buffer+size, self->buffer+self->read_offset, available);
+            ATX_FreeMemory((void*)self->buffer);
+            self->buffer      = buffer;
+            self->buffer_size = size+available;
+        } else {
+            ATX_MoveMemory(self->buffer+size, self->buffer+self->read_offset, available);
+        }
+        ATX_CopyMemory(self->buffer, data, size);
+        self->read_offset = 0;
+        self->valid       = size+available;
+    }
+    self->position = size <= self->position ? self->position-size : 0;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_RemoveCarriageReturns
+|
+|   Removes the '\r' characters from a chunk, in place, and returns the
+|   new size of the chunk.
++---------------------------------------------------------------------*/
+static ATX_Size
+ATX_BufferedInputStream_RemoveCarriageReturns(char* chunk, ATX_Size size)
+{
+    char*       out = ATX_FindByte(chunk, '\r', size);
+    const char* in;
+    const char* end = chunk+size;
+
+    if (out == NULL) return size;
+    for (in = out; in != end; ++in) {
+        if (*in != '\r') *out++ = *in;
+    }
+    return (ATX_Size)(out-chunk);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_ReadLine
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_BufferedInputStream_ReadLine(ATX_BufferedInputStream* self,
+                                 char*                    line,
+                                 ATX_Size                 line_size,
+                                 ATX_Size*                chars_read)
+{
+    ATX_Size total = 0;
+
+    /* check parameters */
+    if (line == NULL || line_size < 1) {
+        return ATX_ERROR_INVALID_PARAMETERS;
+    }
+
+    /* copy chunks until we find a newline or run out of space */
+    while (total < line_size-1) {
+        const ATX_Byte* start;
+        const ATX_Byte* newline;
+        ATX_Size        chunk;
+        ATX_Size        room = line_size-1-total;
+
+        /* refill if needed */
+        if (self->read_offset == self->valid) {
+            ATX_Result result = ATX_BufferedInputStream_Fill(self);
+            if (ATX_FAILED(result)) {
+                line[total] = '\0';
+                if (chars_read) *chars_read = total;
+                if (result == ATX_ERROR_EOS && total != 0) return ATX_SUCCESS;
+                return result;
+            }
+        }
+
+        /* look for the end of the line */
+        start   = self->buffer+self->read_offset;
+        chunk   = self->valid-self->read_offset;
+        newline = ATX_FindByte(start, '\n', chunk);
+        if (newline) chunk = (ATX_Size)(newline-start);
+        if (chunk > room) {
+            chunk   = room;
+            newline = NULL;
+        }
+
+        /* copy the chunk */
+        ATX_CopyMemory(line+total, start, chunk);
+        total += ATX_BufferedInputStream_RemoveCarriageReturns(line+total, chunk);
+        ATX_BufferedInputStream_Consume(self, chunk);
+        if (newline) {
+            ATX_BufferedInputStream_Consume(self, 1);
+            break;
+        }
+    }
+
+    /* terminate the line */
+    line[total] = '\0';
+    if (chars_read) *chars_read = total;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_ReadLineString
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_BufferedInputStream_ReadLineString(ATX_BufferedInputStream* self,
+                                       ATX_String*              string,
+                                       ATX_Size                 max_length)
+{
+    /* reset the string */
+    ATX_String_SetLength(string, 0);
+
+    /* append chunks until we find a newline or reach the max length */
+    while (ATX_String_GetLength(string) < max_length) {
+        const ATX_Byte* start;
+        const ATX_Byte* newline;
+        ATX_Size        chunk;
+        ATX_Size        room = max_length-ATX_String_GetLength(string);
+        ATX_Size        i;
+
+        /* refill if needed */
+        if (self->read_offset == self->valid) {
+            ATX_Result result = ATX_BufferedInputStream_Fill(self);
+            if (ATX_FAILED(result)) {
+                if (result == ATX_ERROR_EOS && !ATX_String_IsEmpty(string)) {
+                    return ATX_SUCCESS;
+                }
+                return result;
+            }
+        }
+
+        /* look for the end of the line */
+        start   = self->buffer+self->read_offset;
+        chunk   = self->valid-self->read_offset;
+        newline = ATX_FindByte(start, '\n', chunk);
+        if (newline) chunk = (ATX_Size)(newline-start);
+        if (chunk > room) {
+            chunk   = room;
+            newline = NULL;
+        }
+
+        /* append the chunk, skipping '\r' characters */
+        for (i=0; i<chunk;) {
+            const ATX_Byte* cr = ATX_FindByte(start+i, '\r', chunk-i);
+            ATX_Size        run = cr ? (ATX_Size)(cr-(start+i)) : chunk-i;
+            ATX_CHECK(ATX_String_AppendSubString(string, (const char*)start+i, run));
+            i += run + (cr ? 1 : 0);
+        }
+        ATX_BufferedInputStream_Consume(self, chunk);
+        if (newline) {
+            ATX_BufferedInputStream_Consume(self, 1);
+            return ATX_SUCCESS;
+        }
+    }
+
+    return ATX_ERROR_NOT_ENOUGH_SPACE;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Read
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_BufferedInputStream_Read(ATX_InputStream* _self,
+                             ATX_Any          buffer, 
+                             ATX_Size         bytes_to_read, 
+                             ATX_Size*        bytes_read)
+{
+    ATX_BufferedInputStream* self = ATX_SELF(ATX_BufferedInputStream, ATX_InputStream);
+    ATX_Size                 available;
+
+    if (bytes_read) *bytes_read = 0;
+    if (bytes_to_read == 0) return ATX_SUCCESS;
+
+    if (self->read_offset == self->valid) {
+        /* large reads bypass the buffer */
+        if (bytes_to_read >= self->buffer_size) {
+            ATX_Size   local_read = 0;
+            ATX_Result result = ATX_InputStream_Read(self->source, 
+                                                     buffer, 
+                                                     bytes_to_read, 
+                                                     &local_read);
+            if (ATX_FAILED(result)) return result;
+            self->position += local_read;
+            if (bytes_read) *bytes_read = local_read;
+            return ATX_SUCCESS;
+        }
+
+        ATX_CHECK(ATX_BufferedInputStream_Fill(self));
+    }
+
+    /* copy from the buffer */
+    available = self->valid-self->read_offset;
+    if (bytes_to_read > available) bytes_to_read = available;
+    ATX_CopyMemory(buffer, self->buffer+self->read_offset, bytes_to_read);
+    ATX_BufferedInputStream_Consume(self, bytes_to_read);
+    if (bytes_read) *bytes_read = bytes_to_read;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Seek
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_BufferedInputStream_Seek(ATX_InputStream* _self, 
+                             ATX_Position     where)
+{
+    ATX_BufferedInputStream* self = ATX_SELF(ATX_BufferedInputStream, ATX_InputStream);
+    ATX_Position             buffer_start = self->position-self->read_offset;
+    ATX_Result               result;
+
+    /* seeks within the buffered data don't touch the source */
+    if (where >= buffer_start && where <= buffer_start+self->valid) {
+        self->read_offset = (ATX_Size)(where-buffer_start);
+        self->position    = where;
+        return ATX_SUCCESS;
+    }
+
+    /* discard the buffer and seek the source */
+    result = ATX_InputStream_Seek(self->source, where);
+    if (ATX_SUCCEEDED(result)) {
+        self->read_offset = 0;
+        self->valid       = 0;
+        self->position    = where;
+    }
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_Tell
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_BufferedInputStream_Tell(ATX_InputStream* _self, 
+                             ATX_Position*    where)
+{
+    ATX_BufferedInputStream* self = ATX_SELF(ATX_BufferedInputStream, ATX_InputStream);
+    if (where) *where = self->position;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_GetSize
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_BufferedInputStream_GetSize(ATX_InputStream* _self,
+                                ATX_LargeSize*   size)
+{
+    ATX_BufferedInputStream* self = ATX_SELF(ATX_BufferedInputStream, ATX_InputStream);
+    return ATX_InputStream_GetSize(self->source, size);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_GetAvailable
++---------------------------------------------------------------------*/
+ATX_METHOD
+ATX_BufferedInputStream_GetAvailable(ATX_InputStream* _self,
+                                     ATX_LargeSize*   available)
+{
+    ATX_BufferedInputStream* self = ATX_SELF(ATX_BufferedInputStream, ATX_InputStream);
+    ATX_LargeSize            source_available = 0;
+
+    ATX_InputStream_GetAvailable(self->source, &source_available);
+    *available = source_available+(self->valid-self->read_offset);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream_GetInterface
++---------------------------------------------------------------------*/
+ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(ATX_BufferedInputStream)
+    ATX_GET_INTERFACE_ACCEPT(ATX_BufferedInputStream, ATX_InputStream)
+    ATX_GET_INTERFACE_ACCEPT(ATX_BufferedInputStream, ATX_Referenceable)
+ATX_END_GET_INTERFACE_IMPLEMENTATION
+
+/*----------------------------------------------------------------------
+|   ATX_InputStream interface
++---------------------------------------------------------------------*/
+ATX_BEGIN_INTERFACE_MAP(ATX_BufferedInputStream, ATX_InputStream)
+    ATX_BufferedInputStream_Read,
+    ATX_BufferedInputStream_Seek,
+    ATX_BufferedInputStream_Tell,
+    ATX_BufferedInputStream_GetSize,
+    ATX_BufferedInputStream_GetAvailable
+};
+
+/*----------------------------------------------------------------------
+|   ATX_Referenceable interface
++---------------------------------------------------------------------*/
+ATX_BEGIN_INTERFACE_MAP(ATX_BufferedInputStream, ATX_Referenceable)
+    ATX_BufferedInputStream_AddReference,
+    ATX_BufferedInputStream_Release
+};
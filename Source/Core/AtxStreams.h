@@ -180,6 +180,74 @@ ATX_END_INTERFACE_DEFINITION
 #define ATX_StreamTransformer_Transform(object, buffer, size) \
 ATX_INTERFACE(object)->Transform(object, buffer, size)
 
+/*----------------------------------------------------------------------
+|   ATX_StreamDescriptor
++---------------------------------------------------------------------*/
+/**
+ * Optional interface of streams that are backed by a native file 
+ * descriptor. The stream remains the authority on the current position:
+ * code that reads from the descriptor directly must start at the 
+ * position returned by Tell() and Seek() the stream past what it 
+ * consumed.
+ */
+ATX_DECLARE_INTERFACE(ATX_StreamDescriptor)
+ATX_BEGIN_INTERFACE_DEFINITION(ATX_StreamDescriptor)
+    ATX_Result (*GetDescriptor)(ATX_StreamDescriptor* self,
+                                ATX_IntPtr*           descriptor);
+ATX_END_INTERFACE_DEFINITION
+
+#define ATX_StreamDescriptor_GetDescriptor(object, descriptor) \
+ATX_INTERFACE(object)->GetDescriptor(object, descriptor)
+
+/*----------------------------------------------------------------------
+|   ATX_StreamTransfer
++---------------------------------------------------------------------*/
+/**
+ * Optional interface of output streams that can pull data from some 
+ * kinds of input streams without copying it through user space.
+ * TransferFrom() returns ATX_ERROR_NOT_SUPPORTED, without having 
+ * consumed anything, when it cannot handle the source. 'size' is 0 to 
+ * transfer everything up to the end of the source.
+ */
+ATX_DECLARE_INTERFACE(ATX_StreamTransfer)
+ATX_BEGIN_INTERFACE_DEFINITION(ATX_StreamTransfer)
+    ATX_Result (*TransferFrom)(ATX_StreamTransfer* self,
+                               ATX_InputStream*    source,
+                               ATX_LargeSize       size,
+                               ATX_LargeSize*      bytes_transferred);
+ATX_END_INTERFACE_DEFINITION
+
+#define ATX_StreamTransfer_TransferFrom(object, source, size, bytes_transferred) \
+ATX_INTERFACE(object)->TransferFrom(object, source, size, bytes_transferred)
+
+/*----------------------------------------------------------------------
+|   ATX_Stream_Copy
++---------------------------------------------------------------------*/
+#define ATX_STREAM_COPY_BUFFER_SIZE 65536
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Copies 'size' bytes, or everything up to the end of the input when 
+ * 'size' is 0, from an input stream to an output stream. When the 
+ * output implements ATX_StreamTransfer, the data may move directly 
+ * between the underlying descriptors (sendfile() for files to sockets),
+ * otherwise it is copied through a single buffer of 
+ * ATX_STREAM_COPY_BUFFER_SIZE bytes. Returns ATX_SUCCESS once 'size' 
+ * bytes were copied or the input ended, and an error otherwise, with
+ * 'bytes_copied' (which may be NULL) telling how far the copy went.
+ */
+ATX_Result ATX_Stream_Copy(ATX_InputStream*  input,
+                           ATX_OutputStream* output,
+                           ATX_LargeSize     size,
+                           ATX_LargeSize*    bytes_copied);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 /*----------------------------------------------------------------------
 |   ATX_MemoryStream
 +---------------------------------------------------------------------*/
@@ -215,6 +283,71 @@ ATX_MemoryStream_GetOutputStream(ATX_MemoryStream* self,
 }
 #endif /* __cplusplus */
 
+/*----------------------------------------------------------------------
+|   ATX_BufferedInputStream
++---------------------------------------------------------------------*/
+/**
+ * An input stream that reads from a source stream in large chunks and
+ * serves Read, ReadLine and Peek requests from an internal buffer.
+ * ATX_InputStream_ReadLine and ATX_InputStream_ReadLineString detect
+ * streams obtained from ATX_BufferedInputStream_GetInputStream and scan
+ * the buffer directly instead of reading one byte at a time.
+ */
+typedef struct ATX_BufferedInputStream ATX_BufferedInputStream;
+
+#define ATX_BUFFERED_INPUT_STREAM_DEFAULT_BUFFER_SIZE 4096
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+ATX_Result 
+ATX_BufferedInputStream_Create(ATX_InputStream*          source,
+                               ATX_Size                  buffer_size, /* 0 for default */
+                               ATX_BufferedInputStream** stream);
+
+ATX_Result 
+ATX_BufferedInputStream_Destroy(ATX_BufferedInputStream* self);
+
+ATX_Result 
+ATX_BufferedInputStream_GetInputStream(ATX_BufferedInputStream* self,
+                                       ATX_InputStream**        stream);
+
+/**
+ * Copies up to bytes_to_peek bytes of upcoming data without consuming
+ * them. At most one read from the source is performed, so fewer bytes
+ * than requested may be returned even if the stream is not at its end.
+ */
+ATX_Result 
+ATX_BufferedInputStream_Peek(ATX_BufferedInputStream* self,
+                             ATX_Any                  buffer,
+                             ATX_Size                 bytes_to_peek,
+                             ATX_Size*                bytes_peeked);
+
+/**
+ * Pushes data back in front of the stream, so that it will be returned
+ * by the next read.
+ */
+ATX_Result 
+ATX_BufferedInputStream_Unread(ATX_BufferedInputStream* self,
+                               ATX_AnyConst             data,
+                               ATX_Size                 size);
+
+ATX_Result 
+ATX_BufferedInputStream_ReadLine(ATX_BufferedInputStream* self,
+                                 char*                    line,
+                                 ATX_Size                 line_size,
+                                 ATX_Size*                chars_read);
+
+ATX_Result 
+ATX_BufferedInputStream_ReadLineString(ATX_BufferedInputStream* self,
+                                       ATX_String*              string,
+                                       ATX_Size                 max_length);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 /*----------------------------------------------------------------------
 |   functions
 +---------------------------------------------------------------------*/
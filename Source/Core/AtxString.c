@@ -43,6 +43,8 @@
 |   constants
 +---------------------------------------------------------------------*/
 #define ATX_STRINGS_WHITESPACE_CHARS "\r\n\t "
+#define ATX_STRING_BUILDER_MIN_CAPACITY         64
+#define ATX_STRING_BUILDER_MAX_FORMAT_CAPACITY  (1024*1024)
 
 /*----------------------------------------------------------------------
 |   helpers
@@ -50,6 +52,8 @@
 #define ATX_UPPERCASE(x) (((x) >= 'a' && (x) <= 'z') ? (x)&0xdf : (x))
 #define ATX_LOWERCASE(x) (((x) >= 'A' && (x) <= 'Z') ? (x)^32   : (x))
 #define ATX_STRING_BUFFER_CHARS(b) ((char*)((b)+1))
+#define ATX_STRING_BUILDER_BUFFER(b) (((ATX_StringBuffer*)((b)->chars))-1)
+#define ATX_String_GetCapacity(s)  ((s)->chars?ATX_String_GetBuffer(s)->allocated:ATX_STRING_INLINE_CAPACITY)
 
 /*----------------------------------------------------------------------
 |   ATX_String_EmptyString
@@ -65,6 +69,7 @@ ATX_StringBuffer_Allocate(ATX_Size allocated, ATX_Size length)
     ATX_StringBuffer* buffer = 
         (ATX_StringBuffer*)
         ATX_AllocateMemory(sizeof(ATX_StringBuffer)+allocated+1);
+    if (buffer == NULL) return NULL;
     buffer->length = length;
     buffer->allocated = allocated;
 
@@ -72,50 +77,59 @@ ATX_StringBuffer_Allocate(ATX_Size allocated, ATX_Size length)
 }
 
 /*----------------------------------------------------------------------
-|   ATX_StringBuffer_Create
+|   ATX_String_SetStorageLength
+|
+|   updates the length of the current storage, inline or heap, without
+|   touching the characters
 +---------------------------------------------------------------------*/
-static char* 
-ATX_StringBuffer_Create(ATX_Size length)
+static void
+ATX_String_SetStorageLength(ATX_String* self, ATX_Size length)
 {
-    /* allocate a buffer of the requested size */
-    ATX_StringBuffer* buffer = ATX_StringBuffer_Allocate(length, length);
-    return ATX_STRING_BUFFER_CHARS(buffer);
+    if (self->chars) {
+        ATX_String_GetBuffer(self)->length = length;
+    } else {
+        self->inline_length = (unsigned char)length;
+    }
 }
 
 /*----------------------------------------------------------------------
-|   ATX_StringBuffer_CreateFromString
+|   ATX_String_Reset
 +---------------------------------------------------------------------*/
-static char* 
-ATX_StringBuffer_CreateFromString(const char* str)
+static void
+ATX_String_Reset(ATX_String* self)
 {
-    /* allocate a buffer of the same size as str */
-    ATX_Size length = ATX_StringLength(str);
-    ATX_StringBuffer* buffer = ATX_StringBuffer_Allocate(length, length);
-    char* result = ATX_STRING_BUFFER_CHARS(buffer);
-    
-    /* copy the string in the new buffer */
-    ATX_CopyString(result, str);
-
-    return result;
+    if (self->chars != NULL) {
+        ATX_FreeMemory((void*)ATX_String_GetBuffer(self));
+    }
+    ATX_String_Construct(self);
 }
 
 /*----------------------------------------------------------------------
-|   ATX_StringBuffer_CreateFromStringN
+|   ATX_String_PrepareToWrite
+|
+|   sets the length of the string, discarding its content if the 
+|   current storage is too small. Returns NULL if out of memory.
 +---------------------------------------------------------------------*/
-static char* 
-ATX_StringBuffer_CreateFromStringN(const char* str, ATX_Size length)
+static char*
+ATX_String_PrepareToWrite(ATX_String* self, ATX_Size length)
 {
-    /* allocate a buffer of the requested size */
-    ATX_StringBuffer* buffer = ATX_StringBuffer_Allocate(length, length);
-    char* result = ATX_STRING_BUFFER_CHARS(buffer);
-
-    /* copy the string in the new buffer */
-    ATX_CopyMemory(result, str, length);
-
-    /* add a null-terminator */
-    result[length] = '\0';
-
-    return result;
+    if (length > ATX_String_GetCapacity(self)) {
+        /* the storage is too small, we need a new one */
+        ATX_Size needed = length;
+        if (self->chars != NULL) {
+            ATX_Size grow = ATX_String_GetBuffer(self)->allocated*2;
+            if (grow > length) needed = grow;
+        }
+        ATX_String_Reset(self);
+        if (length > ATX_STRING_INLINE_CAPACITY) {
+            ATX_StringBuffer* buffer = ATX_StringBuffer_Allocate(needed, length);
+            if (buffer == NULL) return NULL;
+            self->chars = ATX_STRING_BUFFER_CHARS(buffer);
+            return self->chars;
+        }
+    }
+    ATX_String_SetStorageLength(self, length);
+    return ATX_String_UseChars(self);
 }
 
 /*----------------------------------------------------------------------
@@ -125,10 +139,9 @@ ATX_String
 ATX_String_Create(const char* str)
 {
     ATX_String result;
-    if (str == NULL || str[0] == '\0') {
-        result.chars = NULL;
-    } else {
-        result.chars = ATX_StringBuffer_CreateFromString(str);
+    ATX_String_Construct(&result);
+    if (str != NULL) {
+        ATX_String_AssignN(&result, str, ATX_StringLength(str));
     }
 
     return result;
@@ -143,6 +156,7 @@ ATX_String_CreateFromSubString(const char* str,
                                ATX_Size    length)
 {
     ATX_String result;
+    ATX_String_Construct(&result);
 
     /* shortcut */
     if (str != NULL && length != 0) {
@@ -154,12 +168,8 @@ ATX_String_CreateFromSubString(const char* str,
             ++src_str;
             if (str_length >= length) break;
         }
-        if (str_length != 0) {
-            result.chars = ATX_StringBuffer_CreateFromStringN(str+first, str_length);
-            return result;
-        }
+        ATX_String_AssignN(&result, str+first, str_length);
     } 
-    result.chars = NULL;
 
     return result;
 }
@@ -171,78 +181,36 @@ ATX_String
 ATX_String_Clone(const ATX_String* self)
 {
     ATX_String result;
-    if (self->chars == NULL) {
-        result.chars = NULL;
-    } else {
-        ATX_Size length = ATX_String_GetLength(self);
-        result.chars = ATX_StringBuffer_Create(length);
-        ATX_CopyString(result.chars, self->chars);
-    }
+    ATX_String_Construct(&result);
+    ATX_String_AssignN(&result, ATX_String_GetChars(self), ATX_String_GetLength(self));
 
     return result;
 }
 
-
-/*----------------------------------------------------------------------
-|   ATX_String_Reset
-+---------------------------------------------------------------------*/
-static void
-ATX_String_Reset(ATX_String* self)
-{
-    if (self->chars != NULL) {
-        ATX_FreeMemory((void*)ATX_String_GetBuffer(self));
-        self->chars = NULL;
-    }
-}
-
-/*----------------------------------------------------------------------
-|   ATX_String_PrepareToWrite
-+---------------------------------------------------------------------*/
-static char*
-ATX_String_PrepareToWrite(ATX_String* self, ATX_Size length)
-{
-    if (self->chars == NULL || ATX_String_GetBuffer(self)->allocated < length) {
-        /* the buffer is too small, we need to allocate a new one */
-        ATX_Size needed = length;
-        if (self->chars != NULL) {
-            ATX_Size grow = ATX_String_GetBuffer(self)->allocated*2;
-            if (grow > length) needed = grow;
-            ATX_FreeMemory((void*)ATX_String_GetBuffer(self));
-        }
-        self->chars = ATX_STRING_BUFFER_CHARS(
-            ATX_StringBuffer_Allocate(needed, length));
-    } else {   
-        ATX_String_GetBuffer(self)->length = length;
-    }
-    return self->chars;
-}
-
 /*----------------------------------------------------------------------
 |   ATX_String_Reserve
 +---------------------------------------------------------------------*/
 ATX_Result
 ATX_String_Reserve(ATX_String* self, ATX_Size allocate)
 {
-    if (self->chars == NULL || ATX_String_GetBuffer(self)->allocated < allocate) {
-        /* the buffer is too small, we need to allocate a new one */
-        ATX_Size needed = allocate;
+    if (allocate > ATX_String_GetCapacity(self)) {
+        /* the storage is too small, we need to allocate a new buffer */
+        ATX_Size          needed = allocate;
+        ATX_Size          length = ATX_String_GetLength(self);
+        ATX_StringBuffer* buffer;
+        char*             copy;
         if (self->chars != NULL) {
             ATX_Size grow = ATX_String_GetBuffer(self)->allocated*2;
             if (grow > allocate) needed = grow;
         }
-        {
-            ATX_Size length = ATX_String_GetLength(self);
-            char* copy = ATX_STRING_BUFFER_CHARS(
-                ATX_StringBuffer_Allocate(needed, length));
-            if (copy == NULL) return ATX_ERROR_OUT_OF_MEMORY;
-            if (self->chars != NULL) {
-                ATX_CopyString(copy, self->chars);
-                ATX_FreeMemory(ATX_String_GetBuffer(self));
-            } else {
-                copy[0] = '\0';
-            }
-            self->chars = copy;
+        buffer = ATX_StringBuffer_Allocate(needed, length);
+        if (buffer == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        copy = ATX_STRING_BUFFER_CHARS(buffer);
+        ATX_CopyMemory(copy, ATX_String_GetChars(self), length+1);
+        if (self->chars != NULL) {
+            ATX_FreeMemory(ATX_String_GetBuffer(self));
         }
+        self->chars = copy;
     }
 
     return ATX_SUCCESS;
@@ -271,9 +239,10 @@ ATX_String_AssignN(ATX_String* self, const char* str, ATX_Size length)
     if (str == NULL || length == 0) {
         ATX_String_Reset(self);
     } else {
-        ATX_String_PrepareToWrite(self, length);
-        ATX_CopyMemory(self->chars, str, length);
-        self->chars[length] = '\0';
+        char* chars = ATX_String_PrepareToWrite(self, length);
+        if (chars == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        ATX_CopyMemory(chars, str, length);
+        chars[length] = '\0';
     }
 
     return ATX_SUCCESS;
@@ -285,16 +254,11 @@ ATX_String_AssignN(ATX_String* self, const char* str, ATX_Size length)
 void
 ATX_String_Copy(ATX_String* self, const ATX_String* str)
 {
-    if (str == NULL || str->chars == NULL) {
+    if (str == self) return;
+    if (str == NULL) {
         ATX_String_Reset(self);
     } else {
-        ATX_Size length = ATX_String_GetBuffer(str)->length;
-        if (length == 0) {
-            ATX_String_Reset(self);
-        } else {
-            ATX_String_PrepareToWrite(self, length);
-            ATX_CopyString(self->chars, str->chars);
-        }
+        ATX_String_AssignN(self, ATX_String_GetChars(str), ATX_String_GetLength(str));
     }
 }
 
@@ -304,12 +268,9 @@ ATX_String_Copy(ATX_String* self, const ATX_String* str)
 ATX_Result
 ATX_String_SetLength(ATX_String* self, ATX_Size length)
 {
-    if (self->chars == NULL) {
-        return (length == 0 ? ATX_SUCCESS : ATX_ERROR_INVALID_PARAMETERS);
-    }
-    if (length <= ATX_String_GetBuffer(self)->allocated) {
+    if (length <= ATX_String_GetCapacity(self)) {
         char* chars = ATX_String_UseChars(self);
-        ATX_String_GetBuffer(self)->length = length;
+        ATX_String_SetStorageLength(self, length);
         chars[length] = '\0';
         return ATX_SUCCESS;
     } else {
@@ -350,16 +311,18 @@ ATX_String_AppendSubString(ATX_String* self, const char* str, ATX_Size length)
         /* compute the new length */
         ATX_Size old_length = ATX_String_GetLength(self);
         ATX_Size new_length = old_length + length;
+        char*    chars;
 
         /* allocate enough space */
         ATX_CHECK(ATX_String_Reserve(self, new_length));
 
         /* append the new string at the end of the current one */
-        ATX_CopyMemory(self->chars+old_length, str, length);
+        chars = ATX_String_UseChars(self);
+        ATX_CopyMemory(chars+old_length, str, length);
 
         /* set the length and null-terminate */
-        ATX_String_GetBuffer(self)->length = new_length;
-        self->chars[new_length] = '\0';
+        ATX_String_SetStorageLength(self, new_length);
+        chars[new_length] = '\0';
     }
 
     return ATX_SUCCESS;
@@ -408,6 +371,10 @@ ATX_String_Equals(const ATX_String* self, const char *s, ATX_Boolean ignore_case
 ATX_String
 ATX_String_SubString(const ATX_String* self, ATX_Ordinal first, ATX_Size length)
 {
+    if (first > ATX_String_GetLength(self)) {
+        ATX_String empty = ATX_EMPTY_STRING;
+        return empty;
+    }
     return ATX_String_CreateFromSubString(ATX_String_GetChars(self), 
                                           first, 
                                           length);
@@ -452,7 +419,7 @@ ATX_String_EndsWith(const ATX_String* self, const char *s)
     if (s == NULL || *s == '\0') return ATX_FALSE;
     str_length = ATX_StringLength(s);
     if (str_length > ATX_String_GetLength(self)) return ATX_FALSE;
-    return (ATX_StringStartsWith(self->chars+ATX_String_GetLength(self)-str_length, s) == 1)?ATX_TRUE:ATX_FALSE;
+    return (ATX_StringStartsWith(ATX_String_GetChars(self)+ATX_String_GetLength(self)-str_length, s) == 1)?ATX_TRUE:ATX_FALSE;
 }
 
 
@@ -469,7 +436,8 @@ ATX_String_FindStringFrom(const ATX_String* self,
 
     /* skip to start position */
     {
-        const char* src = self->chars + start;
+        const char* chars = ATX_String_GetChars(self);
+        const char* src = chars + start;
 
         /* look for a substring */
         while (*src) {
@@ -480,7 +448,7 @@ ATX_String_FindStringFrom(const ATX_String* self,
                     return -1;
                 case 1:
                     /* match */
-                    return (int)(src-self->chars);
+                    return (int)(src-chars);
             }
             src++;
         }
@@ -509,11 +477,12 @@ ATX_String_FindCharFrom(const ATX_String* self, char c, ATX_Ordinal start)
 
     {
         /* skip to start position */
-        const char* src = self->chars + start;
+        const char* chars = ATX_String_GetChars(self);
+        const char* src = chars + start;
 
         /* look for the character */
         while (*src) {
-            if (*src == c) return (int)(src-self->chars);
+            if (*src == c) return (int)(src-chars);
             src++;
         }
     }
@@ -649,11 +618,11 @@ void
 ATX_String_Replace(ATX_String* self, char a, char b) 
 {
     /* check args */
-    if (self->chars == NULL || a == '\0' || b == '\0') return;
+    if (a == '\0' || b == '\0') return;
 
     {
         /* we are going to modify the characters */
-        char* src = self->chars;
+        char* src = ATX_String_UseChars(self);
 
         /* process the buffer in place */
         while (*src) {
@@ -687,12 +656,15 @@ ATX_String_Insert(ATX_String* self, const char* str, ATX_Ordinal where)
 
     {
         /* prepare to write the new string */
-        char* src = self->chars;
-        char* nst = ATX_StringBuffer_Create(new_length);
-        char* dst = nst;
+        ATX_String  result;
+        const char* src = ATX_String_GetChars(self);
+        char*       dst;
+        
+        ATX_String_Construct(&result);
+        dst = ATX_String_PrepareToWrite(&result, new_length);
 
         /* check for errors */
-        if (nst == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        if (dst == NULL) return ATX_ERROR_OUT_OF_MEMORY;
 
         /* copy the beginning of the old string */
         if (where > 0) {
@@ -711,8 +683,8 @@ ATX_String_Insert(ATX_String* self, const char* str, ATX_Ordinal where)
         }
 
         /* use the new string */
-        if (self->chars) ATX_FreeMemory((void*)ATX_String_GetBuffer(self));
-        self->chars = nst;
+        ATX_String_Reset(self);
+        *self = result;
     }
 
     return ATX_SUCCESS;
@@ -763,11 +735,10 @@ ATX_String_TrimCharLeft(ATX_String* self, char c)
 void 
 ATX_String_TrimCharsLeft(ATX_String* self, const char* chars)
 {
-    const char* s;
+    char*       d = ATX_String_UseChars(self);
+    const char* s = d;
     char        c;
 
-    if (self->chars == NULL) return;
-    s = self->chars;
     while ((c = *s)) {
         const char* x = chars;
         while (*x) {
@@ -777,17 +748,14 @@ ATX_String_TrimCharsLeft(ATX_String* self, const char* chars)
         if (*x == 0) break; /* not found */
         s++;
     }
-    if (s == self->chars) {
+    if (s == d) {
         /* nothing was trimmed */
         return;
     }
 
     /* shift chars to the left */
-    {
-        char* d = self->chars;
-        ATX_String_GetBuffer(self)->length = (ATX_Cardinal)(ATX_String_GetLength(self)-(s-d));
-        while ((*d++ = *s++)) {};
-    }
+    ATX_String_SetStorageLength(self, ATX_String_GetLength(self)-(s-d));
+    while ((*d++ = *s++)) {};
 }
 
 /*----------------------------------------------------------------------
@@ -817,12 +785,13 @@ ATX_String_TrimCharRight(ATX_String* self, char c)
 void 
 ATX_String_TrimCharsRight(ATX_String* self, const char* chars)
 {
-    if (self->chars == NULL || self->chars[0] == '\0') return;
+    char* head = ATX_String_UseChars(self);
+    if (head[0] == '\0') return;
 
     {
-        char* tail = self->chars+ATX_String_GetLength(self)-1;
+        char* tail = head+ATX_String_GetLength(self)-1;
         char* s = tail;
-        while (s != self->chars-1) {
+        while (s != head-1) {
             const char* x = chars;
             while (*x) {
                 if (*x == *s) {
@@ -838,7 +807,7 @@ ATX_String_TrimCharsRight(ATX_String* self, const char* chars)
             /* nothing was trimmed */
             return;
         }
-        ATX_String_GetBuffer(self)->length = 1+(int)(s-self->chars);
+        ATX_String_SetStorageLength(self, 1+(int)(s-head));
     }
 }
 
@@ -892,12 +861,157 @@ ATX_String_Add(const ATX_String* s1, const char* s2)
         /* allocate space for the new string */
         ATX_String result = ATX_EMPTY_STRING;
         char* start = ATX_String_PrepareToWrite(&result, s1_length+s2_length);
+        if (start == NULL) return result;
 
         /* concatenate the two strings into the result */
-        ATX_CopyMemory(start, s1, s1_length);
+        ATX_CopyMemory(start, ATX_String_GetChars(s1), s1_length);
         ATX_CopyString(start+s1_length, s2);
 
         return result;
     }
 }
 
+
+/*----------------------------------------------------------------------
+|   ATX_StringBuilder_Destruct
++---------------------------------------------------------------------*/
+void
+ATX_StringBuilder_Destruct(ATX_StringBuilder* self)
+{
+    if (self->chars) {
+        ATX_FreeMemory((void*)ATX_STRING_BUILDER_BUFFER(self));
+    }
+    ATX_StringBuilder_Construct(self);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_StringBuilder_Reserve
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_StringBuilder_Reserve(ATX_StringBuilder* self, ATX_Size capacity)
+{
+    ATX_StringBuffer* buffer;
+    ATX_Size          needed;
+
+    if (capacity <= self->capacity) return ATX_SUCCESS;
+
+    /* grow geometrically so that appends are amortized O(1) */
+    needed = self->capacity*2;
+    if (needed < ATX_STRING_BUILDER_MIN_CAPACITY) needed = ATX_STRING_BUILDER_MIN_CAPACITY;
+    if (needed < capacity) needed = capacity;
+
+    if (self->chars) {
+        /* the allocator may be able to grow the buffer in place */
+        buffer = (ATX_StringBuffer*)ATX_ReallocateMemory(ATX_STRING_BUILDER_BUFFER(self), 
+                                                         sizeof(ATX_StringBuffer)+needed+1);
+        if (buffer == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        buffer->allocated = needed;
+    } else {
+        buffer = ATX_StringBuffer_Allocate(needed, 0);
+        if (buffer == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        ATX_STRING_BUFFER_CHARS(buffer)[0] = '\0';
+    }
+    self->chars    = ATX_STRING_BUFFER_CHARS(buffer);
+    self->capacity = needed;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_StringBuilder_AppendSubString
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_StringBuilder_AppendSubString(ATX_StringBuilder* self, const char* str, ATX_Size length)
+{
+    if (str == NULL || length == 0) return ATX_SUCCESS;
+    if (self->length+length > self->capacity) {
+        ATX_CHECK(ATX_StringBuilder_Reserve(self, self->length+length));
+    }
+    ATX_CopyMemory(self->chars+self->length, str, length);
+    self->length += length;
+    self->chars[self->length] = '\0';
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_StringBuilder_Append
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_StringBuilder_Append(ATX_StringBuilder* self, const char* str)
+{
+    if (str == NULL) return ATX_SUCCESS;
+    return ATX_StringBuilder_AppendSubString(self, str, ATX_StringLength(str));
+}
+
+/*----------------------------------------------------------------------
+|   ATX_StringBuilder_AppendChar
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_StringBuilder_AppendChar(ATX_StringBuilder* self, char c)
+{
+    if (self->length == self->capacity) {
+        ATX_CHECK(ATX_StringBuilder_Reserve(self, self->length+1));
+    }
+    self->chars[self->length++] = c;
+    self->chars[self->length]   = '\0';
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_StringBuilder_AppendFormat
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_StringBuilder_AppendFormat(ATX_StringBuilder* self, const char* format, ...)
+{
+    if (format == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+    if (self->chars == NULL) {
+        ATX_CHECK(ATX_StringBuilder_Reserve(self, ATX_STRING_BUILDER_MIN_CAPACITY));
+    }
+
+    for (;;) {
+        ATX_Size available = self->capacity-self->length;
+        va_list  args;
+        int      result;
+
+        /* try to format in place, the buffer has room for a terminator */
+        va_start(args, format);
+        result = ATX_FormatStringVN(self->chars+self->length, available+1, format, args);
+        va_end(args);
+        if (result >= 0 && (ATX_Size)result <= available) {
+            self->length += result;
+            self->chars[self->length] = '\0';
+            return ATX_SUCCESS;
+        }
+
+        /* it didn't fit: some implementations return the needed size, */
+        /* others just -1                                              */
+        self->chars[self->length] = '\0';
+        if (result >= 0) {
+            ATX_CHECK(ATX_StringBuilder_Reserve(self, self->length+result));
+        } else {
+            if (self->capacity >= ATX_STRING_BUILDER_MAX_FORMAT_CAPACITY) {
+                return ATX_ERROR_OUT_OF_RANGE;
+            }
+            ATX_CHECK(ATX_StringBuilder_Reserve(self, self->capacity+1));
+        }
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_StringBuilder_Detach
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_StringBuilder_Detach(ATX_StringBuilder* self, ATX_String* str)
+{
+    ATX_String_Reset(str);
+    if (self->length == 0) return ATX_SUCCESS;
+
+    /* the buffer is already laid out like the heap buffer of a string */
+    ATX_STRING_BUILDER_BUFFER(self)->length = self->length;
+    str->chars = self->chars;
+    ATX_StringBuilder_Construct(self);
+
+    return ATX_SUCCESS;
+}
@@ -44,6 +44,9 @@
 #define ATX_STRING_SEARCH_FAILED (-1)
 #define ATX_EMPTY_STRING {0}
 
+/* strings up to this length are stored in the ATX_String itself */
+#define ATX_STRING_INLINE_CAPACITY 22
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -55,8 +58,18 @@ extern const char* const ATX_String_EmptyString;
 /*----------------------------------------------------------------------
 |   types
 +---------------------------------------------------------------------*/
+/*
+ * When chars is NULL, the string is stored inline: inline_length
+ * characters followed by a null terminator in inline_chars. Otherwise
+ * chars points just past an ATX_StringBuffer header. Since the inline
+ * characters live in the struct, a pointer returned by
+ * ATX_String_GetChars is only valid as long as the ATX_String itself
+ * is not moved.
+ */
 typedef struct {
-    char* chars;
+    char*         chars;
+    char          inline_chars[ATX_STRING_INLINE_CAPACITY+1];
+    unsigned char inline_length;
 } ATX_String;
 
 typedef struct {
@@ -65,29 +78,61 @@ typedef struct {
     /* the actual string characters follow */
 } ATX_StringBuffer;
 
+/*
+ * Accumulates characters in a buffer that grows geometrically, for
+ * strings built from many pieces. The buffer has the same layout as
+ * the heap buffer of an ATX_String (chars points just past an
+ * ATX_StringBuffer header), so the result can be handed to an 
+ * ATX_String without copying. A zero-initialized builder is empty.
+ */
+typedef struct {
+    char*    chars;
+    ATX_Size length;
+    ATX_Size capacity;
+} ATX_StringBuilder;
+
 /*----------------------------------------------------------------------
 |   ATX_String inline functions
 +---------------------------------------------------------------------*/
 #define ATX_String_GetBuffer(str) ( ((ATX_StringBuffer*)((str)->chars))-1 )
 #define ATX_String_Construct(str) do {                  \
     (str)->chars = NULL;                                \
+    (str)->inline_chars[0] = '\0';                      \
+    (str)->inline_length = 0;                           \
 } while(0)
 #define ATX_String_Destruct(str) do {                        \
     if ((str)->chars) {                                      \
         ATX_FreeMemory((void*)ATX_String_GetBuffer((str)));  \
-        (str)->chars = NULL;                                 \
     }                                                        \
+    ATX_String_Construct(str);                               \
 } while(0)
-#define ATX_String_GetChar(str, index) ((str)->chars[(index)])
+#define ATX_String_GetChar(str, index) (ATX_String_GetChars(str)[(index)])
 #define ATX_String_SetChar(str, index, c) do {          \
-    (str)->chars[(index)] = (c);                        \
+    ATX_String_UseChars(str)[(index)] = (c);            \
 } while(0)
-#define ATX_String_GetLength(str) ((str)->chars?(ATX_String_GetBuffer(str)->length):0)
-#define ATX_String_GetChars(str) ((str)->chars?(const char*)((str)->chars):ATX_String_EmptyString)
-#define ATX_String_UseChars(str) ((str)->chars?(str)->chars:(char*)ATX_String_EmptyString)
+#define ATX_String_IsInline(str) ((str)->chars == NULL)
+#define ATX_String_GetLength(str) ((str)->chars?(ATX_String_GetBuffer(str)->length):(str)->inline_length)
+#define ATX_String_GetChars(str) ((str)->chars?(const char*)((str)->chars):(const char*)((str)->inline_chars))
+#define ATX_String_UseChars(str) ((str)->chars?(str)->chars:(str)->inline_chars)
 #define ATX_CSTR(str) ATX_String_GetChars(&(str))
 #define ATX_String_IsEmpty(str) (ATX_String_GetLength((str))==0)
-#define ATX_INIT_STRING(s) do {(s).chars = NULL; } while(0)
+#define ATX_INIT_STRING(s) ATX_String_Construct(&(s))
+
+/*----------------------------------------------------------------------
+|   ATX_StringBuilder inline functions
++---------------------------------------------------------------------*/
+#define ATX_EMPTY_STRING_BUILDER {NULL, 0, 0}
+#define ATX_StringBuilder_Construct(builder) do {       \
+    (builder)->chars    = NULL;                         \
+    (builder)->length   = 0;                            \
+    (builder)->capacity = 0;                            \
+} while(0)
+#define ATX_StringBuilder_GetChars(builder) ((builder)->chars?(const char*)((builder)->chars):ATX_String_EmptyString)
+#define ATX_StringBuilder_GetLength(builder) ((builder)->length)
+#define ATX_StringBuilder_Reset(builder) do {           \
+    (builder)->length = 0;                              \
+    if ((builder)->chars) (builder)->chars[0] = '\0';   \
+} while(0)
 
 /*----------------------------------------------------------------------
 |   ATX_String functions
@@ -231,6 +276,38 @@ ATX_String_Insert(ATX_String* str, const char* s, ATX_Ordinal where);
 /*void Erase(ATX_Ordinal start, ATX_Cardinal count = 1);*/
 /*void Replace(ATX_Ordinal start, ATX_Cardinal count, const char* s);*/
 
+/*----------------------------------------------------------------------
+|   ATX_StringBuilder functions
++---------------------------------------------------------------------*/
+extern void
+ATX_StringBuilder_Destruct(ATX_StringBuilder* builder);
+
+extern ATX_Result
+ATX_StringBuilder_Reserve(ATX_StringBuilder* builder, ATX_Size capacity);
+
+extern ATX_Result
+ATX_StringBuilder_Append(ATX_StringBuilder* builder, const char* s);
+
+extern ATX_Result
+ATX_StringBuilder_AppendSubString(ATX_StringBuilder* builder, const char* s, ATX_Size length);
+
+extern ATX_Result
+ATX_StringBuilder_AppendChar(ATX_StringBuilder* builder, char c);
+
+/**
+ * Append printf-style formatted text, formatting directly into the 
+ * builder's buffer.
+ */
+extern ATX_Result
+ATX_StringBuilder_AppendFormat(ATX_StringBuilder* builder, const char* format, ...);
+
+/**
+ * Move the characters to a string, replacing its previous value. The
+ * builder is left empty and can be reused.
+ */
+extern ATX_Result
+ATX_StringBuilder_Detach(ATX_StringBuilder* builder, ATX_String* str);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
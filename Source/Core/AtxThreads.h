@@ -41,8 +41,43 @@
 /*----------------------------------------------------------------------
 |   types
 +---------------------------------------------------------------------*/
-typedef struct ATX_Mutex ATX_Mutex;
-typedef unsigned long    ATX_ThreadId;
+typedef struct ATX_Mutex       ATX_Mutex;
+typedef struct ATX_Condition   ATX_Condition;
+typedef struct ATX_Semaphore   ATX_Semaphore;
+typedef struct ATX_Thread      ATX_Thread;
+typedef struct ATX_ThreadLocal ATX_ThreadLocal;
+typedef unsigned long          ATX_ThreadId;
+
+/**
+ * Function run by a thread.
+ */
+typedef void (*ATX_ThreadFunction)(void* arg);
+
+/**
+ * 32-bit integer that can be shared between threads. It must only be
+ * accessed through the ATX_AtomicInt_XXX functions.
+ */
+typedef struct {
+    volatile ATX_Int32 value;
+} ATX_AtomicInt;
+
+/**
+ * Pointer that can be shared between threads. It must only be
+ * accessed through the ATX_AtomicPointer_XXX functions.
+ */
+typedef struct {
+    void* volatile value;
+} ATX_AtomicPointer;
+
+/*----------------------------------------------------------------------
+|   constants
++---------------------------------------------------------------------*/
+#define ATX_TIMEOUT_INFINITE -1
+
+/*----------------------------------------------------------------------
+|   error codes
++---------------------------------------------------------------------*/
+#define ATX_ERROR_WAIT_TIMEOUT (ATX_ERROR_BASE_THREADS - 0)
 
 /*----------------------------------------------------------------------
 |   prototypes
@@ -81,9 +116,190 @@ ATX_Mutex_Destroy(ATX_Mutex* mutex);
 ATX_ThreadId
 ATX_GetCurrentThreadId(void);
 
+/**
+ * Create a condition variable.
+ */
+ATX_Result
+ATX_Condition_Create(ATX_Condition** condition);
+
+ATX_Result
+ATX_Condition_Destroy(ATX_Condition* self);
+
+/**
+ * Wait until the condition is signaled or the timeout (in milliseconds)
+ * expires. The mutex must be locked by the caller, it is released while
+ * waiting and locked again before returning. Like with any condition 
+ * variable, the caller must re-check its predicate when this returns.
+ * Returns ATX_ERROR_WAIT_TIMEOUT if the timeout expired.
+ */
+ATX_Result
+ATX_Condition_Wait(ATX_Condition* self, ATX_Mutex* mutex, ATX_Timeout timeout);
+
+/**
+ * Wake up one thread waiting on the condition.
+ */
+ATX_Result
+ATX_Condition_Signal(ATX_Condition* self);
+
+/**
+ * Wake up all the threads waiting on the condition.
+ */
+ATX_Result
+ATX_Condition_Broadcast(ATX_Condition* self);
+
+/**
+ * Create and start a thread that runs function(arg).
+ */
+ATX_Result
+ATX_Thread_Create(ATX_ThreadFunction function, void* arg, ATX_Thread** thread);
+
+/**
+ * Wait for a thread to terminate, then destroy the thread object.
+ */
+ATX_Result
+ATX_Thread_Join(ATX_Thread* self);
+
+/**
+ * Let a thread run on its own, then destroy the thread object.
+ * The thread releases its resources when it terminates, and can no
+ * longer be joined.
+ */
+ATX_Result
+ATX_Thread_Detach(ATX_Thread* self);
+
+/**
+ * Get the id of a thread, as returned by ATX_GetCurrentThreadId when
+ * called from that thread.
+ */
+ATX_ThreadId
+ATX_Thread_GetId(ATX_Thread* self);
+
+/**
+ * Give a thread a name that debuggers and system tools can show.
+ * Names may be truncated by the platform (15 characters on Linux).
+ * Returns ATX_ERROR_NOT_SUPPORTED if the platform has no thread names.
+ */
+ATX_Result
+ATX_Thread_SetName(ATX_Thread* self, const char* name);
+
+/**
+ * Create a counting semaphore.
+ */
+ATX_Result
+ATX_Semaphore_Create(ATX_Cardinal initial_count, ATX_Semaphore** semaphore);
+
+ATX_Result
+ATX_Semaphore_Destroy(ATX_Semaphore* self);
+
+/**
+ * Wait until the count is positive, then decrement it.
+ * Returns ATX_ERROR_WAIT_TIMEOUT if the timeout (in milliseconds)
+ * expired first.
+ */
+ATX_Result
+ATX_Semaphore_Wait(ATX_Semaphore* self, ATX_Timeout timeout);
+
+/**
+ * Increment the count, waking up a waiting thread if there is one.
+ */
+ATX_Result
+ATX_Semaphore_Post(ATX_Semaphore* self);
+
+/**
+ * Create a thread-local storage slot. Each thread sees its own value,
+ * NULL until the thread sets it.
+ */
+ATX_Result
+ATX_ThreadLocal_Create(ATX_ThreadLocal** local);
+
+/**
+ * Destroy a thread-local storage slot. The values stored by threads 
+ * are not freed.
+ */
+ATX_Result
+ATX_ThreadLocal_Destroy(ATX_ThreadLocal* self);
+
+void*
+ATX_ThreadLocal_Get(ATX_ThreadLocal* self);
+
+ATX_Result
+ATX_ThreadLocal_Set(ATX_ThreadLocal* self, void* value);
+
+/**
+ * Atomically add a value to an atomic integer and return the new value.
+ */
+ATX_Int32
+ATX_AtomicInt_Add(ATX_AtomicInt* self, ATX_Int32 value);
+
+/**
+ * Atomically set an atomic integer to a new value if its current value
+ * is the expected one. Returns ATX_TRUE if the value was set.
+ */
+ATX_Boolean
+ATX_AtomicInt_CompareAndSwap(ATX_AtomicInt* self, 
+                             ATX_Int32      expected, 
+                             ATX_Int32      value);
+
+/**
+ * Read the value of an atomic integer. Writes made by other threads
+ * before they stored the value are visible after this returns.
+ */
+ATX_Int32
+ATX_AtomicInt_Get(ATX_AtomicInt* self);
+
+/**
+ * Set the value of an atomic integer. Writes made before this call are
+ * visible to threads that read the new value.
+ */
+void
+ATX_AtomicInt_Set(ATX_AtomicInt* self, ATX_Int32 value);
+
+/**
+ * Atomically set an atomic integer and return its previous value.
+ */
+ATX_Int32
+ATX_AtomicInt_Exchange(ATX_AtomicInt* self, ATX_Int32 value);
+
+/**
+ * Pointer versions of the ATX_AtomicInt functions.
+ */
+void*
+ATX_AtomicPointer_Get(ATX_AtomicPointer* self);
+
+void
+ATX_AtomicPointer_Set(ATX_AtomicPointer* self, void* value);
+
+void*
+ATX_AtomicPointer_Exchange(ATX_AtomicPointer* self, void* value);
+
+ATX_Boolean
+ATX_AtomicPointer_CompareAndSwap(ATX_AtomicPointer* self, 
+                                 void*              expected, 
+                                 void*              value);
+
 #ifdef __cplusplus
 }
 #endif
 
+/*----------------------------------------------------------------------
+|   macros
++---------------------------------------------------------------------*/
+/**
+ * Increment or decrement an atomic integer and return the new value.
+ * With compilers that have atomic builtins these expand inline, which
+ * keeps them cheap enough for reference counting. The decrement has
+ * acquire/release semantics so that the thread that drops the last
+ * reference sees every write made through the other references.
+ */
+#if defined(__ATOMIC_ACQ_REL)
+#define ATX_ATOMIC_INCREMENT(_atomic) \
+    __atomic_add_fetch(&(_atomic)->value, 1, __ATOMIC_RELAXED)
+#define ATX_ATOMIC_DECREMENT(_atomic) \
+    __atomic_sub_fetch(&(_atomic)->value, 1, __ATOMIC_ACQ_REL)
+#else
+#define ATX_ATOMIC_INCREMENT(_atomic) ATX_AtomicInt_Add((_atomic),  1)
+#define ATX_ATOMIC_DECREMENT(_atomic) ATX_AtomicInt_Add((_atomic), -1)
+#endif
+
 #endif /* _ATX_THREADS_H_ */
 
@@ -42,6 +42,9 @@
 #if defined(ATX_CONFIG_HAVE_LIMITS_H)
 #include <limits.h>
 #endif
+#if defined(ATX_CONFIG_HAVE_STRTOD)
+#include <stdlib.h>
+#endif
 
 /*----------------------------------------------------------------------
 |   constants
@@ -49,6 +52,15 @@
 #define ATX_FORMAT_LOCAL_BUFFER_SIZE 1024
 #define ATX_FORMAT_BUFFER_INCREMENT  4096
 #define ATX_FORMAT_BUFFER_MAX_SIZE   65536
+#define ATX_SHORTEST_MAX_DECIMALS    15
+
+/*----------------------------------------------------------------------
+|   globals
++---------------------------------------------------------------------*/
+static const double ATX_PowersOf10[ATX_SHORTEST_MAX_DECIMALS+1] = {
+    1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
 
 /*----------------------------------------------------------------------
 |    ATX_BytesFromInt64Be
@@ -535,6 +547,114 @@ ATX_DoubleToString(double value, char* buffer, ATX_Size buffer_size)
     }
 }
 
+/*----------------------------------------------------------------------
+|   ATX_FormatDecimal
+|
+|   Formats mantissa*10^-decimals, with at least one digit before the
+|   decimal point.
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_FormatDecimal(ATX_UInt64   mantissa, 
+                  unsigned int decimals, 
+                  ATX_Boolean  negative, 
+                  char*        buffer, 
+                  ATX_Size     buffer_size)
+{
+    char         s[32];
+    char*        c = &s[sizeof(s)-1];
+    unsigned int i;
+
+    *c = '\0';
+    for (i=0; i<decimals; i++) {
+        *--c = (char)('0'+mantissa%10);
+        mantissa /= 10;
+    }
+    *--c = '.';
+    do {
+        *--c = (char)('0'+mantissa%10);
+        mantissa /= 10;
+    } while (mantissa);
+    if (negative) *--c = '-';
+
+    if ((ATX_Size)(&s[sizeof(s)-1]-c)+1 > buffer_size) return ATX_ERROR_OUT_OF_RANGE;
+    ATX_CopyString(buffer, c);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_DoubleToStringShortest
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_DoubleToStringShortest(double value, char* buffer, ATX_Size buffer_size)
+{
+    double       magnitude = value < 0.0 ? -value : value;
+    unsigned int decimals;
+
+    /* keep the sign of negative zero */
+    if (value == 0.0) {
+        ATX_UInt64 bits;
+        ATX_CopyMemory(&bits, &value, sizeof(bits));
+        if (bits >> 63) {
+            if (buffer_size < 3) return ATX_ERROR_OUT_OF_RANGE;
+            ATX_CopyString(buffer, "-0");
+            return ATX_SUCCESS;
+        }
+    }
+
+    /* integers that a double holds exactly don't need a fraction */
+    if (value > -9007199254740992.0 && value < 9007199254740992.0 &&
+        value == (double)(ATX_Int64)value) {
+        return ATX_IntegerToString((ATX_Int64)value, buffer, buffer_size);
+    }
+
+    /* decimals with up to 15 significant digits, like most values that */
+    /* were parsed from text, are found without formatting: m and 10^k  */
+    /* are exact, so m/10^k is correctly rounded, and if it's the value  */
+    /* then so is the parsed decimal m*10^-k. This is what "%.15g" gives */
+    /* for them, except for values below 1e-4 which it prints with an    */
+    /* exponent, so these are left to it.                                */
+    if (magnitude >= 1e-4) {
+        for (decimals = 1; decimals <= ATX_SHORTEST_MAX_DECIMALS; decimals++) {
+            double scaled = magnitude*ATX_PowersOf10[decimals];
+            double mantissa;
+            if (scaled >= 1e15) break;
+            mantissa = (double)(ATX_UInt64)(scaled+0.5);
+            if (mantissa/ATX_PowersOf10[decimals] == magnitude) {
+                return ATX_FormatDecimal((ATX_UInt64)mantissa, 
+                                         decimals, 
+                                         value < 0.0 ? ATX_TRUE : ATX_FALSE,
+                                         buffer, 
+                                         buffer_size);
+            }
+        }
+    }
+
+#if defined(ATX_CONFIG_HAVE_SNPRINTF)
+    {
+        /* 17 significant digits always round-trip, and any value with 
+           at most 15 significant digits is printed exactly by %.15g */
+        int precision = 17;
+        int length;
+#if defined(ATX_CONFIG_HAVE_STRTOD)
+        for (precision = 15; precision < 17; precision++) {
+            length = ATX_FormatStringN(buffer, buffer_size, "%.*g", precision, value);
+            if (length < 0 || (ATX_Size)length >= buffer_size) {
+                return ATX_ERROR_OUT_OF_RANGE;
+            }
+            if (strtod(buffer, NULL) == value) return ATX_SUCCESS;
+        }
+#endif
+        length = ATX_FormatStringN(buffer, buffer_size, "%.*g", precision, value);
+        if (length < 0 || (ATX_Size)length >= buffer_size) {
+            return ATX_ERROR_OUT_OF_RANGE;
+        }
+        return ATX_SUCCESS;
+    }
+#else
+    return ATX_DoubleToString(value, buffer, buffer_size);
+#endif
+}
+
 /*----------------------------------------------------------------------
 |   ATX_FloatToString
 +---------------------------------------------------------------------*/
@@ -619,6 +739,22 @@ ATX_IntegerToStringU(ATX_UInt64 value, char* buffer, ATX_Size buffer_size)
     return ATX_SUCCESS;
 }
 
+#if !defined(ATX_CONFIG_HAVE_MEMCHR)
+/*----------------------------------------------------------------------
+|    ATX_FindByte
++---------------------------------------------------------------------*/
+void*
+ATX_FindByte(const void* s, int c, ATX_Size size)
+{
+    const unsigned char* p = (const unsigned char*)s;
+    while (size--) {
+        if (*p == (unsigned char)c) return (void*)p;
+        ++p;
+    }
+    return NULL;
+}
+#endif
+
 #if !defined(ATX_CONFIG_HAVE_STRCPY)
 /*----------------------------------------------------------------------
 |    ATX_CopyString
@@ -725,8 +861,8 @@ ATX_HexString(const unsigned char* data,
     ATX_String_Reserve(&result, 2*data_size);
     
     /* build the string */
+    ATX_String_SetLength(&result, 2*data_size);
     dst = ATX_String_UseChars(&result);
-    dst[2*data_size] = '\0'; /* NULL terminate */
     while (data_size--) {
         ATX_ByteToHex(*src++, dst, uppercase);
         dst += 2;
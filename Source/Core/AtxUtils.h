@@ -133,6 +133,15 @@ ATX_FloatToString(float value, char* buffer, ATX_Size buffer_size);
 extern ATX_Result
 ATX_DoubleToString(double value, char* buffer, ATX_Size buffer_size);
 
+/**
+ * Format a double with the fewest significant digits that parse back
+ * to the same value (integers are formatted without a fraction, and
+ * negative zero as "-0"). For subnormal values the output may have a 
+ * few more digits than needed.
+ */
+extern ATX_Result
+ATX_DoubleToStringShortest(double value, char* buffer, ATX_Size buffer_size);
+
 extern ATX_Result
 ATX_IntegerToString(ATX_Int64 value, char* buffer, ATX_Size buffer_size);
 
@@ -200,6 +209,13 @@ void ATX_ScrubMemory(void* buffer, ATX_Size size);
 /*----------------------------------------------------------------------
 |    C Runtime
 +---------------------------------------------------------------------*/
+#if defined(ATX_CONFIG_ENABLE_ALLOCATOR_HOOKS)
+/* see ATX_SetAllocator */
+extern void* ATX_AllocateMemory(ATX_Size size);
+extern void* ATX_AllocateZeroMemory(ATX_Size size);
+extern void* ATX_ReallocateMemory(void* pointer, ATX_Size size);
+extern void  ATX_FreeMemory(void* pointer);
+#else
 #if defined(ATX_CONFIG_HAVE_MALLOC)
 #define ATX_AllocateMemory malloc
 #else
@@ -212,11 +228,18 @@ extern void* ATX_AllocateMemory(unsigned int);
 extern void* ATX_AllocateZeroMemory(unsigned int);
 #endif
 
+#if defined(ATX_CONFIG_HAVE_REALLOC)
+#define ATX_ReallocateMemory realloc
+#else
+extern void* ATX_ReallocateMemory(void* pointer, unsigned int);
+#endif
+
 #if defined(ATX_CONFIG_HAVE_FREE)
 #define ATX_FreeMemory free
 #else
 extern void ATX_FreeMemory(void* pointer);
 #endif
+#endif /* ATX_CONFIG_ENABLE_ALLOCATOR_HOOKS */
 
 #if defined(ATX_CONFIG_HAVE_MEMCPY)
 #define ATX_CopyMemory memcpy
@@ -242,6 +265,12 @@ extern void ATX_SetMemory(void* dest, int c, ATX_Size size);
 extern int ATX_CompareMemory(void* mem1, const void* mem2, ATX_Size size);
 #endif
     
+#if defined(ATX_CONFIG_HAVE_MEMCHR)
+#define ATX_FindByte(s, c, n) memchr((s), (c), (n))
+#else
+extern void* ATX_FindByte(const void* s, int c, ATX_Size size);
+#endif
+
 #if defined(ATX_CONFIG_HAVE_STRCPY)
 #define ATX_CopyString(dst, src) ((void)strcpy((dst), (src)))
 #else
@@ -274,7 +303,7 @@ extern int ATX_StringsEqualN(const char* s1, const char* s2, unsigned long size)
 extern int ATX_FindChar(const char* s, char c);
 #endif
 
-#if defined(ATX_CONFIG_HAVE_STRDUP)
+#if defined(ATX_CONFIG_HAVE_STRDUP) && !defined(ATX_CONFIG_ENABLE_ALLOCATOR_HOOKS)
 #define ATX_DuplicateString(s) ATX_strdup(s)
 #else
 extern char* ATX_DuplicateString(const char* s);
@@ -53,11 +53,12 @@
 |       types
 +---------------------------------------------------------------------*/
 typedef struct {
-    ATX_Cardinal  reference_count;
+    ATX_AtomicInt reference_count;
     int           fd;
     ATX_LargeSize size;
     ATX_Position  position;
     ATX_String    name;
+    ATX_Boolean   sync;
 } AndroidFileWrapper;
 
 typedef struct {
@@ -67,7 +68,7 @@ typedef struct {
     ATX_IMPLEMENTS(ATX_Referenceable);
 
     /* members */
-    ATX_Cardinal     reference_count;
+    ATX_AtomicInt    reference_count;
     AndroidFileWrapper* file;
 } AndroidFileStream;
 
@@ -116,7 +117,7 @@ AndroidFileWrapper_Create(int               fd,
     (*wrapper)->fd              = fd;
     (*wrapper)->size            = 0;
     (*wrapper)->position        = 0;
-    (*wrapper)->reference_count = 1;
+    ATX_AtomicInt_Set(&(*wrapper)->reference_count, 1);
     if (name) {
         ATX_String_Copy(&(*wrapper)->name, name);
     }
@@ -168,7 +169,7 @@ AndroidFileWrapper_Destroy(AndroidFileWrapper* self)
 static void
 AndroidFileWrapper_AddReference(AndroidFileWrapper* self)
 {
-    ++self->reference_count;
+    ATX_ATOMIC_INCREMENT(&self->reference_count);
 }
 
 /*----------------------------------------------------------------------
@@ -178,7 +179,7 @@ static void
 AndroidFileWrapper_Release(AndroidFileWrapper* self)
 {
     if (self == NULL) return;
-    if (--self->reference_count == 0) {
+    if (ATX_ATOMIC_DECREMENT(&self->reference_count) == 0) {
         AndroidFileWrapper_Destroy(self);
     }
 }
@@ -201,7 +202,7 @@ AndroidFileStream_Create(AndroidFileWrapper* file, AndroidFileStream** stream)
     if (*stream == NULL) return ATX_ERROR_OUT_OF_MEMORY;
 
     /* construct the object */
-    (*stream)->reference_count = 1;
+    ATX_AtomicInt_Set(&(*stream)->reference_count, 1);
     (*stream)->file = file;
 
     /* keep a reference */
@@ -258,7 +259,10 @@ AndroidFileStream_Tell(AndroidFileStream* self, ATX_Position* where)
 ATX_METHOD
 AndroidFileStream_Flush(AndroidFileStream* self)
 {
-    ATX_COMPILER_UNUSED(self);
+    /* writes are not buffered, so there's only something to do in sync mode */
+    if (self->file->sync && fdatasync(self->file->fd) != 0) {
+        return MapErrno(errno);
+    }
     return ATX_SUCCESS;
 }
 
@@ -487,7 +491,7 @@ ATX_END_INTERFACE_MAP
 /*----------------------------------------------------------------------
 |       ATX_Referenceable interface
 +---------------------------------------------------------------------*/
-ATX_IMPLEMENT_REFERENCEABLE_INTERFACE(AndroidFileStream, reference_count)
+ATX_IMPLEMENT_ATOMIC_REFERENCEABLE_INTERFACE(AndroidFileStream, reference_count)
 
 /*----------------------------------------------------------------------
 |       forward declarations
@@ -521,6 +525,26 @@ ATX_File_Create(const char* filename, ATX_File** object)
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|       ATX_File_Rename
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_File_Rename(const char* old_name, const char* new_name)
+{
+    if (rename(old_name, new_name) != 0) return MapErrno(errno);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|       ATX_File_Remove
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_File_Remove(const char* name)
+{
+    if (unlink(name) != 0) return MapErrno(errno);
+    return ATX_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
 |       AndroidFile_Destroy
 +---------------------------------------------------------------------*/
@@ -597,7 +621,10 @@ AndroidFile_Open(ATX_File* _self, ATX_Flags mode)
     self->mode = mode;
 
     /* create a wrapper */
-    return AndroidFileWrapper_Create(fd, &self->name, &self->file);
+    ATX_CHECK(AndroidFileWrapper_Create(fd, &self->name, &self->file));
+    self->file->sync = (mode & ATX_FILE_OPEN_MODE_SYNC) ? ATX_TRUE : ATX_FALSE;
+
+    return ATX_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
@@ -32,6 +32,12 @@
 /*----------------------------------------------------------------------
 |   includes
 +---------------------------------------------------------------------*/
+#if defined(__linux__)
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* for recvmmsg and sendmmsg */
+#endif
+#define _FILE_OFFSET_BITS 64 /* for sendfile on large files */
+#endif
 #include "AtxConfig.h"
 
 #if defined(_WIN32) || defined(_WIN32_WCE)
@@ -74,6 +80,19 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdio.h>
+#if defined(ATX_CONFIG_HAVE_EPOLL) && !defined(ATX_CONFIG_DISABLE_EPOLL)
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+#if defined(ATX_CONFIG_HAVE_EVENTFD)
+#include <sys/eventfd.h>
+#endif
+#if defined(ATX_CONFIG_HAVE_SENDFILE)
+#include <sys/sendfile.h>
+#include <signal.h>
+#include <pthread.h>
+#endif
 
 #endif
 
@@ -88,11 +107,23 @@
 #include "AtxSockets.h"
 #include "AtxUtils.h"
 #include "AtxLogging.h"
+#include "AtxThreads.h"
+#include "AtxSystem.h"
 
 /*----------------------------------------------------------------------
 |   constants
 +---------------------------------------------------------------------*/
 #define ATX_TCP_SERVER_SOCKET_DEFAULT_LISTEN_COUNT  20
+#define ATX_EVENT_LOOP_MAX_EVENTS_PER_WAIT          256
+#define ATX_UDP_SOCKET_MAX_BATCH_SIZE               64
+#define ATX_SOCKET_STREAM_MAX_TRANSFER_CHUNK        0x1000000
+
+/* writing to a connection closed by the peer should fail, not raise SIGPIPE */
+#if defined(MSG_NOSIGNAL)
+#define ATX_BSD_SOCKET_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define ATX_BSD_SOCKET_SEND_FLAGS 0
+#endif
 
 /*----------------------------------------------------------------------
 |   WinSock adaptation layer
@@ -134,6 +165,12 @@
 #if !defined(EINTR)
 #define EINTR        WSAEINTR
 #endif
+#if !defined(EALREADY)
+#define EALREADY     WSAEALREADY
+#endif
+#if !defined(EISCONN)
+#define EISCONN      WSAEISCONN
+#endif
 #if !defined(__MINGW32__)
 typedef int          ssize_t;
 #endif
@@ -164,6 +201,8 @@ typedef SOCKET       SocketFd;
 #undef EAGAIN        
 #undef EINTR      
 #undef EINPROGRESS
+#undef EALREADY
+#undef EISCONN
 
 #define EWOULDBLOCK   SYS_NET_EWOULDBLOCK 
 #define ECONNREFUSED  SYS_NET_ECONNREFUSED
@@ -177,6 +216,8 @@ typedef SOCKET       SocketFd;
 #define EAGAIN        SYS_NET_EAGAIN
 #define EINTR         SYS_NET_EINTR
 #define EINPROGRESS   SYS_NET_EINPROGRESS
+#define EALREADY      SYS_NET_EALREADY
+#define EISCONN       SYS_NET_EISCONN
 
 typedef void*        SocketBuffer;
 typedef const void*  SocketConstBuffer;
@@ -214,24 +255,27 @@ typedef int          SocketFd;
 |   types
 +---------------------------------------------------------------------*/
 typedef struct {
-    ATX_Cardinal reference_count;
-    SocketFd     fd;
+    ATX_AtomicInt reference_count;
+    SocketFd      fd;
+    ATX_Boolean   non_blocking;
 } BsdSocketFdWrapper;
 
 typedef struct {
     /* interfaces */
     ATX_IMPLEMENTS(ATX_InputStream);
     ATX_IMPLEMENTS(ATX_OutputStream);
+    ATX_IMPLEMENTS(ATX_StreamTransfer);
     ATX_IMPLEMENTS(ATX_Referenceable);
     
     /* members */
-    ATX_Cardinal        reference_count;
+    ATX_AtomicInt       reference_count;
     BsdSocketFdWrapper* socket_ref;
 } BsdSocketStream;
 
 typedef struct {
     /* interfaces */
     ATX_IMPLEMENTS(ATX_Socket);
+    ATX_IMPLEMENTS(ATX_SelectableSocket);
     ATX_IMPLEMENTS(ATX_Destroyable);
 
     BsdSocketFdWrapper* socket_ref;
@@ -482,7 +526,7 @@ BsdSocketFdWrapper_Create(SocketFd fd, BsdSocketFdWrapper** wrapper)
 
     /* construct the object */
     (*wrapper)->fd = fd;
-    (*wrapper)->reference_count = 1;
+    ATX_AtomicInt_Set(&(*wrapper)->reference_count, 1);
 
     return ATX_SUCCESS;
 }
@@ -503,7 +547,7 @@ BsdSocketFdWrapper_Destroy(BsdSocketFdWrapper* self)
 static void
 BsdSocketFdWrapper_AddReference(BsdSocketFdWrapper* self)
 {
-    ++self->reference_count;
+    ATX_ATOMIC_INCREMENT(&self->reference_count);
 }
 
 /*----------------------------------------------------------------------
@@ -513,7 +557,7 @@ static void
 BsdSocketFdWrapper_Release(BsdSocketFdWrapper* self)
 {
     if (self == NULL) return;
-    if (--self->reference_count == 0) {
+    if (ATX_ATOMIC_DECREMENT(&self->reference_count) == 0) {
         BsdSocketFdWrapper_Destroy(self);
     }
 }
@@ -529,7 +573,7 @@ BsdSocketStream_Create(BsdSocketFdWrapper* socket_ref, BsdSocketStream** stream)
     if (*stream == NULL) return ATX_ERROR_OUT_OF_MEMORY;
 
     /* construct the object */
-    (*stream)->reference_count = 1;
+    ATX_AtomicInt_Set(&(*stream)->reference_count, 1);
     (*stream)->socket_ref = socket_ref;
 
     /* keep a reference */
@@ -543,6 +587,7 @@ BsdSocketStream_Create(BsdSocketFdWrapper* socket_ref, BsdSocketStream** stream)
 +---------------------------------------------------------------------*/
 ATX_DECLARE_INTERFACE_MAP(BsdSocketStream, ATX_InputStream)
 ATX_DECLARE_INTERFACE_MAP(BsdSocketStream, ATX_OutputStream)
+ATX_DECLARE_INTERFACE_MAP(BsdSocketStream, ATX_StreamTransfer)
 ATX_DECLARE_INTERFACE_MAP(BsdSocketStream, ATX_Referenceable)
 
 /*----------------------------------------------------------------------
@@ -565,6 +610,7 @@ BsdSocketInputStream_Create(BsdSocketFdWrapper* socket_ref,
     /* setup the interfaces */
     ATX_SET_INTERFACE(socket_stream, BsdSocketStream, ATX_InputStream);
     ATX_SET_INTERFACE(socket_stream, BsdSocketStream, ATX_OutputStream);
+    ATX_SET_INTERFACE(socket_stream, BsdSocketStream, ATX_StreamTransfer);
     ATX_SET_INTERFACE(socket_stream, BsdSocketStream, ATX_Referenceable);
     *stream = &ATX_BASE(socket_stream, ATX_InputStream);
 
@@ -591,6 +637,7 @@ BsdSocketOutputStream_Create(BsdSocketFdWrapper* socket_ref,
     /* set the interface */
     ATX_SET_INTERFACE(socket_stream, BsdSocketStream, ATX_InputStream);
     ATX_SET_INTERFACE(socket_stream, BsdSocketStream, ATX_OutputStream);
+    ATX_SET_INTERFACE(socket_stream, BsdSocketStream, ATX_StreamTransfer);
     ATX_SET_INTERFACE(socket_stream, BsdSocketStream, ATX_Referenceable);
     *stream = &ATX_BASE(socket_stream, ATX_OutputStream);
 
@@ -636,6 +683,11 @@ BsdSocketStream_Read(ATX_InputStream* _self,
                 return ATX_ERROR_EOS;
             } else {
                 int error = GetSocketError();
+                if (self->socket_ref->non_blocking &&
+                    MapErrorCode(error) == ATX_ERROR_WOULD_BLOCK) {
+                    return ATX_ERROR_WOULD_BLOCK;
+                }
+
                 /* on linux, EAGAIN can be returned for UDP sockets */
                 /* when the checksum fails                          */
                 if (error == EAGAIN) {
@@ -669,7 +721,7 @@ BsdSocketStream_Write(ATX_OutputStream* _self,
     nb_written = send(self->socket_ref->fd, 
                       (SocketConstBuffer)buffer, 
                       (ssize_t)bytes_to_write, 
-                      0);
+                      ATX_BSD_SOCKET_SEND_FLAGS);
 
     if (nb_written > 0) {
         if (bytes_written) *bytes_written = (ATX_Size)nb_written;
@@ -679,11 +731,100 @@ BsdSocketStream_Write(ATX_OutputStream* _self,
         if (nb_written == 0) {
             return ATX_ERROR_DISCONNECTED;
         } else {
+            if (self->socket_ref->non_blocking &&
+                MapErrorCode(GetSocketError()) == ATX_ERROR_WOULD_BLOCK) {
+                return ATX_ERROR_WOULD_BLOCK;
+            }
             return ATX_FAILURE;
         }
     }
 }
 
+/*----------------------------------------------------------------------
+|   BsdSocketStream_TransferFrom
++---------------------------------------------------------------------*/
+ATX_METHOD
+BsdSocketStream_TransferFrom(ATX_StreamTransfer* _self,
+                             ATX_InputStream*    source,
+                             ATX_LargeSize       size,
+                             ATX_LargeSize*      bytes_transferred)
+{
+#if defined(ATX_CONFIG_HAVE_SENDFILE)
+    BsdSocketStream*      self = ATX_SELF(BsdSocketStream, ATX_StreamTransfer);
+    ATX_StreamDescriptor* descriptor = ATX_CAST(source, ATX_StreamDescriptor);
+    ATX_IntPtr            fd;
+    ATX_Position          position;
+    off_t                 offset;
+    ATX_LargeSize         total = 0;
+    ATX_Result            result = ATX_SUCCESS;
+    sigset_t              sigpipe_set;
+    sigset_t              saved_set;
+    sigset_t              pending_set;
+    ATX_Boolean           sigpipe_was_pending;
+
+    *bytes_transferred = 0;
+    if (descriptor == NULL ||
+        ATX_FAILED(ATX_StreamDescriptor_GetDescriptor(descriptor, &fd)) ||
+        ATX_FAILED(ATX_InputStream_Tell(source, &position))) {
+        return ATX_ERROR_NOT_SUPPORTED;
+    }
+    offset = (off_t)position;
+
+    /* sendfile has no MSG_NOSIGNAL, so keep SIGPIPE blocked on this  */
+    /* thread while sending, and discard the one raised by a closed peer */
+    sigemptyset(&sigpipe_set);
+    sigaddset(&sigpipe_set, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &sigpipe_set, &saved_set);
+    sigpending(&pending_set);
+    sigpipe_was_pending = sigismember(&pending_set, SIGPIPE) ? ATX_TRUE : ATX_FALSE;
+
+    while (size == 0 || total < size) {
+        size_t  chunk = ATX_SOCKET_STREAM_MAX_TRANSFER_CHUNK;
+        ssize_t nb_sent;
+        int     error;
+
+        if (size && size-total < chunk) chunk = (size_t)(size-total);
+        nb_sent = sendfile(self->socket_ref->fd, (int)fd, &offset, chunk);
+        if (nb_sent > 0) {
+            total += nb_sent;
+            continue;
+        } 
+        if (nb_sent == 0) break; /* end of the file */
+
+        error = errno;
+        if (error == EINTR) continue;
+        if (total == 0 && (error == EINVAL || error == ENOSYS)) {
+            /* not a file that can be sent this way (a pipe, for example) */
+            result = ATX_ERROR_NOT_SUPPORTED;
+        } else if (self->socket_ref->non_blocking && 
+                   MapErrorCode(error) == ATX_ERROR_WOULD_BLOCK) {
+            result = ATX_ERROR_WOULD_BLOCK;
+        } else {
+            if (error == EPIPE && !sigpipe_was_pending) {
+                struct timespec no_wait = {0, 0};
+                sigtimedwait(&sigpipe_set, NULL, &no_wait);
+            }
+            result = ATX_FAILURE;
+        }
+        break;
+    }
+    pthread_sigmask(SIG_SETMASK, &saved_set, NULL);
+
+    /* move the source past what was sent */
+    if (total) ATX_InputStream_Seek(source, position+total);
+
+    *bytes_transferred = total;
+    return result;
+#else
+    ATX_COMPILER_UNUSED(_self);
+    ATX_COMPILER_UNUSED(source);
+    ATX_COMPILER_UNUSED(size);
+
+    *bytes_transferred = 0;
+    return ATX_ERROR_NOT_SUPPORTED;
+#endif
+}
+
 /*----------------------------------------------------------------------
 |   BsdSocketInputStream_Seek
 +---------------------------------------------------------------------*/
@@ -800,6 +941,7 @@ BsdSocketOutputStream_Flush(ATX_OutputStream* self)
 ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(BsdSocketStream)
     ATX_GET_INTERFACE_ACCEPT(BsdSocketStream, ATX_InputStream)
     ATX_GET_INTERFACE_ACCEPT(BsdSocketStream, ATX_OutputStream)
+    ATX_GET_INTERFACE_ACCEPT(BsdSocketStream, ATX_StreamTransfer)
     ATX_GET_INTERFACE_ACCEPT(BsdSocketStream, ATX_Referenceable)
 ATX_END_GET_INTERFACE_IMPLEMENTATION
 
@@ -824,15 +966,23 @@ ATX_BEGIN_INTERFACE_MAP(BsdSocketStream, ATX_OutputStream)
     BsdSocketOutputStream_Flush
 ATX_END_INTERFACE_MAP
 
+/*----------------------------------------------------------------------
+|   ATX_StreamTransfer interface
++---------------------------------------------------------------------*/
+ATX_BEGIN_INTERFACE_MAP(BsdSocketStream, ATX_StreamTransfer)
+    BsdSocketStream_TransferFrom
+ATX_END_INTERFACE_MAP
+
 /*----------------------------------------------------------------------
 |   ATX_Referenceable interface
 +---------------------------------------------------------------------*/
-ATX_IMPLEMENT_REFERENCEABLE_INTERFACE(BsdSocketStream, reference_count)
+ATX_IMPLEMENT_ATOMIC_REFERENCEABLE_INTERFACE(BsdSocketStream, reference_count)
 
 /*----------------------------------------------------------------------
 |   forward declarations
 +---------------------------------------------------------------------*/
 ATX_DECLARE_INTERFACE_MAP(BsdSocket, ATX_Socket)
+ATX_DECLARE_INTERFACE_MAP(BsdSocket, ATX_SelectableSocket)
 ATX_DECLARE_INTERFACE_MAP(BsdSocket, ATX_Destroyable)
 static ATX_Result BsdSocket_RefreshInfo(BsdSocket* self);
 
@@ -853,6 +1003,7 @@ BsdSocket_Construct(BsdSocket* self, SocketFd fd)
 
     /* setup the interfaces */
     ATX_SET_INTERFACE(self, BsdSocket, ATX_Socket);
+    ATX_SET_INTERFACE(self, BsdSocket, ATX_SelectableSocket);
     ATX_SET_INTERFACE(self, BsdSocket, ATX_Destroyable);
 
     return ATX_SUCCESS;
@@ -1070,11 +1221,37 @@ BsdSocket_GetInfo(ATX_Socket* _self, ATX_SocketInfo* info)
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|   BsdSocket_GetFd
++---------------------------------------------------------------------*/
+static ATX_SocketFd
+BsdSocket_GetFd(ATX_SelectableSocket* _self)
+{
+    BsdSocket* self = ATX_SELF(BsdSocket, ATX_SelectableSocket);
+
+    return (ATX_SocketFd)self->socket_ref->fd;
+}
+
+/*----------------------------------------------------------------------
+|   BsdSocket_SetBlocking
++---------------------------------------------------------------------*/
+ATX_METHOD
+BsdSocket_SetBlocking(ATX_SelectableSocket* _self, ATX_Boolean blocking)
+{
+    BsdSocket* self = ATX_SELF(BsdSocket, ATX_SelectableSocket);
+
+    ATX_CHECK(BsdSocket_SetBlockingMode(self, blocking));
+    self->socket_ref->non_blocking = blocking ? ATX_FALSE : ATX_TRUE;
+
+    return ATX_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
 |   BsdSocket_GetInterface
 +---------------------------------------------------------------------*/
 ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(BsdSocket)
     ATX_GET_INTERFACE_ACCEPT(BsdSocket, ATX_Socket)
+    ATX_GET_INTERFACE_ACCEPT(BsdSocket, ATX_SelectableSocket)
     ATX_GET_INTERFACE_ACCEPT(BsdSocket, ATX_Destroyable)
 ATX_END_GET_INTERFACE_IMPLEMENTATION
 
@@ -1089,6 +1266,14 @@ ATX_BEGIN_INTERFACE_MAP(BsdSocket, ATX_Socket)
     BsdSocket_GetInfo
 ATX_END_INTERFACE_MAP
 
+/*----------------------------------------------------------------------
+|   ATX_SelectableSocket interface
++---------------------------------------------------------------------*/
+ATX_BEGIN_INTERFACE_MAP(BsdSocket, ATX_SelectableSocket)
+    BsdSocket_GetFd,
+    BsdSocket_SetBlocking
+ATX_END_INTERFACE_MAP
+
 /*----------------------------------------------------------------------
 |   ATX_Destroyable interface
 +---------------------------------------------------------------------*/
@@ -1100,6 +1285,7 @@ ATX_IMPLEMENT_DESTROYABLE_INTERFACE(BsdSocket)
 ATX_DECLARE_INTERFACE_MAP(BsdUdpSocket, ATX_DatagramSocket)
 ATX_DECLARE_INTERFACE_MAP(BsdUdpSocket, ATX_MulticastSocket)
 ATX_DECLARE_INTERFACE_MAP(BsdUdpSocket, ATX_Socket)
+ATX_DECLARE_INTERFACE_MAP(BsdUdpSocket, ATX_SelectableSocket)
 ATX_DECLARE_INTERFACE_MAP(BsdUdpSocket, ATX_Destroyable)
 
 /*----------------------------------------------------------------------
@@ -1137,6 +1323,7 @@ ATX_UdpSocket_Create(ATX_DatagramSocket** object)
     ATX_SET_INTERFACE(udp_socket, BsdUdpSocket, ATX_DatagramSocket);
     ATX_SET_INTERFACE(udp_socket, BsdUdpSocket, ATX_MulticastSocket);
     ATX_SET_INTERFACE_EX(udp_socket, BsdUdpSocket, BsdSocket, ATX_Socket);
+    ATX_SET_INTERFACE_EX(udp_socket, BsdUdpSocket, BsdSocket, ATX_SelectableSocket);
     ATX_SET_INTERFACE_EX(udp_socket, BsdUdpSocket, BsdSocket, ATX_Destroyable);
     *object = &ATX_BASE(udp_socket, ATX_DatagramSocket);
 
@@ -1185,15 +1372,14 @@ BsdUdpSocket_Connect(ATX_Socket*              _self,
 }
 
 /*----------------------------------------------------------------------
-|   BsdUdpSocket_Send
+|   BsdUdpSocket_SendOne
 +---------------------------------------------------------------------*/
-ATX_METHOD 
-BsdUdpSocket_Send(ATX_DatagramSocket*      _self,
-                  const ATX_DataBuffer*    packet, 
-                  const ATX_SocketAddress* address) 
+static ATX_Result 
+BsdUdpSocket_SendOne(BsdUdpSocket*            self,
+                     const ATX_DataBuffer*    packet, 
+                     const ATX_SocketAddress* address) 
 {
-    BsdUdpSocket* self = ATX_SELF(BsdUdpSocket, ATX_DatagramSocket);
-    ssize_t       io_result;
+    ssize_t io_result;
 
     /* get the packet buffer */
     const ATX_Byte* buffer        = ATX_DataBuffer_GetData(packet);
@@ -1222,6 +1408,10 @@ BsdUdpSocket_Send(ATX_DatagramSocket*      _self,
 
     /* check the result */
     if (ATX_BSD_SOCKET_CALL_FAILED(io_result)) {
+        if (ATX_BASE(self, BsdSocket).socket_ref->non_blocking &&
+            MapErrorCode(GetSocketError()) == ATX_ERROR_WOULD_BLOCK) {
+            return ATX_ERROR_WOULD_BLOCK;
+        }
         return ATX_FAILURE;
     }
 
@@ -1229,15 +1419,28 @@ BsdUdpSocket_Send(ATX_DatagramSocket*      _self,
 }
 
 /*----------------------------------------------------------------------
-|   BsdUdpSocket_Receive
+|   BsdUdpSocket_Send
 +---------------------------------------------------------------------*/
 ATX_METHOD 
-BsdUdpSocket_Receive(ATX_DatagramSocket* _self,
-                     ATX_DataBuffer*     packet, 
-                     ATX_SocketAddress*  address)
+BsdUdpSocket_Send(ATX_DatagramSocket*      _self,
+                  const ATX_DataBuffer*    packet, 
+                  const ATX_SocketAddress* address) 
 {
-    BsdUdpSocket* self = ATX_SELF(BsdUdpSocket, ATX_DatagramSocket);
-    ssize_t       io_result;
+    return BsdUdpSocket_SendOne(ATX_SELF(BsdUdpSocket, ATX_DatagramSocket),
+                                packet,
+                                address);
+}
+
+/*----------------------------------------------------------------------
+|   BsdUdpSocket_ReceiveOne
++---------------------------------------------------------------------*/
+static ATX_Result 
+BsdUdpSocket_ReceiveOne(BsdUdpSocket*      self,
+                        ATX_DataBuffer*    packet, 
+                        ATX_SocketAddress* address,
+                        int                flags)
+{
+    ssize_t io_result;
 
     /* get the packet buffer */
     ATX_Byte* buffer        = ATX_DataBuffer_UseData(packet);
@@ -1255,7 +1458,7 @@ BsdUdpSocket_Receive(ATX_DatagramSocket* _self,
         io_result = recvfrom(ATX_BASE(self, BsdSocket).socket_ref->fd, 
                              (SocketBuffer)buffer, 
                              buffer_length, 
-                             0, 
+                             flags, 
                              (struct sockaddr *)&inet_address, 
                              &inet_address_length);
 
@@ -1269,19 +1472,200 @@ BsdUdpSocket_Receive(ATX_DatagramSocket* _self,
         io_result = recv(ATX_BASE(self, BsdSocket).socket_ref->fd,
                          (SocketBuffer)buffer,
                          buffer_length,
-                         0);
+                         flags);
     }
 
     /* check the result */
     if (ATX_BSD_SOCKET_CALL_FAILED(io_result)) {
         ATX_DataBuffer_SetDataSize(packet, 0);
-        return MapErrorCode((int)io_result);
+        return MapErrorCode(GetSocketError());
     }
 
     ATX_DataBuffer_SetDataSize(packet, (ATX_Size)io_result);
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|   BsdUdpSocket_Receive
++---------------------------------------------------------------------*/
+ATX_METHOD 
+BsdUdpSocket_Receive(ATX_DatagramSocket* _self,
+                     ATX_DataBuffer*     packet, 
+                     ATX_SocketAddress*  address)
+{
+    return BsdUdpSocket_ReceiveOne(ATX_SELF(BsdUdpSocket, ATX_DatagramSocket),
+                                   packet,
+                                   address,
+                                   0);
+}
+
+/*----------------------------------------------------------------------
+|   BsdUdpSocket_SendMany
++---------------------------------------------------------------------*/
+ATX_METHOD 
+BsdUdpSocket_SendMany(ATX_DatagramSocket*      _self,
+                      ATX_DataBuffer* const*   packets,
+                      const ATX_SocketAddress* addresses,
+                      ATX_Cardinal             count,
+                      ATX_Cardinal*            sent)
+{
+    BsdUdpSocket* self = ATX_SELF(BsdUdpSocket, ATX_DatagramSocket);
+    ATX_Cardinal  done = 0;
+
+    *sent = 0;
+    if (count == 0) return ATX_ERROR_INVALID_PARAMETERS;
+
+#if defined(ATX_CONFIG_HAVE_SENDMMSG)
+    while (done < count) {
+        struct mmsghdr     messages[ATX_UDP_SOCKET_MAX_BATCH_SIZE];
+        struct iovec       vectors[ATX_UDP_SOCKET_MAX_BATCH_SIZE];
+        struct sockaddr_in inet_addresses[ATX_UDP_SOCKET_MAX_BATCH_SIZE];
+        ATX_Cardinal       batch = count-done;
+        ATX_Cardinal       i;
+        int                io_result;
+
+        if (batch > ATX_UDP_SOCKET_MAX_BATCH_SIZE) batch = ATX_UDP_SOCKET_MAX_BATCH_SIZE;
+        ATX_SetMemory(messages, 0, batch*sizeof(messages[0]));
+        for (i=0; i<batch; i++) {
+            const ATX_DataBuffer* packet = packets[done+i];
+            vectors[i].iov_base = (void*)ATX_DataBuffer_GetData(packet);
+            vectors[i].iov_len  = ATX_DataBuffer_GetDataSize(packet);
+            messages[i].msg_hdr.msg_iov    = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            if (addresses) {
+                SocketAddressToInetAddress(&addresses[done+i], &inet_addresses[i]);
+                messages[i].msg_hdr.msg_name    = &inet_addresses[i];
+                messages[i].msg_hdr.msg_namelen = sizeof(inet_addresses[i]);
+            }
+        }
+
+        io_result = sendmmsg(ATX_BASE(self, BsdSocket).socket_ref->fd, 
+                             messages, 
+                             batch, 
+                             0);
+        if (io_result < 0) {
+            /* report the failure with the next call if some were sent */
+            if (done) break;
+            if (ATX_BASE(self, BsdSocket).socket_ref->non_blocking &&
+                MapErrorCode(GetSocketError()) == ATX_ERROR_WOULD_BLOCK) {
+                return ATX_ERROR_WOULD_BLOCK;
+            }
+            return ATX_FAILURE;
+        }
+        done += (ATX_Cardinal)io_result;
+        if ((ATX_Cardinal)io_result < batch) break;
+    }
+#else
+    for (; done < count; done++) {
+        ATX_Result result = BsdUdpSocket_SendOne(self, 
+                                                 packets[done], 
+                                                 addresses?&addresses[done]:NULL);
+        if (ATX_FAILED(result)) {
+            if (done == 0) return result;
+            break;
+        }
+    }
+#endif
+
+    *sent = done;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   BsdUdpSocket_ReceiveMany
++---------------------------------------------------------------------*/
+ATX_METHOD 
+BsdUdpSocket_ReceiveMany(ATX_DatagramSocket*    _self,
+                         ATX_DataBuffer* const* packets,
+                         ATX_SocketAddress*     addresses,
+                         ATX_Cardinal           count,
+                         ATX_Cardinal*          received)
+{
+    BsdUdpSocket* self = ATX_SELF(BsdUdpSocket, ATX_DatagramSocket);
+    ATX_Cardinal  done = 0;
+
+    *received = 0;
+    if (count == 0) return ATX_ERROR_INVALID_PARAMETERS;
+
+#if defined(ATX_CONFIG_HAVE_RECVMMSG)
+    {
+        /* wait for the first datagram only */
+        int flags = MSG_WAITFORONE;
+        while (done < count) {
+            struct mmsghdr     messages[ATX_UDP_SOCKET_MAX_BATCH_SIZE];
+            struct iovec       vectors[ATX_UDP_SOCKET_MAX_BATCH_SIZE];
+            struct sockaddr_in inet_addresses[ATX_UDP_SOCKET_MAX_BATCH_SIZE];
+            ATX_Cardinal       batch = count-done;
+            ATX_Cardinal       i;
+            int                io_result;
+
+            if (batch > ATX_UDP_SOCKET_MAX_BATCH_SIZE) batch = ATX_UDP_SOCKET_MAX_BATCH_SIZE;
+            ATX_SetMemory(messages, 0, batch*sizeof(messages[0]));
+            for (i=0; i<batch; i++) {
+                ATX_DataBuffer* packet = packets[done+i];
+                vectors[i].iov_base = ATX_DataBuffer_UseData(packet);
+                vectors[i].iov_len  = ATX_DataBuffer_GetBufferSize(packet);
+                if (vectors[i].iov_len == 0) return ATX_ERROR_INVALID_PARAMETERS;
+                messages[i].msg_hdr.msg_iov    = &vectors[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+                if (addresses) {
+                    messages[i].msg_hdr.msg_name    = &inet_addresses[i];
+                    messages[i].msg_hdr.msg_namelen = sizeof(inet_addresses[i]);
+                }
+            }
+
+            io_result = recvmmsg(ATX_BASE(self, BsdSocket).socket_ref->fd, 
+                                 messages, 
+                                 batch, 
+                                 flags, 
+                                 NULL);
+            if (io_result < 0) {
+                /* report the failure with the next call if some were received */
+                if (done) break;
+                ATX_DataBuffer_SetDataSize(packets[0], 0);
+                return MapErrorCode(GetSocketError());
+            }
+
+            for (i=0; i<(ATX_Cardinal)io_result; i++) {
+                ATX_DataBuffer_SetDataSize(packets[done+i], messages[i].msg_len);
+                if (addresses && 
+                    messages[i].msg_hdr.msg_namelen == sizeof(inet_addresses[i])) {
+                    InetAddressToSocketAddress(&inet_addresses[i], &addresses[done+i]);
+                }
+            }
+            done += (ATX_Cardinal)io_result;
+            if ((ATX_Cardinal)io_result < batch) break;
+            flags = MSG_DONTWAIT;
+        }
+    }
+#else
+    {
+        /* wait for the first datagram */
+        ATX_Result result = BsdUdpSocket_ReceiveOne(self, 
+                                                    packets[0], 
+                                                    addresses?&addresses[0]:NULL, 
+                                                    0);
+        if (ATX_FAILED(result)) return result;
+        done = 1;
+    }
+
+#if defined(MSG_DONTWAIT)
+    /* take the ones that are already queued */
+    for (; done < count; done++) {
+        if (ATX_FAILED(BsdUdpSocket_ReceiveOne(self, 
+                                               packets[done], 
+                                               addresses?&addresses[done]:NULL, 
+                                               MSG_DONTWAIT))) {
+            break;
+        }
+    }
+#endif
+#endif
+
+    *received = done;
+    return ATX_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
 |   BsdUdpSocket_JoinGroup
 +---------------------------------------------------------------------*/
@@ -1404,6 +1788,7 @@ BsdUdpSocket_SetInterface(ATX_MulticastSocket* _self, const ATX_IpAddress* iface
 +---------------------------------------------------------------------*/
 ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(BsdUdpSocket)
     ATX_GET_INTERFACE_ACCEPT_EX(BsdUdpSocket, BsdSocket, ATX_Socket)
+    ATX_GET_INTERFACE_ACCEPT_EX(BsdUdpSocket, BsdSocket, ATX_SelectableSocket)
     ATX_GET_INTERFACE_ACCEPT_EX(BsdUdpSocket, BsdSocket, ATX_Destroyable)
     ATX_GET_INTERFACE_ACCEPT(BsdUdpSocket, ATX_DatagramSocket)
     ATX_GET_INTERFACE_ACCEPT(BsdUdpSocket, ATX_MulticastSocket)
@@ -1422,12 +1807,24 @@ ATX_INTERFACE_MAP(BsdUdpSocket, ATX_Socket) = {
     BsdSocket_GetInfo
 };
 
+/*----------------------------------------------------------------------
+|   ATX_SelectableSocket interface
++---------------------------------------------------------------------*/
+ATX_IMPLEMENT_GET_INTERFACE_ADAPTER_EX(BsdUdpSocket, BsdSocket, ATX_SelectableSocket)
+ATX_INTERFACE_MAP(BsdUdpSocket, ATX_SelectableSocket) = {
+    BsdUdpSocket_ATX_SelectableSocket_GetInterface,
+    BsdSocket_GetFd,
+    BsdSocket_SetBlocking
+};
+
 /*----------------------------------------------------------------------
 |   ATX_DatagramSocket interface
 +---------------------------------------------------------------------*/
 ATX_BEGIN_INTERFACE_MAP(BsdUdpSocket, ATX_DatagramSocket)
     BsdUdpSocket_Send,
-    BsdUdpSocket_Receive
+    BsdUdpSocket_Receive,
+    BsdUdpSocket_SendMany,
+    BsdUdpSocket_ReceiveMany
 ATX_END_INTERFACE_MAP
 
 /*----------------------------------------------------------------------
@@ -1453,6 +1850,7 @@ ATX_INTERFACE_MAP(BsdUdpSocket, ATX_Destroyable) = {
 |   forward declarations
 +---------------------------------------------------------------------*/
 ATX_DECLARE_INTERFACE_MAP(BsdTcpClientSocket, ATX_Socket)
+ATX_DECLARE_INTERFACE_MAP(BsdTcpClientSocket, ATX_SelectableSocket)
 ATX_DECLARE_INTERFACE_MAP(BsdTcpClientSocket, ATX_Destroyable)
 
 /*----------------------------------------------------------------------
@@ -1478,6 +1876,7 @@ ATX_TcpClientSocket_Create(ATX_Socket** object)
 
     /* setup the interfaces */
     ATX_SET_INTERFACE(client, BsdTcpClientSocket, ATX_Socket);
+    ATX_SET_INTERFACE(client, BsdTcpClientSocket, ATX_SelectableSocket);
     ATX_SET_INTERFACE(client, BsdTcpClientSocket, ATX_Destroyable);
     *object = &ATX_BASE(client, ATX_Socket);
 
@@ -1501,14 +1900,28 @@ BsdTcpClientSocket_Connect(ATX_Socket*              _self,
     fd_set             except_set;
     struct timeval     timeout_value;
 
+    /* convert the address */
+    SocketAddressToInetAddress(address, &inet_address);
+
+    /* non-blocking sockets: start or complete the connection, but don't wait */
+    if (self->socket_ref->non_blocking) {
+        io_result = connect(socket_fd, 
+                            (struct sockaddr *)&inet_address, 
+                            sizeof(inet_address));
+        if (ATX_BSD_SOCKET_CALL_FAILED(io_result)) {
+            int error = GetSocketError();
+            if (error == EALREADY) return ATX_ERROR_WOULD_BLOCK;
+            if (error != EISCONN) return MapErrorCode(error);
+        }
+        BsdSocket_RefreshInfo(self);
+        return ATX_SUCCESS;
+    }
+
     /* set the socket to nonblocking so that we can timeout on connect */
     if (BsdSocket_SetBlockingMode(self, ATX_FALSE)) {
         return ATX_FAILURE;
     }
 
-    /* convert the address */
-    SocketAddressToInetAddress(address, &inet_address);
-
     /* initiate connection */
     io_result = connect(socket_fd, 
                         (struct sockaddr *)&inet_address, 
@@ -1595,6 +2008,7 @@ BsdTcpClientSocket_Connect(ATX_Socket*              _self,
 +---------------------------------------------------------------------*/
 ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(BsdTcpClientSocket)
     ATX_GET_INTERFACE_ACCEPT(BsdTcpClientSocket, ATX_Socket)
+    ATX_GET_INTERFACE_ACCEPT(BsdTcpClientSocket, ATX_SelectableSocket)
     ATX_GET_INTERFACE_ACCEPT(BsdTcpClientSocket, ATX_Destroyable)
 ATX_END_GET_INTERFACE_IMPLEMENTATION
 
@@ -1609,6 +2023,14 @@ ATX_BEGIN_INTERFACE_MAP(BsdTcpClientSocket, ATX_Socket)
     BsdSocket_GetInfo
 ATX_END_INTERFACE_MAP
 
+/*----------------------------------------------------------------------
+|   ATX_SelectableSocket interface
++---------------------------------------------------------------------*/
+ATX_BEGIN_INTERFACE_MAP(BsdTcpClientSocket, ATX_SelectableSocket)
+    BsdSocket_GetFd,
+    BsdSocket_SetBlocking
+ATX_END_INTERFACE_MAP
+
 /*----------------------------------------------------------------------
 |   ATX_Destroyable interface
 +---------------------------------------------------------------------*/
@@ -1621,6 +2043,7 @@ ATX_END_INTERFACE_MAP
 +---------------------------------------------------------------------*/
 ATX_DECLARE_INTERFACE_MAP(BsdTcpServerSocket, ATX_ServerSocket)
 ATX_DECLARE_INTERFACE_MAP(BsdTcpServerSocket, ATX_Socket)
+ATX_DECLARE_INTERFACE_MAP(BsdTcpServerSocket, ATX_SelectableSocket)
 ATX_DECLARE_INTERFACE_MAP(BsdTcpServerSocket, ATX_Destroyable)
 
 /*----------------------------------------------------------------------
@@ -1658,6 +2081,7 @@ ATX_TcpServerSocket_Create(ATX_ServerSocket** object)
     /* setup the interfaces */
     ATX_SET_INTERFACE(server, BsdTcpServerSocket, ATX_ServerSocket);
     ATX_SET_INTERFACE_EX(server, BsdTcpServerSocket, BsdSocket, ATX_Socket);
+    ATX_SET_INTERFACE_EX(server, BsdTcpServerSocket, BsdSocket, ATX_SelectableSocket);
     ATX_SET_INTERFACE_EX(server, BsdTcpServerSocket, BsdSocket, ATX_Destroyable);
     *object = &ATX_BASE(server, ATX_ServerSocket);
 
@@ -1705,13 +2129,27 @@ BsdTcpServerSocket_WaitForNewClient(ATX_ServerSocket* _self,
                        (struct sockaddr*)&inet_address, 
                        &namelen); 
     if (ATX_BSD_SOCKET_IS_INVALID(socket_fd)) {
-        client = NULL;
+        *client = NULL;
+        if (ATX_BASE(self, BsdSocket).socket_ref->non_blocking &&
+            MapErrorCode(GetSocketError()) == ATX_ERROR_WOULD_BLOCK) {
+            return ATX_ERROR_WOULD_BLOCK;
+        }
         return ATX_ERROR_ACCEPT_FAILED;
     }
 
     /* create a new client socket to wrap this file descriptor */
     result = BsdSocket_Create(socket_fd, client);
-    if (result != ATX_SUCCESS) return result;
+    if (result != ATX_SUCCESS) {
+        closesocket(socket_fd);
+        return result;
+    }
+
+    /* clients of a non-blocking server are non-blocking too */
+    if (ATX_BASE(self, BsdSocket).socket_ref->non_blocking) {
+        BsdSocket* bsd_client = ATX_SELF_O(*client, BsdSocket, ATX_Socket);
+        BsdSocket_SetBlockingMode(bsd_client, ATX_FALSE);
+        bsd_client->socket_ref->non_blocking = ATX_TRUE;
+    }
     
     /* done */
     return ATX_SUCCESS;    
@@ -1722,6 +2160,7 @@ BsdTcpServerSocket_WaitForNewClient(ATX_ServerSocket* _self,
 +---------------------------------------------------------------------*/
 ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(BsdTcpServerSocket)
     ATX_GET_INTERFACE_ACCEPT_EX(BsdTcpServerSocket, BsdSocket, ATX_Socket)
+    ATX_GET_INTERFACE_ACCEPT_EX(BsdTcpServerSocket, BsdSocket, ATX_SelectableSocket)
     ATX_GET_INTERFACE_ACCEPT_EX(BsdTcpServerSocket, BsdSocket, ATX_Destroyable)
     ATX_GET_INTERFACE_ACCEPT(BsdTcpServerSocket, ATX_ServerSocket)
 ATX_END_GET_INTERFACE_IMPLEMENTATION
@@ -1739,6 +2178,16 @@ ATX_INTERFACE_MAP(BsdTcpServerSocket, ATX_Socket) = {
     BsdSocket_GetInfo
 };
 
+/*----------------------------------------------------------------------
+|   ATX_SelectableSocket interface
++---------------------------------------------------------------------*/
+ATX_IMPLEMENT_GET_INTERFACE_ADAPTER_EX(BsdTcpServerSocket, BsdSocket, ATX_SelectableSocket)
+ATX_INTERFACE_MAP(BsdTcpServerSocket, ATX_SelectableSocket) = {
+    BsdTcpServerSocket_ATX_SelectableSocket_GetInterface,
+    BsdSocket_GetFd,
+    BsdSocket_SetBlocking
+};
+
 /*----------------------------------------------------------------------
 |   ATX_ServerSocket interface
 +---------------------------------------------------------------------*/
@@ -1757,3 +2206,994 @@ ATX_INTERFACE_MAP(BsdTcpServerSocket, ATX_Destroyable) = {
 };
 
 
+
+/*----------------------------------------------------------------------
+|   event loop backend
++---------------------------------------------------------------------*/
+#if defined(ATX_CONFIG_HAVE_EPOLL) && !defined(ATX_CONFIG_DISABLE_EPOLL)
+#define ATX_EVENT_LOOP_USE_EPOLL
+#elif defined(_WIN32) || defined(__PPU__)
+#define ATX_EVENT_LOOP_USE_SELECT
+#else
+#define ATX_EVENT_LOOP_USE_POLL
+#endif
+
+/*----------------------------------------------------------------------
+|   event loop types
++---------------------------------------------------------------------*/
+struct ATX_EventLoopWatch {
+    SocketFd                    fd;
+    ATX_Flags                   events;
+    ATX_EventLoopSocketCallback callback;
+    void*                       listener;
+    ATX_Boolean                 removed;
+    ATX_EventLoopWatch*         next;
+    ATX_EventLoopWatch*         prev;
+};
+
+struct ATX_EventLoopTimer {
+    ATX_Int64                  deadline; /* milliseconds */
+    ATX_Timeout                period;
+    ATX_EventLoopTimerCallback callback;
+    void*                      listener;
+    int                        heap_index; /* -1 when not scheduled */
+};
+
+typedef struct ATX_EventLoopTask {
+    ATX_EventLoopFunction     function;
+    void*                     arg;
+    struct ATX_EventLoopTask* next;
+} ATX_EventLoopTask;
+
+struct ATX_EventLoop {
+    /* watched sockets */
+    ATX_EventLoopWatch*  watches;
+    ATX_Cardinal         watch_count;
+    ATX_EventLoopWatch*  removed_watches; /* freed after each dispatch */
+
+    /* timers, in a binary min-heap ordered by deadline */
+    ATX_EventLoopTimer** timers;
+    ATX_Cardinal         timer_count;
+    ATX_Cardinal         timer_capacity;
+
+    /* cross-thread state */
+    ATX_Mutex*           lock;
+    ATX_EventLoopTask*   tasks;
+    ATX_EventLoopTask*   tasks_tail;
+    ATX_AtomicInt        wakeup_pending;
+    ATX_AtomicInt        stop_requested;
+    SocketFd             wakeup_fds[2]; /* read end, write end */
+
+#if defined(ATX_EVENT_LOOP_USE_EPOLL)
+    int                  epoll_fd;
+    struct epoll_event   epoll_events[ATX_EVENT_LOOP_MAX_EVENTS_PER_WAIT];
+#else
+    /* snapshot of the watches, rebuilt when the set of watches changes */
+    ATX_EventLoopWatch** snapshot;
+    ATX_Cardinal         snapshot_count;
+    ATX_Cardinal         snapshot_capacity;
+    ATX_Boolean          snapshot_dirty;
+#if defined(ATX_EVENT_LOOP_USE_POLL)
+    struct pollfd*       poll_fds;
+#endif
+#endif
+};
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_GetNow
++---------------------------------------------------------------------*/
+static ATX_Int64
+ATX_EventLoop_GetNow(void)
+{
+    ATX_TimeStamp now;
+    ATX_System_GetCurrentTimeStamp(&now);
+    return (ATX_Int64)now.seconds*1000 + now.nanoseconds/1000000;
+}
+
+#if defined(ATX_CONFIG_HAVE_EVENTFD)
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_OpenWakeUp
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_EventLoop_OpenWakeUp(ATX_EventLoop* self)
+{
+    int fd = eventfd(0, EFD_NONBLOCK);
+    if (fd < 0) return ATX_ERROR_OUT_OF_RESOURCES;
+    self->wakeup_fds[0] = self->wakeup_fds[1] = fd;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_CloseWakeUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_CloseWakeUp(ATX_EventLoop* self)
+{
+    close(self->wakeup_fds[0]);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_SignalWakeUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_SignalWakeUp(ATX_EventLoop* self)
+{
+    eventfd_write(self->wakeup_fds[1], 1);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_DrainWakeUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_DrainWakeUp(ATX_EventLoop* self)
+{
+    eventfd_t value;
+    eventfd_read(self->wakeup_fds[0], &value);
+}
+#elif defined(ATX_EVENT_LOOP_USE_SELECT)
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_OpenWakeUp
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_EventLoop_OpenWakeUp(ATX_EventLoop* self)
+{
+    /* there are no pipes that can be selected on, use a UDP socket */
+    /* that is connected to itself on the loopback interface         */
+    struct sockaddr_in inet_address;
+    socklen_t          name_length = sizeof(inet_address);
+    SocketFd           fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (ATX_BSD_SOCKET_IS_INVALID(fd)) return ATX_ERROR_OUT_OF_RESOURCES;
+
+    ATX_SetMemory(&inet_address, 0, sizeof(inet_address));
+    inet_address.sin_family      = AF_INET;
+    inet_address.sin_addr.s_addr = htonl(0x7F000001);
+    if (bind(fd, (struct sockaddr*)&inet_address, sizeof(inet_address)) < 0 ||
+        getsockname(fd, (struct sockaddr*)&inet_address, &name_length) < 0 ||
+        connect(fd, (struct sockaddr*)&inet_address, sizeof(inet_address)) < 0) {
+        closesocket(fd);
+        return ATX_ERROR_OUT_OF_RESOURCES;
+    }
+    self->wakeup_fds[0] = self->wakeup_fds[1] = fd;
+
+    /* make the socket non-blocking so that draining it never blocks */
+    {
+#if defined(_WIN32)
+        unsigned long args = 1;
+        ioctlsocket(fd, FIONBIO, &args);
+#else
+        int opt = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NBIO, (void*)&opt, sizeof(opt));
+#endif
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_CloseWakeUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_CloseWakeUp(ATX_EventLoop* self)
+{
+    closesocket(self->wakeup_fds[0]);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_SignalWakeUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_SignalWakeUp(ATX_EventLoop* self)
+{
+    char byte = 0;
+    send(self->wakeup_fds[1], (SocketConstBuffer)&byte, 1, 0);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_DrainWakeUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_DrainWakeUp(ATX_EventLoop* self)
+{
+    char bytes[16];
+    while (recv(self->wakeup_fds[0], (SocketBuffer)bytes, sizeof(bytes), 0) > 0) {}
+}
+#else
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_OpenWakeUp
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_EventLoop_OpenWakeUp(ATX_EventLoop* self)
+{
+    int fds[2];
+    if (pipe(fds) != 0) return ATX_ERROR_OUT_OF_RESOURCES;
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL, 0) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL, 0) | O_NONBLOCK);
+    self->wakeup_fds[0] = fds[0];
+    self->wakeup_fds[1] = fds[1];
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_CloseWakeUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_CloseWakeUp(ATX_EventLoop* self)
+{
+    close(self->wakeup_fds[0]);
+    close(self->wakeup_fds[1]);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_SignalWakeUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_SignalWakeUp(ATX_EventLoop* self)
+{
+    char byte = 0;
+    ssize_t result = write(self->wakeup_fds[1], &byte, 1);
+    ATX_COMPILER_UNUSED(result); /* a full pipe is already signaled */
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_DrainWakeUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_DrainWakeUp(ATX_EventLoop* self)
+{
+    char bytes[16];
+    while (read(self->wakeup_fds[0], bytes, sizeof(bytes)) > 0) {}
+}
+#endif
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Create(ATX_EventLoop** loop)
+{
+    ATX_EventLoop* self;
+    ATX_Result     result;
+
+    /* make sure the TCP/IP stack is initialized */
+    ATX_CHECK(BsdSockets_Init());
+
+    *loop = NULL;
+    self = (ATX_EventLoop*)ATX_AllocateZeroMemory(sizeof(ATX_EventLoop));
+    if (self == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    result = ATX_Mutex_Create(&self->lock);
+    if (ATX_FAILED(result)) {
+        ATX_FreeMemory(self);
+        return result;
+    }
+    result = ATX_EventLoop_OpenWakeUp(self);
+    if (ATX_FAILED(result)) {
+        ATX_Mutex_Destroy(self->lock);
+        ATX_FreeMemory(self);
+        return result;
+    }
+
+#if defined(ATX_EVENT_LOOP_USE_EPOLL)
+    self->epoll_fd = epoll_create(ATX_EVENT_LOOP_MAX_EVENTS_PER_WAIT);
+    if (self->epoll_fd >= 0) {
+        struct epoll_event event;
+        ATX_SetMemory(&event, 0, sizeof(event));
+        event.events   = EPOLLIN;
+        event.data.ptr = NULL; /* the wakeup fd is the only one without a watch */
+        if (epoll_ctl(self->epoll_fd, EPOLL_CTL_ADD, self->wakeup_fds[0], &event)) {
+            close(self->epoll_fd);
+            self->epoll_fd = -1;
+        }
+    }
+    if (self->epoll_fd < 0) {
+        ATX_EventLoop_CloseWakeUp(self);
+        ATX_Mutex_Destroy(self->lock);
+        ATX_FreeMemory(self);
+        return ATX_ERROR_OUT_OF_RESOURCES;
+    }
+#else
+    self->snapshot_dirty = ATX_TRUE;
+#endif
+
+    *loop = self;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_FreeRemovedWatches
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_FreeRemovedWatches(ATX_EventLoop* self)
+{
+    while (self->removed_watches) {
+        ATX_EventLoopWatch* watch = self->removed_watches;
+        self->removed_watches = watch->next;
+        ATX_FreeMemory(watch);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Destroy(ATX_EventLoop* self)
+{
+    ATX_Cardinal i;
+
+    if (self == NULL) return ATX_SUCCESS;
+
+    /* free the watches, the sockets themselves belong to the caller */
+    while (self->watches) {
+        ATX_EventLoopWatch* watch = self->watches;
+        self->watches = watch->next;
+        ATX_FreeMemory(watch);
+    }
+    ATX_EventLoop_FreeRemovedWatches(self);
+
+    /* free the timers */
+    for (i=0; i<self->timer_count; i++) {
+        ATX_FreeMemory(self->timers[i]);
+    }
+    if (self->timers) ATX_FreeMemory(self->timers);
+
+    /* drop the tasks that were never run */
+    while (self->tasks) {
+        ATX_EventLoopTask* task = self->tasks;
+        self->tasks = task->next;
+        ATX_FreeMemory(task);
+    }
+
+#if defined(ATX_EVENT_LOOP_USE_EPOLL)
+    close(self->epoll_fd);
+#else
+    if (self->snapshot) ATX_FreeMemory(self->snapshot);
+#if defined(ATX_EVENT_LOOP_USE_POLL)
+    if (self->poll_fds) ATX_FreeMemory(self->poll_fds);
+#endif
+#endif
+    ATX_EventLoop_CloseWakeUp(self);
+    ATX_Mutex_Destroy(self->lock);
+    ATX_FreeMemory(self);
+
+    return ATX_SUCCESS;
+}
+
+#if defined(ATX_EVENT_LOOP_USE_EPOLL)
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_UpdateEpoll
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_EventLoop_UpdateEpoll(ATX_EventLoop*      self, 
+                          ATX_EventLoopWatch* watch, 
+                          int                 operation)
+{
+    struct epoll_event event;
+    ATX_SetMemory(&event, 0, sizeof(event));
+    if (watch->events & ATX_EVENT_LOOP_READABLE) event.events |= EPOLLIN;
+    if (watch->events & ATX_EVENT_LOOP_WRITABLE) event.events |= EPOLLOUT;
+    event.data.ptr = watch;
+    if (epoll_ctl(self->epoll_fd, operation, watch->fd, &event)) {
+        return MapErrorCode(errno);
+    }
+    return ATX_SUCCESS;
+}
+#endif
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_AddSocket
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_AddSocket(ATX_EventLoop*              self,
+                        ATX_SelectableSocket*       socket,
+                        ATX_Flags                   events,
+                        ATX_EventLoopSocketCallback callback,
+                        void*                       listener,
+                        ATX_EventLoopWatch**        watch)
+{
+    ATX_EventLoopWatch* new_watch;
+
+    if (self == NULL || socket == NULL || callback == NULL) {
+        return ATX_ERROR_INVALID_PARAMETERS;
+    }
+#if defined(ATX_EVENT_LOOP_USE_SELECT)
+    if (self->watch_count+1 >= FD_SETSIZE) return ATX_ERROR_OUT_OF_RESOURCES;
+#endif
+
+    new_watch = (ATX_EventLoopWatch*)ATX_AllocateZeroMemory(sizeof(ATX_EventLoopWatch));
+    if (new_watch == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    new_watch->fd       = (SocketFd)ATX_SelectableSocket_GetFd(socket);
+    new_watch->events   = events & (ATX_EVENT_LOOP_READABLE | ATX_EVENT_LOOP_WRITABLE);
+    new_watch->callback = callback;
+    new_watch->listener = listener;
+
+#if defined(ATX_EVENT_LOOP_USE_EPOLL)
+    {
+        ATX_Result result = ATX_EventLoop_UpdateEpoll(self, new_watch, EPOLL_CTL_ADD);
+        if (ATX_FAILED(result)) {
+            ATX_FreeMemory(new_watch);
+            return result;
+        }
+    }
+#else
+    self->snapshot_dirty = ATX_TRUE;
+#endif
+
+    /* new watches go first, so that they are not visited by a dispatch */
+    /* that is already in progress                                      */
+    new_watch->next = self->watches;
+    if (self->watches) self->watches->prev = new_watch;
+    self->watches = new_watch;
+    ++self->watch_count;
+
+    if (watch) *watch = new_watch;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_ModifySocket
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_ModifySocket(ATX_EventLoop*      self,
+                           ATX_EventLoopWatch* watch,
+                           ATX_Flags           events)
+{
+    if (self == NULL || watch == NULL || watch->removed) {
+        return ATX_ERROR_INVALID_PARAMETERS;
+    }
+    events &= ATX_EVENT_LOOP_READABLE | ATX_EVENT_LOOP_WRITABLE;
+    if (events == watch->events) return ATX_SUCCESS;
+    watch->events = events;
+
+#if defined(ATX_EVENT_LOOP_USE_EPOLL)
+    return ATX_EventLoop_UpdateEpoll(self, watch, EPOLL_CTL_MOD);
+#else
+    self->snapshot_dirty = ATX_TRUE;
+    return ATX_SUCCESS;
+#endif
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_RemoveSocket
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_RemoveSocket(ATX_EventLoop*      self,
+                           ATX_EventLoopWatch* watch)
+{
+    if (self == NULL || watch == NULL || watch->removed) {
+        return ATX_ERROR_INVALID_PARAMETERS;
+    }
+
+#if defined(ATX_EVENT_LOOP_USE_EPOLL)
+    {
+        struct epoll_event event; /* ignored, but required by old kernels */
+        epoll_ctl(self->epoll_fd, EPOLL_CTL_DEL, watch->fd, &event);
+    }
+#else
+    self->snapshot_dirty = ATX_TRUE;
+#endif
+
+    /* unlink the watch */
+    if (watch->prev) {
+        watch->prev->next = watch->next;
+    } else {
+        self->watches = watch->next;
+    }
+    if (watch->next) watch->next->prev = watch->prev;
+    --self->watch_count;
+
+    /* pending events may still reference the watch, so it is only */
+    /* freed once the current dispatch is done                      */
+    watch->removed = ATX_TRUE;
+    watch->prev    = NULL;
+    watch->next    = self->removed_watches;
+    self->removed_watches = watch;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_SetTimerAt
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_SetTimerAt(ATX_EventLoop*      self, 
+                         ATX_Cardinal        index, 
+                         ATX_EventLoopTimer* timer)
+{
+    self->timers[index] = timer;
+    timer->heap_index = (int)index;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_SiftTimerUp
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_SiftTimerUp(ATX_EventLoop* self, ATX_Cardinal index)
+{
+    ATX_EventLoopTimer* timer = self->timers[index];
+    while (index) {
+        ATX_Cardinal parent = (index-1)/2;
+        if (self->timers[parent]->deadline <= timer->deadline) break;
+        ATX_EventLoop_SetTimerAt(self, index, self->timers[parent]);
+        index = parent;
+    }
+    ATX_EventLoop_SetTimerAt(self, index, timer);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_SiftTimerDown
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_SiftTimerDown(ATX_EventLoop* self, ATX_Cardinal index)
+{
+    ATX_EventLoopTimer* timer = self->timers[index];
+    for (;;) {
+        ATX_Cardinal child = 2*index+1;
+        if (child >= self->timer_count) break;
+        if (child+1 < self->timer_count &&
+            self->timers[child+1]->deadline < self->timers[child]->deadline) {
+            ++child;
+        }
+        if (timer->deadline <= self->timers[child]->deadline) break;
+        ATX_EventLoop_SetTimerAt(self, index, self->timers[child]);
+        index = child;
+    }
+    ATX_EventLoop_SetTimerAt(self, index, timer);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_ScheduleTimer
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_EventLoop_ScheduleTimer(ATX_EventLoop* self, ATX_EventLoopTimer* timer)
+{
+    if (self->timer_count == self->timer_capacity) {
+        ATX_Cardinal         capacity = self->timer_capacity ? 2*self->timer_capacity : 16;
+        ATX_EventLoopTimer** timers   = (ATX_EventLoopTimer**)ATX_AllocateMemory(capacity*sizeof(ATX_EventLoopTimer*));
+        if (timers == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+        if (self->timers) {
+            ATX_CopyMemory(timers, self->timers, self->timer_count*sizeof(ATX_EventLoopTimer*));
+            ATX_FreeMemory(self->timers);
+        }
+        self->timers         = timers;
+        self->timer_capacity = capacity;
+    }
+    self->timers[self->timer_count] = timer;
+    ATX_EventLoop_SiftTimerUp(self, self->timer_count++);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_UnscheduleTimer
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_UnscheduleTimer(ATX_EventLoop* self, ATX_EventLoopTimer* timer)
+{
+    ATX_Cardinal index = (ATX_Cardinal)timer->heap_index;
+    ATX_EventLoopTimer* last;
+
+    timer->heap_index = -1;
+    last = self->timers[--self->timer_count];
+    if (last == timer) return;
+
+    /* move the last timer in the hole and restore the heap order */
+    ATX_EventLoop_SetTimerAt(self, index, last);
+    if (index && self->timers[(index-1)/2]->deadline > last->deadline) {
+        ATX_EventLoop_SiftTimerUp(self, index);
+    } else {
+        ATX_EventLoop_SiftTimerDown(self, index);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_AddTimer
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_AddTimer(ATX_EventLoop*             self,
+                       ATX_Timeout                delay,
+                       ATX_Timeout                period,
+                       ATX_EventLoopTimerCallback callback,
+                       void*                      listener,
+                       ATX_EventLoopTimer**       timer)
+{
+    ATX_EventLoopTimer* new_timer;
+    ATX_Result          result;
+
+    if (self == NULL || callback == NULL || delay < 0 || period < 0) {
+        return ATX_ERROR_INVALID_PARAMETERS;
+    }
+
+    new_timer = (ATX_EventLoopTimer*)ATX_AllocateZeroMemory(sizeof(ATX_EventLoopTimer));
+    if (new_timer == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    new_timer->deadline   = ATX_EventLoop_GetNow()+delay;
+    new_timer->period     = period;
+    new_timer->callback   = callback;
+    new_timer->listener   = listener;
+    new_timer->heap_index = -1;
+
+    result = ATX_EventLoop_ScheduleTimer(self, new_timer);
+    if (ATX_FAILED(result)) {
+        ATX_FreeMemory(new_timer);
+        return result;
+    }
+
+    if (timer) *timer = new_timer;
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_RemoveTimer
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_RemoveTimer(ATX_EventLoop* self, ATX_EventLoopTimer* timer)
+{
+    if (self == NULL || timer == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+
+    if (timer->heap_index >= 0) ATX_EventLoop_UnscheduleTimer(self, timer);
+    ATX_FreeMemory(timer);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_DispatchTimers
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_DispatchTimers(ATX_EventLoop* self)
+{
+    ATX_Int64 now = ATX_EventLoop_GetNow();
+
+    while (self->timer_count && self->timers[0]->deadline <= now) {
+        ATX_EventLoopTimer* timer = self->timers[0];
+        ATX_EventLoop_UnscheduleTimer(self, timer);
+
+        /* reschedule periodic timers before the callback, which may */
+        /* remove the timer. A timer that fell behind skips the      */
+        /* periods it missed.                                        */
+        if (timer->period) {
+            timer->deadline += timer->period;
+            if (timer->deadline <= now) timer->deadline = now+timer->period;
+            if (ATX_FAILED(ATX_EventLoop_ScheduleTimer(self, timer))) {
+                ATX_LOG_WARNING("failed to reschedule timer");
+            }
+        }
+        timer->callback(self, timer, timer->listener);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_GetWaitTimeout
++---------------------------------------------------------------------*/
+static ATX_Timeout
+ATX_EventLoop_GetWaitTimeout(ATX_EventLoop* self, ATX_Timeout timeout)
+{
+    if (self->timer_count) {
+        ATX_Int64 delay = self->timers[0]->deadline-ATX_EventLoop_GetNow();
+        if (delay < 0) delay = 0;
+        if (timeout == ATX_SOCKET_TIMEOUT_INFINITE || delay < timeout) {
+            timeout = (ATX_Timeout)delay;
+        }
+    }
+    return timeout;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_DispatchTasks
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_DispatchTasks(ATX_EventLoop* self)
+{
+    ATX_EventLoopTask* tasks;
+
+    /* take all the pending tasks at once */
+    ATX_AtomicInt_Set(&self->wakeup_pending, 0);
+    ATX_EventLoop_DrainWakeUp(self);
+    ATX_Mutex_Lock(self->lock);
+    tasks = self->tasks;
+    self->tasks = self->tasks_tail = NULL;
+    ATX_Mutex_Unlock(self->lock);
+
+    while (tasks) {
+        ATX_EventLoopTask* task = tasks;
+        tasks = task->next;
+        task->function(self, task->arg);
+        ATX_FreeMemory(task);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_DispatchSocket
++---------------------------------------------------------------------*/
+static void
+ATX_EventLoop_DispatchSocket(ATX_EventLoop*      self, 
+                             ATX_EventLoopWatch* watch, 
+                             ATX_Flags           events)
+{
+    /* only report what was asked for, and errors */
+    events &= watch->events | ATX_EVENT_LOOP_ERROR;
+    if (events == 0 || watch->removed) return;
+    watch->callback(self, watch, events, watch->listener);
+}
+
+#if defined(ATX_EVENT_LOOP_USE_EPOLL)
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_WaitAndDispatch
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_EventLoop_WaitAndDispatch(ATX_EventLoop* self, ATX_Timeout timeout)
+{
+    ATX_Boolean woken = ATX_FALSE;
+    int         count;
+    int         i;
+
+    count = epoll_wait(self->epoll_fd, 
+                       self->epoll_events, 
+                       ATX_EVENT_LOOP_MAX_EVENTS_PER_WAIT, 
+                       timeout);
+    if (count < 0) {
+        return errno == EINTR ? ATX_SUCCESS : ATX_ERROR_SELECT_FAILED;
+    }
+
+    for (i=0; i<count; i++) {
+        ATX_EventLoopWatch* watch  = (ATX_EventLoopWatch*)self->epoll_events[i].data.ptr;
+        uint32_t            flags  = self->epoll_events[i].events;
+        ATX_Flags           events = 0;
+        if (watch == NULL) {
+            woken = ATX_TRUE;
+            continue;
+        }
+        if (flags & EPOLLIN)              events |= ATX_EVENT_LOOP_READABLE;
+        if (flags & EPOLLOUT)             events |= ATX_EVENT_LOOP_WRITABLE;
+        if (flags & (EPOLLERR | EPOLLHUP)) events |= ATX_EVENT_LOOP_ERROR;
+        ATX_EventLoop_DispatchSocket(self, watch, events);
+    }
+    if (woken) ATX_EventLoop_DispatchTasks(self);
+
+    return ATX_SUCCESS;
+}
+#else
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_UpdateSnapshot
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_EventLoop_UpdateSnapshot(ATX_EventLoop* self)
+{
+    ATX_EventLoopWatch* watch;
+    ATX_Cardinal        count = 0;
+
+    if (!self->snapshot_dirty) return ATX_SUCCESS;
+
+    if (self->watch_count > self->snapshot_capacity) {
+        ATX_Cardinal capacity = self->snapshot_capacity ? self->snapshot_capacity : 16;
+        while (capacity < self->watch_count) capacity *= 2;
+        if (self->snapshot) ATX_FreeMemory(self->snapshot);
+        self->snapshot = (ATX_EventLoopWatch**)ATX_AllocateMemory(capacity*sizeof(ATX_EventLoopWatch*));
+#if defined(ATX_EVENT_LOOP_USE_POLL)
+        if (self->poll_fds) ATX_FreeMemory(self->poll_fds);
+        self->poll_fds = (struct pollfd*)ATX_AllocateMemory((capacity+1)*sizeof(struct pollfd));
+        if (self->poll_fds == NULL && self->snapshot) {
+            ATX_FreeMemory(self->snapshot);
+            self->snapshot = NULL;
+        }
+#endif
+        if (self->snapshot == NULL) {
+            self->snapshot_capacity = 0;
+            self->snapshot_count    = 0;
+            return ATX_ERROR_OUT_OF_MEMORY;
+        }
+        self->snapshot_capacity = capacity;
+    }
+
+    for (watch = self->watches; watch; watch = watch->next) {
+        self->snapshot[count++] = watch;
+    }
+    self->snapshot_count = count;
+    self->snapshot_dirty = ATX_FALSE;
+
+    return ATX_SUCCESS;
+}
+
+#if defined(ATX_EVENT_LOOP_USE_POLL)
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_WaitAndDispatch
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_EventLoop_WaitAndDispatch(ATX_EventLoop* self, ATX_Timeout timeout)
+{
+    struct pollfd* fds;
+    ATX_Cardinal   count;
+    ATX_Cardinal   i;
+    int            io_result;
+
+    ATX_CHECK(ATX_EventLoop_UpdateSnapshot(self));
+    if (self->poll_fds == NULL) {
+        /* no watch was ever added, only the wakeup fd needs space */
+        self->poll_fds = (struct pollfd*)ATX_AllocateMemory(sizeof(struct pollfd));
+        if (self->poll_fds == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* the wakeup fd always comes first */
+    fds   = self->poll_fds;
+    count = self->snapshot_count;
+    fds[0].fd      = self->wakeup_fds[0];
+    fds[0].events  = POLLIN;
+    fds[0].revents = 0;
+    for (i=0; i<count; i++) {
+        ATX_EventLoopWatch* watch = self->snapshot[i];
+        fds[i+1].fd      = watch->fd;
+        fds[i+1].events  = 0;
+        fds[i+1].revents = 0;
+        if (watch->events & ATX_EVENT_LOOP_READABLE) fds[i+1].events |= POLLIN;
+        if (watch->events & ATX_EVENT_LOOP_WRITABLE) fds[i+1].events |= POLLOUT;
+    }
+
+    io_result = poll(fds, count+1, timeout);
+    if (io_result < 0) {
+        return errno == EINTR ? ATX_SUCCESS : ATX_ERROR_SELECT_FAILED;
+    }
+    if (io_result == 0) return ATX_SUCCESS;
+
+    for (i=0; i<count; i++) {
+        short     flags  = fds[i+1].revents;
+        ATX_Flags events = 0;
+        if (flags == 0) continue;
+        if (flags & POLLIN)                         events |= ATX_EVENT_LOOP_READABLE;
+        if (flags & POLLOUT)                        events |= ATX_EVENT_LOOP_WRITABLE;
+        if (flags & (POLLERR | POLLHUP | POLLNVAL)) events |= ATX_EVENT_LOOP_ERROR;
+        ATX_EventLoop_DispatchSocket(self, self->snapshot[i], events);
+    }
+    if (fds[0].revents) ATX_EventLoop_DispatchTasks(self);
+
+    return ATX_SUCCESS;
+}
+#else
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_WaitAndDispatch
++---------------------------------------------------------------------*/
+static ATX_Result
+ATX_EventLoop_WaitAndDispatch(ATX_EventLoop* self, ATX_Timeout timeout)
+{
+    fd_set         read_set;
+    fd_set         write_set;
+    fd_set         except_set;
+    struct timeval timeout_value;
+    SocketFd       max_fd = self->wakeup_fds[0];
+    ATX_Cardinal   count;
+    ATX_Cardinal   i;
+    int            io_result;
+
+    ATX_CHECK(ATX_EventLoop_UpdateSnapshot(self));
+
+    FD_ZERO(&read_set);
+    FD_ZERO(&write_set);
+    FD_ZERO(&except_set);
+    FD_SET(self->wakeup_fds[0], &read_set);
+    count = self->snapshot_count;
+    for (i=0; i<count; i++) {
+        ATX_EventLoopWatch* watch = self->snapshot[i];
+        if (watch->events & ATX_EVENT_LOOP_READABLE) FD_SET(watch->fd, &read_set);
+        if (watch->events & ATX_EVENT_LOOP_WRITABLE) {
+            /* failed connections are reported in the except set on Windows */
+            FD_SET(watch->fd, &write_set);
+            FD_SET(watch->fd, &except_set);
+        }
+        if (watch->fd > max_fd) max_fd = watch->fd;
+    }
+
+    if (timeout != ATX_SOCKET_TIMEOUT_INFINITE) {
+        timeout_value.tv_sec  = timeout/1000;
+        timeout_value.tv_usec = 1000*(timeout-1000*(timeout/1000));
+    }
+    io_result = select((int)(max_fd+1), &read_set, &write_set, &except_set, 
+                       timeout == ATX_SOCKET_TIMEOUT_INFINITE ? 
+                       NULL : &timeout_value);
+    if (ATX_BSD_SOCKET_SELECT_FAILED(io_result)) {
+        return GetSocketError() == EINTR ? ATX_SUCCESS : ATX_ERROR_SELECT_FAILED;
+    }
+    if (io_result == 0) return ATX_SUCCESS;
+
+    for (i=0; i<count; i++) {
+        ATX_EventLoopWatch* watch  = self->snapshot[i];
+        ATX_Flags           events = 0;
+        if (watch->removed) continue;
+        if (FD_ISSET(watch->fd, &read_set))   events |= ATX_EVENT_LOOP_READABLE;
+        if (FD_ISSET(watch->fd, &write_set))  events |= ATX_EVENT_LOOP_WRITABLE;
+        if (FD_ISSET(watch->fd, &except_set)) events |= ATX_EVENT_LOOP_ERROR;
+        if (events) ATX_EventLoop_DispatchSocket(self, watch, events);
+    }
+    if (FD_ISSET(self->wakeup_fds[0], &read_set)) ATX_EventLoop_DispatchTasks(self);
+
+    return ATX_SUCCESS;
+}
+#endif
+#endif
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_RunOnce
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_RunOnce(ATX_EventLoop* self, ATX_Timeout timeout)
+{
+    ATX_Result result;
+
+    if (self == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+
+    result = ATX_EventLoop_WaitAndDispatch(self, ATX_EventLoop_GetWaitTimeout(self, timeout));
+    ATX_EventLoop_DispatchTimers(self);
+    ATX_EventLoop_FreeRemovedWatches(self);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Run
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Run(ATX_EventLoop* self)
+{
+    if (self == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+
+    while (ATX_AtomicInt_Exchange(&self->stop_requested, 0) == 0) {
+        ATX_CHECK(ATX_EventLoop_RunOnce(self, ATX_SOCKET_TIMEOUT_INFINITE));
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Stop
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Stop(ATX_EventLoop* self)
+{
+    if (self == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+
+    ATX_AtomicInt_Set(&self->stop_requested, 1);
+    return ATX_EventLoop_WakeUp(self);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_WakeUp
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_WakeUp(ATX_EventLoop* self)
+{
+    if (self == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+
+    /* only signal once until the loop has woken up */
+    if (ATX_AtomicInt_Exchange(&self->wakeup_pending, 1) == 0) {
+        ATX_EventLoop_SignalWakeUp(self);
+    }
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Post
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Post(ATX_EventLoop*        self,
+                   ATX_EventLoopFunction function,
+                   void*                 arg)
+{
+    ATX_EventLoopTask* task;
+
+    if (self == NULL || function == NULL) return ATX_ERROR_INVALID_PARAMETERS;
+
+    task = (ATX_EventLoopTask*)ATX_AllocateMemory(sizeof(ATX_EventLoopTask));
+    if (task == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    task->function = function;
+    task->arg      = arg;
+    task->next     = NULL;
+
+    ATX_Mutex_Lock(self->lock);
+    if (self->tasks_tail) {
+        self->tasks_tail->next = task;
+    } else {
+        self->tasks = task;
+    }
+    self->tasks_tail = task;
+    ATX_Mutex_Unlock(self->lock);
+
+    return ATX_EventLoop_WakeUp(self);
+}
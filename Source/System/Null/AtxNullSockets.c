@@ -82,3 +82,169 @@ ATX_TcpServerSocket_Create(ATX_ServerSocket** object)
 
     return ATX_ERROR_NOT_IMPLEMENTED;
 }
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Create(ATX_EventLoop** loop)
+{
+    ATX_COMPILER_UNUSED(loop);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Destroy(ATX_EventLoop* self)
+{
+    ATX_COMPILER_UNUSED(self);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_AddSocket
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_AddSocket(ATX_EventLoop*              self,
+                        ATX_SelectableSocket*       socket,
+                        ATX_Flags                   events,
+                        ATX_EventLoopSocketCallback callback,
+                        void*                       listener,
+                        ATX_EventLoopWatch**        watch)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(socket);
+    ATX_COMPILER_UNUSED(events);
+    ATX_COMPILER_UNUSED(callback);
+    ATX_COMPILER_UNUSED(listener);
+    ATX_COMPILER_UNUSED(watch);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_ModifySocket
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_ModifySocket(ATX_EventLoop*      self,
+                           ATX_EventLoopWatch* watch,
+                           ATX_Flags           events)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(watch);
+    ATX_COMPILER_UNUSED(events);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_RemoveSocket
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_RemoveSocket(ATX_EventLoop*      self,
+                           ATX_EventLoopWatch* watch)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(watch);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_AddTimer
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_AddTimer(ATX_EventLoop*             self,
+                       ATX_Timeout                delay,
+                       ATX_Timeout                period,
+                       ATX_EventLoopTimerCallback callback,
+                       void*                      listener,
+                       ATX_EventLoopTimer**       timer)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(delay);
+    ATX_COMPILER_UNUSED(period);
+    ATX_COMPILER_UNUSED(callback);
+    ATX_COMPILER_UNUSED(listener);
+    ATX_COMPILER_UNUSED(timer);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_RemoveTimer
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_RemoveTimer(ATX_EventLoop*      self,
+                          ATX_EventLoopTimer* timer)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(timer);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_RunOnce
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_RunOnce(ATX_EventLoop* self,
+                      ATX_Timeout    timeout)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(timeout);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Run
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Run(ATX_EventLoop* self)
+{
+    ATX_COMPILER_UNUSED(self);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Stop
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Stop(ATX_EventLoop* self)
+{
+    ATX_COMPILER_UNUSED(self);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_WakeUp
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_WakeUp(ATX_EventLoop* self)
+{
+    ATX_COMPILER_UNUSED(self);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_EventLoop_Post
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_EventLoop_Post(ATX_EventLoop*        self,
+                   ATX_EventLoopFunction function,
+                   void*                 arg)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(function);
+    ATX_COMPILER_UNUSED(arg);
+
+    return ATX_ERROR_NOT_IMPLEMENTED;
+}
@@ -35,6 +35,17 @@
 #include "AtxThreads.h"
 #include "AtxUtils.h"
 
+/*----------------------------------------------------------------------
+|   types
++---------------------------------------------------------------------*/
+struct ATX_Semaphore {
+    ATX_Cardinal count;
+};
+
+struct ATX_ThreadLocal {
+    void* value;
+};
+
 /*----------------------------------------------------------------------
 |   ATX_GetCurrentThreadId
 +---------------------------------------------------------------------*/
@@ -98,3 +109,305 @@ ATX_Mutex_Destroy(ATX_Mutex* mutex)
 
     return ATX_SUCCESS;
 }
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Create(ATX_Condition** condition)
+{
+    *condition = ATX_AllocateMemory(1);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Destroy(ATX_Condition* self)
+{
+    ATX_FreeMemory(self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Wait
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Wait(ATX_Condition* self, ATX_Mutex* mutex, ATX_Timeout timeout)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(mutex);
+    ATX_COMPILER_UNUSED(timeout);
+
+    /* there is no other thread to wait for */
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Signal
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Signal(ATX_Condition* self)
+{
+    ATX_COMPILER_UNUSED(self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Broadcast
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Broadcast(ATX_Condition* self)
+{
+    ATX_COMPILER_UNUSED(self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_Create(ATX_ThreadFunction function, void* arg, ATX_Thread** thread)
+{
+    ATX_COMPILER_UNUSED(function);
+    ATX_COMPILER_UNUSED(arg);
+
+    *thread = NULL;
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Join
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_Join(ATX_Thread* self)
+{
+    ATX_COMPILER_UNUSED(self);
+
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Detach
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_Detach(ATX_Thread* self)
+{
+    ATX_COMPILER_UNUSED(self);
+
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_GetId
++---------------------------------------------------------------------*/
+ATX_ThreadId
+ATX_Thread_GetId(ATX_Thread* self)
+{
+    ATX_COMPILER_UNUSED(self);
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_SetName
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_SetName(ATX_Thread* self, const char* name)
+{
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(name);
+
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Create(ATX_Cardinal initial_count, ATX_Semaphore** semaphore)
+{
+    *semaphore = ATX_AllocateZeroMemory(sizeof(ATX_Semaphore));
+    if (*semaphore == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    (*semaphore)->count = initial_count;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Destroy(ATX_Semaphore* self)
+{
+    ATX_FreeMemory(self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Wait
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Wait(ATX_Semaphore* self, ATX_Timeout timeout)
+{
+    ATX_COMPILER_UNUSED(timeout);
+
+    /* there is no other thread that could post */
+    if (self->count == 0) return ATX_ERROR_WAIT_TIMEOUT;
+    --self->count;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Post
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Post(ATX_Semaphore* self)
+{
+    ++self->count;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_ThreadLocal_Create(ATX_ThreadLocal** local)
+{
+    *local = ATX_AllocateZeroMemory(sizeof(ATX_ThreadLocal));
+    if (*local == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_ThreadLocal_Destroy(ATX_ThreadLocal* self)
+{
+    ATX_FreeMemory(self);
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Get
++---------------------------------------------------------------------*/
+void*
+ATX_ThreadLocal_Get(ATX_ThreadLocal* self)
+{
+    return self->value;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Set
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_ThreadLocal_Set(ATX_ThreadLocal* self, void* value)
+{
+    self->value = value;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Add
++---------------------------------------------------------------------*/
+ATX_Int32
+ATX_AtomicInt_Add(ATX_AtomicInt* self, ATX_Int32 value)
+{
+    return self->value += value;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_CompareAndSwap
++---------------------------------------------------------------------*/
+ATX_Boolean
+ATX_AtomicInt_CompareAndSwap(ATX_AtomicInt* self, 
+                             ATX_Int32      expected, 
+                             ATX_Int32      value)
+{
+    if (self->value != expected) return ATX_FALSE;
+    self->value = value;
+    return ATX_TRUE;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Get
++---------------------------------------------------------------------*/
+ATX_Int32
+ATX_AtomicInt_Get(ATX_AtomicInt* self)
+{
+    return self->value;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Set
++---------------------------------------------------------------------*/
+void
+ATX_AtomicInt_Set(ATX_AtomicInt* self, ATX_Int32 value)
+{
+    self->value = value;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Exchange
++---------------------------------------------------------------------*/
+ATX_Int32
+ATX_AtomicInt_Exchange(ATX_AtomicInt* self, ATX_Int32 value)
+{
+    ATX_Int32 previous = self->value;
+    self->value = value;
+    return previous;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_Get
++---------------------------------------------------------------------*/
+void*
+ATX_AtomicPointer_Get(ATX_AtomicPointer* self)
+{
+    return self->value;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_Set
++---------------------------------------------------------------------*/
+void
+ATX_AtomicPointer_Set(ATX_AtomicPointer* self, void* value)
+{
+    self->value = value;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_Exchange
++---------------------------------------------------------------------*/
+void*
+ATX_AtomicPointer_Exchange(ATX_AtomicPointer* self, void* value)
+{
+    void* previous = self->value;
+    self->value = value;
+    return previous;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_CompareAndSwap
++---------------------------------------------------------------------*/
+ATX_Boolean
+ATX_AtomicPointer_CompareAndSwap(ATX_AtomicPointer* self, 
+                                 void*              expected, 
+                                 void*              value)
+{
+    if (self->value != expected) return ATX_FALSE;
+    self->value = value;
+    return ATX_TRUE;
+}
@@ -32,7 +32,12 @@
 /*----------------------------------------------------------------------
 |   includes
 +---------------------------------------------------------------------*/
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE /* for pthread_setname_np */
+#endif
 #include <pthread.h>
+#include <errno.h>
+#include <sys/time.h>
 #include "AtxThreads.h"
 #include "AtxLogging.h"
 #include "AtxUtils.h"
@@ -44,6 +49,27 @@ struct ATX_Mutex {
     pthread_mutex_t mutex;
 };
 
+struct ATX_Condition {
+    pthread_cond_t condition;
+};
+
+struct ATX_Semaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t  condition;
+    ATX_Cardinal    count;
+};
+
+struct ATX_Thread {
+    pthread_t          thread;
+    ATX_ThreadFunction function;
+    void*              arg;
+    ATX_AtomicInt      references; /* the owner and the thread itself */
+};
+
+struct ATX_ThreadLocal {
+    pthread_key_t key;
+};
+
 /*----------------------------------------------------------------------
 |   logger
 +---------------------------------------------------------------------*/
@@ -168,4 +194,491 @@ ATX_Mutex_Destroy(ATX_Mutex* mutex)
     ATX_FreeMemory(mutex);
     return ATX_SUCCESS;
 }
-        
+
+/*----------------------------------------------------------------------
+|   ATX_Posix_GetDeadline
++---------------------------------------------------------------------*/
+static void
+ATX_Posix_GetDeadline(ATX_Timeout timeout, struct timespec* deadline)
+{
+    struct timeval now;
+    long           nanoseconds;
+
+    /* compute the absolute deadline */
+    gettimeofday(&now, NULL);
+    nanoseconds = now.tv_usec*1000 + (long)(timeout%1000)*1000000;
+    deadline->tv_sec  = now.tv_sec + timeout/1000 + nanoseconds/1000000000;
+    deadline->tv_nsec = nanoseconds%1000000000;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Create(ATX_Condition** condition)
+{
+    int pres;
+    if (condition == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    *condition = ATX_AllocateZeroMemory(sizeof(ATX_Condition));
+    if (*condition == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    pres = pthread_cond_init(&(*condition)->condition, NULL);
+    if (pres != 0) {
+        ATX_LOG_SEVERE_1("pthread cond init failed with error %d", pres);
+        ATX_FreeMemory(*condition);
+        *condition = NULL;
+        return ATX_FAILURE;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Destroy(ATX_Condition* self)
+{
+    if (self == NULL) return ATX_SUCCESS;
+    pthread_cond_destroy(&self->condition);
+    ATX_FreeMemory(self);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Wait
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Wait(ATX_Condition* self, ATX_Mutex* mutex, ATX_Timeout timeout)
+{
+    int pres;
+    if (self == NULL || mutex == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+
+    if (timeout == ATX_TIMEOUT_INFINITE) {
+        pres = pthread_cond_wait(&self->condition, &mutex->mutex);
+    } else {
+        struct timespec deadline;
+        ATX_Posix_GetDeadline(timeout, &deadline);
+        pres = pthread_cond_timedwait(&self->condition, &mutex->mutex, &deadline);
+        if (pres == ETIMEDOUT) return ATX_ERROR_WAIT_TIMEOUT;
+    }
+    if (pres != 0) {
+        ATX_LOG_SEVERE_1("pthread cond wait failed with error %d", pres);
+        return ATX_FAILURE;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Signal
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Signal(ATX_Condition* self)
+{
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    pthread_cond_signal(&self->condition);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Broadcast
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Broadcast(ATX_Condition* self)
+{
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    pthread_cond_broadcast(&self->condition);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Release
++---------------------------------------------------------------------*/
+static void
+ATX_Thread_Release(ATX_Thread* self)
+{
+    if (ATX_AtomicInt_Add(&self->references, -1) == 0) {
+        ATX_FreeMemory(self);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_EntryPoint
++---------------------------------------------------------------------*/
+static void*
+ATX_Thread_EntryPoint(void* arg)
+{
+    ATX_Thread* self = (ATX_Thread*)arg;
+    self->function(self->arg);
+    ATX_Thread_Release(self);
+    return NULL;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_Create(ATX_ThreadFunction function, void* arg, ATX_Thread** thread)
+{
+    int pres;
+    if (function == NULL || thread == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    *thread = ATX_AllocateZeroMemory(sizeof(ATX_Thread));
+    if (*thread == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    (*thread)->function = function;
+    (*thread)->arg      = arg;
+    ATX_AtomicInt_Set(&(*thread)->references, 2);
+    pres = pthread_create(&(*thread)->thread, NULL, ATX_Thread_EntryPoint, *thread);
+    if (pres != 0) {
+        ATX_LOG_SEVERE_1("pthread create failed with error %d", pres);
+        ATX_FreeMemory(*thread);
+        *thread = NULL;
+        return ATX_FAILURE;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Join
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_Join(ATX_Thread* self)
+{
+    int pres;
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    pres = pthread_join(self->thread, NULL);
+    ATX_Thread_Release(self);
+    if (pres != 0) {
+        ATX_LOG_SEVERE_1("pthread join failed with error %d", pres);
+        return ATX_FAILURE;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Detach
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_Detach(ATX_Thread* self)
+{
+    int pres;
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+
+    /* the thread keeps running on its own, and frees the object when done */
+    pres = pthread_detach(self->thread);
+    ATX_Thread_Release(self);
+    if (pres != 0) {
+        ATX_LOG_SEVERE_1("pthread detach failed with error %d", pres);
+        return ATX_FAILURE;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_GetId
++---------------------------------------------------------------------*/
+ATX_ThreadId
+ATX_Thread_GetId(ATX_Thread* self)
+{
+    return (ATX_ThreadId)((void*)self->thread);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_SetName
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_SetName(ATX_Thread* self, const char* name)
+{
+#if defined(__linux__)
+    char truncated[16];
+    if (self == NULL || name == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    ATX_CopyStringN(truncated, name, sizeof(truncated)-1);
+    truncated[sizeof(truncated)-1] = '\0';
+    return pthread_setname_np(self->thread, truncated) == 0 ? ATX_SUCCESS : ATX_FAILURE;
+#elif defined(__APPLE__)
+    if (self == NULL || name == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+
+    /* only the current thread can be named */
+    if (!pthread_equal(self->thread, pthread_self())) return ATX_ERROR_NOT_SUPPORTED;
+    return pthread_setname_np(name) == 0 ? ATX_SUCCESS : ATX_FAILURE;
+#else
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(name);
+    return ATX_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Add
++---------------------------------------------------------------------*/
+ATX_Int32
+ATX_AtomicInt_Add(ATX_AtomicInt* self, ATX_Int32 value)
+{
+    return __sync_add_and_fetch(&self->value, value);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_CompareAndSwap
++---------------------------------------------------------------------*/
+ATX_Boolean
+ATX_AtomicInt_CompareAndSwap(ATX_AtomicInt* self, 
+                             ATX_Int32      expected, 
+                             ATX_Int32      value)
+{
+    return __sync_bool_compare_and_swap(&self->value, expected, value) ? 
+           ATX_TRUE : ATX_FALSE;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Get
++---------------------------------------------------------------------*/
+ATX_Int32
+ATX_AtomicInt_Get(ATX_AtomicInt* self)
+{
+#if defined(__ATOMIC_SEQ_CST)
+    return __atomic_load_n(&self->value, __ATOMIC_SEQ_CST);
+#else
+    ATX_Int32 value = self->value;
+    __sync_synchronize();
+    return value;
+#endif
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Set
++---------------------------------------------------------------------*/
+void
+ATX_AtomicInt_Set(ATX_AtomicInt* self, ATX_Int32 value)
+{
+#if defined(__ATOMIC_SEQ_CST)
+    __atomic_store_n(&self->value, value, __ATOMIC_SEQ_CST);
+#else
+    __sync_synchronize();
+    self->value = value;
+    __sync_synchronize();
+#endif
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Exchange
++---------------------------------------------------------------------*/
+ATX_Int32
+ATX_AtomicInt_Exchange(ATX_AtomicInt* self, ATX_Int32 value)
+{
+#if defined(__ATOMIC_SEQ_CST)
+    return __atomic_exchange_n(&self->value, value, __ATOMIC_SEQ_CST);
+#else
+    __sync_synchronize();
+    return __sync_lock_test_and_set(&self->value, value);
+#endif
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_Get
++---------------------------------------------------------------------*/
+void*
+ATX_AtomicPointer_Get(ATX_AtomicPointer* self)
+{
+#if defined(__ATOMIC_SEQ_CST)
+    return __atomic_load_n(&self->value, __ATOMIC_SEQ_CST);
+#else
+    void* value = self->value;
+    __sync_synchronize();
+    return value;
+#endif
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_Set
++---------------------------------------------------------------------*/
+void
+ATX_AtomicPointer_Set(ATX_AtomicPointer* self, void* value)
+{
+#if defined(__ATOMIC_SEQ_CST)
+    __atomic_store_n(&self->value, value, __ATOMIC_SEQ_CST);
+#else
+    __sync_synchronize();
+    self->value = value;
+    __sync_synchronize();
+#endif
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_Exchange
++---------------------------------------------------------------------*/
+void*
+ATX_AtomicPointer_Exchange(ATX_AtomicPointer* self, void* value)
+{
+#if defined(__ATOMIC_SEQ_CST)
+    return __atomic_exchange_n(&self->value, value, __ATOMIC_SEQ_CST);
+#else
+    __sync_synchronize();
+    return __sync_lock_test_and_set(&self->value, value);
+#endif
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_CompareAndSwap
++---------------------------------------------------------------------*/
+ATX_Boolean
+ATX_AtomicPointer_CompareAndSwap(ATX_AtomicPointer* self, 
+                                 void*              expected, 
+                                 void*              value)
+{
+    return __sync_bool_compare_and_swap(&self->value, expected, value) ? 
+           ATX_TRUE : ATX_FALSE;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Create(ATX_Cardinal initial_count, ATX_Semaphore** semaphore)
+{
+    if (semaphore == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    *semaphore = ATX_AllocateZeroMemory(sizeof(ATX_Semaphore));
+    if (*semaphore == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+
+    /* unnamed POSIX semaphores are not available everywhere, */
+    /* so this is built on a mutex and a condition variable   */
+    pthread_mutex_init(&(*semaphore)->mutex, NULL);
+    pthread_cond_init(&(*semaphore)->condition, NULL);
+    (*semaphore)->count = initial_count;
+
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Destroy(ATX_Semaphore* self)
+{
+    if (self == NULL) return ATX_SUCCESS;
+    pthread_cond_destroy(&self->condition);
+    pthread_mutex_destroy(&self->mutex);
+    ATX_FreeMemory(self);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Wait
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Wait(ATX_Semaphore* self, ATX_Timeout timeout)
+{
+    struct timespec deadline;
+    ATX_Result      result = ATX_SUCCESS;
+
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    if (timeout != ATX_TIMEOUT_INFINITE) ATX_Posix_GetDeadline(timeout, &deadline);
+
+    pthread_mutex_lock(&self->mutex);
+    while (self->count == 0) {
+        int pres;
+        if (timeout == ATX_TIMEOUT_INFINITE) {
+            pres = pthread_cond_wait(&self->condition, &self->mutex);
+        } else {
+            pres = pthread_cond_timedwait(&self->condition, &self->mutex, &deadline);
+        }
+        if (pres == ETIMEDOUT) {
+            result = ATX_ERROR_WAIT_TIMEOUT;
+            break;
+        } else if (pres != 0) {
+            ATX_LOG_SEVERE_1("pthread cond wait failed with error %d", pres);
+            result = ATX_FAILURE;
+            break;
+        }
+    }
+    if (ATX_SUCCEEDED(result)) --self->count;
+    pthread_mutex_unlock(&self->mutex);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Post
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Post(ATX_Semaphore* self)
+{
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    pthread_mutex_lock(&self->mutex);
+    ++self->count;
+    pthread_cond_signal(&self->condition);
+    pthread_mutex_unlock(&self->mutex);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_ThreadLocal_Create(ATX_ThreadLocal** local)
+{
+    int pres;
+    if (local == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    *local = ATX_AllocateZeroMemory(sizeof(ATX_ThreadLocal));
+    if (*local == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    pres = pthread_key_create(&(*local)->key, NULL);
+    if (pres != 0) {
+        ATX_LOG_SEVERE_1("pthread key create failed with error %d", pres);
+        ATX_FreeMemory(*local);
+        *local = NULL;
+        return ATX_ERROR_OUT_OF_RESOURCES;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_ThreadLocal_Destroy(ATX_ThreadLocal* self)
+{
+    if (self == NULL) return ATX_SUCCESS;
+    pthread_key_delete(self->key);
+    ATX_FreeMemory(self);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Get
++---------------------------------------------------------------------*/
+void*
+ATX_ThreadLocal_Get(ATX_ThreadLocal* self)
+{
+    return pthread_getspecific(self->key);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Set
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_ThreadLocal_Set(ATX_ThreadLocal* self, void* value)
+{
+    return pthread_setspecific(self->key, value) == 0 ? ATX_SUCCESS : ATX_FAILURE;
+}
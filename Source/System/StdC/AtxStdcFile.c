@@ -58,21 +58,23 @@
 |       types
 +---------------------------------------------------------------------*/
 typedef struct {
-    ATX_Cardinal  reference_count;
+    ATX_AtomicInt reference_count;
     FILE*         file;
     ATX_LargeSize size;
     ATX_Position  position;
     ATX_String    name;
+    ATX_Boolean   sync;
 } StdcFileWrapper;
 
 typedef struct {
     /* interfaces */
     ATX_IMPLEMENTS(ATX_InputStream);
     ATX_IMPLEMENTS(ATX_OutputStream);
+    ATX_IMPLEMENTS(ATX_StreamDescriptor);
     ATX_IMPLEMENTS(ATX_Referenceable);
 
     /* members */
-    ATX_Cardinal     reference_count;
+    ATX_AtomicInt    reference_count;
     StdcFileWrapper* file;
 } StdcFileStream;
 
@@ -103,7 +105,7 @@ StdcFileWrapper_Create(FILE*             file,
     (*wrapper)->file            = file;
     (*wrapper)->size            = 0;
     (*wrapper)->position        = 0;
-    (*wrapper)->reference_count = 1;
+    ATX_AtomicInt_Set(&(*wrapper)->reference_count, 1);
     if (name) {
         ATX_String_Copy(&(*wrapper)->name, name);
     }
@@ -161,7 +163,7 @@ StdcFileWrapper_Destroy(StdcFileWrapper* self)
 static void
 StdcFileWrapper_AddReference(StdcFileWrapper* self)
 {
-    ++self->reference_count;
+    ATX_ATOMIC_INCREMENT(&self->reference_count);
 }
 
 /*----------------------------------------------------------------------
@@ -171,7 +173,7 @@ static void
 StdcFileWrapper_Release(StdcFileWrapper* self)
 {
     if (self == NULL) return;
-    if (--self->reference_count == 0) {
+    if (ATX_ATOMIC_DECREMENT(&self->reference_count) == 0) {
         StdcFileWrapper_Destroy(self);
     }
 }
@@ -181,6 +183,7 @@ StdcFileWrapper_Release(StdcFileWrapper* self)
 +---------------------------------------------------------------------*/
 ATX_DECLARE_INTERFACE_MAP(StdcFileStream, ATX_InputStream)
 ATX_DECLARE_INTERFACE_MAP(StdcFileStream, ATX_OutputStream)
+ATX_DECLARE_INTERFACE_MAP(StdcFileStream, ATX_StreamDescriptor)
 ATX_DECLARE_INTERFACE_MAP(StdcFileStream, ATX_Referenceable)
 
 /*----------------------------------------------------------------------
@@ -194,7 +197,7 @@ StdcFileStream_Create(StdcFileWrapper* file, StdcFileStream** stream)
     if (*stream == NULL) return ATX_ERROR_OUT_OF_MEMORY;
 
     /* construct the object */
-    (*stream)->reference_count = 1;
+    ATX_AtomicInt_Set(&(*stream)->reference_count, 1);
     (*stream)->file = file;
 
     /* keep a reference */
@@ -203,6 +206,7 @@ StdcFileStream_Create(StdcFileWrapper* file, StdcFileStream** stream)
     /* setup interfaces */
     ATX_SET_INTERFACE((*stream), StdcFileStream, ATX_InputStream);
     ATX_SET_INTERFACE((*stream), StdcFileStream, ATX_OutputStream);
+    ATX_SET_INTERFACE((*stream), StdcFileStream, ATX_StreamDescriptor);
     ATX_SET_INTERFACE((*stream), StdcFileStream, ATX_Referenceable);
 
     return ATX_SUCCESS;
@@ -249,7 +253,15 @@ StdcFileStream_Tell(StdcFileStream* self, ATX_Position* where)
 ATX_METHOD
 StdcFileStream_Flush(StdcFileStream* self)
 {
-    fflush(self->file->file);
+    if (fflush(self->file->file) != 0) return ATX_ERROR_ERRNO(errno);
+    if (self->file->sync) {
+        /* write the data (but not necessarily the metadata) to storage */
+#if defined(ATX_CONFIG_HAVE_UNISTD_H) && defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+        if (fdatasync(fileno(self->file->file)) != 0) return ATX_ERROR_ERRNO(errno);
+#elif defined(ATX_CONFIG_HAVE_UNISTD_H)
+        if (fsync(fileno(self->file->file)) != 0) return ATX_ERROR_ERRNO(errno);
+#endif
+    }
     return ATX_SUCCESS;
 }
 
@@ -447,12 +459,28 @@ StdcFileOutputStream_Flush(ATX_OutputStream* _self)
     return StdcFileStream_Flush(ATX_SELF(StdcFileStream, ATX_OutputStream));
 }
 
+/*----------------------------------------------------------------------
+|       StdcFileStream_GetDescriptor
++---------------------------------------------------------------------*/
+ATX_METHOD
+StdcFileStream_GetDescriptor(ATX_StreamDescriptor* _self,
+                             ATX_IntPtr*           descriptor)
+{
+    StdcFileStream* self = ATX_SELF(StdcFileStream, ATX_StreamDescriptor);
+    int             fd   = fileno(self->file->file);
+
+    if (fd < 0) return ATX_ERROR_NOT_SUPPORTED;
+    *descriptor = (ATX_IntPtr)fd;
+    return ATX_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
 |   GetInterface implementation
 +---------------------------------------------------------------------*/
 ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(StdcFileStream)
     ATX_GET_INTERFACE_ACCEPT(StdcFileStream, ATX_InputStream)
     ATX_GET_INTERFACE_ACCEPT(StdcFileStream, ATX_OutputStream)
+    ATX_GET_INTERFACE_ACCEPT(StdcFileStream, ATX_StreamDescriptor)
     ATX_GET_INTERFACE_ACCEPT(StdcFileStream, ATX_Referenceable)
 ATX_END_GET_INTERFACE_IMPLEMENTATION
 
@@ -477,10 +505,17 @@ ATX_BEGIN_INTERFACE_MAP(StdcFileStream, ATX_OutputStream)
     StdcFileOutputStream_Flush
 ATX_END_INTERFACE_MAP
 
+/*----------------------------------------------------------------------
+|       ATX_StreamDescriptor interface
++---------------------------------------------------------------------*/
+ATX_BEGIN_INTERFACE_MAP(StdcFileStream, ATX_StreamDescriptor)
+    StdcFileStream_GetDescriptor
+ATX_END_INTERFACE_MAP
+
 /*----------------------------------------------------------------------
 |       ATX_Referenceable interface
 +---------------------------------------------------------------------*/
-ATX_IMPLEMENT_REFERENCEABLE_INTERFACE(StdcFileStream, reference_count)
+ATX_IMPLEMENT_ATOMIC_REFERENCEABLE_INTERFACE(StdcFileStream, reference_count)
 
 /*----------------------------------------------------------------------
 |       forward declarations
@@ -514,6 +549,39 @@ ATX_File_Create(const char* filename, ATX_File** object)
     return ATX_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+|       StdcFile_MapErrno
++---------------------------------------------------------------------*/
+static ATX_Result
+StdcFile_MapErrno(int err)
+{
+    switch (err) {
+      case EACCES: return ATX_ERROR_ACCESS_DENIED;
+      case ENOENT: return ATX_ERROR_NO_SUCH_FILE;
+      default:     return ATX_ERROR_ERRNO(err);
+    }
+}
+
+/*----------------------------------------------------------------------
+|       ATX_File_Rename
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_File_Rename(const char* old_name, const char* new_name)
+{
+    if (rename(old_name, new_name) != 0) return StdcFile_MapErrno(errno);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|       ATX_File_Remove
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_File_Remove(const char* name)
+{
+    if (remove(name) != 0) return StdcFile_MapErrno(errno);
+    return ATX_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
 |       StdcFile_Destroy
 +---------------------------------------------------------------------*/
@@ -606,7 +674,10 @@ StdcFile_Open(ATX_File* _self, ATX_Flags mode)
     self->mode = mode;
 
     /* create a wrapper */
-    return StdcFileWrapper_Create(stdc_file, &self->name, &self->file);
+    ATX_CHECK(StdcFileWrapper_Create(stdc_file, &self->name, &self->file));
+    self->file->sync = (mode & ATX_FILE_OPEN_MODE_SYNC) ? ATX_TRUE : ATX_FALSE;
+
+    return ATX_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
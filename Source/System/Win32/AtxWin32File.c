@@ -53,11 +53,12 @@
 |   types
 +---------------------------------------------------------------------*/
 typedef struct {
-    ATX_Cardinal  reference_count;
+    ATX_AtomicInt reference_count;
     HANDLE        handle;
     ATX_LargeSize size;
     ATX_Position  position;
     ATX_Boolean   append_mode;
+    ATX_Boolean   sync;
 } Win32FileHandleWrapper;
 
 typedef struct {
@@ -67,7 +68,7 @@ typedef struct {
     ATX_IMPLEMENTS(ATX_Referenceable);
 
     /* members */
-    ATX_Cardinal            reference_count;
+    ATX_AtomicInt           reference_count;
     Win32FileHandleWrapper* file;
 } Win32FileStream;
 
@@ -125,7 +126,7 @@ Win32FileHandleWrapper_Create(HANDLE                   handle,
     /* construct the object */
     (*wrapper)->handle          = handle;
     (*wrapper)->append_mode     = append_mode;
-    (*wrapper)->reference_count = 1;
+    ATX_AtomicInt_Set(&(*wrapper)->reference_count, 1);
 
     /* initialize the object */
     Win32FileHandleWrapper_UpdateSize(*wrapper);
@@ -158,7 +159,7 @@ Win32FileHandleWrapper_Destroy(Win32FileHandleWrapper* self)
 static void
 Win32FileHandleWrapper_AddReference(Win32FileHandleWrapper* self)
 {
-    ++self->reference_count;
+    ATX_ATOMIC_INCREMENT(&self->reference_count);
 }
 
 /*----------------------------------------------------------------------
@@ -168,7 +169,7 @@ static void
 Win32FileHandleWrapper_Release(Win32FileHandleWrapper* self)
 {
     if (self == NULL) return;
-    if (--self->reference_count == 0) {
+    if (ATX_ATOMIC_DECREMENT(&self->reference_count) == 0) {
         Win32FileHandleWrapper_Destroy(self);
     }
 }
@@ -192,7 +193,7 @@ Win32FileStream_Create(Win32FileHandleWrapper* file,
     if (*stream == NULL) return ATX_ERROR_OUT_OF_MEMORY;
 
     /* construct the object */
-    (*stream)->reference_count = 1;
+    ATX_AtomicInt_Set(&(*stream)->reference_count, 1);
     (*stream)->file = file;
 
     /* keep a reference to the file */
@@ -440,7 +441,12 @@ Win32FileOutputStream_Tell(ATX_OutputStream* _self,
 ATX_METHOD
 Win32FileOutputStream_Flush(ATX_OutputStream* _self)
 {
-    ATX_COMPILER_UNUSED(_self);
+    Win32FileStream* self = ATX_SELF(Win32FileStream, ATX_OutputStream);
+
+    /* writes are not buffered, so there's only something to do in sync mode */
+    if (self->file->sync && !FlushFileBuffers(self->file->handle)) {
+        return MapError(GetLastError());
+    }
     return ATX_SUCCESS;
 }
 
@@ -477,7 +483,7 @@ ATX_END_INTERFACE_MAP
 /*----------------------------------------------------------------------
 |   ATX_Referenceable interface
 +---------------------------------------------------------------------*/
-ATX_IMPLEMENT_REFERENCEABLE_INTERFACE(Win32FileStream, reference_count)
+ATX_IMPLEMENT_ATOMIC_REFERENCEABLE_INTERFACE(Win32FileStream, reference_count)
 
 /*----------------------------------------------------------------------
 |   forward declarations
@@ -507,6 +513,59 @@ CreateFile_UTF8(LPCSTR lpFileName,
     return handle;
 }
 
+/*----------------------------------------------------------------------
+|   ToWideName
++---------------------------------------------------------------------*/
+static WCHAR*
+ToWideName(const char* name)
+{
+    unsigned int name_length = ATX_StringLength(name);
+    WCHAR*       name_w = ATX_AllocateMemory(2*(name_length+1));
+    if (name_w) MultiByteToWideChar(CP_UTF8, 0, name, -1, name_w, name_length+1);
+    return name_w;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_File_Rename
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_File_Rename(const char* old_name, const char* new_name)
+{
+    WCHAR*     old_name_w = ToWideName(old_name);
+    WCHAR*     new_name_w = ToWideName(new_name);
+    ATX_Result result = ATX_ERROR_OUT_OF_MEMORY;
+
+    if (old_name_w && new_name_w) {
+#if defined(_WIN32_WCE)
+        DeleteFileW(new_name_w);
+        result = MoveFileW(old_name_w, new_name_w) ? ATX_SUCCESS : MapError(GetLastError());
+#else
+        result = MoveFileExW(old_name_w, new_name_w, MOVEFILE_REPLACE_EXISTING) ?
+                 ATX_SUCCESS : MapError(GetLastError());
+#endif
+    }
+    if (old_name_w) ATX_FreeMemory(old_name_w);
+    if (new_name_w) ATX_FreeMemory(new_name_w);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_File_Remove
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_File_Remove(const char* name)
+{
+    WCHAR*     name_w = ToWideName(name);
+    ATX_Result result;
+
+    if (name_w == NULL) return ATX_ERROR_OUT_OF_MEMORY;
+    result = DeleteFileW(name_w) ? ATX_SUCCESS : MapError(GetLastError());
+    ATX_FreeMemory(name_w);
+
+    return result;
+}
+
 /*----------------------------------------------------------------------
 |   ATX_File_Create
 +---------------------------------------------------------------------*/
@@ -615,7 +674,10 @@ Win32File_Open(ATX_File* _self, ATX_Flags mode)
     self->mode = mode;
 
     /* create a handle wrapper */
-    return Win32FileHandleWrapper_Create(handle, (mode&ATX_FILE_OPEN_MODE_APPEND)?ATX_TRUE:ATX_FALSE, &self->file);
+    ATX_CHECK(Win32FileHandleWrapper_Create(handle, (mode&ATX_FILE_OPEN_MODE_APPEND)?ATX_TRUE:ATX_FALSE, &self->file));
+    self->file->sync = (mode & ATX_FILE_OPEN_MODE_SYNC) ? ATX_TRUE : ATX_FALSE;
+
+    return ATX_SUCCESS;
 }
 
 /*----------------------------------------------------------------------
@@ -49,6 +49,26 @@ struct ATX_Mutex {
     CRITICAL_SECTION mutex;
 };
 
+struct ATX_Condition {
+    CONDITION_VARIABLE condition;
+};
+
+struct ATX_Semaphore {
+    HANDLE handle;
+};
+
+struct ATX_Thread {
+    HANDLE             handle;
+    DWORD              id;
+    ATX_ThreadFunction function;
+    void*              arg;
+    ATX_AtomicInt      references; /* the owner and the thread itself */
+};
+
+struct ATX_ThreadLocal {
+    DWORD index;
+};
+
 /*----------------------------------------------------------------------
 |   ATX_Mutex_Create
 +---------------------------------------------------------------------*/
@@ -138,3 +158,381 @@ ATX_GetCurrentThreadId(void)
 {
     return GetCurrentThreadId();
 }
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Create(ATX_Condition** condition)
+{
+    if (condition == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    *condition = ATX_AllocateZeroMemory(sizeof(ATX_Condition));
+    if (*condition == NULL) {
+        ATX_CHECK_SEVERE(ATX_ERROR_OUT_OF_MEMORY);
+    }
+    InitializeConditionVariable(&(*condition)->condition);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Destroy(ATX_Condition* self)
+{
+    if (self == NULL) return ATX_SUCCESS;
+    ATX_FreeMemory(self);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Wait
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Wait(ATX_Condition* self, ATX_Mutex* mutex, ATX_Timeout timeout)
+{
+    if (self == NULL || mutex == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    if (!SleepConditionVariableCS(&self->condition, 
+                                  &mutex->mutex, 
+                                  timeout == ATX_TIMEOUT_INFINITE ? INFINITE : (DWORD)timeout)) {
+        if (GetLastError() == ERROR_TIMEOUT) return ATX_ERROR_WAIT_TIMEOUT;
+        return ATX_FAILURE;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Signal
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Signal(ATX_Condition* self)
+{
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    WakeConditionVariable(&self->condition);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Condition_Broadcast
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Condition_Broadcast(ATX_Condition* self)
+{
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    WakeAllConditionVariable(&self->condition);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Release
++---------------------------------------------------------------------*/
+static void
+ATX_Thread_Release(ATX_Thread* self)
+{
+    if (ATX_AtomicInt_Add(&self->references, -1) == 0) {
+        ATX_FreeMemory(self);
+    }
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_EntryPoint
++---------------------------------------------------------------------*/
+static DWORD WINAPI
+ATX_Thread_EntryPoint(LPVOID arg)
+{
+    ATX_Thread* self = (ATX_Thread*)arg;
+    self->function(self->arg);
+    ATX_Thread_Release(self);
+    return 0;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_Create(ATX_ThreadFunction function, void* arg, ATX_Thread** thread)
+{
+    if (function == NULL || thread == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    *thread = ATX_AllocateZeroMemory(sizeof(ATX_Thread));
+    if (*thread == NULL) {
+        ATX_CHECK_SEVERE(ATX_ERROR_OUT_OF_MEMORY);
+    }
+    (*thread)->function = function;
+    (*thread)->arg      = arg;
+    ATX_AtomicInt_Set(&(*thread)->references, 2);
+    (*thread)->handle   = CreateThread(NULL, 0, ATX_Thread_EntryPoint, *thread, 0, &(*thread)->id);
+    if ((*thread)->handle == NULL) {
+        ATX_LOG_SEVERE_1("CreateThread failed with error %d", GetLastError());
+        ATX_FreeMemory(*thread);
+        *thread = NULL;
+        return ATX_FAILURE;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Join
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_Join(ATX_Thread* self)
+{
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    WaitForSingleObject(self->handle, INFINITE);
+    CloseHandle(self->handle);
+    ATX_Thread_Release(self);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_Detach
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_Detach(ATX_Thread* self)
+{
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    CloseHandle(self->handle);
+    ATX_Thread_Release(self);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_GetId
++---------------------------------------------------------------------*/
+ATX_ThreadId
+ATX_Thread_GetId(ATX_Thread* self)
+{
+    return self->id;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Thread_SetName
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Thread_SetName(ATX_Thread* self, const char* name)
+{
+    /* SetThreadDescription is not available on all supported versions */
+    ATX_COMPILER_UNUSED(self);
+    ATX_COMPILER_UNUSED(name);
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Create(ATX_Cardinal initial_count, ATX_Semaphore** semaphore)
+{
+    if (semaphore == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    *semaphore = ATX_AllocateZeroMemory(sizeof(ATX_Semaphore));
+    if (*semaphore == NULL) {
+        ATX_CHECK_SEVERE(ATX_ERROR_OUT_OF_MEMORY);
+    }
+    (*semaphore)->handle = CreateSemaphore(NULL, (LONG)initial_count, 0x7FFFFFFF, NULL);
+    if ((*semaphore)->handle == NULL) {
+        ATX_FreeMemory(*semaphore);
+        *semaphore = NULL;
+        return ATX_ERROR_OUT_OF_RESOURCES;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Destroy(ATX_Semaphore* self)
+{
+    if (self == NULL) return ATX_SUCCESS;
+    CloseHandle(self->handle);
+    ATX_FreeMemory(self);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Wait
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Wait(ATX_Semaphore* self, ATX_Timeout timeout)
+{
+    DWORD result;
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    result = WaitForSingleObject(self->handle, 
+                                 timeout == ATX_TIMEOUT_INFINITE ? INFINITE : (DWORD)timeout);
+    if (result == WAIT_TIMEOUT) return ATX_ERROR_WAIT_TIMEOUT;
+    return result == WAIT_OBJECT_0 ? ATX_SUCCESS : ATX_FAILURE;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_Semaphore_Post
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_Semaphore_Post(ATX_Semaphore* self)
+{
+    if (self == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    return ReleaseSemaphore(self->handle, 1, NULL) ? ATX_SUCCESS : ATX_FAILURE;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Create
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_ThreadLocal_Create(ATX_ThreadLocal** local)
+{
+    if (local == NULL) {
+        ATX_CHECK_WARNING(ATX_ERROR_INVALID_PARAMETERS);
+    }
+    *local = ATX_AllocateZeroMemory(sizeof(ATX_ThreadLocal));
+    if (*local == NULL) {
+        ATX_CHECK_SEVERE(ATX_ERROR_OUT_OF_MEMORY);
+    }
+    (*local)->index = TlsAlloc();
+    if ((*local)->index == TLS_OUT_OF_INDEXES) {
+        ATX_FreeMemory(*local);
+        *local = NULL;
+        return ATX_ERROR_OUT_OF_RESOURCES;
+    }
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Destroy
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_ThreadLocal_Destroy(ATX_ThreadLocal* self)
+{
+    if (self == NULL) return ATX_SUCCESS;
+    TlsFree(self->index);
+    ATX_FreeMemory(self);
+    return ATX_SUCCESS;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Get
++---------------------------------------------------------------------*/
+void*
+ATX_ThreadLocal_Get(ATX_ThreadLocal* self)
+{
+    return TlsGetValue(self->index);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_ThreadLocal_Set
++---------------------------------------------------------------------*/
+ATX_Result
+ATX_ThreadLocal_Set(ATX_ThreadLocal* self, void* value)
+{
+    return TlsSetValue(self->index, value) ? ATX_SUCCESS : ATX_FAILURE;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Add
++---------------------------------------------------------------------*/
+ATX_Int32
+ATX_AtomicInt_Add(ATX_AtomicInt* self, ATX_Int32 value)
+{
+    return InterlockedExchangeAdd((volatile LONG*)&self->value, value)+value;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_CompareAndSwap
++---------------------------------------------------------------------*/
+ATX_Boolean
+ATX_AtomicInt_CompareAndSwap(ATX_AtomicInt* self, 
+                             ATX_Int32      expected, 
+                             ATX_Int32      value)
+{
+    return InterlockedCompareExchange((volatile LONG*)&self->value, 
+                                      value, 
+                                      expected) == expected ? ATX_TRUE : ATX_FALSE;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Get
++---------------------------------------------------------------------*/
+ATX_Int32
+ATX_AtomicInt_Get(ATX_AtomicInt* self)
+{
+    ATX_Int32 value = self->value;
+    MemoryBarrier();
+    return value;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Set
++---------------------------------------------------------------------*/
+void
+ATX_AtomicInt_Set(ATX_AtomicInt* self, ATX_Int32 value)
+{
+    InterlockedExchange((volatile LONG*)&self->value, value);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicInt_Exchange
++---------------------------------------------------------------------*/
+ATX_Int32
+ATX_AtomicInt_Exchange(ATX_AtomicInt* self, ATX_Int32 value)
+{
+    return InterlockedExchange((volatile LONG*)&self->value, value);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_Get
++---------------------------------------------------------------------*/
+void*
+ATX_AtomicPointer_Get(ATX_AtomicPointer* self)
+{
+    void* value = self->value;
+    MemoryBarrier();
+    return value;
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_Set
++---------------------------------------------------------------------*/
+void
+ATX_AtomicPointer_Set(ATX_AtomicPointer* self, void* value)
+{
+    InterlockedExchangePointer(&self->value, value);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_Exchange
++---------------------------------------------------------------------*/
+void*
+ATX_AtomicPointer_Exchange(ATX_AtomicPointer* self, void* value)
+{
+    return InterlockedExchangePointer(&self->value, value);
+}
+
+/*----------------------------------------------------------------------
+|   ATX_AtomicPointer_CompareAndSwap
++---------------------------------------------------------------------*/
+ATX_Boolean
+ATX_AtomicPointer_CompareAndSwap(ATX_AtomicPointer* self, 
+                                 void*              expected, 
+                                 void*              value)
+{
+    return InterlockedCompareExchangePointer(&self->value, 
+                                             value, 
+                                             expected) == expected ? ATX_TRUE : ATX_FALSE;
+}
@@ -0,0 +1,363 @@
+/*****************************************************************
+|
+|      Allocators Test Program
+|
+| Copyright (c) 2002-2010, Axiomatic Systems, LLC.
+| All rights reserved.
+|
+| Redistribution and use in source and binary forms, with or without
+| modification, are permitted provided that the following conditions are met:
+|     * Redistributions of source code must retain the above copyright
+|       notice, this list of conditions and the following disclaimer.
+|     * Redistributions in binary form must reproduce the above copyright
+|       notice, this list of conditions and the following disclaimer in the
+|       documentation and/or other materials provided with the distribution.
+|     * Neither the name of Axiomatic Systems nor the
+|       names of its contributors may be used to endorse or promote products
+|       derived from this software without specific prior written permission.
+|
+| THIS SOFTWARE IS PROVIDED BY AXIOMATIC SYSTEMS ''AS IS'' AND ANY
+| EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+| WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+| DISCLAIMED. IN NO EVENT SHALL AXIOMATIC SYSTEMS BE LIABLE FOR ANY
+| DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+| (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+| LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+| ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+| (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+| SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+|
+ ****************************************************************/
+
+/*----------------------------------------------------------------------
+|       includes
++---------------------------------------------------------------------*/
+#include "Atomix.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+/*----------------------------------------------------------------------
+|       macros
++---------------------------------------------------------------------*/
+#define SHOULD_SUCCEED(r)                                   \
+    do {                                                    \
+        ATX_Result x = r;                                   \
+        if (ATX_FAILED(x)) {                                \
+            printf("failed line %d (%d)\n", __LINE__, x);   \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)                                         
+
+#define CHECK(x)                                            \
+    do {                                                    \
+        if (!(x)) {                                         \
+            printf("check failed line %d\n", __LINE__);     \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)                                         
+
+
+/*----------------------------------------------------------------------
+|       types
++---------------------------------------------------------------------*/
+typedef struct {
+    ATX_Allocator base;
+    unsigned int  allocations;
+    unsigned int  reallocations;
+    unsigned int  frees;
+} CountingAllocator;
+
+/*----------------------------------------------------------------------
+|       CountingAllocator
++---------------------------------------------------------------------*/
+static void*
+CountingAllocator_Allocate(void* context, ATX_Size size)
+{
+    CountingAllocator* self = (CountingAllocator*)context;
+    ++self->allocations;
+    return ATX_Allocator_Allocate(ATX_GetDefaultAllocator(), size);
+}
+
+static void*
+CountingAllocator_Reallocate(void* context, void* memory, ATX_Size size)
+{
+    CountingAllocator* self = (CountingAllocator*)context;
+    if (memory == NULL) ++self->allocations;
+    ++self->reallocations;
+    return ATX_Allocator_Reallocate(ATX_GetDefaultAllocator(), memory, size);
+}
+
+static void
+CountingAllocator_Free(void* context, void* memory)
+{
+    CountingAllocator* self = (CountingAllocator*)context;
+    if (memory) ++self->frees;
+    ATX_Allocator_Free(ATX_GetDefaultAllocator(), memory);
+}
+
+static void
+CountingAllocator_Init(CountingAllocator* self)
+{
+    self->base.Allocate   = CountingAllocator_Allocate;
+    self->base.Reallocate = CountingAllocator_Reallocate;
+    self->base.Free       = CountingAllocator_Free;
+    self->base.context    = self;
+    self->allocations     = 0;
+    self->reallocations   = 0;
+    self->frees           = 0;
+}
+
+/*----------------------------------------------------------------------
+|       HooksTest
++---------------------------------------------------------------------*/
+static void
+HooksTest(void)
+{
+    CountingAllocator counter;
+    ATX_Allocator     incomplete;
+    ATX_String        s = ATX_EMPTY_STRING;
+    ATX_StringBuilder b = ATX_EMPTY_STRING_BUILDER;
+    ATX_List*         list;
+    ATX_Json*         json;
+    unsigned int      i;
+
+    CHECK(ATX_GetAllocator() == ATX_GetDefaultAllocator());
+
+    /* an allocator must have all its functions */
+    CountingAllocator_Init(&counter);
+    incomplete = counter.base;
+    incomplete.Reallocate = NULL;
+    CHECK(ATX_SetAllocator(&incomplete) == ATX_ERROR_INVALID_PARAMETERS);
+    CHECK(ATX_GetAllocator() == ATX_GetDefaultAllocator());
+
+    /* everything goes through the installed allocator */
+    SHOULD_SUCCEED(ATX_SetAllocator(&counter.base));
+    CHECK(ATX_GetAllocator() == &counter.base);
+
+    SHOULD_SUCCEED(ATX_String_Assign(&s, "a string that is too long to be stored inline"));
+    for (i=0; i<100; i++) {
+        SHOULD_SUCCEED(ATX_StringBuilder_AppendFormat(&b, "%u,", i));
+    }
+    CHECK(counter.reallocations > 0);
+    SHOULD_SUCCEED(ATX_List_Create(&list));
+    for (i=0; i<10; i++) {
+        SHOULD_SUCCEED(ATX_List_AddData(list, NULL));
+    }
+    SHOULD_SUCCEED(ATX_Json_Parse("{\"a\":[1,2,3],\"b\":{\"c\":\"a long string value, not inline\"}}", &json));
+    CHECK(counter.allocations > 10);
+    CHECK(counter.frees < counter.allocations);
+
+    ATX_Json_Destroy(json);
+    ATX_List_Destroy(list);
+    ATX_StringBuilder_Destruct(&b);
+    ATX_String_Destruct(&s);
+    CHECK(counter.frees == counter.allocations);
+
+    SHOULD_SUCCEED(ATX_SetAllocator(NULL));
+    CHECK(ATX_GetAllocator() == ATX_GetDefaultAllocator());
+}
+
+/*----------------------------------------------------------------------
+|       PoolTest
++---------------------------------------------------------------------*/
+static void
+PoolTest(void)
+{
+    CountingAllocator    counter;
+    ATX_MemoryPool*      pool;
+    const ATX_Allocator* allocator;
+    void*                blocks[10];
+    void*                block;
+    unsigned int         i;
+
+    CountingAllocator_Init(&counter);
+    CHECK(ATX_MemoryPool_Create(0, 4, &counter.base, &pool) == ATX_ERROR_INVALID_PARAMETERS);
+    SHOULD_SUCCEED(ATX_MemoryPool_Create(20, 4, &counter.base, &pool));
+    CHECK(ATX_MemoryPool_GetBlockSize(pool) == 24);
+    CHECK(counter.allocations == 1);
+
+    /* blocks are distinct, aligned and usable */
+    for (i=0; i<10; i++) {
+        blocks[i] = ATX_MemoryPool_Allocate(pool);
+        CHECK(blocks[i] != NULL);
+        CHECK(((ATX_UIntPtr)blocks[i] & 7) == 0);
+        ATX_SetMemory(blocks[i], (int)i, 24);
+    }
+    for (i=0; i<10; i++) {
+        CHECK(((unsigned char*)blocks[i])[0]  == i);
+        CHECK(((unsigned char*)blocks[i])[23] == i);
+    }
+
+    /* 10 blocks, 4 per chunk */
+    CHECK(counter.allocations == 1+3);
+
+    /* freed blocks are reused before the pool grows */
+    ATX_MemoryPool_Free(pool, blocks[3]);
+    ATX_MemoryPool_Free(pool, blocks[7]);
+    CHECK(ATX_MemoryPool_Allocate(pool) == blocks[7]);
+    CHECK(ATX_MemoryPool_Allocate(pool) == blocks[3]);
+    ATX_MemoryPool_Allocate(pool);
+    ATX_MemoryPool_Allocate(pool);
+    CHECK(counter.allocations == 1+3);
+    ATX_MemoryPool_Allocate(pool);
+    CHECK(counter.allocations == 1+4);
+
+    /* allocator view */
+    allocator = ATX_MemoryPool_GetAllocator(pool);
+    CHECK(ATX_Allocator_Allocate(allocator, 25) == NULL);
+    block = ATX_Allocator_Allocate(allocator, 16);
+    CHECK(block != NULL);
+    CHECK(ATX_Allocator_Reallocate(allocator, block, 24) == block);
+    CHECK(ATX_Allocator_Reallocate(allocator, block, 32) == NULL);
+    ATX_Allocator_Free(allocator, block);
+    CHECK(ATX_MemoryPool_Allocate(pool) == block);
+
+    SHOULD_SUCCEED(ATX_MemoryPool_Destroy(pool));
+    CHECK(counter.frees == counter.allocations);
+}
+
+/*----------------------------------------------------------------------
+|       ArenaTest
++---------------------------------------------------------------------*/
+static void
+ArenaTest(void)
+{
+    CountingAllocator    counter;
+    ATX_MemoryArena*     arena;
+    const ATX_Allocator* allocator;
+    unsigned char*       a;
+    unsigned char*       b;
+    unsigned char*       c;
+    unsigned char*       large;
+    ATX_MemoryArenaMark  mark;
+    unsigned int         allocations;
+    unsigned int         i;
+    unsigned int         j;
+
+    CountingAllocator_Init(&counter);
+    SHOULD_SUCCEED(ATX_MemoryArena_Create(1024, &counter.base, &arena));
+    allocator = ATX_MemoryArena_GetAllocator(arena);
+    CHECK(ATX_MemoryArena_GetSize(arena) == 0);
+
+    /* bump allocations are contiguous and aligned */
+    a = (unsigned char*)ATX_MemoryArena_Allocate(arena, 10);
+    b = (unsigned char*)ATX_MemoryArena_Allocate(arena, 16);
+    CHECK(a != NULL && b != NULL);
+    CHECK(b == a+16);
+    CHECK(ATX_MemoryArena_GetSize(arena) == 32);
+    CHECK(counter.allocations == 2);
+
+    /* the most recent allocation grows, shrinks and is freed in place */
+    ATX_SetMemory(b, 'b', 16);
+    CHECK(ATX_Allocator_Reallocate(allocator, b, 100) == b);
+    CHECK(ATX_MemoryArena_GetSize(arena) == 16+104);
+    CHECK(ATX_Allocator_Reallocate(allocator, b, 8) == b);
+    CHECK(ATX_MemoryArena_GetSize(arena) == 16+8);
+    ATX_Allocator_Free(allocator, b);
+    CHECK(ATX_MemoryArena_GetSize(arena) == 16);
+    CHECK(ATX_MemoryArena_Allocate(arena, 8) == b);
+
+    /* older allocations are copied */
+    ATX_SetMemory(a, 'a', 10);
+    c = (unsigned char*)ATX_Allocator_Reallocate(allocator, a, 40);
+    CHECK(c != NULL && c != a);
+    for (i=0; i<10; i++) CHECK(c[i] == 'a');
+
+    /* large allocations get their own chunk without wasting the current one */
+    large = (unsigned char*)ATX_MemoryArena_Allocate(arena, 4000);
+    CHECK(large != NULL);
+    ATX_SetMemory(large, 'L', 4000);
+    CHECK(counter.allocations == 3);
+    CHECK(ATX_MemoryArena_Allocate(arena, 8) == c+40);
+    large = (unsigned char*)ATX_Allocator_Reallocate(allocator, large, 5000);
+    CHECK(large != NULL);
+    CHECK(large[0] == 'L' && large[3999] == 'L');
+
+    /* filling up the current chunk starts a new one */
+    for (i=0; i<100; i++) {
+        CHECK(ATX_MemoryArena_Allocate(arena, 64) != NULL);
+    }
+    CHECK(counter.allocations > 4);
+
+    /* rewinding releases what was allocated after the mark, large */
+    /* chunks included                                              */
+    ATX_MemoryArena_GetMark(arena, &mark);
+    allocations = counter.allocations;
+    i           = counter.frees;
+    c = (unsigned char*)ATX_MemoryArena_Allocate(arena, 8);
+    CHECK(ATX_MemoryArena_Allocate(arena, 4000) != NULL);
+    for (j=0; j<100; j++) {
+        CHECK(ATX_MemoryArena_Allocate(arena, 64) != NULL);
+    }
+    ATX_MemoryArena_Rewind(arena, &mark);
+    CHECK(ATX_MemoryArena_GetSize(arena) == mark.allocated);
+    CHECK(counter.frees-i == counter.allocations-allocations);
+    CHECK(ATX_MemoryArena_Allocate(arena, 8) == c);
+
+    /* a reset keeps one chunk for reuse */
+    ATX_MemoryArena_Reset(arena);
+    CHECK(ATX_MemoryArena_GetSize(arena) == 0);
+    CHECK(counter.allocations-counter.frees == 2);
+    i = counter.allocations;
+    CHECK(ATX_MemoryArena_Allocate(arena, 512) != NULL);
+    CHECK(counter.allocations == i);
+
+    SHOULD_SUCCEED(ATX_MemoryArena_Destroy(arena));
+    CHECK(counter.frees == counter.allocations);
+}
+
+/*----------------------------------------------------------------------
+|       JsonArenaTest
++---------------------------------------------------------------------*/
+static void
+JsonArenaTest(void)
+{
+    CountingAllocator counter;
+    ATX_MemoryArena*  arena;
+    ATX_JsonArena*    json_arena;
+    ATX_Json*         json;
+    const char*       text = "{\"id\":1,\"name\":\"request-scoped parse, all in one arena\",\"tags\":[\"a\",\"b\"]}";
+    unsigned int      i;
+
+    /* a request-scoped parse, allocated entirely from one arena */
+    CountingAllocator_Init(&counter);
+    SHOULD_SUCCEED(ATX_MemoryArena_Create(16384, &counter.base, &arena));
+    for (i=0; i<3; i++) {
+        SHOULD_SUCCEED(ATX_JsonArena_CreateWithAllocator(4096, 
+                                                         ATX_MemoryArena_GetAllocator(arena),
+                                                         &json_arena));
+        SHOULD_SUCCEED(ATX_Json_ParseBufferEx(text, ATX_StringLength(text), json_arena, &json));
+        CHECK(ATX_Json_AsInteger(ATX_Json_GetChild(json, "id")) == 1);
+        CHECK(ATX_String_Equals(ATX_Json_AsString(ATX_Json_GetChild(json, "name")), 
+                                "request-scoped parse, all in one arena", 
+                                ATX_FALSE));
+        CHECK(ATX_Json_GetChildCount(ATX_Json_GetChild(json, "tags")) == 2);
+        CHECK(ATX_MemoryArena_GetSize(arena) > 0);
+        SHOULD_SUCCEED(ATX_JsonArena_Destroy(json_arena));
+        ATX_MemoryArena_Reset(arena);
+    }
+
+    /* the arena object and a single chunk */
+    CHECK(counter.allocations == 2);
+
+    SHOULD_SUCCEED(ATX_MemoryArena_Destroy(arena));
+    CHECK(counter.frees == counter.allocations);
+}
+
+/*----------------------------------------------------------------------
+|       main
++---------------------------------------------------------------------*/
+int
+main(int argc, char** argv)
+{
+    ATX_COMPILER_UNUSED(argc);
+    ATX_COMPILER_UNUSED(argv);
+
+    HooksTest();
+    PoolTest();
+    ArenaTest();
+    JsonArenaTest();
+
+    printf("allocators test passed\n");
+    return 0;
+}
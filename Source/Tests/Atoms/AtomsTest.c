@@ -0,0 +1,208 @@
+/*****************************************************************
+|
+|      Atoms Test Program
+|
+| Copyright (c) 2002-2010, Axiomatic Systems, LLC.
+| All rights reserved.
+|
+| Redistribution and use in source and binary forms, with or without
+| modification, are permitted provided that the following conditions are met:
+|     * Redistributions of source code must retain the above copyright
+|       notice, this list of conditions and the following disclaimer.
+|     * Redistributions in binary form must reproduce the above copyright
+|       notice, this list of conditions and the following disclaimer in the
+|       documentation and/or other materials provided with the distribution.
+|     * Neither the name of Axiomatic Systems nor the
+|       names of its contributors may be used to endorse or promote products
+|       derived from this software without specific prior written permission.
+|
+| THIS SOFTWARE IS PROVIDED BY AXIOMATIC SYSTEMS ''AS IS'' AND ANY
+| EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+| WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+| DISCLAIMED. IN NO EVENT SHALL AXIOMATIC SYSTEMS BE LIABLE FOR ANY
+| DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+| (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+| LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+| ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+| (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+| SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+|
+ ****************************************************************/
+
+/*----------------------------------------------------------------------
+|       includes
++---------------------------------------------------------------------*/
+#include "Atomix.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+/*----------------------------------------------------------------------
+|       macros
++---------------------------------------------------------------------*/
+#define SHOULD_SUCCEED(r)                                   \
+    do {                                                    \
+        ATX_Result x = r;                                   \
+        if (ATX_FAILED(x)) {                                \
+            printf("failed line %d (%d)\n", __LINE__, x);   \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)                                         
+
+#define CHECK(x)                                            \
+    do {                                                    \
+        if (!(x)) {                                         \
+            printf("check failed line %d\n", __LINE__);     \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)                                         
+
+/*----------------------------------------------------------------------
+|       constants
++---------------------------------------------------------------------*/
+#define THREAD_COUNT 8
+#define NAME_COUNT   2000
+
+/*----------------------------------------------------------------------
+|       types
++---------------------------------------------------------------------*/
+typedef struct {
+    ATX_Atom atoms[NAME_COUNT];
+} WorkerArgs;
+
+/*----------------------------------------------------------------------
+|       Worker
++---------------------------------------------------------------------*/
+static void
+Worker(void* arg)
+{
+    WorkerArgs*  args = (WorkerArgs*)arg;
+    char         name[64];
+    unsigned int i;
+
+    for (i=0; i<NAME_COUNT; i++) {
+        ATX_FormatStringN(name, sizeof(name), "org.example.Worker.%u", i);
+        SHOULD_SUCCEED(ATX_Atom_Intern(name, &args->atoms[i]));
+    }
+}
+
+/*----------------------------------------------------------------------
+|       BasicTest
++---------------------------------------------------------------------*/
+static void
+BasicTest(void)
+{
+    ATX_Atom a = NULL;
+    ATX_Atom b = NULL;
+    ATX_Atom c = NULL;
+    char     buffer[16];
+
+    SHOULD_SUCCEED(ATX_Atom_Intern("Content-Length", &a));
+    CHECK(a != NULL);
+    CHECK(ATX_StringsEqual(ATX_Atom_GetChars(a), "Content-Length"));
+    CHECK(ATX_Atom_GetLength(a) == 14);
+
+    /* the same characters always give the same atom */
+    ATX_CopyString(buffer, "Content-Length");
+    SHOULD_SUCCEED(ATX_Atom_Intern(buffer, &b));
+    CHECK(a == b);
+    CHECK(ATX_Atom_Find(buffer) == a);
+    SHOULD_SUCCEED(ATX_Atom_InternN("Content-Length: 12", 14, &b));
+    CHECK(a == b);
+
+    /* case */
+    SHOULD_SUCCEED(ATX_Atom_Intern("CONTENT-length", &b));
+    CHECK(a != b);
+    CHECK(ATX_Atom_GetCaseless(a) == ATX_Atom_GetCaseless(b));
+    c = ATX_Atom_GetCaseless(a);
+    CHECK(ATX_StringsEqual(ATX_Atom_GetChars(c), "content-length"));
+    CHECK(ATX_Atom_GetCaseless(c) == c);
+    CHECK(ATX_Atom_Find("content-length") == c);
+    CHECK(ATX_Atom_FindCaseless("Content-LENGTH") == c);
+    CHECK(ATX_Atom_Find("Content-LENGTH") == NULL);
+
+    /* unknown names */
+    CHECK(ATX_Atom_Find("never.interned") == NULL);
+    CHECK(ATX_Atom_FindCaseless("Never.Interned") == NULL);
+
+    /* empty strings are valid atoms */
+    SHOULD_SUCCEED(ATX_Atom_Intern("", &a));
+    CHECK(a != NULL);
+    CHECK(ATX_Atom_GetLength(a) == 0);
+    CHECK(ATX_Atom_Find("") == a);
+
+    /* invalid parameters */
+    CHECK(ATX_Atom_Intern(NULL, &a) == ATX_ERROR_INVALID_PARAMETERS);
+    CHECK(a == NULL);
+    CHECK(ATX_Atom_Find(NULL) == NULL);
+}
+
+/*----------------------------------------------------------------------
+|       ThreadTest
++---------------------------------------------------------------------*/
+static void
+ThreadTest(void)
+{
+    static WorkerArgs args[THREAD_COUNT];
+    ATX_Thread*       threads[THREAD_COUNT];
+    unsigned int      i;
+    unsigned int      j;
+
+    /* all the threads race to intern the same names */
+    for (i=0; i<THREAD_COUNT; i++) {
+        SHOULD_SUCCEED(ATX_Thread_Create(Worker, &args[i], &threads[i]));
+    }
+    for (i=0; i<THREAD_COUNT; i++) {
+        SHOULD_SUCCEED(ATX_Thread_Join(threads[i]));
+    }
+    for (j=0; j<NAME_COUNT; j++) {
+        char name[64];
+        ATX_FormatStringN(name, sizeof(name), "org.example.Worker.%u", j);
+        CHECK(ATX_StringsEqual(ATX_Atom_GetChars(args[0].atoms[j]), name));
+        CHECK(ATX_Atom_Find(name) == args[0].atoms[j]);
+        for (i=1; i<THREAD_COUNT; i++) {
+            CHECK(args[i].atoms[j] == args[0].atoms[j]);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------
+|       HeaderTest
++---------------------------------------------------------------------*/
+static void
+HeaderTest(void)
+{
+    ATX_HttpMessage*  message = NULL;
+    ATX_Atom          atom = NULL;
+    const ATX_String* value;
+
+    SHOULD_SUCCEED(ATX_HttpMessage_Create(&message));
+    SHOULD_SUCCEED(ATX_HttpMessage_SetHeader(message, "X-Request-Id", "1"));
+    SHOULD_SUCCEED(ATX_HttpMessage_SetHeader(message, "x-request-ID", "2"));
+
+    /* header names don't depend on case */
+    value = ATX_HttpMessage_GetHeader(message, "X-REQUEST-ID");
+    CHECK(value != NULL);
+    CHECK(ATX_String_Equals(value, "2", ATX_FALSE));
+    SHOULD_SUCCEED(ATX_Atom_Intern("X-Request-Id", &atom));
+    CHECK(ATX_HttpMessage_GetHeaderByAtom(message, atom) == value);
+    CHECK(ATX_HttpMessage_GetHeader(message, "X-Unknown-Header") == NULL);
+
+    ATX_HttpMessage_Destroy(message);
+}
+
+/*----------------------------------------------------------------------
+|       main
++---------------------------------------------------------------------*/
+int
+main(int argc, char** argv)
+{
+    ATX_COMPILER_UNUSED(argc);
+    ATX_COMPILER_UNUSED(argv);
+
+    BasicTest();
+    ThreadTest();
+    HeaderTest();
+
+    printf("atoms test passed\n");
+    return 0;
+}
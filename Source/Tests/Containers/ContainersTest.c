@@ -55,6 +55,31 @@
         }                                                               \
     } while(0)                                  
 
+/*----------------------------------------------------------------------
+|       constants
++---------------------------------------------------------------------*/
+#define MAP_TEST_KEY_COUNT      5000
+#define MAP_BENCHMARK_KEY_COUNT 4000
+
+#define LIST_BENCHMARK_ITEM_COUNT  10000
+#define LIST_BENCHMARK_CHURN_COUNT 1000000
+#define LIST_BENCHMARK_WALK_COUNT  200
+
+/*----------------------------------------------------------------------
+|       types
++---------------------------------------------------------------------*/
+/* one allocation per node, like list items before they had slabs */
+typedef struct BaselineNode {
+    struct BaselineNode* next;
+    struct BaselineNode* prev;
+    ATX_Any              data;
+} BaselineNode;
+
+typedef struct {
+    BaselineNode* head;
+    BaselineNode* tail;
+} BaselineList;
+
 /*----------------------------------------------------------------------
 |       globals
 +---------------------------------------------------------------------*/
@@ -81,6 +106,379 @@ static void DestroyData(ATX_ListDataDestructor* self, ATX_Any data, ATX_UInt32 t
     ATX_FreeMemory(data);
 }
 
+/*----------------------------------------------------------------------
+|       GetElapsedMicroseconds
++---------------------------------------------------------------------*/
+static ATX_UInt64
+GetElapsedMicroseconds(const ATX_TimeStamp* start)
+{
+    ATX_TimeStamp now;
+    ATX_TimeStamp elapsed;
+    ATX_System_GetCurrentTimeStamp(&now);
+    ATX_TimeStamp_Sub(elapsed, now, *start);
+    return (ATX_UInt64)elapsed.seconds*1000000+elapsed.nanoseconds/1000;
+}
+
+/*----------------------------------------------------------------------
+|       CountingAllocator
++---------------------------------------------------------------------*/
+static unsigned int AllocationCount = 0;
+static unsigned int FreeCount = 0;
+
+static void*
+CountingAllocator_Allocate(void* context, ATX_Size size)
+{
+    ATX_COMPILER_UNUSED(context);
+    ++AllocationCount;
+    return ATX_Allocator_Allocate(ATX_GetDefaultAllocator(), size);
+}
+
+static void*
+CountingAllocator_Reallocate(void* context, void* memory, ATX_Size size)
+{
+    ATX_COMPILER_UNUSED(context);
+    ++AllocationCount;
+    return ATX_Allocator_Reallocate(ATX_GetDefaultAllocator(), memory, size);
+}
+
+static void
+CountingAllocator_Free(void* context, void* memory)
+{
+    ATX_COMPILER_UNUSED(context);
+    if (memory) ++FreeCount;
+    ATX_Allocator_Free(ATX_GetDefaultAllocator(), memory);
+}
+
+static const ATX_Allocator CountingAllocator = {
+    CountingAllocator_Allocate,
+    CountingAllocator_Reallocate,
+    CountingAllocator_Free,
+    NULL
+};
+
+/*----------------------------------------------------------------------
+|       SlabTest
++---------------------------------------------------------------------*/
+static void
+SlabTest(void)
+{
+    ATX_List*     list;
+    ATX_Map*      map;
+    ATX_ListItem* item;
+    ATX_Any       data;
+    unsigned int  allocations;
+    unsigned int  frees;
+    unsigned int  i;
+
+    SHOULD_SUCCEED(ATX_SetAllocator(&CountingAllocator));
+
+    /* removed items are recycled */
+    SHOULD_SUCCEED(ATX_List_Create(&list));
+    SHOULD_SUCCEED(ATX_List_AddData(list, (ATX_Any)"a"));
+    SHOULD_SUCCEED(ATX_List_AddData(list, (ATX_Any)"b"));
+    item = ATX_List_GetFirstItem(list);
+    SHOULD_SUCCEED(ATX_List_RemoveItem(list, item));
+    allocations = AllocationCount;
+    SHOULD_SUCCEED(ATX_List_AddData(list, (ATX_Any)"c"));
+    ATX_ASSERT(ATX_List_GetLastItem(list) == item);
+    ATX_ASSERT(AllocationCount == allocations);
+
+    /* a reserved list doesn't allocate while it fills up */
+    SHOULD_SUCCEED(ATX_List_Reserve(list, 1000));
+    allocations = AllocationCount;
+    for (i=2; i<1000; i++) {
+        SHOULD_SUCCEED(ATX_List_AddData(list, NULL));
+    }
+    ATX_ASSERT(ATX_List_GetItemCount(list) == 1000);
+    ATX_ASSERT(AllocationCount == allocations);
+
+    /* a detached item keeps the slabs of a cleared list alive */
+    item = ATX_List_GetFirstItem(list);
+    SHOULD_SUCCEED(ATX_List_DetachItem(list, item));
+    frees = FreeCount;
+    SHOULD_SUCCEED(ATX_List_Clear(list));
+    ATX_ASSERT(FreeCount == frees);
+    SHOULD_SUCCEED(ATX_List_AddItem(list, item));
+
+    /* otherwise the slabs go back to the allocator */
+    SHOULD_SUCCEED(ATX_List_Clear(list));
+    ATX_ASSERT(FreeCount > frees);
+    for (i=0; i<1000; i++) {
+        SHOULD_SUCCEED(ATX_List_InsertData(list, ATX_List_GetFirstItem(list), NULL));
+    }
+    ATX_ASSERT(AllocationCount > allocations);
+    ATX_ASSERT(ATX_List_GetItemCount(list) == 1000);
+    SHOULD_SUCCEED(ATX_List_Destroy(list));
+
+    /* map entries come from the same kind of slabs */
+    SHOULD_SUCCEED(ATX_Map_Create(&map));
+    SHOULD_SUCCEED(ATX_Map_Put(map, "one", (ATX_Any)"1", NULL));
+    SHOULD_SUCCEED(ATX_Map_Put(map, "two", (ATX_Any)"2", NULL));
+    SHOULD_SUCCEED(ATX_Map_Remove(map, "one", NULL));
+    allocations = AllocationCount;
+    SHOULD_SUCCEED(ATX_Map_Put(map, "three", (ATX_Any)"3", NULL));
+    ATX_ASSERT(AllocationCount == allocations);
+    SHOULD_SUCCEED(ATX_List_Reserve(ATX_Map_AsList(map), 100));
+    ATX_ASSERT(ATX_Map_GetEntryCount(map) == 2);
+    data = ATX_MapEntry_GetData(ATX_Map_Get(map, "three"));
+    ATX_ASSERT(ATX_StringsEqual((const char*)data, "3"));
+    SHOULD_SUCCEED(ATX_Map_Destroy(map));
+
+    SHOULD_SUCCEED(ATX_SetAllocator(NULL));
+}
+
+/*----------------------------------------------------------------------
+|       MapTest
++---------------------------------------------------------------------*/
+static void
+MapTest(ATX_MapIndexType index_type)
+{
+    ATX_Map*         map;
+    ATX_MapEntry*    entry;
+    ATX_MapEntryInfo info;
+    ATX_ListItem*    item;
+    ATX_ListDataDestructor des = {
+        NULL, 
+        DestroyData
+    };
+    char             key[32];
+    unsigned int     i;
+
+    SHOULD_SUCCEED(ATX_Map_CreateIndexed(&des, index_type, &map));
+    ATX_ASSERT(ATX_Map_Get(map, "foo") == NULL);
+    ATX_ASSERT(ATX_Map_HasKey(map, "foo") == ATX_FALSE);
+    SHOULD_FAIL(ATX_Map_Remove(map, "foo", NULL));
+
+    SHOULD_SUCCEED(ATX_Map_Put(map, "foo", CreateData("foo1"), NULL));
+    SHOULD_SUCCEED(ATX_Map_PutTyped(map, "bar", CreateData("bar1"), 7, NULL));
+    ATX_ASSERT(ATX_Map_GetEntryCount(map) == 2);
+    ATX_ASSERT(ItemCount == 2);
+    entry = ATX_Map_Get(map, "bar");
+    ATX_ASSERT(entry != NULL);
+    ATX_ASSERT(ATX_MapEntry_GetType(entry) == 7);
+    ATX_ASSERT(ATX_StringsEqual(ATX_MapEntry_GetKey(entry), "bar"));
+    ATX_ASSERT(ATX_StringsEqual((const char*)ATX_MapEntry_GetData(entry), "bar1"));
+
+    /* replacing a value destroys the previous one */
+    SHOULD_SUCCEED(ATX_Map_Put(map, "foo", CreateData("foo2"), NULL));
+    ATX_ASSERT(ItemCount == 2);
+    ATX_ASSERT(ATX_Map_GetEntryCount(map) == 2);
+
+    /* unless the caller asks for it */
+    SHOULD_SUCCEED(ATX_Map_Put(map, "foo", CreateData("foo3"), &info));
+    ATX_ASSERT(info.is_set);
+    ATX_ASSERT(ATX_StringsEqual((const char*)info.data, "foo2"));
+    DestroyData(NULL, info.data, info.type);
+    SHOULD_SUCCEED(ATX_Map_Remove(map, "foo", &info));
+    ATX_ASSERT(info.is_set);
+    ATX_ASSERT(ATX_StringsEqual((const char*)info.data, "foo3"));
+    DestroyData(NULL, info.data, info.type);
+    ATX_ASSERT(ATX_Map_HasKey(map, "foo") == ATX_FALSE);
+    ATX_ASSERT(ATX_Map_HasKey(map, "bar") == ATX_TRUE);
+    SHOULD_SUCCEED(ATX_Map_Remove(map, "bar", NULL));
+    ATX_ASSERT(ItemCount == 0);
+    ATX_ASSERT(ATX_Map_GetEntryCount(map) == 0);
+
+    /* enough keys to go through several resizes */
+    for (i=0; i<MAP_TEST_KEY_COUNT; i++) {
+        ATX_FormatStringN(key, sizeof(key), "key-%u", i);
+        SHOULD_SUCCEED(ATX_Map_Put(map, key, CreateData(key), NULL));
+        if (i%3 == 0) {
+            /* remove some keys while a resize may be in progress */
+            ATX_FormatStringN(key, sizeof(key), "key-%u", i/2);
+            if (ATX_Map_HasKey(map, key)) {
+                SHOULD_SUCCEED(ATX_Map_Remove(map, key, NULL));
+            }
+        }
+    }
+    ATX_ASSERT(ATX_Map_GetEntryCount(map) == ItemCount);
+    for (i=0; i<MAP_TEST_KEY_COUNT; i++) {
+        ATX_FormatStringN(key, sizeof(key), "key-%u", i);
+        entry = ATX_Map_Get(map, key);
+        if (entry) {
+            ATX_ASSERT(ATX_StringsEqual((const char*)ATX_MapEntry_GetData(entry), key));
+        }
+    }
+
+    /* entries are still listed in insertion order */
+    {
+        unsigned int last = 0;
+        unsigned int count = 0;
+        for (item = ATX_List_GetFirstItem(ATX_Map_AsList(map));
+             item;
+             item = ATX_ListItem_GetNext(item)) {
+            unsigned int value = 0;
+            SHOULD_SUCCEED(ATX_ParseIntegerU(ATX_MapEntry_GetKey((ATX_MapEntry*)item)+4, &value, ATX_FALSE));
+            ATX_ASSERT(count == 0 || value > last);
+            last = value;
+            ++count;
+        }
+        ATX_ASSERT(count == ATX_Map_GetEntryCount(map));
+    }
+
+    SHOULD_SUCCEED(ATX_Map_Clear(map));
+    ATX_ASSERT(ItemCount == 0);
+    ATX_ASSERT(ATX_Map_Get(map, "key-1") == NULL);
+    SHOULD_SUCCEED(ATX_Map_Put(map, "foo", CreateData("foo"), NULL));
+    ATX_ASSERT(ATX_Map_HasKey(map, "foo"));
+
+    ATX_Map_Destroy(map);
+    ATX_ASSERT(ItemCount == 0);
+}
+
+/*----------------------------------------------------------------------
+|       MapBenchmark
++---------------------------------------------------------------------*/
+static ATX_UInt64
+MapBenchmark(ATX_MapIndexType index_type)
+{
+    ATX_Map*      map;
+    ATX_TimeStamp start;
+    ATX_UInt64    elapsed;
+    char          key[32];
+    unsigned int  i;
+
+    ATX_System_GetCurrentTimeStamp(&start);
+
+    SHOULD_SUCCEED(ATX_Map_CreateIndexed(NULL, index_type, &map));
+    for (i=0; i<MAP_BENCHMARK_KEY_COUNT; i++) {
+        ATX_FormatStringN(key, sizeof(key), "config.session.%u", i);
+        SHOULD_SUCCEED(ATX_Map_Put(map, key, NULL, NULL));
+    }
+    for (i=0; i<MAP_BENCHMARK_KEY_COUNT; i++) {
+        ATX_FormatStringN(key, sizeof(key), "config.session.%u", (i*7919)%MAP_BENCHMARK_KEY_COUNT);
+        ATX_ASSERT(ATX_Map_Get(map, key) != NULL);
+        ATX_FormatStringN(key, sizeof(key), "config.missing.%u", i);
+        ATX_ASSERT(ATX_Map_HasKey(map, key) == ATX_FALSE);
+    }
+    ATX_Map_Destroy(map);
+
+    elapsed = GetElapsedMicroseconds(&start);
+    ATX_Debug("map benchmark (%s index, %d keys): %d us\n", 
+              index_type == ATX_MAP_INDEX_TYPE_HASH ? "hash" : "list",
+              MAP_BENCHMARK_KEY_COUNT,
+              (int)elapsed);
+
+    return elapsed;
+}
+
+/*----------------------------------------------------------------------
+|       BaselineList_Add
++---------------------------------------------------------------------*/
+static void
+BaselineList_Add(BaselineList* list, ATX_Any data)
+{
+    BaselineNode* node = (BaselineNode*)ATX_AllocateMemory(sizeof(BaselineNode));
+    ATX_ASSERT(node != NULL);
+    node->data = data;
+    node->next = NULL;
+    node->prev = list->tail;
+    if (list->tail) {
+        list->tail->next = node;
+    } else {
+        list->head = node;
+    }
+    list->tail = node;
+}
+
+/*----------------------------------------------------------------------
+|       BaselineList_RemoveHead
++---------------------------------------------------------------------*/
+static void
+BaselineList_RemoveHead(BaselineList* list)
+{
+    BaselineNode* node = list->head;
+    list->head = node->next;
+    if (list->head) {
+        list->head->prev = NULL;
+    } else {
+        list->tail = NULL;
+    }
+    ATX_FreeMemory(node);
+}
+
+/*----------------------------------------------------------------------
+|       ListBenchmark
+|
+|       Compares ATX_List with a list that allocates each node on its
+|       own, for a queue workload (add at the tail, remove at the head)
+|       and for traversals of a list that was built while other
+|       allocations were interleaved with the nodes.
++---------------------------------------------------------------------*/
+static void
+ListBenchmark(void)
+{
+    ATX_List*     list;
+    BaselineList  baseline = {NULL, NULL};
+    void*         noise[LIST_BENCHMARK_ITEM_COUNT];
+    ATX_TimeStamp start;
+    ATX_UInt64    churn_time[2];
+    ATX_UInt64    walk_time[2];
+    ATX_UIntPtr   checksum[2] = {0, 0};
+    unsigned int  i;
+    unsigned int  j;
+
+    /* build both lists, interleaving unrelated allocations */
+    SHOULD_SUCCEED(ATX_List_Create(&list));
+    for (i=0; i<LIST_BENCHMARK_ITEM_COUNT; i++) {
+        BaselineList_Add(&baseline, (ATX_Any)(ATX_UIntPtr)i);
+        SHOULD_SUCCEED(ATX_List_AddData(list, (ATX_Any)(ATX_UIntPtr)i));
+        noise[i] = ATX_AllocateMemory(16+(i*37)%200);
+    }
+
+    /* traversals */
+    ATX_System_GetCurrentTimeStamp(&start);
+    for (j=0; j<LIST_BENCHMARK_WALK_COUNT; j++) {
+        BaselineNode* node;
+        for (node = baseline.head; node; node = node->next) {
+            checksum[0] += (ATX_UIntPtr)node->data;
+        }
+    }
+    walk_time[0] = GetElapsedMicroseconds(&start);
+    ATX_System_GetCurrentTimeStamp(&start);
+    for (j=0; j<LIST_BENCHMARK_WALK_COUNT; j++) {
+        ATX_ListItem* item;
+        for (item = ATX_List_GetFirstItem(list); item; item = ATX_ListItem_GetNext(item)) {
+            checksum[1] += (ATX_UIntPtr)ATX_ListItem_GetData(item);
+        }
+    }
+    walk_time[1] = GetElapsedMicroseconds(&start);
+    ATX_ASSERT(checksum[0] == checksum[1]);
+
+    /* queue churn */
+    ATX_System_GetCurrentTimeStamp(&start);
+    for (i=0; i<LIST_BENCHMARK_CHURN_COUNT; i++) {
+        BaselineList_RemoveHead(&baseline);
+        BaselineList_Add(&baseline, (ATX_Any)(ATX_UIntPtr)i);
+    }
+    churn_time[0] = GetElapsedMicroseconds(&start);
+    ATX_System_GetCurrentTimeStamp(&start);
+    for (i=0; i<LIST_BENCHMARK_CHURN_COUNT; i++) {
+        SHOULD_SUCCEED(ATX_List_RemoveItem(list, ATX_List_GetFirstItem(list)));
+        SHOULD_SUCCEED(ATX_List_AddData(list, (ATX_Any)(ATX_UIntPtr)i));
+    }
+    churn_time[1] = GetElapsedMicroseconds(&start);
+    ATX_ASSERT(ATX_List_GetItemCount(list) == LIST_BENCHMARK_ITEM_COUNT);
+
+    ATX_Debug("list benchmark (%d items): walk x%d: %d us per-node allocations, %d us slabs\n",
+              LIST_BENCHMARK_ITEM_COUNT,
+              LIST_BENCHMARK_WALK_COUNT,
+              (int)walk_time[0],
+              (int)walk_time[1]);
+    ATX_Debug("list benchmark (%d items): churn x%d: %d us per-node allocations, %d us slabs\n",
+              LIST_BENCHMARK_ITEM_COUNT,
+              LIST_BENCHMARK_CHURN_COUNT,
+              (int)churn_time[0],
+              (int)churn_time[1]);
+
+    /* cleanup */
+    while (baseline.head) BaselineList_RemoveHead(&baseline);
+    for (i=0; i<LIST_BENCHMARK_ITEM_COUNT; i++) {
+        ATX_FreeMemory(noise[i]);
+    }
+    ATX_List_Destroy(list);
+}
+
 /*----------------------------------------------------------------------
 |       main
 +---------------------------------------------------------------------*/
@@ -158,6 +556,13 @@ main(int argc, char** argv)
     ATX_List_Destroy(list);
     ATX_ASSERT(ItemCount == 0);
 
+    MapTest(ATX_MAP_INDEX_TYPE_HASH);
+    MapTest(ATX_MAP_INDEX_TYPE_LIST);
+    MapBenchmark(ATX_MAP_INDEX_TYPE_LIST);
+    MapBenchmark(ATX_MAP_INDEX_TYPE_HASH);
+    SlabTest();
+    ListBenchmark();
+
     return 0;
 }
 
@@ -0,0 +1,790 @@
+/*****************************************************************
+|
+|      EventLoop Test Program 1
+|
+| Copyright (c) 2002-2016, Axiomatic Systems, LLC.
+| All rights reserved.
+|
+| Redistribution and use in source and binary forms, with or without
+| modification, are permitted provided that the following conditions are met:
+|     * Redistributions of source code must retain the above copyright
+|       notice, this list of conditions and the following disclaimer.
+|     * Redistributions in binary form must reproduce the above copyright
+|       notice, this list of conditions and the following disclaimer in the
+|       documentation and/or other materials provided with the distribution.
+|     * Neither the name of Axiomatic Systems nor the
+|       names of its contributors may be used to endorse or promote products
+|       derived from this software without specific prior written permission.
+|
+| THIS SOFTWARE IS PROVIDED BY AXIOMATIC SYSTEMS ''AS IS'' AND ANY
+| EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+| WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+| DISCLAIMED. IN NO EVENT SHALL AXIOMATIC SYSTEMS BE LIABLE FOR ANY
+| DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+| (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+| LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+| ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+| (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+| SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+|
+ ****************************************************************/
+
+
+/*----------------------------------------------------------------------
+|       includes
++---------------------------------------------------------------------*/
+#include "Atomix.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------
+|       macros
++---------------------------------------------------------------------*/
+#define SHOULD_SUCCEED(r)                                   \
+    do {                                                    \
+        ATX_Result x = r;                                   \
+        if (ATX_FAILED(x)) {                                \
+            printf("failed line %d (%d)\n", __LINE__, x);   \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)                                         
+
+#define CHECK(x)                                            \
+    do {                                                    \
+        if (!(x)) {                                         \
+            printf("check failed line %d\n", __LINE__);     \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)                                         
+
+/*----------------------------------------------------------------------
+|       constants
++---------------------------------------------------------------------*/
+#define CLIENT_COUNT   16
+#define MESSAGE_SIZE   64
+#define POST_COUNT     1000
+#define PACKET_COUNT   200
+#define PACKET_SIZE    128
+#define BATCH_SIZE     32
+#define TEST_DEADLINE  10000 /* ms */
+
+/*----------------------------------------------------------------------
+|       types
++---------------------------------------------------------------------*/
+typedef struct EchoTest EchoTest;
+
+typedef struct {
+    EchoTest*           test;
+    ATX_Socket*         socket;
+    ATX_InputStream*    input;
+    ATX_OutputStream*   output;
+    ATX_EventLoopWatch* watch;
+    ATX_Boolean         connected;
+    char                message[MESSAGE_SIZE];
+    char                buffer[MESSAGE_SIZE];
+    ATX_Size            received;
+} Connection;
+
+struct EchoTest {
+    ATX_ServerSocket*   server;
+    ATX_SocketAddress   address;
+    Connection          clients[CLIENT_COUNT];
+    unsigned int        clients_done;
+    unsigned int        peers_open;
+    unsigned int        peers_closed;
+};
+
+typedef struct {
+    ATX_DatagramSocket* receiver;
+    ATX_IpPort          sender_port;
+    ATX_DataBuffer*     packets[BATCH_SIZE];
+    ATX_SocketAddress   addresses[BATCH_SIZE];
+    unsigned int        received;
+    unsigned int        batches;
+} DatagramTestState;
+
+typedef struct {
+    ATX_EventLoopTimer* periodic;
+    ATX_EventLoopTimer* cancelled;
+    unsigned int        periodic_count;
+    unsigned int        one_shot_count;
+    unsigned int        cancelled_count;
+} TimerTestState;
+
+/*----------------------------------------------------------------------
+|       Connection_Open
++---------------------------------------------------------------------*/
+static void
+Connection_Open(Connection* self, EchoTest* test, ATX_Socket* socket)
+{
+    self->test   = test;
+    self->socket = socket;
+    SHOULD_SUCCEED(ATX_Socket_GetInputStream(socket, &self->input));
+    SHOULD_SUCCEED(ATX_Socket_GetOutputStream(socket, &self->output));
+}
+
+/*----------------------------------------------------------------------
+|       Connection_Close
++---------------------------------------------------------------------*/
+static void
+Connection_Close(Connection* self, ATX_EventLoop* loop)
+{
+    SHOULD_SUCCEED(ATX_EventLoop_RemoveSocket(loop, self->watch));
+    ATX_RELEASE_OBJECT(self->input);
+    ATX_RELEASE_OBJECT(self->output);
+    ATX_DESTROY_OBJECT(self->socket);
+}
+
+/*----------------------------------------------------------------------
+|       EchoTest_CheckDone
++---------------------------------------------------------------------*/
+static void
+EchoTest_CheckDone(EchoTest* self, ATX_EventLoop* loop)
+{
+    if (self->clients_done == CLIENT_COUNT && 
+        self->peers_closed == CLIENT_COUNT) {
+        SHOULD_SUCCEED(ATX_EventLoop_Stop(loop));
+    }
+}
+
+/*----------------------------------------------------------------------
+|       OnPeerEvent
++---------------------------------------------------------------------*/
+static void
+OnPeerEvent(ATX_EventLoop*      loop, 
+            ATX_EventLoopWatch* watch, 
+            ATX_Flags           events, 
+            void*               listener)
+{
+    Connection* peer = (Connection*)listener;
+    char        buffer[MESSAGE_SIZE];
+    ATX_Size    bytes_read = 0;
+    ATX_Result  result;
+
+    ATX_COMPILER_UNUSED(watch);
+    CHECK(events & ATX_EVENT_LOOP_READABLE);
+
+    /* echo what was received, until the client goes away */
+    result = ATX_InputStream_Read(peer->input, buffer, sizeof(buffer), &bytes_read);
+    if (result == ATX_ERROR_WOULD_BLOCK) return;
+    if (ATX_FAILED(result)) {
+        EchoTest* test = peer->test;
+        CHECK(result == ATX_ERROR_EOS || result == ATX_ERROR_CONNECTION_RESET);
+        Connection_Close(peer, loop);
+        free(peer);
+        ++test->peers_closed;
+        EchoTest_CheckDone(test, loop);
+        return;
+    }
+    SHOULD_SUCCEED(ATX_OutputStream_WriteFully(peer->output, buffer, bytes_read));
+}
+
+/*----------------------------------------------------------------------
+|       OnServerEvent
++---------------------------------------------------------------------*/
+static void
+OnServerEvent(ATX_EventLoop*      loop, 
+              ATX_EventLoopWatch* watch, 
+              ATX_Flags           events, 
+              void*               listener)
+{
+    EchoTest* test = (EchoTest*)listener;
+
+    ATX_COMPILER_UNUSED(watch);
+    CHECK(events == ATX_EVENT_LOOP_READABLE);
+
+    /* accept all the pending clients */
+    for (;;) {
+        ATX_Socket* client = NULL;
+        Connection* peer;
+        ATX_Result  result = ATX_ServerSocket_WaitForNewClient(test->server, &client);
+        if (result == ATX_ERROR_WOULD_BLOCK) break;
+        SHOULD_SUCCEED(result);
+
+        peer = (Connection*)calloc(1, sizeof(Connection));
+        Connection_Open(peer, test, client);
+        SHOULD_SUCCEED(ATX_EventLoop_AddSocket(loop, 
+                                               ATX_CAST(client, ATX_SelectableSocket),
+                                               ATX_EVENT_LOOP_READABLE,
+                                               OnPeerEvent,
+                                               peer,
+                                               &peer->watch));
+        ++test->peers_open;
+    }
+}
+
+/*----------------------------------------------------------------------
+|       OnClientEvent
++---------------------------------------------------------------------*/
+static void
+OnClientEvent(ATX_EventLoop*      loop, 
+              ATX_EventLoopWatch* watch, 
+              ATX_Flags           events, 
+              void*               listener)
+{
+    Connection* client = (Connection*)listener;
+    ATX_Size    bytes_read = 0;
+    ATX_Result  result;
+
+    CHECK((events & ATX_EVENT_LOOP_ERROR) == 0);
+
+    if (!client->connected) {
+        /* finish connecting, then send the message */
+        CHECK(events == ATX_EVENT_LOOP_WRITABLE);
+        SHOULD_SUCCEED(ATX_Socket_Connect(client->socket, &client->test->address, 0));
+        client->connected = ATX_TRUE;
+        SHOULD_SUCCEED(ATX_OutputStream_WriteFully(client->output, 
+                                                   client->message, 
+                                                   MESSAGE_SIZE));
+        SHOULD_SUCCEED(ATX_EventLoop_ModifySocket(loop, watch, ATX_EVENT_LOOP_READABLE));
+        return;
+    }
+
+    CHECK(events == ATX_EVENT_LOOP_READABLE);
+    result = ATX_InputStream_Read(client->input, 
+                                  client->buffer+client->received, 
+                                  MESSAGE_SIZE-client->received, 
+                                  &bytes_read);
+    if (result == ATX_ERROR_WOULD_BLOCK) return;
+    SHOULD_SUCCEED(result);
+    client->received += bytes_read;
+    if (client->received == MESSAGE_SIZE) {
+        CHECK(memcmp(client->buffer, client->message, MESSAGE_SIZE) == 0);
+        Connection_Close(client, loop);
+        ++client->test->clients_done;
+        EchoTest_CheckDone(client->test, loop);
+    }
+}
+
+/*----------------------------------------------------------------------
+|       OnDeadline
++---------------------------------------------------------------------*/
+static void
+OnDeadline(ATX_EventLoop* loop, ATX_EventLoopTimer* timer, void* listener)
+{
+    ATX_COMPILER_UNUSED(loop);
+    ATX_COMPILER_UNUSED(timer);
+    ATX_COMPILER_UNUSED(listener);
+
+    printf("test deadline exceeded\n");
+    exit(1);
+}
+
+/*----------------------------------------------------------------------
+|       EchoTest_Run
++---------------------------------------------------------------------*/
+static void
+EchoTest_Run(void)
+{
+    ATX_EventLoop*      loop;
+    ATX_EventLoopWatch* server_watch;
+    ATX_EventLoopTimer* deadline;
+    ATX_SocketInfo      info;
+    ATX_IpAddress       loopback;
+    EchoTest            test;
+    unsigned int        i;
+
+    memset(&test, 0, sizeof(test));
+    SHOULD_SUCCEED(ATX_EventLoop_Create(&loop));
+    SHOULD_SUCCEED(ATX_EventLoop_AddTimer(loop, TEST_DEADLINE, 0, OnDeadline, NULL, &deadline));
+
+    /* listen on an ephemeral loopback port */
+    ATX_IpAddress_SetFromLong(&loopback, 0x7F000001);
+    ATX_SocketAddress_Set(&test.address, &loopback, 0);
+    SHOULD_SUCCEED(ATX_TcpServerSocket_Create(&test.server));
+    SHOULD_SUCCEED(ATX_Socket_Bind(ATX_CAST(test.server, ATX_Socket), &test.address));
+    SHOULD_SUCCEED(ATX_ServerSocket_Listen(test.server, CLIENT_COUNT));
+    SHOULD_SUCCEED(ATX_Socket_GetInfo(ATX_CAST(test.server, ATX_Socket), &info));
+    CHECK(info.local_address.port != 0);
+    test.address.port = info.local_address.port;
+    SHOULD_SUCCEED(ATX_SelectableSocket_SetBlocking(ATX_CAST(test.server, ATX_SelectableSocket), ATX_FALSE));
+    SHOULD_SUCCEED(ATX_EventLoop_AddSocket(loop, 
+                                           ATX_CAST(test.server, ATX_SelectableSocket),
+                                           ATX_EVENT_LOOP_READABLE,
+                                           OnServerEvent,
+                                           &test,
+                                           &server_watch));
+
+    /* start all the clients connecting at once */
+    for (i=0; i<CLIENT_COUNT; i++) {
+        Connection*           client = &test.clients[i];
+        ATX_SelectableSocket* selectable;
+        ATX_Socket*           socket;
+        ATX_Result            result;
+        unsigned int          j;
+
+        for (j=0; j<MESSAGE_SIZE; j++) client->message[j] = (char)('a'+(i+j)%26);
+        SHOULD_SUCCEED(ATX_TcpClientSocket_Create(&socket));
+        Connection_Open(client, &test, socket);
+        selectable = ATX_CAST(socket, ATX_SelectableSocket);
+        CHECK(selectable != NULL);
+        SHOULD_SUCCEED(ATX_SelectableSocket_SetBlocking(selectable, ATX_FALSE));
+        result = ATX_Socket_Connect(socket, &test.address, 0);
+        CHECK(result == ATX_SUCCESS || result == ATX_ERROR_WOULD_BLOCK);
+        SHOULD_SUCCEED(ATX_EventLoop_AddSocket(loop, 
+                                               selectable,
+                                               ATX_EVENT_LOOP_WRITABLE,
+                                               OnClientEvent,
+                                               client,
+                                               &client->watch));
+    }
+
+    SHOULD_SUCCEED(ATX_EventLoop_Run(loop));
+    CHECK(test.clients_done == CLIENT_COUNT);
+    CHECK(test.peers_open   == CLIENT_COUNT);
+    CHECK(test.peers_closed == CLIENT_COUNT);
+
+    SHOULD_SUCCEED(ATX_EventLoop_RemoveTimer(loop, deadline));
+    SHOULD_SUCCEED(ATX_EventLoop_RemoveSocket(loop, server_watch));
+    ATX_DESTROY_OBJECT(test.server);
+    SHOULD_SUCCEED(ATX_EventLoop_Destroy(loop));
+}
+
+/*----------------------------------------------------------------------
+|       OnDatagramEvent
++---------------------------------------------------------------------*/
+static void
+OnDatagramEvent(ATX_EventLoop*      loop, 
+                ATX_EventLoopWatch* watch, 
+                ATX_Flags           events, 
+                void*               listener)
+{
+    DatagramTestState* state = (DatagramTestState*)listener;
+
+    ATX_COMPILER_UNUSED(watch);
+    CHECK(events == ATX_EVENT_LOOP_READABLE);
+
+    /* drain the socket, one batch at a time */
+    for (;;) {
+        ATX_Cardinal received = 0;
+        ATX_Cardinal i;
+        ATX_Result   result = ATX_DatagramSocket_ReceiveMany(state->receiver,
+                                                             state->packets,
+                                                             state->addresses,
+                                                             BATCH_SIZE,
+                                                             &received);
+        if (result == ATX_ERROR_WOULD_BLOCK) break;
+        SHOULD_SUCCEED(result);
+        CHECK(received >= 1 && received <= BATCH_SIZE);
+        ++state->batches;
+
+        /* datagrams arrive whole and in order on the loopback */
+        for (i=0; i<received; i++) {
+            const ATX_Byte* data = ATX_DataBuffer_GetData(state->packets[i]);
+            CHECK(ATX_DataBuffer_GetDataSize(state->packets[i]) == PACKET_SIZE);
+            CHECK(ATX_BytesToInt32Be(data) == state->received);
+            CHECK(data[PACKET_SIZE-1] == (ATX_Byte)state->received);
+            CHECK(state->addresses[i].port == state->sender_port);
+            ++state->received;
+        }
+    }
+
+    if (state->received == PACKET_COUNT) SHOULD_SUCCEED(ATX_EventLoop_Stop(loop));
+}
+
+/*----------------------------------------------------------------------
+|       DatagramTest
++---------------------------------------------------------------------*/
+static void
+DatagramTest(void)
+{
+    ATX_EventLoop*      loop;
+    ATX_EventLoopWatch* watch;
+    ATX_EventLoopTimer* deadline;
+    ATX_DatagramSocket* sender;
+    ATX_DataBuffer*     packets[PACKET_COUNT];
+    ATX_SocketAddress   addresses[PACKET_COUNT];
+    ATX_SocketAddress   address;
+    ATX_SocketInfo      info;
+    ATX_IpAddress       loopback;
+    ATX_Cardinal        sent = 0;
+    DatagramTestState   state;
+    unsigned int        i;
+
+    memset(&state, 0, sizeof(state));
+    SHOULD_SUCCEED(ATX_EventLoop_Create(&loop));
+    SHOULD_SUCCEED(ATX_EventLoop_AddTimer(loop, TEST_DEADLINE, 0, OnDeadline, NULL, &deadline));
+
+    /* bind both ends to ephemeral loopback ports */
+    ATX_IpAddress_SetFromLong(&loopback, 0x7F000001);
+    ATX_SocketAddress_Set(&address, &loopback, 0);
+    SHOULD_SUCCEED(ATX_UdpSocket_Create(&state.receiver));
+    SHOULD_SUCCEED(ATX_Socket_Bind(ATX_CAST(state.receiver, ATX_Socket), &address));
+    SHOULD_SUCCEED(ATX_UdpSocket_Create(&sender));
+    SHOULD_SUCCEED(ATX_Socket_Bind(ATX_CAST(sender, ATX_Socket), &address));
+    SHOULD_SUCCEED(ATX_Socket_GetInfo(ATX_CAST(sender, ATX_Socket), &info));
+    state.sender_port = info.local_address.port;
+    SHOULD_SUCCEED(ATX_Socket_GetInfo(ATX_CAST(state.receiver, ATX_Socket), &info));
+    address.port = info.local_address.port;
+
+    /* nothing is queued yet */
+    for (i=0; i<BATCH_SIZE; i++) {
+        SHOULD_SUCCEED(ATX_DataBuffer_Create(PACKET_SIZE, &state.packets[i]));
+    }
+    SHOULD_SUCCEED(ATX_SelectableSocket_SetBlocking(ATX_CAST(state.receiver, ATX_SelectableSocket), ATX_FALSE));
+    CHECK(ATX_DatagramSocket_ReceiveMany(state.receiver, state.packets, NULL, BATCH_SIZE, &sent) == ATX_ERROR_WOULD_BLOCK);
+    CHECK(sent == 0);
+
+    /* send everything in one call */
+    for (i=0; i<PACKET_COUNT; i++) {
+        ATX_Byte data[PACKET_SIZE];
+        memset(data, 0, sizeof(data));
+        ATX_BytesFromInt32Be(data, i);
+        data[PACKET_SIZE-1] = (ATX_Byte)i;
+        SHOULD_SUCCEED(ATX_DataBuffer_Create(PACKET_SIZE, &packets[i]));
+        SHOULD_SUCCEED(ATX_DataBuffer_SetData(packets[i], data, PACKET_SIZE));
+        addresses[i] = address;
+    }
+    SHOULD_SUCCEED(ATX_DatagramSocket_SendMany(sender, packets, addresses, PACKET_COUNT, &sent));
+    CHECK(sent == PACKET_COUNT);
+
+    SHOULD_SUCCEED(ATX_EventLoop_AddSocket(loop, 
+                                           ATX_CAST(state.receiver, ATX_SelectableSocket),
+                                           ATX_EVENT_LOOP_READABLE,
+                                           OnDatagramEvent,
+                                           &state,
+                                           &watch));
+    SHOULD_SUCCEED(ATX_EventLoop_Run(loop));
+    CHECK(state.received == PACKET_COUNT);
+    CHECK(state.batches < PACKET_COUNT);
+
+    for (i=0; i<PACKET_COUNT; i++) ATX_DataBuffer_Destroy(packets[i]);
+    for (i=0; i<BATCH_SIZE; i++) ATX_DataBuffer_Destroy(state.packets[i]);
+    SHOULD_SUCCEED(ATX_EventLoop_RemoveTimer(loop, deadline));
+    SHOULD_SUCCEED(ATX_EventLoop_RemoveSocket(loop, watch));
+    ATX_DESTROY_OBJECT(sender);
+    ATX_DESTROY_OBJECT(state.receiver);
+    SHOULD_SUCCEED(ATX_EventLoop_Destroy(loop));
+}
+
+/*----------------------------------------------------------------------
+|       OnPeriodicTimer
++---------------------------------------------------------------------*/
+static void
+OnPeriodicTimer(ATX_EventLoop* loop, ATX_EventLoopTimer* timer, void* listener)
+{
+    TimerTestState* state = (TimerTestState*)listener;
+    CHECK(timer == state->periodic);
+    if (++state->periodic_count == 5) {
+        SHOULD_SUCCEED(ATX_EventLoop_RemoveTimer(loop, timer));
+        state->periodic = NULL;
+    }
+}
+
+/*----------------------------------------------------------------------
+|       OnOneShotTimer
++---------------------------------------------------------------------*/
+static void
+OnOneShotTimer(ATX_EventLoop* loop, ATX_EventLoopTimer* timer, void* listener)
+{
+    TimerTestState* state = (TimerTestState*)listener;
+    ATX_COMPILER_UNUSED(loop);
+    ATX_COMPILER_UNUSED(timer);
+    ++state->one_shot_count;
+}
+
+/*----------------------------------------------------------------------
+|       OnCancelledTimer
++---------------------------------------------------------------------*/
+static void
+OnCancelledTimer(ATX_EventLoop* loop, ATX_EventLoopTimer* timer, void* listener)
+{
+    TimerTestState* state = (TimerTestState*)listener;
+    ATX_COMPILER_UNUSED(loop);
+    ATX_COMPILER_UNUSED(timer);
+    ++state->cancelled_count;
+}
+
+/*----------------------------------------------------------------------
+|       OnFinalTimer
++---------------------------------------------------------------------*/
+static void
+OnFinalTimer(ATX_EventLoop* loop, ATX_EventLoopTimer* timer, void* listener)
+{
+    ATX_COMPILER_UNUSED(timer);
+    ATX_COMPILER_UNUSED(listener);
+    SHOULD_SUCCEED(ATX_EventLoop_Stop(loop));
+}
+
+/*----------------------------------------------------------------------
+|       TimerTest
++---------------------------------------------------------------------*/
+static void
+TimerTest(void)
+{
+    ATX_EventLoop*      loop;
+    ATX_EventLoopTimer* timers[8];
+    ATX_EventLoopTimer* final_timer;
+    ATX_TimeStamp       start;
+    ATX_TimeStamp       end;
+    ATX_TimeInterval    elapsed;
+    TimerTestState      state;
+    unsigned int        i;
+    
+    memset(&state, 0, sizeof(state));
+    SHOULD_SUCCEED(ATX_EventLoop_Create(&loop));
+
+    /* timers added out of order must fire in order */
+    for (i=0; i<8; i++) {
+        SHOULD_SUCCEED(ATX_EventLoop_AddTimer(loop, 10*((i*5)%8), 0, OnOneShotTimer, &state, &timers[i]));
+    }
+    SHOULD_SUCCEED(ATX_EventLoop_AddTimer(loop, 10, 10, OnPeriodicTimer, &state, &state.periodic));
+    SHOULD_SUCCEED(ATX_EventLoop_AddTimer(loop, 20, 0, OnCancelledTimer, &state, &state.cancelled));
+    SHOULD_SUCCEED(ATX_EventLoop_AddTimer(loop, 200, 0, OnFinalTimer, &state, &final_timer));
+    SHOULD_SUCCEED(ATX_EventLoop_RemoveTimer(loop, state.cancelled));
+
+    ATX_System_GetCurrentTimeStamp(&start);
+    SHOULD_SUCCEED(ATX_EventLoop_Run(loop));
+    ATX_System_GetCurrentTimeStamp(&end);
+
+    CHECK(state.one_shot_count  == 8);
+    CHECK(state.periodic_count  == 5);
+    CHECK(state.periodic        == NULL);
+    CHECK(state.cancelled_count == 0);
+    ATX_TimeStamp_Sub(elapsed, end, start);
+    CHECK(elapsed.seconds > 0 || elapsed.nanoseconds >= 190000000);
+
+    /* expired timers stay allocated until removed */
+    for (i=0; i<8; i++) {
+        SHOULD_SUCCEED(ATX_EventLoop_RemoveTimer(loop, timers[i]));
+    }
+    SHOULD_SUCCEED(ATX_EventLoop_RemoveTimer(loop, final_timer));
+    SHOULD_SUCCEED(ATX_EventLoop_Destroy(loop));
+}
+
+/*----------------------------------------------------------------------
+|       PostedTask
++---------------------------------------------------------------------*/
+static void
+PostedTask(ATX_EventLoop* loop, void* arg)
+{
+    unsigned int* counter = (unsigned int*)arg;
+    ATX_COMPILER_UNUSED(loop);
+    ++*counter;
+}
+
+/*----------------------------------------------------------------------
+|       StopTask
++---------------------------------------------------------------------*/
+static void
+StopTask(ATX_EventLoop* loop, void* arg)
+{
+    unsigned int* counter = (unsigned int*)arg;
+    CHECK(*counter == POST_COUNT);
+    SHOULD_SUCCEED(ATX_EventLoop_Stop(loop));
+}
+
+/*----------------------------------------------------------------------
+|       Poster
++---------------------------------------------------------------------*/
+static void
+Poster(void* arg)
+{
+    ATX_EventLoop* loop = (ATX_EventLoop*)arg;
+    static unsigned int counter = 0;
+    unsigned int   i;
+
+    for (i=0; i<POST_COUNT; i++) {
+        SHOULD_SUCCEED(ATX_EventLoop_Post(loop, PostedTask, &counter));
+        if (i%100 == 0) SHOULD_SUCCEED(ATX_EventLoop_WakeUp(loop));
+    }
+    SHOULD_SUCCEED(ATX_EventLoop_Post(loop, StopTask, &counter));
+}
+
+/*----------------------------------------------------------------------
+|       Stopper
++---------------------------------------------------------------------*/
+static void
+Stopper(void* arg)
+{
+    ATX_EventLoop*   loop = (ATX_EventLoop*)arg;
+    ATX_TimeInterval delay = {0, 50000000};
+
+    ATX_System_Sleep(&delay);
+    SHOULD_SUCCEED(ATX_EventLoop_Stop(loop));
+}
+
+/*----------------------------------------------------------------------
+|       PostTest
++---------------------------------------------------------------------*/
+static void
+PostTest(void)
+{
+    ATX_EventLoop* loop;
+    ATX_Thread*    thread;
+
+    SHOULD_SUCCEED(ATX_EventLoop_Create(&loop));
+
+    /* tasks posted from another thread run in order, on the loop thread */
+    SHOULD_SUCCEED(ATX_Thread_Create(Poster, loop, &thread));
+    SHOULD_SUCCEED(ATX_EventLoop_Run(loop));
+    SHOULD_SUCCEED(ATX_Thread_Join(thread));
+
+    /* a loop blocked with nothing to watch can be stopped from outside */
+    SHOULD_SUCCEED(ATX_Thread_Create(Stopper, loop, &thread));
+    SHOULD_SUCCEED(ATX_EventLoop_Run(loop));
+    SHOULD_SUCCEED(ATX_Thread_Join(thread));
+
+    /* a pending wakeup makes RunOnce return right away */
+    SHOULD_SUCCEED(ATX_EventLoop_WakeUp(loop));
+    SHOULD_SUCCEED(ATX_EventLoop_RunOnce(loop, ATX_SOCKET_TIMEOUT_INFINITE));
+
+    SHOULD_SUCCEED(ATX_EventLoop_Destroy(loop));
+}
+
+/*----------------------------------------------------------------------
+|       ShortSocket
+|
+|       Datagram socket that sends a few datagrams per call, and fails
+|       once it has sent a given number of them
++---------------------------------------------------------------------*/
+typedef struct {
+    ATX_IMPLEMENTS(ATX_DatagramSocket);
+    ATX_Cardinal          per_call;
+    ATX_Cardinal          capacity;
+    ATX_Cardinal          call_count;
+    ATX_Cardinal          sent_count;
+    const ATX_DataBuffer* sent[PACKET_COUNT];
+    ATX_IpPort            ports[PACKET_COUNT];
+} ShortSocket;
+
+ATX_DECLARE_INTERFACE_MAP(ShortSocket, ATX_DatagramSocket)
+
+ATX_METHOD
+ShortSocket_Send(ATX_DatagramSocket*      _self,
+                 const ATX_DataBuffer*    packet,
+                 const ATX_SocketAddress* address)
+{
+    ATX_COMPILER_UNUSED(_self);
+    ATX_COMPILER_UNUSED(packet);
+    ATX_COMPILER_UNUSED(address);
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+ATX_METHOD
+ShortSocket_Receive(ATX_DatagramSocket* _self,
+                    ATX_DataBuffer*     packet,
+                    ATX_SocketAddress*  address)
+{
+    ATX_COMPILER_UNUSED(_self);
+    ATX_COMPILER_UNUSED(packet);
+    ATX_COMPILER_UNUSED(address);
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+ATX_METHOD
+ShortSocket_SendMany(ATX_DatagramSocket*      _self,
+                     ATX_DataBuffer* const*   packets,
+                     const ATX_SocketAddress* addresses,
+                     ATX_Cardinal             count,
+                     ATX_Cardinal*            sent)
+{
+    ShortSocket* self = ATX_SELF(ShortSocket, ATX_DatagramSocket);
+
+    ++self->call_count;
+    *sent = 0;
+    if (self->sent_count == self->capacity) return ATX_FAILURE;
+    while (*sent < count && *sent < self->per_call && self->sent_count < self->capacity) {
+        self->sent[self->sent_count]  = packets[*sent];
+        self->ports[self->sent_count] = addresses[*sent].port;
+        ++self->sent_count;
+        ++*sent;
+    }
+    return ATX_SUCCESS;
+}
+
+ATX_METHOD
+ShortSocket_ReceiveMany(ATX_DatagramSocket*    _self,
+                        ATX_DataBuffer* const* packets,
+                        ATX_SocketAddress*     addresses,
+                        ATX_Cardinal           count,
+                        ATX_Cardinal*          received)
+{
+    ATX_COMPILER_UNUSED(_self);
+    ATX_COMPILER_UNUSED(packets);
+    ATX_COMPILER_UNUSED(addresses);
+    ATX_COMPILER_UNUSED(count);
+    *received = 0;
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(ShortSocket)
+    ATX_GET_INTERFACE_ACCEPT(ShortSocket, ATX_DatagramSocket)
+ATX_END_GET_INTERFACE_IMPLEMENTATION
+
+ATX_BEGIN_INTERFACE_MAP(ShortSocket, ATX_DatagramSocket)
+    ShortSocket_Send,
+    ShortSocket_Receive,
+    ShortSocket_SendMany,
+    ShortSocket_ReceiveMany
+};
+
+/*----------------------------------------------------------------------
+|       ShortSendTest
+|
+|       SendAll() sends again what a short send left out, in order
++---------------------------------------------------------------------*/
+static void
+ShortSendTest(void)
+{
+    ShortSocket       socket;
+    ATX_DataBuffer*   packets[8];
+    ATX_SocketAddress addresses[8];
+    ATX_Cardinal      sent;
+    unsigned int      i;
+
+    for (i=0; i<8; i++) {
+        SHOULD_SUCCEED(ATX_DataBuffer_Create(0, &packets[i]));
+        ATX_SocketAddress_Reset(&addresses[i]);
+        addresses[i].port = (ATX_IpPort)(1000+i);
+    }
+    ATX_SET_INTERFACE(&socket, ShortSocket, ATX_DatagramSocket);
+
+    /* every datagram goes out once, with its own address */
+    socket.call_count = 0;
+    socket.sent_count = 0;
+    socket.per_call   = 3;
+    socket.capacity   = 100;
+    SHOULD_SUCCEED(ATX_DatagramSocket_SendAll(&ATX_BASE(&socket, ATX_DatagramSocket), 
+                                              packets, addresses, 8, &sent));
+    CHECK(sent == 8);
+    CHECK(socket.call_count == 3);
+    CHECK(socket.sent_count == 8);
+    for (i=0; i<8; i++) {
+        CHECK(socket.sent[i] == packets[i]);
+        CHECK(socket.ports[i] == 1000+i);
+    }
+
+    /* a failure after a short send reports what was sent */
+    socket.call_count = 0;
+    socket.sent_count = 0;
+    socket.per_call   = 3;
+    socket.capacity   = 5;
+    CHECK(ATX_FAILED(ATX_DatagramSocket_SendAll(&ATX_BASE(&socket, ATX_DatagramSocket), 
+                                                packets, addresses, 8, &sent)));
+    CHECK(sent == 5);
+    CHECK(socket.call_count == 3);
+
+    for (i=0; i<8; i++) ATX_DataBuffer_Destroy(packets[i]);
+}
+
+/*----------------------------------------------------------------------
+|       main
++---------------------------------------------------------------------*/
+int
+main(int argc, char** argv)
+{
+    ATX_COMPILER_UNUSED(argc);
+    ATX_COMPILER_UNUSED(argv);
+
+    TimerTest();
+    PostTest();
+    EchoTest_Run();
+    DatagramTest();
+    ShortSendTest();
+
+    printf("EventLoopTest passed\n");
+
+    return 0;
+}
@@ -45,6 +45,41 @@
         }                                   \
     } while(0)                              \
 
+#define CHECK(x)                                            \
+    do {                                                    \
+        if (!(x)) {                                         \
+            ATX_Debug("check failed line %d: %s\n", __LINE__, #x); \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)                                              \
+
+/*----------------------------------------------------------------------
+|       constants
++---------------------------------------------------------------------*/
+#define LOCAL_SERVER_MAX_CONNECTIONS 16
+
+/*----------------------------------------------------------------------
+|       types
++---------------------------------------------------------------------*/
+typedef struct LocalServer LocalServer;
+
+typedef struct {
+    LocalServer* server;
+    ATX_Socket*  socket;
+    ATX_Thread*  thread;
+} LocalConnection;
+
+struct LocalServer {
+    ATX_ServerSocket* socket;
+    ATX_IpPort        port;
+    ATX_Thread*       thread;
+    ATX_AtomicInt     terminating;
+    ATX_AtomicInt     connections; /* accepted so far */
+    ATX_AtomicInt     requests;    /* received so far */
+    ATX_AtomicInt     closed;      /* closed by the server */
+    LocalConnection   clients[LOCAL_SERVER_MAX_CONNECTIONS];
+};
+
 #if 0
 /*----------------------------------------------------------------------
 |       ConnectClient
@@ -94,6 +129,415 @@ ConnectClient(ATX_ClientSocket* client,
 
 #endif
 
+/*----------------------------------------------------------------------
+|       ChunkedTest
++---------------------------------------------------------------------*/
+static void
+ChunkedTest(void)
+{
+    const char* encoded = 
+        "5\r\nhello\r\n"
+        "1;name=value\r\n \r\n"
+        "0000A\r\nchunked-wo\r\n"
+        "3 \r\nrld\r\n"
+        "0\r\n"
+        "X-Trailer: foo\r\n"
+        "\r\n"
+        "next";
+    ATX_MemoryStream* memory;
+    ATX_InputStream*  source;
+    ATX_InputStream*  chunked;
+    char              buffer[32];
+    ATX_Size          bytes_read;
+    ATX_Position      position;
+    ATX_Result        result;
+
+    result = ATX_MemoryStream_CreateFromBuffer((ATX_Byte*)encoded, 
+                                               ATX_StringLength(encoded), 
+                                               &memory);
+    CHECK_RESULT(result, "ATX_MemoryStream_CreateFromBuffer failed");
+    ATX_MemoryStream_GetInputStream(memory, &source);
+    result = ATX_HttpChunkedInputStream_Create(source, &chunked);
+    CHECK_RESULT(result, "ATX_HttpChunkedInputStream_Create failed");
+
+    /* reads never cross a chunk boundary */
+    result = ATX_InputStream_Read(chunked, buffer, sizeof(buffer), &bytes_read);
+    CHECK_RESULT(result, "ATX_InputStream_Read failed");
+    if (bytes_read != 5 || ATX_CompareMemory(buffer, "hello", 5)) {
+        ATX_Debug("first chunk mismatch\n");
+        exit(1);
+    }
+
+    /* skip over a chunk boundary */
+    result = ATX_InputStream_Seek(chunked, 11);
+    CHECK_RESULT(result, "ATX_InputStream_Seek failed");
+    result = ATX_InputStream_ReadFully(chunked, buffer, 8);
+    CHECK_RESULT(result, "ATX_InputStream_ReadFully failed");
+    if (ATX_CompareMemory(buffer, "ed-world", 8)) {
+        ATX_Debug("chunk data mismatch\n");
+        exit(1);
+    }
+    ATX_InputStream_Tell(chunked, &position);
+    if (position != 19) {
+        ATX_Debug("wrong position %d\n", (int)position);
+        exit(1);
+    }
+
+    /* the trailer is consumed with the last chunk */
+    result = ATX_InputStream_Read(chunked, buffer, sizeof(buffer), &bytes_read);
+    if (result != ATX_ERROR_EOS) {
+        ATX_Debug("expected EOS (%d)\n", result);
+        exit(1);
+    }
+    result = ATX_InputStream_ReadFully(source, buffer, 4);
+    CHECK_RESULT(result, "ATX_InputStream_ReadFully failed");
+    if (ATX_CompareMemory(buffer, "next", 4)) {
+        ATX_Debug("source not left after the body\n");
+        exit(1);
+    }
+
+    ATX_RELEASE_OBJECT(chunked);
+    ATX_RELEASE_OBJECT(source);
+    ATX_MemoryStream_Destroy(memory);
+    ATX_Debug("ChunkedTest passed\n");
+}
+
+/*----------------------------------------------------------------------
+|       ParsedHeadersTest
++---------------------------------------------------------------------*/
+static void
+ParsedHeadersTest(void)
+{
+    char              encoded[8192];
+    ATX_Size          encoded_size;
+    ATX_MemoryStream* memory;
+    ATX_InputStream*  source;
+    ATX_HttpResponse* response;
+    ATX_Atom          known;
+    ATX_Atom          late;
+    const ATX_String* value;
+    int               i;
+
+    /* a response with a known header name and many unique ones */
+    CHECK_RESULT(ATX_Atom_Intern("X-Known-Header", &known), "ATX_Atom_Intern failed");
+    ATX_CopyString(encoded, "HTTP/1.1 200 OK\r\nx-known-header: known\r\n");
+    for (i=0; i<200; i++) {
+        encoded_size = ATX_StringLength(encoded);
+        ATX_FormatStringN(encoded+encoded_size, sizeof(encoded)-encoded_size,
+                          "X-Unique-Header-%d: %d\r\n", i, i);
+    }
+    encoded_size = ATX_StringLength(encoded);
+    ATX_CopyString(encoded+encoded_size, "Content-Length: 0\r\n\r\n");
+    encoded_size = ATX_StringLength(encoded);
+
+    CHECK_RESULT(ATX_MemoryStream_CreateFromBuffer((ATX_Byte*)encoded, encoded_size, &memory),
+                 "ATX_MemoryStream_CreateFromBuffer failed");
+    ATX_MemoryStream_GetInputStream(memory, &source);
+    CHECK_RESULT(ATX_HttpResponse_CreateFromStream(source, &response),
+                 "ATX_HttpResponse_CreateFromStream failed");
+
+    /* the parsed names didn't go into the atom table */
+    for (i=0; i<200; i++) {
+        char name[32];
+        ATX_FormatStringN(name, sizeof(name), "X-Unique-Header-%d", i);
+        CHECK(ATX_Atom_FindCaseless(name) == NULL);
+    }
+
+    /* but all the headers can be found, without case */
+    value = ATX_HttpMessage_GetHeaderByAtom((const ATX_HttpMessage*)response, known);
+    CHECK(value && ATX_String_Equals(value, "known", ATX_FALSE));
+    value = ATX_HttpMessage_GetHeader((const ATX_HttpMessage*)response, "x-unique-header-7");
+    CHECK(value && ATX_String_Equals(value, "7", ATX_FALSE));
+    CHECK(ATX_Atom_FindCaseless("x-unique-header-7") == NULL);
+    CHECK_RESULT(ATX_Atom_Intern("X-UNIQUE-HEADER-42", &late), "ATX_Atom_Intern failed");
+    value = ATX_HttpMessage_GetHeaderByAtom((const ATX_HttpMessage*)response, late);
+    CHECK(value && ATX_String_Equals(value, "42", ATX_FALSE));
+    CHECK(ATX_HttpMessage_GetHeader((const ATX_HttpMessage*)response, "X-Unique-Header-200") == NULL);
+
+    /* setting a parsed header again replaces its value */
+    CHECK_RESULT(ATX_HttpMessage_SetHeader((ATX_HttpMessage*)response, "x-unique-header-3", "three"),
+                 "ATX_HttpMessage_SetHeader failed");
+    value = ATX_HttpMessage_GetHeader((const ATX_HttpMessage*)response, "X-Unique-Header-3");
+    CHECK(value && ATX_String_Equals(value, "three", ATX_FALSE));
+
+    ATX_HttpResponse_Destroy(response);
+    ATX_RELEASE_OBJECT(source);
+    ATX_MemoryStream_Destroy(memory);
+    ATX_Debug("ParsedHeadersTest passed\n");
+}
+
+/*----------------------------------------------------------------------
+|       LocalServer_Serve
++---------------------------------------------------------------------*/
+static void
+LocalServer_Serve(void* arg)
+{
+    LocalConnection*  self = (LocalConnection*)arg;
+    ATX_InputStream*  input = NULL;
+    ATX_OutputStream* output = NULL;
+    ATX_Boolean       closing = ATX_FALSE;
+    ATX_Boolean       interim;
+    char              line[256];
+    ATX_Size          line_size;
+
+    ATX_Socket_GetInputStream(self->socket, &input);
+    ATX_Socket_GetOutputStream(self->socket, &output);
+
+    /* answer every request with a small keep-alive response, until */
+    /* the client goes away or asks for "/close" (and with interim   */
+    /* responses first for "/continue")                              */
+    while (!closing &&
+           ATX_SUCCEEDED(ATX_InputStream_ReadLine(input, line, sizeof(line), &line_size))) {
+        ATX_ATOMIC_INCREMENT(&self->server->requests);
+        closing = (strstr(line, " /close ") != NULL);
+        interim = (strstr(line, " /continue ") != NULL);
+        do {
+            if (ATX_FAILED(ATX_InputStream_ReadLine(input, line, sizeof(line), &line_size))) {
+                goto end;
+            }
+        } while (line_size);
+        if (interim) {
+            ATX_OutputStream_WriteString(output, 
+                                         "HTTP/1.1 100 Continue\r\n"
+                                         "\r\n"
+                                         "HTTP/1.1 102 Processing\r\n"
+                                         "\r\n");
+        }
+        ATX_OutputStream_WriteString(output, 
+                                     "HTTP/1.1 200 OK\r\n"
+                                     "Connection: keep-alive\r\n"
+                                     "Content-Length: 5\r\n"
+                                     "\r\n"
+                                     "hello");
+    }
+
+end:
+    ATX_RELEASE_OBJECT(input);
+    ATX_RELEASE_OBJECT(output);
+    ATX_DESTROY_OBJECT(self->socket);
+    if (closing) ATX_ATOMIC_INCREMENT(&self->server->closed);
+}
+
+/*----------------------------------------------------------------------
+|       LocalServer_Run
++---------------------------------------------------------------------*/
+static void
+LocalServer_Run(void* arg)
+{
+    LocalServer* self = (LocalServer*)arg;
+    ATX_Socket*  client;
+
+    while (ATX_SUCCEEDED(ATX_ServerSocket_WaitForNewClient(self->socket, &client))) {
+        LocalConnection* connection;
+        if (ATX_AtomicInt_Get(&self->terminating) ||
+            ATX_AtomicInt_Get(&self->connections) == LOCAL_SERVER_MAX_CONNECTIONS) {
+            ATX_DESTROY_OBJECT(client);
+            break;
+        }
+        /* count the connection before it can answer anything */
+        connection = &self->clients[ATX_ATOMIC_INCREMENT(&self->connections)-1];
+        connection->server = self;
+        connection->socket = client;
+        CHECK_RESULT(ATX_Thread_Create(LocalServer_Serve, connection, &connection->thread),
+                     "ATX_Thread_Create failed");
+    }
+}
+
+/*----------------------------------------------------------------------
+|       LocalServer_Start
++---------------------------------------------------------------------*/
+static void
+LocalServer_Start(LocalServer* self)
+{
+    ATX_IpAddress     loopback;
+    ATX_SocketAddress address;
+    ATX_SocketInfo    info;
+
+    ATX_SetMemory(self, 0, sizeof(*self));
+    ATX_IpAddress_SetFromLong(&loopback, 0x7F000001);
+    ATX_SocketAddress_Set(&address, &loopback, 0);
+    CHECK_RESULT(ATX_TcpServerSocket_Create(&self->socket), "ATX_TcpServerSocket_Create failed");
+    CHECK_RESULT(ATX_Socket_Bind(ATX_CAST(self->socket, ATX_Socket), &address), "ATX_Socket_Bind failed");
+    CHECK_RESULT(ATX_ServerSocket_Listen(self->socket, LOCAL_SERVER_MAX_CONNECTIONS), "ATX_ServerSocket_Listen failed");
+    CHECK_RESULT(ATX_Socket_GetInfo(ATX_CAST(self->socket, ATX_Socket), &info), "ATX_Socket_GetInfo failed");
+    self->port = info.local_address.port;
+    CHECK_RESULT(ATX_Thread_Create(LocalServer_Run, self, &self->thread), "ATX_Thread_Create failed");
+}
+
+/*----------------------------------------------------------------------
+|       LocalServer_Stop
++---------------------------------------------------------------------*/
+static void
+LocalServer_Stop(LocalServer* self)
+{
+    ATX_Socket*       waker;
+    ATX_IpAddress     loopback;
+    ATX_SocketAddress address;
+    int               i;
+
+    /* wake up the accepting thread with a last connection */
+    ATX_AtomicInt_Set(&self->terminating, 1);
+    ATX_IpAddress_SetFromLong(&loopback, 0x7F000001);
+    ATX_SocketAddress_Set(&address, &loopback, self->port);
+    CHECK_RESULT(ATX_TcpClientSocket_Create(&waker), "ATX_TcpClientSocket_Create failed");
+    CHECK_RESULT(ATX_Socket_Connect(waker, &address, 10000), "ATX_Socket_Connect failed");
+    ATX_Thread_Join(self->thread);
+    ATX_DESTROY_OBJECT(waker);
+    ATX_DESTROY_OBJECT(self->socket);
+
+    /* the connection threads end when the client closes its side */
+    for (i=0; i<ATX_AtomicInt_Get(&self->connections); i++) {
+        ATX_Thread_Join(self->clients[i].thread);
+    }
+}
+
+/*----------------------------------------------------------------------
+|       LocalServer_WaitForClose
++---------------------------------------------------------------------*/
+static void
+LocalServer_WaitForClose(LocalServer* self, ATX_Int32 closed)
+{
+    ATX_TimeInterval delay = {0, 10000000};
+    int              i;
+
+    for (i=0; i<500 && ATX_AtomicInt_Get(&self->closed) < closed; i++) {
+        ATX_System_Sleep(&delay);
+    }
+    CHECK(ATX_AtomicInt_Get(&self->closed) == closed);
+}
+
+/*----------------------------------------------------------------------
+|       SendLocalRequest
++---------------------------------------------------------------------*/
+static ATX_Result
+SendLocalRequest(ATX_HttpClient*    client,
+                 LocalServer*       server,
+                 ATX_CString        method,
+                 ATX_CString        path,
+                 ATX_HttpResponse** response)
+{
+    ATX_HttpRequest* request;
+    char             url[64];
+    ATX_Result       result;
+
+    ATX_FormatStringN(url, sizeof(url), "http://127.0.0.1:%d%s", (int)server->port, path);
+    result = ATX_HttpRequest_Create(method, url, &request);
+    CHECK_RESULT(result, "ATX_HttpRequest_Create failed");
+    result = ATX_HttpClient_SendRequest(client, request, response);
+    ATX_HttpRequest_Destroy(request);
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|       FinishLocalResponse
++---------------------------------------------------------------------*/
+static void
+FinishLocalResponse(ATX_HttpResponse* response)
+{
+    ATX_InputStream* body = NULL;
+    ATX_Size         body_size = 0;
+    char             buffer[5];
+    ATX_Size         bytes_read;
+
+    /* reading the body to the end gives the connection back to the pool */
+    CHECK(ATX_HttpResponse_GetStatusCode(response) == 200);
+    ATX_HttpMessage_GetBody((const ATX_HttpMessage*)response, &body, &body_size);
+    CHECK(body != NULL && body_size == 5);
+    CHECK_RESULT(ATX_InputStream_ReadFully(body, buffer, 5), "ATX_InputStream_ReadFully failed");
+    CHECK(ATX_CompareMemory(buffer, "hello", 5) == 0);
+    CHECK(ATX_InputStream_Read(body, buffer, 1, &bytes_read) == ATX_ERROR_EOS);
+    ATX_RELEASE_OBJECT(body);
+    ATX_HttpResponse_Destroy(response);
+}
+
+/*----------------------------------------------------------------------
+|       FetchLocal
++---------------------------------------------------------------------*/
+static void
+FetchLocal(ATX_HttpClient* client, LocalServer* server, ATX_CString path)
+{
+    ATX_HttpResponse* response;
+    ATX_Result        result;
+
+    result = SendLocalRequest(client, server, ATX_HTTP_METHOD_GET, path, &response);
+    CHECK_RESULT(result, "SendLocalRequest failed");
+    FinishLocalResponse(response);
+}
+
+/*----------------------------------------------------------------------
+|       ConnectionPoolTest
++---------------------------------------------------------------------*/
+static void
+ConnectionPoolTest(void)
+{
+    LocalServer       server;
+    ATX_HttpClient*   client;
+    ATX_HttpResponse* first;
+    ATX_HttpResponse* second;
+    ATX_UInt32        idle_timeout;
+    ATX_TimeInterval  idle = {0, 100000000};
+    ATX_Result        result;
+
+    LocalServer_Start(&server);
+    CHECK_RESULT(ATX_HttpClient_Create(&client), "ATX_HttpClient_Create failed");
+
+    /* a connection is reused once its response has been read */
+    FetchLocal(client, &server, "/a");
+    FetchLocal(client, &server, "/b");
+    CHECK(ATX_AtomicInt_Get(&server.connections) == 1);
+    CHECK(ATX_AtomicInt_Get(&server.requests) == 2);
+
+    /* an idle connection is not reused after the idle timeout */
+    ATX_HttpClient_GetOptionUInt(client, ATX_HTTP_CLIENT_OPTION_IDLE_TIMEOUT, &idle_timeout);
+    ATX_HttpClient_SetOptionUInt(client, ATX_HTTP_CLIENT_OPTION_IDLE_TIMEOUT, 20);
+    ATX_System_Sleep(&idle);
+    FetchLocal(client, &server, "/a");
+    CHECK(ATX_AtomicInt_Get(&server.connections) == 2);
+    ATX_HttpClient_SetOptionUInt(client, ATX_HTTP_CLIENT_OPTION_IDLE_TIMEOUT, idle_timeout);
+
+    /* two requests in flight need two connections, but only one is */
+    /* kept when the pool holds at most one connection per host     */
+    ATX_HttpClient_SetOptionUInt(client, ATX_HTTP_CLIENT_OPTION_MAX_CONNECTIONS_PER_HOST, 1);
+    CHECK_RESULT(SendLocalRequest(client, &server, ATX_HTTP_METHOD_GET, "/a", &first), "SendLocalRequest failed");
+    CHECK_RESULT(SendLocalRequest(client, &server, ATX_HTTP_METHOD_GET, "/b", &second), "SendLocalRequest failed");
+    CHECK(ATX_AtomicInt_Get(&server.connections) == 3);
+    FinishLocalResponse(first);
+    FinishLocalResponse(second);
+    CHECK_RESULT(SendLocalRequest(client, &server, ATX_HTTP_METHOD_GET, "/a", &first), "SendLocalRequest failed");
+    CHECK_RESULT(SendLocalRequest(client, &server, ATX_HTTP_METHOD_GET, "/b", &second), "SendLocalRequest failed");
+    CHECK(ATX_AtomicInt_Get(&server.connections) == 4);
+    FinishLocalResponse(first);
+    FinishLocalResponse(second);
+    CHECK(ATX_AtomicInt_Get(&server.requests) == 7);
+
+    /* a GET on a connection closed by the server is sent again */
+    FetchLocal(client, &server, "/close");
+    LocalServer_WaitForClose(&server, 1);
+    FetchLocal(client, &server, "/a");
+    CHECK(ATX_AtomicInt_Get(&server.connections) == 5);
+    CHECK(ATX_AtomicInt_Get(&server.requests) == 9);
+
+    /* a POST is not, as the server may already have received it */
+    FetchLocal(client, &server, "/close");
+    LocalServer_WaitForClose(&server, 2);
+    result = SendLocalRequest(client, &server, ATX_HTTP_METHOD_POST, "/a", &first);
+    CHECK(ATX_FAILED(result));
+    CHECK(ATX_AtomicInt_Get(&server.connections) == 5);
+    CHECK(ATX_AtomicInt_Get(&server.requests) == 10);
+    FetchLocal(client, &server, "/a");
+    CHECK(ATX_AtomicInt_Get(&server.connections) == 6);
+
+    /* interim responses are skipped, and the connection stays usable */
+    FetchLocal(client, &server, "/continue");
+    FetchLocal(client, &server, "/a");
+    CHECK(ATX_AtomicInt_Get(&server.connections) == 6);
+    CHECK(ATX_AtomicInt_Get(&server.requests) == 13);
+
+    ATX_HttpClient_Destroy(client);
+    LocalServer_Stop(&server);
+    ATX_Debug("ConnectionPoolTest passed\n");
+}
+
 /*----------------------------------------------------------------------
 |       main
 +---------------------------------------------------------------------*/
@@ -103,14 +547,20 @@ main(int argc, char** argv)
     ATX_HttpClient*   client;
     ATX_HttpRequest*  request;
     ATX_HttpResponse* response;
-    ATX_InputStream*  response_body = NULL;
-    ATX_Size          response_body_size = 0;
-    const char*       url = "http://zebulon.bok.net/tmp/redirect";
+    const char*       url;
     ATX_Result        result;
+    int               i;
 
+    /* decoding tests */
+    ChunkedTest();
+    ParsedHeadersTest();
 
-    /* command line args */
-    if (argc == 2) url = argv[1];
+    /* connection pool tests, against a local server */
+    ConnectionPoolTest();
+
+    /* the remote test only runs when given a url */
+    if (argc != 2) return 0;
+    url = argv[1];
     ATX_Debug("test url=%s\n", url);
 
     /* create a request */
@@ -121,21 +571,36 @@ main(int argc, char** argv)
     result = ATX_HttpClient_Create(&client);
     CHECK_RESULT(result, "ATX_HttpClient_Create failed");
 
-    /* send the request and get a response */
-    result = ATX_HttpClient_SendRequest(client, request, &response);
-    CHECK_RESULT(result, "ATX_HttpClient_SendRequest failed");
+    /* send the request twice, the second one can reuse the connection */
+    for (i=0; i<2; i++) {
+        ATX_InputStream* response_body = NULL;
+        ATX_Size         response_body_size = 0;
+        ATX_DataBuffer*  body = NULL;
+
+        /* send the request and get a response */
+        result = ATX_HttpClient_SendRequest(client, request, &response);
+        CHECK_RESULT(result, "ATX_HttpClient_SendRequest failed");
 
-    /* print the response */
-    ATX_Debug("StatusCode = %d\n", ATX_HttpResponse_GetStatusCode(response));
-    ATX_Debug("ReasonPhrase = %s\n", 
-              ATX_String_GetChars(ATX_HttpResponse_GetReasonPhrase(response)));
-    ATX_HttpMessage_GetBody((const ATX_HttpMessage*)response, NULL, &response_body_size);
-    ATX_Debug("BodySize = %d\n", response_body_size);
+        /* print the response */
+        ATX_Debug("StatusCode = %d\n", ATX_HttpResponse_GetStatusCode(response));
+        ATX_Debug("ReasonPhrase = %s\n", 
+                  ATX_String_GetChars(ATX_HttpResponse_GetReasonPhrase(response)));
+        ATX_HttpMessage_GetBody((const ATX_HttpMessage*)response, &response_body, &response_body_size);
+        ATX_Debug("BodySize = %d\n", response_body_size);
 
+        /* read the body so that the connection goes back to the pool */
+        if (response_body) {
+            result = ATX_InputStream_Load(response_body, 0, &body);
+            CHECK_RESULT(result, "ATX_InputStream_Load failed");
+            ATX_Debug("BodyRead = %d\n", ATX_DataBuffer_GetDataSize(body));
+            ATX_DataBuffer_Destroy(body);
+        }
+
+        ATX_RELEASE_OBJECT(response_body);
+        ATX_HttpResponse_Destroy(response);
+    }
 
     /* cleanup */
-    ATX_RELEASE_OBJECT(response_body);
-    ATX_HttpResponse_Destroy(response);
     ATX_HttpRequest_Destroy(request);
     ATX_HttpClient_Destroy(client);
 
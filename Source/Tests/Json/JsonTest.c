@@ -248,6 +248,782 @@ static char pass1_json[] = {
 };
 unsigned int pass1_json_len = 1441;
 
+/*----------------------------------------------------------------------
+|       GetElapsedMicroseconds
++---------------------------------------------------------------------*/
+static ATX_UInt64
+GetElapsedMicroseconds(const ATX_TimeStamp* start)
+{
+    ATX_TimeStamp now;
+    ATX_TimeStamp elapsed;
+    ATX_System_GetCurrentTimeStamp(&now);
+    ATX_TimeStamp_Sub(elapsed, now, *start);
+    return (ATX_UInt64)elapsed.seconds*1000000+elapsed.nanoseconds/1000;
+}
+
+/*----------------------------------------------------------------------
+|       ChildrenTest
++---------------------------------------------------------------------*/
+static void
+ChildrenTest(void)
+{
+    ATX_Json*    json = ATX_Json_CreateObject();
+    ATX_Json*    child;
+    char         name[32];
+    unsigned int i;
+
+    /* members are kept in insertion order, before and after indexing */
+    for (i=0; i<100; i++) {
+        ATX_FormatStringN(name, sizeof(name), "m%u", i);
+        SHOULD_SUCCEED(ATX_Json_AddChild(json, name, ATX_Json_CreateNumber(i)));
+        if (i == 20) CHECK(ATX_Json_GetChild(json, "m3") != NULL);
+    }
+    CHECK(ATX_Json_GetChildCount(json) == 100);
+    for (i=0; i<100; i++) {
+        const char* child_name = NULL;
+        ATX_FormatStringN(name, sizeof(name), "m%u", i);
+        child = ATX_Json_GetChildAt(json, i, &child_name);
+        CHECK(ATX_StringsEqual(child_name, name));
+        CHECK(ATX_Json_GetChild(json, name) == child);
+        CHECK(ATX_Json_GetParent(child) == json);
+    }
+    CHECK(ATX_Json_GetChild(json, "m100") == NULL);
+    CHECK(ATX_Json_GetChild(json, "") == NULL);
+
+    /* the last of duplicate names wins */
+    SHOULD_SUCCEED(ATX_Json_AddChild(json, "m7", ATX_Json_CreateNumber(1000)));
+    CHECK(ATX_Json_AsInteger(ATX_Json_GetChild(json, "m7")) == 1000);
+    CHECK(ATX_Json_AsInteger(ATX_Json_GetChildAt(json, 7, NULL)) == 7);
+    CHECK(ATX_Json_AsInteger(ATX_Json_GetChildAt(json, 100, NULL)) == 1000);
+    ATX_Json_Destroy(json);
+}
+
+/*----------------------------------------------------------------------
+|       ChildrenBenchmark
++---------------------------------------------------------------------*/
+#define JSON_BENCHMARK_ARRAY_SIZE   100000
+#define JSON_BENCHMARK_OBJECT_SIZE  10000
+
+static void
+ChildrenBenchmark(void)
+{
+    ATX_Json*     json;
+    ATX_TimeStamp start;
+    char          name[32];
+    unsigned int  i;
+
+    /* array access by index */
+    ATX_System_GetCurrentTimeStamp(&start);
+    json = ATX_Json_CreateArray();
+    for (i=0; i<JSON_BENCHMARK_ARRAY_SIZE; i++) {
+        SHOULD_SUCCEED(ATX_Json_AddChild(json, NULL, ATX_Json_CreateNumber(i)));
+    }
+    for (i=0; i<JSON_BENCHMARK_ARRAY_SIZE; i++) {
+        CHECK(ATX_Json_AsInteger(ATX_Json_GetChildAt(json, i, NULL)) == (ATX_Int32)i);
+    }
+    ATX_Json_Destroy(json);
+    ATX_Debug("json array benchmark (%d elements): %d us\n", 
+              JSON_BENCHMARK_ARRAY_SIZE,
+              (int)GetElapsedMicroseconds(&start));
+
+    /* object access by name */
+    ATX_System_GetCurrentTimeStamp(&start);
+    json = ATX_Json_CreateObject();
+    for (i=0; i<JSON_BENCHMARK_OBJECT_SIZE; i++) {
+        ATX_FormatStringN(name, sizeof(name), "config.session.%u", i);
+        SHOULD_SUCCEED(ATX_Json_AddChild(json, name, ATX_Json_CreateNumber(i)));
+    }
+    for (i=0; i<JSON_BENCHMARK_OBJECT_SIZE; i++) {
+        unsigned int member = (i*7919)%JSON_BENCHMARK_OBJECT_SIZE;
+        ATX_FormatStringN(name, sizeof(name), "config.session.%u", member);
+        CHECK(ATX_Json_AsInteger(ATX_Json_GetChild(json, name)) == (ATX_Int32)member);
+        ATX_FormatStringN(name, sizeof(name), "config.missing.%u", i);
+        CHECK(ATX_Json_GetChild(json, name) == NULL);
+    }
+    ATX_Json_Destroy(json);
+    ATX_Debug("json object benchmark (%d members): %d us\n", 
+              JSON_BENCHMARK_OBJECT_SIZE,
+              (int)GetElapsedMicroseconds(&start));
+}
+
+/*----------------------------------------------------------------------
+|       EventRecorder
++---------------------------------------------------------------------*/
+typedef struct {
+    ATX_IMPLEMENTS(ATX_JsonListener);
+    ATX_String events;
+    int        max_values; /* abort after that many values (-1: never) */
+} EventRecorder;
+
+ATX_DECLARE_INTERFACE_MAP(EventRecorder, ATX_JsonListener)
+
+static void
+EventRecorder_AppendName(EventRecorder* self, const char* name)
+{
+    if (name) {
+        ATX_String_Append(&self->events, name);
+        ATX_String_AppendChar(&self->events, ':');
+    }
+}
+
+ATX_METHOD
+EventRecorder_OnStartContainer(ATX_JsonListener* _self, 
+                               const char*       name, 
+                               ATX_JsonType      type)
+{
+    EventRecorder* self = ATX_SELF(EventRecorder, ATX_JsonListener);
+    EventRecorder_AppendName(self, name);
+    ATX_String_AppendChar(&self->events, type == ATX_JSON_TYPE_OBJECT ? '{' : '[');
+    return ATX_SUCCESS;
+}
+
+ATX_METHOD
+EventRecorder_OnEndContainer(ATX_JsonListener* _self, ATX_JsonType type)
+{
+    EventRecorder* self = ATX_SELF(EventRecorder, ATX_JsonListener);
+    ATX_String_AppendChar(&self->events, type == ATX_JSON_TYPE_OBJECT ? '}' : ']');
+    return ATX_SUCCESS;
+}
+
+ATX_METHOD
+EventRecorder_OnValue(ATX_JsonListener*    _self, 
+                      const char*          name, 
+                      const ATX_JsonValue* value)
+{
+    EventRecorder* self = ATX_SELF(EventRecorder, ATX_JsonListener);
+    char           workspace[32];
+
+    if (self->max_values == 0) return ATX_ERROR_INVALID_STATE;
+    if (self->max_values > 0) --self->max_values;
+    EventRecorder_AppendName(self, name);
+    switch (value->type) {
+      case ATX_JSON_TYPE_STRING:
+        ATX_String_AppendChar(&self->events, '"');
+        ATX_String_AppendSubString(&self->events, 
+                                   value->value.string.chars,
+                                   value->value.string.length);
+        ATX_String_AppendChar(&self->events, '"');
+        break;
+      case ATX_JSON_TYPE_NUMBER:
+        ATX_IntegerToString((ATX_Int32)value->value.number, workspace, sizeof(workspace));
+        ATX_String_Append(&self->events, workspace);
+        break;
+      case ATX_JSON_TYPE_BOOLEAN:
+        ATX_String_Append(&self->events, value->value.boolean ? "T" : "F");
+        break;
+      default:
+        ATX_String_Append(&self->events, "N");
+        break;
+    }
+    ATX_String_AppendChar(&self->events, ',');
+    return ATX_SUCCESS;
+}
+
+ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(EventRecorder)
+    ATX_GET_INTERFACE_ACCEPT(EventRecorder, ATX_JsonListener)
+ATX_END_GET_INTERFACE_IMPLEMENTATION
+
+ATX_BEGIN_INTERFACE_MAP(EventRecorder, ATX_JsonListener)
+    EventRecorder_OnStartContainer,
+    EventRecorder_OnEndContainer,
+    EventRecorder_OnValue
+};
+
+/*----------------------------------------------------------------------
+|       StreamingTest
++---------------------------------------------------------------------*/
+static void
+StreamingTest(void)
+{
+    static const ATX_Size chunk_sizes[] = {1, 2, 3, 7, 64, 4096};
+    const char*       source = "{\"a\": [1, \"x\\u0041y\", true], \"\": {}, \"b\": null, \"c\": -12e1}";
+    const char*       events = "{a:[1,\"xAy\",T,]:{}b:N,c:-120,}";
+    ATX_JsonParser*   parser = NULL;
+    ATX_Json*         json = NULL;
+    ATX_String        expected = ATX_EMPTY_STRING;
+    ATX_String        buffer = ATX_EMPTY_STRING;
+    ATX_MemoryStream* memory = NULL;
+    ATX_InputStream*  stream = NULL;
+    EventRecorder     recorder;
+    ATX_JsonListener* listener;
+    unsigned int      i;
+
+    SHOULD_SUCCEED(ATX_Json_ParseBuffer(pass1_json, pass1_json_len, &json));
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &expected, ATX_FALSE));
+    ATX_Json_Destroy(json);
+
+    /* build a tree from chunks of any size, reusing the parser */
+    SHOULD_SUCCEED(ATX_JsonParser_Create(NULL, &parser));
+    for (i=0; i<sizeof(chunk_sizes)/sizeof(chunk_sizes[0]); i++) {
+        ATX_Size offset = 0;
+        while (offset < pass1_json_len) {
+            ATX_Size chunk = chunk_sizes[i];
+            if (chunk > pass1_json_len-offset) chunk = pass1_json_len-offset;
+            SHOULD_SUCCEED(ATX_JsonParser_Feed(parser, pass1_json+offset, chunk));
+            offset += chunk;
+        }
+        SHOULD_SUCCEED(ATX_JsonParser_Finish(parser, &json));
+        CHECK(json != NULL);
+        SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+        CHECK(ATX_String_Equals(&buffer, ATX_CSTR(expected), ATX_FALSE));
+        ATX_Json_Destroy(json);
+    }
+
+    /* errors are sticky until the document is finished */
+    SHOULD_FAIL(ATX_JsonParser_Feed(parser, "[1,]", 4));
+    SHOULD_FAIL(ATX_JsonParser_Feed(parser, "1", 1));
+    SHOULD_FAIL(ATX_JsonParser_Finish(parser, &json));
+    CHECK(json == NULL);
+    SHOULD_SUCCEED(ATX_JsonParser_Feed(parser, "[1,", 3));
+    SHOULD_FAIL(ATX_JsonParser_Finish(parser, &json));
+    CHECK(json == NULL);
+    SHOULD_SUCCEED(ATX_JsonParser_Feed(parser, "tr", 2));
+    SHOULD_SUCCEED(ATX_JsonParser_Feed(parser, "ue", 2));
+    SHOULD_SUCCEED(ATX_JsonParser_Finish(parser, &json));
+    CHECK(json != NULL && ATX_Json_AsBoolean(json) == ATX_TRUE);
+    ATX_Json_Destroy(json);
+    SHOULD_SUCCEED(ATX_JsonParser_Destroy(parser));
+
+    /* events */
+    ATX_SET_INTERFACE(&recorder, EventRecorder, ATX_JsonListener);
+    listener = &ATX_BASE(&recorder, ATX_JsonListener);
+    ATX_String_Construct(&recorder.events);
+    SHOULD_SUCCEED(ATX_JsonParser_CreateWithListener(listener, &parser));
+    for (i=0; i<sizeof(chunk_sizes)/sizeof(chunk_sizes[0]); i++) {
+        ATX_Size size   = ATX_StringLength(source);
+        ATX_Size offset = 0;
+        recorder.max_values = -1;
+        ATX_String_SetLength(&recorder.events, 0);
+        while (offset < size) {
+            ATX_Size chunk = chunk_sizes[i];
+            if (chunk > size-offset) chunk = size-offset;
+            SHOULD_SUCCEED(ATX_JsonParser_Feed(parser, source+offset, chunk));
+            offset += chunk;
+        }
+        SHOULD_SUCCEED(ATX_JsonParser_Finish(parser, NULL));
+        CHECK(ATX_String_Equals(&recorder.events, events, ATX_FALSE));
+    }
+
+    /* a listener can abort the parse */
+    recorder.max_values = 2;
+    ATX_String_SetLength(&recorder.events, 0);
+    CHECK(ATX_JsonParser_Feed(parser, source, ATX_StringLength(source)) == ATX_ERROR_INVALID_STATE);
+    CHECK(ATX_String_Equals(&recorder.events, "{a:[1,\"xAy\",", ATX_FALSE));
+    CHECK(ATX_JsonParser_Finish(parser, NULL) == ATX_ERROR_INVALID_STATE);
+    SHOULD_SUCCEED(ATX_JsonParser_Destroy(parser));
+    ATX_String_Destruct(&recorder.events);
+
+    /* parse from a stream */
+    SHOULD_SUCCEED(ATX_MemoryStream_CreateFromBuffer((ATX_Byte*)pass1_json, pass1_json_len, &memory));
+    SHOULD_SUCCEED(ATX_MemoryStream_GetInputStream(memory, &stream));
+    SHOULD_SUCCEED(ATX_Json_ParseStream(stream, NULL, &json));
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+    CHECK(ATX_String_Equals(&buffer, ATX_CSTR(expected), ATX_FALSE));
+    ATX_Json_Destroy(json);
+    ATX_RELEASE_OBJECT(stream);
+    ATX_MemoryStream_Destroy(memory);
+
+    ATX_String_Destruct(&expected);
+    ATX_String_Destruct(&buffer);
+}
+
+/*----------------------------------------------------------------------
+|       SerializeTest
++---------------------------------------------------------------------*/
+static void
+SerializeTest(void)
+{
+    static const double numbers[] = {
+        0.1, 1.0/3.0, -2.5, 1e300, -2.5e-300, 5e-324, 0.30000000000000004,
+        123456789012345678.0, 9007199254740993.0, 1e21, 4294967296.0, -0.0
+    };
+    ATX_Json*          json = NULL;
+    ATX_Json*          parsed = NULL;
+    ATX_String         expected = ATX_EMPTY_STRING;
+    ATX_String         buffer = ATX_EMPTY_STRING;
+    ATX_MemoryStream*  memory = NULL;
+    ATX_OutputStream*  stream = NULL;
+    const ATX_DataBuffer* data = NULL;
+    double             zero = 0.0;
+    char               name[32];
+    unsigned int       i;
+    int                pretty;
+
+    /* numbers use the shortest form that round-trips */
+    for (i=0; i<sizeof(numbers)/sizeof(numbers[0]); i++) {
+        json = ATX_Json_CreateNumber(numbers[i]);
+        SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+        SHOULD_SUCCEED(ATX_Json_Parse(ATX_CSTR(buffer), &parsed));
+        CHECK(ATX_Json_AsDouble(parsed) == numbers[i]);
+        ATX_Json_Destroy(parsed);
+        ATX_Json_Destroy(json);
+    }
+    json = ATX_Json_CreateNumber(0.1);
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+    CHECK(ATX_String_Equals(&buffer, "0.1", ATX_FALSE));
+    ATX_Json_Destroy(json);
+    json = ATX_Json_CreateNumber(-1234567890123.0);
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+    CHECK(ATX_String_Equals(&buffer, "-1234567890123", ATX_FALSE));
+    ATX_Json_Destroy(json);
+    json = ATX_Json_CreateNumber(-273.15);
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+    CHECK(ATX_String_Equals(&buffer, "-273.15", ATX_FALSE));
+    ATX_Json_Destroy(json);
+    json = ATX_Json_CreateNumber(0.00012);
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+    CHECK(ATX_String_Equals(&buffer, "0.00012", ATX_FALSE));
+    ATX_Json_Destroy(json);
+    json = ATX_Json_CreateNumber(0.00001);
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+    CHECK(ATX_String_Equals(&buffer, "1e-05", ATX_FALSE));
+    ATX_Json_Destroy(json);
+
+    /* negative zero keeps its sign */
+    json = ATX_Json_CreateNumber(-zero);
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+    CHECK(ATX_String_Equals(&buffer, "-0", ATX_FALSE));
+    SHOULD_SUCCEED(ATX_Json_Parse(ATX_CSTR(buffer), &parsed));
+    CHECK(1.0/ATX_Json_AsDouble(parsed) < 0.0);
+    ATX_Json_Destroy(parsed);
+    ATX_Json_Destroy(json);
+    json = ATX_Json_CreateNumber(zero/zero);
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+    CHECK(ATX_String_Equals(&buffer, "null", ATX_FALSE));
+    ATX_Json_Destroy(json);
+
+    /* control characters are escaped */
+    json = ATX_Json_CreateString("a\x01" "b\x1F\"");
+    SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+    CHECK(ATX_String_Equals(&buffer, "\"a\\u0001b\\u001f\\\"\"", ATX_FALSE));
+    SHOULD_SUCCEED(ATX_Json_Parse(ATX_CSTR(buffer), &parsed));
+    CHECK(ATX_String_Equals(ATX_Json_AsString(parsed), "a\x01" "b\x1F\"", ATX_FALSE));
+    ATX_Json_Destroy(parsed);
+    ATX_Json_Destroy(json);
+
+    /* a stream gets the same output, across many staging buffer flushes */
+    json = ATX_Json_CreateObject();
+    for (i=0; i<1000; i++) {
+        ATX_Json* child = ATX_Json_CreateArray();
+        ATX_FormatStringN(name, sizeof(name), "member %u", i);
+        SHOULD_SUCCEED(ATX_Json_AddChild(child, NULL, ATX_Json_CreateString(name)));
+        SHOULD_SUCCEED(ATX_Json_AddChild(child, NULL, ATX_Json_CreateNumber(i/8.0)));
+        SHOULD_SUCCEED(ATX_Json_AddChild(json, name, child));
+    }
+    for (pretty=0; pretty<2; pretty++) {
+        SHOULD_SUCCEED(ATX_Json_Serialize(json, &expected, (ATX_Boolean)pretty));
+        CHECK(ATX_String_GetLength(&expected) > 4*ATX_JSON_SERIALIZER_BUFFER_SIZE);
+        SHOULD_SUCCEED(ATX_MemoryStream_Create(0, &memory));
+        SHOULD_SUCCEED(ATX_MemoryStream_GetOutputStream(memory, &stream));
+        SHOULD_SUCCEED(ATX_Json_SerializeToStream(json, stream, (ATX_Boolean)pretty));
+        SHOULD_SUCCEED(ATX_MemoryStream_GetBuffer(memory, &data));
+        CHECK(ATX_DataBuffer_GetDataSize(data) == ATX_String_GetLength(&expected));
+        CHECK(ATX_MemoryEqual(ATX_DataBuffer_GetData(data), 
+                              ATX_CSTR(expected), 
+                              ATX_String_GetLength(&expected)));
+        SHOULD_SUCCEED(ATX_Json_ParseBuffer((const char*)ATX_DataBuffer_GetData(data),
+                                            ATX_DataBuffer_GetDataSize(data),
+                                            &parsed));
+        SHOULD_SUCCEED(ATX_Json_Serialize(parsed, &buffer, (ATX_Boolean)pretty));
+        CHECK(ATX_String_Equals(&buffer, ATX_CSTR(expected), ATX_FALSE));
+        ATX_Json_Destroy(parsed);
+        ATX_RELEASE_OBJECT(stream);
+        ATX_MemoryStream_Destroy(memory);
+    }
+    ATX_Json_Destroy(json);
+
+    ATX_String_Destruct(&expected);
+    ATX_String_Destruct(&buffer);
+}
+
+/*----------------------------------------------------------------------
+|       FailingStream
+|
+|       Output stream that fails once it has taken a given number of bytes
++---------------------------------------------------------------------*/
+typedef struct {
+    ATX_IMPLEMENTS(ATX_OutputStream);
+    ATX_Size     capacity;
+    ATX_Size     written;
+    unsigned int write_count;
+} FailingStream;
+
+ATX_DECLARE_INTERFACE_MAP(FailingStream, ATX_OutputStream)
+
+ATX_METHOD
+FailingStream_Write(ATX_OutputStream* _self,
+                    ATX_AnyConst      buffer,
+                    ATX_Size          bytes_to_write,
+                    ATX_Size*         bytes_written)
+{
+    FailingStream* self = ATX_SELF(FailingStream, ATX_OutputStream);
+
+    ATX_COMPILER_UNUSED(buffer);
+    ++self->write_count;
+    if (bytes_written) *bytes_written = 0;
+    if (self->written+bytes_to_write > self->capacity) return ATX_ERROR_NOT_ENOUGH_SPACE;
+    self->written += bytes_to_write;
+    if (bytes_written) *bytes_written = bytes_to_write;
+    return ATX_SUCCESS;
+}
+
+ATX_METHOD
+FailingStream_Seek(ATX_OutputStream* _self, ATX_Position offset)
+{
+    ATX_COMPILER_UNUSED(_self);
+    ATX_COMPILER_UNUSED(offset);
+    return ATX_ERROR_NOT_SUPPORTED;
+}
+
+ATX_METHOD
+FailingStream_Tell(ATX_OutputStream* _self, ATX_Position* offset)
+{
+    FailingStream* self = ATX_SELF(FailingStream, ATX_OutputStream);
+    *offset = self->written;
+    return ATX_SUCCESS;
+}
+
+ATX_METHOD
+FailingStream_Flush(ATX_OutputStream* _self)
+{
+    ATX_COMPILER_UNUSED(_self);
+    return ATX_SUCCESS;
+}
+
+ATX_BEGIN_GET_INTERFACE_IMPLEMENTATION(FailingStream)
+    ATX_GET_INTERFACE_ACCEPT(FailingStream, ATX_OutputStream)
+ATX_END_GET_INTERFACE_IMPLEMENTATION
+
+ATX_BEGIN_INTERFACE_MAP(FailingStream, ATX_OutputStream)
+    FailingStream_Write,
+    FailingStream_Seek,
+    FailingStream_Tell,
+    FailingStream_Flush
+};
+
+/*----------------------------------------------------------------------
+|       FailingStreamTest
+|
+|       A write error stops the serializer, whatever is left to emit
++---------------------------------------------------------------------*/
+static void
+FailingStreamTest(void)
+{
+    FailingStream stream;
+    ATX_Json*     json = ATX_Json_CreateArray();
+    ATX_Size      capacity;
+    unsigned int  i;
+    int           pretty;
+
+    for (i=0; i<3000; i++) {
+        SHOULD_SUCCEED(ATX_Json_AddChild(json, NULL, ATX_Json_CreateString("some array element")));
+    }
+    ATX_SET_INTERFACE(&stream, FailingStream, ATX_OutputStream);
+    for (pretty=0; pretty<2; pretty++) {
+        for (capacity=0; capacity<=2*ATX_JSON_SERIALIZER_BUFFER_SIZE; capacity += ATX_JSON_SERIALIZER_BUFFER_SIZE) {
+            stream.capacity    = capacity;
+            stream.written     = 0;
+            stream.write_count = 0;
+            CHECK(ATX_Json_SerializeToStream(json, 
+                                             &ATX_BASE(&stream, ATX_OutputStream), 
+                                             (ATX_Boolean)pretty) == ATX_ERROR_NOT_ENOUGH_SPACE);
+            CHECK(stream.written == capacity);
+            /* nothing is written after the failure */
+            CHECK(stream.write_count == capacity/ATX_JSON_SERIALIZER_BUFFER_SIZE+1);
+        }
+    }
+    ATX_Json_Destroy(json);
+}
+
+/*----------------------------------------------------------------------
+|       LimitedAllocator
+|
+|       fails all the allocations after the first LimitedAllocatorBudget
++---------------------------------------------------------------------*/
+static unsigned int LimitedAllocatorBudget = 0;
+
+static void*
+LimitedAllocator_Allocate(void* context, ATX_Size size)
+{
+    ATX_COMPILER_UNUSED(context);
+    if (LimitedAllocatorBudget == 0) return NULL;
+    --LimitedAllocatorBudget;
+    return ATX_Allocator_Allocate(ATX_GetDefaultAllocator(), size);
+}
+
+static void*
+LimitedAllocator_Reallocate(void* context, void* memory, ATX_Size size)
+{
+    ATX_COMPILER_UNUSED(context);
+    if (LimitedAllocatorBudget == 0) return NULL;
+    --LimitedAllocatorBudget;
+    return ATX_Allocator_Reallocate(ATX_GetDefaultAllocator(), memory, size);
+}
+
+static void
+LimitedAllocator_Free(void* context, void* memory)
+{
+    ATX_COMPILER_UNUSED(context);
+    ATX_Allocator_Free(ATX_GetDefaultAllocator(), memory);
+}
+
+static const ATX_Allocator LimitedAllocator = {
+    LimitedAllocator_Allocate,
+    LimitedAllocator_Reallocate,
+    LimitedAllocator_Free,
+    NULL
+};
+
+/*----------------------------------------------------------------------
+|       OutOfMemoryTest
+|
+|       running out of memory at any point fails the parse, it never
+|       produces an incomplete tree
++---------------------------------------------------------------------*/
+static void
+OutOfMemoryTest(void)
+{
+    const char*  source = "[\"first\", \"a string value that can't be stored inline\"]";
+    const char*  expected = "a string value that can't be stored inline";
+    ATX_Json*    json;
+    ATX_Result   result;
+    ATX_Boolean  failed = ATX_FALSE;
+    unsigned int budget;
+
+    SHOULD_SUCCEED(ATX_SetAllocator(&LimitedAllocator));
+    for (budget=0; budget<100; budget++) {
+        LimitedAllocatorBudget = budget;
+        json = NULL;
+        result = ATX_Json_ParseBuffer(source, ATX_StringLength(source), &json);
+        if (ATX_FAILED(result)) {
+            CHECK(result == ATX_ERROR_OUT_OF_MEMORY);
+            CHECK(json == NULL);
+            failed = ATX_TRUE;
+            continue;
+        }
+        CHECK(ATX_String_Equals(ATX_Json_AsString(ATX_Json_GetChildAt(json, 1, NULL)), 
+                                expected, 
+                                ATX_FALSE));
+        ATX_Json_Destroy(json);
+        break;
+    }
+    CHECK(failed);
+    CHECK(budget < 100);
+    SHOULD_SUCCEED(ATX_SetAllocator(NULL));
+}
+
+/*----------------------------------------------------------------------
+|       ArenaTest
++---------------------------------------------------------------------*/
+static void
+ArenaTest(void)
+{
+    ATX_JsonArena* arena = NULL;
+    ATX_Json*      json = NULL;
+    ATX_Json*      heap_json = NULL;
+    ATX_Json*      child = NULL;
+    ATX_String     expected = ATX_EMPTY_STRING;
+    ATX_String     buffer = ATX_EMPTY_STRING;
+    const char*    name = NULL;
+    const char*    source = "{\"a\":\"hello\\u00e9\", \"\":[true, null, 3.5]}";
+    unsigned int   i;
+
+    /* a small block size forces the tree to span many blocks */
+    SHOULD_SUCCEED(ATX_JsonArena_Create(256, &arena));
+
+    /* an arena tree serializes exactly like a heap tree */
+    SHOULD_SUCCEED(ATX_Json_ParseBuffer(pass1_json, pass1_json_len, &heap_json));
+    SHOULD_SUCCEED(ATX_Json_Serialize(heap_json, &expected, ATX_TRUE));
+    for (i=0; i<3; i++) {
+        SHOULD_SUCCEED(ATX_Json_ParseBufferEx(pass1_json, pass1_json_len, arena, &json));
+        CHECK(json != NULL);
+        SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_TRUE));
+        CHECK(ATX_String_Equals(&buffer, ATX_CSTR(expected), ATX_FALSE));
+        ATX_Json_Destroy(json); /* no-op */
+        ATX_JsonArena_Reset(arena);
+    }
+
+    /* accessors */
+    SHOULD_SUCCEED(ATX_Json_ParseBufferEx(source, ATX_StringLength(source), arena, &json));
+    CHECK(ATX_Json_GetType(json) == ATX_JSON_TYPE_OBJECT);
+    CHECK(ATX_Json_GetChildCount(json) == 2);
+    child = ATX_Json_GetChild(json, "a");
+    CHECK(child != NULL);
+    CHECK(ATX_Json_GetParent(child) == json);
+    CHECK(ATX_String_Equals(ATX_Json_AsString(child), "hello\xC3\xA9", ATX_FALSE));
+    CHECK(ATX_String_GetLength(ATX_Json_AsString(child)) == 7);
+    child = ATX_Json_GetChildAt(json, 1, &name);
+    CHECK(child != NULL);
+    CHECK(ATX_StringsEqual(name, ""));
+    CHECK(ATX_Json_GetChildCount(child) == 3);
+    CHECK(ATX_Json_AsBoolean(ATX_Json_GetChildAt(child, 0, NULL)) == ATX_TRUE);
+    CHECK(ATX_Json_GetType(ATX_Json_GetChildAt(child, 1, NULL)) == ATX_JSON_TYPE_NULL);
+    CHECK(ATX_Json_AsDouble(ATX_Json_GetChildAt(child, 2, NULL)) == 3.5);
+
+    /* heap and arena nodes can't be mixed */
+    SHOULD_FAIL(ATX_Json_AddChild(json, "b", heap_json));
+    SHOULD_FAIL(ATX_Json_AddChild(heap_json, NULL, child));
+
+    /* a failed parse leaves earlier trees intact */
+    SHOULD_FAIL(ATX_Json_ParseBufferEx("[1,2,{\"x\":]", 12, arena, &json));
+    CHECK(json == NULL);
+    SHOULD_FAIL(ATX_Json_ParseBufferEx(pass1_json, pass1_json_len-1, arena, &json));
+    CHECK(ATX_Json_AsDouble(ATX_Json_GetChildAt(child, 2, NULL)) == 3.5);
+
+    ATX_Json_Destroy(heap_json);
+    SHOULD_SUCCEED(ATX_JsonArena_Destroy(arena));
+    ATX_String_Destruct(&expected);
+    ATX_String_Destruct(&buffer);
+}
+
+/*----------------------------------------------------------------------
+|       ScannerTest
+|
+|       every scanner must produce exactly the same trees and errors
++---------------------------------------------------------------------*/
+#define JSON_SCANNER_DOCUMENT_SIZE 20000
+#define JSON_SCANNER_RUN_SIZE      1000000
+#define JSON_SCANNER_REPEAT        3
+
+/*----------------------------------------------------------------------
+|       TimeParse
+|
+|       best time of a few parses, in microseconds
++---------------------------------------------------------------------*/
+static int
+TimeParse(const ATX_String* document)
+{
+    ATX_Json*     json = NULL;
+    ATX_TimeStamp start;
+    int           best = 0;
+    int           elapsed;
+    unsigned int  i;
+
+    for (i=0; i<JSON_SCANNER_REPEAT; i++) {
+        ATX_System_GetCurrentTimeStamp(&start);
+        SHOULD_SUCCEED(ATX_Json_ParseBuffer(ATX_CSTR(*document), 
+                                            ATX_String_GetLength(document), 
+                                            &json));
+        elapsed = (int)GetElapsedMicroseconds(&start);
+        if (i == 0 || elapsed < best) best = elapsed;
+        ATX_Json_Destroy(json);
+    }
+
+    return best;
+}
+
+static void
+ScannerTest(void)
+{
+    static const ATX_JsonScannerType types[] = {
+        ATX_JSON_SCANNER_SCALAR,
+        ATX_JSON_SCANNER_SSE2,
+        ATX_JSON_SCANNER_AVX2
+    };
+    static const char* const names[] = { "scalar", "sse2", "avx2" };
+    ATX_JsonScannerType default_type = ATX_Json_GetScanner();
+    ATX_String          document = ATX_EMPTY_STRING;
+    ATX_String          expected = ATX_EMPTY_STRING;
+    ATX_String          buffer = ATX_EMPTY_STRING;
+    ATX_String          string_run = ATX_EMPTY_STRING;
+    ATX_String          blank_run = ATX_EMPTY_STRING;
+    ATX_Json*           json = NULL;
+    char                line[128];
+    char                source[96];
+    unsigned int        t;
+    unsigned int        i;
+    unsigned int        offset;
+
+    CHECK(default_type != ATX_JSON_SCANNER_AUTO);
+    SHOULD_FAIL(ATX_Json_SetScanner((ATX_JsonScannerType)42));
+
+    /* a string-heavy, indented document */
+    ATX_String_Append(&document, "{\n    \"records\": [\n");
+    for (i=0; i<JSON_SCANNER_DOCUMENT_SIZE; i++) {
+        ATX_FormatStringN(line, sizeof(line), 
+                          "        {\"message\": \"request %u handled by worker pool in %u ms\", "
+                          "\"path\": \"C:\\\\logs\\\\%u.txt\", \"ok\": %s}%s\n",
+                          i, i%97, i, (i%3) ? "true" : "false",
+                          i+1 == JSON_SCANNER_DOCUMENT_SIZE ? "" : ",");
+        ATX_String_Append(&document, line);
+    }
+    ATX_String_Append(&document, "    ]\n}\n");
+
+    /* documents where the parse time is the scan time */
+    ATX_String_Append(&string_run, "[\"");
+    ATX_String_Append(&blank_run, "[");
+    for (i=0; i<JSON_SCANNER_RUN_SIZE; i++) {
+        ATX_String_AppendChar(&string_run, (char)('a'+i%26));
+        ATX_String_AppendChar(&blank_run, " \n\t"[i%3]);
+    }
+    ATX_String_Append(&string_run, "\"]");
+    ATX_String_Append(&blank_run, "1]");
+
+    for (t=0; t<sizeof(types)/sizeof(types[0]); t++) {
+        if (ATX_FAILED(ATX_Json_SetScanner(types[t]))) {
+            ATX_Debug("json scanner %s: not supported\n", names[t]);
+            continue;
+        }
+        CHECK(ATX_Json_GetScanner() == types[t]);
+
+        ATX_Debug("json scanner %s: document (%d bytes) %d us, "
+                  "string run %d us, whitespace run %d us\n", 
+                  names[t],
+                  (int)ATX_String_GetLength(&document),
+                  TimeParse(&document),
+                  TimeParse(&string_run),
+                  TimeParse(&blank_run));
+        SHOULD_SUCCEED(ATX_Json_ParseBuffer(ATX_CSTR(document), 
+                                            ATX_String_GetLength(&document), 
+                                            &json));
+        SHOULD_SUCCEED(ATX_Json_Serialize(json, &buffer, ATX_FALSE));
+        ATX_Json_Destroy(json);
+        if (t == 0) {
+            ATX_String_Assign(&expected, ATX_CSTR(buffer));
+        } else {
+            CHECK(ATX_String_Equals(&buffer, ATX_CSTR(expected), ATX_FALSE));
+        }
+        SHOULD_SUCCEED(ATX_Json_Parse(ATX_CSTR(string_run), &json));
+        CHECK(ATX_String_GetLength(ATX_Json_AsString(ATX_Json_GetChildAt(json, 0, NULL))) == JSON_SCANNER_RUN_SIZE);
+        ATX_Json_Destroy(json);
+
+        /* special characters and whitespace runs at every offset within a vector */
+        for (offset=0; offset<70; offset++) {
+            ATX_SetMemory(source, 'x', sizeof(source));
+            source[0] = '[';
+            source[1] = '"';
+            source[2+offset] = '\\';
+            source[3+offset] = 'n';
+            ATX_CopyMemory(&source[4+offset], "\"]", 3);
+            SHOULD_SUCCEED(ATX_Json_Parse(source, &json));
+            CHECK(ATX_String_GetLength(ATX_Json_AsString(ATX_Json_GetChildAt(json, 0, NULL))) == offset+1);
+            CHECK(ATX_String_GetChars(ATX_Json_AsString(ATX_Json_GetChildAt(json, 0, NULL)))[offset] == '\n');
+            ATX_Json_Destroy(json);
+
+            source[2+offset] = '\t';
+            ATX_CopyMemory(&source[3+offset], "\"]", 3);
+            SHOULD_FAIL(ATX_Json_Parse(source, &json));
+
+            ATX_SetMemory(source, ' ', sizeof(source));
+            source[0] = '[';
+            ATX_CopyMemory(&source[2+offset], "1]", 3);
+            source[1] = '\n';
+            SHOULD_SUCCEED(ATX_Json_Parse(source, &json));
+            CHECK(ATX_Json_AsInteger(ATX_Json_GetChildAt(json, 0, NULL)) == 1);
+            ATX_Json_Destroy(json);
+        }
+    }
+
+    SHOULD_SUCCEED(ATX_Json_SetScanner(ATX_JSON_SCANNER_AUTO));
+    CHECK(ATX_Json_GetScanner() == default_type);
+
+    ATX_String_Destruct(&document);
+    ATX_String_Destruct(&expected);
+    ATX_String_Destruct(&buffer);
+    ATX_String_Destruct(&string_run);
+    ATX_String_Destruct(&blank_run);
+}
+
 /*----------------------------------------------------------------------
 |       main
 +---------------------------------------------------------------------*/
@@ -463,6 +1239,17 @@ main(int argc, char** argv)
     CHECK(name != NULL);
     CHECK(ATX_StringsEqual(name, ""));
     ATX_Json_Destroy(json);
+
+    ATX_String_Destruct(&buffer);
+
+    ArenaTest();
+    ChildrenTest();
+    StreamingTest();
+    SerializeTest();
+    FailingStreamTest();
+    OutOfMemoryTest();
+    ScannerTest();
+    ChildrenBenchmark();
     
     return 0;
 }
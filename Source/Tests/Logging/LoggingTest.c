@@ -32,12 +32,188 @@
 /*----------------------------------------------------------------------
 |  includes
 +---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
 #include "Atomix.h"
 
 ATX_DEFINE_LOGGER(MyLogger, "atomix.test.my")
 ATX_DEFINE_LOGGER(FooLogger, "atomix.test.foo")
+ATX_DEFINE_LOGGER(BenchSyncLogger, "atomix.test.bench.sync")
+ATX_DEFINE_LOGGER(BenchAsyncLogger, "atomix.test.bench.async")
+ATX_DEFINE_LOGGER(DispatchLogger, "atomix.test.dispatch")
+ATX_DEFINE_LOGGER(BinaryLogger, "atomix.test.binary")
+ATX_DEFINE_LOGGER(BenchTextLogger, "atomix.test.bench.text")
+ATX_DEFINE_LOGGER(BenchBinaryLogger, "atomix.test.bench.binary")
+ATX_DEFINE_LOGGER(BenchBufferedLogger, "atomix.test.bench.buffered")
+ATX_DEFINE_LOGGER(BenchDeferredLogger, "atomix.test.bench.deferred")
+ATX_DEFINE_LOGGER(DeferredLogger, "atomix.test.deferred")
+ATX_DEFINE_LOGGER(BufferedLogger, "atomix.test.buffered")
+ATX_DEFINE_LOGGER(IntervalLogger, "atomix.test.interval")
+ATX_DEFINE_LOGGER(RotatingLogger, "atomix.test.rotating")
+ATX_DEFINE_LOGGER(DeadHostLogger, "atomix.test.dead")
+ATX_DEFINE_LOGGER(TcpLogger, "atomix.test.tcp")
+ATX_DEFINE_LOGGER(UdpLogger, "atomix.test.udp")
+ATX_DEFINE_LOGGER(OverflowLogger, "atomix.test.overflow")
 ATX_SET_LOCAL_LOGGER("atomix.test")
 
+/*----------------------------------------------------------------------
+|  constants
++---------------------------------------------------------------------*/
+#define BENCH_THREAD_COUNT        4
+#define BENCH_RECORDS_PER_THREAD  10000
+#define DISPATCH_THREAD_COUNT     4
+#define DISPATCH_RECORDS_PER_THREAD 2000
+#define REGISTRY_LOGGER_COUNT     500
+#define BINARY_MAX_RECORDS        32
+#define BINARY_MESSAGE_SIZE       1024
+#define DEFERRED_MESSAGE_SIZE     64    /* must match LogConfig */
+#define CALL_COST_RECORDS         100000
+#define CALL_COST_BATCH           1000
+#define ROTATING_RECORDS          100
+#define FLUSH_INTERVAL            200   /* must match LogConfig */
+#define DEAD_HOST_RECORDS         1000
+#define TCP_TEST_PORT             17723 /* must match LogConfig */
+#define TCP_RECORDS               10
+#define UDP_TEST_PORT             17724 /* must match LogConfig */
+#define UDP_RECORDS               20
+#define OVERFLOW_TEST_PORT        17725 /* must match LogConfig */
+#define OVERFLOW_DURATION         300   /* ms of logging to a dead host */
+
+/*----------------------------------------------------------------------
+|  macros
++---------------------------------------------------------------------*/
+#define CHECK(x)                                            \
+    do {                                                    \
+        if (!(x)) {                                         \
+            printf("check failed line %d\n", __LINE__);     \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)
+
+/*----------------------------------------------------------------------
+|  globals
++---------------------------------------------------------------------*/
+/* the benchmark loggers write to files, directly or from a writer thread */
+/* whose queue is large enough for the whole benchmark                    */
+static char LogConfig[] = 
+    "ATOMIX_LOG_CONFIG=file:atomix-logging.properties|plist:"
+    "atomix.test.bench.sync.level=ALL;"
+    "atomix.test.bench.sync.forward=false;"
+    "atomix.test.bench.sync.handlers=FileHandler;"
+    "atomix.test.bench.sync.FileHandler.filename=atomix-bench-sync.log;"
+    "atomix.test.bench.sync.FileHandler.append=false;"
+    "atomix.test.bench.async.level=ALL;"
+    "atomix.test.bench.async.forward=false;"
+    "atomix.test.bench.async.handlers=AsyncHandler;"
+    "atomix.test.bench.async.AsyncHandler.handlers=FileHandler;"
+    "atomix.test.bench.async.AsyncHandler.capacity=65536;"
+    "atomix.test.bench.async.AsyncHandler.message_size=128;"
+    "atomix.test.bench.async.AsyncHandler.overflow=block;"
+    "atomix.test.bench.async.FileHandler.filename=atomix-bench-async.log;"
+    "atomix.test.bench.async.FileHandler.append=false;"
+    "atomix.test.dispatch.level=ALL;"
+    "atomix.test.dispatch.forward=false;"
+    "atomix.test.tree.level=ALL;"
+    "atomix.test.tree.forward=false;"
+    "atomix.test.tree.quiet.forward=false;"
+    "atomix.test.binary.level=ALL;"
+    "atomix.test.binary.forward=false;"
+    "atomix.test.binary.handlers=FileHandler;"
+    "atomix.test.binary.FileHandler.filename=atomix-binary.log;"
+    "atomix.test.binary.FileHandler.append=false;"
+    "atomix.test.binary.FileHandler.format=binary;"
+    "atomix.test.bench.text.level=ALL;"
+    "atomix.test.bench.text.forward=false;"
+    "atomix.test.bench.text.handlers=FileHandler;"
+    "atomix.test.bench.text.FileHandler.filename=atomix-bench-text.log;"
+    "atomix.test.bench.text.FileHandler.append=false;"
+    "atomix.test.bench.binary.level=ALL;"
+    "atomix.test.bench.binary.forward=false;"
+    "atomix.test.bench.binary.handlers=FileHandler;"
+    "atomix.test.bench.binary.FileHandler.filename=atomix-bench-binary.log;"
+    "atomix.test.bench.binary.FileHandler.append=false;"
+    "atomix.test.bench.binary.FileHandler.format=binary;"
+    "atomix.test.bench.buffered.level=ALL;"
+    "atomix.test.bench.buffered.forward=false;"
+    "atomix.test.bench.buffered.handlers=FileHandler;"
+    "atomix.test.bench.buffered.FileHandler.filename=atomix-bench-buffered.log;"
+    "atomix.test.bench.buffered.FileHandler.append=false;"
+    "atomix.test.bench.buffered.FileHandler.buffer_size=64K;"
+    "atomix.test.bench.deferred.level=ALL;"
+    "atomix.test.bench.deferred.forward=false;"
+    "atomix.test.bench.deferred.handlers=AsyncHandler;"
+    "atomix.test.bench.deferred.AsyncHandler.handlers=FileHandler;"
+    "atomix.test.bench.deferred.AsyncHandler.capacity=65536;"
+    "atomix.test.bench.deferred.AsyncHandler.message_size=128;"
+    "atomix.test.bench.deferred.AsyncHandler.overflow=block;"
+    "atomix.test.bench.deferred.FileHandler.filename=atomix-bench-deferred.log;"
+    "atomix.test.bench.deferred.FileHandler.append=false;"
+    "atomix.test.bench.deferred.FileHandler.format=binary;"
+    "atomix.test.bench.deferred.FileHandler.buffer_size=64K;"
+    "atomix.test.deferred.level=ALL;"
+    "atomix.test.deferred.forward=false;"
+    "atomix.test.deferred.handlers=AsyncHandler;"
+    "atomix.test.deferred.AsyncHandler.handlers=FileHandler;"
+    "atomix.test.deferred.AsyncHandler.message_size=64;"
+    "atomix.test.deferred.FileHandler.filename=atomix-deferred.log;"
+    "atomix.test.deferred.FileHandler.append=false;"
+    "atomix.test.deferred.FileHandler.format=binary;"
+    "atomix.test.buffered.level=ALL;"
+    "atomix.test.buffered.forward=false;"
+    "atomix.test.buffered.handlers=FileHandler;"
+    "atomix.test.buffered.FileHandler.filename=atomix-buffered.log;"
+    "atomix.test.buffered.FileHandler.append=false;"
+    "atomix.test.buffered.FileHandler.buffer_size=4096;"
+    "atomix.test.buffered.FileHandler.flush_interval=60000;"
+    "atomix.test.buffered.FileHandler.sync=true;"
+    "atomix.test.interval.level=ALL;"
+    "atomix.test.interval.forward=false;"
+    "atomix.test.interval.handlers=FileHandler;"
+    "atomix.test.interval.FileHandler.filename=atomix-interval.log;"
+    "atomix.test.interval.FileHandler.append=false;"
+    "atomix.test.interval.FileHandler.buffer_size=64K;"
+    "atomix.test.interval.FileHandler.flush_interval=200;"
+    "atomix.test.rotating.level=ALL;"
+    "atomix.test.rotating.forward=false;"
+    "atomix.test.rotating.handlers=FileHandler;"
+    "atomix.test.rotating.FileHandler.filename=atomix-rotating.log;"
+    "atomix.test.rotating.FileHandler.append=false;"
+    "atomix.test.rotating.FileHandler.max_size=2K;"
+    "atomix.test.rotating.FileHandler.backups=2;"
+    "atomix.test.dead.level=ALL;"
+    "atomix.test.dead.forward=false;"
+    "atomix.test.dead.handlers=TcpHandler;"
+    "atomix.test.dead.TcpHandler.hostname=127.0.0.1;"
+    "atomix.test.dead.TcpHandler.port=1;"
+    "atomix.test.dead.TcpHandler.queue_size=4K;"
+    "atomix.test.tcp.level=ALL;"
+    "atomix.test.tcp.forward=false;"
+    "atomix.test.tcp.handlers=TcpHandler;"
+    "atomix.test.tcp.TcpHandler.hostname=127.0.0.1;"
+    "atomix.test.tcp.TcpHandler.port=17723;"
+    "atomix.test.tcp.TcpHandler.framing=compact;"
+    "atomix.test.udp.level=ALL;"
+    "atomix.test.udp.forward=false;"
+    "atomix.test.udp.handlers=UdpHandler;"
+    "atomix.test.udp.UdpHandler.hostname=127.0.0.1;"
+    "atomix.test.udp.UdpHandler.port=17724;"
+    "atomix.test.udp.UdpHandler.framing=compact;"
+    "atomix.test.overflow.level=ALL;"
+    "atomix.test.overflow.forward=false;"
+    "atomix.test.overflow.handlers=TcpHandler;"
+    "atomix.test.overflow.TcpHandler.hostname=127.0.0.1;"
+    "atomix.test.overflow.TcpHandler.port=17725;"
+    "atomix.test.overflow.TcpHandler.format=binary;"
+    "atomix.test.overflow.TcpHandler.queue_size=1K";
+
+/* messages logged by BinaryTest, formatted by the caller */
+static char BinaryExpected[BINARY_MAX_RECORDS][BINARY_MESSAGE_SIZE];
+static int  BinaryRecordCount = 0;
+
+/* messages logged by DeferredTest */
+static char DeferredExpected[BINARY_MAX_RECORDS][DEFERRED_MESSAGE_SIZE];
+static int  DeferredRecordCount = 0;
+
 /*----------------------------------------------------------------------
 |  TestCheck functions
 +---------------------------------------------------------------------*/
@@ -160,6 +336,776 @@ end:
     return 1;
 }
 
+/*----------------------------------------------------------------------
+|  BenchThread
++---------------------------------------------------------------------*/
+static void
+BenchThread(void* arg)
+{
+    ATX_LoggerReference* logger = (ATX_LoggerReference*)arg;
+    int                  i;
+    
+    for (i=0; i<BENCH_RECORDS_PER_THREAD; i++) {
+        ATX_LOG_INFO_L2(*logger, "benchmark record %d of %d", i, BENCH_RECORDS_PER_THREAD);
+    }
+}
+
+/*----------------------------------------------------------------------
+|  RunBenchmark
++---------------------------------------------------------------------*/
+static void
+RunBenchmark(const char* name, ATX_LoggerReference* logger)
+{
+    ATX_Thread*   threads[BENCH_THREAD_COUNT];
+    ATX_TimeStamp start;
+    ATX_TimeStamp end;
+    ATX_TimeStamp elapsed;
+    double        seconds;
+    int           records = BENCH_THREAD_COUNT*BENCH_RECORDS_PER_THREAD;
+    int           i;
+    
+    /* resolve the logger before the threads share it */
+    ATX_LOG_INFO_L1(*logger, "starting %s benchmark", name);
+    
+    ATX_System_GetCurrentTimeStamp(&start);
+    for (i=0; i<BENCH_THREAD_COUNT; i++) {
+        if (ATX_FAILED(ATX_Thread_Create(BenchThread, logger, &threads[i]))) {
+            /* no threads, log from this one */
+            threads[i] = NULL;
+            BenchThread(logger);
+        }
+    }
+    for (i=0; i<BENCH_THREAD_COUNT; i++) {
+        if (threads[i]) ATX_Thread_Join(threads[i]);
+    }
+    ATX_System_GetCurrentTimeStamp(&end);
+    
+    ATX_TimeStamp_Sub(elapsed, end, start);
+    seconds = (double)elapsed.seconds+(double)elapsed.nanoseconds/1000000000.0;
+    ATX_Debug("%s: %d records in %d ms, %d records/s\n",
+              name,
+              records,
+              (int)(seconds*1000.0),
+              seconds > 0.0 ? (int)((double)records/seconds) : 0);
+}
+
+/*----------------------------------------------------------------------
+|  counting handlers
++---------------------------------------------------------------------*/
+typedef struct {
+    ATX_AtomicInt records;
+    ATX_AtomicInt inside; /* callers currently in the Log method */
+    ATX_AtomicInt overlaps;
+} CountingHandlerState;
+
+static void
+CountingHandler_Log(ATX_LogHandler* self, const ATX_LogRecord* record)
+{
+    CountingHandlerState* state = (CountingHandlerState*)self->instance;
+    ATX_COMPILER_UNUSED(record);
+
+    if (ATX_AtomicInt_Add(&state->inside, 1) != 1) {
+        ATX_AtomicInt_Add(&state->overlaps, 1);
+    }
+    ATX_AtomicInt_Add(&state->records, 1);
+
+    /* this must not recurse */
+    ATX_LOG_INFO_L(DispatchLogger, "logged from a handler");
+    
+    ATX_AtomicInt_Add(&state->inside, -1);
+}
+
+static void
+CountingHandler_Destroy(ATX_LogHandler* self)
+{
+    ATX_COMPILER_UNUSED(self);
+}
+
+static const ATX_LogHandlerInterface CountingHandler_Interface = {
+    CountingHandler_Log,
+    CountingHandler_Destroy,
+    0
+};
+
+static const ATX_LogHandlerInterface SerializedCountingHandler_Interface = {
+    CountingHandler_Log,
+    CountingHandler_Destroy,
+    ATX_LOG_HANDLER_FLAG_SERIALIZED
+};
+
+/*----------------------------------------------------------------------
+|  DispatchThread
++---------------------------------------------------------------------*/
+static void
+DispatchThread(void* arg)
+{
+    int i;
+    ATX_COMPILER_UNUSED(arg);
+    
+    for (i=0; i<DISPATCH_RECORDS_PER_THREAD; i++) {
+        ATX_LOG_INFO_L1(DispatchLogger, "dispatch record %d", i);
+    }
+}
+
+/*----------------------------------------------------------------------
+|  DispatchTest
++---------------------------------------------------------------------*/
+static void
+DispatchTest(void)
+{
+    static CountingHandlerState concurrent_state;
+    static CountingHandlerState serialized_state;
+    static CountingHandlerState late_state;
+    ATX_LogHandler concurrent = { (ATX_LogHandlerInstance*)&concurrent_state, &CountingHandler_Interface };
+    ATX_LogHandler serialized = { (ATX_LogHandlerInstance*)&serialized_state, &SerializedCountingHandler_Interface };
+    ATX_LogHandler late       = { (ATX_LogHandlerInstance*)&late_state,       &CountingHandler_Interface };
+    ATX_Thread*    threads[DISPATCH_THREAD_COUNT];
+    int            records = 1+DISPATCH_THREAD_COUNT*DISPATCH_RECORDS_PER_THREAD;
+    int            i;
+
+    /* a handler that logs only sees its own records once */
+    ATX_LOG_GET_LOGGER(DispatchLogger);
+    CHECK(DispatchLogger.logger != NULL);
+    CHECK(ATX_SUCCEEDED(ATX_Logger_AddHandler(DispatchLogger.logger, &concurrent)));
+    CHECK(ATX_SUCCEEDED(ATX_Logger_AddHandler(DispatchLogger.logger, &serialized)));
+    ATX_LOG_INFO_L(DispatchLogger, "first record");
+    CHECK(ATX_AtomicInt_Get(&concurrent_state.records) == 1);
+    CHECK(ATX_AtomicInt_Get(&serialized_state.records) == 1);
+
+    /* log from several threads while the handlers are reconfigured */
+    for (i=0; i<DISPATCH_THREAD_COUNT; i++) {
+        CHECK(ATX_SUCCEEDED(ATX_Thread_Create(DispatchThread, NULL, &threads[i])));
+    }
+    CHECK(ATX_SUCCEEDED(ATX_Logger_AddHandler(DispatchLogger.logger, &late)));
+    for (i=0; i<DISPATCH_THREAD_COUNT; i++) {
+        ATX_Thread_Join(threads[i]);
+    }
+
+    /* every record reached the handlers that were there from the start */
+    CHECK(ATX_AtomicInt_Get(&concurrent_state.records) == records);
+    CHECK(ATX_AtomicInt_Get(&serialized_state.records) == records);
+    CHECK(ATX_AtomicInt_Get(&late_state.records) <= records);
+    CHECK(ATX_AtomicInt_Get(&serialized_state.overlaps) == 0);
+}
+
+/*----------------------------------------------------------------------
+|  HierarchyTest
++---------------------------------------------------------------------*/
+static void
+HierarchyTest(void)
+{
+    static CountingHandlerState state;
+    ATX_LogHandler handler = { (ATX_LogHandlerInstance*)&state, &CountingHandler_Interface };
+    ATX_Logger*    leaf;
+    ATX_Logger*    quiet;
+    ATX_Logger*    tree;
+    char           name[64];
+    int            i;
+
+    /* the children exist before their parent gets a handler */
+    leaf  = ATX_Log_GetLogger("atomix.test.tree.leaf");
+    quiet = ATX_Log_GetLogger("atomix.test.tree.quiet");
+    tree  = ATX_Log_GetLogger("atomix.test.tree");
+    CHECK(leaf != NULL && quiet != NULL && tree != NULL);
+    CHECK(leaf->parent == tree);
+    CHECK(quiet->parent == tree);
+    CHECK(leaf->level == ATX_LOG_LEVEL_ALL);
+    CHECK(ATX_SUCCEEDED(ATX_Logger_AddHandler(tree, &handler)));
+
+    ATX_Logger_Log(leaf, ATX_LOG_LEVEL_INFO, __FILE__, __LINE__, "HierarchyTest", "leaf");
+    CHECK(ATX_AtomicInt_Get(&state.records) == 1);
+    ATX_Logger_Log(quiet, ATX_LOG_LEVEL_INFO, __FILE__, __LINE__, "HierarchyTest", "quiet");
+    CHECK(ATX_AtomicInt_Get(&state.records) == 1);
+    ATX_Logger_Log(tree, ATX_LOG_LEVEL_INFO, __FILE__, __LINE__, "HierarchyTest", "tree");
+    CHECK(ATX_AtomicInt_Get(&state.records) == 2);
+
+    /* loggers are found again by name */
+    for (i=0; i<REGISTRY_LOGGER_COUNT; i++) {
+        ATX_FormatStringN(name, sizeof(name), "atomix.test.tree.registry.%d", i);
+        CHECK(ATX_Log_GetLogger(name) != NULL);
+    }
+    for (i=0; i<REGISTRY_LOGGER_COUNT; i++) {
+        ATX_Logger* logger;
+        ATX_FormatStringN(name, sizeof(name), "atomix.test.tree.registry.%d", i);
+        logger = ATX_Log_GetLogger(name);
+        CHECK(logger != NULL);
+        CHECK(ATX_StringsEqual(ATX_CSTR(logger->name), name));
+        CHECK(logger->parent == tree);
+    }
+    CHECK(ATX_Log_GetLogger("atomix.test.tree.leaf") == leaf);
+}
+
+/*----------------------------------------------------------------------
+|  BinaryTest
++---------------------------------------------------------------------*/
+#define BINARY_EXPECT(_args) \
+    ATX_FormatStringN _args; ++BinaryRecordCount
+
+static void
+BinaryTest(void)
+{
+    char        long_string[600];
+    const char* null_string = NULL;
+    int         local;
+    
+    ATX_SetMemory(long_string, 'x', sizeof(long_string)-1);
+    long_string[sizeof(long_string)-1] = '\0';
+
+    ATX_LOG_INFO_L(BinaryLogger, "no arguments");
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "no arguments"));
+    ATX_LOG_INFO_L3(BinaryLogger, "ints %d %i %u", -5, 42, 4000000000U);
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "ints %d %i %u", -5, 42, 4000000000U));
+    ATX_LOG_WARNING_L4(BinaryLogger, "short %hd %hu %hhd %hhu", (short)-3, (unsigned short)65535, -1, 300);
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "short %hd %hu %hhd %hhu", (short)-3, (unsigned short)65535, -1, 300));
+    ATX_LOG_INFO_L4(BinaryLogger, "long %ld %lu %lld %llu", -123456789L, 123456789UL, (ATX_Int64)-1234567890123LL, (ATX_UInt64)1234567890123ULL);
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "long %ld %lu %lld %llu", -123456789L, 123456789UL, (ATX_Int64)-1234567890123LL, (ATX_UInt64)1234567890123ULL));
+    ATX_LOG_INFO_L2(BinaryLogger, "sizes %zu %td", (size_t)65536, (ptrdiff_t)-8);
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "sizes %zu %td", (size_t)65536, (ptrdiff_t)-8));
+    ATX_LOG_INFO_L4(BinaryLogger, "hex %x %08X %#o %-6d|", 0xbeef, 0xcafe, 8, 12);
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "hex %x %08X %#o %-6d|", 0xbeef, 0xcafe, 8, 12));
+    ATX_LOG_INFO_L4(BinaryLogger, "doubles %5.2f %e %g %Lf", 3.14159, 1e-10, 0.5, (long double)1.5);
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "doubles %5.2f %e %g %Lf", 3.14159, 1e-10, 0.5, (long double)1.5));
+    ATX_LOG_INFO_L4(BinaryLogger, "strings %s [%-8s] [%.3s] %c", "hello", "left", "truncated", 'z');
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "strings %s [%-8s] [%.3s] %c", "hello", "left", "truncated", 'z'));
+    ATX_LOG_INFO_L6(BinaryLogger, "stars [%*d] [%.*s] [%.*s] 100%%", 6, 42, 2, "abc", -1, "all");
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "stars [%*d] [%.*s] [%.*s] 100%%", 6, 42, 2, "abc", -1, "all"));
+    ATX_LOG_INFO_L1(BinaryLogger, "pointer %p", (void*)&local);
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "pointer %p", (void*)&local));
+    ATX_LOG_INFO_L1(BinaryLogger, "null %s", null_string);
+    ATX_CopyString(BinaryExpected[BinaryRecordCount++], "null (null)");
+
+    /* too large for the arguments buffer, the message is formatted */
+    ATX_LOG_INFO_L1(BinaryLogger, "long %s", long_string);
+    BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "long %s", long_string));
+
+    /* the same format more than once */
+    for (local=0; local<3; local++) {
+        ATX_LOG_FINE_L1(BinaryLogger, "repeat %d", local);
+        BINARY_EXPECT((BinaryExpected[BinaryRecordCount], BINARY_MESSAGE_SIZE, "repeat %d", local));
+    }
+}
+
+/*----------------------------------------------------------------------
+|  CheckBinaryRecords
+|
+|  Decodes the records written by BinaryTest, once the log file is 
+|  closed.
++---------------------------------------------------------------------*/
+static void
+CheckBinaryRecords(void)
+{
+    ATX_File*             file;
+    ATX_InputStream*      stream;
+    ATX_LogBinaryDecoder* decoder;
+    ATX_LogRecord         record;
+    int                   i;
+
+    CHECK(ATX_SUCCEEDED(ATX_File_Create("atomix-binary.log", &file)));
+    CHECK(ATX_SUCCEEDED(ATX_File_Open(file, ATX_FILE_OPEN_MODE_READ)));
+    CHECK(ATX_SUCCEEDED(ATX_File_GetInputStream(file, &stream)));
+    CHECK(ATX_SUCCEEDED(ATX_LogBinaryDecoder_Create(stream, &decoder)));
+    ATX_RELEASE_OBJECT(stream);
+    ATX_DESTROY_OBJECT(file);
+
+    for (i=0; i<BinaryRecordCount; i++) {
+        CHECK(ATX_SUCCEEDED(ATX_LogBinaryDecoder_ReadRecord(decoder, &record)));
+        if (!ATX_StringsEqual(record.message, BinaryExpected[i])) {
+            printf("record %d: got '%s', expected '%s'\n", i, record.message, BinaryExpected[i]);
+            CHECK(0);
+        }
+        CHECK(ATX_StringsEqual(record.logger_name, "atomix.test.binary"));
+        CHECK(ATX_StringsEqual(record.source_function, "BinaryTest"));
+        CHECK(record.source_line != 0);
+        CHECK(record.level == (i == 2 ? ATX_LOG_LEVEL_WARNING : 
+                               i >= BinaryRecordCount-3 ? ATX_LOG_LEVEL_FINE : 
+                               ATX_LOG_LEVEL_INFO));
+    }
+    CHECK(ATX_LogBinaryDecoder_ReadRecord(decoder, &record) == ATX_ERROR_EOS);
+    ATX_LogBinaryDecoder_Destroy(decoder);
+}
+
+/*----------------------------------------------------------------------
+|  DeferredTest
+|
+|  Logs binary records through an AsyncHandler, which queues their 
+|  format and arguments for a binary FileHandler.
++---------------------------------------------------------------------*/
+#define DEFERRED_EXPECT(_args) \
+    ATX_FormatStringN _args; ++DeferredRecordCount
+
+static void
+DeferredTest(void)
+{
+    char long_string[DEFERRED_MESSAGE_SIZE-6];
+    char format[16];
+    int  i;
+
+    ATX_SetMemory(long_string, 'y', sizeof(long_string)-1);
+    long_string[sizeof(long_string)-1] = '\0';
+
+    ATX_LOG_INFO_L3(DeferredLogger, "deferred %d %s %.1f", 1, "two", 3.0);
+    DEFERRED_EXPECT((DeferredExpected[DeferredRecordCount], DEFERRED_MESSAGE_SIZE, "deferred %d %s %.1f", 1, "two", 3.0));
+
+    /* too large for a slot with its format, the message is queued */
+    ATX_LOG_INFO_L1(DeferredLogger, "%s", long_string);
+    DEFERRED_EXPECT((DeferredExpected[DeferredRecordCount], DEFERRED_MESSAGE_SIZE, "%s", long_string));
+
+    /* a format that changes after the call */
+    for (i=0; i<3; i++) {
+        ATX_FormatStringN(format, sizeof(format), "format %d %%d", i);
+        ATX_LOG_INFO_L1(DeferredLogger, format, i*10);
+        DEFERRED_EXPECT((DeferredExpected[DeferredRecordCount], DEFERRED_MESSAGE_SIZE, format, i*10));
+        ATX_SetMemory(format, '%', sizeof(format)-1);
+    }
+
+    /* the same format more than once */
+    for (i=0; i<3; i++) {
+        ATX_LOG_INFO_L1(DeferredLogger, "repeat %d", i);
+        DEFERRED_EXPECT((DeferredExpected[DeferredRecordCount], DEFERRED_MESSAGE_SIZE, "repeat %d", i));
+    }
+}
+
+/*----------------------------------------------------------------------
+|  CheckDeferredRecords
+|
+|  Decodes the records written by DeferredTest, once the log file is 
+|  closed.
++---------------------------------------------------------------------*/
+static void
+CheckDeferredRecords(void)
+{
+    ATX_File*             file;
+    ATX_InputStream*      stream;
+    ATX_LogBinaryDecoder* decoder;
+    ATX_LogRecord         record;
+    int                   i;
+
+    CHECK(ATX_SUCCEEDED(ATX_File_Create("atomix-deferred.log", &file)));
+    CHECK(ATX_SUCCEEDED(ATX_File_Open(file, ATX_FILE_OPEN_MODE_READ)));
+    CHECK(ATX_SUCCEEDED(ATX_File_GetInputStream(file, &stream)));
+    CHECK(ATX_SUCCEEDED(ATX_LogBinaryDecoder_Create(stream, &decoder)));
+    ATX_RELEASE_OBJECT(stream);
+    ATX_DESTROY_OBJECT(file);
+
+    for (i=0; i<DeferredRecordCount; i++) {
+        CHECK(ATX_SUCCEEDED(ATX_LogBinaryDecoder_ReadRecord(decoder, &record)));
+        if (!ATX_StringsEqual(record.message, DeferredExpected[i])) {
+            printf("record %d: got '%s', expected '%s'\n", i, record.message, DeferredExpected[i]);
+            CHECK(0);
+        }
+        CHECK(ATX_StringsEqual(record.logger_name, "atomix.test.deferred"));
+        CHECK(ATX_StringsEqual(record.source_function, "DeferredTest"));
+        CHECK(record.level == ATX_LOG_LEVEL_INFO);
+    }
+    CHECK(ATX_LogBinaryDecoder_ReadRecord(decoder, &record) == ATX_ERROR_EOS);
+    ATX_LogBinaryDecoder_Destroy(decoder);
+}
+
+/*----------------------------------------------------------------------
+|  GetFileSize
++---------------------------------------------------------------------*/
+static ATX_Result
+GetFileSize(const char* name, ATX_LargeSize* size)
+{
+    ATX_File*  file;
+    ATX_Result result;
+
+    ATX_CHECK(ATX_File_Create(name, &file));
+    result = ATX_File_Open(file, ATX_FILE_OPEN_MODE_READ);
+    if (ATX_SUCCEEDED(result)) result = ATX_File_GetSize(file, size);
+    ATX_DESTROY_OBJECT(file);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------
+|  BufferedFileTest
++---------------------------------------------------------------------*/
+static void
+BufferedFileTest(void)
+{
+    ATX_LargeSize size = 0;
+    int           i;
+
+    /* the records stay in the handler until the buffer is full */
+    ATX_LOG_INFO_L(BufferedLogger, "first buffered record");
+    CHECK(ATX_SUCCEEDED(GetFileSize("atomix-buffered.log", &size)));
+    CHECK(size == 0);
+    for (i=0; size == 0 && i<1000; i++) {
+        ATX_LOG_INFO_L1(BufferedLogger, "buffered record %d", i);
+        CHECK(ATX_SUCCEEDED(GetFileSize("atomix-buffered.log", &size)));
+    }
+    CHECK(size >= 4096);
+    CHECK(i > 10);
+}
+
+/*----------------------------------------------------------------------
+|  FlushIntervalTest
+|
+|  A buffered record is written once it is due, with nothing logged
+|  after it.
++---------------------------------------------------------------------*/
+static void
+FlushIntervalTest(void)
+{
+    ATX_TimeInterval poll = {0, 10000000};
+    ATX_TimeStamp    start;
+    ATX_TimeStamp    now;
+    ATX_TimeStamp    elapsed;
+    ATX_LargeSize    size = 0;
+    int              i;
+
+    ATX_System_GetCurrentTimeStamp(&start);
+    ATX_LOG_INFO_L(IntervalLogger, "a single buffered record");
+    for (i=0; size == 0 && i<500; i++) {
+        ATX_System_Sleep(&poll);
+        CHECK(ATX_SUCCEEDED(GetFileSize("atomix-interval.log", &size)));
+    }
+    ATX_System_GetCurrentTimeStamp(&now);
+    ATX_TimeStamp_Sub(elapsed, now, start);
+    ATX_Debug("flush interval: record written after %d ms\n",
+              (int)(elapsed.seconds*1000+elapsed.nanoseconds/1000000));
+    CHECK(size != 0);
+    CHECK(elapsed.seconds*1000+elapsed.nanoseconds/1000000 >= FLUSH_INTERVAL);
+}
+
+/*----------------------------------------------------------------------
+|  RotatingFileTest
++---------------------------------------------------------------------*/
+static void
+RotatingFileTest(void)
+{
+    ATX_LargeSize size;
+    int           i;
+
+    for (i=0; i<ROTATING_RECORDS; i++) {
+        ATX_LOG_INFO_L1(RotatingLogger, "rotating record %d, with some padding to make it longer", i);
+    }
+
+    /* two backups (which are closed, so their size is final), just */
+    /* over max_size                                                 */
+    CHECK(ATX_SUCCEEDED(GetFileSize("atomix-rotating.log.1", &size)));
+    CHECK(size >= 2048 && size < 2048+512);
+    CHECK(ATX_SUCCEEDED(GetFileSize("atomix-rotating.log.2", &size)));
+    CHECK(size >= 2048 && size < 2048+512);
+    CHECK(GetFileSize("atomix-rotating.log.3", &size) == ATX_ERROR_NO_SUCH_FILE);
+}
+
+/*----------------------------------------------------------------------
+|  DeadHostTest
+|
+|  Nothing listens on port 1, the records must not wait for the host.
++---------------------------------------------------------------------*/
+static void
+DeadHostTest(void)
+{
+    ATX_TimeStamp start;
+    ATX_TimeStamp end;
+    ATX_TimeStamp elapsed;
+    int           i;
+
+    ATX_System_GetCurrentTimeStamp(&start);
+    for (i=0; i<DEAD_HOST_RECORDS; i++) {
+        ATX_LOG_INFO_L1(DeadHostLogger, "record %d for a dead host", i);
+    }
+    ATX_System_GetCurrentTimeStamp(&end);
+
+    ATX_TimeStamp_Sub(elapsed, end, start);
+    ATX_Debug("dead host: %d us for %d records\n",
+              (int)(elapsed.seconds*1000000+elapsed.nanoseconds/1000), DEAD_HOST_RECORDS);
+    CHECK(elapsed.seconds == 0);
+}
+
+/*----------------------------------------------------------------------
+|  CheckCompactFrame
++---------------------------------------------------------------------*/
+static void
+CheckCompactFrame(const ATX_Byte* frame, ATX_Size size, const char* expected)
+{
+    char line[256];
+
+    CHECK(size > 2 && size < sizeof(line));
+    ATX_CopyMemory(line, frame, size);
+    line[size] = '\0';
+    CHECK(ATX_StringsEqual(line+size-2, "\r\n"));
+    line[size-2] = '\0';
+    if (!ATX_StringsEqual(line+ATX_StringLength(line)-ATX_StringLength(expected), expected)) {
+        printf("got '%s', expected '%s'\n", line, expected);
+        CHECK(0);
+    }
+}
+
+/*----------------------------------------------------------------------
+|  TcpHandlerTest
+|
+|  Half of the records are logged before the collector listens, they
+|  wait in the queue until the handler reconnects.
++---------------------------------------------------------------------*/
+static void
+TcpHandlerTest(void)
+{
+    ATX_ServerSocket* server;
+    ATX_Socket*       client;
+    ATX_InputStream*  stream;
+    ATX_SocketAddress address;
+    char              expected[64];
+    int               i;
+
+    for (i=0; i<TCP_RECORDS/2; i++) {
+        ATX_LOG_INFO_L1(TcpLogger, "tcp record %d", i);
+    }
+
+    CHECK(ATX_SUCCEEDED(ATX_TcpServerSocket_Create(&server)));
+    CHECK(ATX_SUCCEEDED(ATX_IpAddress_Parse(&address.ip_address, "127.0.0.1")));
+    address.port = TCP_TEST_PORT;
+    if (ATX_FAILED(ATX_Socket_Bind(ATX_CAST(server, ATX_Socket), &address))) {
+        printf("port %d not available, skipping the TcpHandler test\n", TCP_TEST_PORT);
+        ATX_DESTROY_OBJECT(server);
+        return;
+    }
+    CHECK(ATX_SUCCEEDED(ATX_ServerSocket_Listen(server, 1)));
+
+    for (; i<TCP_RECORDS; i++) {
+        ATX_LOG_INFO_L1(TcpLogger, "tcp record %d", i);
+    }
+
+    CHECK(ATX_SUCCEEDED(ATX_ServerSocket_WaitForNewClient(server, &client)));
+    CHECK(ATX_SUCCEEDED(ATX_Socket_GetInputStream(client, &stream)));
+    for (i=0; i<TCP_RECORDS; i++) {
+        ATX_Byte frame[256];
+        ATX_Size size;
+
+        CHECK(ATX_SUCCEEDED(ATX_InputStream_ReadFully(stream, frame, 4)));
+        size = ATX_BytesToInt32Be(frame);
+        CHECK(size < sizeof(frame));
+        CHECK(ATX_SUCCEEDED(ATX_InputStream_ReadFully(stream, frame, size)));
+        ATX_FormatStringN(expected, sizeof(expected), "INFO: tcp record %d", i);
+        CheckCompactFrame(frame, size, expected);
+    }
+
+    ATX_RELEASE_OBJECT(stream);
+    ATX_DESTROY_OBJECT(client);
+    ATX_DESTROY_OBJECT(server);
+}
+
+/*----------------------------------------------------------------------
+|  UdpHandlerTest
+|
+|  The records queued while a datagram is sent go in the next one.
++---------------------------------------------------------------------*/
+static void
+UdpHandlerTest(void)
+{
+    ATX_DatagramSocket* receiver;
+    ATX_DataBuffer*     packet;
+    ATX_SocketAddress   address;
+    char                expected[64];
+    int                 datagrams = 0;
+    int                 i;
+
+    CHECK(ATX_SUCCEEDED(ATX_UdpSocket_Create(&receiver)));
+    CHECK(ATX_SUCCEEDED(ATX_IpAddress_Parse(&address.ip_address, "127.0.0.1")));
+    address.port = UDP_TEST_PORT;
+    if (ATX_FAILED(ATX_Socket_Bind(ATX_CAST(receiver, ATX_Socket), &address))) {
+        printf("port %d not available, skipping the UdpHandler test\n", UDP_TEST_PORT);
+        ATX_DESTROY_OBJECT(receiver);
+        return;
+    }
+    CHECK(ATX_SUCCEEDED(ATX_DataBuffer_Create(65536, &packet)));
+
+    for (i=0; i<UDP_RECORDS; i++) {
+        ATX_LOG_INFO_L1(UdpLogger, "udp record %d", i);
+    }
+
+    for (i=0; i<UDP_RECORDS; ) {
+        const ATX_Byte* data;
+        ATX_Size        offset = 0;
+
+        CHECK(ATX_SUCCEEDED(ATX_DatagramSocket_Receive(receiver, packet, &address)));
+        data = ATX_DataBuffer_GetData(packet);
+        ++datagrams;
+        while (offset < ATX_DataBuffer_GetDataSize(packet)) {
+            ATX_Size size = ATX_BytesToInt32Be(data+offset);
+            CHECK(offset+4+size <= ATX_DataBuffer_GetDataSize(packet));
+            ATX_FormatStringN(expected, sizeof(expected), "INFO: udp record %d", i++);
+            CheckCompactFrame(data+offset+4, size, expected);
+            offset += 4+size;
+        }
+    }
+    CHECK(i == UDP_RECORDS);
+    ATX_Debug("udp: %d records in %d datagrams\n", UDP_RECORDS, datagrams);
+
+    ATX_DataBuffer_Destroy(packet);
+    ATX_DESTROY_OBJECT(receiver);
+}
+
+/*----------------------------------------------------------------------
+|  TcpOverflowTest
+|
+|  Binary records are logged faster than they can wait for the host,
+|  so the queue overflows while the handler tries to connect. What the
+|  collector gets once it listens must still decode.
++---------------------------------------------------------------------*/
+static void
+TcpOverflowTest(void)
+{
+    ATX_ServerSocket*     server;
+    ATX_Socket*           client;
+    ATX_InputStream*      stream;
+    ATX_LogBinaryDecoder* decoder;
+    ATX_LogRecord         record;
+    ATX_SocketAddress     address;
+    ATX_TimeStamp         start;
+    ATX_TimeStamp         now;
+    ATX_TimeStamp         elapsed;
+    int                   last = -1;
+    int                   reports = 0;
+    int                   i = 0;
+
+    ATX_System_GetCurrentTimeStamp(&start);
+    do {
+        ATX_LOG_INFO_L1(OverflowLogger, "overflow record %d", i++);
+        ATX_System_GetCurrentTimeStamp(&now);
+        ATX_TimeStamp_Sub(elapsed, now, start);
+    } while (elapsed.seconds*1000+elapsed.nanoseconds/1000000 < OVERFLOW_DURATION);
+
+    CHECK(ATX_SUCCEEDED(ATX_TcpServerSocket_Create(&server)));
+    CHECK(ATX_SUCCEEDED(ATX_IpAddress_Parse(&address.ip_address, "127.0.0.1")));
+    address.port = OVERFLOW_TEST_PORT;
+    if (ATX_FAILED(ATX_Socket_Bind(ATX_CAST(server, ATX_Socket), &address))) {
+        printf("port %d not available, skipping the overflow test\n", OVERFLOW_TEST_PORT);
+        ATX_DESTROY_OBJECT(server);
+        return;
+    }
+    CHECK(ATX_SUCCEEDED(ATX_ServerSocket_Listen(server, 1)));
+
+    /* the queue was emptied when the handler started to connect */
+    CHECK(ATX_SUCCEEDED(ATX_ServerSocket_WaitForNewClient(server, &client)));
+    ATX_LOG_INFO_L(OverflowLogger, "overflow done");
+
+    CHECK(ATX_SUCCEEDED(ATX_Socket_GetInputStream(client, &stream)));
+    CHECK(ATX_SUCCEEDED(ATX_LogBinaryDecoder_Create(stream, &decoder)));
+    ATX_RELEASE_OBJECT(stream);
+    for (;;) {
+        int number;
+
+        CHECK(ATX_SUCCEEDED(ATX_LogBinaryDecoder_ReadRecord(decoder, &record)));
+        CHECK(ATX_StringsEqual(record.logger_name, "atomix.test.overflow"));
+        CHECK(ATX_StringsEqual(record.source_function, "TcpOverflowTest") ||
+              ATX_StringsEqual(record.source_function, "ATX_LogSender_Queue"));
+        if (ATX_StringsEqual(record.message, "overflow done")) break;
+        if (sscanf(record.message, "overflow record %d", &number) == 1) {
+            CHECK(number > last && number < i);
+            last = number;
+        } else {
+            CHECK(ATX_StringsEqual(record.message+ATX_StringLength(record.message)-19,
+                                   "log records dropped"));
+            ++reports;
+        }
+    }
+    ATX_Debug("overflow: %d records logged, %d dropped reports\n", i, reports);
+    CHECK(reports > 0);
+
+    ATX_LogBinaryDecoder_Destroy(decoder);
+    ATX_DESTROY_OBJECT(client);
+    ATX_DESTROY_OBJECT(server);
+}
+
+/*----------------------------------------------------------------------
+|  RunCallCostBenchmark
+|
+|  Logs batches of records, with a pause after each one for the threads 
+|  of the handlers to catch up. The fastest batch shows the cost of a 
+|  call for the caller, without the time that these threads may take
+|  from it.
++---------------------------------------------------------------------*/
+static void
+RunCallCostBenchmark(const char* name, ATX_LoggerReference* logger)
+{
+    ATX_TimeInterval pause = {0, 2000000};
+    ATX_TimeStamp    start;
+    ATX_TimeStamp    end;
+    ATX_TimeStamp    elapsed;
+    double           seconds;
+    double           total = 0.0;
+    double           best = 0.0;
+    int              batch;
+    int              i;
+
+    /* resolve the logger outside of the measurement */
+    ATX_LOG_INFO_L1(*logger, "starting %s benchmark", name);
+
+    for (batch=0; batch<CALL_COST_RECORDS/CALL_COST_BATCH; batch++) {
+        ATX_System_GetCurrentTimeStamp(&start);
+        for (i=0; i<CALL_COST_BATCH; i++) {
+            ATX_LOG_INFO_L3(*logger, "benchmark record %d of %d (%s)", i, CALL_COST_BATCH, name);
+        }
+        ATX_System_GetCurrentTimeStamp(&end);
+
+        ATX_TimeStamp_Sub(elapsed, end, start);
+        seconds = (double)elapsed.seconds+(double)elapsed.nanoseconds/1000000000.0;
+        total += seconds;
+        if (batch == 0 || seconds < best) best = seconds;
+        ATX_System_Sleep(&pause);
+    }
+    ATX_Debug("%s: %d ns per record (%d ns in the fastest batch)\n", 
+              name, 
+              (int)(total*1000000000.0/CALL_COST_RECORDS),
+              (int)(best*1000000000.0/CALL_COST_BATCH));
+}
+
+/*----------------------------------------------------------------------
+|  WriteConfigFile
+|
+|  A line too long to be parsed, followed by the config of the logger
+|  that the log manager reports it to.
++---------------------------------------------------------------------*/
+static void
+WriteConfigFile(void)
+{
+    ATX_File*         file;
+    ATX_OutputStream* output;
+    int               i;
+
+    CHECK(ATX_SUCCEEDED(ATX_File_Create("atomix-logging.properties", &file)));
+    CHECK(ATX_SUCCEEDED(ATX_File_Open(file, ATX_FILE_OPEN_MODE_WRITE  | 
+                                            ATX_FILE_OPEN_MODE_CREATE | 
+                                            ATX_FILE_OPEN_MODE_TRUNCATE)));
+    CHECK(ATX_SUCCEEDED(ATX_File_GetOutputStream(file, &output)));
+    CHECK(ATX_SUCCEEDED(ATX_OutputStream_WriteString(output, "atomix.test.config.padding=")));
+    for (i=0; i<1000; i++) {
+        CHECK(ATX_SUCCEEDED(ATX_OutputStream_WriteString(output, "long ")));
+    }
+    CHECK(ATX_SUCCEEDED(ATX_OutputStream_WriteString(output, 
+        "\n"
+        "atomix.logging.level=ALL\n"
+        "atomix.logging.forward=false\n"
+        "atomix.logging.handlers=FileHandler\n"
+        "atomix.logging.FileHandler.filename=atomix-config.log\n"
+        "atomix.logging.FileHandler.append=false\n")));
+    ATX_RELEASE_OBJECT(output);
+    ATX_DESTROY_OBJECT(file);
+}
+
+/*----------------------------------------------------------------------
+|  ConfigFileTest
++---------------------------------------------------------------------*/
+static void
+ConfigFileTest(void)
+{
+    ATX_DataBuffer* data;
+    char*           text;
+
+    CHECK(ATX_SUCCEEDED(ATX_DataBuffer_Create(0, &data)));
+    CHECK(ATX_SUCCEEDED(ATX_LoadFile("atomix-config.log", &data)));
+    text = (char*)ATX_AllocateZeroMemory(ATX_DataBuffer_GetDataSize(data)+1);
+    CHECK(text != NULL);
+    ATX_CopyMemory(text, ATX_DataBuffer_GetData(data), ATX_DataBuffer_GetDataSize(data));
+    CHECK(strstr(text, "1 config lines longer than 4096 characters were skipped") != NULL);
+    ATX_FreeMemory(text);
+    ATX_DataBuffer_Destroy(data);
+}
+
 /*----------------------------------------------------------------------
 |  main
 +---------------------------------------------------------------------*/
@@ -169,6 +1115,10 @@ main(int argc, char** argv)
     ATX_COMPILER_UNUSED(argc);
     ATX_COMPILER_UNUSED(argv);
     
+    /* this must be done before anything is logged */
+    WriteConfigFile();
+    putenv(LogConfig);
+
     ATX_LOG_L(MyLogger, ATX_LOG_LEVEL_WARNING, "blabla");
     ATX_LOG_L2(MyLogger, ATX_LOG_LEVEL_WARNING, "blabla %d %d", 8, 9);
     ATX_LOG(ATX_LOG_LEVEL_WARNING, "blabla");
@@ -226,6 +1176,35 @@ main(int argc, char** argv)
     TestCheckFinerL();
     TestCheckFinestL();
 
+    DispatchTest();
+    HierarchyTest();
+
+    /* compare the time spent by callers with synchronous and async handlers */
+    RunBenchmark("sync FileHandler", &BenchSyncLogger);
+    RunBenchmark("AsyncHandler+FileHandler", &BenchAsyncLogger);
+
+    /* compare the cost of a call with text and binary records */
+    RunCallCostBenchmark("text FileHandler", &BenchTextLogger);
+    RunCallCostBenchmark("binary FileHandler", &BenchBinaryLogger);
+    RunCallCostBenchmark("buffered FileHandler", &BenchBufferedLogger);
+    RunCallCostBenchmark("AsyncHandler+binary FileHandler", &BenchDeferredLogger);
+
+    BinaryTest();
+    DeferredTest();
+    BufferedFileTest();
+    FlushIntervalTest();
+    RotatingFileTest();
+    DeadHostTest();
+    TcpHandlerTest();
+    UdpHandlerTest();
+    TcpOverflowTest();
+
+    /* close the log files before decoding */
+    ATX_LogManager_Terminate();
+    CheckBinaryRecords();
+    CheckDeferredRecords();
+    ConfigFileTest();
+
     return 0;
 }
 
@@ -33,6 +33,8 @@
 |       includes
 +---------------------------------------------------------------------*/
 #include "Atomix.h"
+#include <stdio.h>
+#include <stdlib.h>
 
 /*----------------------------------------------------------------------
 |       macros
@@ -77,6 +79,48 @@
         }                                                              \
     } while(0)                                  
 
+/*----------------------------------------------------------------------
+|       constants
++---------------------------------------------------------------------*/
+#define COPY_TEST_SIZE      300000
+#define COPY_TEST_FILE_NAME "MiscTest-copy.tmp"
+
+/*----------------------------------------------------------------------
+|       types
++---------------------------------------------------------------------*/
+typedef struct {
+    ATX_InputStream* input;
+    ATX_Byte*        data;
+    ATX_Size         size;
+} CopyTestReceiver;
+
+/*----------------------------------------------------------------------
+|       CopyTestPattern
++---------------------------------------------------------------------*/
+static ATX_Byte
+CopyTestPattern(ATX_Size offset)
+{
+    return (ATX_Byte)(offset*7+offset/251);
+}
+
+/*----------------------------------------------------------------------
+|       CopyTestReceive
++---------------------------------------------------------------------*/
+static void
+CopyTestReceive(void* arg)
+{
+    CopyTestReceiver* receiver = (CopyTestReceiver*)arg;
+    for (;;) {
+        ATX_Size bytes_read = 0;
+        ATX_Result result = ATX_InputStream_Read(receiver->input, 
+                                                 receiver->data+receiver->size, 
+                                                 2*COPY_TEST_SIZE-receiver->size, 
+                                                 &bytes_read);
+        if (ATX_FAILED(result)) break;
+        receiver->size += bytes_read;
+    }
+}
+
 /*----------------------------------------------------------------------
 |       main
 +---------------------------------------------------------------------*/
@@ -222,6 +266,174 @@ main(int argc, char** argv)
         SHOULD_EQUAL_I(ip.ip[3],0);
     }
 
+    /* buffered input streams */
+    {
+        const char               text[] = "GET / HTTP/1.1\r\nHost: a\r\n\r\nbody-bytes\nlast";
+        ATX_MemoryStream*        memory;
+        ATX_InputStream*         source;
+        ATX_BufferedInputStream* buffered;
+        ATX_InputStream*         stream;
+        ATX_String               line = ATX_EMPTY_STRING;
+        ATX_Position             position;
+        ATX_Size                 bytes_read;
+        char                     peeked[1];
+
+        SHOULD_SUCCEED(ATX_MemoryStream_Create(0, &memory));
+        SHOULD_SUCCEED(ATX_MemoryStream_GetOutputStream(memory, (ATX_OutputStream**)&source));
+        SHOULD_SUCCEED(ATX_OutputStream_WriteString((ATX_OutputStream*)source, text));
+        ATX_RELEASE_OBJECT(source);
+        SHOULD_SUCCEED(ATX_MemoryStream_GetInputStream(memory, &source));
+
+        /* use a tiny buffer so that lines span several refills */
+        SHOULD_SUCCEED(ATX_BufferedInputStream_Create(source, 5, &buffered));
+        SHOULD_SUCCEED(ATX_BufferedInputStream_GetInputStream(buffered, &stream));
+
+        SHOULD_SUCCEED(ATX_InputStream_ReadLine(stream, buff, sizeof(buff), &bytes_read));
+        SHOULD_EQUAL_S(buff, "GET / HTTP/1.1");
+        SHOULD_EQUAL_I(bytes_read, 14);
+        SHOULD_SUCCEED(ATX_InputStream_ReadLine(stream, buff, 5, &bytes_read));
+        SHOULD_EQUAL_S(buff, "Host");
+        SHOULD_SUCCEED(ATX_InputStream_ReadLine(stream, buff, sizeof(buff), NULL));
+        SHOULD_EQUAL_S(buff, ": a");
+        SHOULD_SUCCEED(ATX_InputStream_ReadLine(stream, buff, sizeof(buff), NULL));
+        SHOULD_EQUAL_S(buff, "");
+        SHOULD_SUCCEED(ATX_InputStream_Tell(stream, &position));
+        SHOULD_EQUAL_I(position, 27);
+
+        /* peek and unread don't move the data */
+        SHOULD_SUCCEED(ATX_BufferedInputStream_Peek(buffered, peeked, 1, &bytes_read));
+        SHOULD_EQUAL_I(bytes_read, 1);
+        SHOULD_EQUAL_I(peeked[0], 'b');
+        SHOULD_SUCCEED(ATX_InputStream_ReadFully(stream, buff, 4));
+        SHOULD_SUCCEED(ATX_BufferedInputStream_Unread(buffered, "xbody", 5));
+        SHOULD_SUCCEED(ATX_InputStream_ReadLineString(stream, &line, 64));
+        SHOULD_EQUAL_S(ATX_CSTR(line), "xbody-bytes");
+
+        SHOULD_SUCCEED(ATX_BufferedInputStream_ReadLineString(buffered, &line, 64));
+        SHOULD_EQUAL_S(ATX_CSTR(line), "last");
+        SHOULD_FAIL(ATX_InputStream_ReadLine(stream, buff, sizeof(buff), NULL));
+
+        /* seeking back re-reads from the source */
+        SHOULD_SUCCEED(ATX_InputStream_Seek(stream, 4));
+        SHOULD_SUCCEED(ATX_InputStream_ReadFully(stream, buff, 10));
+        SHOULD_EQUAL_I(ATX_MemoryEqual(buff, "/ HTTP/1.1", 10), 1);
+
+        ATX_String_Destruct(&line);
+        ATX_RELEASE_OBJECT(stream);
+        ATX_BufferedInputStream_Destroy(buffered);
+        ATX_RELEASE_OBJECT(source);
+        ATX_MemoryStream_Destroy(memory);
+    }
+
+    /* stream copy through a buffer */
+    {
+        ATX_MemoryStream* from;
+        ATX_MemoryStream* to;
+        ATX_InputStream*  input;
+        ATX_OutputStream* output;
+        ATX_DataBuffer*   data;
+        ATX_LargeSize     copied = 0;
+        ATX_Size          x;
+
+        SHOULD_SUCCEED(ATX_DataBuffer_Create(COPY_TEST_SIZE, &data));
+        for (x=0; x<COPY_TEST_SIZE; x++) {
+            ATX_DataBuffer_UseData(data)[x] = CopyTestPattern(x);
+        }
+        SHOULD_SUCCEED(ATX_DataBuffer_SetDataSize(data, COPY_TEST_SIZE));
+        SHOULD_SUCCEED(ATX_MemoryStream_CreateFromBuffer(ATX_DataBuffer_UseData(data), COPY_TEST_SIZE, &from));
+        SHOULD_SUCCEED(ATX_MemoryStream_Create(0, &to));
+        SHOULD_SUCCEED(ATX_MemoryStream_GetInputStream(from, &input));
+        SHOULD_SUCCEED(ATX_MemoryStream_GetOutputStream(to, &output));
+
+        SHOULD_SUCCEED(ATX_Stream_Copy(input, output, 1000, &copied));
+        SHOULD_EQUAL_I(copied, 1000);
+        SHOULD_SUCCEED(ATX_Stream_Copy(input, output, 0, &copied));
+        SHOULD_EQUAL_I(copied, COPY_TEST_SIZE-1000);
+        SHOULD_SUCCEED(ATX_Stream_Copy(input, output, 0, &copied));
+        SHOULD_EQUAL_I(copied, 0);
+        {
+            const ATX_DataBuffer* result;
+            SHOULD_SUCCEED(ATX_MemoryStream_GetBuffer(to, &result));
+            SHOULD_EQUAL_I(ATX_DataBuffer_Equals(result, data), ATX_TRUE);
+        }
+
+        ATX_RELEASE_OBJECT(input);
+        ATX_RELEASE_OBJECT(output);
+        ATX_MemoryStream_Destroy(from);
+        ATX_MemoryStream_Destroy(to);
+
+        /* stream copy from a file to a socket, which can skip the buffer */
+        {
+            ATX_ServerSocket* server;
+            ATX_Socket*       client;
+            ATX_Socket*       peer;
+            ATX_SocketAddress address;
+            ATX_SocketInfo    info;
+            ATX_IpAddress     loopback;
+            ATX_File*         file;
+            ATX_Thread*       thread;
+            CopyTestReceiver  receiver;
+            ATX_Position      position;
+            ATX_Byte          next;
+
+            SHOULD_SUCCEED(ATX_SaveFile(COPY_TEST_FILE_NAME, data));
+            SHOULD_SUCCEED(ATX_File_Create(COPY_TEST_FILE_NAME, &file));
+            SHOULD_SUCCEED(ATX_File_Open(file, ATX_FILE_OPEN_MODE_READ));
+            SHOULD_SUCCEED(ATX_File_GetInputStream(file, &input));
+
+            ATX_IpAddress_SetFromLong(&loopback, 0x7F000001);
+            ATX_SocketAddress_Set(&address, &loopback, 0);
+            SHOULD_SUCCEED(ATX_TcpServerSocket_Create(&server));
+            SHOULD_SUCCEED(ATX_Socket_Bind(ATX_CAST(server, ATX_Socket), &address));
+            SHOULD_SUCCEED(ATX_ServerSocket_Listen(server, 1));
+            SHOULD_SUCCEED(ATX_Socket_GetInfo(ATX_CAST(server, ATX_Socket), &info));
+            SHOULD_SUCCEED(ATX_TcpClientSocket_Create(&client));
+            SHOULD_SUCCEED(ATX_Socket_Connect(client, &info.local_address, 1000));
+            SHOULD_SUCCEED(ATX_ServerSocket_WaitForNewClient(server, &peer));
+            SHOULD_SUCCEED(ATX_Socket_GetOutputStream(client, &output));
+
+            receiver.data = (ATX_Byte*)malloc(2*COPY_TEST_SIZE);
+            receiver.size = 0;
+            SHOULD_SUCCEED(ATX_Socket_GetInputStream(peer, &receiver.input));
+            SHOULD_SUCCEED(ATX_Thread_Create(CopyTestReceive, &receiver, &thread));
+
+            /* a buffered read first, so the file and stdio positions differ */
+            SHOULD_SUCCEED(ATX_InputStream_ReadFully(input, buff, 10));
+            SHOULD_SUCCEED(ATX_Stream_Copy(input, output, 5000, &copied));
+            SHOULD_EQUAL_I(copied, 5000);
+            SHOULD_SUCCEED(ATX_InputStream_Tell(input, &position));
+            SHOULD_EQUAL_I(position, 5010);
+            SHOULD_SUCCEED(ATX_InputStream_ReadFully(input, &next, 1));
+            SHOULD_EQUAL_I(next, CopyTestPattern(5010));
+            SHOULD_SUCCEED(ATX_InputStream_Seek(input, 0));
+            SHOULD_SUCCEED(ATX_Stream_Copy(input, output, 0, &copied));
+            SHOULD_EQUAL_I(copied, COPY_TEST_SIZE);
+
+            /* closing the client ends the receiver */
+            ATX_RELEASE_OBJECT(output);
+            ATX_DESTROY_OBJECT(client);
+            SHOULD_SUCCEED(ATX_Thread_Join(thread));
+            SHOULD_EQUAL_I(receiver.size, 5000+COPY_TEST_SIZE);
+            for (x=0; x<receiver.size; x++) {
+                ATX_Size offset = x < 5000 ? x+10 : x-5000;
+                if (receiver.data[x] != CopyTestPattern(offset)) {
+                    ATX_Debug("bad byte at %d\n", (int)x);
+                    exit(1);
+                }
+            }
+
+            free(receiver.data);
+            ATX_RELEASE_OBJECT(receiver.input);
+            ATX_DESTROY_OBJECT(peer);
+            ATX_DESTROY_OBJECT(server);
+            ATX_RELEASE_OBJECT(input);
+            ATX_DESTROY_OBJECT(file);
+            remove(COPY_TEST_FILE_NAME);
+        }
+
+        ATX_DataBuffer_Destroy(data);
+    }
+
     return 0;
 }
 
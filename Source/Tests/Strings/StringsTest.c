@@ -36,8 +36,10 @@
 #include <stdio.h>
 #include <string.h>
 #include "AtxString.h"
+#include "AtxAllocator.h"
 #include "AtxDebug.h"
 #include "AtxUtils.h"
+#include "AtxResults.h"
 
 /*----------------------------------------------------------------------
 |       Fail
@@ -49,6 +51,17 @@ Fail()
     exit(1);
 }
 
+/*----------------------------------------------------------------------
+|       CHECK
++---------------------------------------------------------------------*/
+#define CHECK(_x)                                           \
+    do {                                                    \
+        if (!(_x)) {                                        \
+            printf("check failed line %d: %s\n", __LINE__, #_x); \
+            Fail();                                         \
+        }                                                   \
+    } while (0)
+
 /*----------------------------------------------------------------------
 |       CompareTest
 +---------------------------------------------------------------------*/
@@ -106,6 +119,79 @@ IntTest(const char* name, int a, int expected)
     if (a != expected) Fail();
 }
 
+/*----------------------------------------------------------------------
+|       CountingAllocator
+|
+|       counts the calls that go to the default allocator
++---------------------------------------------------------------------*/
+static unsigned int AllocationCount = 0;
+static unsigned int FreeCount       = 0;
+
+static void*
+CountingAllocator_Allocate(void* context, ATX_Size size)
+{
+    ATX_COMPILER_UNUSED(context);
+    ++AllocationCount;
+    return ATX_Allocator_Allocate(ATX_GetDefaultAllocator(), size);
+}
+
+static void*
+CountingAllocator_Reallocate(void* context, void* memory, ATX_Size size)
+{
+    ATX_COMPILER_UNUSED(context);
+    ++AllocationCount;
+    return ATX_Allocator_Reallocate(ATX_GetDefaultAllocator(), memory, size);
+}
+
+static void
+CountingAllocator_Free(void* context, void* memory)
+{
+    ATX_COMPILER_UNUSED(context);
+    if (memory) ++FreeCount;
+    ATX_Allocator_Free(ATX_GetDefaultAllocator(), memory);
+}
+
+static const ATX_Allocator CountingAllocator = {
+    CountingAllocator_Allocate,
+    CountingAllocator_Reallocate,
+    CountingAllocator_Free,
+    NULL
+};
+
+/*----------------------------------------------------------------------
+|       CountAllocations
+|
+|       builds one string per entry of a NULL-terminated list and returns
+|       the number of calls made to the allocator (without inline 
+|       storage, every non-empty string needs at least one)
++---------------------------------------------------------------------*/
+static unsigned int
+CountAllocations(const char* const* workload, unsigned int* string_count)
+{
+    ATX_String   strings[64];
+    unsigned int allocations;
+    unsigned int count;
+    unsigned int i;
+
+    CHECK(ATX_SetAllocator(&CountingAllocator) == ATX_SUCCESS);
+    AllocationCount = 0;
+    FreeCount       = 0;
+    for (count=0; workload[count] && count < 64; count++) {
+        ATX_String_Construct(&strings[count]);
+        CHECK(ATX_String_Assign(&strings[count], workload[count]) == ATX_SUCCESS);
+    }
+    allocations = AllocationCount;
+    for (i=0; i<count; i++) {
+        CHECK(strcmp(ATX_CSTR(strings[i]), workload[i]) == 0);
+        ATX_String_Destruct(&strings[i]);
+    }
+    CHECK(FreeCount == allocations);
+    CHECK(ATX_SetAllocator(NULL) == ATX_SUCCESS);
+    *string_count = count;
+
+    return allocations;
+}
+
 /*----------------------------------------------------------------------
 |       main
 +---------------------------------------------------------------------*/
@@ -119,7 +205,8 @@ main(int argc, char** argv)
 
     {
         ATX_String s = ATX_EMPTY_STRING;
-        ATX_ASSERT(sizeof(ATX_String) == sizeof(void*));
+        CHECK(sizeof(ATX_String) <= 32);
+        CHECK(ATX_String_IsInline(&s));
         ATX_ASSERT(ATX_String_GetChars(&s)[0] == '\0');
         ATX_String_Destruct(&s);
     }
@@ -390,5 +477,137 @@ main(int argc, char** argv)
         ATX_String_Destruct(&in0);
     }
 
+    printf(":: testing inline storage\n");
+    {
+        ATX_String s0 = ATX_String_Create("0123456789012345678901");
+        ATX_String s1;
+        CHECK(ATX_String_IsInline(&s0));
+        IntTest("inline length", ATX_String_GetLength(&s0), ATX_STRING_INLINE_CAPACITY);
+
+        /* a struct copy carries the characters with it */
+        s1 = s0;
+        StringTest("struct copy", s1, "0123456789012345678901");
+
+        /* growing past the inline capacity moves to the heap */
+        ATX_String_AppendChar(&s0, 'x');
+        CHECK(!ATX_String_IsInline(&s0));
+        StringTest("append past inline capacity", s0, "0123456789012345678901x");
+        IntTest("heap length", ATX_String_GetLength(&s0), ATX_STRING_INLINE_CAPACITY+1);
+        ATX_String_Destruct(&s0);
+        CHECK(ATX_String_IsInline(&s0));
+        CHECK(ATX_String_IsEmpty(&s0));
+
+        /* in-place operations on inline strings */
+        ATX_String_TrimChar(&s1, '0');
+        StringTest("trim inline", s1, "123456789012345678901");
+        IntTest("trimmed length", ATX_String_GetLength(&s1), 21);
+        ATX_String_SetLength(&s1, 3);
+        StringTest("set inline length", s1, "123");
+        ATX_String_SetChar(&s1, 1, 'X');
+        StringTest("set inline char", s1, "1X3");
+        CHECK(ATX_String_GetChar(&s1, 2) == '3');
+        ATX_String_Copy(&s0, &s1);
+        StringTest("copy inline", s0, "1X3");
+        ATX_String_Destruct(&s0);
+        ATX_String_Destruct(&s1);
+    }
+
+    printf(":: testing allocation count\n");
+    {
+        static const char* const headers[] = {
+            "Host", "www.example.com",
+            "User-Agent", "Atomix/1.0",
+            "Accept", "*/*",
+            "Accept-Encoding", "gzip, deflate",
+            "Connection", "keep-alive",
+            "Content-Type", "application/json; charset=utf-8",
+            "Content-Length", "1432",
+            "Cache-Control", "no-cache",
+            "Date", "Sun, 18 Oct 2026 10:12:45 GMT",
+            NULL
+        };
+        static const char* const members[] = {
+            "id", "name", "type", "level", "logger", "message", "timestamp",
+            "thread", "sequence", "source", "file", "line", "enabled", "handlers",
+            "config.session.1024", "org.example.network.http",
+            NULL
+        };
+        unsigned int count;
+        unsigned int allocations;
+
+        allocations = CountAllocations(headers, &count);
+        printf("headers: %d strings, %d allocations (%d without inline storage)\n",
+               count, allocations, count);
+        CHECK(allocations == 2);
+
+        allocations = CountAllocations(members, &count);
+        printf("json members: %d strings, %d allocations (%d without inline storage)\n",
+               count, allocations, count);
+        CHECK(allocations == 1);
+    }
+
+    printf(":: testing string builder\n");
+    {
+        ATX_StringBuilder b = ATX_EMPTY_STRING_BUILDER;
+        ATX_String        s = ATX_EMPTY_STRING;
+        const char*       chars;
+        unsigned int      i;
+        ATX_Result        result;
+
+        CHECK(ATX_StringBuilder_GetLength(&b) == 0);
+        CHECK(ATX_StringBuilder_GetChars(&b)[0] == '\0');
+
+        result = ATX_StringBuilder_Append(&b, "Host");
+        CHECK(ATX_SUCCEEDED(result));
+        result = ATX_StringBuilder_AppendChar(&b, ':');
+        CHECK(ATX_SUCCEEDED(result));
+        result = ATX_StringBuilder_AppendSubString(&b, " example.com/x", 12);
+        CHECK(ATX_SUCCEEDED(result));
+        CHECK(strcmp(ATX_StringBuilder_GetChars(&b), "Host: example.com") == 0);
+        CHECK(ATX_StringBuilder_GetLength(&b) == 17);
+
+        /* grow past the minimum capacity */
+        for (i=0; i<100; i++) {
+            result = ATX_StringBuilder_AppendFormat(&b, "[%03u]", i);
+            CHECK(ATX_SUCCEEDED(result));
+        }
+        CHECK(ATX_StringBuilder_GetLength(&b) == 17+100*5);
+        CHECK(strncmp(ATX_StringBuilder_GetChars(&b)+17, "[000][001]", 10) == 0);
+        CHECK(strcmp(ATX_StringBuilder_GetChars(&b)+17+99*5, "[099]") == 0);
+
+        /* a single format larger than the remaining space */
+        ATX_StringBuilder_Reset(&b);
+        CHECK(ATX_StringBuilder_GetLength(&b) == 0);
+        result = ATX_StringBuilder_AppendFormat(&b, "%s=%0600d;", "key", 7);
+        CHECK(ATX_SUCCEEDED(result));
+        CHECK(ATX_StringBuilder_GetLength(&b) == 4+600+1);
+        CHECK(strncmp(ATX_StringBuilder_GetChars(&b), "key=000", 7) == 0);
+        CHECK(strcmp(ATX_StringBuilder_GetChars(&b)+603, "7;") == 0);
+
+        /* detach into a string without copying */
+        chars = ATX_StringBuilder_GetChars(&b);
+        ATX_StringBuilder_Detach(&b, &s);
+        CHECK(ATX_String_GetChars(&s) == chars);
+        CHECK(ATX_String_GetLength(&s) == 605);
+        CHECK(ATX_StringBuilder_GetLength(&b) == 0);
+        CHECK(ATX_StringBuilder_GetChars(&b)[0] == '\0');
+        result = ATX_String_Append(&s, "!");
+        CHECK(ATX_SUCCEEDED(result));
+        CHECK(ATX_String_GetLength(&s) == 606);
+
+        /* reuse after detach */
+        result = ATX_StringBuilder_AppendFormat(&b, "%d-%s", 42, "x");
+        CHECK(ATX_SUCCEEDED(result));
+        CHECK(strcmp(ATX_StringBuilder_GetChars(&b), "42-x") == 0);
+
+        /* detaching an empty builder yields an empty string */
+        ATX_StringBuilder_Destruct(&b);
+        ATX_StringBuilder_Detach(&b, &s);
+        CHECK(ATX_String_IsEmpty(&s));
+
+        ATX_String_Destruct(&s);
+        ATX_StringBuilder_Destruct(&b);
+    }
+
     return 0;
 }
@@ -0,0 +1,355 @@
+/*****************************************************************
+|
+|      Threads Test Program 1
+|
+| Copyright (c) 2002-2010, Axiomatic Systems, LLC.
+| All rights reserved.
+|
+| Redistribution and use in source and binary forms, with or without
+| modification, are permitted provided that the following conditions are met:
+|     * Redistributions of source code must retain the above copyright
+|       notice, this list of conditions and the following disclaimer.
+|     * Redistributions in binary form must reproduce the above copyright
+|       notice, this list of conditions and the following disclaimer in the
+|       documentation and/or other materials provided with the distribution.
+|     * Neither the name of Axiomatic Systems nor the
+|       names of its contributors may be used to endorse or promote products
+|       derived from this software without specific prior written permission.
+|
+| THIS SOFTWARE IS PROVIDED BY AXIOMATIC SYSTEMS ''AS IS'' AND ANY
+| EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+| WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+| DISCLAIMED. IN NO EVENT SHALL AXIOMATIC SYSTEMS BE LIABLE FOR ANY
+| DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+| (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+| LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+| ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+| (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+| SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+|
+ ****************************************************************/
+
+
+/*----------------------------------------------------------------------
+|       includes
++---------------------------------------------------------------------*/
+#include "Atomix.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+/*----------------------------------------------------------------------
+|       macros
++---------------------------------------------------------------------*/
+#define SHOULD_SUCCEED(r)                                   \
+    do {                                                    \
+        ATX_Result x = r;                                   \
+        if (ATX_FAILED(x)) {                                \
+            printf("failed line %d (%d)\n", __LINE__, x);   \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)                                         
+
+#define CHECK(x)                                            \
+    do {                                                    \
+        if (!(x)) {                                         \
+            printf("check failed line %d\n", __LINE__);     \
+            exit(1);                                        \
+        }                                                   \
+    } while(0)                                         
+
+/*----------------------------------------------------------------------
+|       constants
++---------------------------------------------------------------------*/
+#define THREAD_COUNT     8
+#define ITERATIONS       100000
+#define PRODUCED_ITEMS   10000
+#define QUEUE_SIZE       64
+
+/*----------------------------------------------------------------------
+|       types
++---------------------------------------------------------------------*/
+typedef struct StackNode {
+    struct StackNode* next;
+    unsigned int      value;
+} StackNode;
+
+typedef struct {
+    ATX_AtomicInt     atomic_counter;
+    ATX_Mutex*        mutex;
+    unsigned int      mutex_counter;
+    ATX_AtomicPointer stack;
+    StackNode*        nodes;
+    ATX_ThreadLocal*  local;
+    ATX_AtomicInt     local_errors;
+} SharedState;
+
+typedef struct {
+    SharedState* shared;
+    unsigned int index;
+} WorkerArg;
+
+typedef struct {
+    ATX_Semaphore* items;
+    ATX_Semaphore* slots;
+    ATX_Mutex*     mutex;
+    unsigned int   queue[QUEUE_SIZE];
+    unsigned int   head;
+    unsigned int   tail;
+    ATX_UInt64     sum;
+} BoundedQueue;
+
+/*----------------------------------------------------------------------
+|       Worker
++---------------------------------------------------------------------*/
+static void
+Worker(void* arg)
+{
+    WorkerArg*   worker = (WorkerArg*)arg;
+    SharedState* shared = worker->shared;
+    unsigned int i;
+
+    ATX_ThreadLocal_Set(shared->local, worker);
+
+    for (i=0; i<ITERATIONS; i++) {
+        ATX_AtomicInt_Add(&shared->atomic_counter, 1);
+
+        ATX_Mutex_Lock(shared->mutex);
+        ++shared->mutex_counter;
+        ATX_Mutex_Unlock(shared->mutex);
+
+        /* another thread must never see our thread-local value */
+        if (ATX_ThreadLocal_Get(shared->local) != worker) {
+            ATX_AtomicInt_Add(&shared->local_errors, 1);
+        }
+    }
+
+    /* push our share of nodes on a lock-free stack */
+    for (i=0; i<ITERATIONS/10; i++) {
+        StackNode* node = &shared->nodes[worker->index*(ITERATIONS/10)+i];
+        void*      top;
+        node->value = worker->index;
+        do {
+            top = ATX_AtomicPointer_Get(&shared->stack);
+            node->next = (StackNode*)top;
+        } while (!ATX_AtomicPointer_CompareAndSwap(&shared->stack, top, node));
+    }
+}
+
+/*----------------------------------------------------------------------
+|       Producer
++---------------------------------------------------------------------*/
+static void
+Producer(void* arg)
+{
+    BoundedQueue* queue = (BoundedQueue*)arg;
+    unsigned int  i;
+
+    for (i=1; i<=PRODUCED_ITEMS; i++) {
+        SHOULD_SUCCEED(ATX_Semaphore_Wait(queue->slots, ATX_TIMEOUT_INFINITE));
+        ATX_Mutex_Lock(queue->mutex);
+        queue->queue[queue->tail++ % QUEUE_SIZE] = i;
+        ATX_Mutex_Unlock(queue->mutex);
+        SHOULD_SUCCEED(ATX_Semaphore_Post(queue->items));
+    }
+}
+
+/*----------------------------------------------------------------------
+|       Consumer
++---------------------------------------------------------------------*/
+static void
+Consumer(void* arg)
+{
+    BoundedQueue* queue = (BoundedQueue*)arg;
+    unsigned int  i;
+
+    for (i=0; i<PRODUCED_ITEMS; i++) {
+        SHOULD_SUCCEED(ATX_Semaphore_Wait(queue->items, ATX_TIMEOUT_INFINITE));
+        ATX_Mutex_Lock(queue->mutex);
+        queue->sum += queue->queue[queue->head++ % QUEUE_SIZE];
+        ATX_Mutex_Unlock(queue->mutex);
+        SHOULD_SUCCEED(ATX_Semaphore_Post(queue->slots));
+    }
+}
+
+/*----------------------------------------------------------------------
+|       Notifier
++---------------------------------------------------------------------*/
+static void
+Notifier(void* arg)
+{
+    ATX_Semaphore** semaphores = (ATX_Semaphore**)arg;
+
+    /* stay alive until the creator is done with the thread object */
+    ATX_Semaphore_Wait(semaphores[0], ATX_TIMEOUT_INFINITE);
+    ATX_Semaphore_Post(semaphores[1]);
+}
+
+/*----------------------------------------------------------------------
+|       StressTest
++---------------------------------------------------------------------*/
+static void
+StressTest(void)
+{
+    SharedState  shared;
+    WorkerArg    args[THREAD_COUNT];
+    ATX_Thread*  threads[THREAD_COUNT];
+    unsigned int counts[THREAD_COUNT];
+    unsigned int total = 0;
+    StackNode*   node;
+    unsigned int i;
+
+    ATX_SetMemory(&shared, 0, sizeof(shared));
+    ATX_SetMemory(counts, 0, sizeof(counts));
+    shared.nodes = (StackNode*)ATX_AllocateZeroMemory(THREAD_COUNT*(ITERATIONS/10)*sizeof(StackNode));
+    CHECK(shared.nodes != NULL);
+    SHOULD_SUCCEED(ATX_Mutex_Create(&shared.mutex));
+    SHOULD_SUCCEED(ATX_ThreadLocal_Create(&shared.local));
+    CHECK(ATX_ThreadLocal_Get(shared.local) == NULL);
+
+    for (i=0; i<THREAD_COUNT; i++) {
+        args[i].shared = &shared;
+        args[i].index  = i;
+        SHOULD_SUCCEED(ATX_Thread_Create(Worker, &args[i], &threads[i]));
+    }
+    for (i=0; i<THREAD_COUNT; i++) {
+        SHOULD_SUCCEED(ATX_Thread_Join(threads[i]));
+    }
+
+    CHECK(ATX_AtomicInt_Get(&shared.atomic_counter) == THREAD_COUNT*ITERATIONS);
+    CHECK(shared.mutex_counter == THREAD_COUNT*ITERATIONS);
+    CHECK(ATX_AtomicInt_Get(&shared.local_errors) == 0);
+
+    /* the main thread has its own, untouched, thread-local slot */
+    CHECK(ATX_ThreadLocal_Get(shared.local) == NULL);
+
+    /* every node pushed must be on the stack exactly once */
+    for (node = (StackNode*)ATX_AtomicPointer_Get(&shared.stack); node; node = node->next) {
+        CHECK(node->value < THREAD_COUNT);
+        ++counts[node->value];
+        ++total;
+    }
+    CHECK(total == THREAD_COUNT*(ITERATIONS/10));
+    for (i=0; i<THREAD_COUNT; i++) {
+        CHECK(counts[i] == ITERATIONS/10);
+    }
+
+    ATX_ThreadLocal_Destroy(shared.local);
+    ATX_Mutex_Destroy(shared.mutex);
+    ATX_FreeMemory(shared.nodes);
+}
+
+/*----------------------------------------------------------------------
+|       SemaphoreTest
++---------------------------------------------------------------------*/
+static void
+SemaphoreTest(void)
+{
+    BoundedQueue queue;
+    ATX_Thread*  producer;
+    ATX_Thread*  consumer;
+
+    ATX_SetMemory(&queue, 0, sizeof(queue));
+    SHOULD_SUCCEED(ATX_Semaphore_Create(0, &queue.items));
+    SHOULD_SUCCEED(ATX_Semaphore_Create(QUEUE_SIZE, &queue.slots));
+    SHOULD_SUCCEED(ATX_Mutex_Create(&queue.mutex));
+
+    /* nothing to take yet */
+    CHECK(ATX_Semaphore_Wait(queue.items, 0) == ATX_ERROR_WAIT_TIMEOUT);
+    CHECK(ATX_Semaphore_Wait(queue.items, 10) == ATX_ERROR_WAIT_TIMEOUT);
+
+    SHOULD_SUCCEED(ATX_Thread_Create(Consumer, &queue, &consumer));
+    SHOULD_SUCCEED(ATX_Thread_Create(Producer, &queue, &producer));
+    SHOULD_SUCCEED(ATX_Thread_Join(producer));
+    SHOULD_SUCCEED(ATX_Thread_Join(consumer));
+
+    CHECK(queue.sum == (ATX_UInt64)PRODUCED_ITEMS*(PRODUCED_ITEMS+1)/2);
+    CHECK(queue.head == PRODUCED_ITEMS && queue.tail == PRODUCED_ITEMS);
+
+    ATX_Mutex_Destroy(queue.mutex);
+    ATX_Semaphore_Destroy(queue.slots);
+    ATX_Semaphore_Destroy(queue.items);
+}
+
+/*----------------------------------------------------------------------
+|       ConditionTest
++---------------------------------------------------------------------*/
+static void
+ConditionTest(void)
+{
+    ATX_Mutex*     mutex;
+    ATX_Condition* condition;
+    ATX_TimeStamp  before;
+    ATX_TimeStamp  after;
+
+    SHOULD_SUCCEED(ATX_Mutex_Create(&mutex));
+    SHOULD_SUCCEED(ATX_Condition_Create(&condition));
+
+    ATX_System_GetCurrentTimeStamp(&before);
+    ATX_Mutex_Lock(mutex);
+    CHECK(ATX_Condition_Wait(condition, mutex, 50) == ATX_ERROR_WAIT_TIMEOUT);
+    ATX_Mutex_Unlock(mutex);
+    ATX_System_GetCurrentTimeStamp(&after);
+    ATX_TimeStamp_Sub(after, after, before);
+    CHECK(after.seconds > 0 || after.nanoseconds >= 40000000);
+
+    ATX_Condition_Destroy(condition);
+    ATX_Mutex_Destroy(mutex);
+}
+
+/*----------------------------------------------------------------------
+|       MiscTest
++---------------------------------------------------------------------*/
+static void
+MiscTest(void)
+{
+    ATX_AtomicInt     value;
+    ATX_AtomicPointer pointer;
+    ATX_Semaphore*    semaphores[2];
+    ATX_Thread*       thread;
+    ATX_Result        result;
+    int               dummy;
+
+    ATX_AtomicInt_Set(&value, 5);
+    CHECK(ATX_AtomicInt_Exchange(&value, 7) == 5);
+    CHECK(ATX_AtomicInt_CompareAndSwap(&value, 5, 9) == ATX_FALSE);
+    CHECK(ATX_AtomicInt_CompareAndSwap(&value, 7, 9) == ATX_TRUE);
+    CHECK(ATX_AtomicInt_Add(&value, -9) == 0);
+
+    ATX_AtomicPointer_Set(&pointer, NULL);
+    CHECK(ATX_AtomicPointer_Exchange(&pointer, &dummy) == NULL);
+    CHECK(ATX_AtomicPointer_Get(&pointer) == &dummy);
+    CHECK(ATX_AtomicPointer_CompareAndSwap(&pointer, NULL, &value) == ATX_FALSE);
+    CHECK(ATX_AtomicPointer_CompareAndSwap(&pointer, &dummy, NULL) == ATX_TRUE);
+
+    /* a detached thread cleans up after itself */
+    SHOULD_SUCCEED(ATX_Semaphore_Create(0, &semaphores[0]));
+    SHOULD_SUCCEED(ATX_Semaphore_Create(0, &semaphores[1]));
+    SHOULD_SUCCEED(ATX_Thread_Create(Notifier, semaphores, &thread));
+    result = ATX_Thread_SetName(thread, "atx-test-notifier");
+    CHECK(result == ATX_SUCCESS || result == ATX_ERROR_NOT_SUPPORTED);
+    CHECK(ATX_Thread_GetId(thread) != 0);
+    SHOULD_SUCCEED(ATX_Thread_Detach(thread));
+    SHOULD_SUCCEED(ATX_Semaphore_Post(semaphores[0]));
+    SHOULD_SUCCEED(ATX_Semaphore_Wait(semaphores[1], 5000));
+    ATX_Semaphore_Destroy(semaphores[1]);
+    ATX_Semaphore_Destroy(semaphores[0]);
+}
+
+/*----------------------------------------------------------------------
+|       main
++---------------------------------------------------------------------*/
+int
+main(int argc, char** argv)
+{
+    ATX_COMPILER_UNUSED(argc);
+    ATX_COMPILER_UNUSED(argv);
+
+    MiscTest();
+    ConditionTest();
+    SemaphoreTest();
+    StressTest();
+
+    printf("ThreadsTest passed\n");
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*****************************************************************
+|
+|      Atomix Tools - LogDecoder
+|
+| Copyright (c) 2002-2010, Axiomatic Systems, LLC.
+| All rights reserved.
+|
+| Redistribution and use in source and binary forms, with or without
+| modification, are permitted provided that the following conditions are met:
+|     * Redistributions of source code must retain the above copyright
+|       notice, this list of conditions and the following disclaimer.
+|     * Redistributions in binary form must reproduce the above copyright
+|       notice, this list of conditions and the following disclaimer in the
+|       documentation and/or other materials provided with the distribution.
+|     * Neither the name of Axiomatic Systems nor the
+|       names of its contributors may be used to endorse or promote products
+|       derived from this software without specific prior written permission.
+|
+| THIS SOFTWARE IS PROVIDED BY AXIOMATIC SYSTEMS ''AS IS'' AND ANY
+| EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+| WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+| DISCLAIMED. IN NO EVENT SHALL AXIOMATIC SYSTEMS BE LIABLE FOR ANY
+| DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+| (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+| LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+| ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+| (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+| SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+|
+ ****************************************************************/
+
+
+/*----------------------------------------------------------------------
+|       includes
++---------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Atomix.h"
+
+/*----------------------------------------------------------------------
+|       PrintUsageAndExit
++---------------------------------------------------------------------*/
+static void
+PrintUsageAndExit(void)
+{
+    fprintf(stderr, 
+            "usage: LogDecoder <filename>|" ATX_FILE_STANDARD_INPUT " [<filename>...]\n"
+            "\n"
+            "prints the records of log files written by a FileHandler with\n"
+            "the 'format' property set to 'binary' (or the data received\n"
+            "by a binary TcpHandler)\n");
+    exit(1);
+}
+
+/*----------------------------------------------------------------------
+|       DecodeFile
++---------------------------------------------------------------------*/
+static ATX_Result
+DecodeFile(const char* filename)
+{
+    ATX_File*             file;
+    ATX_InputStream*      stream = NULL;
+    ATX_LogBinaryDecoder* decoder = NULL;
+    ATX_LogRecord         record;
+    ATX_Result            result;
+
+    /* open the file */
+    result = ATX_File_Create(filename, &file);
+    if (ATX_FAILED(result)) return result;
+    result = ATX_File_Open(file, ATX_FILE_OPEN_MODE_READ);
+    if (ATX_SUCCEEDED(result)) {
+        result = ATX_File_GetInputStream(file, &stream);
+    }
+    ATX_DESTROY_OBJECT(file);
+    if (ATX_FAILED(result)) return result;
+
+    /* print all the records */
+    result = ATX_LogBinaryDecoder_Create(stream, &decoder);
+    ATX_RELEASE_OBJECT(stream);
+    if (ATX_FAILED(result)) return result;
+    while (ATX_SUCCEEDED(result = ATX_LogBinaryDecoder_ReadRecord(decoder, &record))) {
+        const char* level_name = ATX_Log_GetLogLevelName(record.level);
+        char        level_string[16];
+
+        if (level_name[0] == '\0') {
+            ATX_IntegerToString(record.level, level_string, sizeof(level_string));
+            level_name = level_string;
+        }
+        printf("%s(%lu): [%s] %lu:%03lu [%s] %s: %s\n",
+               record.source_file,
+               (unsigned long)record.source_line,
+               record.logger_name,
+               (unsigned long)record.timestamp.seconds,
+               (unsigned long)(record.timestamp.nanoseconds/1000000L),
+               record.source_function,
+               level_name,
+               record.message);
+    }
+    ATX_LogBinaryDecoder_Destroy(decoder);
+
+    return result == ATX_ERROR_EOS ? ATX_SUCCESS : result;
+}
+
+/*----------------------------------------------------------------------
+|       main
++---------------------------------------------------------------------*/
+int
+main(int argc, char** argv)
+{
+    int exit_code = 0;
+    
+    if (argc < 2) {
+        PrintUsageAndExit();
+    }
+
+    while (*++argv) {
+        ATX_Result result = DecodeFile(*argv);
+        if (ATX_FAILED(result)) {
+            fprintf(stderr, "ERROR: cannot decode %s (%d)\n", *argv, result);
+            exit_code = 1;
+        }
+    }
+
+    return exit_code;
+}